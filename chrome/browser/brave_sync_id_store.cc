@@ -0,0 +1,293 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "chrome/browser/brave_sync_id_store.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/task_runner_util.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "base/time/time.h"
+#include "third_party/leveldatabase/src/include/leveldb/db.h"
+#include "third_party/leveldatabase/src/include/leveldb/write_batch.h"
+
+#if defined(OS_ANDROID)
+#include "base/android/application_status_listener.h"
+#endif
+
+namespace brave_sync_storage {
+
+namespace {
+
+// How long writes are held so that a sync burst is committed at once.
+constexpr base::TimeDelta kCommitDelay = base::TimeDelta::FromMilliseconds(100);
+
+}  // namespace
+
+const size_t SyncIdStore::kCacheSize = 1000;
+
+SyncIdStore::SyncIdStore(const base::FilePath& db_path,
+                         scoped_refptr<base::SequencedTaskRunner> task_runner)
+    : db_path_(db_path),
+      task_runner_(std::move(task_runner)),
+      cache_(kCacheSize) {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+  task_runner_->PostTask(FROM_HERE,
+                         base::BindOnce(&SyncIdStore::OpenOnSequence,
+                                        base::Unretained(this)));
+}
+
+SyncIdStore::~SyncIdStore() = default;
+
+bool SyncIdStore::GetCachedValue(const std::string& key, std::string* value) {
+  base::AutoLock lock(lock_);
+  if (closed_) {
+    value->clear();
+    return true;
+  }
+  base::Optional<std::string> cached = GetCachedValueLocked(key);
+  if (!cached)
+    return false;
+  *value = std::move(*cached);
+  return true;
+}
+
+void SyncIdStore::GetValues(std::vector<std::string> keys,
+                            GetValuesCallback callback) {
+  std::vector<std::string> values;
+  {
+    base::AutoLock lock(lock_);
+    for (const auto& key : keys) {
+      base::Optional<std::string> value =
+          closed_ ? base::make_optional(std::string())
+                  : GetCachedValueLocked(key);
+      if (!value)
+        break;
+      values.push_back(std::move(*value));
+    }
+  }
+  if (values.size() == keys.size()) {
+    base::SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(std::move(callback), std::move(values)));
+    return;
+  }
+  base::PostTaskAndReplyWithResult(
+      task_runner_.get(), FROM_HERE,
+      base::BindOnce(&SyncIdStore::GetValuesOnSequence, base::Unretained(this),
+                     std::move(keys)),
+      std::move(callback));
+}
+
+void SyncIdStore::Put(const std::string& key, const std::string& value) {
+  base::AutoLock lock(lock_);
+  if (closed_)
+    return;
+  AddWriteLocked(key, value);
+  ScheduleCommitLocked();
+}
+
+void SyncIdStore::Delete(const std::string& key) {
+  base::AutoLock lock(lock_);
+  if (closed_)
+    return;
+  AddWriteLocked(key, base::nullopt);
+  ScheduleCommitLocked();
+}
+
+void SyncIdStore::DeleteKeyAndValue(const std::string& key) {
+  base::AutoLock lock(lock_);
+  if (closed_)
+    return;
+  base::Optional<std::string> value = GetCachedValueLocked(key);
+  if (!value) {
+    // The value is read when the delete is committed, rather than here.
+    pending_value_deletes_.insert(key);
+  } else if (!value->empty()) {
+    AddWriteLocked(*value, base::nullopt);
+  }
+  AddWriteLocked(key, base::nullopt);
+  ScheduleCommitLocked();
+}
+
+base::Optional<std::string> SyncIdStore::GetCachedValueLocked(
+    const std::string& key) {
+  lock_.AssertAcquired();
+  auto write = pending_.find(key);
+  if (write != pending_.end())
+    return write->second.value_or(std::string());
+  auto entry = cache_.Get(key);
+  if (entry != cache_.end())
+    return entry->second;
+  return base::nullopt;
+}
+
+void SyncIdStore::AddWriteLocked(const std::string& key,
+                                 base::Optional<std::string> value) {
+  lock_.AssertAcquired();
+  cache_.Put(key, value.value_or(std::string()));
+  pending_[key] = std::move(value);
+}
+
+void SyncIdStore::ScheduleCommitLocked() {
+  lock_.AssertAcquired();
+  if (commit_scheduled_)
+    return;
+  commit_scheduled_ = true;
+  task_runner_->PostDelayedTask(FROM_HERE,
+                                base::BindOnce(&SyncIdStore::CommitOnSequence,
+                                               base::Unretained(this)),
+                                kCommitDelay);
+}
+
+void SyncIdStore::Commit() {
+  task_runner_->PostTask(FROM_HERE,
+                         base::BindOnce(&SyncIdStore::CommitOnSequence,
+                                        base::Unretained(this)));
+}
+
+void SyncIdStore::Close() {
+  {
+    base::AutoLock lock(lock_);
+    if (closed_)
+      return;
+    closed_ = true;
+    cache_.Clear();
+  }
+  task_runner_->PostTask(FROM_HERE,
+                         base::BindOnce(&SyncIdStore::CloseOnSequence,
+                                        base::Unretained(this)));
+}
+
+#if defined(OS_ANDROID)
+void SyncIdStore::CommitWhenAppIsBackgrounded() {
+  task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&SyncIdStore::ListenForAppStateOnSequence,
+                                base::Unretained(this)));
+}
+#endif
+
+void SyncIdStore::OpenOnSequence() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  leveldb::Options options;
+  options.create_if_missing = true;
+  leveldb::DB* db = nullptr;
+  leveldb::Status status =
+      leveldb::DB::Open(options, db_path_.value().c_str(), &db);
+  db_.reset(db);
+  if (!status.ok() || !db_) {
+    db_.reset();
+    LOG(ERROR) << "sync level db open error " << db_path_.value();
+  }
+}
+
+std::vector<std::string> SyncIdStore::GetValuesOnSequence(
+    const std::vector<std::string>& keys) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  std::vector<std::string> values(keys.size());
+  std::vector<size_t> misses;
+  {
+    base::AutoLock lock(lock_);
+    if (closed_)
+      return values;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      base::Optional<std::string> value = GetCachedValueLocked(keys[i]);
+      if (value)
+        values[i] = std::move(*value);
+      else
+        misses.push_back(i);
+    }
+  }
+  if (misses.empty() || !db_)
+    return values;
+
+  // Commits run on this sequence too, so |db_| holds everything that is not
+  // pending.
+  for (size_t i : misses) {
+    if (!db_->Get(leveldb::ReadOptions(), keys[i], &values[i]).ok())
+      values[i].clear();
+  }
+
+  base::AutoLock lock(lock_);
+  if (closed_)
+    return values;
+  for (size_t i : misses) {
+    // A write made while the database was read is newer than what was read.
+    auto write = pending_.find(keys[i]);
+    if (write != pending_.end())
+      values[i] = write->second.value_or(std::string());
+    else
+      cache_.Put(keys[i], std::string(values[i]));
+  }
+  return values;
+}
+
+void SyncIdStore::CommitOnSequence() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  std::map<std::string, base::Optional<std::string>> committing;
+  std::set<std::string> value_deletes;
+  {
+    base::AutoLock lock(lock_);
+    commit_scheduled_ = false;
+    committing.swap(pending_);
+    value_deletes.swap(pending_value_deletes_);
+  }
+  if (committing.empty() || !db_)
+    return;
+
+  leveldb::WriteBatch batch;
+  for (const auto& key : value_deletes) {
+    std::string value;
+    if (!db_->Get(leveldb::ReadOptions(), key, &value).ok() || value.empty())
+      continue;
+    // A write of the value in this burst or after it is kept.
+    if (committing.count(value))
+      continue;
+    base::AutoLock lock(lock_);
+    if (pending_.count(value))
+      continue;
+    batch.Delete(value);
+    if (!closed_)
+      cache_.Put(value, std::string());
+  }
+  for (const auto& write : committing) {
+    if (write.second)
+      batch.Put(write.first, *write.second);
+    else
+      batch.Delete(write.first);
+  }
+  leveldb::Status status = db_->Write(leveldb::WriteOptions(), &batch);
+  if (!status.ok())
+    LOG(ERROR) << "sync level db write error " << status.ToString();
+}
+
+void SyncIdStore::CloseOnSequence() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  CommitOnSequence();
+  db_.reset();
+#if defined(OS_ANDROID)
+  app_status_listener_.reset();
+#endif
+}
+
+#if defined(OS_ANDROID)
+void SyncIdStore::ListenForAppStateOnSequence() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  app_status_listener_ = base::android::ApplicationStatusListener::New(
+      base::BindRepeating(
+          [](SyncIdStore* store, base::android::ApplicationState state) {
+            if (state ==
+                    base::android::APPLICATION_STATE_HAS_PAUSED_ACTIVITIES ||
+                state ==
+                    base::android::APPLICATION_STATE_HAS_STOPPED_ACTIVITIES) {
+              store->CommitOnSequence();
+            }
+          },
+          base::Unretained(this)));
+}
+#endif
+
+}  // namespace brave_sync_storage
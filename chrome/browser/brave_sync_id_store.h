@@ -0,0 +1,151 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef CHROME_BROWSER_BRAVE_SYNC_ID_STORE_H_
+#define CHROME_BROWSER_BRAVE_SYNC_ID_STORE_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/containers/mru_cache.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/optional.h"
+#include "base/sequence_checker.h"
+#include "base/sequenced_task_runner.h"
+#include "base/synchronization/lock.h"
+#include "build/build_config.h"
+
+namespace base {
+namespace android {
+class ApplicationStatusListener;
+}
+}  // namespace base
+
+namespace leveldb {
+class DB;
+}
+
+namespace brave_sync_storage {
+
+// The sync database, which maps local ids to object ids and the other way
+// round in the same key space.
+//
+// The database is only opened, read and written on |task_runner|. Reads are
+// answered from the writes not yet committed, then from an LRU of recently
+// used mappings; the callers' threads never touch the database. Keys found in
+// neither are read on |task_runner|, and the answer is posted back. Puts and
+// deletes update the memory right away and are committed as one
+// leveldb::WriteBatch shortly after the first write of a burst, or as soon as
+// Commit() is called.
+class SyncIdStore {
+ public:
+  // Called with the values of the keys looked up, in the order of the keys.
+  // Unknown keys have an empty value.
+  using GetValuesCallback =
+      base::OnceCallback<void(std::vector<std::string> values)>;
+
+  // How many mappings the LRU keeps.
+  static const size_t kCacheSize;
+
+  SyncIdStore(const base::FilePath& db_path,
+              scoped_refptr<base::SequencedTaskRunner> task_runner);
+  // The store must only be destroyed once |task_runner| has run the tasks it
+  // posted.
+  ~SyncIdStore();
+
+  // Sets |value| to the value of |key| and returns true if it is known without
+  // reading the database. An unknown key has an empty value.
+  bool GetCachedValue(const std::string& key, std::string* value);
+
+  // Looks up |keys| and runs |callback| with their values on the calling
+  // sequence. The keys not in memory are read on |task_runner|.
+  void GetValues(std::vector<std::string> keys, GetValuesCallback callback);
+
+  void Put(const std::string& key, const std::string& value);
+  void Delete(const std::string& key);
+
+  // Deletes |key| and the key its value names, as when a local id and its
+  // object id are both dropped.
+  void DeleteKeyAndValue(const std::string& key);
+
+  // Commits the pending writes without waiting for the rest of the burst.
+  void Commit();
+
+  // Commits the pending writes and closes the database for good. Later reads
+  // return empty strings and later writes are dropped.
+  void Close();
+
+#if defined(OS_ANDROID)
+  // Commits the pending writes whenever the app stops being in the
+  // foreground, as Android may kill its process at any time after that.
+  void CommitWhenAppIsBackgrounded();
+#endif
+
+ private:
+  // Returns the value of |key| from the pending writes or the LRU.
+  base::Optional<std::string> GetCachedValueLocked(const std::string& key);
+
+  // Records a put, or a delete when |value| is null.
+  void AddWriteLocked(const std::string& key,
+                      base::Optional<std::string> value);
+
+  // Posts the commit of the pending writes after kCommitDelay, unless it is
+  // already posted.
+  void ScheduleCommitLocked();
+
+  void OpenOnSequence();
+
+  // Looks up |keys| in memory and then in the database, and keeps the values
+  // read from the database in the LRU.
+  std::vector<std::string> GetValuesOnSequence(
+      const std::vector<std::string>& keys);
+
+  // Writes the pending writes as a single batch. The lock is only held to
+  // take them, not while they are written.
+  void CommitOnSequence();
+
+  void CloseOnSequence();
+
+#if defined(OS_ANDROID)
+  void ListenForAppStateOnSequence();
+#endif
+
+  const base::FilePath db_path_;
+  const scoped_refptr<base::SequencedTaskRunner> task_runner_;
+
+  base::Lock lock_;
+  // Recently used mappings, including the written ones. Unknown keys are kept
+  // with an empty value. Guarded by |lock_|.
+  base::MRUCache<std::string, std::string> cache_;
+  // Writes not yet in |db_|, by key. A null value is a delete. Guarded by
+  // |lock_|.
+  std::map<std::string, base::Optional<std::string>> pending_;
+  // Deleted keys whose value, read from |db_| when they are committed, names
+  // a key to delete as well. Guarded by |lock_|.
+  std::set<std::string> pending_value_deletes_;
+  // Guarded by |lock_|.
+  bool commit_scheduled_ = false;
+  bool closed_ = false;
+
+  // Only used on |task_runner_|.
+  std::unique_ptr<leveldb::DB> db_;
+#if defined(OS_ANDROID)
+  std::unique_ptr<base::android::ApplicationStatusListener>
+      app_status_listener_;
+#endif
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  DISALLOW_COPY_AND_ASSIGN(SyncIdStore);
+};
+
+}  // namespace brave_sync_storage
+
+#endif  // CHROME_BROWSER_BRAVE_SYNC_ID_STORE_H_
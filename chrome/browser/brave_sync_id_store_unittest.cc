@@ -0,0 +1,164 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "chrome/browser/brave_sync_id_store.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/task/post_task.h"
+#include "base/test/task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_sync_storage {
+
+class SyncIdStoreTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  std::unique_ptr<SyncIdStore> CreateStore() {
+    return std::make_unique<SyncIdStore>(
+        temp_dir_.GetPath().AppendASCII("brave_sync_db"),
+        base::CreateSequencedTaskRunner(
+            {base::ThreadPool(), base::MayBlock()}));
+  }
+
+  // Closes |store| and destroys it once its sequence is idle.
+  void CloseStore(std::unique_ptr<SyncIdStore> store) {
+    store->Close();
+    task_environment_.RunUntilIdle();
+  }
+
+  std::vector<std::string> GetValues(SyncIdStore* store,
+                                     std::vector<std::string> keys) {
+    std::vector<std::string> values;
+    base::RunLoop run_loop;
+    store->GetValues(std::move(keys),
+                     base::BindOnce(
+                         [](std::vector<std::string>* values,
+                            base::OnceClosure quit,
+                            std::vector<std::string> result) {
+                           *values = std::move(result);
+                           std::move(quit).Run();
+                         },
+                         &values, run_loop.QuitClosure()));
+    run_loop.Run();
+    return values;
+  }
+
+  std::string GetValue(SyncIdStore* store, const std::string& key) {
+    return GetValues(store, {key})[0];
+  }
+
+  // Mock time keeps the delayed commits from running after a store is gone.
+  base::test::TaskEnvironment task_environment_{
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
+  base::ScopedTempDir temp_dir_;
+};
+
+TEST_F(SyncIdStoreTest, PendingWriteIsCached) {
+  std::unique_ptr<SyncIdStore> store = CreateStore();
+  store->Put("local", "object");
+  // The write is not committed yet.
+  std::string value;
+  EXPECT_TRUE(store->GetCachedValue("local", &value));
+  EXPECT_EQ("object", value);
+  EXPECT_FALSE(store->GetCachedValue("unknown", &value));
+  EXPECT_EQ("", GetValue(store.get(), "unknown"));
+  // Unknown keys are cached too.
+  EXPECT_TRUE(store->GetCachedValue("unknown", &value));
+  EXPECT_EQ("", value);
+  CloseStore(std::move(store));
+}
+
+TEST_F(SyncIdStoreTest, DeleteThenGet) {
+  std::unique_ptr<SyncIdStore> store = CreateStore();
+  store->Put("local", "object");
+  store->Commit();
+  task_environment_.RunUntilIdle();
+
+  store->Delete("local");
+  EXPECT_EQ("", GetValue(store.get(), "local"));
+  CloseStore(std::move(store));
+
+  store = CreateStore();
+  EXPECT_EQ("", GetValue(store.get(), "local"));
+  CloseStore(std::move(store));
+}
+
+TEST_F(SyncIdStoreTest, CloseCommitsPendingWrites) {
+  std::unique_ptr<SyncIdStore> store = CreateStore();
+  store->Put("local", "object");
+  store->Put("object", "local");
+  store->Put("gone", "soon");
+  store->Delete("gone");
+  CloseStore(std::move(store));
+
+  store = CreateStore();
+  std::string value;
+  EXPECT_FALSE(store->GetCachedValue("local", &value));
+  EXPECT_EQ(std::vector<std::string>({"object", "local", ""}),
+            GetValues(store.get(), {"local", "object", "gone"}));
+  EXPECT_TRUE(store->GetCachedValue("local", &value));
+  EXPECT_EQ("object", value);
+  CloseStore(std::move(store));
+}
+
+TEST_F(SyncIdStoreTest, CacheIsBounded) {
+  std::unique_ptr<SyncIdStore> store = CreateStore();
+  const size_t count = SyncIdStore::kCacheSize + 1;
+  for (size_t i = 0; i < count; ++i)
+    store->Put(base::NumberToString(i), "value");
+  store->Commit();
+  task_environment_.RunUntilIdle();
+
+  // The first write is the least recently used one.
+  std::string value;
+  EXPECT_FALSE(store->GetCachedValue("0", &value));
+  EXPECT_TRUE(store->GetCachedValue(base::NumberToString(count - 1), &value));
+  EXPECT_EQ("value", GetValue(store.get(), "0"));
+  EXPECT_TRUE(store->GetCachedValue("0", &value));
+  CloseStore(std::move(store));
+}
+
+TEST_F(SyncIdStoreTest, DeleteKeyAndValue) {
+  std::unique_ptr<SyncIdStore> store = CreateStore();
+  store->Put("local1", "object1");
+  store->Put("object1", "local1");
+  store->Put("local2", "object2");
+  store->Put("object2", "local2");
+  CloseStore(std::move(store));
+
+  store = CreateStore();
+  // The value of local1 is in memory, the one of local2 is not.
+  EXPECT_EQ("object1", GetValue(store.get(), "local1"));
+  store->DeleteKeyAndValue("local1");
+  store->DeleteKeyAndValue("local2");
+  CloseStore(std::move(store));
+
+  store = CreateStore();
+  EXPECT_EQ(std::vector<std::string>({"", "", "", ""}),
+            GetValues(store.get(), {"local1", "object1", "local2", "object2"}));
+  CloseStore(std::move(store));
+}
+
+TEST_F(SyncIdStoreTest, ClosedStoreIsEmpty) {
+  std::unique_ptr<SyncIdStore> store = CreateStore();
+  store->Put("local", "object");
+  store->Close();
+  std::string value;
+  EXPECT_TRUE(store->GetCachedValue("local", &value));
+  EXPECT_EQ("", value);
+  store->Put("local", "object");
+  EXPECT_EQ("", GetValue(store.get(), "local"));
+  task_environment_.RunUntilIdle();
+}
+
+}  // namespace brave_sync_storage
@@ -2,20 +2,46 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
  #include "brave_sync_worker.h"
+
+ #include <utility>
+
  #include "base/android/jni_android.h"
+ #include "base/android/jni_array.h"
  #include "base/android/jni_string.h"
+ #include "base/android/scoped_java_ref.h"
  #include "chrome/android/chrome_jni_headers/BraveSyncWorker_jni.h"
- #include "base/files/file_util.h"
+ #include "base/bind.h"
+ #include "base/bind_helpers.h"
+ #include "base/files/file_path.h"
  #include "base/path_service.h"
- #include "third_party/leveldatabase/src/include/leveldb/db.h"
+ #include "base/task/post_task.h"
+ #include "chrome/browser/brave_sync_id_store.h"
 
 namespace brave_sync_storage {
 
 #define DB_FILE_NAME      "brave_sync_db"
 
-leveldb::DB* g_level_db;
-static std::mutex* g_pLevel_db_init_mutex = new std::mutex();
+namespace {
+
+SyncIdStore* CreateSyncIdStore() {
+    base::FilePath app_data_path;
+    base::PathService::Get(base::DIR_ANDROID_APP_DATA, &app_data_path);
+    SyncIdStore* store = new SyncIdStore(app_data_path.Append(DB_FILE_NAME),
+        base::CreateSequencedTaskRunner(
+            {base::ThreadPool(), base::MayBlock(),
+             base::TaskPriority::USER_VISIBLE,
+             base::TaskShutdownBehavior::BLOCK_SHUTDOWN}));
+    store->CommitWhenAppIsBackgrounded();
+    return store;
+}
+
+// The store is shared by all the workers and lives as long as the process.
+SyncIdStore* GetSyncIdStore() {
+    static SyncIdStore* store = CreateSyncIdStore();
+    return store;
+}
 
+}  // namespace
 
 BraveSyncWorker::BraveSyncWorker(JNIEnv* env, jobject obj):
   weak_java_shields_config_(env, obj) {
@@ -24,59 +50,60 @@ BraveSyncWorker::BraveSyncWorker(JNIEnv* env, jobject obj):
 BraveSyncWorker::~BraveSyncWorker() {
 }
 
-void CreateOpenDatabase() {
-    if (!g_pLevel_db_init_mutex) {
-        return;
-    }
-    std::lock_guard<std::mutex> guard(*g_pLevel_db_init_mutex);
-
-    if (nullptr == g_level_db) {
-        base::FilePath app_data_path;
-        base::PathService::Get(base::DIR_ANDROID_APP_DATA, &app_data_path);
-        base::FilePath dbFilePath = app_data_path.Append(DB_FILE_NAME);
-
-        leveldb::Options options;
-        options.create_if_missing = true;
-        leveldb::Status status = leveldb::DB::Open(options, dbFilePath.value().c_str(), &g_level_db);
-        if (!status.ok() || !g_level_db) {
-            if (g_level_db) {
-                delete g_level_db;
-                g_level_db = nullptr;
-            }
-
-            LOG(ERROR) << "sync level db open error " << DB_FILE_NAME;
-
-            return;
-        }
-    }
+void GetValuesAsync(std::vector<std::string> keys,
+        base::OnceCallback<void(std::vector<std::string>)> callback) {
+    GetSyncIdStore()->GetValues(std::move(keys), std::move(callback));
 }
 
-base::android::ScopedJavaLocalRef<jstring> JNI_BraveSyncWorker_GetLocalIdByObjectId(JNIEnv*
-      env, const base::android::JavaParamRef<jobject>& jcaller,
-      const base::android::JavaParamRef<jstring>& objectId) {
-    CreateOpenDatabase();
-    if (nullptr == g_level_db) {
-        return base::android::ConvertUTF8ToJavaString(env, "");
-    }
+namespace {
 
+// Returns the value of |key| if it is in memory. Otherwise returns null and
+// reads it in the background, so that it is in memory on the next call; the
+// caller resolves the misses it cannot retry through
+// JNI_BraveSyncWorker_GetLocalIdsByObjectIds().
+base::android::ScopedJavaLocalRef<jstring> GetCachedValue(JNIEnv* env,
+      const base::android::JavaParamRef<jstring>& key) {
+    SyncIdStore* store = GetSyncIdStore();
+    std::string strKey = base::android::ConvertJavaStringToUTF8(key);
     std::string value;
-    g_level_db->Get(leveldb::ReadOptions(), base::android::ConvertJavaStringToUTF8(objectId), &value);
+    if (store->GetCachedValue(strKey, &value))
+        return base::android::ConvertUTF8ToJavaString(env, value);
+    store->GetValues({strKey}, base::DoNothing());
+    return base::android::ScopedJavaLocalRef<jstring>();
+}
+
+}  // namespace
 
-    return base::android::ConvertUTF8ToJavaString(env, value);
+base::android::ScopedJavaLocalRef<jstring> JNI_BraveSyncWorker_GetLocalIdByObjectId(JNIEnv*
+      env, const base::android::JavaParamRef<jobject>& jcaller,
+      const base::android::JavaParamRef<jstring>& objectId) {
+    return GetCachedValue(env, objectId);
 }
 
 base::android::ScopedJavaLocalRef<jstring> JNI_BraveSyncWorker_GetObjectIdByLocalId(JNIEnv* env,
       const base::android::JavaParamRef<jobject>& obj,
       const base::android::JavaParamRef<jstring>& localId) {
-    CreateOpenDatabase();
-    if (nullptr == g_level_db) {
-        return base::android::ConvertUTF8ToJavaString(env, "");
-    }
-
-    std::string value;
-    g_level_db->Get(leveldb::ReadOptions(), base::android::ConvertJavaStringToUTF8(localId), &value);
+    return GetCachedValue(env, localId);
+}
 
-    return base::android::ConvertUTF8ToJavaString(env, value);
+// Resolves many ids in one call, without blocking. The results are passed to
+// the Java object's onLocalIdsResolved() with the ids, each at the position of
+// its id, and empty for unknown ids.
+void JNI_BraveSyncWorker_GetLocalIdsByObjectIds(JNIEnv* env,
+      const base::android::JavaParamRef<jobject>& obj,
+      const base::android::JavaParamRef<jobjectArray>& objectIds) {
+    std::vector<std::string> keys;
+    base::android::AppendJavaStringArrayToStringVector(env, objectIds, &keys);
+    GetValuesAsync(std::move(keys), base::BindOnce(
+        [](const base::android::ScopedJavaGlobalRef<jobject>& obj,
+           const base::android::ScopedJavaGlobalRef<jobjectArray>& objectIds,
+           std::vector<std::string> localIds) {
+            JNIEnv* env = base::android::AttachCurrentThread();
+            Java_BraveSyncWorker_onLocalIdsResolved(env, obj, objectIds,
+                base::android::ToJavaArrayOfStrings(env, localIds));
+        },
+        base::android::ScopedJavaGlobalRef<jobject>(obj),
+        base::android::ScopedJavaGlobalRef<jobjectArray>(objectIds)));
 }
 
 void JNI_BraveSyncWorker_SaveObjectId(JNIEnv* env, const
@@ -84,55 +111,33 @@ void JNI_BraveSyncWorker_SaveObjectId(JNIEnv* env, const
       const base::android::JavaParamRef<jstring>& localId,
       const base::android::JavaParamRef<jstring>& objectIdJSON,
       const base::android::JavaParamRef<jstring>& objectId) {
-    CreateOpenDatabase();
-    if (nullptr == g_level_db) {
-        return;
-    }
+    SyncIdStore* store = GetSyncIdStore();
     std::string strLocalId = base::android::ConvertJavaStringToUTF8(localId);
 
-    g_level_db->Put(leveldb::WriteOptions(), strLocalId,
+    store->Put(strLocalId,
         base::android::ConvertJavaStringToUTF8(objectIdJSON));
     std::string strObjectId = base::android::ConvertJavaStringToUTF8(objectId);
     if (0 != strObjectId.size()) {
-        g_level_db->Put(leveldb::WriteOptions(), strObjectId, strLocalId);
+        store->Put(strObjectId, strLocalId);
     }
 }
 
 void JNI_BraveSyncWorker_DeleteByLocalId(JNIEnv* env,
       const base::android::JavaParamRef<jobject>& obj,
       const base::android::JavaParamRef<jstring>& localId) {
-    CreateOpenDatabase();
-    if (nullptr == g_level_db) {
-        return;
-    }
-
-    std::string strLocalId = base::android::ConvertJavaStringToUTF8(localId);
-    std::string value;
-    g_level_db->Get(leveldb::ReadOptions(), strLocalId, &value);
-
-    g_level_db->Delete(leveldb::WriteOptions(), strLocalId);
-    g_level_db->Delete(leveldb::WriteOptions(), value);
+    GetSyncIdStore()->DeleteKeyAndValue(
+        base::android::ConvertJavaStringToUTF8(localId));
 }
 
 static void JNI_BraveSyncWorker_Clear(JNIEnv* env, const base::android::JavaParamRef<jobject>& obj) {
-    if (g_level_db) {
-        delete g_level_db;
-        g_level_db = nullptr;
-    }
-    if (g_pLevel_db_init_mutex) {
-        delete g_pLevel_db_init_mutex;
-        g_pLevel_db_init_mutex = nullptr;
-    }
+    GetSyncIdStore()->Close();
 }
 
 static void JNI_BraveSyncWorker_ResetSync(JNIEnv* env,
       const base::android::JavaParamRef<jobject>& obj,
       const base::android::JavaParamRef<jstring>& key) {
-    CreateOpenDatabase();
-    if (nullptr == g_level_db) {
-        return;
-    }
-    g_level_db->Delete(leveldb::WriteOptions(), base::android::ConvertJavaStringToUTF8(key));
+    GetSyncIdStore()->Delete(
+        base::android::ConvertJavaStringToUTF8(key));
 }
 
 // static
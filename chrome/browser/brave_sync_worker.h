@@ -6,10 +6,20 @@
 #define BRAVE_SYNC_STORAGE_H_
 
 #include <jni.h>
+#include <string>
+#include <vector>
+
 #include "../../../../base/android/jni_weak_ref.h"
+#include "base/callback.h"
 
 namespace brave_sync_storage {
 
+// Looks up the values of |keys| in the sync database off the calling thread,
+// then runs |callback| on the calling sequence with them, in the order of
+// |keys|. Unknown keys get an empty value.
+void GetValuesAsync(std::vector<std::string> keys,
+        base::OnceCallback<void(std::vector<std::string>)> callback);
+
 class BraveSyncWorker {
 public:
     BraveSyncWorker(JNIEnv* env, jobject obj);
@@ -60,6 +60,7 @@ class ChromeConfigurator : public update_client::Configurator {
   int NextCheckDelay() const override;
   int OnDemandDelay() const override;
   int UpdateDelay() const override;
+  int MaxConcurrentDownloads() const override;
   std::vector<GURL> UpdateUrl() const override;
   std::vector<GURL> PingUrl() const override;
   std::string GetProdId() const override;
@@ -126,6 +127,10 @@ int ChromeConfigurator::UpdateDelay() const {
   return configurator_impl_.UpdateDelay();
 }
 
+int ChromeConfigurator::MaxConcurrentDownloads() const {
+  return configurator_impl_.MaxConcurrentDownloads();
+}
+
 std::vector<GURL> ChromeConfigurator::UpdateUrl() const {
   return configurator_impl_.UpdateUrl();
 }
@@ -126,6 +126,10 @@ int ChromeUpdateClientConfig::UpdateDelay() const {
   return impl_.UpdateDelay();
 }
 
+int ChromeUpdateClientConfig::MaxConcurrentDownloads() const {
+  return impl_.MaxConcurrentDownloads();
+}
+
 std::vector<GURL> ChromeUpdateClientConfig::UpdateUrl() const {
   return impl_.UpdateUrl();
 }
@@ -44,6 +44,7 @@ class ChromeUpdateClientConfig : public update_client::Configurator {
   int NextCheckDelay() const override;
   int OnDemandDelay() const override;
   int UpdateDelay() const override;
+  int MaxConcurrentDownloads() const override;
   std::vector<GURL> UpdateUrl() const override;
   std::vector<GURL> PingUrl() const override;
   std::string GetProdId() const override;
@@ -14,6 +14,7 @@
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/command_line.h"
+#include "base/feature_list.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/pickle.h"
 #include "base/stl_util.h"
@@ -64,7 +65,8 @@ using content::WebContents;
 using sessions::ContentSerializedNavigationBuilder;
 using sessions::SerializedNavigationEntry;
 
-// Every kWritesPerReset commands triggers recreating the file.
+// Every kWritesPerReset commands triggers recreating the file, unless the
+// backend compacts it.
 static const int kWritesPerReset = 250;
 
 // SessionService -------------------------------------------------------------
@@ -79,7 +81,9 @@ SessionService::SessionService(Profile* profile)
       has_open_trackable_browsers_(false),
       move_on_new_browser_(false),
       force_browser_not_alive_with_no_windows_(false),
-      rebuild_on_next_save_(false) {
+      rebuild_on_next_save_(false),
+      compact_session_file_(
+          base::FeatureList::IsEnabled(sessions::kCompactSessionFile)) {
   // We should never be created when incognito.
   DCHECK(!profile->IsOffTheRecord());
   Init();
@@ -95,7 +99,9 @@ SessionService::SessionService(const base::FilePath& save_path)
       has_open_trackable_browsers_(false),
       move_on_new_browser_(false),
       force_browser_not_alive_with_no_windows_(false),
-      rebuild_on_next_save_(false) {
+      rebuild_on_next_save_(false),
+      compact_session_file_(
+          base::FeatureList::IsEnabled(sessions::kCompactSessionFile)) {
   Init();
 }
 
@@ -579,6 +585,10 @@ void SessionService::RebuildCommandsIfRequired() {
 
 void SessionService::Init() {
   BrowserList::AddObserver(this);
+  if (compact_session_file_) {
+    base_session_service_->SetCommandCompactor(
+        base::BindRepeating(&sessions::CompactSessionCommands));
+  }
 }
 
 bool SessionService::ShouldRestoreWindowOfType(
@@ -835,7 +845,8 @@ void SessionService::ScheduleCommand(
   base_session_service_->ScheduleCommand(std::move(command));
   // Don't schedule a reset on tab closed/window closed. Otherwise we may
   // lose tabs/windows we want to restore from if we exit right after this.
-  if (!base_session_service_->pending_reset() &&
+  // There's no need for periodic resets when the backend compacts the file.
+  if (!compact_session_file_ && !base_session_service_->pending_reset() &&
       pending_window_close_ids_.empty() &&
       base_session_service_->commands_since_reset() >= kWritesPerReset &&
       !is_closing_command) {
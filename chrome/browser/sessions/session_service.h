@@ -396,6 +396,10 @@ class SessionService : public sessions::BaseSessionServiceDelegate,
   // Force session commands to be rebuild before next save event.
   bool rebuild_on_next_save_;
 
+  // Whether the backend compacts the session file, in which case it isn't
+  // periodically rebuilt from the open browsers.
+  bool compact_session_file_;
+
   // Don't send duplicate SetSelectedTabInWindow commands when the selected
   // tab's index hasn't changed.
   std::map<SessionID, int> last_selected_tab_in_window_;
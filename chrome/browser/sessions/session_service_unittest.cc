@@ -36,6 +36,7 @@
 #include "chrome/test/base/testing_profile.h"
 #include "chrome/test/base/testing_profile_manager.h"
 #include "components/sessions/content/content_test_helper.h"
+#include "components/sessions/core/base_session_service_test_helper.h"
 #include "components/sessions/core/serialized_navigation_entry_test_helper.h"
 #include "components/sessions/core/session_command.h"
 #include "components/sessions/core/session_types.h"
@@ -485,6 +486,79 @@ TEST_F(SessionServiceTest, WindowCloseCommittedAfterNavigate) {
   helper_.AssertNavigationEquals(nav1, tab->navigations[0]);
 }
 
+// Compacting the session commands doesn't change the session restored from
+// them.
+TEST_F(SessionServiceTest, CompactedCommandsRestoreSameSession) {
+  SessionID window2_id = SessionID::NewUnique();
+  SessionID tab1_id = SessionID::NewUnique();
+  SessionID tab2_id = SessionID::NewUnique();
+  SerializedNavigationEntry nav1;
+  SerializedNavigationEntry nav2;
+  CreateAndWriteSessionWithTwoWindows(
+      window2_id, tab1_id, tab2_id, &nav1, &nav2);
+
+  // Navigate back and forth, prune some navigations and navigate again.
+  for (int i = 0; i < 6; ++i) {
+    SerializedNavigationEntry* nav = (i % 2) == 0 ? &nav1 : &nav2;
+    nav->set_index(i);
+    UpdateNavigation(window_id, tab1_id, *nav, true);
+  }
+  service()->TabNavigationPathPruned(window_id, tab1_id, 2 /* index */,
+                                     3 /* count */);
+  nav2.set_index(2);
+  UpdateNavigation(window_id, tab1_id, nav2, true);
+  service()->SetPinnedState(window_id, tab1_id, true);
+  service()->SetPinnedState(window_id, tab1_id, false);
+
+  // Close a tab, and a window, which leaves its tabs.
+  const SessionID tab3_id = CreateTabWithTestNavigationData(window_id, 1);
+  service()->TabClosed(window_id, tab3_id, false);
+  service()->WindowClosing(window2_id);
+  service()->WindowClosed(window2_id);
+
+  // Recreating the service makes the session written the last session.
+  helper_.SetService(NULL);
+  helper_.SetService(new SessionService(path_));
+  sessions::BaseSessionServiceTestHelper test_helper(
+      service()->GetBaseSessionServiceForTest());
+  std::vector<std::unique_ptr<sessions::SessionCommand>> commands;
+  ASSERT_TRUE(test_helper.ReadLastSessionCommands(&commands));
+  std::vector<std::unique_ptr<sessions::SessionCommand>> compacted_commands;
+  ASSERT_TRUE(test_helper.ReadLastSessionCommands(&compacted_commands));
+  compacted_commands =
+      sessions::CompactSessionCommands(std::move(compacted_commands));
+  EXPECT_LT(compacted_commands.size(), commands.size());
+
+  std::vector<std::unique_ptr<sessions::SessionWindow>> windows;
+  SessionID active_window_id = SessionID::InvalidValue();
+  sessions::RestoreSessionFromCommands(commands, &windows, &active_window_id);
+  std::vector<std::unique_ptr<sessions::SessionWindow>> compacted_windows;
+  SessionID compacted_active_window_id = SessionID::InvalidValue();
+  sessions::RestoreSessionFromCommands(compacted_commands, &compacted_windows,
+                                       &compacted_active_window_id);
+
+  EXPECT_EQ(active_window_id, compacted_active_window_id);
+  ASSERT_EQ(1U, windows.size());
+  ASSERT_EQ(windows.size(), compacted_windows.size());
+  const sessions::SessionWindow& window = *windows[0];
+  const sessions::SessionWindow& compacted_window = *compacted_windows[0];
+  EXPECT_EQ(window.window_id, compacted_window.window_id);
+  EXPECT_EQ(window.bounds, compacted_window.bounds);
+  EXPECT_EQ(window.show_state, compacted_window.show_state);
+  EXPECT_EQ(window.workspace, compacted_window.workspace);
+  EXPECT_EQ(window.selected_tab_index, compacted_window.selected_tab_index);
+  ASSERT_EQ(1U, window.tabs.size());
+  ASSERT_EQ(window.tabs.size(), compacted_window.tabs.size());
+  const sessions::SessionTab& tab = *window.tabs[0];
+  helper_.AssertTabEquals(window_id, tab1_id, 0, tab.current_navigation_index,
+                          tab.navigations.size(), *compacted_window.tabs[0]);
+  EXPECT_EQ(tab.pinned, compacted_window.tabs[0]->pinned);
+  for (size_t i = 0; i < tab.navigations.size(); ++i) {
+    helper_.AssertNavigationEquals(tab.navigations[i],
+                                   compacted_window.tabs[0]->navigations[i]);
+  }
+}
+
 // Makes sure we don't track popups.
 TEST_F(SessionServiceTest, IgnorePopups) {
   SessionID window2_id = SessionID::NewUnique();
@@ -55,6 +55,10 @@ int Configurator::UpdateDelay() const {
   return 0;
 }
 
+int Configurator::MaxConcurrentDownloads() const {
+  return 3;
+}
+
 std::vector<GURL> Configurator::UpdateUrl() const {
   return std::vector<GURL>{GURL(kUpdaterJSONDefaultUrl)};
 }
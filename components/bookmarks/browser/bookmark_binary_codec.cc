@@ -0,0 +1,276 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/bookmarks/browser/bookmark_binary_codec.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "base/guid.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/pickle.h"
+#include "base/stl_util.h"
+#include "components/bookmarks/browser/bookmark_model.h"
+#include "url/gurl.h"
+
+using base::Time;
+
+namespace bookmarks {
+
+namespace {
+
+// Current version of the binary form. Data of any other version is rejected.
+const int kCurrentVersion = 1;
+
+// Deeper trees can't come from the JSON file, whose parser has the same limit.
+const int kMaxDepth = 200;
+
+}  // namespace
+
+struct BookmarkBinaryCodec::PermanentNodeFields {
+  int64_t id = 0;
+  int64_t date_added = 0;
+  int64_t date_folder_modified = 0;
+  BookmarkNode::MetaInfoMap meta_info_map;
+  int64_t sync_transaction_version = 0;
+};
+
+BookmarkBinaryCodec::BookmarkBinaryCodec() = default;
+
+BookmarkBinaryCodec::~BookmarkBinaryCodec() = default;
+
+std::string BookmarkBinaryCodec::Encode(BookmarkModel* model,
+                                        const std::string& sync_metadata_str,
+                                        const std::string& checksum) {
+  return Encode(model->bookmark_bar_node(), model->other_node(),
+                model->mobile_node(), model->root_node()->GetMetaInfoMap(),
+                model->root_node()->sync_transaction_version(),
+                sync_metadata_str, checksum);
+}
+
+std::string BookmarkBinaryCodec::Encode(
+    const BookmarkNode* bookmark_bar_node,
+    const BookmarkNode* other_folder_node,
+    const BookmarkNode* mobile_folder_node,
+    const BookmarkNode::MetaInfoMap* model_meta_info_map,
+    int64_t sync_transaction_version,
+    const std::string& sync_metadata_str,
+    const std::string& checksum) {
+  checksum_ = checksum;
+
+  base::Pickle pickle;
+  pickle.WriteInt(kCurrentVersion);
+  pickle.WriteString(checksum);
+  pickle.WriteString(sync_metadata_str);
+  EncodeMetaInfo(model_meta_info_map, &pickle);
+  pickle.WriteInt64(sync_transaction_version);
+  for (const BookmarkNode* node :
+       {bookmark_bar_node, other_folder_node, mobile_folder_node}) {
+    // The type, GUID and title of permanent nodes are fixed.
+    pickle.WriteInt64(node->id());
+    pickle.WriteInt64(node->date_added().ToInternalValue());
+    pickle.WriteInt64(node->date_folder_modified().ToInternalValue());
+    EncodeMetaInfo(node->GetMetaInfoMap(), &pickle);
+    pickle.WriteInt64(node->sync_transaction_version());
+    EncodeChildren(node, &pickle);
+  }
+  return std::string(static_cast<const char*>(pickle.data()), pickle.size());
+}
+
+bool BookmarkBinaryCodec::Decode(base::StringPiece data,
+                                 BookmarkNode* bb_node,
+                                 BookmarkNode* other_folder_node,
+                                 BookmarkNode* mobile_folder_node,
+                                 int64_t* max_id,
+                                 std::string* sync_metadata_str) {
+  DCHECK(bb_node->children().empty());
+  DCHECK(other_folder_node->children().empty());
+  DCHECK(mobile_folder_node->children().empty());
+
+  ids_.clear();
+  guids_ = {BookmarkNode::kRootNodeGuid, BookmarkNode::kBookmarkBarNodeGuid,
+            BookmarkNode::kOtherBookmarksNodeGuid,
+            BookmarkNode::kMobileBookmarksNodeGuid,
+            BookmarkNode::kManagedNodeGuid};
+  maximum_id_ = 0;
+
+  base::Pickle pickle(data.data(), data.size());
+  base::PickleIterator iter(pickle);
+  int version;
+  std::string checksum;
+  std::string sync_metadata;
+  BookmarkNode::MetaInfoMap model_meta_info_map;
+  int64_t model_sync_transaction_version;
+  PermanentNodeFields fields[3];
+  BookmarkNode* const nodes[] = {bb_node, other_folder_node,
+                                 mobile_folder_node};
+  bool success = iter.ReadInt(&version) && version == kCurrentVersion &&
+                 iter.ReadString(&checksum) &&
+                 iter.ReadString(&sync_metadata) &&
+                 DecodeMetaInfo(&iter, &model_meta_info_map) &&
+                 iter.ReadInt64(&model_sync_transaction_version);
+  for (size_t i = 0; success && i < base::size(nodes); ++i)
+    success = DecodePermanentNode(&iter, nodes[i], &fields[i]);
+
+  if (!success) {
+    for (BookmarkNode* node : nodes)
+      node->DeleteAll();
+    return false;
+  }
+
+  for (size_t i = 0; i < base::size(nodes); ++i) {
+    nodes[i]->set_id(fields[i].id);
+    nodes[i]->set_date_added(Time::FromInternalValue(fields[i].date_added));
+    nodes[i]->set_date_folder_modified(
+        Time::FromInternalValue(fields[i].date_folder_modified));
+    nodes[i]->SetMetaInfoMap(fields[i].meta_info_map);
+    nodes[i]->set_sync_transaction_version(
+        fields[i].sync_transaction_version);
+  }
+  checksum_ = std::move(checksum);
+  model_meta_info_map_ = std::move(model_meta_info_map);
+  model_sync_transaction_version_ = model_sync_transaction_version;
+  if (sync_metadata_str)
+    *sync_metadata_str = std::move(sync_metadata);
+  if (max_id)
+    *max_id = maximum_id_ + 1;
+  return true;
+}
+
+void BookmarkBinaryCodec::EncodeNode(const BookmarkNode* node,
+                                     base::Pickle* pickle) {
+  pickle->WriteBool(node->is_url());
+  pickle->WriteInt64(node->id());
+  pickle->WriteString(node->guid());
+  pickle->WriteString16(node->GetTitle());
+  pickle->WriteInt64(node->date_added().ToInternalValue());
+  if (node->is_url())
+    pickle->WriteString(node->url().spec());
+  else
+    pickle->WriteInt64(node->date_folder_modified().ToInternalValue());
+  EncodeMetaInfo(node->GetMetaInfoMap(), pickle);
+  pickle->WriteInt64(node->sync_transaction_version());
+  if (node->is_folder())
+    EncodeChildren(node, pickle);
+}
+
+void BookmarkBinaryCodec::EncodeChildren(const BookmarkNode* node,
+                                         base::Pickle* pickle) {
+  pickle->WriteInt(base::checked_cast<int>(node->children().size()));
+  for (const auto& child : node->children())
+    EncodeNode(child.get(), pickle);
+}
+
+void BookmarkBinaryCodec::EncodeMetaInfo(
+    const BookmarkNode::MetaInfoMap* meta_info_map,
+    base::Pickle* pickle) {
+  if (!meta_info_map) {
+    pickle->WriteInt(0);
+    return;
+  }
+  pickle->WriteInt(base::checked_cast<int>(meta_info_map->size()));
+  for (const auto& key_value : *meta_info_map) {
+    pickle->WriteString(key_value.first);
+    pickle->WriteString(key_value.second);
+  }
+}
+
+bool BookmarkBinaryCodec::DecodePermanentNode(base::PickleIterator* iter,
+                                              BookmarkNode* node,
+                                              PermanentNodeFields* fields) {
+  if (!iter->ReadInt64(&fields->id) || !ids_.insert(fields->id).second)
+    return false;
+  maximum_id_ = std::max(maximum_id_, fields->id);
+  return iter->ReadInt64(&fields->date_added) &&
+         iter->ReadInt64(&fields->date_folder_modified) &&
+         DecodeMetaInfo(iter, &fields->meta_info_map) &&
+         iter->ReadInt64(&fields->sync_transaction_version) &&
+         DecodeChildren(iter, node, 1);
+}
+
+bool BookmarkBinaryCodec::DecodeNode(base::PickleIterator* iter,
+                                     BookmarkNode* parent,
+                                     int depth) {
+  bool is_url;
+  int64_t id;
+  std::string guid;
+  base::string16 title;
+  int64_t date_added;
+  if (!iter->ReadBool(&is_url) || !iter->ReadInt64(&id) ||
+      !iter->ReadString(&guid) || !iter->ReadString16(&title) ||
+      !iter->ReadInt64(&date_added)) {
+    return false;
+  }
+  if (!ids_.insert(id).second || !base::IsValidGUID(guid) ||
+      !guids_.insert(guid).second) {
+    return false;
+  }
+  maximum_id_ = std::max(maximum_id_, id);
+
+  std::unique_ptr<BookmarkNode> node;
+  if (is_url) {
+    std::string url_string;
+    if (!iter->ReadString(&url_string))
+      return false;
+    GURL url(url_string);
+    if (!url.is_valid())
+      return false;
+    node = std::make_unique<BookmarkNode>(id, guid, url);
+  } else {
+    int64_t date_folder_modified;
+    if (!iter->ReadInt64(&date_folder_modified))
+      return false;
+    node = std::make_unique<BookmarkNode>(id, guid, GURL());
+    node->set_date_folder_modified(
+        Time::FromInternalValue(date_folder_modified));
+  }
+  node->SetTitle(title);
+  node->set_date_added(Time::FromInternalValue(date_added));
+
+  BookmarkNode::MetaInfoMap meta_info_map;
+  int64_t sync_transaction_version;
+  if (!DecodeMetaInfo(iter, &meta_info_map) ||
+      !iter->ReadInt64(&sync_transaction_version)) {
+    return false;
+  }
+  node->SetMetaInfoMap(meta_info_map);
+  node->set_sync_transaction_version(sync_transaction_version);
+
+  BookmarkNode* added_node = parent->Add(std::move(node));
+  return is_url || DecodeChildren(iter, added_node, depth + 1);
+}
+
+bool BookmarkBinaryCodec::DecodeChildren(base::PickleIterator* iter,
+                                         BookmarkNode* parent,
+                                         int depth) {
+  int child_count;
+  if (depth > kMaxDepth || !iter->ReadInt(&child_count) || child_count < 0)
+    return false;
+  for (int i = 0; i < child_count; ++i) {
+    if (!DecodeNode(iter, parent, depth))
+      return false;
+  }
+  return true;
+}
+
+bool BookmarkBinaryCodec::DecodeMetaInfo(
+    base::PickleIterator* iter,
+    BookmarkNode::MetaInfoMap* meta_info_map) {
+  int count;
+  if (!iter->ReadInt(&count) || count < 0)
+    return false;
+  for (int i = 0; i < count; ++i) {
+    std::string key;
+    std::string value;
+    if (!iter->ReadString(&key) || !iter->ReadString(&value))
+      return false;
+    (*meta_info_map)[key] = value;
+  }
+  return true;
+}
+
+}  // namespace bookmarks
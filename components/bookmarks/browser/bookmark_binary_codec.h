@@ -0,0 +1,119 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef COMPONENTS_BOOKMARKS_BROWSER_BOOKMARK_BINARY_CODEC_H_
+#define COMPONENTS_BOOKMARKS_BROWSER_BOOKMARK_BINARY_CODEC_H_
+
+#include <stdint.h>
+
+#include <set>
+#include <string>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "components/bookmarks/browser/bookmark_node.h"
+
+namespace base {
+class Pickle;
+class PickleIterator;
+}  // namespace base
+
+namespace bookmarks {
+
+class BookmarkModel;
+
+// BookmarkBinaryCodec encodes the same data as BookmarkCodec in a binary form
+// that is much quicker to decode than JSON. BookmarkStorage keeps such a copy
+// of the bookmarks file next to it, so that loading usually needs neither JSON
+// parsing nor checksumming.
+//
+// Unlike BookmarkCodec, the binary form is not meant to be edited or kept
+// across versions: decoding fails on anything unexpected, and the bookmarks
+// file is decoded instead.
+class BookmarkBinaryCodec {
+ public:
+  BookmarkBinaryCodec();
+  ~BookmarkBinaryCodec();
+
+  // Encodes the model along with |sync_metadata_str|, and |checksum| which
+  // should be the checksum of the matching JSON encoding.
+  std::string Encode(BookmarkModel* model,
+                     const std::string& sync_metadata_str,
+                     const std::string& checksum);
+
+  // Encodes the bookmark bar, other and mobile folders.
+  std::string Encode(const BookmarkNode* bookmark_bar_node,
+                     const BookmarkNode* other_folder_node,
+                     const BookmarkNode* mobile_folder_node,
+                     const BookmarkNode::MetaInfoMap* model_meta_info_map,
+                     int64_t sync_transaction_version,
+                     const std::string& sync_metadata_str,
+                     const std::string& checksum);
+
+  // Decodes |data| into the specified nodes, which must have no children, and
+  // sets |max_node_id| to the greatest node id. Returns true on success. On
+  // failure the nodes are left as they were.
+  bool Decode(base::StringPiece data,
+              BookmarkNode* bb_node,
+              BookmarkNode* other_folder_node,
+              BookmarkNode* mobile_folder_node,
+              int64_t* max_node_id,
+              std::string* sync_metadata_str);
+
+  // Returns the checksum passed to the last Encode() call, or the one stored
+  // in the data after a successful Decode() call.
+  const std::string& checksum() const { return checksum_; }
+
+  // Return meta info of bookmark model root.
+  const BookmarkNode::MetaInfoMap& model_meta_info_map() const {
+    return model_meta_info_map_;
+  }
+
+  // Return the sync transaction version of the bookmark model root.
+  int64_t model_sync_transaction_version() const {
+    return model_sync_transaction_version_;
+  }
+
+ private:
+  // The fields of a permanent node, applied once decoding succeeds.
+  struct PermanentNodeFields;
+
+  void EncodeNode(const BookmarkNode* node, base::Pickle* pickle);
+  void EncodeChildren(const BookmarkNode* node, base::Pickle* pickle);
+  void EncodeMetaInfo(const BookmarkNode::MetaInfoMap* meta_info_map,
+                      base::Pickle* pickle);
+
+  bool DecodePermanentNode(base::PickleIterator* iter,
+                           BookmarkNode* node,
+                           PermanentNodeFields* fields);
+  // Decodes a node and adds it to |parent|. |depth| is the depth of |parent|.
+  bool DecodeNode(base::PickleIterator* iter, BookmarkNode* parent, int depth);
+  bool DecodeChildren(base::PickleIterator* iter,
+                      BookmarkNode* parent,
+                      int depth);
+  bool DecodeMetaInfo(base::PickleIterator* iter,
+                      BookmarkNode::MetaInfoMap* meta_info_map);
+
+  std::string checksum_;
+
+  // The ids and GUIDs found while decoding. Duplicates fail the decoding.
+  std::set<int64_t> ids_;
+  std::set<std::string> guids_;
+
+  // Maximum ID found when decoding data.
+  int64_t maximum_id_ = 0;
+
+  // Meta info set on bookmark model root.
+  BookmarkNode::MetaInfoMap model_meta_info_map_;
+
+  // Sync transaction version set on bookmark model root.
+  int64_t model_sync_transaction_version_ =
+      BookmarkNode::kInvalidSyncTransactionVersion;
+
+  DISALLOW_COPY_AND_ASSIGN(BookmarkBinaryCodec);
+};
+
+}  // namespace bookmarks
+
+#endif  // COMPONENTS_BOOKMARKS_BROWSER_BOOKMARK_BINARY_CODEC_H_
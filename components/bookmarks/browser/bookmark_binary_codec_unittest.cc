@@ -0,0 +1,166 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/bookmarks/browser/bookmark_binary_codec.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/guid.h"
+#include "base/strings/utf_string_conversions.h"
+#include "components/bookmarks/browser/bookmark_model.h"
+#include "components/bookmarks/test/test_bookmark_client.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::ASCIIToUTF16;
+
+namespace bookmarks {
+namespace {
+
+const char kChecksum[] = "0123456789abcdef";
+const char kSyncMetadata[] = "sync metadata";
+
+// Helper to get a mutable bookmark node.
+BookmarkNode* AsMutable(const BookmarkNode* node) {
+  return const_cast<BookmarkNode*>(node);
+}
+
+// Helper to verify the two given bookmark nodes.
+void AssertNodesEqual(const BookmarkNode* expected,
+                      const BookmarkNode* actual) {
+  ASSERT_TRUE(expected);
+  ASSERT_TRUE(actual);
+  EXPECT_EQ(expected->id(), actual->id());
+  EXPECT_EQ(expected->guid(), actual->guid());
+  EXPECT_EQ(expected->GetTitle(), actual->GetTitle());
+  EXPECT_EQ(expected->type(), actual->type());
+  EXPECT_EQ(expected->date_added(), actual->date_added());
+  EXPECT_EQ(expected->sync_transaction_version(),
+            actual->sync_transaction_version());
+  if (expected->GetMetaInfoMap()) {
+    ASSERT_TRUE(actual->GetMetaInfoMap());
+    EXPECT_EQ(*expected->GetMetaInfoMap(), *actual->GetMetaInfoMap());
+  } else {
+    EXPECT_FALSE(actual->GetMetaInfoMap());
+  }
+  if (expected->is_url()) {
+    EXPECT_EQ(expected->url(), actual->url());
+  } else {
+    EXPECT_EQ(expected->date_folder_modified(),
+              actual->date_folder_modified());
+    ASSERT_EQ(expected->children().size(), actual->children().size());
+    for (size_t i = 0; i < expected->children().size(); ++i) {
+      AssertNodesEqual(expected->children()[i].get(),
+                       actual->children()[i].get());
+    }
+  }
+}
+
+std::unique_ptr<BookmarkModel> CreateTestModel() {
+  std::unique_ptr<BookmarkModel> model(TestBookmarkClient::CreateModel());
+  const BookmarkNode* bookmark_bar = model->bookmark_bar_node();
+  model->AddURL(bookmark_bar, 0, ASCIIToUTF16("url1"),
+                GURL("http://www.url1.com"));
+  const BookmarkNode* folder =
+      model->AddFolder(bookmark_bar, 1, ASCIIToUTF16("folder"));
+  const BookmarkNode* url2 = model->AddURL(folder, 0, ASCIIToUTF16("url2"),
+                                           GURL("http://www.url2.com"));
+  model->AddURL(model->other_node(), 0, ASCIIToUTF16("url3"),
+                GURL("http://www.url3.com/path?query"));
+  model->AddFolder(model->mobile_node(), 0, ASCIIToUTF16("empty"));
+  model->SetNodeMetaInfo(model->root_node(), "model_info", "value1");
+  model->SetNodeMetaInfo(url2, "node_info", "value2");
+  model->SetNodeSyncTransactionVersion(model->root_node(), 1);
+  model->SetNodeSyncTransactionVersion(folder, 42);
+  return model;
+}
+
+bool Decode(BookmarkBinaryCodec* codec,
+            const std::string& data,
+            BookmarkModel* model,
+            int64_t* max_id,
+            std::string* sync_metadata_str) {
+  return codec->Decode(data, AsMutable(model->bookmark_bar_node()),
+                       AsMutable(model->other_node()),
+                       AsMutable(model->mobile_node()), max_id,
+                       sync_metadata_str);
+}
+
+}  // namespace
+
+TEST(BookmarkBinaryCodecTest, EncodeAndDecode) {
+  std::unique_ptr<BookmarkModel> model = CreateTestModel();
+  BookmarkBinaryCodec encoder;
+  const std::string data =
+      encoder.Encode(model.get(), kSyncMetadata, kChecksum);
+  EXPECT_EQ(kChecksum, encoder.checksum());
+
+  std::unique_ptr<BookmarkModel> decoded_model(
+      TestBookmarkClient::CreateModel());
+  BookmarkBinaryCodec decoder;
+  int64_t max_id = 0;
+  std::string sync_metadata_str;
+  ASSERT_TRUE(Decode(&decoder, data, decoded_model.get(), &max_id,
+                     &sync_metadata_str));
+
+  EXPECT_EQ(kChecksum, decoder.checksum());
+  EXPECT_EQ(kSyncMetadata, sync_metadata_str);
+  EXPECT_EQ(*model->root_node()->GetMetaInfoMap(),
+            decoder.model_meta_info_map());
+  EXPECT_EQ(1, decoder.model_sync_transaction_version());
+  EXPECT_EQ(model->next_node_id(), max_id);
+  ASSERT_NO_FATAL_FAILURE(AssertNodesEqual(model->bookmark_bar_node(),
+                                           decoded_model->bookmark_bar_node()));
+  ASSERT_NO_FATAL_FAILURE(
+      AssertNodesEqual(model->other_node(), decoded_model->other_node()));
+  ASSERT_NO_FATAL_FAILURE(
+      AssertNodesEqual(model->mobile_node(), decoded_model->mobile_node()));
+}
+
+TEST(BookmarkBinaryCodecTest, RejectTruncatedData) {
+  std::unique_ptr<BookmarkModel> model = CreateTestModel();
+  const std::string data =
+      BookmarkBinaryCodec().Encode(model.get(), kSyncMetadata, kChecksum);
+
+  // Cut the data short at a few points, including inside the last folder.
+  for (size_t size : {size_t{0}, size_t{4}, data.size() / 2, data.size() - 1}) {
+    SCOPED_TRACE(size);
+    std::unique_ptr<BookmarkModel> decoded_model(
+        TestBookmarkClient::CreateModel());
+    const int64_t bookmark_bar_id = decoded_model->bookmark_bar_node()->id();
+    BookmarkBinaryCodec decoder;
+    int64_t max_id = 0;
+    EXPECT_FALSE(Decode(&decoder, data.substr(0, size), decoded_model.get(),
+                        &max_id, nullptr));
+    EXPECT_TRUE(decoded_model->bookmark_bar_node()->children().empty());
+    EXPECT_TRUE(decoded_model->other_node()->children().empty());
+    EXPECT_TRUE(decoded_model->mobile_node()->children().empty());
+    EXPECT_EQ(bookmark_bar_id, decoded_model->bookmark_bar_node()->id());
+    EXPECT_EQ(0, max_id);
+  }
+}
+
+TEST(BookmarkBinaryCodecTest, RejectDuplicateIds) {
+  BookmarkNode bookmark_bar(1, BookmarkNode::kBookmarkBarNodeGuid, GURL());
+  BookmarkNode other(2, BookmarkNode::kOtherBookmarksNodeGuid, GURL());
+  BookmarkNode mobile(3, BookmarkNode::kMobileBookmarksNodeGuid, GURL());
+  // Reuses the id of |other|.
+  bookmark_bar.Add(std::make_unique<BookmarkNode>(2, base::GenerateGUID(),
+                                                  GURL("http://www.dup.com")));
+  const std::string data = BookmarkBinaryCodec().Encode(
+      &bookmark_bar, &other, &mobile, /*model_meta_info_map=*/nullptr,
+      BookmarkNode::kInvalidSyncTransactionVersion, kSyncMetadata, kChecksum);
+
+  std::unique_ptr<BookmarkModel> decoded_model(
+      TestBookmarkClient::CreateModel());
+  BookmarkBinaryCodec decoder;
+  EXPECT_FALSE(Decode(&decoder, data, decoded_model.get(), nullptr, nullptr));
+  EXPECT_TRUE(decoded_model->bookmark_bar_node()->children().empty());
+  EXPECT_TRUE(decoded_model->other_node()->children().empty());
+}
+
+}  // namespace bookmarks
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -18,6 +19,7 @@
 #include "base/macros.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/strings/string_util.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "components/bookmarks/browser/bookmark_expanded_state_tracker.h"
 #include "components/bookmarks/browser/bookmark_model_observer.h"
 #include "components/bookmarks/browser/bookmark_node_data.h"
@@ -209,6 +211,7 @@ void BookmarkModel::Remove(const BookmarkNode* node) {
   for (BookmarkModelObserver& observer : observers_)
     observer.OnWillRemoveBookmarks(this, parent, index, node);
 
+  EnsureIndexBuilt();
   std::set<GURL> removed_urls;
   std::unique_ptr<BookmarkNode> owned_node =
       url_index_->Remove(AsMutable(node), &removed_urls);
@@ -236,6 +239,7 @@ void BookmarkModel::RemoveAllUserBookmarks() {
   for (BookmarkModelObserver& observer : observers_)
     observer.OnWillRemoveAllUserBookmarks(this);
 
+  EnsureIndexBuilt();
   BeginExtensiveChanges();
   // Skip deleting permanent nodes. Permanent bookmark nodes are the root and
   // its immediate children. For removing all non permanent nodes just remove
@@ -361,6 +365,7 @@ void BookmarkModel::SetTitle(const BookmarkNode* node,
   // The title index doesn't support changing the title, instead we remove then
   // add it back. Only do this for URL nodes. A directory node can have its
   // title changed but should be excluded from the index.
+  EnsureIndexBuilt();
   if (node->is_url())
     index_->Remove(node);
   AsMutable(node)->SetTitle(title);
@@ -387,6 +392,7 @@ void BookmarkModel::SetURL(const BookmarkNode* node, const GURL& url) {
   for (BookmarkModelObserver& observer : observers_)
     observer.OnWillChangeBookmarkNode(this, node);
 
+  EnsureIndexBuilt();
   index_->Remove(mutable_node);
   url_index_->SetUrl(mutable_node, url);
   AddNodeToIndexRecursive(mutable_node);
@@ -703,6 +709,7 @@ void BookmarkModel::GetBookmarksMatching(
   if (!loaded_)
     return;
 
+  EnsureIndexBuilt();
   index_->GetResultsMatching(text, max_count, matching_algorithm, matches);
 }
 
@@ -810,11 +817,21 @@ void BookmarkModel::DoneLoading(std::unique_ptr<BookmarkLoadDetails> details) {
   // Notify our direct observers.
   for (BookmarkModelObserver& observer : observers_)
     observer.BookmarkModelLoaded(this, details->ids_reassigned());
+
+  if (details->index_deferred()) {
+    // The model is usable already; the index is only needed once titles are
+    // searched or bookmarks change, and is built in the meantime.
+    nodes_to_index_.push_back(root_);
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(&BookmarkModel::BuildIndexSlice,
+                                  weak_factory_.GetWeakPtr()));
+  }
 }
 
 BookmarkNode* BookmarkModel::AddNode(BookmarkNode* parent,
                                      size_t index,
                                      std::unique_ptr<BookmarkNode> node) {
+  EnsureIndexBuilt();
   BookmarkNode* node_ptr = node.get();
   url_index_->Add(parent, index, std::move(node));
 
@@ -836,6 +853,39 @@ void BookmarkModel::AddNodeToIndexRecursive(BookmarkNode* node) {
     AddNodeToIndexRecursive(child.get());
 }
 
+bool BookmarkModel::IndexPendingNodes(size_t max_count) {
+  size_t count = 0;
+  while (!nodes_to_index_.empty() && count < max_count) {
+    BookmarkNode* node = nodes_to_index_.back();
+    nodes_to_index_.pop_back();
+    if (node->is_url()) {
+      if (node->url().is_valid()) {
+        index_->Add(node);
+        ++count;
+      }
+    } else {
+      for (const auto& child : node->children())
+        nodes_to_index_.push_back(child.get());
+    }
+  }
+  return nodes_to_index_.empty();
+}
+
+void BookmarkModel::BuildIndexSlice() {
+  // Enough to keep each task short on slow devices.
+  constexpr size_t kNodesPerSlice = 1000;
+  if (!IndexPendingNodes(kNodesPerSlice)) {
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(&BookmarkModel::BuildIndexSlice,
+                                  weak_factory_.GetWeakPtr()));
+  }
+}
+
+void BookmarkModel::EnsureIndexBuilt() {
+  if (!nodes_to_index_.empty())
+    IndexPendingNodes(std::numeric_limits<size_t>::max());
+}
+
 bool BookmarkModel::IsValidIndex(const BookmarkNode* parent,
                                  size_t index,
                                  bool allow_end) {
@@ -342,6 +342,18 @@ class BookmarkModel : public BookmarkUndoProvider,
   // Adds |node| to |index_| and recursisvely invokes this for all children.
   void AddNodeToIndexRecursive(BookmarkNode* node);
 
+  // Adds the URL nodes under |nodes_to_index_| to |index_|, stopping after
+  // |max_count| of them if there are more. Returns true if all nodes are
+  // indexed.
+  bool IndexPendingNodes(size_t max_count);
+
+  // Indexes a slice of |nodes_to_index_| and posts a task for the next one.
+  void BuildIndexSlice();
+
+  // Finishes indexing |nodes_to_index_|. Must be called before |index_| is
+  // queried or updated.
+  void EnsureIndexBuilt();
+
   // Returns true if the parent and index are valid.
   bool IsValidIndex(const BookmarkNode* parent, size_t index, bool allow_end);
 
@@ -410,6 +422,10 @@ class BookmarkModel : public BookmarkUndoProvider,
 
   std::unique_ptr<TitledUrlIndex> index_;
 
+  // Nodes whose subtrees are not yet in |index_|, when the index is built after
+  // loading.
+  std::vector<BookmarkNode*> nodes_to_index_;
+
   // Owned by |model_loader_|.
   // WARNING: in some tests this does *not* refer to
   // |ModelLoader::history_bookmark_model_|. This is because some tests
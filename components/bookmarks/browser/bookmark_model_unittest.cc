@@ -17,6 +17,7 @@
 #include "base/base_paths.h"
 #include "base/command_line.h"
 #include "base/compiler_specific.h"
+#include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/guid.h"
 #include "base/run_loop.h"
@@ -26,15 +27,18 @@
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/task_environment.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/time/time.h"
 #include "components/bookmarks/browser/bookmark_model_observer.h"
+#include "components/bookmarks/browser/bookmark_storage.h"
 #include "components/bookmarks/browser/bookmark_undo_delegate.h"
 #include "components/bookmarks/browser/bookmark_utils.h"
 #include "components/bookmarks/browser/titled_url_match.h"
 #include "components/bookmarks/browser/url_and_title.h"
 #include "components/bookmarks/test/bookmark_test_helpers.h"
+#include "components/bookmarks/common/bookmark_constants.h"
 #include "components/bookmarks/test/test_bookmark_client.h"
 #include "components/favicon_base/favicon_callback.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -1259,6 +1263,67 @@ TEST(BookmarkModelLoadTest, TitledUrlIndexPopulatedOnLoad) {
   EXPECT_EQ(node_url, matches[0].node->GetTitledUrlNodeUrl());
 }
 
+// Verifies that with kFastBookmarkLoad the bookmarks are loaded from the
+// binary copy of the file while it is up to date, and are searchable at once.
+TEST(BookmarkModelLoadTest, FastLoadUsesCacheWhileUpToDate) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(kFastBookmarkLoad);
+  base::ScopedTempDir tmp_dir;
+  ASSERT_TRUE(tmp_dir.CreateUniqueTempDir());
+  const base::FilePath path = tmp_dir.GetPath().Append(kBookmarksFileName);
+  base::test::TaskEnvironment task_environment;
+  std::unique_ptr<BookmarkModel> model =
+      std::make_unique<BookmarkModel>(std::make_unique<TestBookmarkClient>());
+  model->Load(nullptr, tmp_dir.GetPath(), base::ThreadTaskRunnerHandle::Get(),
+              base::ThreadTaskRunnerHandle::Get());
+  test::WaitForBookmarkModelToLoad(model.get());
+  const GURL node_url("http://google.com");
+  model->AddURL(model->bookmark_bar_node(), 0, base::ASCIIToUTF16("User"),
+                node_url);
+  // This is necessary to ensure the save is scheduled.
+  base::RunLoop().RunUntilIdle();
+  // Deleting the model writes the file, and then its binary copy.
+  model.reset();
+  base::RunLoop().RunUntilIdle();
+  ASSERT_TRUE(base::PathExists(GetBookmarksCachePath(path)));
+
+  // Replace the file with garbage that has the same size and modification
+  // time, which only the binary copy can be loaded in place of.
+  base::File::Info info;
+  ASSERT_TRUE(base::GetFileInfo(path, &info));
+  const std::string garbage(static_cast<size_t>(info.size), 'x');
+  ASSERT_EQ(info.size, base::WriteFile(path, garbage.data(), garbage.size()));
+  ASSERT_TRUE(base::TouchFile(path, info.last_accessed, info.last_modified));
+
+  model =
+      std::make_unique<BookmarkModel>(std::make_unique<TestBookmarkClient>());
+  model->Load(nullptr, tmp_dir.GetPath(), base::ThreadTaskRunnerHandle::Get(),
+              base::ThreadTaskRunnerHandle::Get());
+  test::WaitForBookmarkModelToLoad(model.get());
+  EXPECT_TRUE(model->IsBookmarked(node_url));
+
+  // The index is built after loading, but must be complete when queried.
+  std::vector<TitledUrlMatch> matches;
+  model->GetBookmarksMatching(base::ASCIIToUTF16("user"), 1,
+                              query_parser::MatchingAlgorithm::DEFAULT,
+                              &matches);
+  ASSERT_EQ(1u, matches.size());
+  EXPECT_EQ(node_url, matches[0].node->GetTitledUrlNodeUrl());
+  model.reset();
+  base::RunLoop().RunUntilIdle();
+
+  // A file changed behind the model's back makes the binary copy stale.
+  const std::string empty_file = "{}";
+  ASSERT_EQ(static_cast<int>(empty_file.size()),
+            base::WriteFile(path, empty_file.data(), empty_file.size()));
+  model =
+      std::make_unique<BookmarkModel>(std::make_unique<TestBookmarkClient>());
+  model->Load(nullptr, tmp_dir.GetPath(), base::ThreadTaskRunnerHandle::Get(),
+              base::ThreadTaskRunnerHandle::Get());
+  test::WaitForBookmarkModelToLoad(model.get());
+  EXPECT_FALSE(model->IsBookmarked(node_url));
+}
+
 TEST(BookmarkNodeTest, NodeMetaInfo) {
   GURL url;
   BookmarkNode node(/*id=*/0, base::GenerateGUID(), url);
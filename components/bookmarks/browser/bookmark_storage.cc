@@ -19,8 +19,12 @@
 #include "base/metrics/histogram_functions.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/numerics/safe_conversions.h"
+#include "base/pickle.h"
 #include "base/sequenced_task_runner.h"
+#include "base/strings/string_piece.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "base/time/time.h"
+#include "components/bookmarks/browser/bookmark_binary_codec.h"
 #include "components/bookmarks/browser/bookmark_codec.h"
 #include "components/bookmarks/browser/bookmark_model.h"
 #include "components/bookmarks/browser/bookmark_node.h"
@@ -34,11 +38,17 @@ using base::TimeTicks;
 
 namespace bookmarks {
 
+const base::Feature kFastBookmarkLoad{"FastBookmarkLoad",
+                                      base::FEATURE_DISABLED_BY_DEFAULT};
+
 namespace {
 
 // Extension used for backup files (copy of main file created during startup).
 const base::FilePath::CharType kBackupExtension[] = FILE_PATH_LITERAL("bak");
 
+// Extension used for the binary copy of the bookmarks file.
+const base::FilePath::CharType kCacheExtension[] = FILE_PATH_LITERAL("cache");
+
 // How often we save.
 const int kSaveDelayMS = 2500;
 
@@ -47,6 +57,97 @@ void BackupCallback(const base::FilePath& path) {
   base::CopyFile(path, backup_path);
 }
 
+// Gets the size and modification time of the bookmarks file at |path|. The
+// binary copy stores them, and is only used while they are unchanged.
+bool GetBookmarksFileStamp(const base::FilePath& path,
+                           int64_t* size,
+                           int64_t* last_modified) {
+  base::File::Info info;
+  if (!base::GetFileInfo(path, &info))
+    return false;
+  *size = info.size;
+  *last_modified = info.last_modified.ToInternalValue();
+  return true;
+}
+
+// Writes |payload|, the binary encoding of the bookmarks file at |path|, next
+// to it. Must run after the bookmarks file is written.
+void WriteBookmarksCache(const base::FilePath& path,
+                         const std::string& payload) {
+  base::FilePath cache_path = GetBookmarksCachePath(path);
+  int64_t size;
+  int64_t last_modified;
+  if (!GetBookmarksFileStamp(path, &size, &last_modified)) {
+    base::DeleteFile(cache_path, false);
+    return;
+  }
+  base::Pickle pickle;
+  pickle.WriteInt64(size);
+  pickle.WriteInt64(last_modified);
+  pickle.WriteString(payload);
+  if (!base::ImportantFileWriter::WriteFileAtomically(
+          cache_path, base::StringPiece(static_cast<const char*>(pickle.data()),
+                                        pickle.size()))) {
+    base::DeleteFile(cache_path, false);
+  }
+}
+
+// Called once BookmarkStorage has written the bookmarks file at |path|.
+void OnBookmarksWritten(const base::FilePath& path,
+                        const std::string& payload,
+                        bool success) {
+  if (success)
+    WriteBookmarksCache(path, payload);
+  else
+    base::DeleteFile(GetBookmarksCachePath(path), false);
+}
+
+// Loads the bookmarks from the binary copy of the bookmarks file at |path|.
+// Returns false if the copy is missing, stale or can't be decoded, in which
+// case |details| is unchanged.
+bool LoadBookmarksFromCache(const base::FilePath& path,
+                            BookmarkLoadDetails* details) {
+  std::string data;
+  int64_t size;
+  int64_t last_modified;
+  if (!base::ReadFileToString(GetBookmarksCachePath(path), &data) ||
+      !GetBookmarksFileStamp(path, &size, &last_modified)) {
+    return false;
+  }
+
+  base::Pickle pickle(data.data(), data.size());
+  base::PickleIterator iter(pickle);
+  int64_t cached_size;
+  int64_t cached_last_modified;
+  base::StringPiece payload;
+  if (!iter.ReadInt64(&cached_size) || !iter.ReadInt64(&cached_last_modified) ||
+      cached_size != size || cached_last_modified != last_modified ||
+      !iter.ReadStringPiece(&payload)) {
+    return false;
+  }
+
+  int64_t max_node_id = 0;
+  std::string sync_metadata_str;
+  BookmarkBinaryCodec codec;
+  TimeTicks start_time = TimeTicks::Now();
+  if (!codec.Decode(payload, details->bb_node(), details->other_folder_node(),
+                    details->mobile_folder_node(), &max_node_id,
+                    &sync_metadata_str)) {
+    return false;
+  }
+  details->set_sync_metadata_str(std::move(sync_metadata_str));
+  details->set_max_id(std::max(max_node_id, details->max_id()));
+  // The copy is only written for files whose checksum matched.
+  details->set_computed_checksum(codec.checksum());
+  details->set_stored_checksum(codec.checksum());
+  details->set_model_meta_info_map(codec.model_meta_info_map());
+  details->set_model_sync_transaction_version(
+      codec.model_sync_transaction_version());
+  UMA_HISTOGRAM_TIMES("Bookmarks.DecodeCacheTime",
+                      TimeTicks::Now() - start_time);
+  return true;
+}
+
 // Adds node to the model's index, recursing through all children as well.
 void AddBookmarksToIndex(BookmarkLoadDetails* details,
                          BookmarkNode* node) {
@@ -111,12 +212,20 @@ int GetNumNodesWithEmptyTitle(const BookmarkNode* node) {
 
 }  // namespace
 
+base::FilePath GetBookmarksCachePath(const base::FilePath& bookmarks_path) {
+  return bookmarks_path.ReplaceExtension(kCacheExtension);
+}
+
 void LoadBookmarks(const base::FilePath& path,
                    bool emit_experimental_uma,
+                   bool fast_load,
                    BookmarkLoadDetails* details) {
   bool load_index = false;
   bool bookmark_file_exists = base::PathExists(path);
-  if (bookmark_file_exists) {
+  if (bookmark_file_exists && fast_load &&
+      LoadBookmarksFromCache(path, details)) {
+    load_index = true;
+  } else if (bookmark_file_exists) {
     // Titles may end up containing invalid utf and we shouldn't throw away
     // all bookmarks if some titles have invalid utf.
     JSONFileValueDeserializer deserializer(
@@ -145,6 +254,23 @@ void LoadBookmarks(const base::FilePath& path,
           codec.model_sync_transaction_version());
       UMA_HISTOGRAM_TIMES("Bookmarks.DecodeTime",
                           TimeTicks::Now() - start_time);
+      if (fast_load &&
+          codec.computed_checksum() == codec.stored_checksum() &&
+          !codec.ids_reassigned() && !codec.guids_reassigned()) {
+        // The file is missing its binary copy, or the copy is stale. Encode it
+        // now, while the tree is still ours, and write it after the load.
+        BookmarkBinaryCodec binary_codec;
+        base::SequencedTaskRunnerHandle::Get()->PostTask(
+            FROM_HERE,
+            base::BindOnce(
+                &WriteBookmarksCache, path,
+                binary_codec.Encode(
+                    details->bb_node(), details->other_folder_node(),
+                    details->mobile_folder_node(),
+                    &details->model_meta_info_map(),
+                    details->model_sync_transaction_version(),
+                    details->sync_metadata_str(), codec.computed_checksum())));
+      }
       int64_t size = 0;
       if (base::GetFileSize(path, &size)) {
         int64_t size_kb = size / 1024;
@@ -163,8 +289,11 @@ void LoadBookmarks(const base::FilePath& path,
     load_index = true;
 
   // Load any extra root nodes now, after the IDs have been potentially
-  // reassigned.
-  if (load_index) {
+  // reassigned. With |fast_load| BookmarkModel builds the index instead, in
+  // slices on the main thread, so that the model is usable sooner.
+  if (load_index && fast_load) {
+    details->set_index_deferred(true);
+  } else if (load_index) {
     TimeTicks start_time = TimeTicks::Now();
     AddBookmarksToIndex(details, details->root_node());
     UMA_HISTOGRAM_TIMES("Bookmarks.CreateBookmarkIndexTime",
@@ -281,7 +410,8 @@ BookmarkStorage::BookmarkStorage(
               sequenced_task_runner,
               base::TimeDelta::FromMilliseconds(kSaveDelayMS),
               "BookmarkStorage"),
-      sequenced_task_runner_(sequenced_task_runner) {}
+      sequenced_task_runner_(sequenced_task_runner),
+      write_cache_(base::FeatureList::IsEnabled(kFastBookmarkLoad)) {}
 
 BookmarkStorage::~BookmarkStorage() {
   if (writer_.HasPendingWrite())
@@ -322,11 +452,25 @@ void BookmarkStorage::BookmarkModelDeleted() {
 
 bool BookmarkStorage::SerializeData(std::string* output) {
   BookmarkCodec codec;
-  std::unique_ptr<base::Value> value(
-      codec.Encode(model_, model_->client()->EncodeBookmarkSyncMetadata()));
+  const std::string sync_metadata_str =
+      model_->client()->EncodeBookmarkSyncMetadata();
+  std::unique_ptr<base::Value> value(codec.Encode(model_, sync_metadata_str));
   JSONStringValueSerializer serializer(output);
   serializer.set_pretty_print(true);
-  return serializer.Serialize(*(value.get()));
+  if (!serializer.Serialize(*(value.get())))
+    return false;
+
+  if (write_cache_) {
+    // Rewrite the binary copy once the file is written, so that the copy is
+    // stamped with the new file.
+    BookmarkBinaryCodec binary_codec;
+    writer_.RegisterOnNextWriteCallbacks(
+        base::OnceClosure(),
+        base::BindOnce(&OnBookmarksWritten, writer_.path(),
+                       binary_codec.Encode(model_, sync_metadata_str,
+                                           codec.computed_checksum())));
+  }
+  return true;
 }
 
 bool BookmarkStorage::SaveNow() {
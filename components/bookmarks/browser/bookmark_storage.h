@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "base/callback_forward.h"
+#include "base/feature_list.h"
 #include "base/files/file_path.h"
 #include "base/files/important_file_writer.h"
 #include "base/macros.h"
@@ -32,6 +33,15 @@ class BookmarkModel;
 class BookmarkNode;
 class UrlIndex;
 
+// When enabled, BookmarkStorage keeps a binary copy of the bookmarks file (see
+// BookmarkBinaryCodec) that is loaded instead of the JSON file while it is up
+// to date, and the title index is built on the main thread after loading.
+extern const base::Feature kFastBookmarkLoad;
+
+// Returns the path of the binary copy of the bookmarks file at
+// |bookmarks_path|.
+base::FilePath GetBookmarksCachePath(const base::FilePath& bookmarks_path);
+
 // A callback that generates a std::unique_ptr<BookmarkPermanentNode>, given a
 // max ID to use. The max ID argument will be updated after if a new node has
 // been created and assigned an ID.
@@ -111,6 +121,10 @@ class BookmarkLoadDetails {
   }
   const std::string& sync_metadata_str() const { return sync_metadata_str_; }
 
+  // Whether |index()| was left empty, for BookmarkModel to fill once loaded.
+  void set_index_deferred(bool value) { index_deferred_ = value; }
+  bool index_deferred() const { return index_deferred_; }
+
   void CreateUrlIndex();
   UrlIndex* url_index() { return url_index_.get(); }
 
@@ -134,6 +148,7 @@ class BookmarkLoadDetails {
   std::string stored_checksum_;
   bool ids_reassigned_ = false;
   bool guids_reassigned_ = false;
+  bool index_deferred_ = false;
   scoped_refptr<UrlIndex> url_index_;
   // A string blob represetning the sync metadata stored in the json file.
   std::string sync_metadata_str_;
@@ -144,9 +159,12 @@ class BookmarkLoadDetails {
 // Loads the bookmarks. This is intended to be called on the background thread.
 // Updates state in |details| based on the load. |emit_experimental_uma|
 // determines whether a few newly introduced and experimental UMA metrics should
-// be logged.
+// be logged. If |fast_load| is true, the bookmarks are read from the binary
+// copy of the file when it is up to date, a missing or stale copy is written,
+// and building the title index is left to BookmarkModel.
 void LoadBookmarks(const base::FilePath& profile_path,
                    bool emit_experimental_uma,
+                   bool fast_load,
                    BookmarkLoadDetails* details);
 
 // BookmarkStorage handles reading/write the bookmark bar model. The
@@ -208,6 +226,9 @@ class BookmarkStorage : public base::ImportantFileWriter::DataSerializer {
   // Sequenced task runner where file I/O operations will be performed at.
   scoped_refptr<base::SequencedTaskRunner> sequenced_task_runner_;
 
+  // Whether the binary copy of the bookmarks file is written along with it.
+  const bool write_cache_;
+
   base::WeakPtrFactory<BookmarkStorage> weak_factory_{this};
 
   DISALLOW_COPY_AND_ASSIGN(BookmarkStorage);
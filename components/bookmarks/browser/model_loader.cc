@@ -31,16 +31,17 @@ scoped_refptr<ModelLoader> ModelLoader::Create(
   // Note: base::MakeRefCounted is not available here, as ModelLoader's
   // constructor is private.
   auto model_loader = base::WrapRefCounted(new ModelLoader());
-  // We plumb the value for kEmitExperimentalBookmarkLoadUma as retrieved on
-  // the UI thread to avoid issues with TSAN bots (in case there are tests that
-  // override feature toggles -not necessarily this one- while bookmark loading
-  // is ongoing, which is problematic due to how feature overriding for tests is
-  // implemented).
+  // We plumb the values for kEmitExperimentalBookmarkLoadUma and
+  // kFastBookmarkLoad as retrieved on the UI thread to avoid issues with TSAN
+  // bots (in case there are tests that override feature toggles -not
+  // necessarily these ones- while bookmark loading is ongoing, which is
+  // problematic due to how feature overriding for tests is implemented).
   load_sequenced_task_runner->PostTask(
       FROM_HERE,
       base::BindOnce(
           &ModelLoader::DoLoadOnBackgroundThread, model_loader, profile_path,
           base::FeatureList::IsEnabled(kEmitExperimentalBookmarkLoadUma),
+          base::FeatureList::IsEnabled(kFastBookmarkLoad),
           base::ThreadTaskRunnerHandle::Get(), std::move(details),
           std::move(callback)));
   return model_loader;
@@ -59,10 +60,11 @@ ModelLoader::~ModelLoader() = default;
 void ModelLoader::DoLoadOnBackgroundThread(
     const base::FilePath& profile_path,
     bool emit_experimental_uma,
+    bool fast_load,
     scoped_refptr<base::SequencedTaskRunner> main_sequenced_task_runner,
     std::unique_ptr<BookmarkLoadDetails> details,
     LoadCallback callback) {
-  LoadBookmarks(profile_path, emit_experimental_uma, details.get());
+  LoadBookmarks(profile_path, emit_experimental_uma, fast_load, details.get());
   history_bookmark_model_ = details->url_index();
   loaded_signal_.Signal();
   main_sequenced_task_runner->PostTask(
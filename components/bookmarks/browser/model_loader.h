@@ -58,6 +58,7 @@ class ModelLoader : public base::RefCountedThreadSafe<ModelLoader> {
   void DoLoadOnBackgroundThread(
       const base::FilePath& profile_path,
       bool emit_experimental_uma,
+      bool fast_load,
       scoped_refptr<base::SequencedTaskRunner> main_sequenced_task_runner,
       std::unique_ptr<BookmarkLoadDetails> details,
       LoadCallback callback);
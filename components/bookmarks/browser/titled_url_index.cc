@@ -6,6 +6,8 @@
 
 #include <stdint.h>
 
+#include <utility>
+
 #include "base/i18n/case_conversion.h"
 #include "base/i18n/unicodestring.h"
 #include "base/logging.h"
@@ -185,40 +187,25 @@ bool TitledUrlIndex::GetResultsMatchingTerm(
     bool first_term,
     query_parser::MatchingAlgorithm matching_algorithm,
     TitledUrlNodeSet* matches) {
-  Index::const_iterator i = index_.lower_bound(term);
-  if (i == index_.end())
-    return false;
-
   if (!query_parser::QueryParser::IsWordLongEnoughForPrefixSearch(
       term, matching_algorithm)) {
     // Term is too short for prefix match, compare using exact match.
-    if (i->first != term)
+    const TitledUrlNodeSet* term_matches = index_.FindWord(term);
+    if (!term_matches)
       return false;  // No title/URL pairs with this term.
 
     if (first_term) {
-      (*matches) = i->second;
+      (*matches) = *term_matches;
       return true;
     }
-    base::EraseIf(*matches, base::IsNotIn<TitledUrlNodeSet>(i->second));
+    base::EraseIf(*matches, base::IsNotIn<TitledUrlNodeSet>(*term_matches));
   } else {
-    // Loop through index adding all entries that start with term to
-    // |prefix_matches|.
-    TitledUrlNodeSet tmp_prefix_matches;
-    // If this is the first term, then store the result directly in |matches|
-    // to avoid calling stl intersection (which requires a copy).
-    TitledUrlNodeSet* prefix_matches =
-        first_term ? matches : &tmp_prefix_matches;
-    while (i != index_.end() &&
-           i->first.size() >= term.size() &&
-           term.compare(0, term.size(), i->first, 0, term.size()) == 0) {
-      for (auto n = i->second.begin(); n != i->second.end(); ++n) {
-        prefix_matches->insert(prefix_matches->end(), *n);
-      }
-      ++i;
-    }
-    if (!first_term) {
-      base::EraseIf(*matches, base::IsNotIn<TitledUrlNodeSet>(*prefix_matches));
-    }
+    // All entries that start with term.
+    TitledUrlNodeSet prefix_matches = index_.FindPrefix(term);
+    if (first_term)
+      (*matches) = std::move(prefix_matches);
+    else
+      base::EraseIf(*matches, base::IsNotIn<TitledUrlNodeSet>(prefix_matches));
   }
   return !matches->empty();
 }
@@ -237,20 +224,12 @@ std::vector<base::string16> TitledUrlIndex::ExtractQueryWords(
 
 void TitledUrlIndex::RegisterNode(const base::string16& term,
                                  const TitledUrlNode* node) {
-  index_[term].insert(node);
+  index_.Insert(term, node);
 }
 
 void TitledUrlIndex::UnregisterNode(const base::string16& term,
                                    const TitledUrlNode* node) {
-  auto i = index_.find(term);
-  if (i == index_.end()) {
-    // We can get here if the node has the same term more than once. For
-    // example, a node with the title 'foo foo' would end up here.
-    return;
-  }
-  i->second.erase(node);
-  if (i->second.empty())
-    index_.erase(i);
+  index_.Erase(term, node);
 }
 
 }  // namespace bookmarks
@@ -7,7 +7,6 @@
 
 #include <stddef.h>
 
-#include <map>
 #include <string>
 #include <vector>
 
@@ -15,6 +14,7 @@
 #include "base/macros.h"
 #include "base/strings/string16.h"
 #include "components/bookmarks/browser/titled_url_node_sorter.h"
+#include "components/bookmarks/browser/titled_url_trie.h"
 #include "components/query_parser/query_parser.h"
 
 namespace bookmarks {
@@ -25,8 +25,8 @@ struct TitledUrlMatch;
 
 // TitledUrlIndex maintains an index of paired titles and URLs for quick lookup.
 //
-// TitledUrlIndex maintains the index (index_) as a map of sets. The map (type
-// Index) maps from a lower case string to the set (type TitledUrlNodeSet) of
+// TitledUrlIndex maintains the index (index_) as a trie (see TitledUrlTrie)
+// mapping from a lower case string to the set (type TitledUrlNodeSet) of
 // TitledUrlNodes that contain that string in their title or URL.
 class TitledUrlIndex {
  public:
@@ -55,7 +55,6 @@ class TitledUrlIndex {
  private:
   using TitledUrlNodes = std::vector<const TitledUrlNode*>;
   using TitledUrlNodeSet = base::flat_set<const TitledUrlNode*>;
-  using Index = std::map<base::string16, TitledUrlNodeSet>;
 
   // Constructs |sorted_nodes| by copying the matches in |matches| and sorting
   // them.
@@ -86,7 +85,7 @@ class TitledUrlIndex {
   // Removes |node| from |index_|.
   void UnregisterNode(const base::string16& term, const TitledUrlNode* node);
 
-  Index index_;
+  TitledUrlTrie index_;
 
   std::unique_ptr<TitledUrlNodeSorter> sorter_;
 
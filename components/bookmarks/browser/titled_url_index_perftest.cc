@@ -0,0 +1,163 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_set.h"
+#include "base/guid.h"
+#include "base/stl_util.h"
+#include "base/strings/string16.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/timer/elapsed_timer.h"
+#include "components/bookmarks/browser/bookmark_node.h"
+#include "components/bookmarks/browser/titled_url_trie.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace bookmarks {
+namespace {
+
+constexpr size_t kBookmarkCount = 50000;
+constexpr size_t kWordsPerBookmark = 6;
+
+const char* const kSyllables[] = {"ba", "ker", "to", "ri", "nel", "so",
+                                  "ma", "pu",  "den", "vi", "lo", "gra",
+                                  "chi", "om", "tes", "fa"};
+
+using TitledUrlNodeSet = base::flat_set<const TitledUrlNode*>;
+
+// The index as TitledUrlIndex used to keep it.
+using MapIndex = std::map<base::string16, TitledUrlNodeSet>;
+
+TitledUrlNodeSet FindPrefixInMap(const MapIndex& index,
+                                 const base::string16& prefix) {
+  TitledUrlNodeSet matches;
+  for (auto i = index.lower_bound(prefix);
+       i != index.end() && i->first.compare(0, prefix.size(), prefix) == 0;
+       ++i) {
+    for (const TitledUrlNode* node : i->second)
+      matches.insert(matches.end(), node);
+  }
+  return matches;
+}
+
+// Makes words of one to four syllables, the same ones on every run.
+class WordGenerator {
+ public:
+  base::string16 Next() {
+    std::string word;
+    for (uint32_t syllables = NextInt(4) + 1; syllables > 0; --syllables)
+      word += kSyllables[NextInt(base::size(kSyllables))];
+    return base::ASCIIToUTF16(word);
+  }
+
+ private:
+  uint32_t NextInt(uint32_t range) {
+    seed_ = seed_ * 1103515245 + 12345;
+    return (seed_ >> 16) % range;
+  }
+
+  uint32_t seed_ = 1;
+};
+
+class TitledUrlIndexPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    WordGenerator generator;
+    for (size_t i = 0; i < kBookmarkCount; ++i) {
+      nodes_.push_back(std::make_unique<BookmarkNode>(
+          i + 1, base::GenerateGUID(), GURL("http://example.com/")));
+      std::vector<base::string16> words;
+      for (size_t j = 0; j < kWordsPerBookmark; ++j)
+        words.push_back(generator.Next());
+      words_.push_back(std::move(words));
+    }
+    // What a user could type, one keystroke at a time.
+    for (const char* input : {"kerden", "gratesfa", "chiom", "vilo", "z"}) {
+      const std::string text(input);
+      for (size_t length = 1; length <= text.size(); ++length)
+        prefixes_.push_back(base::ASCIIToUTF16(text.substr(0, length)));
+    }
+  }
+
+  void Report(const std::string& trace,
+              base::TimeDelta time,
+              size_t count,
+              const std::string& units) {
+    perf_test::PrintResult("TitledUrlIndex", "", trace,
+                           time.InMicrosecondsF() / count, units, true);
+  }
+
+  std::vector<std::unique_ptr<BookmarkNode>> nodes_;
+  std::vector<std::vector<base::string16>> words_;
+  std::vector<base::string16> prefixes_;
+};
+
+TEST_F(TitledUrlIndexPerfTest, PrefixLookup) {
+  base::ElapsedTimer map_build_timer;
+  MapIndex map_index;
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    for (const base::string16& word : words_[i])
+      map_index[word].insert(nodes_[i].get());
+  }
+  Report("map_build", map_build_timer.Elapsed(), nodes_.size(), "us/node");
+
+  base::ElapsedTimer trie_build_timer;
+  TitledUrlTrie trie;
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    for (const base::string16& word : words_[i])
+      trie.Insert(word, nodes_[i].get());
+  }
+  Report("trie_build", trie_build_timer.Elapsed(), nodes_.size(), "us/node");
+
+  size_t map_matches = 0;
+  base::ElapsedTimer map_timer;
+  for (const base::string16& prefix : prefixes_)
+    map_matches += FindPrefixInMap(map_index, prefix).size();
+  Report("map_prefix", map_timer.Elapsed(), prefixes_.size(), "us/lookup");
+
+  size_t trie_matches = 0;
+  base::ElapsedTimer trie_timer;
+  for (const base::string16& prefix : prefixes_)
+    trie_matches += trie.FindPrefix(prefix).size();
+  Report("trie_prefix", trie_timer.Elapsed(), prefixes_.size(), "us/lookup");
+
+  EXPECT_EQ(map_matches, trie_matches);
+}
+
+TEST_F(TitledUrlIndexPerfTest, SubstringLookup) {
+  TitledUrlTrie trie;
+  TitledUrlTrie trigram_trie(/*index_trigrams=*/true);
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    for (const base::string16& word : words_[i]) {
+      trie.Insert(word, nodes_[i].get());
+      trigram_trie.Insert(word, nodes_[i].get());
+    }
+  }
+
+  size_t scan_matches = 0;
+  base::ElapsedTimer scan_timer;
+  for (const base::string16& prefix : prefixes_)
+    scan_matches += trie.FindContaining(prefix).size();
+  Report("trie_substring", scan_timer.Elapsed(), prefixes_.size(),
+         "us/lookup");
+
+  size_t trigram_matches = 0;
+  base::ElapsedTimer trigram_timer;
+  for (const base::string16& prefix : prefixes_)
+    trigram_matches += trigram_trie.FindContaining(prefix).size();
+  Report("trigram_substring", trigram_timer.Elapsed(), prefixes_.size(),
+         "us/lookup");
+
+  EXPECT_EQ(scan_matches, trigram_matches);
+}
+
+}  // namespace
+}  // namespace bookmarks
@@ -0,0 +1,324 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/bookmarks/browser/titled_url_trie.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "base/logging.h"
+
+namespace bookmarks {
+
+namespace {
+
+uint64_t PackTrigram(const base::char16* chars) {
+  return (static_cast<uint64_t>(chars[0]) << 32) |
+         (static_cast<uint64_t>(chars[1]) << 16) | chars[2];
+}
+
+// Returns the distinct trigrams of |text|, sorted.
+std::vector<uint64_t> GetTrigrams(const base::string16& text) {
+  std::vector<uint64_t> trigrams;
+  for (size_t i = 0; i + 3 <= text.size(); ++i)
+    trigrams.push_back(PackTrigram(&text[i]));
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()),
+                 trigrams.end());
+  return trigrams;
+}
+
+}  // namespace
+
+constexpr uint32_t TitledUrlTrie::kRoot;
+constexpr uint32_t TitledUrlTrie::kNone;
+
+TitledUrlTrie::Node::Node() = default;
+TitledUrlTrie::Node::Node(Node&&) = default;
+TitledUrlTrie::Node& TitledUrlTrie::Node::operator=(Node&&) = default;
+TitledUrlTrie::Node::~Node() = default;
+
+TitledUrlTrie::TitledUrlTrie(bool index_trigrams)
+    : index_trigrams_(index_trigrams), nodes_(1) {}
+
+TitledUrlTrie::~TitledUrlTrie() = default;
+
+void TitledUrlTrie::Insert(const base::string16& word,
+                           const TitledUrlNode* node) {
+  if (word.empty())
+    return;
+  const uint32_t id = FindOrAddWordNode(word);
+  TitledUrlNodeSet& nodes = nodes_[id].nodes;
+  if (nodes.empty()) {
+    ++word_count_;
+    if (index_trigrams_)
+      AddTrigrams(word, id);
+  }
+  nodes.insert(node);
+}
+
+void TitledUrlTrie::Erase(const base::string16& word,
+                          const TitledUrlNode* node) {
+  const uint32_t id = FindWordNode(word);
+  // We can get here without a word if a node has the same word more than
+  // once. For example, a node with the title 'foo foo' would end up here.
+  if (id == kNone)
+    return;
+  TitledUrlNodeSet& nodes = nodes_[id].nodes;
+  nodes.erase(node);
+  if (!nodes.empty())
+    return;
+  --word_count_;
+  if (index_trigrams_)
+    RemoveTrigrams(word, id);
+  Prune(id);
+}
+
+const TitledUrlTrie::TitledUrlNodeSet* TitledUrlTrie::FindWord(
+    const base::string16& word) const {
+  const uint32_t id = FindWordNode(word);
+  return id == kNone ? nullptr : &nodes_[id].nodes;
+}
+
+TitledUrlTrie::TitledUrlNodeSet TitledUrlTrie::FindPrefix(
+    const base::string16& prefix) const {
+  const uint32_t id = FindPrefixNode(prefix);
+  if (id == kNone)
+    return TitledUrlNodeSet();
+  // Building the set in one go sorts once, rather than shifting the set on
+  // every insertion.
+  std::vector<const TitledUrlNode*> nodes;
+  CollectNodes(id, &nodes);
+  return TitledUrlNodeSet(std::move(nodes));
+}
+
+TitledUrlTrie::TitledUrlNodeSet TitledUrlTrie::FindContaining(
+    const base::string16& text) const {
+  std::vector<const TitledUrlNode*> nodes;
+  if (!index_trigrams_ || text.size() < 3) {
+    // Check every word, spelling them out while walking the trie.
+    std::vector<std::pair<uint32_t, size_t>> stack = {{kRoot, 0}};
+    base::string16 word;
+    while (!stack.empty()) {
+      const uint32_t id = stack.back().first;
+      word.resize(stack.back().second);
+      stack.pop_back();
+      const Node& node = nodes_[id];
+      word += node.chars;
+      if (!node.nodes.empty() && word.find(text) != base::string16::npos)
+        nodes.insert(nodes.end(), node.nodes.begin(), node.nodes.end());
+      for (uint32_t child : node.children)
+        stack.emplace_back(child, word.size());
+    }
+    return TitledUrlNodeSet(std::move(nodes));
+  }
+
+  // Intersect the words of each trigram of |text|, rarest first, then check
+  // the remaining words, as having every trigram doesn't make a match.
+  std::vector<const std::vector<uint32_t>*> lists;
+  for (uint64_t trigram : GetTrigrams(text)) {
+    auto i = trigrams_.find(trigram);
+    if (i == trigrams_.end())
+      return TitledUrlNodeSet();
+    lists.push_back(&i->second);
+  }
+  std::sort(lists.begin(), lists.end(),
+            [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+              return a->size() < b->size();
+            });
+  std::vector<uint32_t> candidates = *lists.front();
+  for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+    std::vector<uint32_t> remaining;
+    std::set_intersection(candidates.begin(), candidates.end(),
+                          lists[i]->begin(), lists[i]->end(),
+                          std::back_inserter(remaining));
+    candidates.swap(remaining);
+  }
+  for (uint32_t id : candidates) {
+    if (GetWord(id).find(text) != base::string16::npos) {
+      nodes.insert(nodes.end(), nodes_[id].nodes.begin(),
+                   nodes_[id].nodes.end());
+    }
+  }
+  return TitledUrlNodeSet(std::move(nodes));
+}
+
+uint32_t TitledUrlTrie::FindOrAddWordNode(const base::string16& word) {
+  uint32_t current = kRoot;
+  size_t pos = 0;
+  while (pos < word.size()) {
+    const size_t child_pos = ChildPosition(current, word[pos]);
+    const Node& parent = nodes_[current];
+    if (child_pos == parent.children.size() ||
+        parent.child_chars[child_pos] != word[pos]) {
+      // No word shares the next char: add the rest of |word| as a leaf.
+      const uint32_t leaf = NewNode(word.substr(pos), current);
+      Node& updated_parent = nodes_[current];
+      updated_parent.child_chars.insert(
+          updated_parent.child_chars.begin() + child_pos, word[pos]);
+      updated_parent.children.insert(
+          updated_parent.children.begin() + child_pos, leaf);
+      return leaf;
+    }
+
+    const uint32_t child = parent.children[child_pos];
+    const base::string16& chars = nodes_[child].chars;
+    const size_t max_common = std::min(chars.size(), word.size() - pos);
+    size_t common = 1;
+    while (common < max_common && chars[common] == word[pos + common])
+      ++common;
+    if (common < chars.size()) {
+      // |word| leaves or ends within |child|'s chars: split them, putting a
+      // new node between |current| and |child|, which keeps its position.
+      const uint32_t middle = NewNode(chars.substr(0, common), current);
+      Node& child_node = nodes_[child];
+      child_node.chars.erase(0, common);
+      child_node.parent = middle;
+      Node& middle_node = nodes_[middle];
+      middle_node.child_chars.push_back(child_node.chars[0]);
+      middle_node.children.push_back(child);
+      nodes_[current].children[child_pos] = middle;
+      current = middle;
+    } else {
+      current = child;
+    }
+    pos += common;
+  }
+  return current;
+}
+
+uint32_t TitledUrlTrie::FindWordNode(const base::string16& word) const {
+  if (word.empty())
+    return kNone;
+  uint32_t current = kRoot;
+  size_t pos = 0;
+  while (pos < word.size()) {
+    const size_t child_pos = ChildPosition(current, word[pos]);
+    const Node& parent = nodes_[current];
+    if (child_pos == parent.children.size() ||
+        parent.child_chars[child_pos] != word[pos]) {
+      return kNone;
+    }
+    current = parent.children[child_pos];
+    const base::string16& chars = nodes_[current].chars;
+    if (word.compare(pos, chars.size(), chars) != 0)
+      return kNone;
+    pos += chars.size();
+  }
+  return nodes_[current].nodes.empty() ? kNone : current;
+}
+
+uint32_t TitledUrlTrie::FindPrefixNode(const base::string16& prefix) const {
+  uint32_t current = kRoot;
+  size_t pos = 0;
+  while (pos < prefix.size()) {
+    const size_t child_pos = ChildPosition(current, prefix[pos]);
+    const Node& parent = nodes_[current];
+    if (child_pos == parent.children.size() ||
+        parent.child_chars[child_pos] != prefix[pos]) {
+      return kNone;
+    }
+    current = parent.children[child_pos];
+    const base::string16& chars = nodes_[current].chars;
+    // |prefix| may end within |chars|.
+    const size_t length = std::min(chars.size(), prefix.size() - pos);
+    if (prefix.compare(pos, length, chars, 0, length) != 0)
+      return kNone;
+    pos += length;
+  }
+  return current;
+}
+
+size_t TitledUrlTrie::ChildPosition(uint32_t parent, base::char16 c) const {
+  const std::vector<base::char16>& child_chars = nodes_[parent].child_chars;
+  return std::lower_bound(child_chars.begin(), child_chars.end(), c) -
+         child_chars.begin();
+}
+
+base::string16 TitledUrlTrie::GetWord(uint32_t id) const {
+  base::string16 word;
+  for (; id != kRoot; id = nodes_[id].parent)
+    word.insert(0, nodes_[id].chars);
+  return word;
+}
+
+void TitledUrlTrie::CollectNodes(
+    uint32_t id,
+    std::vector<const TitledUrlNode*>* nodes) const {
+  std::vector<uint32_t> stack = {id};
+  while (!stack.empty()) {
+    const Node& node = nodes_[stack.back()];
+    stack.pop_back();
+    nodes->insert(nodes->end(), node.nodes.begin(), node.nodes.end());
+    stack.insert(stack.end(), node.children.begin(), node.children.end());
+  }
+}
+
+void TitledUrlTrie::Prune(uint32_t id) {
+  // Remove leaves holding no word, up the trie.
+  while (id != kRoot && nodes_[id].nodes.empty() &&
+         nodes_[id].children.empty()) {
+    const uint32_t parent = nodes_[id].parent;
+    Node& parent_node = nodes_[parent];
+    const size_t child_pos = ChildPosition(parent, nodes_[id].chars[0]);
+    DCHECK_EQ(id, parent_node.children[child_pos]);
+    parent_node.child_chars.erase(parent_node.child_chars.begin() + child_pos);
+    parent_node.children.erase(parent_node.children.begin() + child_pos);
+    FreeNode(id);
+    id = parent;
+  }
+
+  // A node holding no word with a single child is merged into the child,
+  // which keeps its position as it may hold a word.
+  Node& node = nodes_[id];
+  if (id == kRoot || !node.nodes.empty() || node.children.size() != 1)
+    return;
+  const uint32_t child = node.children[0];
+  const uint32_t parent = node.parent;
+  Node& child_node = nodes_[child];
+  child_node.chars.insert(0, node.chars);
+  child_node.parent = parent;
+  nodes_[parent].children[ChildPosition(parent, node.chars[0])] = child;
+  FreeNode(id);
+}
+
+uint32_t TitledUrlTrie::NewNode(base::string16 chars, uint32_t parent) {
+  uint32_t id;
+  if (free_nodes_.empty()) {
+    id = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+  } else {
+    id = free_nodes_.back();
+    free_nodes_.pop_back();
+  }
+  nodes_[id].chars = std::move(chars);
+  nodes_[id].parent = parent;
+  return id;
+}
+
+void TitledUrlTrie::FreeNode(uint32_t id) {
+  nodes_[id] = Node();
+  free_nodes_.push_back(id);
+}
+
+void TitledUrlTrie::AddTrigrams(const base::string16& word, uint32_t id) {
+  for (uint64_t trigram : GetTrigrams(word)) {
+    std::vector<uint32_t>& ids = trigrams_[trigram];
+    ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+  }
+}
+
+void TitledUrlTrie::RemoveTrigrams(const base::string16& word, uint32_t id) {
+  for (uint64_t trigram : GetTrigrams(word)) {
+    auto i = trigrams_.find(trigram);
+    DCHECK(i != trigrams_.end());
+    std::vector<uint32_t>& ids = i->second;
+    ids.erase(std::lower_bound(ids.begin(), ids.end(), id));
+    if (ids.empty())
+      trigrams_.erase(i);
+  }
+}
+
+}  // namespace bookmarks
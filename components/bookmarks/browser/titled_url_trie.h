@@ -0,0 +1,133 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef COMPONENTS_BOOKMARKS_BROWSER_TITLED_URL_TRIE_H_
+#define COMPONENTS_BOOKMARKS_BROWSER_TITLED_URL_TRIE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "base/containers/flat_set.h"
+#include "base/macros.h"
+#include "base/strings/string16.h"
+
+namespace bookmarks {
+
+class TitledUrlNode;
+
+// TitledUrlTrie maps the words of titles and URLs to the TitledUrlNodes that
+// contain them, for TitledUrlIndex.
+//
+// The words are kept in a radix trie: each trie node holds the run of chars
+// leading to it from its parent and a sorted vector of its children's first
+// chars, so finding every word with a given prefix walks at most one trie node
+// per char and then only the subtree below. The trie nodes live in a single
+// vector and refer to each other by position, and each word's TitledUrlNodes
+// are a sorted vector.
+//
+// When |index_trigrams| is true, every word is also listed under each of its
+// three-char substrings, so that FindContaining() only checks the words that
+// have every trigram of the text instead of all of them.
+class TitledUrlTrie {
+ public:
+  using TitledUrlNodeSet = base::flat_set<const TitledUrlNode*>;
+
+  explicit TitledUrlTrie(bool index_trigrams = false);
+  ~TitledUrlTrie();
+
+  // Records that |node| contains |word|.
+  void Insert(const base::string16& word, const TitledUrlNode* node);
+
+  // Forgets that |node| contains |word|, if it was recorded.
+  void Erase(const base::string16& word, const TitledUrlNode* node);
+
+  // Returns the nodes containing |word|, or null if there are none.
+  const TitledUrlNodeSet* FindWord(const base::string16& word) const;
+
+  // Returns the nodes containing a word that starts with |prefix|.
+  TitledUrlNodeSet FindPrefix(const base::string16& prefix) const;
+
+  // Returns the nodes containing a word that contains |text|.
+  TitledUrlNodeSet FindContaining(const base::string16& text) const;
+
+  // Returns the number of distinct words.
+  size_t word_count() const { return word_count_; }
+
+ private:
+  static constexpr uint32_t kRoot = 0;
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  struct Node {
+    Node();
+    Node(Node&&);
+    Node& operator=(Node&&);
+    ~Node();
+
+    // The chars leading from |parent| to this node.
+    base::string16 chars;
+    uint32_t parent = kNone;
+    // The first char of each child's |chars|, sorted, and the children in the
+    // same order.
+    std::vector<base::char16> child_chars;
+    std::vector<uint32_t> children;
+    // The nodes containing the word ending here. Empty if no word does.
+    TitledUrlNodeSet nodes;
+  };
+
+  // Returns the trie node for |word|, adding it and splitting an existing
+  // node's chars as needed.
+  uint32_t FindOrAddWordNode(const base::string16& word);
+
+  // Returns the trie node for |word|, or kNone.
+  uint32_t FindWordNode(const base::string16& word) const;
+
+  // Returns the highest trie node whose subtree holds exactly the words
+  // starting with |prefix|, or kNone.
+  uint32_t FindPrefixNode(const base::string16& prefix) const;
+
+  // Returns the position of the child of |parent| whose chars start with |c|,
+  // or where to insert one.
+  size_t ChildPosition(uint32_t parent, base::char16 c) const;
+
+  // Returns the word leading to |id|.
+  base::string16 GetWord(uint32_t id) const;
+
+  // Appends the nodes of every word in the subtree of |id| to |nodes|.
+  void CollectNodes(uint32_t id,
+                    std::vector<const TitledUrlNode*>* nodes) const;
+
+  // Removes |id| if it no longer holds a word, along with the ancestors that
+  // are left with no purpose, and merges a trie node left with a single child
+  // into that child.
+  void Prune(uint32_t id);
+
+  uint32_t NewNode(base::string16 chars, uint32_t parent);
+  void FreeNode(uint32_t id);
+
+  void AddTrigrams(const base::string16& word, uint32_t id);
+  void RemoveTrigrams(const base::string16& word, uint32_t id);
+
+  const bool index_trigrams_;
+
+  std::vector<Node> nodes_;
+
+  // Positions in |nodes_| of removed trie nodes, reused by NewNode().
+  std::vector<uint32_t> free_nodes_;
+
+  size_t word_count_ = 0;
+
+  // Maps a trigram, its chars packed in a uint64_t, to the sorted trie nodes
+  // of the words containing it. Trie nodes holding a word never move, so the
+  // lists stay valid as other words come and go.
+  std::unordered_map<uint64_t, std::vector<uint32_t>> trigrams_;
+
+  DISALLOW_COPY_AND_ASSIGN(TitledUrlTrie);
+};
+
+}  // namespace bookmarks
+
+#endif  // COMPONENTS_BOOKMARKS_BROWSER_TITLED_URL_TRIE_H_
@@ -0,0 +1,164 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/bookmarks/browser/titled_url_trie.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/guid.h"
+#include "base/strings/utf_string_conversions.h"
+#include "components/bookmarks/browser/bookmark_node.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::ASCIIToUTF16;
+
+namespace bookmarks {
+namespace {
+
+using TitledUrlNodeSet = TitledUrlTrie::TitledUrlNodeSet;
+
+// The trie checked against a map of words, over a few nodes.
+class TitledUrlTrieTest : public testing::TestWithParam<bool> {
+ protected:
+  TitledUrlTrieTest() : trie_(/*index_trigrams=*/GetParam()) {
+    for (int i = 0; i < 8; ++i) {
+      nodes_.push_back(std::make_unique<BookmarkNode>(
+          i + 1, base::GenerateGUID(), GURL("http://example.com/")));
+    }
+  }
+
+  void Insert(const std::string& word, size_t node) {
+    trie_.Insert(ASCIIToUTF16(word), nodes_[node].get());
+    words_[word].insert(nodes_[node].get());
+  }
+
+  void Erase(const std::string& word, size_t node) {
+    trie_.Erase(ASCIIToUTF16(word), nodes_[node].get());
+    auto i = words_.find(word);
+    if (i == words_.end())
+      return;
+    i->second.erase(nodes_[node].get());
+    if (i->second.empty())
+      words_.erase(i);
+  }
+
+  TitledUrlNodeSet ExpectedWord(const std::string& word) const {
+    auto i = words_.find(word);
+    return i == words_.end() ? TitledUrlNodeSet()
+                             : TitledUrlNodeSet(i->second.begin(),
+                                                i->second.end());
+  }
+
+  TitledUrlNodeSet ExpectedPrefix(const std::string& prefix) const {
+    TitledUrlNodeSet nodes;
+    for (const auto& word : words_) {
+      if (word.first.compare(0, prefix.size(), prefix) == 0)
+        nodes.insert(word.second.begin(), word.second.end());
+    }
+    return nodes;
+  }
+
+  TitledUrlNodeSet ExpectedContaining(const std::string& text) const {
+    TitledUrlNodeSet nodes;
+    for (const auto& word : words_) {
+      if (word.first.find(text) != std::string::npos)
+        nodes.insert(word.second.begin(), word.second.end());
+    }
+    return nodes;
+  }
+
+  // Checks every lookup of every string of up to |max_length| chars of
+  // |alphabet|.
+  void CheckLookups(const std::string& alphabet, size_t max_length) {
+    EXPECT_EQ(words_.size(), trie_.word_count());
+    std::vector<std::string> texts = {std::string()};
+    for (size_t i = 0; i < texts.size(); ++i) {
+      const std::string& text = texts[i];
+      SCOPED_TRACE(text);
+      const TitledUrlNodeSet* word_nodes = trie_.FindWord(ASCIIToUTF16(text));
+      EXPECT_EQ(ExpectedWord(text),
+                word_nodes ? *word_nodes : TitledUrlNodeSet());
+      EXPECT_EQ(ExpectedPrefix(text), trie_.FindPrefix(ASCIIToUTF16(text)));
+      EXPECT_EQ(ExpectedContaining(text),
+                trie_.FindContaining(ASCIIToUTF16(text)));
+      if (text.size() < max_length) {
+        for (char c : alphabet)
+          texts.push_back(text + c);
+      }
+    }
+  }
+
+  TitledUrlTrie trie_;
+  std::vector<std::unique_ptr<BookmarkNode>> nodes_;
+  std::map<std::string, std::set<const TitledUrlNode*>> words_;
+};
+
+TEST_P(TitledUrlTrieTest, InsertAndFind) {
+  Insert("foo", 0);
+  Insert("food", 1);
+  Insert("fool", 2);
+  Insert("fo", 3);
+  Insert("bar", 0);
+  Insert("foo", 4);
+  CheckLookups("abdflor", 4);
+}
+
+TEST_P(TitledUrlTrieTest, EraseMergesNodes) {
+  Insert("abc", 0);
+  Insert("abd", 1);
+  Insert("ab", 2);
+  Erase("abc", 0);
+  CheckLookups("abcd", 4);
+  Erase("ab", 2);
+  CheckLookups("abcd", 4);
+  // Erasing what isn't there changes nothing.
+  Erase("abd", 0);
+  Erase("xyz", 0);
+  CheckLookups("abcd", 4);
+  Erase("abd", 1);
+  CheckLookups("abcd", 4);
+  EXPECT_EQ(0u, trie_.word_count());
+}
+
+TEST_P(TitledUrlTrieTest, RandomOperations) {
+  const char kAlphabet[] = "abc";
+  uint32_t seed = 1;
+  auto next = [&seed](uint32_t range) {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % range;
+  };
+  for (int i = 0; i < 2000; ++i) {
+    std::string word;
+    for (uint32_t length = next(5) + 1; length > 0; --length)
+      word += kAlphabet[next(3)];
+    const size_t node = next(nodes_.size());
+    if (next(3) == 0)
+      Erase(word, node);
+    else
+      Insert(word, node);
+    if (i % 250 == 0)
+      CheckLookups(kAlphabet, 4);
+  }
+  CheckLookups(kAlphabet, 5);
+
+  // Empty the trie in the order the words sort in.
+  while (!words_.empty()) {
+    const std::string word = words_.begin()->first;
+    for (size_t node = 0; node < nodes_.size(); ++node)
+      Erase(word, node);
+  }
+  CheckLookups(kAlphabet, 3);
+}
+
+INSTANTIATE_TEST_SUITE_P(All, TitledUrlTrieTest, testing::Bool());
+
+}  // namespace
+}  // namespace bookmarks
@@ -72,6 +72,10 @@ int ConfiguratorImpl::UpdateDelay() const {
   return fast_update_ ? 10 : (15 * kDelayOneMinute);
 }
 
+int ConfiguratorImpl::MaxConcurrentDownloads() const {
+  return 3;
+}
+
 std::vector<GURL> ConfiguratorImpl::UpdateUrl() const {
   if (url_source_override_.is_valid())
     return {GURL(url_source_override_)};
@@ -50,6 +50,10 @@ class ConfiguratorImpl {
   // components.
   int UpdateDelay() const;
 
+  // The number of components of one update which may download at the same
+  // time.
+  int MaxConcurrentDownloads() const;
+
   // The URLs for the update checks. The URLs are tried in order, the first one
   // that succeeds wins.
   std::vector<GURL> UpdateUrl() const;
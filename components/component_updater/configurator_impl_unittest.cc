@@ -37,6 +37,7 @@ TEST_F(ComponentUpdaterConfiguratorImplTest, FastUpdate) {
   CHECK_EQ(5 * kDelayOneHour, config->NextCheckDelay());
   CHECK_EQ(30 * kDelayOneMinute, config->OnDemandDelay());
   CHECK_EQ(15 * kDelayOneMinute, config->UpdateDelay());
+  CHECK_EQ(3, config->MaxConcurrentDownloads());
 
   // Test the fast-update timings.
   cmdline.AppendSwitchASCII("--component-updater", "fast-update");
@@ -71,6 +72,7 @@ TEST_F(ComponentUpdaterConfiguratorImplTest, FastUpdateWithCustomPolicy) {
   CHECK_EQ(5 * kDelayOneHour, config->NextCheckDelay());
   CHECK_EQ(30 * kDelayOneMinute, config->OnDemandDelay());
   CHECK_EQ(15 * kDelayOneMinute, config->UpdateDelay());
+  CHECK_EQ(3, config->MaxConcurrentDownloads());
 
   // Test the fast-update timings.
   class FastUpdateCommandLineConfigurator
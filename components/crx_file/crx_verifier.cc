@@ -4,6 +4,7 @@
 
 #include "components/crx_file/crx_verifier.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iterator>
 #include <memory>
@@ -15,6 +16,7 @@
 #include "base/callback.h"
 #include "base/files/file.h"
 #include "base/files/file_path.h"
+#include "base/logging.h"
 #include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "components/crx_file/crx3.pb.h"
@@ -44,47 +46,161 @@ constexpr uint8_t kPublisherTestKeyHash[] = {
     0x5f, 0x64, 0xf3, 0xa6, 0x17, 0x03, 0x0d, 0xde, 0x21, 0x61, 0xbe,
     0xb7, 0x95, 0x91, 0x95, 0x83, 0x68, 0x12, 0xe9, 0x78, 0x1e};
 
-using VerifierCollection =
-    std::vector<std::unique_ptr<crypto::SignatureVerifier>>;
 using RepeatedProof = google::protobuf::RepeatedPtrField<AsymmetricKeyProof>;
 
-int ReadAndHashBuffer(uint8_t* buffer,
-                      int length,
-                      base::File* file,
-                      crypto::SecureHash* hash) {
+// Reads a little-endian uint32 from the start of |bytes|.
+uint32_t ReadLittleEndianUInt32(const std::vector<uint8_t>& bytes) {
+  return bytes[3] << 24 | bytes[2] << 16 | bytes[1] << 8 | bytes[0];
+}
+
+}  // namespace
+
+VerifierResult Verify(
+    const base::FilePath& crx_path,
+    const VerifierFormat& format,
+    const std::vector<std::vector<uint8_t>>& required_key_hashes,
+    const std::vector<uint8_t>& required_file_hash,
+    std::string* public_key,
+    std::string* crx_id) {
+  base::File file(crx_path, base::File::FLAG_OPEN | base::File::FLAG_READ);
+  if (!file.IsValid())
+    return VerifierResult::ERROR_FILE_NOT_READABLE;
+
+  StreamingVerifier verifier(format, required_key_hashes, required_file_hash);
   static_assert(sizeof(char) == sizeof(uint8_t), "Unsupported char size.");
-  int read = file->ReadAtCurrentPos(reinterpret_cast<char*>(buffer), length);
-  if (read > 0)
-    hash->Update(buffer, read);
-  return read;
+  uint8_t buffer[1 << 12] = {};
+  for (;;) {
+    const int read = file.ReadAtCurrentPos(reinterpret_cast<char*>(buffer),
+                                           base::size(buffer));
+    if (read < 0)
+      return VerifierResult::ERROR_FILE_NOT_READABLE;
+    if (read == 0)
+      break;
+    if (!verifier.Update(base::make_span(buffer, read)))
+      break;
+  }
+  return verifier.Finish(public_key, crx_id);
 }
 
-// Returns UINT32_MAX in the case of an unexpected EOF or read error, else
-// returns the read uint32.
-uint32_t ReadAndHashLittleEndianUInt32(base::File* file,
-                                       crypto::SecureHash* hash) {
-  uint8_t buffer[4] = {};
-  if (ReadAndHashBuffer(buffer, 4, file, hash) != 4)
-    return UINT32_MAX;
-  return buffer[3] << 24 | buffer[2] << 16 | buffer[1] << 8 | buffer[0];
+StreamingVerifier::StreamingVerifier(
+    const VerifierFormat& format,
+    const std::vector<std::vector<uint8_t>>& required_key_hashes,
+    const std::vector<uint8_t>& required_file_hash)
+    : format_(format),
+      required_key_hashes_(required_key_hashes),
+      required_file_hash_(required_file_hash),
+      file_hash_(crypto::SecureHash::Create(crypto::SecureHash::SHA256)),
+      field_size_(kCrxFileHeaderMagicSize) {}
+
+StreamingVerifier::~StreamingVerifier() = default;
+
+bool StreamingVerifier::Update(base::span<const uint8_t> data) {
+  if (error_)
+    return false;
+
+  file_hash_->Update(data.data(), data.size());
+  for (;;) {
+    if (field_ == Field::kArchive) {
+      for (auto& verifier : verifiers_)
+        verifier->VerifyUpdate(data);
+      return true;
+    }
+    if (field_bytes_.size() == field_size_) {
+      if (!ParseField())
+        return false;
+      continue;
+    }
+    if (data.empty())
+      return true;
+    const size_t length =
+        std::min(data.size(), field_size_ - field_bytes_.size());
+    field_bytes_.insert(field_bytes_.end(), data.begin(),
+                        data.begin() + length);
+    data = data.subspan(length);
+  }
 }
 
-// Read to the end of the file, updating the hash and all verifiers.
-bool ReadHashAndVerifyArchive(base::File* file,
-                              crypto::SecureHash* hash,
-                              const VerifierCollection& verifiers) {
-  uint8_t buffer[1 << 12] = {};
-  size_t len = 0;
-  while ((len = ReadAndHashBuffer(buffer, base::size(buffer), file, hash)) >
-         0) {
-    for (auto& verifier : verifiers)
-      verifier->VerifyUpdate(base::make_span(buffer, len));
+VerifierResult StreamingVerifier::Finish(std::string* public_key,
+                                         std::string* crx_id) {
+  if (error_)
+    return *error_;
+
+  // The Crx ends before its archive.
+  if (field_ != Field::kArchive)
+    return VerifierResult::ERROR_HEADER_INVALID;
+
+  // Finalize the verifiers with [archive].
+  bool verified = true;
+  for (auto& verifier : verifiers_)
+    verified = verifier->VerifyFinal() && verified;
+  if (!verified)
+    return VerifierResult::ERROR_SIGNATURE_VERIFICATION_FAILED;
+
+  // Finalize file hash.
+  uint8_t final_hash[crypto::kSHA256Length] = {};
+  file_hash_->Finish(final_hash, sizeof(final_hash));
+  if (!required_file_hash_.empty()) {
+    if (required_file_hash_.size() != crypto::kSHA256Length)
+      return VerifierResult::ERROR_EXPECTED_HASH_INVALID;
+    if (!crypto::SecureMemEqual(final_hash, required_file_hash_.data(),
+                                crypto::kSHA256Length))
+      return VerifierResult::ERROR_FILE_HASH_FAILED;
   }
-  for (auto& verifier : verifiers) {
-    if (!verifier->VerifyFinal())
+
+  // All is well. Set the out-params and return.
+  if (public_key)
+    base::Base64Encode(public_key_, public_key);
+  if (crx_id)
+    *crx_id = crx_id_;
+  return diff_ ? VerifierResult::OK_DELTA : VerifierResult::OK_FULL;
+}
+
+bool StreamingVerifier::ParseField() {
+  DCHECK_EQ(field_size_, field_bytes_.size());
+  switch (field_) {
+    case Field::kMagic: {
+      const char* magic = reinterpret_cast<const char*>(field_bytes_.data());
+      if (!strncmp(magic, kCrxDiffFileHeaderMagic, kCrxFileHeaderMagicSize)) {
+        diff_ = true;
+      } else if (strncmp(magic, kCrxFileHeaderMagic,
+                         kCrxFileHeaderMagicSize)) {
+        error_ = VerifierResult::ERROR_HEADER_INVALID;
+        return false;
+      }
+      field_ = Field::kVersion;
+      field_size_ = 4;
+      break;
+    }
+    case Field::kVersion:
+      if (ReadLittleEndianUInt32(field_bytes_) != 3) {
+        error_ = VerifierResult::ERROR_HEADER_INVALID;
+        return false;
+      }
+      field_ = Field::kHeaderSize;
+      field_size_ = 4;
+      break;
+    case Field::kHeaderSize: {
+      const uint32_t header_size = ReadLittleEndianUInt32(field_bytes_);
+      if (header_size > kMaxHeaderSize) {
+        error_ = VerifierResult::ERROR_HEADER_INVALID;
+        return false;
+      }
+      field_ = Field::kHeader;
+      field_size_ = header_size;
+      break;
+    }
+    case Field::kHeader:
+      if (!ParseHeader())
+        return false;
+      field_ = Field::kArchive;
+      field_size_ = 0;
+      break;
+    case Field::kArchive:
+      NOTREACHED();
       return false;
   }
-  return len == 0;
+  field_bytes_.clear();
+  return true;
 }
 
 // The remaining contents of a Crx3 file are [header-size][header][archive].
@@ -92,32 +208,26 @@ bool ReadHashAndVerifyArchive(base::File* file,
 // unsigned section. The unsigned section contains a set of key/signature pairs,
 // and the signed section is the encoding of another protocol buffer. All
 // signatures cover [prefix][signed-header-size][signed-header][archive].
-VerifierResult VerifyCrx3(
-    base::File* file,
-    crypto::SecureHash* hash,
-    const std::vector<std::vector<uint8_t>>& required_key_hashes,
-    std::string* public_key,
-    std::string* crx_id,
-    bool require_publisher_key,
-    bool accept_publisher_test_key) {
-  // Parse [header-size] and [header].
-  const uint32_t header_size = ReadAndHashLittleEndianUInt32(file, hash);
-  if (header_size > kMaxHeaderSize)
-    return VerifierResult::ERROR_HEADER_INVALID;
-  std::vector<uint8_t> header_bytes(header_size);
-  // Assuming kMaxHeaderSize can fit in an int, the following cast is safe.
-  if (ReadAndHashBuffer(header_bytes.data(), header_size, file, hash) !=
-      static_cast<int>(header_size))
-    return VerifierResult::ERROR_HEADER_INVALID;
+bool StreamingVerifier::ParseHeader() {
+  const bool require_publisher_key =
+      format_ == VerifierFormat::CRX3_WITH_PUBLISHER_PROOF ||
+      format_ == VerifierFormat::CRX3_WITH_TEST_PUBLISHER_PROOF;
+  const bool accept_publisher_test_key =
+      format_ == VerifierFormat::CRX3_WITH_TEST_PUBLISHER_PROOF;
+
   CrxFileHeader header;
-  if (!header.ParseFromArray(header_bytes.data(), header_size))
-    return VerifierResult::ERROR_HEADER_INVALID;
+  if (!header.ParseFromArray(field_bytes_.data(), field_bytes_.size())) {
+    error_ = VerifierResult::ERROR_HEADER_INVALID;
+    return false;
+  }
 
   // Parse [signed-header].
   const std::string& signed_header_data_str = header.signed_header_data();
   SignedData signed_header_data;
-  if (!signed_header_data.ParseFromString(signed_header_data_str))
-    return VerifierResult::ERROR_HEADER_INVALID;
+  if (!signed_header_data.ParseFromString(signed_header_data_str)) {
+    error_ = VerifierResult::ERROR_HEADER_INVALID;
+    return false;
+  }
   const std::string& crx_id_encoded = signed_header_data.crx_id();
   const std::string declared_crx_id = id_util::GenerateIdFromHex(
       base::HexEncode(crx_id_encoded.data(), crx_id_encoded.size()));
@@ -129,17 +239,16 @@ VerifierResult VerifyCrx3(
       signed_header_size >> 24};
 
   // Create a set of all required key hashes.
-  std::set<std::vector<uint8_t>> required_key_set(required_key_hashes.begin(),
-                                                  required_key_hashes.end());
+  std::set<std::vector<uint8_t>> required_key_set(required_key_hashes_.begin(),
+                                                  required_key_hashes_.end());
 
   using ProofFetcher = const RepeatedProof& (CrxFileHeader::*)() const;
   ProofFetcher rsa = &CrxFileHeader::sha256_with_rsa;
   ProofFetcher ecdsa = &CrxFileHeader::sha256_with_ecdsa;
 
   std::string public_key_bytes;
-  VerifierCollection verifiers;
-  verifiers.reserve(header.sha256_with_rsa_size() +
-                    header.sha256_with_ecdsa_size());
+  verifiers_.reserve(header.sha256_with_rsa_size() +
+                     header.sha256_with_ecdsa_size());
   const std::vector<
       std::pair<ProofFetcher, crypto::SignatureVerifier::SignatureAlgorithm>>
       proof_types = {
@@ -177,94 +286,25 @@ VerifierResult VerifyCrx3(
                     "Unsupported char size.");
       if (!v->VerifyInit(proof_type.second,
                          base::as_bytes(base::make_span(sig)),
-                         base::as_bytes(base::make_span(key))))
-        return VerifierResult::ERROR_SIGNATURE_INITIALIZATION_FAILED;
+                         base::as_bytes(base::make_span(key)))) {
+        error_ = VerifierResult::ERROR_SIGNATURE_INITIALIZATION_FAILED;
+        return false;
+      }
       v->VerifyUpdate(kSignatureContext);
       v->VerifyUpdate(header_size_octets);
       v->VerifyUpdate(base::as_bytes(base::make_span(signed_header_data_str)));
-      verifiers.push_back(std::move(v));
+      verifiers_.push_back(std::move(v));
     }
   }
-  if (public_key_bytes.empty() || !required_key_set.empty())
-    return VerifierResult::ERROR_REQUIRED_PROOF_MISSING;
-
-  if (require_publisher_key && !found_publisher_key)
-    return VerifierResult::ERROR_REQUIRED_PROOF_MISSING;
-
-  // Update and finalize the verifiers with [archive].
-  if (!ReadHashAndVerifyArchive(file, hash, verifiers))
-    return VerifierResult::ERROR_SIGNATURE_VERIFICATION_FAILED;
-
-  base::Base64Encode(public_key_bytes, public_key);
-  *crx_id = declared_crx_id;
-  return VerifierResult::OK_FULL;
-}
-
-}  // namespace
-
-VerifierResult Verify(
-    const base::FilePath& crx_path,
-    const VerifierFormat& format,
-    const std::vector<std::vector<uint8_t>>& required_key_hashes,
-    const std::vector<uint8_t>& required_file_hash,
-    std::string* public_key,
-    std::string* crx_id) {
-  std::string public_key_local;
-  std::string crx_id_local;
-  base::File file(crx_path, base::File::FLAG_OPEN | base::File::FLAG_READ);
-  if (!file.IsValid())
-    return VerifierResult::ERROR_FILE_NOT_READABLE;
-
-  std::unique_ptr<crypto::SecureHash> file_hash =
-      crypto::SecureHash::Create(crypto::SecureHash::SHA256);
-
-  // Magic number.
-  bool diff = false;
-  char buffer[kCrxFileHeaderMagicSize] = {};
-  if (file.ReadAtCurrentPos(buffer, kCrxFileHeaderMagicSize) !=
-      kCrxFileHeaderMagicSize)
-    return VerifierResult::ERROR_HEADER_INVALID;
-  if (!strncmp(buffer, kCrxDiffFileHeaderMagic, kCrxFileHeaderMagicSize))
-    diff = true;
-  else if (strncmp(buffer, kCrxFileHeaderMagic, kCrxFileHeaderMagicSize))
-    return VerifierResult::ERROR_HEADER_INVALID;
-  file_hash->Update(buffer, sizeof(buffer));
-
-  // Version number.
-  const uint32_t version =
-      ReadAndHashLittleEndianUInt32(&file, file_hash.get());
-  VerifierResult result;
-  if (version == 3) {
-    bool require_publisher_key =
-        format == VerifierFormat::CRX3_WITH_PUBLISHER_PROOF ||
-        format == VerifierFormat::CRX3_WITH_TEST_PUBLISHER_PROOF;
-    result =
-        VerifyCrx3(&file, file_hash.get(), required_key_hashes,
-                   &public_key_local, &crx_id_local, require_publisher_key,
-                   format == VerifierFormat::CRX3_WITH_TEST_PUBLISHER_PROOF);
-  } else {
-    result = VerifierResult::ERROR_HEADER_INVALID;
-  }
-  if (result != VerifierResult::OK_FULL)
-    return result;
-
-  // Finalize file hash.
-  uint8_t final_hash[crypto::kSHA256Length] = {};
-  file_hash->Finish(final_hash, sizeof(final_hash));
-  if (!required_file_hash.empty()) {
-    if (required_file_hash.size() != crypto::kSHA256Length)
-      return VerifierResult::ERROR_EXPECTED_HASH_INVALID;
-    if (!crypto::SecureMemEqual(final_hash, required_file_hash.data(),
-                                crypto::kSHA256Length))
-      return VerifierResult::ERROR_FILE_HASH_FAILED;
+  if (public_key_bytes.empty() || !required_key_set.empty() ||
+      (require_publisher_key && !found_publisher_key)) {
+    error_ = VerifierResult::ERROR_REQUIRED_PROOF_MISSING;
+    return false;
   }
 
-  // All is well. Set the out-params and return.
-  if (public_key)
-    *public_key = public_key_local;
-  if (crx_id)
-    *crx_id = crx_id_local;
-  return diff ? VerifierResult::OK_DELTA : VerifierResult::OK_FULL;
+  public_key_ = public_key_bytes;
+  crx_id_ = declared_crx_id;
+  return true;
 }
 
 }  // namespace crx_file
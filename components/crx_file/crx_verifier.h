@@ -5,14 +5,26 @@
 #ifndef COMPONENTS_CRX_FILE_CRX_VERIFIER_H_
 #define COMPONENTS_CRX_FILE_CRX_VERIFIER_H_
 
+#include <stddef.h>
 #include <stdint.h>
+
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "base/containers/span.h"
+#include "base/macros.h"
+#include "base/optional.h"
+
 namespace base {
 class FilePath;
 }  // namespace base
 
+namespace crypto {
+class SecureHash;
+class SignatureVerifier;
+}  // namespace crypto
+
 namespace crx_file {
 
 enum class VerifierFormat {
@@ -50,6 +62,58 @@ VerifierResult Verify(
     std::string* public_key,
     std::string* crx_id);
 
+// Verifies a Crx from its bytes, as they arrive, with the same checks as
+// Verify(). The header is checked and the signature verifiers are set up as
+// soon as the header is complete, so a bad header is reported without waiting
+// for the archive, which then only updates the hash and the verifiers.
+class StreamingVerifier {
+ public:
+  StreamingVerifier(const VerifierFormat& format,
+                    const std::vector<std::vector<uint8_t>>& required_key_hashes,
+                    const std::vector<uint8_t>& required_file_hash);
+  ~StreamingVerifier();
+
+  // Consumes the next bytes of the Crx. Returns false as soon as the Crx is
+  // known to be invalid, after which the bytes are ignored and Finish()
+  // returns the error.
+  bool Update(base::span<const uint8_t> data);
+
+  // Ends the Crx and returns the verdict. Must be called once. The out-params
+  // are set as in Verify().
+  VerifierResult Finish(std::string* public_key, std::string* crx_id);
+
+ private:
+  enum class Field { kMagic, kVersion, kHeaderSize, kHeader, kArchive };
+
+  // Checks the field in |field_bytes_| and moves on to the next one. Returns
+  // false and sets |error_| if the field is invalid.
+  bool ParseField();
+
+  // Parses [header] and sets up the verifiers with the signed data before
+  // [archive].
+  bool ParseHeader();
+
+  const VerifierFormat format_;
+  const std::vector<std::vector<uint8_t>> required_key_hashes_;
+  const std::vector<uint8_t> required_file_hash_;
+
+  std::unique_ptr<crypto::SecureHash> file_hash_;
+  std::vector<std::unique_ptr<crypto::SignatureVerifier>> verifiers_;
+
+  // The field being read, its size and the bytes of it read so far. Fields
+  // are buffered until complete; the archive is not.
+  Field field_ = Field::kMagic;
+  size_t field_size_;
+  std::vector<uint8_t> field_bytes_;
+
+  bool diff_ = false;
+  std::string public_key_;
+  std::string crx_id_;
+  base::Optional<VerifierResult> error_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamingVerifier);
+};
+
 }  // namespace crx_file
 
 #endif  // COMPONENTS_CRX_FILE_CRX_VERIFIER_H_
@@ -3,8 +3,12 @@
 // found in the LICENSE file.
 
 #include "components/crx_file/crx_verifier.h"
+
+#include <algorithm>
+
 #include "base/base_paths.h"
 #include "base/files/file_path.h"
+#include "base/files/file_util.h"
 #include "base/path_service.h"
 #include "base/strings/string_number_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -230,4 +234,69 @@ TEST_F(CrxVerifierTest, RequiresDeveloperKey) {
   EXPECT_EQ("UNSET", public_key);
 }
 
+TEST_F(CrxVerifierTest, StreamingVerifierAcceptsAnyChunks) {
+  std::string contents;
+  ASSERT_TRUE(
+      base::ReadFileToString(TestFile("valid_no_publisher.crx3"), &contents));
+  const std::vector<std::vector<uint8_t>> keys;
+  std::vector<uint8_t> hash;
+  EXPECT_TRUE(base::HexStringToBytes(
+      "d033c510f9e4ee081ccb60ea2bf530dc2e5cb0e71085b55503c8b13b74515fe4",
+      &hash));
+  const auto bytes = base::as_bytes(base::make_span(contents));
+
+  for (size_t chunk_size : {size_t{1}, size_t{7}, size_t{4096}, bytes.size()}) {
+    SCOPED_TRACE(chunk_size);
+    StreamingVerifier verifier(VerifierFormat::CRX3, keys, hash);
+    for (size_t offset = 0; offset < bytes.size(); offset += chunk_size) {
+      ASSERT_TRUE(verifier.Update(bytes.subspan(
+          offset, std::min(chunk_size, bytes.size() - offset))));
+    }
+    std::string public_key = "UNSET";
+    std::string crx_id = "UNSET";
+    EXPECT_EQ(VerifierResult::OK_FULL, verifier.Finish(&public_key, &crx_id));
+    EXPECT_EQ(std::string(kOjjHash), crx_id);
+    EXPECT_EQ(std::string(kOjjKey), public_key);
+  }
+}
+
+TEST_F(CrxVerifierTest, StreamingVerifierRejectsEarly) {
+  const std::vector<uint8_t> hash;
+  const std::vector<std::vector<uint8_t>> keys;
+
+  // A Crx2 is rejected from its version number.
+  std::string crx2;
+  ASSERT_TRUE(base::ReadFileToString(TestFile("valid.crx2"), &crx2));
+  StreamingVerifier crx2_verifier(VerifierFormat::CRX3, keys, hash);
+  EXPECT_FALSE(crx2_verifier.Update(
+      base::as_bytes(base::make_span(crx2.data(), size_t{8}))));
+  EXPECT_EQ(VerifierResult::ERROR_HEADER_INVALID,
+            crx2_verifier.Finish(nullptr, nullptr));
+
+  // A missing proof is found from the header, before the archive.
+  std::string unsigned_crx;
+  ASSERT_TRUE(
+      base::ReadFileToString(TestFile("unsigned.crx3"), &unsigned_crx));
+  const auto bytes = base::as_bytes(base::make_span(unsigned_crx));
+  const uint32_t header_size =
+      bytes[8] | bytes[9] << 8 | bytes[10] << 16 | bytes[11] << 24;
+  StreamingVerifier unsigned_verifier(VerifierFormat::CRX3, keys, hash);
+  EXPECT_TRUE(unsigned_verifier.Update(bytes.first(11 + header_size)));
+  EXPECT_FALSE(unsigned_verifier.Update(bytes.subspan(11 + header_size, 1)));
+  std::string public_key = "UNSET";
+  EXPECT_EQ(VerifierResult::ERROR_REQUIRED_PROOF_MISSING,
+            unsigned_verifier.Finish(&public_key, nullptr));
+  EXPECT_EQ("UNSET", public_key);
+
+  // A truncated Crx fails its signatures.
+  std::string contents;
+  ASSERT_TRUE(
+      base::ReadFileToString(TestFile("valid_no_publisher.crx3"), &contents));
+  StreamingVerifier truncated_verifier(VerifierFormat::CRX3, keys, hash);
+  EXPECT_TRUE(truncated_verifier.Update(base::as_bytes(
+      base::make_span(contents.data(), contents.size() - 1))));
+  EXPECT_EQ(VerifierResult::ERROR_SIGNATURE_VERIFICATION_FAILED,
+            truncated_verifier.Finish(nullptr, nullptr));
+}
+
 }  // namespace crx_file
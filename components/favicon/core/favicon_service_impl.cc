@@ -6,17 +6,20 @@
 
 #include <stddef.h>
 #include <cmath>
+#include <tuple>
 #include <utility>
 
 #include "base/bind.h"
 #include "base/hash/hash.h"
 #include "base/single_thread_task_runner.h"
+#include "base/stl_util.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/trace_event/trace_event.h"
 #include "components/favicon/core/favicon_client.h"
 #include "components/favicon_base/favicon_util.h"
 #include "components/favicon_base/select_favicon_frames.h"
 #include "components/history/core/browser/history_service.h"
+#include "components/history/core/browser/history_types.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/gfx/codec/png_codec.h"
 #include "ui/gfx/favicon_size.h"
@@ -26,6 +29,10 @@
 namespace favicon {
 namespace {
 
+// How many decoded images are kept. A 16 DIP favicon at scales 1x and 2x takes
+// about 5 KB.
+const size_t kImageCacheSize = 200;
+
 // Returns a vector of pixel edge sizes from |size_in_dip| and
 // favicon_base::GetFaviconScales().
 std::vector<int> GetPixelSizesForFaviconScales(int size_in_dip) {
@@ -54,12 +61,37 @@ std::vector<SkBitmap> ExtractSkBitmapsToStore(const gfx::Image& image) {
 
 }  // namespace
 
+bool FaviconServiceImpl::ImageRequest::operator<(
+    const ImageRequest& other) const {
+  return std::tie(is_page_url, url, icon_type, size_in_dip) <
+         std::tie(other.is_page_url, other.url, other.icon_type,
+                  other.size_in_dip);
+}
+
+FaviconServiceImpl::ImageRequestWaiter::ImageRequestWaiter(
+    favicon_base::FaviconImageCallback callback,
+    base::CancelableTaskTracker::IsCanceledCallback is_canceled)
+    : callback(std::move(callback)), is_canceled(std::move(is_canceled)) {}
+
+FaviconServiceImpl::ImageRequestWaiter::ImageRequestWaiter(
+    ImageRequestWaiter&& other) = default;
+
+FaviconServiceImpl::ImageRequestWaiter::~ImageRequestWaiter() = default;
+
 FaviconServiceImpl::FaviconServiceImpl(
     std::unique_ptr<FaviconClient> favicon_client,
     history::HistoryService* history_service)
     : favicon_client_(std::move(favicon_client)),
-      history_service_(history_service) {
+      history_service_(history_service),
+      image_cache_(kImageCacheSize),
+      memory_pressure_listener_(
+          base::BindRepeating(&FaviconServiceImpl::OnMemoryPressure,
+                              base::Unretained(this))) {
   DCHECK(history_service_);
+  history_observer_.Add(history_service_);
+  favicons_changed_subscription_ =
+      history_service_->AddFaviconsChangedCallback(base::BindRepeating(
+          &FaviconServiceImpl::OnFaviconsChanged, base::Unretained(this)));
 }
 
 FaviconServiceImpl::~FaviconServiceImpl() {}
@@ -69,13 +101,10 @@ base::CancelableTaskTracker::TaskId FaviconServiceImpl::GetFaviconImage(
     favicon_base::FaviconImageCallback callback,
     base::CancelableTaskTracker* tracker) {
   TRACE_EVENT0("browser", "FaviconServiceImpl::GetFaviconImage");
-  favicon_base::FaviconResultsCallback callback_runner = base::BindOnce(
-      &FaviconServiceImpl::RunFaviconImageCallbackWithBitmapResults,
-      base::Unretained(this), std::move(callback), gfx::kFaviconSize);
-  return history_service_->GetFavicon(
-      icon_url, favicon_base::IconType::kFavicon,
-      GetPixelSizesForFaviconScales(gfx::kFaviconSize),
-      std::move(callback_runner), tracker);
+  return GetFaviconImageImpl(
+      {icon_url, /*is_page_url=*/false, favicon_base::IconType::kFavicon,
+       gfx::kFaviconSize},
+      std::move(callback), tracker);
 }
 
 base::CancelableTaskTracker::TaskId FaviconServiceImpl::GetRawFavicon(
@@ -117,14 +146,10 @@ FaviconServiceImpl::GetFaviconImageForPageURL(
     favicon_base::FaviconImageCallback callback,
     base::CancelableTaskTracker* tracker) {
   TRACE_EVENT0("browser", "FaviconServiceImpl::GetFaviconImageForPageURL");
-  return GetFaviconForPageURLImpl(
-      page_url, {favicon_base::IconType::kFavicon},
-      GetPixelSizesForFaviconScales(gfx::kFaviconSize),
-      /*fallback_to_host=*/false,
-      base::BindOnce(
-          &FaviconServiceImpl::RunFaviconImageCallbackWithBitmapResults,
-          base::Unretained(this), std::move(callback), gfx::kFaviconSize),
-      tracker);
+  return GetFaviconImageImpl(
+      {page_url, /*is_page_url=*/true, favicon_base::IconType::kFavicon,
+       gfx::kFaviconSize},
+      std::move(callback), tracker);
 }
 
 base::CancelableTaskTracker::TaskId FaviconServiceImpl::GetRawFaviconForPageURL(
@@ -188,6 +213,8 @@ FaviconServiceImpl::UpdateFaviconMappingsAndFetch(
     int desired_size_in_dip,
     favicon_base::FaviconResultsCallback callback,
     base::CancelableTaskTracker* tracker) {
+  InvalidateCachedImages(std::set<GURL>(page_urls.begin(), page_urls.end()),
+                         GURL());
   return history_service_->UpdateFaviconMappingsAndFetch(
       page_urls, icon_url, icon_type,
       GetPixelSizesForFaviconScales(desired_size_in_dip), std::move(callback),
@@ -197,6 +224,8 @@ FaviconServiceImpl::UpdateFaviconMappingsAndFetch(
 void FaviconServiceImpl::DeleteFaviconMappings(
     const base::flat_set<GURL>& page_urls,
     favicon_base::IconType icon_type) {
+  InvalidateCachedImages(std::set<GURL>(page_urls.begin(), page_urls.end()),
+                         GURL());
   return history_service_->DeleteFaviconMappings(page_urls, icon_type);
 }
 
@@ -227,6 +256,8 @@ void FaviconServiceImpl::TouchOnDemandFavicon(const GURL& icon_url) {
 
 void FaviconServiceImpl::SetImportedFavicons(
     const favicon_base::FaviconUsageDataList& favicon_usage) {
+  for (const favicon_base::FaviconUsageData& usage : favicon_usage)
+    InvalidateCachedImages(usage.urls, usage.favicon_url);
   history_service_->SetImportedFavicons(favicon_usage);
 }
 
@@ -242,6 +273,7 @@ void FaviconServiceImpl::MergeFavicon(
     favicon_base::IconType icon_type,
     scoped_refptr<base::RefCountedMemory> bitmap_data,
     const gfx::Size& pixel_size) {
+  InvalidateCachedImages({page_url}, icon_url);
   history_service_->MergeFavicon(page_url, icon_url, icon_type, bitmap_data,
                                  pixel_size);
 }
@@ -250,6 +282,8 @@ void FaviconServiceImpl::SetFavicons(const base::flat_set<GURL>& page_urls,
                                      const GURL& icon_url,
                                      favicon_base::IconType icon_type,
                                      const gfx::Image& image) {
+  InvalidateCachedImages(std::set<GURL>(page_urls.begin(), page_urls.end()),
+                         icon_url);
   history_service_->SetFavicons(page_urls, icon_type, icon_url,
                                 ExtractSkBitmapsToStore(image));
 }
@@ -258,6 +292,9 @@ void FaviconServiceImpl::CloneFaviconMappingsForPages(
     const GURL& page_url_to_read,
     const favicon_base::IconTypeSet& icon_types,
     const base::flat_set<GURL>& page_urls_to_write) {
+  InvalidateCachedImages(
+      std::set<GURL>(page_urls_to_write.begin(), page_urls_to_write.end()),
+      GURL());
   history_service_->CloneFaviconMappingsForPages(page_url_to_read, icon_types,
                                                  page_urls_to_write);
 }
@@ -276,6 +313,7 @@ void FaviconServiceImpl::SetOnDemandFavicons(
     favicon_base::IconType icon_type,
     const gfx::Image& image,
     base::OnceCallback<void(bool)> callback) {
+  InvalidateCachedImages({page_url}, icon_url);
   history_service_->SetOnDemandFavicons(page_url, icon_type, icon_url,
                                         ExtractSkBitmapsToStore(image),
                                         std::move(callback));
@@ -313,6 +351,149 @@ FaviconServiceImpl::GetFaviconForPageURLImpl(
       std::move(callback), tracker);
 }
 
+base::CancelableTaskTracker::TaskId FaviconServiceImpl::GetFaviconImageImpl(
+    const ImageRequest& request,
+    favicon_base::FaviconImageCallback callback,
+    base::CancelableTaskTracker* tracker) {
+  auto cached = image_cache_.Get(request);
+  if (cached != image_cache_.end()) {
+    // Still reply asynchronously, as callers expect.
+    return tracker->PostTask(
+        base::ThreadTaskRunnerHandle::Get().get(), FROM_HERE,
+        base::BindOnce(std::move(callback), cached->second));
+  }
+
+  base::CancelableTaskTracker::IsCanceledCallback is_canceled;
+  base::CancelableTaskTracker::TaskId task_id =
+      tracker->NewTrackedTaskId(&is_canceled);
+
+  auto joinable = joinable_image_fetches_.find(request);
+  if (joinable != joinable_image_fetches_.end()) {
+    image_fetch_waiters_[joinable->second].emplace_back(std::move(callback),
+                                                        std::move(is_canceled));
+    return task_id;
+  }
+
+  const ImageFetchId fetch_id = next_image_fetch_id_++;
+  joinable_image_fetches_[request] = fetch_id;
+  image_fetch_waiters_[fetch_id].emplace_back(std::move(callback),
+                                              std::move(is_canceled));
+
+  favicon_base::FaviconResultsCallback callback_runner = base::BindOnce(
+      &FaviconServiceImpl::RunFaviconImageCallbackWithBitmapResults,
+      base::Unretained(this),
+      base::BindOnce(&FaviconServiceImpl::OnFaviconImageFetched,
+                     base::Unretained(this), request, fetch_id),
+      request.size_in_dip);
+  std::vector<int> desired_sizes_in_pixel =
+      GetPixelSizesForFaviconScales(request.size_in_dip);
+  base::CancelableTaskTracker::TaskId fetch_task_id =
+      request.is_page_url
+          ? GetFaviconForPageURLImpl(request.url, {request.icon_type},
+                                     desired_sizes_in_pixel,
+                                     /*fallback_to_host=*/false,
+                                     std::move(callback_runner),
+                                     &image_fetch_tracker_)
+          : history_service_->GetFavicon(
+                request.url, request.icon_type, desired_sizes_in_pixel,
+                std::move(callback_runner), &image_fetch_tracker_);
+  if (fetch_task_id == base::CancelableTaskTracker::kBadTaskId) {
+    // Nobody else could have joined the read yet.
+    joinable_image_fetches_.erase(request);
+    image_fetch_waiters_.erase(fetch_id);
+    return base::CancelableTaskTracker::kBadTaskId;
+  }
+  return task_id;
+}
+
+void FaviconServiceImpl::OnFaviconImageFetched(
+    const ImageRequest& request,
+    ImageFetchId fetch_id,
+    const favicon_base::FaviconImageResult& result) {
+  auto waiters = image_fetch_waiters_.find(fetch_id);
+  DCHECK(waiters != image_fetch_waiters_.end());
+  std::vector<ImageRequestWaiter> callers = std::move(waiters->second);
+  image_fetch_waiters_.erase(waiters);
+
+  auto joinable = joinable_image_fetches_.find(request);
+  if (joinable != joinable_image_fetches_.end() &&
+      joinable->second == fetch_id) {
+    joinable_image_fetches_.erase(joinable);
+    if (!result.image.IsEmpty())
+      image_cache_.Put(request, result);
+  }
+
+  for (ImageRequestWaiter& caller : callers) {
+    if (!caller.is_canceled.Run())
+      std::move(caller.callback).Run(result);
+  }
+}
+
+void FaviconServiceImpl::InvalidateCachedImages(
+    const std::set<GURL>& page_urls,
+    const GURL& icon_url) {
+  auto is_requested_url = [&page_urls, &icon_url](const ImageRequest& request) {
+    if (request.is_page_url)
+      return base::Contains(page_urls, request.url);
+    return !icon_url.is_empty() && request.url == icon_url;
+  };
+
+  for (auto it = image_cache_.begin(); it != image_cache_.end();) {
+    if (is_requested_url(it->first) ||
+        (!icon_url.is_empty() && it->second.icon_url == icon_url)) {
+      it = image_cache_.Erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // Which icon a read for a page URL ends up with isn't known until it
+  // replies, so any of them may be reading |icon_url|.
+  base::EraseIf(joinable_image_fetches_, [&](const auto& fetch) {
+    return is_requested_url(fetch.first) ||
+           (!icon_url.is_empty() && fetch.first.is_page_url);
+  });
+}
+
+void FaviconServiceImpl::OnURLsDeleted(
+    history::HistoryService* history_service,
+    const history::DeletionInfo& deletion_info) {
+  // Expired pages are never shown again, so their images may stay.
+  if (deletion_info.is_from_expiration())
+    return;
+
+  if (deletion_info.IsAllHistory()) {
+    image_cache_.Clear();
+    joinable_image_fetches_.clear();
+    return;
+  }
+
+  std::set<GURL> page_urls;
+  for (const history::URLRow& row : deletion_info.deleted_rows())
+    page_urls.insert(row.url());
+  InvalidateCachedImages(page_urls, GURL());
+}
+
+void FaviconServiceImpl::OnFaviconsChanged(const std::set<GURL>& page_urls,
+                                           const GURL& icon_url) {
+  InvalidateCachedImages(page_urls, icon_url);
+}
+
+void FaviconServiceImpl::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  switch (level) {
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE:
+      break;
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE:
+      // Keep the most recently used half.
+      image_cache_.ShrinkToSize(image_cache_.size() / 2);
+      break;
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL:
+      image_cache_.Clear();
+      break;
+  }
+}
+
 void FaviconServiceImpl::RunFaviconImageCallbackWithBitmapResults(
     favicon_base::FaviconImageCallback callback,
     int desired_size_in_dip,
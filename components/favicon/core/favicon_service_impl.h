@@ -7,21 +7,27 @@
 
 #include <stdint.h>
 
+#include <map>
 #include <memory>
+#include <set>
 #include <unordered_set>
 #include <vector>
 
 #include "base/callback.h"
+#include "base/callback_list.h"
 #include "base/containers/flat_set.h"
+#include "base/containers/mru_cache.h"
 #include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/memory/ref_counted.h"
+#include "base/scoped_observer.h"
 #include "base/task/cancelable_task_tracker.h"
 #include "components/favicon/core/favicon_service.h"
 #include "components/favicon_base/favicon_callback.h"
 #include "components/favicon_base/favicon_types.h"
 #include "components/favicon_base/favicon_usage_data.h"
-
-class GURL;
+#include "components/history/core/browser/history_service_observer.h"
+#include "url/gurl.h"
 
 namespace history {
 class HistoryService;
@@ -34,7 +40,13 @@ class FaviconClient;
 // The favicon service provides methods to access favicons. It calls the history
 // backend behind the scenes. The callbacks are run asynchronously, even in the
 // case of an error.
-class FaviconServiceImpl : public FaviconService {
+//
+// The images returned by GetFaviconImage() and GetFaviconImageForPageURL() are
+// kept decoded in memory, so that the same favicon shown in many places is
+// read from the database and decoded once. Concurrent requests for the same
+// image share a single database read.
+class FaviconServiceImpl : public FaviconService,
+                           public history::HistoryServiceObserver {
  public:
   // |history_service| most not be nullptr and  must outlive this object.
   FaviconServiceImpl(std::unique_ptr<FaviconClient> favicon_client,
@@ -129,6 +141,61 @@ class FaviconServiceImpl : public FaviconService {
  private:
   typedef uint32_t MissingFaviconURLHash;
 
+  // What a decoded image is cached and shared under.
+  struct ImageRequest {
+    bool operator<(const ImageRequest& other) const;
+
+    GURL url;
+    // Whether |url| is a page URL, rather than an icon URL.
+    bool is_page_url;
+    favicon_base::IconType icon_type;
+    int size_in_dip;
+  };
+
+  // A caller of GetFaviconImage() or GetFaviconImageForPageURL() waiting for
+  // a database read.
+  struct ImageRequestWaiter {
+    ImageRequestWaiter(
+        favicon_base::FaviconImageCallback callback,
+        base::CancelableTaskTracker::IsCanceledCallback is_canceled);
+    ImageRequestWaiter(ImageRequestWaiter&& other);
+    ~ImageRequestWaiter();
+
+    favicon_base::FaviconImageCallback callback;
+    // Tells whether the caller's task was canceled.
+    base::CancelableTaskTracker::IsCanceledCallback is_canceled;
+  };
+
+  using ImageFetchId = int64_t;
+
+  // Serves |request| from |image_cache_|, or from the database read already
+  // running for it, or else from a new read.
+  base::CancelableTaskTracker::TaskId GetFaviconImageImpl(
+      const ImageRequest& request,
+      favicon_base::FaviconImageCallback callback,
+      base::CancelableTaskTracker* tracker);
+
+  // Caches the image read for |request| by the read |fetch_id| and runs the
+  // callbacks of the callers waiting for it.
+  void OnFaviconImageFetched(const ImageRequest& request,
+                             ImageFetchId fetch_id,
+                             const favicon_base::FaviconImageResult& result);
+
+  // Forgets the cached images of |page_urls| and of |icon_url|. The reads
+  // running for them still run their callbacks, but their results are not
+  // cached and new requests don't share them.
+  void InvalidateCachedImages(const std::set<GURL>& page_urls,
+                              const GURL& icon_url);
+
+  // history::HistoryServiceObserver:
+  void OnURLsDeleted(history::HistoryService* history_service,
+                     const history::DeletionInfo& deletion_info) override;
+  void OnFaviconsChanged(const std::set<GURL>& page_urls,
+                         const GURL& icon_url);
+
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
   // Helper function for GetFaviconImageForPageURL(), GetRawFaviconForPageURL()
   // and GetFaviconForPageURL().
   base::CancelableTaskTracker::TaskId GetFaviconForPageURLImpl(
@@ -163,6 +230,28 @@ class FaviconServiceImpl : public FaviconService {
   std::unique_ptr<FaviconClient> favicon_client_;
   history::HistoryService* history_service_;
 
+  // Decoded images, with the icon URL they were read from. Only non-empty
+  // images are cached.
+  base::MRUCache<ImageRequest, favicon_base::FaviconImageResult> image_cache_;
+
+  // The database read that new requests for an image join, by image. A read
+  // stops being joinable once the image is invalidated.
+  std::map<ImageRequest, ImageFetchId> joinable_image_fetches_;
+  // The callers waiting for each running read.
+  std::map<ImageFetchId, std::vector<ImageRequestWaiter>> image_fetch_waiters_;
+  ImageFetchId next_image_fetch_id_ = 0;
+
+  ScopedObserver<history::HistoryService, history::HistoryServiceObserver>
+      history_observer_{this};
+  std::unique_ptr<base::CallbackList<void(const std::set<GURL>&,
+                                          const GURL&)>::Subscription>
+      favicons_changed_subscription_;
+  base::MemoryPressureListener memory_pressure_listener_;
+
+  // Tracks the database reads shared by the image requests. Declared last so
+  // that no read is replied to while the members above are destroyed.
+  base::CancelableTaskTracker image_fetch_tracker_;
+
   DISALLOW_COPY_AND_ASSIGN(FaviconServiceImpl);
 };
 
@@ -6,16 +6,164 @@
 
 #include <memory>
 
+#include "base/bind.h"
 #include "base/files/scoped_temp_dir.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/run_loop.h"
+#include "base/task/cancelable_task_tracker.h"
 #include "base/test/task_environment.h"
 #include "components/favicon/core/favicon_client.h"
 #include "components/history/core/browser/history_service.h"
 #include "components/history/core/test/history_service_test_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/favicon_size.h"
+#include "ui/gfx/image/image.h"
+#include "ui/gfx/image/image_skia.h"
 
 namespace favicon {
 namespace {
 
+const char kPageURL[] = "http://www.google.com/";
+const char kIconURL[] = "http://www.google.com/favicon.ico";
+
+SkBitmap CreateBitmap(SkColor color) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(gfx::kFaviconSize, gfx::kFaviconSize);
+  bitmap.eraseColor(color);
+  return bitmap;
+}
+
+bool IsSameImage(const favicon_base::FaviconImageResult& a,
+                 const favicon_base::FaviconImageResult& b) {
+  return a.image.AsImageSkia().BackedBySameObjectAs(b.image.AsImageSkia());
+}
+
+// Tests the decoded images of GetFaviconImageForPageURL(), with a history
+// database.
+class FaviconServiceImplImageTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(history_dir_.CreateUniqueTempDir());
+    history_service_ = history::CreateHistoryService(history_dir_.GetPath(),
+                                                     /*create_db=*/true);
+    ASSERT_TRUE(history_service_);
+    favicon_service_ = std::make_unique<FaviconServiceImpl>(
+        /*favicon_client=*/nullptr, history_service_.get());
+  }
+
+  void SetFavicon(SkColor color) {
+    favicon_service_->SetFavicons({GURL(kPageURL)}, GURL(kIconURL),
+                                  favicon_base::IconType::kFavicon,
+                                  gfx::Image::CreateFrom1xBitmap(
+                                      CreateBitmap(color)));
+    WaitForHistory();
+  }
+
+  // Requests the image of kPageURL, which is stored in |result| once read.
+  base::CancelableTaskTracker::TaskId RequestImage(
+      favicon_base::FaviconImageResult* result) {
+    return favicon_service_->GetFaviconImageForPageURL(
+        GURL(kPageURL),
+        base::BindOnce(
+            [](favicon_base::FaviconImageResult* result,
+               const favicon_base::FaviconImageResult& image_result) {
+              *result = image_result;
+            },
+            result),
+        &tracker_);
+  }
+
+  // Waits for the history backend and for its replies.
+  void WaitForHistory() {
+    history::BlockUntilHistoryProcessesPendingRequests(history_service_.get());
+    base::RunLoop().RunUntilIdle();
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  base::ScopedTempDir history_dir_;
+  std::unique_ptr<history::HistoryService> history_service_;
+  std::unique_ptr<FaviconServiceImpl> favicon_service_;
+  base::CancelableTaskTracker tracker_;
+};
+
+TEST_F(FaviconServiceImplImageTest, ShouldShareConcurrentReads) {
+  SetFavicon(SK_ColorRED);
+
+  favicon_base::FaviconImageResult result1;
+  favicon_base::FaviconImageResult result2;
+  RequestImage(&result1);
+  RequestImage(&result2);
+  WaitForHistory();
+
+  ASSERT_FALSE(result1.image.IsEmpty());
+  EXPECT_EQ(GURL(kIconURL), result1.icon_url);
+  EXPECT_TRUE(IsSameImage(result1, result2));
+}
+
+TEST_F(FaviconServiceImplImageTest, ShouldReplyFromCacheAsynchronously) {
+  SetFavicon(SK_ColorRED);
+  favicon_base::FaviconImageResult result1;
+  RequestImage(&result1);
+  WaitForHistory();
+  ASSERT_FALSE(result1.image.IsEmpty());
+
+  favicon_base::FaviconImageResult result2;
+  RequestImage(&result2);
+  EXPECT_TRUE(result2.image.IsEmpty());
+  base::RunLoop().RunUntilIdle();
+  EXPECT_TRUE(IsSameImage(result1, result2));
+  EXPECT_EQ(GURL(kIconURL), result2.icon_url);
+}
+
+TEST_F(FaviconServiceImplImageTest, ShouldNotRunCanceledCallbacks) {
+  SetFavicon(SK_ColorRED);
+
+  favicon_base::FaviconImageResult result1;
+  favicon_base::FaviconImageResult result2;
+  base::CancelableTaskTracker::TaskId task_id = RequestImage(&result1);
+  RequestImage(&result2);
+  tracker_.TryCancel(task_id);
+  WaitForHistory();
+
+  EXPECT_TRUE(result1.image.IsEmpty());
+  EXPECT_FALSE(result2.image.IsEmpty());
+}
+
+TEST_F(FaviconServiceImplImageTest, ShouldInvalidateChangedFavicons) {
+  SetFavicon(SK_ColorRED);
+  favicon_base::FaviconImageResult result1;
+  RequestImage(&result1);
+  WaitForHistory();
+  ASSERT_FALSE(result1.image.IsEmpty());
+  EXPECT_EQ(SK_ColorRED, result1.image.ToSkBitmap()->getColor(0, 0));
+
+  SetFavicon(SK_ColorBLUE);
+  favicon_base::FaviconImageResult result2;
+  RequestImage(&result2);
+  WaitForHistory();
+  ASSERT_FALSE(result2.image.IsEmpty());
+  EXPECT_EQ(SK_ColorBLUE, result2.image.ToSkBitmap()->getColor(0, 0));
+}
+
+TEST_F(FaviconServiceImplImageTest, ShouldDropImagesOnMemoryPressure) {
+  SetFavicon(SK_ColorRED);
+  favicon_base::FaviconImageResult result1;
+  RequestImage(&result1);
+  WaitForHistory();
+  ASSERT_FALSE(result1.image.IsEmpty());
+
+  base::MemoryPressureListener::SimulatePressureNotification(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  base::RunLoop().RunUntilIdle();
+
+  favicon_base::FaviconImageResult result2;
+  RequestImage(&result2);
+  WaitForHistory();
+  ASSERT_FALSE(result2.image.IsEmpty());
+  EXPECT_FALSE(IsSameImage(result1, result2));
+}
+
 TEST(FaviconServiceImplTest, ShouldCacheUnableToDownloadFavicons) {
   base::test::TaskEnvironment task_environment;
   base::ScopedTempDir history_dir;
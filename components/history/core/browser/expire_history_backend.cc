@@ -18,6 +18,7 @@
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/numerics/ranges.h"
 #include "base/sequenced_task_runner.h"
 #include "base/stl_util.h"
 #include "build/build_config.h"
@@ -103,9 +104,22 @@ class AutoSubframeVisitsReader : public ExpiringVisitsReader {
 };
 
 // The number of visits we will expire very time we check for old items. This
-// Prevents us from doing too much work any given time.
+// Prevents us from doing too much work any given time. This is the size of the
+// first batch, and the least any batch deletes.
 const int kNumExpirePerIteration = 32;
 
+// The most visits one batch deletes.
+const int kMaxNumExpirePerBatch = 1024;
+
+// How long one periodic expiration may keep the history sequence busy. The
+// other history requests wait for it.
+constexpr base::TimeDelta kExpireSliceBudget =
+    base::TimeDelta::FromMilliseconds(50);
+
+// How long each batch should take, so that a slice runs a few of them.
+constexpr base::TimeDelta kExpireBatchTarget =
+    base::TimeDelta::FromMilliseconds(10);
+
 // The number of seconds between checking for items that should be expired when
 // we think there might be more items to expire. This timeout is used when the
 // last expiration found at least kNumExpirePerIteration and we want to check
@@ -136,6 +150,23 @@ bool IsAnyURLPinned(HistoryBackendClient* backend_client,
   return false;
 }
 
+// Keeps only the last of the modifications of each URL, and none of those of
+// URLs deleted since, as a URL may change in several batches of a slice.
+void RemoveSupersededModifications(URLRows* modified_urls,
+                                   const URLRows& deleted_urls) {
+  std::set<URLID> superseded;
+  for (const URLRow& row : deleted_urls)
+    superseded.insert(row.id());
+  URLRows latest;
+  for (auto row = modified_urls->rbegin(); row != modified_urls->rend();
+       ++row) {
+    if (superseded.insert(row->id()).second)
+      latest.push_back(*row);
+  }
+  std::reverse(latest.begin(), latest.end());
+  modified_urls->swap(latest);
+}
+
 }  // namespace
 
 namespace internal {
@@ -149,6 +180,19 @@ constexpr bool kClearOldOnDemandFaviconsEnabled = false;
 
 const int kOnDemandFaviconIsOldAfterDays = 30;
 
+int GetNextExpireBatchSize(int batch_size, base::TimeDelta elapsed) {
+  // Aim for kExpireBatchTarget, but change by at most twofold at once, so that
+  // a single slow or fast batch doesn't swing the size.
+  double scale = 2.0;
+  if (!elapsed.is_zero()) {
+    scale = base::ClampToRange(
+        kExpireBatchTarget.InMicrosecondsF() / elapsed.InMicrosecondsF(), 0.5,
+        2.0);
+  }
+  return base::ClampToRange(static_cast<int>(batch_size * scale),
+                            kNumExpirePerIteration, kMaxNumExpirePerBatch);
+}
+
 }  // namespace internal
 
 // ExpireHistoryBackend::DeleteEffects ----------------------------------------
@@ -169,6 +213,7 @@ ExpireHistoryBackend::ExpireHistoryBackend(
     : notifier_(notifier),
       main_db_(nullptr),
       thumb_db_(nullptr),
+      expire_batch_size_(kNumExpirePerIteration),
       backend_client_(backend_client),
       task_runner_(task_runner) {
   DCHECK(notifier_);
@@ -464,10 +509,10 @@ VisitVector ExpireHistoryBackend::GetVisitsAndRedirectParents(
 
 void ExpireHistoryBackend::DeleteVisitRelatedInfo(const VisitVector& visits,
                                                   DeleteEffects* effects) {
-  for (size_t i = 0; i < visits.size(); i++) {
-    // Delete the visit itself.
-    main_db_->DeleteVisit(visits[i]);
+  // Delete the visits themselves.
+  main_db_->DeleteVisits(visits);
 
+  for (size_t i = 0; i < visits.size(); i++) {
     // Add the URL row to the affected URL list.
     if (!effects->affected_urls.count(visits[i].url_id)) {
       URLRow row;
@@ -606,8 +651,8 @@ void ExpireHistoryBackend::DoExpireIteration() {
   }
 
   const ExpiringVisitsReader* reader = work_queue_.front();
-  bool more_to_expire = ExpireSomeOldHistory(
-      GetCurrentExpirationTime(), reader, kNumExpirePerIteration);
+  bool more_to_expire = ExpireOldHistorySlice(GetCurrentExpirationTime(),
+                                              reader, kExpireSliceBudget);
 
   work_queue_.pop();
   if (more_to_expire) {
@@ -631,6 +676,56 @@ bool ExpireHistoryBackend::ExpireSomeOldHistory(
   if (!main_db_)
     return false;
 
+  DeleteEffects deleted_effects;
+  bool more_to_expire =
+      ExpireOldVisits(end_time, reader, max_visits, &deleted_effects);
+  DeleteFaviconsIfPossible(&deleted_effects);
+
+  BroadcastNotifications(&deleted_effects, DELETION_EXPIRED,
+                         DeletionTimeRange::Invalid(), base::nullopt);
+
+  return more_to_expire;
+}
+
+bool ExpireHistoryBackend::ExpireOldHistorySlice(
+    base::Time end_time,
+    const ExpiringVisitsReader* reader,
+    base::TimeDelta budget) {
+  if (!main_db_)
+    return false;
+
+  const base::TimeTicks slice_start = base::TimeTicks::Now();
+  DeleteEffects deleted_effects;
+  bool more_to_expire;
+  do {
+    // The rows of the URLs are read again for each batch, as the previous one
+    // may have updated them.
+    deleted_effects.affected_urls.clear();
+    const base::TimeTicks batch_start = base::TimeTicks::Now();
+    more_to_expire = ExpireOldVisits(end_time, reader, expire_batch_size_,
+                                     &deleted_effects);
+    // Only a full batch tells how long that many visits take.
+    if (more_to_expire) {
+      expire_batch_size_ = internal::GetNextExpireBatchSize(
+          expire_batch_size_, base::TimeTicks::Now() - batch_start);
+    }
+  } while (more_to_expire && base::TimeTicks::Now() - slice_start < budget);
+
+  // Favicons are checked, and the in-memory URL index and visited links
+  // updated, once for the whole slice.
+  DeleteFaviconsIfPossible(&deleted_effects);
+  RemoveSupersededModifications(&deleted_effects.modified_urls,
+                                deleted_effects.deleted_urls);
+  BroadcastNotifications(&deleted_effects, DELETION_EXPIRED,
+                         DeletionTimeRange::Invalid(), base::nullopt);
+
+  return more_to_expire;
+}
+
+bool ExpireHistoryBackend::ExpireOldVisits(base::Time end_time,
+                                           const ExpiringVisitsReader* reader,
+                                           int max_visits,
+                                           DeleteEffects* effects) {
   // Add an extra time unit to given end time, because
   // GetAllVisitsInRange, et al. queries' end value is non-inclusive.
   base::Time effective_end_time =
@@ -640,14 +735,8 @@ bool ExpireHistoryBackend::ExpireSomeOldHistory(
   bool more_to_expire = reader->Read(effective_end_time, main_db_,
                                      &deleted_visits, max_visits);
 
-  DeleteEffects deleted_effects;
-  DeleteVisitRelatedInfo(deleted_visits, &deleted_effects);
-  ExpireURLsForVisits(deleted_visits, &deleted_effects);
-  DeleteFaviconsIfPossible(&deleted_effects);
-
-  BroadcastNotifications(&deleted_effects, DELETION_EXPIRED,
-                         DeletionTimeRange::Invalid(), base::nullopt);
-
+  DeleteVisitRelatedInfo(deleted_visits, effects);
+  ExpireURLsForVisits(deleted_visits, effects);
   return more_to_expire;
 }
 
@@ -46,6 +46,10 @@ typedef std::vector<const ExpiringVisitsReader*> ExpiringVisitsReaders;
 namespace internal {
 // The minimum number of days since last use for an icon to be considered old.
 extern const int kOnDemandFaviconIsOldAfterDays;
+
+// Returns how many visits the next batch of periodic expiration should delete,
+// given that the last batch deleted |batch_size| visits in |elapsed|.
+int GetNextExpireBatchSize(int batch_size, base::TimeDelta elapsed);
 }  // namespace internal
 
 // Helper component to HistoryBackend that manages expiration and deleting of
@@ -113,6 +117,7 @@ class ExpireHistoryBackend {
  private:
   FRIEND_TEST_ALL_PREFIXES(ExpireHistoryTest, DeleteFaviconsIfPossible);
   FRIEND_TEST_ALL_PREFIXES(ExpireHistoryTest, ExpireSomeOldHistory);
+  FRIEND_TEST_ALL_PREFIXES(ExpireHistoryTest, ExpireOldHistorySlice);
   FRIEND_TEST_ALL_PREFIXES(ExpireHistoryTest, ExpiringVisitsReader);
   FRIEND_TEST_ALL_PREFIXES(ExpireHistoryTest, ExpireSomeOldHistoryWithSource);
   FRIEND_TEST_ALL_PREFIXES(ExpireHistoryTest,
@@ -248,6 +253,21 @@ class ExpireHistoryBackend {
                              const ExpiringVisitsReader* reader,
                              int max_visits);
 
+  // Expires old history as ExpireSomeOldHistory() does, in batches of
+  // |expire_batch_size_| visits, until there is none left or |budget| is
+  // spent. Observers are notified once, for all the batches.
+  bool ExpireOldHistorySlice(base::Time end_time,
+                             const ExpiringVisitsReader* reader,
+                             base::TimeDelta budget);
+
+  // Deletes up to |max_visits| visits read by |reader| and the URLs left
+  // without visits, adding them to |effects|. Favicons aren't checked and
+  // observers aren't notified. Returns whether there may be more to expire.
+  bool ExpireOldVisits(base::Time end_time,
+                       const ExpiringVisitsReader* reader,
+                       int max_visits,
+                       DeleteEffects* effects);
+
   // Tries to detect possible bad history or inconsistencies in the database
   // and deletes items. For example, URLs with no visits.
   void ParanoidExpireHistory();
@@ -277,6 +297,10 @@ class ExpireHistoryBackend {
   // The time at which we expect the expiration code to run.
   base::Time expected_expiration_time_;
 
+  // How many visits each batch of periodic expiration deletes. This follows
+  // how long the batches take.
+  int expire_batch_size_;
+
   // The lastly used threshold for "old" on-demand favicons.
   base::Time last_on_demand_expiration_threshold_;
 
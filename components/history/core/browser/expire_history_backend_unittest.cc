@@ -1078,6 +1078,46 @@ TEST_F(ExpireHistoryTest, ExpireSomeOldHistory) {
   EXPECT_EQ(nullptr, GetLastDeletionInfo());
 }
 
+// Tests that a slice of periodic expiration goes on batch after batch, and
+// notifies observers once for all of them.
+TEST_F(ExpireHistoryTest, ExpireOldHistorySlice) {
+  URLID url_ids[3];
+  base::Time visit_times[4];
+  AddExampleData(url_ids, visit_times);
+  const ExpiringVisitsReader* reader = expirer_.GetAllVisitsReader();
+
+  // The first batch deletes a single visit, the following ones more.
+  expirer_.expire_batch_size_ = 1;
+  EXPECT_FALSE(expirer_.ExpireOldHistorySlice(visit_times[2], reader,
+                                              base::TimeDelta::Max()));
+
+  URLRow temp_row;
+  EXPECT_FALSE(main_db_->GetURLRow(url_ids[0], &temp_row));
+  EXPECT_FALSE(main_db_->GetURLRow(url_ids[1], &temp_row));
+  EXPECT_TRUE(main_db_->GetURLRow(url_ids[2], &temp_row));
+
+  ASSERT_EQ(1U, urls_deleted_notifications_.size());
+  EXPECT_TRUE(GetLastDeletionInfo()->is_from_expiration());
+  EXPECT_EQ(2U, GetLastDeletionInfo()->deleted_rows().size());
+  EXPECT_TRUE(urls_modified_notifications_.empty());
+}
+
+TEST_F(ExpireHistoryTest, GetNextExpireBatchSize) {
+  const base::TimeDelta kFast = base::TimeDelta::FromMicroseconds(1);
+  const base::TimeDelta kSlow = base::TimeDelta::FromSeconds(1);
+
+  // Batches grow and shrink twofold at most, and stay within bounds.
+  EXPECT_EQ(128, internal::GetNextExpireBatchSize(64, kFast));
+  EXPECT_EQ(128, internal::GetNextExpireBatchSize(64, base::TimeDelta()));
+  EXPECT_EQ(64, internal::GetNextExpireBatchSize(128, kSlow));
+  EXPECT_EQ(1024, internal::GetNextExpireBatchSize(1024, kFast));
+  EXPECT_EQ(32, internal::GetNextExpireBatchSize(32, kSlow));
+
+  // A batch that took its share of the budget keeps its size.
+  EXPECT_EQ(64, internal::GetNextExpireBatchSize(
+                    64, base::TimeDelta::FromMilliseconds(10)));
+}
+
 TEST_F(ExpireHistoryTest, ExpiringVisitsReader) {
   URLID url_ids[3];
   base::Time visit_times[4];
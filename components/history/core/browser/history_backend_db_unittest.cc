@@ -1855,5 +1855,60 @@ TEST_F(HistoryBackendDBTest, QuerySegmentUsage) {
   EXPECT_EQ(segment_id2, results2[0]->GetID());
 }
 
+TEST_F(HistoryBackendDBTest, QuerySegmentUsageAfterVisits) {
+  CreateBackendAndDatabase();
+
+  const GURL url1("http://www.bar.com");
+  const GURL url2("http://www.foo.com");
+  const GURL url3("http://www.baz.com");
+  const base::Time time(base::Time::Now());
+
+  URLID url_id1 = db_->AddURL(URLRow(url1));
+  ASSERT_NE(0, url_id1);
+  URLID url_id2 = db_->AddURL(URLRow(url2));
+  ASSERT_NE(0, url_id2);
+  URLID url_id3 = db_->AddURL(URLRow(url3));
+  ASSERT_NE(0, url_id3);
+
+  SegmentID segment_id1 = db_->CreateSegment(
+      url_id1, VisitSegmentDatabase::ComputeSegmentName(url1));
+  ASSERT_NE(0, segment_id1);
+  SegmentID segment_id2 = db_->CreateSegment(
+      url_id2, VisitSegmentDatabase::ComputeSegmentName(url2));
+  ASSERT_NE(0, segment_id2);
+  SegmentID segment_id3 = db_->CreateSegment(
+      url_id3, VisitSegmentDatabase::ComputeSegmentName(url3));
+  ASSERT_NE(0, segment_id3);
+
+  ASSERT_TRUE(db_->IncreaseSegmentVisitCount(segment_id1, time, 10));
+  ASSERT_TRUE(db_->IncreaseSegmentVisitCount(segment_id2, time, 5));
+
+  std::vector<std::unique_ptr<PageUsageData>> results =
+      db_->QuerySegmentUsage(time, 10, base::Callback<bool(const GURL&)>());
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ(segment_id1, results[0]->GetID());
+  EXPECT_EQ(segment_id2, results[1]->GetID());
+
+  // Visits after the first query reorder the ranking kept since, and add new
+  // segments to it.
+  ASSERT_TRUE(db_->IncreaseSegmentVisitCount(segment_id2, time, 20));
+  ASSERT_TRUE(db_->IncreaseSegmentVisitCount(segment_id3, time, 1));
+  results =
+      db_->QuerySegmentUsage(time, 10, base::Callback<bool(const GURL&)>());
+  ASSERT_EQ(3u, results.size());
+  EXPECT_EQ(segment_id2, results[0]->GetID());
+  EXPECT_EQ(segment_id1, results[1]->GetID());
+  EXPECT_EQ(segment_id3, results[2]->GetID());
+  EXPECT_GT(results[0]->GetScore(), results[1]->GetScore());
+
+  // Deleted segments leave the ranking.
+  ASSERT_TRUE(db_->DeleteSegmentForURL(url_id2));
+  results =
+      db_->QuerySegmentUsage(time, 10, base::Callback<bool(const GURL&)>());
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ(segment_id1, results[0]->GetID());
+  EXPECT_EQ(segment_id3, results[1]->GetID());
+}
+
 }  // namespace
 }  // namespace history
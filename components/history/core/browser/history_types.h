@@ -425,6 +425,8 @@ struct TopSitesDelta {
   MostVisitedURLList deleted;
   MostVisitedURLWithRankList added;
   MostVisitedURLWithRankList moved;
+  // URLs in both lists whose title or redirects changed.
+  MostVisitedURLList changed;
 };
 
 typedef base::RefCountedData<MostVisitedURLList> MostVisitedThreadSafe;
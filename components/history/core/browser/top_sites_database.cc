@@ -394,6 +394,9 @@ void TopSitesDatabase::ApplyDelta(const TopSitesDelta& delta) {
   for (size_t i = 0; i < delta.moved.size(); ++i)
     UpdateSiteRankNoTransaction(delta.moved[i].url, delta.moved[i].rank);
 
+  for (size_t i = 0; i < delta.changed.size(); ++i)
+    UpdateSite(delta.changed[i]);
+
   transaction.Commit();
 }
 
@@ -483,10 +486,11 @@ void TopSitesDatabase::AddSite(const MostVisitedURL& url, int new_rank) {
 bool TopSitesDatabase::UpdateSite(const MostVisitedURL& url) {
   sql::Statement statement(db_->GetCachedStatement(SQL_FROM_HERE,
                                                    "UPDATE top_sites SET "
-                                                   "title = ?, redirects = ?"
+                                                   "title = ?, redirects = ? "
                                                    "WHERE url = ?"));
   statement.BindString16(0, url.title);
   statement.BindString(1, GetRedirects(url));
+  statement.BindString(2, url.url.spec());
 
   return statement.Run();
 }
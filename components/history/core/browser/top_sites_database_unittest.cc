@@ -486,6 +486,27 @@ TEST_F(TopSitesDatabaseTest, ApplyDelta_Move) {
   VerifyURLsEqual(std::vector<GURL>({kUrl0, kUrl2, kUrl1}), urls);
 }
 
+TEST_F(TopSitesDatabaseTest, ApplyDelta_Change) {
+  ASSERT_TRUE(CreateDatabaseFromSQL(file_name_, "TopSites.v4.sql"));
+
+  TopSitesDatabase db;
+  ASSERT_TRUE(db.Init(file_name_));
+
+  // Rename kUrl1 without moving it.
+  TopSitesDelta delta;
+  delta.changed.push_back(
+      MostVisitedURL(kUrl1, base::ASCIIToUTF16("Chrome Browser")));
+
+  // Update db.
+  db.ApplyDelta(delta);
+
+  // Read db and verify.
+  MostVisitedURLList urls;
+  db.GetSites(&urls);
+  VerifyURLsEqual(std::vector<GURL>({kUrl0, kUrl1, kUrl2}), urls);
+  EXPECT_EQ(base::ASCIIToUTF16("Chrome Browser"), urls[1].title);
+}
+
 TEST_F(TopSitesDatabaseTest, ApplyDelta_All) {
   ASSERT_TRUE(CreateDatabaseFromSQL(file_name_, "TopSites.v4.sql"));
 
@@ -281,6 +281,11 @@ void TopSitesImpl::DiffMostVisited(const MostVisitedURLList& old_list,
         moved.rank = rank;
         delta->moved.push_back(moved);
       }
+      const MostVisitedURL& old_url = old_list[found->second];
+      if (old_url.title != new_list[i].title ||
+          old_url.redirects != new_list[i].redirects) {
+        delta->changed.push_back(new_list[i]);
+      }
       found->second = kAlreadyFoundMarker;
     }
   }
@@ -364,6 +369,9 @@ void TopSitesImpl::SetTopSites(const MostVisitedURLList& new_top_sites,
   if (!delta.deleted.empty() || !delta.added.empty() || !delta.moved.empty()) {
     backend_->UpdateTopSites(delta, record_or_not);
     should_notify_observers = true;
+  } else if (!delta.changed.empty()) {
+    // Only titles or redirects changed, which the db keeps too.
+    backend_->UpdateTopSites(delta, record_or_not);
   }
   // If there is no url change in top sites, check if the titles have changes.
   // Notify observers if there's a change in titles.
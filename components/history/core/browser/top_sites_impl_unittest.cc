@@ -373,17 +373,21 @@ TEST_F(TopSitesImplTest, DiffMostVisited) {
   GURL gets_added_2("http://getsadded2/");
   GURL gets_deleted_1("http://getsdeleted1/");
   GURL gets_moved_1("http://getsmoved1/");
+  GURL gets_renamed_1("http://getsrenamed1/");
 
   std::vector<MostVisitedURL> old_list;
   AppendMostVisitedURL(stays_the_same, &old_list);  // 0  (unchanged)
   AppendMostVisitedURL(gets_deleted_1, &old_list);  // 1  (deleted)
   AppendMostVisitedURL(gets_moved_1, &old_list);    // 2  (moved to 3)
+  AppendMostVisitedURL(gets_renamed_1, &old_list);  // 3  (moved to 4)
 
   std::vector<MostVisitedURL> new_list;
   AppendMostVisitedURL(stays_the_same, &new_list);  // 0  (unchanged)
   AppendMostVisitedURL(gets_added_1, &new_list);    // 1  (added)
   AppendMostVisitedURL(gets_added_2, &new_list);    // 2  (added)
   AppendMostVisitedURL(gets_moved_1, &new_list);    // 3  (moved from 2)
+  AppendMostVisitedURL(gets_renamed_1, &new_list);  // 4  (moved from 3)
+  new_list.back().title = base::ASCIIToUTF16("renamed");
 
   history::TopSitesDelta delta;
   TopSitesImpl::DiffMostVisited(old_list, new_list, &delta);
@@ -397,9 +401,15 @@ TEST_F(TopSitesImplTest, DiffMostVisited) {
   ASSERT_EQ(1u, delta.deleted.size());
   EXPECT_TRUE(gets_deleted_1 == delta.deleted[0].url);
 
-  ASSERT_EQ(1u, delta.moved.size());
+  ASSERT_EQ(2u, delta.moved.size());
   EXPECT_TRUE(gets_moved_1 == delta.moved[0].url.url);
   EXPECT_EQ(3, delta.moved[0].rank);
+  EXPECT_TRUE(gets_renamed_1 == delta.moved[1].url.url);
+  EXPECT_EQ(4, delta.moved[1].rank);
+
+  ASSERT_EQ(1u, delta.changed.size());
+  EXPECT_TRUE(gets_renamed_1 == delta.changed[0].url);
+  EXPECT_EQ(base::ASCIIToUTF16("renamed"), delta.changed[0].title);
 }
 
 // Tests GetMostVisitedURLs.
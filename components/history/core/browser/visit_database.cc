@@ -219,6 +219,56 @@ void VisitDatabase::DeleteVisit(const VisitRow& visit) {
   del.Run();
 }
 
+void VisitDatabase::DeleteVisits(const VisitVector& visits) {
+  // Patch around every visit first, as DeleteVisit() does. Visits deleted
+  // together can refer to each other, so each one's referrer is followed
+  // through the deleted visits up to the first one that survives.
+  std::map<VisitID, VisitID> deleted_referrers;
+  for (const VisitRow& visit : visits)
+    deleted_referrers[visit.visit_id] = visit.referring_visit;
+  for (const VisitRow& visit : visits) {
+    VisitID referrer = visit.referring_visit;
+    // Bounded by the number of deleted visits, in case of a cycle.
+    for (size_t i = 0; i < visits.size(); ++i) {
+      auto deleted = deleted_referrers.find(referrer);
+      if (deleted == deleted_referrers.end())
+        break;
+      referrer = deleted->second;
+    }
+    if (deleted_referrers.count(referrer))
+      referrer = 0;
+
+    sql::Statement update_chain(GetDB().GetCachedStatement(SQL_FROM_HERE,
+        "UPDATE visits SET from_visit=? WHERE from_visit=?"));
+    update_chain.BindInt64(0, referrer);
+    update_chain.BindInt64(1, visit.visit_id);
+    if (!update_chain.Run())
+      return;
+  }
+
+  // Each statement deletes kVisitsPerDelete ids. The last chunk repeats its
+  // last id, so that the same cached statements serve it.
+  const int kVisitsPerDelete = 16;
+  for (size_t begin = 0; begin < visits.size(); begin += kVisitsPerDelete) {
+    sql::Statement del(GetDB().GetCachedStatement(SQL_FROM_HERE,
+        "DELETE FROM visits WHERE id IN "
+        "(?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)"));
+    sql::Statement del_source(GetDB().GetCachedStatement(SQL_FROM_HERE,
+        "DELETE FROM visit_source WHERE id IN "
+        "(?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)"));
+    for (int i = 0; i < kVisitsPerDelete; ++i) {
+      const VisitID visit_id =
+          visits[std::min(begin + i, visits.size() - 1)].visit_id;
+      del.BindInt64(i, visit_id);
+      del_source.BindInt64(i, visit_id);
+    }
+    if (!del.Run())
+      return;
+    // As in DeleteVisit(), browsed visits have no visit_source row.
+    del_source.Run();
+  }
+}
+
 bool VisitDatabase::GetRowForVisit(VisitID visit_id, VisitRow* out_visit) {
   sql::Statement statement(GetDB().GetCachedStatement(SQL_FROM_HERE,
       "SELECT" HISTORY_VISIT_ROW_FIELDS "FROM visits WHERE id=?"));
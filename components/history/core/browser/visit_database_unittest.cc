@@ -140,6 +140,39 @@ TEST_F(VisitDatabaseTest, Delete) {
               IsVisitInfoEqual(matches[1], visit_info3));
 }
 
+TEST_F(VisitDatabaseTest, DeleteVisits) {
+  // Add a chain of navigations longer than what one statement deletes, plus a
+  // visit with a source, and delete all but the first and last of the chain.
+  std::vector<VisitRow> chain;
+  for (int i = 0; i < 20; ++i) {
+    VisitRow visit(1, Time::FromInternalValue(1000 + i),
+                   chain.empty() ? 0 : chain.back().visit_id,
+                   ui::PAGE_TRANSITION_LINK, 0, false);
+    ASSERT_TRUE(AddVisit(&visit, SOURCE_BROWSED));
+    chain.push_back(visit);
+  }
+  VisitRow synced(2, Time::FromInternalValue(2000), 0,
+                  ui::PAGE_TRANSITION_TYPED, 0, false);
+  ASSERT_TRUE(AddVisit(&synced, SOURCE_SYNCED));
+
+  std::vector<VisitRow> to_delete(chain.begin() + 1, chain.end() - 1);
+  to_delete.push_back(synced);
+  DeleteVisits(to_delete);
+
+  // The outer two are left, linked together.
+  std::vector<VisitRow> matches;
+  EXPECT_TRUE(GetVisitsForURL(1, &matches));
+  ASSERT_EQ(2U, matches.size());
+  EXPECT_TRUE(IsVisitInfoEqual(matches[0], chain.front()));
+  EXPECT_EQ(chain.front().visit_id, matches[1].referring_visit);
+
+  EXPECT_TRUE(GetVisitsForURL(2, &matches));
+  EXPECT_TRUE(matches.empty());
+  VisitSourceMap sources;
+  GetVisitsSource({synced}, &sources);
+  EXPECT_TRUE(sources.empty());
+}
+
 TEST_F(VisitDatabaseTest, Update) {
   // Make something in the database.
   VisitRow original(1, Time::Now(), 23, ui::PageTransitionFromInt(0), 19,
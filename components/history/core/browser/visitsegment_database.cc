@@ -16,6 +16,7 @@
 #include "base/callback.h"
 #include "base/logging.h"
 #include "base/macros.h"
+#include "base/stl_util.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "components/history/core/browser/page_usage_data.h"
@@ -38,6 +39,30 @@
 
 namespace history {
 
+namespace {
+
+// How many of the highest-scored segments QuerySegmentUsage() keeps ranked
+// between calls. Callers ask for a few dozen at most, but some of the segments
+// may be filtered out.
+const size_t kRankedSegments = 100;
+
+// Returns the score of |visit_count| visits on the day starting at |timeslot|.
+float GetDayScore(base::Time now, base::Time timeslot, int visit_count) {
+  int days_ago = (now - timeslot).InDays();
+
+  // Score for this day in isolation.
+  float day_visits_score = 1.0f + log(static_cast<float>(visit_count));
+  // Recent visits count more than historical ones, so we multiply in a boost
+  // related to how long ago this day was.
+  // This boost is a curve that smoothly goes through these values:
+  // Today gets 3x, a week ago 2x, three weeks ago 1.5x, falling off to 1x
+  // at the limit of how far we reach into the past.
+  float recency_boost = 1.0f + (2.0f * (1.0f / (1.0f + days_ago/7.0f)));
+  return recency_boost * day_visits_score;
+}
+
+}  // namespace
+
 VisitSegmentDatabase::VisitSegmentDatabase() {
 }
 
@@ -91,6 +116,7 @@ bool VisitSegmentDatabase::InitSegmentTables() {
 }
 
 bool VisitSegmentDatabase::DropSegmentTables() {
+  ResetRanking();
   // Dropping the tables will implicitly delete the indices.
   return GetDB().Execute("DROP TABLE segments") &&
          GetDB().Execute("DROP TABLE segment_usage");
@@ -185,7 +211,8 @@ bool VisitSegmentDatabase::IncreaseSegmentVisitCount(SegmentID segment_id,
     update.BindInt64(0, select.ColumnInt64(1) + static_cast<int64_t>(amount));
     update.BindInt64(1, select.ColumnInt64(0));
 
-    return update.Run();
+    if (!update.Run())
+      return false;
   } else {
     sql::Statement insert(GetDB().GetCachedStatement(SQL_FROM_HERE,
         "INSERT INTO segment_usage "
@@ -194,8 +221,12 @@ bool VisitSegmentDatabase::IncreaseSegmentVisitCount(SegmentID segment_id,
     insert.BindInt64(1, t.ToInternalValue());
     insert.BindInt64(2, static_cast<int64_t>(amount));
 
-    return insert.Run();
+    if (!insert.Run())
+      return false;
   }
+
+  UpdateRanking(segment_id);
+  return true;
 }
 
 std::vector<std::unique_ptr<PageUsageData>>
@@ -204,9 +235,23 @@ VisitSegmentDatabase::QuerySegmentUsage(
     int max_result_count,
     const base::Callback<bool(const GURL&)>& url_filter) {
   // This function gathers the highest-ranked segments in two queries.
-  // The first gathers scores for all segments.
+  // The first gathers scores for all segments, unless they are still ranked
+  // from an earlier call today.
   // The second gathers segment data (url, title, etc.) for the highest-ranked
   // segments.
+  DCHECK_GE(max_result_count, 0);
+  base::Time ts = from_time.LocalMidnight();
+  base::Time now = base::Time::Now();
+  if (!ranking_midnight_.is_null() && ranking_from_midnight_ == ts &&
+      ranking_midnight_ == now.LocalMidnight()) {
+    std::vector<std::unique_ptr<PageUsageData>> results =
+        GetSegmentPages(ranking_, max_result_count, url_filter);
+    // Too many ranked segments may have been filtered out.
+    if (ranking_is_complete_ ||
+        results.size() >= static_cast<size_t>(max_result_count)) {
+      return results;
+    }
+  }
 
   // Gather all the segment scores.
   sql::Statement statement(GetDB().GetCachedStatement(SQL_FROM_HERE,
@@ -216,73 +261,133 @@ VisitSegmentDatabase::QuerySegmentUsage(
   if (!statement.is_valid())
     return std::vector<std::unique_ptr<PageUsageData>>();
 
-  base::Time ts = from_time.LocalMidnight();
   statement.BindInt64(0, ts.ToInternalValue());
 
-  std::vector<std::unique_ptr<PageUsageData>> segments;
-  base::Time now = base::Time::Now();
-  SegmentID previous_segment_id = 0;
+  std::vector<ScoredSegment> segments;
   while (statement.Step()) {
     SegmentID segment_id = statement.ColumnInt64(0);
-    if (segment_id != previous_segment_id) {
-      segments.push_back(std::make_unique<PageUsageData>(segment_id));
-      previous_segment_id = segment_id;
-    }
+    if (segments.empty() || segments.back().id != segment_id)
+      segments.push_back({segment_id, 0.0f});
 
     base::Time timeslot =
         base::Time::FromInternalValue(statement.ColumnInt64(1));
-    int visit_count = statement.ColumnInt(2);
-    int days_ago = (now - timeslot).InDays();
-
-    // Score for this day in isolation.
-    float day_visits_score = 1.0f + log(static_cast<float>(visit_count));
-    // Recent visits count more than historical ones, so we multiply in a boost
-    // related to how long ago this day was.
-    // This boost is a curve that smoothly goes through these values:
-    // Today gets 3x, a week ago 2x, three weeks ago 1.5x, falling off to 1x
-    // at the limit of how far we reach into the past.
-    float recency_boost = 1.0f + (2.0f * (1.0f / (1.0f + days_ago/7.0f)));
-    float score = recency_boost * day_visits_score;
-    segments.back()->SetScore(segments.back()->GetScore() + score);
+    segments.back().score +=
+        GetDayScore(now, timeslot, statement.ColumnInt(2));
   }
 
   // Order by descending scores.
   std::sort(segments.begin(), segments.end(),
-            [](const std::unique_ptr<PageUsageData>& lhs,
-               const std::unique_ptr<PageUsageData>& rhs) {
-              return lhs->GetScore() > rhs->GetScore();
+            [](const ScoredSegment& lhs, const ScoredSegment& rhs) {
+              return lhs.score > rhs.score;
             });
 
-  // Now fetch the details about the entries we care about.
-  sql::Statement statement2(GetDB().GetCachedStatement(SQL_FROM_HERE,
+  std::vector<std::unique_ptr<PageUsageData>> results =
+      GetSegmentPages(segments, max_result_count, url_filter);
+
+  // Keep the highest scores for the rest of the day.
+  ranking_is_complete_ = segments.size() <= kRankedSegments;
+  if (!ranking_is_complete_)
+    segments.resize(kRankedSegments);
+  ranking_ = std::move(segments);
+  ranking_from_midnight_ = ts;
+  ranking_midnight_ = now.LocalMidnight();
+
+  return results;
+}
+
+float VisitSegmentDatabase::ScoreSegment(SegmentID segment_id,
+                                         base::Time from_midnight,
+                                         base::Time now) {
+  sql::Statement statement(GetDB().GetCachedStatement(SQL_FROM_HERE,
+      "SELECT time_slot, visit_count FROM segment_usage "
+      "WHERE segment_id = ? AND time_slot >= ?"));
+  statement.BindInt64(0, segment_id);
+  statement.BindInt64(1, from_midnight.ToInternalValue());
+
+  float score = 0.0f;
+  while (statement.Step()) {
+    base::Time timeslot =
+        base::Time::FromInternalValue(statement.ColumnInt64(0));
+    score += GetDayScore(now, timeslot, statement.ColumnInt(1));
+  }
+  return score;
+}
+
+std::vector<std::unique_ptr<PageUsageData>>
+VisitSegmentDatabase::GetSegmentPages(
+    const std::vector<ScoredSegment>& segments,
+    int max_result_count,
+    const base::Callback<bool(const GURL&)>& url_filter) {
+  sql::Statement statement(GetDB().GetCachedStatement(SQL_FROM_HERE,
       "SELECT urls.url, urls.title FROM urls "
       "JOIN segments ON segments.url_id = urls.id "
       "WHERE segments.id = ?"));
 
-  if (!statement2.is_valid())
+  if (!statement.is_valid())
     return std::vector<std::unique_ptr<PageUsageData>>();
 
   std::vector<std::unique_ptr<PageUsageData>> results;
-  DCHECK_GE(max_result_count, 0);
-  for (std::unique_ptr<PageUsageData>& pud : segments) {
-    statement2.BindInt64(0, pud->GetID());
-    if (statement2.Step()) {
-      GURL url(statement2.ColumnString(0));
+  for (const ScoredSegment& segment : segments) {
+    if (results.size() >= static_cast<size_t>(max_result_count))
+      break;
+    statement.BindInt64(0, segment.id);
+    if (statement.Step()) {
+      GURL url(statement.ColumnString(0));
       if (url_filter.is_null() || url_filter.Run(url)) {
+        auto pud = std::make_unique<PageUsageData>(segment.id);
         pud->SetURL(url);
-        pud->SetTitle(statement2.ColumnString16(1));
+        pud->SetTitle(statement.ColumnString16(1));
+        pud->SetScore(segment.score);
         results.push_back(std::move(pud));
-        if (results.size() >= static_cast<size_t>(max_result_count))
-          break;
       }
     }
-    statement2.Reset(true);
+    statement.Reset(true);
   }
 
   return results;
 }
 
+void VisitSegmentDatabase::UpdateRanking(SegmentID segment_id) {
+  if (ranking_midnight_.is_null())
+    return;
+  base::Time now = base::Time::Now();
+  if (ranking_midnight_ != now.LocalMidnight()) {
+    // Every score changed at midnight.
+    ResetRanking();
+    return;
+  }
+
+  // Only the score of |segment_id| changed, so it is the only segment that
+  // may join the ranking or move in it.
+  base::EraseIf(ranking_, [segment_id](const ScoredSegment& segment) {
+    return segment.id == segment_id;
+  });
+  ScoredSegment segment = {segment_id,
+                           ScoreSegment(segment_id, ranking_from_midnight_,
+                                        now)};
+  auto position = std::upper_bound(
+      ranking_.begin(), ranking_.end(), segment,
+      [](const ScoredSegment& lhs, const ScoredSegment& rhs) {
+        return lhs.score > rhs.score;
+      });
+  // Past the end of an incomplete ranking, unranked segments may score more.
+  if (position == ranking_.end() && !ranking_is_complete_)
+    return;
+  ranking_.insert(position, segment);
+  if (ranking_.size() > kRankedSegments) {
+    ranking_.pop_back();
+    ranking_is_complete_ = false;
+  }
+}
+
+void VisitSegmentDatabase::ResetRanking() {
+  ranking_.clear();
+  ranking_midnight_ = base::Time();
+  ranking_is_complete_ = false;
+}
+
 bool VisitSegmentDatabase::DeleteSegmentForURL(URLID url_id) {
+  ResetRanking();
   sql::Statement delete_usage(GetDB().GetCachedStatement(SQL_FROM_HERE,
       "DELETE FROM segment_usage WHERE segment_id IN "
       "(SELECT id FROM segments WHERE url_id = ?)"));
@@ -350,6 +455,7 @@ bool VisitSegmentDatabase::RenameSegment(SegmentID segment_id,
 
 bool VisitSegmentDatabase::MergeSegments(SegmentID from_segment_id,
                                          SegmentID to_segment_id) {
+  ResetRanking();
   sql::Transaction transaction(&GetDB());
   if (!transaction.Begin())
     return false;
@@ -7,9 +7,11 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/callback_forward.h"
 #include "base/macros.h"
+#include "base/time/time.h"
 #include "components/history/core/browser/history_types.h"
 
 namespace sql {
@@ -53,6 +55,10 @@ class VisitSegmentDatabase {
   // Computes the segment usage since |from_time|. If |url_filter| is non-null,
   // then only URLs for which it returns true will be included.
   // Returns the highest-scored segments up to |max_result_count|.
+  //
+  // Every segment is scored on the first call of the day, after which the
+  // highest scores are kept up to date as visits are added, so that later
+  // calls that day only look up the segments they return.
   std::vector<std::unique_ptr<PageUsageData>> QuerySegmentUsage(
       base::Time from_time,
       int max_result_count,
@@ -85,6 +91,32 @@ class VisitSegmentDatabase {
   bool MigrateVisitSegmentNames();
 
  private:
+  // A segment with its score, as ranked by QuerySegmentUsage().
+  struct ScoredSegment {
+    SegmentID id;
+    float score;
+  };
+
+  // Returns the score of |segment_id| as of |now|, from its usage since
+  // |from_midnight|.
+  float ScoreSegment(SegmentID segment_id,
+                     base::Time from_midnight,
+                     base::Time now);
+
+  // Returns the pages of the highest-ranked of |segments| that pass
+  // |url_filter|, up to |max_result_count|.
+  std::vector<std::unique_ptr<PageUsageData>> GetSegmentPages(
+      const std::vector<ScoredSegment>& segments,
+      int max_result_count,
+      const base::Callback<bool(const GURL&)>& url_filter);
+
+  // Rescores |segment_id| in |ranking_| after its usage increased.
+  void UpdateRanking(SegmentID segment_id);
+
+  // Drops |ranking_|, so that the next QuerySegmentUsage() scores every
+  // segment.
+  void ResetRanking();
+
   // Updates the |name| column for a single segment. Returns true on success.
   bool RenameSegment(SegmentID segment_id, const std::string& new_name);
   // Merges two segments such that data is aggregated, all former references to
@@ -92,6 +124,18 @@ class VisitSegmentDatabase {
   // deleted. Returns true on success.
   bool MergeSegments(SegmentID from_segment_id, SegmentID to_segment_id);
 
+  // The highest-scored segments, by descending score, as scored for the usage
+  // since |ranking_from_midnight_| on the day starting at |ranking_midnight_|.
+  // Scores only change from one day to the next, besides visits, so the
+  // ranking holds for that day. |ranking_midnight_| is null when there is no
+  // ranking.
+  std::vector<ScoredSegment> ranking_;
+  base::Time ranking_from_midnight_;
+  base::Time ranking_midnight_;
+  // Whether |ranking_| has every segment used since |ranking_from_midnight_|,
+  // rather than the highest-scored ones only.
+  bool ranking_is_complete_ = false;
+
   DISALLOW_COPY_AND_ASSIGN(VisitSegmentDatabase);
 };
 
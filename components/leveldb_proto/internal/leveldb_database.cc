@@ -6,6 +6,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/bind.h"
@@ -205,8 +206,9 @@ bool LevelDB::LoadWithFilter(const KeyFilter& filter,
   if (!result)
     return false;
 
-  for (const auto& pair : keys_entries)
-    entries->push_back(pair.second);
+  entries->reserve(entries->size() + keys_entries.size());
+  for (auto& pair : keys_entries)
+    entries->push_back(std::move(pair.second));
   return true;
 }
 
@@ -244,19 +246,46 @@ bool LevelDB::LoadKeysAndEntriesWhile(
 
   std::unique_ptr<leveldb::Iterator> db_iterator(db_->NewIterator(options));
   leveldb::Slice start(start_key);
-  for (db_iterator->Seek(start);
-       db_iterator->Valid() &&
-       while_callback.Run(db_iterator->key().ToString());
-       db_iterator->Next()) {
-    leveldb::Slice key_slice = db_iterator->key();
-    std::string key_slice_str(key_slice.data(), key_slice.size());
-    if (!filter.is_null() && !filter.Run(key_slice_str)) {
+  for (db_iterator->Seek(start); db_iterator->Valid(); db_iterator->Next()) {
+    std::string key = db_iterator->key().ToString();
+    if (!while_callback.Run(key))
+      break;
+    if (!filter.is_null() && !filter.Run(key))
       continue;
-    }
 
-    leveldb::Slice value_slice = db_iterator->value();
-    keys_entries->insert(std::make_pair(
-        key_slice_str, std::string(value_slice.data(), value_slice.size())));
+    // Keys come in order, so each one goes at the end of the map.
+    keys_entries->emplace_hint(keys_entries->end(), std::move(key),
+                               db_iterator->value().ToString());
+  }
+  return true;
+}
+
+bool LevelDB::LoadKeysAndEntriesInRange(
+    const std::string& start_key,
+    const std::string& end_key,
+    size_t max_entries,
+    const leveldb::ReadOptions& options,
+    std::map<std::string, std::string>* keys_entries,
+    bool* more) {
+  DCHECK(more);
+  DFAKE_SCOPED_LOCK(thread_checker_);
+  *more = false;
+  if (!db_)
+    return false;
+
+  std::unique_ptr<leveldb::Iterator> db_iterator(db_->NewIterator(options));
+  const leveldb::Slice end(end_key);
+  // Compare the slices in place, only copying the entries that are kept.
+  for (db_iterator->Seek(leveldb::Slice(start_key));
+       db_iterator->Valid() && db_iterator->key().compare(end) <= 0;
+       db_iterator->Next()) {
+    if (keys_entries->size() == max_entries) {
+      *more = true;
+      break;
+    }
+    keys_entries->emplace_hint(keys_entries->end(),
+                               db_iterator->key().ToString(),
+                               db_iterator->value().ToString());
   }
   return true;
 }
@@ -275,6 +304,7 @@ bool LevelDB::LoadKeys(const std::string& target_prefix,
   if (!result)
     return false;
 
+  keys->reserve(keys->size() + keys_entries.size());
   for (const auto& pair : keys_entries)
     keys->push_back(pair.first);
   return true;
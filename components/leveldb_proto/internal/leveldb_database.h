@@ -87,6 +87,16 @@ class COMPONENT_EXPORT(LEVELDB_PROTO) LevelDB {
       const std::string& start_key,
       const KeyFilter& while_callback);
 
+  // Retrieves up to |max_entries| keys and values in [|start_key|, |end_key|],
+  // and sets |more| to whether the range holds keys past them.
+  virtual bool LoadKeysAndEntriesInRange(
+      const std::string& start_key,
+      const std::string& end_key,
+      size_t max_entries,
+      const leveldb::ReadOptions& options,
+      std::map<std::string, std::string>* keys_entries,
+      bool* more);
+
   virtual bool LoadKeys(std::vector<std::string>* keys);
   virtual bool LoadKeys(const std::string& target_prefix,
                         std::vector<std::string>* keys);
@@ -281,6 +281,7 @@ void ParseLoadedEntries(
   if (!success || !loaded_entries) {
     entries.reset();
   } else {
+    entries->reserve(loaded_entries->size());
     for (const auto& serialized_entry : *loaded_entries) {
       entries->emplace_back(T());
       ParseToClientType<P, T>(serialized_entry, &entries->back());
@@ -305,9 +306,11 @@ void ParseLoadedKeysAndEntries(
   if (!success || !loaded_entries) {
     keys_entries.reset();
   } else {
+    // Both maps are sorted the same way, so each key goes at the end.
     for (const auto& pair : *loaded_entries) {
-      auto it = keys_entries->emplace(pair.first, T());
-      ParseToClientType<P, T>(pair.second, &(it.first->second));
+      auto it =
+          keys_entries->emplace_hint(keys_entries->end(), pair.first, T());
+      ParseToClientType<P, T>(pair.second, &it->second);
     }
   }
 
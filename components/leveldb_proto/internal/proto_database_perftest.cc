@@ -12,6 +12,7 @@
 #include "base/timer/elapsed_timer.h"
 
 #include "base/bind.h"
+#include "base/barrier_closure.h"
 #include "base/bind_helpers.h"
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
@@ -25,6 +26,7 @@
 #include "build/build_config.h"
 #include "components/leveldb_proto/internal/leveldb_database.h"
 #include "components/leveldb_proto/internal/proto_database_impl.h"
+#include "components/leveldb_proto/internal/proto_leveldb_wrapper.h"
 #include "components/leveldb_proto/internal/unique_proto_database.h"
 #include "components/leveldb_proto/testing/proto/test_db.pb.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -471,6 +473,139 @@ class ProtoDBPerfTest : public testing::Test {
     return stats;
   }
 
+  // Issues |num_entries| single entry updates without waiting for any of them,
+  // which the wrapper writes in batches.
+  void RunBurstInsertTestAndCleanup(const std::string& test_modifier,
+                                    int num_entries,
+                                    int data_size) {
+    ScopedTempDir temp_dir;
+    ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+    InitDB(kSingleDBName, temp_dir);
+    TestDatabase* db;
+    GetDatabase(kSingleDBName, &db);
+
+    auto entries = GenerateTestEntries("burst", num_entries, data_size);
+    base::RunLoop run_update_entries;
+    base::RepeatingClosure barrier =
+        base::BarrierClosure(num_entries, run_update_entries.QuitClosure());
+    base::ElapsedTimer timer;
+    for (auto& entry : *entries) {
+      auto single_entry = std::make_unique<KeyEntryVector>();
+      single_entry->push_back(std::move(entry));
+      db->proto_db()->UpdateEntries(
+          std::move(single_entry), std::make_unique<std::vector<std::string>>(),
+          base::BindOnce(
+              [](base::RepeatingClosure signal, bool success) {
+                EXPECT_TRUE(success);
+                signal.Run();
+              },
+              barrier));
+    }
+    run_update_entries.Run();
+
+    auto test_modifier_str = base::StringPrintf(
+        "%s_%d_%d", test_modifier.c_str(), num_entries, data_size);
+    perf_test::PrintResult("ProtoDBPerfTest", test_modifier_str, "time",
+                           timer.Elapsed().InMillisecondsF(), "ms", true);
+    ShutdownDBs();
+  }
+
+  // Compares loading a key range at once with loading it in batches, where the
+  // next batch is read while the previous one is handled.
+  void RunLoadRangeInBatchesTest(const std::string& test_modifier,
+                                 int num_entries,
+                                 int data_size,
+                                 size_t batch_size) {
+    ScopedTempDir temp_dir;
+    ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+    LevelDB db("RangeTest");
+    ASSERT_TRUE(db.Init(temp_dir.GetPath(), CreateSimpleOptions()));
+    ProtoLevelDBWrapper wrapper(task_runner_, &db);
+
+    auto entries = GenerateTestEntries("range", num_entries, data_size);
+    auto serialized_entries = std::make_unique<KeyValueVector>();
+    for (const auto& entry : *entries) {
+      serialized_entries->emplace_back(entry.first,
+                                       entry.second.SerializeAsString());
+    }
+    base::RunLoop run_update_entries;
+    wrapper.UpdateEntries(std::move(serialized_entries),
+                          std::make_unique<KeyVector>(),
+                          base::BindOnce(
+                              [](base::OnceClosure signal, bool success) {
+                                EXPECT_TRUE(success);
+                                std::move(signal).Run();
+                              },
+                              run_update_entries.QuitClosure()));
+    run_update_entries.Run();
+    PruneBlockCache();
+
+    // Every entry is parsed, as a client would.
+    size_t num_loaded = 0;
+    base::RunLoop run_load_all;
+    base::ElapsedTimer load_all_timer;
+    wrapper.LoadKeysAndEntriesInRange(
+        "range", "range~",
+        base::BindOnce(
+            [](base::OnceClosure signal, size_t* num_loaded, bool success,
+               std::unique_ptr<KeyValueMap> keys_entries) {
+              EXPECT_TRUE(success);
+              for (const auto& pair : *keys_entries) {
+                TestProto proto;
+                EXPECT_TRUE(proto.ParseFromString(pair.second));
+              }
+              *num_loaded = keys_entries->size();
+              std::move(signal).Run();
+            },
+            run_load_all.QuitClosure(), &num_loaded));
+    run_load_all.Run();
+    const double load_all_ms = load_all_timer.Elapsed().InMillisecondsF();
+    EXPECT_EQ(static_cast<size_t>(num_entries), num_loaded);
+    PruneBlockCache();
+
+    size_t num_batch_loaded = 0;
+    base::TimeDelta first_batch_time;
+    base::RunLoop run_load_batches;
+    base::ElapsedTimer load_batches_timer;
+    wrapper.LoadKeysAndEntriesInRangeInBatches(
+        "range", "range~", batch_size, leveldb::ReadOptions(),
+        base::BindRepeating(
+            [](base::RepeatingClosure signal, size_t* num_loaded,
+               base::TimeDelta* first_batch_time,
+               const base::ElapsedTimer* timer, bool success,
+               std::unique_ptr<KeyValueMap> keys_entries, bool complete) {
+              EXPECT_TRUE(success);
+              if (*num_loaded == 0)
+                *first_batch_time = timer->Elapsed();
+              for (const auto& pair : *keys_entries) {
+                TestProto proto;
+                EXPECT_TRUE(proto.ParseFromString(pair.second));
+              }
+              *num_loaded += keys_entries->size();
+              if (complete)
+                signal.Run();
+            },
+            run_load_batches.QuitClosure(), &num_batch_loaded,
+            &first_batch_time, &load_batches_timer));
+    run_load_batches.Run();
+    const double load_batches_ms =
+        load_batches_timer.Elapsed().InMillisecondsF();
+    EXPECT_EQ(static_cast<size_t>(num_entries), num_batch_loaded);
+
+    auto test_modifier_str =
+        base::StringPrintf("%s_%d_%d_%zu", test_modifier.c_str(), num_entries,
+                           data_size, batch_size);
+    perf_test::PrintResult("ProtoDBPerfTest", test_modifier_str,
+                           "Load at once time", load_all_ms, "ms", true);
+    perf_test::PrintResult("ProtoDBPerfTest", test_modifier_str,
+                           "Load in batches time", load_batches_ms, "ms",
+                           true);
+    perf_test::PrintResult("ProtoDBPerfTest", test_modifier_str,
+                           "First batch time",
+                           first_batch_time.InMillisecondsF(), "ms", true);
+    PruneBlockCache();
+  }
+
   PerfStats CombinePerfStats(const PerfStats& a, const PerfStats& b) {
     PerfStats out;
     out.time_ms = a.time_ms + b.time_ms;
@@ -1099,4 +1234,24 @@ TEST_F(ProtoDBPerfTest, LoadEntriesMulti_DifferingNumDBs_SkipReadCache_Large) {
   ASSERT_NE(num_entries, 0U);
 }
 
+TEST_F(ProtoDBPerfTest, InsertSingleDBBurst_Individual_100b) {
+  RunBurstInsertTestAndCleanup("InsertSingleDBBurst_Individual",
+                               kSmallNumEntries, kMediumDataSize);
+}
+
+TEST_F(ProtoDBPerfTest, InsertSingleDBBurst_Individual_1000b) {
+  RunBurstInsertTestAndCleanup("InsertSingleDBBurst_Individual",
+                               kSmallNumEntries, kLargeDataSize);
+}
+
+TEST_F(ProtoDBPerfTest, LoadRangeInBatches_Small) {
+  RunLoadRangeInBatchesTest("LoadRangeInBatches", kLargeNumEntries,
+                            kMediumDataSize, 100);
+}
+
+TEST_F(ProtoDBPerfTest, LoadRangeInBatches_Large) {
+  RunLoadRangeInBatchesTest("LoadRangeInBatches", kLargeNumEntries,
+                            kLargeDataSize, 100);
+}
+
 }  // namespace leveldb_proto
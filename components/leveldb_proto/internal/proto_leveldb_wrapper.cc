@@ -4,9 +4,13 @@
 
 #include "components/leveldb_proto/internal/proto_leveldb_wrapper.h"
 
+#include <iterator>
+#include <limits>
 #include <string>
 
+#include "base/containers/flat_set.h"
 #include "base/sequenced_task_runner.h"
+#include "base/stl_util.h"
 #include "base/task/post_task.h"
 #include "base/task/task_traits.h"
 #include "base/threading/sequenced_task_runner_handle.h"
@@ -104,6 +108,40 @@ void RunGetCallback(Callbacks::GetCallback callback,
   std::move(callback).Run(*success, *found ? std::move(entry) : nullptr);
 }
 
+// Adds an UpdateEntries() call to the pending |entries| and |keys|, so that
+// saving them all at once leaves the same entries as saving them one call
+// after the other. LevelDB::Save() puts before it deletes, so earlier deletes
+// of the keys put by the call are dropped. Earlier puts of the keys it
+// deletes are dropped too, which just makes the write smaller.
+void MergeUpdate(KeyValueVector* entries,
+                 KeyVector* keys,
+                 std::unique_ptr<KeyValueVector> entries_to_save,
+                 std::unique_ptr<KeyVector> keys_to_remove) {
+  if (!keys->empty() && !entries_to_save->empty()) {
+    KeyVector saved_key_list;
+    saved_key_list.reserve(entries_to_save->size());
+    for (const auto& entry : *entries_to_save)
+      saved_key_list.push_back(entry.first);
+    base::flat_set<std::string> saved_keys(std::move(saved_key_list));
+    base::EraseIf(*keys, [&saved_keys](const std::string& key) {
+      return base::Contains(saved_keys, key);
+    });
+  }
+  if (!entries->empty() && !keys_to_remove->empty()) {
+    base::flat_set<std::string> removed_keys(keys_to_remove->begin(),
+                                             keys_to_remove->end());
+    base::EraseIf(*entries, [&removed_keys](
+                                const KeyValueVector::value_type& entry) {
+      return base::Contains(removed_keys, entry.first);
+    });
+  }
+  entries->insert(entries->end(),
+                  std::make_move_iterator(entries_to_save->begin()),
+                  std::make_move_iterator(entries_to_save->end()));
+  keys->insert(keys->end(), std::make_move_iterator(keys_to_remove->begin()),
+               std::make_move_iterator(keys_to_remove->end()));
+}
+
 bool UpdateEntriesFromTaskRunner(
     LevelDB* database,
     std::unique_ptr<KeyValueVector> entries_to_save,
@@ -115,6 +153,12 @@ bool UpdateEntriesFromTaskRunner(
   return success;
 }
 
+void RunUpdateCallbacks(std::vector<Callbacks::UpdateCallback> callbacks,
+                        bool success) {
+  for (auto& callback : callbacks)
+    std::move(callback).Run(success);
+}
+
 bool UpdateEntriesWithRemoveFilterFromTaskRunner(
     LevelDB* database,
     std::unique_ptr<KeyValueVector> entries_to_save,
@@ -146,6 +190,27 @@ void LoadKeysAndEntriesFromTaskRunner(LevelDB* database,
   ProtoLevelDBWrapperMetrics::RecordLoadKeysAndEntries(client_id, success);
 }
 
+void LoadKeysAndEntriesInRangeFromTaskRunner(
+    LevelDB* database,
+    const std::string& start,
+    const std::string& end,
+    size_t max_entries,
+    const leveldb::ReadOptions& options,
+    const std::string& client_id,
+    bool* success,
+    bool* more,
+    KeyValueMap* keys_entries) {
+  DCHECK(success);
+  DCHECK(more);
+  DCHECK(keys_entries);
+  keys_entries->clear();
+
+  *success = database->LoadKeysAndEntriesInRange(start, end, max_entries,
+                                                 options, keys_entries, more);
+
+  ProtoLevelDBWrapperMetrics::RecordLoadKeysAndEntries(client_id, success);
+}
+
 void LoadEntriesFromTaskRunner(LevelDB* database,
                                const KeyFilter& filter,
                                const leveldb::ReadOptions& options,
@@ -184,7 +249,16 @@ ProtoLevelDBWrapper::ProtoLevelDBWrapper(
   DETACH_FROM_SEQUENCE(sequence_checker_);
 }
 
-ProtoLevelDBWrapper::~ProtoLevelDBWrapper() = default;
+ProtoLevelDBWrapper::~ProtoLevelDBWrapper() {
+  // The pending callbacks are still owed a result. This is only safe when |db_|
+  // outlives the wrapper; owners that delete it first call Flush() before.
+  if (pending_update_)
+    FlushPendingUpdate();
+}
+
+ProtoLevelDBWrapper::PendingUpdate::PendingUpdate() = default;
+
+ProtoLevelDBWrapper::PendingUpdate::~PendingUpdate() = default;
 
 void ProtoLevelDBWrapper::RunInitCallback(Callbacks::InitCallback callback,
                                           const leveldb::Status* status) {
@@ -213,12 +287,40 @@ void ProtoLevelDBWrapper::UpdateEntries(
     std::unique_ptr<KeyVector> keys_to_remove,
     typename Callbacks::UpdateCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (pending_update_) {
+    MergeUpdate(pending_update_->entries_to_save.get(),
+                pending_update_->keys_to_remove.get(),
+                std::move(entries_to_save), std::move(keys_to_remove));
+    pending_update_->callbacks.push_back(std::move(callback));
+    return;
+  }
+
+  pending_update_ = std::make_unique<PendingUpdate>();
+  pending_update_->entries_to_save = std::move(entries_to_save);
+  pending_update_->keys_to_remove = std::move(keys_to_remove);
+  pending_update_->callbacks.push_back(std::move(callback));
+  base::SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(&ProtoLevelDBWrapper::FlushPendingUpdate,
+                                weak_ptr_factory_.GetWeakPtr()));
+}
+
+void ProtoLevelDBWrapper::Flush() {
+  if (pending_update_)
+    FlushPendingUpdate();
+}
+
+void ProtoLevelDBWrapper::FlushPendingUpdate() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!pending_update_)
+    return;
+
+  std::unique_ptr<PendingUpdate> update = std::move(pending_update_);
   base::PostTaskAndReplyWithResult(
       task_runner_.get(), FROM_HERE,
       base::BindOnce(UpdateEntriesFromTaskRunner, base::Unretained(db_),
-                     std::move(entries_to_save), std::move(keys_to_remove),
-                     metrics_id_),
-      std::move(callback));
+                     std::move(update->entries_to_save),
+                     std::move(update->keys_to_remove), metrics_id_),
+      base::BindOnce(RunUpdateCallbacks, std::move(update->callbacks)));
 }
 
 void ProtoLevelDBWrapper::UpdateEntriesWithRemoveFilter(
@@ -236,6 +338,7 @@ void ProtoLevelDBWrapper::UpdateEntriesWithRemoveFilter(
     const std::string& target_prefix,
     Callbacks::UpdateCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  FlushPendingUpdate();
   base::PostTaskAndReplyWithResult(
       task_runner_.get(), FROM_HERE,
       base::BindOnce(UpdateEntriesWithRemoveFilterFromTaskRunner,
@@ -261,6 +364,7 @@ void ProtoLevelDBWrapper::LoadEntriesWithFilter(
     const std::string& target_prefix,
     Callbacks::LoadCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  FlushPendingUpdate();
   bool* success = new bool(false);
   auto entries = std::make_unique<ValueVector>();
   // Get this pointer before |entries| is std::move()'d so we can use it below.
@@ -305,13 +409,83 @@ void ProtoLevelDBWrapper::LoadKeysAndEntriesInRange(
     const std::string& start,
     const std::string& end,
     Callbacks::LoadKeysAndEntriesCallback callback) {
-  LoadKeysAndEntriesWhile(
-      base::BindRepeating(
-          [](const std::string& range_end, const std::string& key) {
-            return key.compare(range_end) <= 0;
-          },
-          end),
-      KeyFilter(), leveldb::ReadOptions(), start, std::move(callback));
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  FlushPendingUpdate();
+  bool* success = new bool(false);
+  bool* more = new bool(false);
+  auto keys_entries = std::make_unique<KeyValueMap>();
+  // Get this pointer before |keys_entries| is std::move()'d so we can use it
+  // below.
+  auto* keys_entries_ptr = keys_entries.get();
+  task_runner_->PostTaskAndReply(
+      FROM_HERE,
+      base::BindOnce(LoadKeysAndEntriesInRangeFromTaskRunner,
+                     base::Unretained(db_), start, end,
+                     std::numeric_limits<size_t>::max(), leveldb::ReadOptions(),
+                     metrics_id_, success, base::Owned(more), keys_entries_ptr),
+      base::BindOnce(RunLoadKeysAndEntriesCallback, std::move(callback),
+                     base::Owned(success), std::move(keys_entries)));
+}
+
+void ProtoLevelDBWrapper::LoadKeysAndEntriesInRangeInBatches(
+    const std::string& start,
+    const std::string& end,
+    size_t batch_size,
+    const leveldb::ReadOptions& options,
+    LoadKeysAndEntriesBatchCallback callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK_GT(batch_size, 0u);
+  LoadRangeBatch(start, end, batch_size, options, std::move(callback));
+}
+
+void ProtoLevelDBWrapper::LoadRangeBatch(
+    const std::string& start,
+    const std::string& end,
+    size_t batch_size,
+    const leveldb::ReadOptions& options,
+    LoadKeysAndEntriesBatchCallback callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  FlushPendingUpdate();
+  bool* success = new bool(false);
+  bool* more = new bool(false);
+  auto keys_entries = std::make_unique<KeyValueMap>();
+  auto* keys_entries_ptr = keys_entries.get();
+  task_runner_->PostTaskAndReply(
+      FROM_HERE,
+      base::BindOnce(LoadKeysAndEntriesInRangeFromTaskRunner,
+                     base::Unretained(db_), start, end, batch_size, options,
+                     metrics_id_, success, more, keys_entries_ptr),
+      base::BindOnce(&ProtoLevelDBWrapper::OnRangeBatchLoaded,
+                     weak_ptr_factory_.GetWeakPtr(), end, batch_size, options,
+                     std::move(callback), base::Owned(success),
+                     base::Owned(more), std::move(keys_entries)));
+}
+
+// static
+void ProtoLevelDBWrapper::OnRangeBatchLoaded(
+    base::WeakPtr<ProtoLevelDBWrapper> wrapper,
+    const std::string& end,
+    size_t batch_size,
+    const leveldb::ReadOptions& options,
+    LoadKeysAndEntriesBatchCallback callback,
+    const bool* success,
+    const bool* more,
+    std::unique_ptr<KeyValueMap> keys_entries) {
+  if (!*success || !*more) {
+    callback.Run(*success, std::move(keys_entries), true /* complete */);
+    return;
+  }
+  // The range can't go on once the wrapper is gone.
+  if (!wrapper) {
+    callback.Run(false, std::move(keys_entries), true /* complete */);
+    return;
+  }
+
+  // The smallest key after the last one loaded.
+  std::string next_start = keys_entries->rbegin()->first;
+  next_start.push_back('\0');
+  wrapper->LoadRangeBatch(next_start, end, batch_size, options, callback);
+  callback.Run(true, std::move(keys_entries), false /* complete */);
 }
 
 void ProtoLevelDBWrapper::LoadKeysAndEntriesWhile(
@@ -321,6 +495,7 @@ void ProtoLevelDBWrapper::LoadKeysAndEntriesWhile(
     const std::string& target_prefix,
     Callbacks::LoadKeysAndEntriesCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  FlushPendingUpdate();
   bool* success = new bool(false);
   auto keys_entries = std::make_unique<KeyValueMap>();
   // Get this pointer before |keys_entries| is std::move()'d so we can use it
@@ -338,6 +513,7 @@ void ProtoLevelDBWrapper::LoadKeysAndEntriesWhile(
 void ProtoLevelDBWrapper::GetEntry(const std::string& key,
                                    Callbacks::GetCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  FlushPendingUpdate();
   bool* success = new bool(false);
   bool* found = new bool(false);
   auto entry = std::make_unique<std::string>();
@@ -361,6 +537,7 @@ void ProtoLevelDBWrapper::LoadKeys(
     const std::string& target_prefix,
     typename Callbacks::LoadKeysCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  FlushPendingUpdate();
   task_runner_->PostTask(
       FROM_HERE, base::BindOnce(LoadKeysFromTaskRunner, base::Unretained(db_),
                                 target_prefix, metrics_id_, std::move(callback),
@@ -371,6 +548,7 @@ void ProtoLevelDBWrapper::RemoveKeys(const KeyFilter& filter,
                                      const std::string& target_prefix,
                                      Callbacks::UpdateCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  FlushPendingUpdate();
   task_runner_->PostTask(
       FROM_HERE,
       base::BindOnce(RemoveKeysFromTaskRunner, base::Unretained(db_),
@@ -380,6 +558,7 @@ void ProtoLevelDBWrapper::RemoveKeys(const KeyFilter& filter,
 
 void ProtoLevelDBWrapper::Destroy(Callbacks::DestroyCallback callback) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  FlushPendingUpdate();
   DCHECK(db_);
 
   base::PostTaskAndReplyWithResult(
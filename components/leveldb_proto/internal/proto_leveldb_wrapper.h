@@ -14,6 +14,7 @@
 #include "base/callback.h"
 #include "base/component_export.h"
 #include "base/memory/ptr_util.h"
+#include "base/memory/weak_ptr.h"
 #include "base/sequenced_task_runner.h"
 #include "base/strings/string_util.h"
 #include "base/task_runner_util.h"
@@ -39,8 +40,23 @@ using ValueVector = std::vector<std::string>;
 // When the ProtoDatabase instance is deleted, in-progress asynchronous
 // operations will be completed and the corresponding callbacks will be called.
 // Construction/calls/destruction should all happen on the same thread.
+//
+// UpdateEntries() calls are not written one by one: the calls made before the
+// calling sequence gets back to its task queue are written as a single batch,
+// and each of their callbacks gets the result of that batch. Any other call
+// writes the pending batch first, so operations still happen in order. An
+// owner that deletes the LevelDB before the wrapper must call Flush() first,
+// so that the pending batch is written before the database goes away.
 class COMPONENT_EXPORT(LEVELDB_PROTO) ProtoLevelDBWrapper {
  public:
+  // Called with each batch of keys and entries of a streamed load, in key
+  // order. |complete| is true for the last call, which is also the first one
+  // to report a failure.
+  using LoadKeysAndEntriesBatchCallback =
+      base::RepeatingCallback<void(bool success,
+                                   std::unique_ptr<KeyValueMap> keys_entries,
+                                   bool complete)>;
+
   // Used to destroy database when initialization fails.
   static void Destroy(
       const base::FilePath& db_dir,
@@ -106,6 +122,16 @@ class COMPONENT_EXPORT(LEVELDB_PROTO) ProtoLevelDBWrapper {
       const std::string& end,
       Callbacks::LoadKeysAndEntriesCallback callback);
 
+  // Loads the keys and entries in [|start|, |end|] up to |batch_size| at a
+  // time. The next batch is read while |callback| handles the previous one.
+  // Entries written while the range is being read may or may not be seen.
+  void LoadKeysAndEntriesInRangeInBatches(
+      const std::string& start,
+      const std::string& end,
+      size_t batch_size,
+      const leveldb::ReadOptions& options,
+      LoadKeysAndEntriesBatchCallback callback);
+
   void LoadKeys(Callbacks::LoadKeysCallback callback);
   void LoadKeys(const std::string& target_prefix,
                 Callbacks::LoadKeysCallback callback);
@@ -118,6 +144,11 @@ class COMPONENT_EXPORT(LEVELDB_PROTO) ProtoLevelDBWrapper {
 
   void Destroy(Callbacks::DestroyCallback callback);
 
+  // Posts the write of the pending UpdateEntries() calls, if any, to the
+  // database sequence now instead of when the calling sequence gets back to
+  // its task queue.
+  void Flush();
+
   void RunInitCallback(Callbacks::InitCallback callback,
                        const leveldb::Status* status);
 
@@ -135,6 +166,38 @@ class COMPONENT_EXPORT(LEVELDB_PROTO) ProtoLevelDBWrapper {
   const scoped_refptr<base::SequencedTaskRunner>& task_runner();
 
  private:
+  // The UpdateEntries() calls waiting to be written.
+  struct PendingUpdate {
+    PendingUpdate();
+    ~PendingUpdate();
+
+    std::unique_ptr<KeyValueVector> entries_to_save;
+    std::unique_ptr<KeyVector> keys_to_remove;
+    std::vector<Callbacks::UpdateCallback> callbacks;
+  };
+
+  // Posts the write of |pending_update_|, if any, to |task_runner_|.
+  void FlushPendingUpdate();
+
+  // Reads the batch of the range starting at |start|.
+  void LoadRangeBatch(const std::string& start,
+                      const std::string& end,
+                      size_t batch_size,
+                      const leveldb::ReadOptions& options,
+                      LoadKeysAndEntriesBatchCallback callback);
+
+  // Asks for the batch after |keys_entries|, if there is one, before handing
+  // |keys_entries| to |callback|.
+  static void OnRangeBatchLoaded(
+      base::WeakPtr<ProtoLevelDBWrapper> wrapper,
+      const std::string& end,
+      size_t batch_size,
+      const leveldb::ReadOptions& options,
+      LoadKeysAndEntriesBatchCallback callback,
+      const bool* success,
+      const bool* more,
+      std::unique_ptr<KeyValueMap> keys_entries);
+
   SEQUENCE_CHECKER(sequence_checker_);
 
   // Used to run blocking tasks in-order, must be the TaskRunner that |db_|
@@ -146,6 +209,8 @@ class COMPONENT_EXPORT(LEVELDB_PROTO) ProtoLevelDBWrapper {
   // LevelDB calls, likely the database client name.
   std::string metrics_id_ = "Default";
 
+  std::unique_ptr<PendingUpdate> pending_update_;
+
   base::WeakPtrFactory<ProtoLevelDBWrapper> weak_ptr_factory_{this};
 
   DISALLOW_COPY_AND_ASSIGN(ProtoLevelDBWrapper);
@@ -466,6 +466,8 @@ void SharedProtoDatabase::CommitUpdatedGlobalMetadata(
 }
 
 SharedProtoDatabase::~SharedProtoDatabase() {
+  // Writes the coalesced updates before |db_| is deleted, on the same sequence.
+  db_wrapper_->Flush();
   task_runner_->DeleteSoon(FROM_HERE, std::move(db_));
   task_runner_->DeleteSoon(FROM_HERE, std::move(metadata_db_wrapper_));
 }
@@ -31,6 +31,8 @@ UniqueProtoDatabase::UniqueProtoDatabase(
 }
 
 UniqueProtoDatabase::~UniqueProtoDatabase() {
+  // Writes the coalesced updates before |db_| is deleted, on the same sequence.
+  db_wrapper_->Flush();
   if (db_.get() &&
       !db_wrapper_->task_runner()->DeleteSoon(FROM_HERE, db_.release())) {
     DLOG(WARNING) << "Proto database will not be deleted.";
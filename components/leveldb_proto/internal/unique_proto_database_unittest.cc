@@ -22,6 +22,7 @@
 #include "base/threading/thread_task_runner_handle.h"
 #include "components/leveldb_proto/internal/leveldb_database.h"
 #include "components/leveldb_proto/internal/proto_database_impl.h"
+#include "components/leveldb_proto/internal/proto_leveldb_wrapper.h"
 #include "components/leveldb_proto/public/proto_database_provider.h"
 #include "components/leveldb_proto/testing/proto/test_db.pb.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -790,6 +791,47 @@ TEST_F(UniqueProtoDatabaseTest, TestDBRemoveFailure) {
   base::RunLoop().RunUntilIdle();
 }
 
+// Test that updates made back to back are saved with a single write, and that
+// each caller gets the result of that write.
+TEST_F(UniqueProtoDatabaseTest, TestDBCoalescesUpdates) {
+  base::FilePath path(FILE_PATH_LITERAL("/fake/path"));
+
+  auto mock_db = std::make_unique<MockDB>();
+  MockDatabaseCaller caller;
+  EntryMap model = GetSmallModel();
+
+  EXPECT_CALL(*mock_db, Init(_, options_, _));
+  EXPECT_CALL(caller, InitStatusCallback(_));
+  db_->InitWithDatabase(mock_db.get(), path, CreateSimpleOptions(),
+                        base::BindOnce(&MockDatabaseCaller::InitStatusCallback,
+                                       base::Unretained(&caller)));
+  base::RunLoop().RunUntilIdle();
+
+  // Saves "0" and "1", then removes "1" and saves "2".
+  auto entries = std::make_unique<ProtoDatabase<TestProto>::KeyEntryVector>();
+  entries->push_back(std::make_pair("0", model["0"]));
+  entries->push_back(std::make_pair("1", model["1"]));
+  auto more_entries =
+      std::make_unique<ProtoDatabase<TestProto>::KeyEntryVector>();
+  more_entries->push_back(std::make_pair("2", model["2"]));
+
+  EntryMap expected;
+  expected["0"] = model["0"];
+  expected["2"] = model["2"];
+  EXPECT_CALL(*mock_db, Save(_, KeyVector({"1"}), _))
+      .WillOnce(VerifyUpdateEntries(expected));
+  EXPECT_CALL(caller, SaveCallback(true)).Times(2);
+  db_->UpdateEntries(std::move(entries), std::make_unique<KeyVector>(),
+                     base::BindOnce(&MockDatabaseCaller::SaveCallback,
+                                    base::Unretained(&caller)));
+  db_->UpdateEntries(std::move(more_entries),
+                     std::make_unique<KeyVector>(KeyVector({"1"})),
+                     base::BindOnce(&MockDatabaseCaller::SaveCallback,
+                                    base::Unretained(&caller)));
+
+  base::RunLoop().RunUntilIdle();
+}
+
 // This tests that normal usage of the real database does not cause any
 // threading violations.
 TEST(UniqueProtoDatabaseThreadingTest, TestDBDestruction) {
@@ -824,6 +866,55 @@ TEST(UniqueProtoDatabaseThreadingTest, TestDBDestruction) {
   run_loop.Run();
 }
 
+// Test that an update still waiting to be coalesced with others is written
+// when the database is destroyed, before the LevelDB is deleted.
+TEST(UniqueProtoDatabaseThreadingTest, TestDBDestructionWritesPendingUpdate) {
+  TaskEnvironment task_environment;
+
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  base::Thread db_thread("dbthread");
+  ASSERT_TRUE(db_thread.Start());
+
+  std::unique_ptr<ProtoDatabase<TestProto>> db =
+      ProtoDatabaseProvider::CreateUniqueDB<TestProto>(db_thread.task_runner());
+
+  MockDatabaseCaller caller;
+  EXPECT_CALL(caller, InitCallback(true));
+  base::RunLoop init_loop;
+  db->Init(kTestLevelDBClientName, temp_dir.GetPath(), CreateSimpleOptions(),
+           base::BindOnce(
+               [](MockDatabaseCaller* caller, base::OnceClosure closure,
+                  bool success) {
+                 caller->InitCallback(success);
+                 std::move(closure).Run();
+               },
+               &caller, init_loop.QuitClosure()));
+  init_loop.Run();
+
+  EntryMap model = GetSmallModel();
+  auto entries = std::make_unique<ProtoDatabase<TestProto>::KeyEntryVector>();
+  entries->push_back(std::make_pair("0", model["0"]));
+  db->UpdateEntries(std::move(entries), std::make_unique<KeyVector>(),
+                    base::DoNothing());
+
+  // The update reaches the wrapper on |db_thread| just before the database is
+  // deleted there, so the write is still pending when it is destroyed.
+  db.reset();
+  // Stopping the thread runs its tasks until it is idle.
+  db_thread.Stop();
+
+  LevelDB level_db(kTestLevelDBClientName);
+  ASSERT_TRUE(level_db.Init(temp_dir.GetPath(), CreateSimpleOptions()));
+  bool found = false;
+  std::string entry;
+  leveldb::Status status;
+  EXPECT_TRUE(level_db.Get("0", &found, &entry, &status));
+  EXPECT_TRUE(found);
+  EXPECT_EQ(model["0"].SerializeAsString(), entry);
+}
+
 // This tests that normal usage of the real database does not cause any
 // threading violations.
 TEST(UniqueProtoDatabaseThreadingTest, TestDBDestroy) {
@@ -1014,6 +1105,98 @@ TEST_F(UniqueProtoDatabaseLevelDBTest, TestDBLoadKeysAndEntriesWhile) {
   }
 }
 
+// Test that a batch of updates leaves the same entries as writing them one
+// after the other.
+TEST_F(UniqueProtoDatabaseLevelDBTest, TestDBCoalescedUpdatesKeepOrder) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  LevelDB db(kTestLevelDBClientName);
+  EXPECT_TRUE(db.Init(temp_dir.GetPath(), CreateSimpleOptions()));
+  ProtoLevelDBWrapper wrapper(base::ThreadTaskRunnerHandle::Get(), &db);
+
+  int successes = 0;
+  auto count_success = base::BindRepeating(
+      [](int* successes, bool success) { *successes += success; }, &successes);
+  wrapper.UpdateEntries(std::make_unique<KeyValueVector>(
+                            KeyValueVector({{"a", "1"}, {"b", "1"}})),
+                        std::make_unique<KeyVector>(), count_success);
+  wrapper.UpdateEntries(std::make_unique<KeyValueVector>(),
+                        std::make_unique<KeyVector>(KeyVector({"a"})),
+                        count_success);
+  wrapper.UpdateEntries(
+      std::make_unique<KeyValueVector>(KeyValueVector({{"a", "2"}})),
+      std::make_unique<KeyVector>(KeyVector({"b"})), count_success);
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(3, successes);
+
+  std::map<std::string, std::string> keys_entries;
+  EXPECT_TRUE(db.LoadKeysAndEntries(&keys_entries));
+  EXPECT_EQ((std::map<std::string, std::string>{{"a", "2"}}), keys_entries);
+}
+
+TEST_F(UniqueProtoDatabaseLevelDBTest, TestDBLoadKeysAndEntriesInRange) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  LevelDB db(kTestLevelDBClientName);
+  EXPECT_TRUE(db.Init(temp_dir.GetPath(), CreateSimpleOptions()));
+  leveldb::Status status;
+  EXPECT_TRUE(db.Save({{"a", "1"}, {"b", "2"}, {"c", "3"}, {"d", "4"}}, {},
+                      &status));
+
+  std::map<std::string, std::string> keys_entries;
+  bool more = false;
+  EXPECT_TRUE(db.LoadKeysAndEntriesInRange("a", "c", 2, leveldb::ReadOptions(),
+                                           &keys_entries, &more));
+  EXPECT_EQ((std::map<std::string, std::string>{{"a", "1"}, {"b", "2"}}),
+            keys_entries);
+  EXPECT_TRUE(more);
+
+  keys_entries.clear();
+  EXPECT_TRUE(db.LoadKeysAndEntriesInRange("b", "c", 2, leveldb::ReadOptions(),
+                                           &keys_entries, &more));
+  EXPECT_EQ((std::map<std::string, std::string>{{"b", "2"}, {"c", "3"}}),
+            keys_entries);
+  EXPECT_FALSE(more);
+}
+
+TEST_F(UniqueProtoDatabaseLevelDBTest, TestDBLoadInRangeInBatches) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  LevelDB db(kTestLevelDBClientName);
+  EXPECT_TRUE(db.Init(temp_dir.GetPath(), CreateSimpleOptions()));
+  leveldb::Status status;
+  EXPECT_TRUE(db.Save(
+      {{"a", "1"}, {"b", "2"}, {"c", "3"}, {"d", "4"}, {"e", "5"}, {"f", "6"}},
+      {}, &status));
+  ProtoLevelDBWrapper wrapper(base::ThreadTaskRunnerHandle::Get(), &db);
+
+  std::vector<KeyValueMap> batches;
+  bool complete = false;
+  base::RunLoop run_loop;
+  wrapper.LoadKeysAndEntriesInRangeInBatches(
+      "b", "e", 2, leveldb::ReadOptions(),
+      base::BindRepeating(
+          [](std::vector<KeyValueMap>* batches, bool* complete,
+             base::RepeatingClosure quit, bool success,
+             std::unique_ptr<KeyValueMap> keys_entries, bool last_batch) {
+            EXPECT_TRUE(success);
+            EXPECT_FALSE(*complete);
+            batches->push_back(*keys_entries);
+            *complete = last_batch;
+            if (last_batch)
+              quit.Run();
+          },
+          &batches, &complete, run_loop.QuitClosure()));
+  run_loop.Run();
+
+  ASSERT_EQ(2u, batches.size());
+  EXPECT_EQ((KeyValueMap{{"b", "2"}, {"c", "3"}}), batches[0]);
+  EXPECT_EQ((KeyValueMap{{"d", "4"}, {"e", "5"}}), batches[1]);
+}
+
 TEST_F(UniqueProtoDatabaseLevelDBTest, TestDBInitFail) {
   ScopedTempDir temp_dir;
   ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
@@ -217,5 +217,13 @@ void RecordTileClick(const NTPTileImpression& impression) {
   }
 }
 
+void RecordTopSitesQueryTime(base::TimeDelta time) {
+  UMA_HISTOGRAM_TIMES("NewTabPage.MostVisited.TopSitesQueryTime", time);
+}
+
+void RecordTimeToFirstTiles(base::TimeDelta time) {
+  UMA_HISTOGRAM_TIMES("NewTabPage.MostVisited.TimeToFirstTiles", time);
+}
+
 }  // namespace metrics
 }  // namespace ntp_tiles
@@ -5,6 +5,7 @@
 #ifndef COMPONENTS_NTP_TILES_METRICS_H_
 #define COMPONENTS_NTP_TILES_METRICS_H_
 
+#include "base/time/time.h"
 #include "components/ntp_tiles/ntp_tile_impression.h"
 
 namespace rappor {
@@ -26,6 +27,13 @@ void RecordTileImpression(const NTPTileImpression& impression,
 // Records a click on a tile.
 void RecordTileClick(const NTPTileImpression& impression);
 
+// Records how long TopSites took to answer a query for most visited URLs.
+void RecordTopSitesQueryTime(base::TimeDelta time);
+
+// Records the time from an observer starting to observe the most visited sites
+// to it being given the first tiles.
+void RecordTimeToFirstTiles(base::TimeDelta time);
+
 }  // namespace metrics
 }  // namespace ntp_tiles
 
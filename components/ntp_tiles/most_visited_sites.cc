@@ -20,6 +20,7 @@
 #include "components/ntp_tiles/constants.h"
 #include "components/ntp_tiles/features.h"
 #include "components/ntp_tiles/icon_cacher.h"
+#include "components/ntp_tiles/metrics.h"
 #include "components/ntp_tiles/pref_names.h"
 #include "components/ntp_tiles/switches.h"
 #include "components/pref_registry/pref_registry_syncable.h"
@@ -203,6 +204,7 @@ void MostVisitedSites::SetMostVisitedURLsObserver(Observer* observer,
   DCHECK(observer);
   observer_ = observer;
   max_num_sites_ = num_sites;
+  observer_set_time_ = base::TimeTicks::Now();
 
   // The order for this condition is important, ShouldShowPopularSites() should
   // always be called last to keep metrics as relevant as possible.
@@ -434,6 +436,7 @@ void MostVisitedSites::InitiateTopSitesQuery() {
     return;
   if (top_sites_weak_ptr_factory_.HasWeakPtrs())
     return;  // Ongoing query.
+  top_sites_query_start_time_ = base::TimeTicks::Now();
   top_sites_->GetMostVisitedURLs(
       base::Bind(&MostVisitedSites::OnMostVisitedURLsAvailable,
                  top_sites_weak_ptr_factory_.GetWeakPtr()));
@@ -451,6 +454,12 @@ base::FilePath MostVisitedSites::GetWhitelistLargeIconPath(const GURL& url) {
 
 void MostVisitedSites::OnMostVisitedURLsAvailable(
     const history::MostVisitedURLList& visited_list) {
+  if (!top_sites_query_start_time_.is_null()) {
+    metrics::RecordTopSitesQueryTime(base::TimeTicks::Now() -
+                                     top_sites_query_start_time_);
+    top_sites_query_start_time_ = base::TimeTicks();
+  }
+
   // Ignore the event if tiles are provided by the Suggestions Service or custom
   // links, which take precedence.
   if (IsCustomLinksInitialized() ||
@@ -837,6 +846,11 @@ void MostVisitedSites::SaveTilesAndNotify(
   if (!observer_)
     return;
   sections[SectionType::PERSONALIZED] = *current_tiles_;
+  if (!observer_set_time_.is_null()) {
+    metrics::RecordTimeToFirstTiles(base::TimeTicks::Now() -
+                                    observer_set_time_);
+    observer_set_time_ = base::TimeTicks();
+  }
   observer_->OnURLsAvailable(sections);
 }
 
@@ -23,6 +23,7 @@
 #include "base/optional.h"
 #include "base/scoped_observer.h"
 #include "base/strings/string16.h"
+#include "base/time/time.h"
 #include "components/history/core/browser/history_types.h"
 #include "components/history/core/browser/top_sites.h"
 #include "components/history/core/browser/top_sites_observer.h"
@@ -374,6 +375,12 @@ class MostVisitedSites : public history::TopSitesObserver,
   // !current_tiles_.has_value() to current_tiles_->empty().
   base::Optional<NTPTilesVector> current_tiles_;
 
+  // When the ongoing TopSites query started.
+  base::TimeTicks top_sites_query_start_time_;
+
+  // When |observer_| was set, until it is given its first tiles.
+  base::TimeTicks observer_set_time_;
+
   // For callbacks may be run after destruction, used exclusively for TopSites
   // (since it's used to detect whether there's a query in flight).
   base::WeakPtrFactory<MostVisitedSites> top_sites_weak_ptr_factory_{this};
@@ -22,6 +22,7 @@
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/task/post_task.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/time/time.h"
 #include "base/trace_event/memory_dump_manager.h"
@@ -219,12 +220,22 @@ AutocompleteController::AutocompleteController(
       zero_suggest_provider_(nullptr),
       on_device_head_provider_(nullptr),
       stop_timer_duration_(OmniboxFieldTrial::StopTimerFieldTrialDuration()),
+      run_providers_in_parallel_(
+          base::FeatureList::IsEnabled(omnibox::kOmniboxParallelProviders)),
+      pending_background_matchers_(0),
       done_(true),
       in_start_(false),
       first_query_(true),
       search_service_worker_signal_sent_(false),
       template_url_service_(provider_client_->GetTemplateURLService()) {
   provider_types &= ~OmniboxFieldTrial::GetDisabledProviderTypes();
+  if (run_providers_in_parallel_) {
+    // Matches are only useful while the user is typing, so don't block
+    // shutdown on them.
+    background_task_runner_ = base::CreateSequencedTaskRunner(
+        {base::ThreadPool(), base::TaskPriority::USER_BLOCKING,
+         base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN});
+  }
   if (provider_types & AutocompleteProvider::TYPE_BOOKMARK)
     providers_.push_back(new BookmarkProvider(provider_client_.get()));
   if (provider_types & AutocompleteProvider::TYPE_BUILTIN)
@@ -346,11 +357,23 @@ void AutocompleteController::Start(const AutocompleteInput& input) {
 
   expire_timer_.Stop();
   stop_timer_.Stop();
+  CancelBackgroundMatching();
 
   // Start the new query.
   in_start_ = true;
   base::TimeTicks start_time = base::TimeTicks::Now();
+  query_start_time_ = start_time;
   for (auto i(providers_.begin()); i != providers_.end(); ++i) {
+    // Only queries that may finish asynchronously can wait for the background
+    // matches; the others need every match before Start() returns.
+    if (run_providers_in_parallel_ && input.want_asynchronous_matches()) {
+      AutocompleteProvider::BackgroundMatcher matcher =
+          (*i)->GetBackgroundMatcher(input_, minimal_changes);
+      if (matcher) {
+        StartBackgroundMatching(*i, std::move(matcher));
+        continue;
+      }
+    }
     // TODO(mpearson): Remove timing code once bug 178705 is resolved.
     base::TimeTicks provider_start_time = base::TimeTicks::Now();
     (*i)->Start(input_, minimal_changes);
@@ -399,6 +422,9 @@ void AutocompleteController::Start(const AutocompleteInput& input) {
     first_query_ = false;
   }
 
+  if (!pending_background_matchers_)
+    RecordKeystrokeToResultsTime();
+
   // If the input looks like a query, send a signal predicting that the user is
   // going to issue a search (either to the default search engine or to a
   // keyword search engine, as indicated by the destination_url). This allows
@@ -783,8 +809,54 @@ void AutocompleteController::StartStopTimer() {
                                    base::Unretained(this), false, true));
 }
 
+void AutocompleteController::StartBackgroundMatching(
+    scoped_refptr<AutocompleteProvider> provider,
+    AutocompleteProvider::BackgroundMatcher matcher) {
+  provider->OnBackgroundMatchingStarted();
+  ++pending_background_matchers_;
+  // |background_task_tracker_| cancels the reply when |this| is destroyed.
+  background_task_tracker_.PostTaskAndReplyWithResult(
+      background_task_runner_.get(), FROM_HERE, std::move(matcher),
+      base::BindOnce(&AutocompleteController::OnBackgroundMatchesReady,
+                     base::Unretained(this), std::move(provider)));
+}
+
+void AutocompleteController::OnBackgroundMatchesReady(
+    scoped_refptr<AutocompleteProvider> provider,
+    ACMatches matches) {
+  DCHECK_GT(pending_background_matchers_, 0u);
+  provider->OnBackgroundMatchesReady(std::move(matches));
+  --pending_background_matchers_;
+  OnProviderUpdate(true);
+  if (!pending_background_matchers_)
+    RecordKeystrokeToResultsTime();
+}
+
+void AutocompleteController::CancelBackgroundMatching() {
+  if (!pending_background_matchers_)
+    return;
+  base::UmaHistogramCounts100("Omnibox.ParallelProviders.CanceledMatchers",
+                              pending_background_matchers_);
+  background_task_tracker_.TryCancelAll();
+  pending_background_matchers_ = 0;
+}
+
+void AutocompleteController::RecordKeystrokeToResultsTime() {
+  // Queries that don't come from typing in the omnibox, e.g. classifying
+  // pasted text, aren't keystrokes.
+  if (!input_.want_asynchronous_matches())
+    return;
+  base::UmaHistogramTimes(run_providers_in_parallel_
+                              ? "Omnibox.KeystrokeToLocalResultsTime.Parallel"
+                              : "Omnibox.KeystrokeToLocalResultsTime.Serial",
+                          base::TimeTicks::Now() - query_start_time_);
+}
+
 void AutocompleteController::StopHelper(bool clear_result,
                                         bool due_to_user_inactivity) {
+  // Providers whose matches are still being computed are done after Stop() as
+  // well.
+  CancelBackgroundMatching();
   for (Providers::const_iterator i(providers_.begin()); i != providers_.end();
        ++i) {
     (*i)->Stop(clear_result, due_to_user_inactivity);
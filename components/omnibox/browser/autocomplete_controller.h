@@ -12,7 +12,9 @@
 #include "base/gtest_prod_util.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/sequenced_task_runner.h"
 #include "base/strings/string16.h"
+#include "base/task/cancelable_task_tracker.h"
 #include "base/time/time.h"
 #include "base/timer/timer.h"
 #include "base/trace_event/memory_dump_provider.h"
@@ -49,6 +51,10 @@ class OnDeviceHeadProvider;
 // autocomplete system.  All calls to and from the AutocompleteController should
 // happen on the same thread.  AutocompleteProviders are responsible for doing
 // their own thread management when they need to return matches asynchronously.
+// The one exception is the matching of providers that return a
+// GetBackgroundMatcher(): when the kOmniboxParallelProviders feature is on,
+// the controller runs it on a ThreadPool sequence and hands the matches back to
+// the provider on this thread.
 //
 // The coordinator for autocomplete queries, responsible for combining the
 // matches from a series of providers into one AutocompleteResult.
@@ -209,6 +215,21 @@ class AutocompleteController : public AutocompleteProviderListener,
   // Starts |stop_timer_|.
   void StartStopTimer();
 
+  // Runs |matcher| for |provider| on |background_task_runner_|, and passes its
+  // matches back to |provider| in OnBackgroundMatchesReady().
+  void StartBackgroundMatching(scoped_refptr<AutocompleteProvider> provider,
+                               AutocompleteProvider::BackgroundMatcher matcher);
+  void OnBackgroundMatchesReady(scoped_refptr<AutocompleteProvider> provider,
+                                ACMatches matches);
+
+  // Drops the background matching still running for the previous query, so
+  // that its matches are never merged into |result_|.
+  void CancelBackgroundMatching();
+
+  // Records how long the matches of all the providers that don't go to the
+  // network took to reach |result_| since the last Start().
+  void RecordKeystrokeToResultsTime();
+
   // Helper function for Stop().  |due_to_user_inactivity| means this call was
   // triggered by a user's idleness, i.e., not an explicit user action.
   void StopHelper(bool clear_result,
@@ -276,6 +297,24 @@ class AutocompleteController : public AutocompleteProviderListener,
   // and doesn't expect it to change.
   const base::TimeDelta stop_timer_duration_;
 
+  // True if the matching of providers with a GetBackgroundMatcher() runs on
+  // |background_task_runner_| rather than in Start().
+  const bool run_providers_in_parallel_;
+
+  // Where background matching runs. Null unless |run_providers_in_parallel_|.
+  scoped_refptr<base::SequencedTaskRunner> background_task_runner_;
+
+  // Tracks the background matching of the current query, so that a newer
+  // query or Stop() can cancel it.
+  base::CancelableTaskTracker background_task_tracker_;
+
+  // The number of providers whose background matches for the current query
+  // are not back yet.
+  size_t pending_background_matchers_;
+
+  // When the current query was started.
+  base::TimeTicks query_start_time_;
+
   // True if a query is not currently running.
   bool done_;
 
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <set>
 #include <string>
+#include <utility>
 
 #include "base/feature_list.h"
 #include "base/i18n/case_conversion.h"
@@ -64,6 +65,26 @@ const char* AutocompleteProvider::TypeToString(Type type) {
   }
 }
 
+AutocompleteProvider::BackgroundMatcher
+AutocompleteProvider::GetBackgroundMatcher(const AutocompleteInput& input,
+                                           bool minimal_changes) {
+  return BackgroundMatcher();
+}
+
+void AutocompleteProvider::OnBackgroundMatchingStarted() {
+  matches_.clear();
+  done_ = false;
+}
+
+void AutocompleteProvider::OnBackgroundMatchesReady(ACMatches matches) {
+  matches_ = std::move(matches);
+  for (AutocompleteMatch& match : matches_) {
+    DCHECK(!match.provider);
+    match.provider = this;
+  }
+  done_ = true;
+}
+
 void AutocompleteProvider::Stop(bool clear_cached_results,
                                 bool due_to_user_inactivity) {
   done_ = true;
@@ -11,6 +11,7 @@
 #include <utility>
 #include <vector>
 
+#include "base/callback.h"
 #include "base/gtest_prod_util.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -175,6 +176,25 @@ class AutocompleteProvider
   // OmniboxPopupModel::StartAutocomplete().
   virtual void Start(const AutocompleteInput& input, bool minimal_changes) = 0;
 
+  // Computes a provider's matches away from the main thread. See
+  // GetBackgroundMatcher().
+  using BackgroundMatcher = base::OnceCallback<ACMatches()>;
+
+  // Returns a callback computing this provider's matches for |input| that
+  // only reads immutable state or state it owns, so that AutocompleteController
+  // can run it on a ThreadPool sequence instead of calling Start(). The
+  // matches it returns have a null |provider|; OnBackgroundMatchesReady() sets
+  // it. Providers that can't do this for |input| return a null callback, which
+  // is what the default implementation does.
+  virtual BackgroundMatcher GetBackgroundMatcher(const AutocompleteInput& input,
+                                                 bool minimal_changes);
+
+  // Called by AutocompleteController on the main thread when it starts
+  // running the callback from GetBackgroundMatcher(), and with its matches
+  // when it is done. The provider is not done() in between.
+  void OnBackgroundMatchingStarted();
+  void OnBackgroundMatchesReady(ACMatches matches);
+
   // Advises the provider to stop processing.  This may be called even if the
   // provider is already done.  If the provider caches any results, it should
   // clear the cache based on the value of |clear_cached_results|.  Normally,
@@ -19,6 +19,7 @@
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/task_environment.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "components/omnibox/browser/autocomplete_controller.h"
@@ -28,6 +29,7 @@
 #include "components/omnibox/browser/keyword_provider.h"
 #include "components/omnibox/browser/mock_autocomplete_provider_client.h"
 #include "components/omnibox/browser/search_provider.h"
+#include "components/omnibox/common/omnibox_features.h"
 #include "components/open_from_clipboard/fake_clipboard_recent_content.h"
 #include "components/search_engines/search_engines_switches.h"
 #include "components/search_engines/template_url.h"
@@ -202,6 +204,48 @@ void TestProvider::AddResultsWithSearchTermsArgs(
   }
 }
 
+// Autocomplete provider whose matching can run away from the main thread. Its
+// matches are the input text followed by a digit.
+class BackgroundTestProvider : public AutocompleteProvider {
+ public:
+  BackgroundTestProvider()
+      : AutocompleteProvider(AutocompleteProvider::TYPE_BUILTIN) {}
+
+  void Start(const AutocompleteInput& input, bool minimal_changes) override {
+    matches_ = MatchesForText(input.text());
+    for (AutocompleteMatch& match : matches_)
+      match.provider = this;
+  }
+
+  BackgroundMatcher GetBackgroundMatcher(const AutocompleteInput& input,
+                                         bool minimal_changes) override {
+    return base::BindOnce(&BackgroundTestProvider::MatchesForText,
+                          input.text());
+  }
+
+ private:
+  ~BackgroundTestProvider() override {}
+
+  static ACMatches MatchesForText(const base::string16& text) {
+    ACMatches matches;
+    for (int i = 0; i < 2; ++i) {
+      AutocompleteMatch match(nullptr, 1000 - i, false,
+                              AutocompleteMatchType::URL_WHAT_YOU_TYPED);
+      match.fill_into_edit = text + base::NumberToString16(i);
+      match.destination_url =
+          GURL("http://" + base::UTF16ToUTF8(match.fill_into_edit));
+      match.allowed_to_be_default_match = true;
+      match.contents = match.fill_into_edit;
+      match.contents_class.push_back(
+          ACMatchClassification(0, ACMatchClassification::NONE));
+      matches.push_back(match);
+    }
+    return matches;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundTestProvider);
+};
+
 // Helper class to make running tests of ClassifyAllMatchesInString() more
 // convenient.
 class ClassifyTest {
@@ -278,6 +322,14 @@ class AutocompleteProviderTest : public testing::Test {
 
   void RunQuery(const std::string& query, bool allow_exact_keyword_match);
 
+  // Resets |controller_| with a single BackgroundTestProvider, which is
+  // returned in |provider_ptr|.
+  void ResetControllerWithBackgroundProvider(
+      BackgroundTestProvider** provider_ptr);
+
+  // Starts a query on |query| without waiting for it to finish.
+  void StartQuery(const std::string& query, bool want_asynchronous_matches);
+
   void ResetControllerWithKeywordAndSearchProviders();
   void ResetControllerWithKeywordProvider();
   void RunExactKeymatchTest(bool allow_exact_keyword_match);
@@ -304,6 +356,10 @@ class AutocompleteProviderTest : public testing::Test {
     controller_->input_.current_page_classification_ = classification;
   }
 
+  AutocompleteController* controller() { return controller_.get(); }
+
+  void RunUntilIdle() { task_environment_.RunUntilIdle(); }
+
   AutocompleteResult result_;
 
  private:
@@ -404,6 +460,24 @@ void AutocompleteProviderTest::ResetControllerWithTestProviders(
     *provider2_ptr = provider2;
 }
 
+void AutocompleteProviderTest::ResetControllerWithBackgroundProvider(
+    BackgroundTestProvider** provider_ptr) {
+  ResetControllerWithType(0);
+  EXPECT_TRUE(controller_->providers_.empty());
+  *provider_ptr = new BackgroundTestProvider();
+  controller_->providers_.push_back(*provider_ptr);
+}
+
+void AutocompleteProviderTest::StartQuery(const std::string& query,
+                                          bool want_asynchronous_matches) {
+  AutocompleteInput input(base::ASCIIToUTF16(query),
+                          metrics::OmniboxEventProto::OTHER,
+                          TestingSchemeClassifier());
+  input.set_prevent_inline_autocomplete(true);
+  input.set_want_asynchronous_matches(want_asynchronous_matches);
+  controller_->Start(input);
+}
+
 void AutocompleteProviderTest::ResetControllerWithKeywordAndSearchProviders() {
   // Reset the default TemplateURL.
   TemplateURLData data;
@@ -627,6 +701,68 @@ TEST_F(AutocompleteProviderTest, RemoveDuplicates) {
     EXPECT_EQ(provider2, i->provider);
 }
 
+// Tests that the matching of providers with a background matcher runs off the
+// main thread when parallel providers are enabled.
+TEST_F(AutocompleteProviderTest, BackgroundMatching) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(omnibox::kOmniboxParallelProviders);
+  BackgroundTestProvider* provider = nullptr;
+  ResetControllerWithBackgroundProvider(&provider);
+
+  StartQuery("ab", true);
+  EXPECT_FALSE(controller()->done());
+  EXPECT_FALSE(provider->done());
+  EXPECT_TRUE(provider->matches().empty());
+
+  RunUntilIdle();
+  EXPECT_TRUE(controller()->done());
+  EXPECT_TRUE(provider->done());
+  ASSERT_EQ(2u, controller()->result().size());
+  EXPECT_EQ(base::ASCIIToUTF16("ab0"),
+            controller()->result().match_at(0)->fill_into_edit);
+  EXPECT_EQ(provider, controller()->result().match_at(0)->provider);
+  EXPECT_EQ(provider, controller()->result().match_at(1)->provider);
+
+  // Queries that can't finish asynchronously still get every match from
+  // Start().
+  StartQuery("cd", false);
+  EXPECT_TRUE(controller()->done());
+  ASSERT_EQ(2u, controller()->result().size());
+  EXPECT_EQ(base::ASCIIToUTF16("cd0"),
+            controller()->result().match_at(0)->fill_into_edit);
+}
+
+// Tests that the background matches of an old query are never merged once a
+// newer query started or the query was stopped.
+TEST_F(AutocompleteProviderTest, BackgroundMatchingCanceledByNewInput) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(omnibox::kOmniboxParallelProviders);
+  BackgroundTestProvider* provider = nullptr;
+  ResetControllerWithBackgroundProvider(&provider);
+
+  StartQuery("a", true);
+  StartQuery("ab", true);
+  RunUntilIdle();
+  EXPECT_TRUE(controller()->done());
+  ASSERT_EQ(2u, controller()->result().size());
+  EXPECT_EQ(base::ASCIIToUTF16("ab0"),
+            controller()->result().match_at(0)->fill_into_edit);
+  EXPECT_EQ(base::ASCIIToUTF16("ab1"),
+            controller()->result().match_at(1)->fill_into_edit);
+
+  StartQuery("abc", true);
+  controller()->Stop(false);
+  EXPECT_TRUE(controller()->done());
+  EXPECT_TRUE(provider->done());
+  RunUntilIdle();
+  EXPECT_TRUE(provider->matches().empty());
+  for (const AutocompleteMatch& match : controller()->result()) {
+    EXPECT_FALSE(base::StartsWith(match.fill_into_edit,
+                                  base::ASCIIToUTF16("abc"),
+                                  base::CompareCase::SENSITIVE));
+  }
+}
+
 TEST_F(AutocompleteProviderTest, AllowExactKeywordMatch) {
   ResetControllerWithKeywordAndSearchProviders();
   RunExactKeymatchTest(true);
@@ -0,0 +1,90 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "components/omnibox/browser/fixed_substring_index.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+base::StringPiece FixedSubstringIndex::GetString(size_t index) const {
+  DCHECK_LT(index, string_count_);
+  // Leave out the NUL terminator.
+  return base::StringPiece(chars_ + offsets_[index],
+                           offsets_[index + 1] - offsets_[index] - 1);
+}
+
+std::vector<size_t> FixedSubstringIndex::FindStringsContaining(
+    base::StringPiece needle,
+    size_t max_results) const {
+  std::vector<size_t> results;
+  if (max_results == 0)
+    return results;
+
+  if (needle.empty()) {
+    for (size_t i = 0; i < std::min(max_results, string_count_); ++i)
+      results.push_back(i);
+    return results;
+  }
+
+  // The suffixes starting with |needle| sort after every suffix that is less
+  // than |needle| and before every suffix whose first needle.size() chars are
+  // greater than |needle|.
+  const uint16_t* suffixes_end = suffixes_ + suffix_count_;
+  const uint16_t* first = std::lower_bound(
+      suffixes_, suffixes_end, needle,
+      [this](uint16_t offset, base::StringPiece text) {
+        return GetSuffix(offset) < text;
+      });
+  const uint16_t* last = std::upper_bound(
+      first, suffixes_end, needle,
+      [this](base::StringPiece text, uint16_t offset) {
+        return text < GetSuffix(offset).substr(0, text.size());
+      });
+
+  // When many strings contain |needle|, the first |max_results| of them are
+  // found sooner by checking the strings in list order: that takes about
+  // |string_count_| * |max_results| / |range_size| checks, against
+  // |range_size| steps below.
+  const size_t range_size = last - first;
+  if (range_size * range_size > string_count_ * max_results) {
+    for (size_t i = 0; i < string_count_ && results.size() < max_results;
+         ++i) {
+      if (GetString(i).find(needle) != base::StringPiece::npos)
+        results.push_back(i);
+    }
+    return results;
+  }
+
+  // The suffixes are not in list order, and a string containing |needle| more
+  // than once owns several of them. Keep the |max_results| smallest distinct
+  // string indices seen, in order.
+  for (const uint16_t* suffix = first; suffix != last; ++suffix) {
+    const size_t string_index = StringIndexForOffset(*suffix);
+    if (results.size() == max_results && string_index >= results.back())
+      continue;
+    const size_t position =
+        std::lower_bound(results.begin(), results.end(), string_index) -
+        results.begin();
+    if (position < results.size() && results[position] == string_index)
+      continue;
+    if (results.size() == max_results)
+      results.pop_back();
+    results.insert(results.begin() + position, string_index);
+  }
+  return results;
+}
+
+base::StringPiece FixedSubstringIndex::GetSuffix(uint16_t offset) const {
+  return base::StringPiece(chars_ + offset);
+}
+
+size_t FixedSubstringIndex::StringIndexForOffset(uint16_t offset) const {
+  // |offsets_| is increasing and starts at 0, so this finds the last string
+  // starting at or before |offset|.
+  const uint16_t* next_string =
+      std::upper_bound(offsets_, offsets_ + string_count_ + 1, offset);
+  DCHECK(next_string != offsets_);
+  return next_string - offsets_ - 1;
+}
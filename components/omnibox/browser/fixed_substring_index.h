@@ -0,0 +1,68 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef COMPONENTS_OMNIBOX_BROWSER_FIXED_SUBSTRING_INDEX_H_
+#define COMPONENTS_OMNIBOX_BROWSER_FIXED_SUBSTRING_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/strings/string_piece.h"
+
+// Finds which strings of a fixed list contain a given substring, without
+// scanning the whole list. The list must be known at compile time: a script
+// such as make_topsites_index.py turns it into three constant arrays:
+//   |chars|     Every string followed by a NUL, in list order.
+//   |offsets|   The offset of each string in |chars|, followed by the total
+//               size of |chars|, so |string_count| + 1 entries.
+//   |suffixes|  The offset in |chars| of every non-empty suffix of every
+//               string, sorted by the text of the suffix.
+// The strings that contain a substring are then those owning the suffixes
+// that start with it, which form a contiguous range of |suffixes|. When that
+// range is large the substring is common, and the first few strings that
+// contain it are quicker to find by checking the strings in list order.
+//
+// The class only points at the arrays, so a constexpr instance built over
+// constant arrays costs no static initializer and no heap allocation.
+class FixedSubstringIndex {
+ public:
+  constexpr FixedSubstringIndex(const char* chars,
+                                const uint16_t* offsets,
+                                size_t string_count,
+                                const uint16_t* suffixes,
+                                size_t suffix_count)
+      : chars_(chars),
+        offsets_(offsets),
+        string_count_(string_count),
+        suffixes_(suffixes),
+        suffix_count_(suffix_count) {}
+
+  size_t string_count() const { return string_count_; }
+
+  // Returns the |index|th string of the list.
+  base::StringPiece GetString(size_t index) const;
+
+  // Returns, in increasing order, the indices of the first |max_results|
+  // strings of the list which contain |needle|. The comparison is
+  // case-sensitive. An empty |needle| is contained in every string.
+  std::vector<size_t> FindStringsContaining(base::StringPiece needle,
+                                            size_t max_results) const;
+
+ private:
+  // Returns the NUL-terminated suffix starting at |offset| in |chars_|.
+  base::StringPiece GetSuffix(uint16_t offset) const;
+
+  // Returns the index of the string that the char at |offset| belongs to.
+  size_t StringIndexForOffset(uint16_t offset) const;
+
+  const char* const chars_;
+  const uint16_t* const offsets_;
+  const size_t string_count_;
+  const uint16_t* const suffixes_;
+  const size_t suffix_count_;
+};
+
+#endif  // COMPONENTS_OMNIBOX_BROWSER_FIXED_SUBSTRING_INDEX_H_
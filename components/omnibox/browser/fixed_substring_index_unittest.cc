@@ -0,0 +1,123 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "components/omnibox/browser/fixed_substring_index.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/stl_util.h"
+#include "components/omnibox/browser/topsites_provider.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// "banana", "band" and "ab", laid out as make_topsites_index.py would.
+constexpr char kChars[] = "banana\0band\0ab\0";
+constexpr uint16_t kOffsets[] = {0, 7, 12, 15};
+// a, ab, ana, anana, and, b, banana, band, d, na, nana, nd.
+constexpr uint16_t kSuffixes[] = {5, 12, 3, 1, 8, 13, 0, 7, 10, 4, 2, 9};
+
+constexpr FixedSubstringIndex kIndex(kChars,
+                                     kOffsets,
+                                     base::size(kOffsets) - 1,
+                                     kSuffixes,
+                                     base::size(kSuffixes));
+
+std::vector<size_t> Find(const FixedSubstringIndex& index,
+                         base::StringPiece needle,
+                         size_t max_results = 100) {
+  return index.FindStringsContaining(needle, max_results);
+}
+
+// The straightforward way of answering FindStringsContaining().
+std::vector<size_t> FindLinear(const FixedSubstringIndex& index,
+                               base::StringPiece needle) {
+  std::vector<size_t> results;
+  for (size_t i = 0; i < index.string_count(); ++i) {
+    if (index.GetString(i).find(needle) != base::StringPiece::npos)
+      results.push_back(i);
+  }
+  return results;
+}
+
+}  // namespace
+
+TEST(FixedSubstringIndexTest, GetString) {
+  ASSERT_EQ(3u, kIndex.string_count());
+  EXPECT_EQ("banana", kIndex.GetString(0));
+  EXPECT_EQ("band", kIndex.GetString(1));
+  EXPECT_EQ("ab", kIndex.GetString(2));
+}
+
+TEST(FixedSubstringIndexTest, FindStringsContaining) {
+  EXPECT_EQ((std::vector<size_t>{0, 1, 2}), Find(kIndex, "a"));
+  EXPECT_EQ((std::vector<size_t>{0, 1, 2}), Find(kIndex, "b"));
+  EXPECT_EQ((std::vector<size_t>{0, 1}), Find(kIndex, "an"));
+  EXPECT_EQ((std::vector<size_t>{0, 1}), Find(kIndex, "ban"));
+  EXPECT_EQ((std::vector<size_t>{0}), Find(kIndex, "nan"));
+  EXPECT_EQ((std::vector<size_t>{0}), Find(kIndex, "banana"));
+  EXPECT_EQ((std::vector<size_t>{1}), Find(kIndex, "d"));
+  EXPECT_EQ((std::vector<size_t>{2}), Find(kIndex, "ab"));
+
+  // Only whole substrings match, and case matters.
+  EXPECT_TRUE(Find(kIndex, "bananas").empty());
+  EXPECT_TRUE(Find(kIndex, "bd").empty());
+  EXPECT_TRUE(Find(kIndex, "A").empty());
+  EXPECT_TRUE(Find(kIndex, "z").empty());
+  EXPECT_TRUE(Find(kIndex, base::StringPiece("a\0b", 3)).empty());
+
+  // An empty needle is contained in every string.
+  EXPECT_EQ((std::vector<size_t>{0, 1, 2}), Find(kIndex, ""));
+}
+
+TEST(FixedSubstringIndexTest, MaxResults) {
+  EXPECT_EQ((std::vector<size_t>{0, 1}), Find(kIndex, "a", 2));
+  EXPECT_EQ((std::vector<size_t>{0}), Find(kIndex, "b", 1));
+  EXPECT_EQ((std::vector<size_t>{0}), Find(kIndex, "", 1));
+  EXPECT_TRUE(Find(kIndex, "a", 0).empty());
+}
+
+TEST(FixedSubstringIndexTest, Empty) {
+  constexpr char kNoChars[] = "";
+  constexpr uint16_t kNoOffsets[] = {0};
+  const FixedSubstringIndex index(kNoChars, kNoOffsets, 0, nullptr, 0);
+  EXPECT_EQ(0u, index.string_count());
+  EXPECT_TRUE(Find(index, "a").empty());
+  EXPECT_TRUE(Find(index, "").empty());
+}
+
+// Checks the generated index of TopSitesProvider against a linear search, for
+// every substring of up to four chars of every site, plus a few more.
+TEST(FixedSubstringIndexTest, TopSites) {
+  const FixedSubstringIndex& index = TopSitesProvider::GetTopSitesIndex();
+  ASSERT_GT(index.string_count(), 0u);
+
+  std::set<std::string> needles = {"google.com", "com.cn", "brave.com",
+                                   "http", "..", "Google", "-"};
+  for (size_t i = 0; i < index.string_count(); ++i) {
+    base::StringPiece site = index.GetString(i);
+    ASSERT_FALSE(site.empty());
+    needles.insert(site.as_string());
+    for (size_t start = 0; start < site.size(); ++start) {
+      for (size_t length = 1; length <= 4 && start + length <= site.size();
+           ++length) {
+        needles.insert(site.substr(start, length).as_string());
+      }
+    }
+  }
+
+  for (const std::string& needle : needles) {
+    SCOPED_TRACE(needle);
+    std::vector<size_t> expected = FindLinear(index, needle);
+    EXPECT_EQ(expected, Find(index, needle, index.string_count()));
+    if (expected.size() > 3)
+      expected.resize(3);
+    EXPECT_EQ(expected, Find(index, needle, 3));
+  }
+}
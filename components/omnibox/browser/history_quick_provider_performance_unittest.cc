@@ -8,11 +8,15 @@
 #include <random>
 #include <string>
 
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/no_destructor.h"
 #include "base/run_loop.h"
 #include "base/stl_util.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/test/task_environment.h"
+#include "base/timer/elapsed_timer.h"
 #include "components/history/core/browser/history_backend.h"
 #include "components/history/core/browser/history_database.h"
 #include "components/history/core/browser/history_service.h"
@@ -20,6 +24,7 @@
 #include "components/omnibox/browser/fake_autocomplete_provider_client.h"
 #include "components/omnibox/browser/history_test_util.h"
 #include "components/omnibox/browser/in_memory_url_index_test_util.h"
+#include "components/omnibox/browser/url_index_private_data.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/perf/perf_test.h"
 
@@ -213,4 +218,140 @@ TEST_F(HQPPerfTestOnePopularURL, Backspacing) {
   RunAllTests(prefixes.rbegin(), prefixes.rend());
 }
 
+// Measures restoring URLIndexPrivateData from its cache files and querying
+// the restored, memory-mapped word index, against a synthetic history of many
+// distinct URLs.
+class HQPPerfTestLargeHistory : public testing::Test {
+ protected:
+  HQPPerfTestLargeHistory() = default;
+
+  void SetUp() override;
+  void TearDown() override;
+
+  history::HistoryBackend* history_backend() {
+    return client_->GetHistoryService()->history_backend_.get();
+  }
+
+  // Times HistoryItemsForTerms() for every prefix of each of |queries|
+  // against |private_data|, and reports the total as |trace|.
+  void TimeQueries(URLIndexPrivateData* private_data,
+                   const std::vector<std::string>& queries,
+                   const std::string& trace);
+
+  void PrintResult(const std::string& trace,
+                   size_t value,
+                   const std::string& units);
+
+ private:
+  base::test::TaskEnvironment task_environment_;
+  std::unique_ptr<FakeAutocompleteProviderClient> client_;
+
+  DISALLOW_COPY_AND_ASSIGN(HQPPerfTestLargeHistory);
+};
+
+void HQPPerfTestLargeHistory::SetUp() {
+  client_ = std::make_unique<FakeAutocompleteProviderClient>();
+  ASSERT_TRUE(client_->GetHistoryService());
+
+#if defined NDEBUG
+  constexpr size_t kUrlCount = 100000;
+#else
+  LOG(ERROR) << "HQP performance test is running on a debug build, results may "
+                "not be accurate.";
+  constexpr size_t kUrlCount = 1000;
+#endif
+  static constexpr const char* kTitleWords[] = {
+      "news",  "weather", "mail",   "search", "video", "music",  "recipes",
+      "maps",  "sports",  "travel", "shop",   "bank",  "forum",  "docs",
+      "photo", "jobs",    "movies", "games",  "wiki",  "social", "cars"};
+  for (size_t i = 0; i < kUrlCount; ++i) {
+    const std::string host = "site" + base::NumberToString(i % 5000) +
+                             ".example" + base::NumberToString(i % 13) + ".com";
+    URLRow row{GURL("https://" + host + "/" + GenerateFakeHashedString(12))};
+    row.set_title(base::UTF8ToUTF16(
+        std::string(kTitleWords[i % base::size(kTitleWords)]) + " " +
+        kTitleWords[(i / 7) % base::size(kTitleWords)] + " " +
+        GenerateFakeHashedString(6)));
+    row.set_visit_count(1 + i % 5);
+    row.set_typed_count(i % 3 == 0 ? 1 : 0);
+    row.set_last_visit(base::Time::Now() - base::TimeDelta::FromHours(i % 500));
+    AddFakeURLToHistoryDB(history_backend()->db(), row);
+  }
+}
+
+void HQPPerfTestLargeHistory::TearDown() {
+  client_.reset();
+  task_environment_.RunUntilIdle();
+}
+
+void HQPPerfTestLargeHistory::TimeQueries(
+    URLIndexPrivateData* private_data,
+    const std::vector<std::string>& queries,
+    const std::string& trace) {
+  base::ElapsedTimer timer;
+  for (const std::string& query : queries) {
+    for (const base::StringPiece& prefix : AllPrefixes(query)) {
+      if (prefix.empty())
+        continue;
+      private_data->HistoryItemsForTerms(base::UTF8ToUTF16(prefix),
+                                         base::string16::npos, 10, nullptr,
+                                         nullptr);
+    }
+  }
+  PrintResult(trace, timer.Elapsed().InMicroseconds(), "us");
+}
+
+void HQPPerfTestLargeHistory::PrintResult(const std::string& trace,
+                                          size_t value,
+                                          const std::string& units) {
+  auto* test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+  perf_test::PrintResult(test_info->test_case_name(), test_info->name(), trace,
+                         value, units, true);
+}
+
+TEST_F(HQPPerfTestLargeHistory, CacheRestoreAndQuery) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath cache_path =
+      temp_dir.GetPath().AppendASCII("History Provider Cache");
+  const std::set<std::string> scheme_whitelist = {"http", "https"};
+
+  base::ElapsedTimer rebuild_timer;
+  scoped_refptr<URLIndexPrivateData> rebuilt_data =
+      URLIndexPrivateData::RebuildFromHistory(history_backend()->db(),
+                                              scheme_whitelist);
+  PrintResult("rebuild_from_history",
+              rebuild_timer.Elapsed().InMilliseconds(), "ms");
+  ASSERT_TRUE(rebuilt_data);
+
+  base::ElapsedTimer save_timer;
+  ASSERT_TRUE(URLIndexPrivateData::WritePrivateDataToCacheFileTask(
+      rebuilt_data, cache_path));
+  PrintResult("save_cache", save_timer.Elapsed().InMilliseconds(), "ms");
+
+  int64_t cache_size = 0;
+  int64_t flat_size = 0;
+  ASSERT_TRUE(base::GetFileSize(cache_path, &cache_size));
+  ASSERT_TRUE(base::GetFileSize(
+      URLIndexPrivateData::FlatDataFilePath(cache_path), &flat_size));
+  PrintResult("cache_file_size", cache_size, "bytes");
+  PrintResult("word_index_file_size", flat_size, "bytes");
+
+  base::ElapsedTimer restore_timer;
+  scoped_refptr<URLIndexPrivateData> restored_data =
+      URLIndexPrivateData::RestoreFromFile(cache_path);
+  PrintResult("restore_from_cache", restore_timer.Elapsed().InMilliseconds(),
+              "ms");
+  ASSERT_TRUE(restored_data);
+  PrintResult("rebuilt_memory_usage", rebuilt_data->EstimateMemoryUsage(),
+              "bytes");
+  PrintResult("restored_memory_usage", restored_data->EstimateMemoryUsage(),
+              "bytes");
+
+  const std::vector<std::string> queries = {
+      "site123.example4", "weather news", "https://site42", "mail", "zzz"};
+  TimeQueries(rebuilt_data.get(), queries, "query_rebuilt");
+  TimeQueries(restored_data.get(), queries, "query_restored");
+}
+
 }  // namespace history
@@ -204,7 +204,8 @@ void InMemoryURLIndex::OnURLsDeleted(
   if (needs_to_be_cached_ && GetCacheFilePath(&path))
     task_runner_->PostTask(
         FROM_HERE,
-        base::BindOnce(base::IgnoreResult(base::DeleteFile), path, false));
+        base::BindOnce(
+            base::IgnoreResult(&URLIndexPrivateData::DeleteCacheFiles), path));
 }
 
 void InMemoryURLIndex::OnHistoryServiceLoaded(
@@ -271,7 +272,8 @@ void InMemoryURLIndex::OnCacheLoadDone(
       return;
     task_runner_->PostTask(
         FROM_HERE,
-        base::BindOnce(base::IgnoreResult(base::DeleteFile), path, false));
+        base::BindOnce(
+            base::IgnoreResult(&URLIndexPrivateData::DeleteCacheFiles), path));
     if (history_service_->backend_loaded()) {
       ScheduleRebuildFromHistory();
     } else {
@@ -360,7 +362,8 @@ void InMemoryURLIndex::PostSaveToCacheFileTask() {
     // If there is no data in our index then delete any existing cache file.
     task_runner_->PostTask(
         FROM_HERE,
-        base::BindOnce(base::IgnoreResult(base::DeleteFile), path, false));
+        base::BindOnce(
+            base::IgnoreResult(&URLIndexPrivateData::DeleteCacheFiles), path));
   }
 }
 
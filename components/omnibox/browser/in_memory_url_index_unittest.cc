@@ -956,6 +956,51 @@ TEST_F(InMemoryURLIndexTest, TypedCharacterCaching) {
   CheckTerm(cache, ASCIIToUTF16("rec"));
 }
 
+TEST_F(InMemoryURLIndexTest, PreviousCandidatesReuse) {
+  URLIndexPrivateData* private_data = GetPrivateData();
+  EXPECT_TRUE(private_data->previous_candidates_.empty());
+
+  // Simulate typing, with a few edits which do not extend the previous input.
+  // Each result must be the same as when computed from scratch.
+  const char* kInputs[] = {"r",         "re",        "rec",      "reco",
+                           "reco m",    "reco mo",   "reco mor", "reco mort",
+                           "rec mort",  "mort",      "mortg",    "w",
+                           "ww",        "www",       "www.",     "www.d",
+                           "www.drudg", "zzz",       "zzzz"};
+  for (const char* input : kInputs) {
+    SCOPED_TRACE(input);
+    ScoredHistoryMatches matches = url_index_->HistoryItemsForTerms(
+        ASCIIToUTF16(input), base::string16::npos, kProviderMaxMatches);
+    EXPECT_FALSE(private_data->previous_candidates_.empty());
+    URLIndexPrivateData::SearchCandidatesList candidates =
+        private_data->previous_candidates_;
+
+    private_data->previous_candidates_.clear();
+    private_data->search_term_cache_.clear();
+    ScoredHistoryMatches expected_matches = url_index_->HistoryItemsForTerms(
+        ASCIIToUTF16(input), base::string16::npos, kProviderMaxMatches);
+    EXPECT_EQ(candidates, private_data->previous_candidates_);
+    ASSERT_EQ(expected_matches.size(), matches.size());
+    for (size_t i = 0; i < matches.size(); ++i) {
+      EXPECT_EQ(expected_matches[i].url_info.id(), matches[i].url_info.id());
+      EXPECT_EQ(expected_matches[i].raw_score, matches[i].raw_score);
+    }
+  }
+
+  // Changing the index invalidates the candidates.
+  ScoredHistoryMatches matches = url_index_->HistoryItemsForTerms(
+      ASCIIToUTF16("DrudgeReport"), base::string16::npos, kProviderMaxMatches);
+  ASSERT_EQ(1U, matches.size());
+  EXPECT_FALSE(private_data->previous_candidates_.empty());
+  EXPECT_TRUE(DeleteURL(matches[0].url_info.url()));
+  EXPECT_TRUE(private_data->previous_candidates_.empty());
+  EXPECT_TRUE(url_index_
+                  ->HistoryItemsForTerms(ASCIIToUTF16("DrudgeReport"),
+                                         base::string16::npos,
+                                         kProviderMaxMatches)
+                  .empty());
+}
+
 TEST_F(InMemoryURLIndexTest, AddNewRows) {
   // Verify that the row we're going to add does not already exist.
   history::URLID new_row_id = 87654321;
@@ -1223,10 +1268,89 @@ TEST_F(InMemoryURLIndexTest, CacheSaveRestore) {
   EXPECT_GT(new_data.restored_cache_version_, 0);
   EXPECT_EQ(rebuild_time, new_data.last_time_rebuilt_from_history_);
 
+  // The word index is restored as a mapping of the flat file and only decoded
+  // into the maps on demand.
+  ASSERT_TRUE(new_data.flat_data_);
+  EXPECT_TRUE(new_data.word_list_.empty());
+  EXPECT_TRUE(new_data.word_id_history_map_.empty());
+  new_data.MaterializeFlatData();
+  EXPECT_FALSE(new_data.flat_data_);
+
   // Compare the captured and restored for equality.
   ExpectPrivateDataEqual(*old_data, new_data);
 }
 
+TEST_F(InMemoryURLIndexTest, CacheRestoreFlatDataQueries) {
+  base::ScopedTempDir temp_directory;
+  ASSERT_TRUE(temp_directory.CreateUniqueTempDir());
+  set_history_dir(temp_directory.GetPath());
+
+  const char* kTerms[] = {"drudge", "d", "reco", "mort rate", "ww", "cnn.com",
+                          "zzzzz"};
+  std::vector<ScoredHistoryMatches> expected_matches;
+  for (const char* term : kTerms) {
+    expected_matches.push_back(url_index_->HistoryItemsForTerms(
+        ASCIIToUTF16(term), base::string16::npos, kProviderMaxMatches));
+  }
+
+  {
+    base::RunLoop run_loop;
+    CacheFileSaverObserver save_observer(run_loop.QuitClosure());
+    url_index_->set_save_cache_observer(&save_observer);
+    PostSaveToCacheFileTask();
+    run_loop.Run();
+    EXPECT_TRUE(save_observer.succeeded());
+    url_index_->set_save_cache_observer(nullptr);
+  }
+  ClearPrivateData();
+  {
+    base::RunLoop run_loop;
+    HistoryIndexRestoreObserver restore_observer(run_loop.QuitClosure());
+    url_index_->set_restore_cache_observer(&restore_observer);
+    PostRestoreFromCacheFileTask();
+    run_loop.Run();
+    EXPECT_TRUE(restore_observer.succeeded());
+    url_index_->set_restore_cache_observer(nullptr);
+  }
+  ASSERT_TRUE(GetPrivateData()->flat_data_);
+
+  // Queries against the mapped index must match those against the maps.
+  for (size_t i = 0; i < base::size(kTerms); ++i) {
+    SCOPED_TRACE(kTerms[i]);
+    ScoredHistoryMatches matches = url_index_->HistoryItemsForTerms(
+        ASCIIToUTF16(kTerms[i]), base::string16::npos, kProviderMaxMatches);
+    ASSERT_EQ(expected_matches[i].size(), matches.size());
+    for (size_t j = 0; j < matches.size(); ++j) {
+      EXPECT_EQ(expected_matches[i][j].url_info.id(), matches[j].url_info.id());
+      EXPECT_EQ(expected_matches[i][j].raw_score, matches[j].raw_score);
+    }
+  }
+  EXPECT_TRUE(GetPrivateData()->flat_data_);
+
+  // Modifying the index decodes it first.
+  ScoredHistoryMatches matches = url_index_->HistoryItemsForTerms(
+      ASCIIToUTF16("DrudgeReport"), base::string16::npos, kProviderMaxMatches);
+  ASSERT_EQ(1U, matches.size());
+  EXPECT_TRUE(DeleteURL(matches[0].url_info.url()));
+  EXPECT_FALSE(GetPrivateData()->flat_data_);
+  EXPECT_FALSE(GetPrivateData()->word_list_.empty());
+  EXPECT_TRUE(url_index_
+                  ->HistoryItemsForTerms(ASCIIToUTF16("DrudgeReport"),
+                                         base::string16::npos,
+                                         kProviderMaxMatches)
+                  .empty());
+
+  // Deleting the cache also deletes the word index.
+  base::FilePath cache_path;
+  ASSERT_TRUE(GetCacheFilePath(&cache_path));
+  const base::FilePath flat_path =
+      URLIndexPrivateData::FlatDataFilePath(cache_path);
+  EXPECT_TRUE(base::PathExists(flat_path));
+  EXPECT_TRUE(URLIndexPrivateData::DeleteCacheFiles(cache_path));
+  EXPECT_FALSE(base::PathExists(cache_path));
+  EXPECT_FALSE(base::PathExists(flat_path));
+}
+
 TEST_F(InMemoryURLIndexTest, RebuildFromHistoryIfCacheOld) {
   base::ScopedTempDir temp_directory;
   ASSERT_TRUE(temp_directory.CreateUniqueTempDir());
@@ -0,0 +1,129 @@
+#!/usr/bin/env python
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this file,
+# You can obtain one at http://mozilla.org/MPL/2.0/.
+
+"""Generates the FixedSubstringIndex tables used by TopSitesProvider.
+
+Reads the site list (see topsites_provider_data.txt) and writes a C++ file
+defining:
+
+  kTopSitesChars     Every site followed by a NUL, in list order.
+  kTopSitesOffsets   The offset of each site in kTopSitesChars, followed by
+                     the total size of kTopSitesChars.
+  kTopSitesSuffixes  The offset in kTopSitesChars of every non-empty suffix
+                     of every site, sorted by the text of the suffix.
+
+A lookup for a substring then is a binary search for the range of suffixes
+that start with it, which is what FixedSubstringIndex does. The tables are
+plain constant arrays, so using them needs neither static initializers nor
+heap allocations.
+"""
+
+from __future__ import print_function
+
+import optparse
+import sys
+
+
+# The offsets are stored as uint16_t.
+MAX_CHARS = 0xffff
+
+
+def ReadSites(path):
+  sites = []
+  seen = set()
+  with open(path) as f:
+    for line_number, line in enumerate(f, 1):
+      site = line.strip()
+      if not site or site.startswith('#'):
+        continue
+      if any(c not in 'abcdefghijklmnopqrstuvwxyz0123456789.-' for c in site):
+        raise ValueError('%s:%d: unexpected character in "%s"' %
+                         (path, line_number, site))
+      if site in seen:
+        raise ValueError('%s:%d: duplicate site "%s"' %
+                         (path, line_number, site))
+      seen.add(site)
+      sites.append(site)
+  return sites
+
+
+def BuildTables(sites):
+  offsets = []
+  chars = 0
+  for site in sites:
+    offsets.append(chars)
+    chars += len(site) + 1
+  offsets.append(chars)
+  if chars > MAX_CHARS:
+    raise ValueError('Too many characters: %d' % chars)
+
+  suffixes = []
+  for site, offset in zip(sites, offsets):
+    for i in range(len(site)):
+      suffixes.append((site[i:], offset + i))
+  # Sorting by the suffix text matches the order of NUL-terminated strings
+  # compared as unsigned bytes, since the sites are ASCII.
+  suffixes.sort()
+  return offsets, [offset for _, offset in suffixes]
+
+
+def FormatArray(values, indent='    ', width=80):
+  lines = []
+  line = indent
+  for value in values:
+    item = '%d,' % value
+    if len(line) + len(item) + 1 > width:
+      lines.append(line.rstrip())
+      line = indent
+    line += item + ' '
+  if line.strip():
+    lines.append(line.rstrip())
+  return '\n'.join(lines)
+
+
+def Generate(sites, input_name):
+  offsets, suffixes = BuildTables(sites)
+  out = []
+  out.append('// This file is generated by make_topsites_index.py from')
+  out.append('// %s. Do not edit.' % input_name)
+  out.append('')
+  out.append('const char kTopSitesChars[] =')
+  for site in sites:
+    out.append('    "%s\\0"' % site)
+  out.append('    ;')
+  out.append('')
+  out.append('const uint16_t kTopSitesOffsets[] = {')
+  out.append(FormatArray(offsets))
+  out.append('};')
+  out.append('')
+  out.append('const uint16_t kTopSitesSuffixes[] = {')
+  out.append(FormatArray(suffixes))
+  out.append('};')
+  out.append('')
+  return '\n'.join(out)
+
+
+def main():
+  parser = optparse.OptionParser(usage='%prog --input FILE --output FILE')
+  parser.add_option('--input', help='The list of sites.')
+  parser.add_option('--output', help='The C++ file to write.')
+  opts, _ = parser.parse_args()
+  if not opts.input or not opts.output:
+    parser.error('--input and --output are required')
+
+  try:
+    sites = ReadSites(opts.input)
+    contents = Generate(sites, opts.input.replace('\\', '/').split('/')[-1])
+  except ValueError as e:
+    print(e, file=sys.stderr)
+    return 1
+
+  with open(opts.output, 'w') as f:
+    f.write(contents)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -419,6 +419,36 @@ TermMatches ScoredHistoryMatch::FilterTermMatchesByWordStarts(
   return filtered_matches;
 }
 
+// static
+int ScoredHistoryMatch::GetRawScoreUpperBound(const VisitInfoVector& visits,
+                                              size_t num_matching_pages,
+                                              base::Time now) {
+  Init();
+
+  // No term can score more than a maxed-out raw term score, so neither can
+  // their average.  Being bookmarked can only raise the value of a visit.
+  const float max_intermediate_score =
+      raw_term_score_to_topicality_score[kMaxRawTermScore - 1] *
+      GetFrequency(now, true, visits) *
+      GetDocumentSpecificityScore(num_matching_pages);
+
+  // The relevance buckets are not required to be increasing, so take the
+  // highest score reachable at or below |max_intermediate_score|.
+  float max_score = GetFinalRelevancyScore(max_intermediate_score, 1, 1);
+  for (const ScoreMaxRelevance& bucket : GetRelevanceBuckets()) {
+    if (bucket.first > max_intermediate_score)
+      break;
+    max_score = std::max(max_score, static_cast<float>(bucket.second));
+  }
+  int upper_bound = base::saturated_cast<int>(max_score);
+
+  if (also_do_hup_like_scoring_) {
+    upper_bound = std::max(upper_bound,
+                           HistoryURLProvider::kScoreForBestInlineableResult);
+  }
+  return upper_bound;
+}
+
 // static
 void ScoredHistoryMatch::Init() {
   static bool initialized = false;
@@ -583,7 +613,8 @@ float ScoredHistoryMatch::GetTopicalityScore(
   return final_topicality_score;
 }
 
-float ScoredHistoryMatch::GetRecencyScore(int last_visit_days_ago) const {
+// static
+float ScoredHistoryMatch::GetRecencyScore(int last_visit_days_ago) {
   // Lookup the score in days_ago_to_recency_score, treating
   // everything older than what we've precomputed as the oldest thing
   // we've precomputed.  The std::max is to protect against corruption
@@ -592,9 +623,10 @@ float ScoredHistoryMatch::GetRecencyScore(int last_visit_days_ago) const {
       std::min(last_visit_days_ago, kDaysToPrecomputeRecencyScoresFor - 1), 0)];
 }
 
+// static
 float ScoredHistoryMatch::GetFrequency(const base::Time& now,
                                        const bool bookmarked,
-                                       const VisitInfoVector& visits) const {
+                                       const VisitInfoVector& visits) {
   // Compute the weighted sum of |value_of_transition| over the last at most
   // |max_visits_to_score_| visits, where each visit is weighted using
   // GetRecencyScore() based on how many days ago it happened.
@@ -637,8 +669,9 @@ float ScoredHistoryMatch::GetFrequency(const base::Time& now,
   return summed_visit_points;
 }
 
+// static
 float ScoredHistoryMatch::GetDocumentSpecificityScore(
-    size_t num_matching_pages) const {
+    size_t num_matching_pages) {
   // A mapping from the number of matching pages to their associated document
   // specificity scores.  See omnibox_field_trial.h for more details.
   static base::NoDestructor<OmniboxFieldTrial::NumMatchesScores>
@@ -661,11 +694,7 @@ float ScoredHistoryMatch::GetFinalRelevancyScore(float topicality_score,
                                                  float specificity_score) {
   // |relevance_buckets| gives a mapping from intemerdiate score to the final
   // relevance score.
-  static base::NoDestructor<ScoreMaxRelevances> default_relevance_buckets(
-      GetHQPBuckets());
-  ScoreMaxRelevances* relevance_buckets = relevance_buckets_override_
-                                              ? relevance_buckets_override_
-                                              : default_relevance_buckets.get();
+  const ScoreMaxRelevances* relevance_buckets = &GetRelevanceBuckets();
   DCHECK(!relevance_buckets->empty());
   DCHECK_EQ(0.0, (*relevance_buckets)[0].first);
 
@@ -715,6 +744,15 @@ float ScoredHistoryMatch::GetFinalRelevancyScore(float topicality_score,
   return (*relevance_buckets)[i - 1].second;
 }
 
+// static
+const ScoredHistoryMatch::ScoreMaxRelevances&
+ScoredHistoryMatch::GetRelevanceBuckets() {
+  static base::NoDestructor<ScoreMaxRelevances> default_relevance_buckets(
+      GetHQPBuckets());
+  return relevance_buckets_override_ ? *relevance_buckets_override_
+                                     : *default_relevance_buckets;
+}
+
 // static
 std::vector<ScoredHistoryMatch::ScoreMaxRelevance>
 ScoredHistoryMatch::GetHQPBuckets() {
@@ -89,6 +89,15 @@ struct ScoredHistoryMatch : public history::HistoryMatch {
       size_t start_pos,
       size_t end_pos);
 
+  // Returns a value that is at least the |raw_score| a match constructed with
+  // the given |visits|, |num_matching_pages| and |now| would get, whatever its
+  // URL, title, terms and bookmark state. This only looks at the visits, so
+  // it is much cheaper than constructing the match; callers use it to skip
+  // rows that cannot make it into the top results.
+  static int GetRawScoreUpperBound(const VisitInfoVector& visits,
+                                   size_t num_matching_pages,
+                                   base::Time now);
+
   // An interim score taking into consideration location and completeness
   // of the match.
   int raw_score;
@@ -111,6 +120,7 @@ struct ScoredHistoryMatch : public history::HistoryMatch {
   FRIEND_TEST_ALL_PREFIXES(ScoredHistoryMatchTest, GetFinalRelevancyScore);
   FRIEND_TEST_ALL_PREFIXES(ScoredHistoryMatchTest, GetFrequency);
   FRIEND_TEST_ALL_PREFIXES(ScoredHistoryMatchTest, GetHQPBucketsFromString);
+  FRIEND_TEST_ALL_PREFIXES(ScoredHistoryMatchTest, GetRawScoreUpperBound);
   FRIEND_TEST_ALL_PREFIXES(ScoredHistoryMatchTest, ScoringBookmarks);
   FRIEND_TEST_ALL_PREFIXES(ScoredHistoryMatchTest, ScoringScheme);
   FRIEND_TEST_ALL_PREFIXES(ScoredHistoryMatchTest, ScoringTLD);
@@ -133,20 +143,20 @@ struct ScoredHistoryMatch : public history::HistoryMatch {
 
   // Returns a recency score based on |last_visit_days_ago|, which is
   // how many days ago the page was last visited.
-  float GetRecencyScore(int last_visit_days_ago) const;
+  static float GetRecencyScore(int last_visit_days_ago);
 
   // Examines the first |max_visits_to_score_| and returns a score (higher is
   // better) based the rate of visits, whether the page is bookmarked, and
   // how often those visits are typed navigations (i.e., explicitly
   // invoked by the user).  |now| is passed in to avoid unnecessarily
   // recomputing it frequently.
-  float GetFrequency(const base::Time& now,
-                     const bool bookmarked,
-                     const VisitInfoVector& visits) const;
+  static float GetFrequency(const base::Time& now,
+                            const bool bookmarked,
+                            const VisitInfoVector& visits);
 
   // Returns a document specificity score based on how many pages matched the
   // user's input.
-  float GetDocumentSpecificityScore(size_t num_matching_pages) const;
+  static float GetDocumentSpecificityScore(size_t num_matching_pages);
 
   // Combines the three component scores into a final score that's
   // an appropriate value to use as a relevancy score.
@@ -154,6 +164,10 @@ struct ScoredHistoryMatch : public history::HistoryMatch {
                                       float frequency_score,
                                       float specificity_score);
 
+  // Returns the buckets used by GetFinalRelevancyScore(): the test override if
+  // set, otherwise the default or experimental ones.
+  static const ScoreMaxRelevances& GetRelevanceBuckets();
+
   // Helper function that returns the string containing the scoring buckets
   // (either the default ones or ones specified in an experiment).
   static ScoreMaxRelevances GetHQPBuckets();
@@ -196,8 +210,8 @@ struct ScoredHistoryMatch : public history::HistoryMatch {
   static float topicality_threshold_;
 
   // Used for testing.  A possibly null pointer to a vector.  If set,
-  // overrides the static local variable |relevance_buckets| declared in
-  // GetFinalRelevancyScore().
+  // overrides the static local variable |default_relevance_buckets| declared
+  // in GetRelevanceBuckets().
   static ScoreMaxRelevances* relevance_buckets_override_;
 
   // Used for testing.  If this pointer is not null, it overrides the static
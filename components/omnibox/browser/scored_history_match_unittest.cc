@@ -624,6 +624,54 @@ TEST_F(ScoredHistoryMatchTest, GetDocumentSpecificityScore) {
   EXPECT_EQ(1.0, match.GetDocumentSpecificityScore(4));
 }
 
+TEST_F(ScoredHistoryMatchTest, GetRawScoreUpperBound) {
+  base::Time now = base::Time::NowFromSystemTime();
+  const char* const kURLs[] = {"http://abc.com/", "http://www.abcdef.com/abc",
+                               "http://def.com/abc?abc=abc#abc"};
+  const VisitInfoVector kVisits[] = {
+      VisitInfoVector(),
+      CreateVisitInfoVector(1, 1, now),
+      CreateVisitInfoVector(3, 30, now),
+      CreateVisitInfoVector(10, 1, now),
+      {{now, ui::PAGE_TRANSITION_TYPED}, {now, ui::PAGE_TRANSITION_TYPED}},
+  };
+  auto ExpectBoundHolds = [&]() {
+    for (const char* url : kURLs) {
+      history::URLRow row(MakeURLRow(url, "abc def", 3, 1, 1));
+      RowWordStarts word_starts;
+      PopulateWordStarts(row, &word_starts);
+      for (const VisitInfoVector& visits : kVisits) {
+        for (size_t num_matching_pages : {1, 2, 50}) {
+          const int upper_bound = ScoredHistoryMatch::GetRawScoreUpperBound(
+              visits, num_matching_pages, now);
+          for (bool is_bookmarked : {false, true}) {
+            ScoredHistoryMatch scored(row, visits, ASCIIToUTF16("abc"),
+                                      Make1Term("abc"), WordStarts{0},
+                                      word_starts, is_bookmarked,
+                                      num_matching_pages, now);
+            EXPECT_GT(scored.raw_score, 0) << url;
+            EXPECT_LE(scored.raw_score, upper_bound) << url;
+          }
+        }
+      }
+    }
+  };
+  ExpectBoundHolds();
+
+  // Fewer and older visits lower the bound.
+  EXPECT_LT(ScoredHistoryMatch::GetRawScoreUpperBound(kVisits[1], 50, now),
+            ScoredHistoryMatch::GetRawScoreUpperBound(kVisits[3], 50, now));
+
+  // The bound must also hold when the buckets are not increasing.
+  ScoredHistoryMatch::ScoreMaxRelevances relevance_buckets = {
+      {0.0, 900}, {1.0, 100}, {4.0, 1000}, {90.0, 1399}};
+  base::AutoReset<ScoredHistoryMatch::ScoreMaxRelevances*> tmp(
+      &ScoredHistoryMatch::relevance_buckets_override_, &relevance_buckets);
+  EXPECT_EQ(900,
+            ScoredHistoryMatch::GetRawScoreUpperBound(kVisits[0], 50, now));
+  ExpectBoundHolds();
+}
+
 // This function only tests scoring of single terms that match exactly
 // once somewhere in the URL or title.
 TEST_F(ScoredHistoryMatchTest, GetTopicalityScore) {
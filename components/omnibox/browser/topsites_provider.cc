@@ -8,9 +8,12 @@
 
 #include <algorithm>
 
+#include "base/bind.h"
+#include "base/logging.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "components/omnibox/browser/autocomplete_input.h"
+#include "components/omnibox/browser/fixed_substring_index.h"
 #include "components/omnibox/browser/history_provider.h"
 
 // As from autocomplete_provider.h:
@@ -24,34 +27,17 @@ TopSitesProvider::TopSitesProvider(AutocompleteProviderClient* client)
 
 void TopSitesProvider::Start(const AutocompleteInput& input,
                             bool minimal_changes) {
-  matches_.clear();
-  if (input.from_omnibox_focus() ||
-      (input.type() == metrics::OmniboxInputType::EMPTY) ||
-      (input.type() == metrics::OmniboxInputType::QUERY))
-    return;
-
-  const base::string16 input_text = input.text();
-
-  for (std::vector<base::string16>::const_iterator i = top_sites_.begin();
-    (i != top_sites_.end()) && (matches_.size() < provider_max_matches()); ++i) {
-
-    const base::string16 &current_site = *i;
-    size_t foundPos = current_site.find(input_text);
-    if (base::string16::npos != foundPos) {
-      ACMatchClassifications styles = StylesForSingleMatch(input_text, current_site, foundPos);
-      AddMatch(current_site, styles);
-    }
-  }
+  matches_ = MatchesForInput(input, provider_max_matches());
+  for (AutocompleteMatch& match : matches_)
+    match.provider = this;
+}
 
-  for (size_t i = 0; i < matches_.size(); ++i)
-    matches_[i].relevance = kRelevance + matches_.size() - (i + 1);
-  if ((matches_.size() == 1) && !matches_[0].inline_autocompletion.empty()) {
-    // If there's only one possible completion of the user's input and
-    // allowing completions is okay, give the match a high enough score to
-    // allow it to beat url-what-you-typed and be inlined.
-    matches_[0].relevance = 1250;
-    matches_[0].allowed_to_be_default_match = true;
-  }
+AutocompleteProvider::BackgroundMatcher TopSitesProvider::GetBackgroundMatcher(
+    const AutocompleteInput& input,
+    bool minimal_changes) {
+  // The index is constant, so matching only needs a copy of the input.
+  return base::BindOnce(&TopSitesProvider::MatchesForInput, input,
+                        provider_max_matches());
 }
 
 TopSitesProvider::~TopSitesProvider() {}
@@ -77,14 +63,53 @@ ACMatchClassifications TopSitesProvider::StylesForSingleMatch(
   return styles;
 }
 
-void TopSitesProvider::AddMatch(const base::string16& match_string,
-                               const ACMatchClassifications& styles) {
-  static const base::string16 kScheme = base::ASCIIToUTF16("https://");
-  AutocompleteMatch match(this, kRelevance, false,
+// static
+ACMatches TopSitesProvider::MatchesForInput(const AutocompleteInput& input,
+                                            size_t max_matches) {
+  ACMatches matches;
+  if (input.from_omnibox_focus() ||
+      (input.type() == metrics::OmniboxInputType::EMPTY) ||
+      (input.type() == metrics::OmniboxInputType::QUERY))
+    return matches;
+
+  const base::string16& input_text = input.text();
+  // The sites are ASCII, so they cannot contain anything else.
+  if (!base::IsStringASCII(input_text))
+    return matches;
+
+  const FixedSubstringIndex& top_sites = GetTopSitesIndex();
+  for (size_t site_index : top_sites.FindStringsContaining(
+           base::UTF16ToASCII(input_text), max_matches)) {
+    const base::string16 current_site =
+        base::ASCIIToUTF16(top_sites.GetString(site_index));
+    size_t foundPos = current_site.find(input_text);
+    DCHECK_NE(base::string16::npos, foundPos);
+    ACMatchClassifications styles = StylesForSingleMatch(input_text, current_site, foundPos);
+    matches.push_back(CreateMatch(current_site, styles));
+  }
+
+  for (size_t i = 0; i < matches.size(); ++i)
+    matches[i].relevance = kRelevance + matches.size() - (i + 1);
+  if ((matches.size() == 1) && !matches[0].inline_autocompletion.empty()) {
+    // If there's only one possible completion of the user's input and
+    // allowing completions is okay, give the match a high enough score to
+    // allow it to beat url-what-you-typed and be inlined.
+    matches[0].relevance = 1250;
+    matches[0].allowed_to_be_default_match = true;
+  }
+  return matches;
+}
+
+// static
+AutocompleteMatch TopSitesProvider::CreateMatch(
+    const base::string16& match_string,
+    const ACMatchClassifications& styles) {
+  const base::string16 kScheme = base::ASCIIToUTF16("https://");
+  AutocompleteMatch match(nullptr, kRelevance, false,
                           AutocompleteMatchType::NAVSUGGEST);
   match.fill_into_edit = match_string;
   match.destination_url = GURL(kScheme + match_string);
   match.contents = match_string;
   match.contents_class = styles;
-  matches_.push_back(match);
+  return match;
 }
@@ -5,8 +5,6 @@
 #ifndef COMPONENTS_OMNIBOX_BROWSER_TOPSITES_PROVIDER_H_
 #define COMPONENTS_OMNIBOX_BROWSER_TOPSITES_PROVIDER_H_
 
-#include <vector>
-
 #include "base/compiler_specific.h"
 #include "base/macros.h"
 #include "base/strings/string16.h"
@@ -14,6 +12,7 @@
 #include "components/omnibox/browser/autocomplete_provider.h"
 
 class AutocompleteProviderClient;
+class FixedSubstringIndex;
 
 // This is the provider for top Alexa 500 sites URLs
 class TopSitesProvider : public AutocompleteProvider {
@@ -22,16 +21,25 @@ class TopSitesProvider : public AutocompleteProvider {
 
   // AutocompleteProvider:
   void Start(const AutocompleteInput& input, bool minimal_changes) override;
+  BackgroundMatcher GetBackgroundMatcher(const AutocompleteInput& input,
+                                         bool minimal_changes) override;
+
+  // The built-in list of sites, most popular first. Generated at build time
+  // from topsites_provider_data.txt.
+  static const FixedSubstringIndex& GetTopSitesIndex();
 
  private:
   ~TopSitesProvider() override;
 
   static const int kRelevance;
 
-  static std::vector<base::string16> top_sites_;
+  // Returns the matches for |input|, with a null |provider|. Only reads the
+  // constant index, so it may run on any thread.
+  static ACMatches MatchesForInput(const AutocompleteInput& input,
+                                   size_t max_matches);
 
-  void AddMatch(const base::string16& match_string,
-                const ACMatchClassifications& styles);
+  static AutocompleteMatch CreateMatch(const base::string16& match_string,
+                                       const ACMatchClassifications& styles);
 
   static ACMatchClassifications StylesForSingleMatch(
       const base::string16 &input_text,
@@ -3,511 +3,27 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "components/omnibox/browser/topsites_provider.h"
-#include <stddef.h>
-#include "base/strings/utf_string_conversions.h"
 
+#include <stdint.h>
 
-std::vector<base::string16> TopSitesProvider::top_sites_ = {
-  base::ASCIIToUTF16("google.com"),
-  base::ASCIIToUTF16("gmail.com"),
-  base::ASCIIToUTF16("mail.google.com"),
-  base::ASCIIToUTF16("maps.google.com"),
-  base::ASCIIToUTF16("calendar.google.com"),
-  base::ASCIIToUTF16("facebook.com"),
-  base::ASCIIToUTF16("youtube.com"),
-  base::ASCIIToUTF16("yahoo.com"),
-  base::ASCIIToUTF16("baidu.com"),
-  base::ASCIIToUTF16("wikipedia.org"),
-  base::ASCIIToUTF16("qq.com"),
-  base::ASCIIToUTF16("taobao.com"),
-  base::ASCIIToUTF16("twitter.com"),
-  base::ASCIIToUTF16("live.com"),
-  base::ASCIIToUTF16("linkedin.com"),
-  base::ASCIIToUTF16("sina.com.cn"),
-  base::ASCIIToUTF16("amazon.com"),
-  base::ASCIIToUTF16("amazon.ca"),
-  base::ASCIIToUTF16("hao123.com"),
-  base::ASCIIToUTF16("google.co.in"),
-  base::ASCIIToUTF16("blogspot.com"),
-  base::ASCIIToUTF16("weibo.com"),
-  base::ASCIIToUTF16("wordpress.com"),
-  base::ASCIIToUTF16("360.cn"),
-  base::ASCIIToUTF16("yandex.ru"),
-  base::ASCIIToUTF16("yahoo.co.jp"),
-  base::ASCIIToUTF16("bing.com"),
-  base::ASCIIToUTF16("tmall.com"),
-  base::ASCIIToUTF16("vk.com"),
-  base::ASCIIToUTF16("ebay.com"),
-  base::ASCIIToUTF16("sohu.com"),
-  base::ASCIIToUTF16("google.de"),
-  base::ASCIIToUTF16("pinterest.com"),
-  base::ASCIIToUTF16("163.com"),
-  base::ASCIIToUTF16("ask.com"),
-  base::ASCIIToUTF16("google.co.uk"),
-  base::ASCIIToUTF16("soso.com"),
-  base::ASCIIToUTF16("google.fr"),
-  base::ASCIIToUTF16("msn.com"),
-  base::ASCIIToUTF16("tumblr.com"),
-  base::ASCIIToUTF16("google.co.jp"),
-  base::ASCIIToUTF16("mail.ru"),
-  base::ASCIIToUTF16("instagram.com"),
-  base::ASCIIToUTF16("microsoft.com"),
-  base::ASCIIToUTF16("google.com.br"),
-  base::ASCIIToUTF16("google.ru"),
-  base::ASCIIToUTF16("paypal.com"),
-  base::ASCIIToUTF16("imdb.com"),
-  base::ASCIIToUTF16("google.es"),
-  base::ASCIIToUTF16("apple.com"),
-  base::ASCIIToUTF16("google.it"),
-  base::ASCIIToUTF16("xinhuanet.com"),
-  base::ASCIIToUTF16("amazon.co.jp"),
-  base::ASCIIToUTF16("craigslist.org"),
-  base::ASCIIToUTF16("neobux.com"),
-  base::ASCIIToUTF16("imgur.com"),
-  base::ASCIIToUTF16("stackoverflow.com"),
-  base::ASCIIToUTF16("ifeng.com"),
-  base::ASCIIToUTF16("google.com.mx"),
-  base::ASCIIToUTF16("bbc.co.uk"),
-  base::ASCIIToUTF16("google.com.hk"),
-  base::ASCIIToUTF16("adcash.com"),
-  base::ASCIIToUTF16("blogger.com"),
-  base::ASCIIToUTF16("news.ycombinator.com"),
-  base::ASCIIToUTF16("reddit.com"),
-  base::ASCIIToUTF16("slashdot.org"),
-  base::ASCIIToUTF16("digg.com"),
-  base::ASCIIToUTF16("duckduckgo.com"),
-  base::ASCIIToUTF16("startpage.com"),
-  base::ASCIIToUTF16("wolframalpha.com"),
-  base::ASCIIToUTF16("infogalactic.com"),
-  base::ASCIIToUTF16("qwant.com"),
-  base::ASCIIToUTF16("searx.me"),
-  base::ASCIIToUTF16("ecosia.org"),
-  base::ASCIIToUTF16("semanticscholar.org"),
-  base::ASCIIToUTF16("fc2.com"),
-  base::ASCIIToUTF16("cnn.com"),
-  base::ASCIIToUTF16("google.ca"),
-  base::ASCIIToUTF16("t.co"),
-  base::ASCIIToUTF16("akamaihd.net"),
-  base::ASCIIToUTF16("vube.com"),
-  base::ASCIIToUTF16("go.com"),
-  base::ASCIIToUTF16("people.com.cn"),
-  base::ASCIIToUTF16("wordpress.org"),
-  base::ASCIIToUTF16("about.com"),
-  base::ASCIIToUTF16("adobe.com"),
-  base::ASCIIToUTF16("alipay.com"),
-  base::ASCIIToUTF16("odnoklassniki.ru"),
-  base::ASCIIToUTF16("conduit.com"),
-  base::ASCIIToUTF16("youku.com"),
-  base::ASCIIToUTF16("googleusercontent.com"),
-  base::ASCIIToUTF16("gmw.cn"),
-  base::ASCIIToUTF16("google.com.tr"),
-  base::ASCIIToUTF16("flickr.com"),
-  base::ASCIIToUTF16("alibaba.com"),
-  base::ASCIIToUTF16("aliexpress.com"),
-  base::ASCIIToUTF16("godaddy.com"),
-  base::ASCIIToUTF16("huffingtonpost.com"),
-  base::ASCIIToUTF16("amazon.de"),
-  base::ASCIIToUTF16("google.com.au"),
-  base::ASCIIToUTF16("blogspot.in"),
-  base::ASCIIToUTF16("ebay.de"),
-  base::ASCIIToUTF16("netflix.com"),
-  base::ASCIIToUTF16("khanacademy.org"),
-  base::ASCIIToUTF16("kickass.to"),
-  base::ASCIIToUTF16("google.pl"),
-  base::ASCIIToUTF16("ku6.com"),
-  base::ASCIIToUTF16("bp.blogspot.com"),
-  base::ASCIIToUTF16("thepiratebay.se"),
-  base::ASCIIToUTF16("dailymotion.com"),
-  base::ASCIIToUTF16("weather.com"),
-  base::ASCIIToUTF16("vimeo.com"),
-  base::ASCIIToUTF16("dailymail.co.uk"),
-  base::ASCIIToUTF16("cnet.com"),
-  base::ASCIIToUTF16("espn.go.com"),
-  base::ASCIIToUTF16("ebay.co.uk"),
-  base::ASCIIToUTF16("rakuten.co.jp"),
-  base::ASCIIToUTF16("indiatimes.com"),
-  base::ASCIIToUTF16("themeforest.net"),
-  base::ASCIIToUTF16("aol.com"),
-  base::ASCIIToUTF16("amazonaws.com"),
-  base::ASCIIToUTF16("uol.com.br"),
-  base::ASCIIToUTF16("amazon.co.uk"),
-  base::ASCIIToUTF16("google.com.sa"),
-  base::ASCIIToUTF16("dropbox.com"),
-  base::ASCIIToUTF16("google.com.ar"),
-  base::ASCIIToUTF16("nytimes.com"),
-  base::ASCIIToUTF16("slideshare.net"),
-  base::ASCIIToUTF16("google.com.eg"),
-  base::ASCIIToUTF16("pixnet.net"),
-  base::ASCIIToUTF16("globo.com"),
-  base::ASCIIToUTF16("adf.ly"),
-  base::ASCIIToUTF16("china.com"),
-  base::ASCIIToUTF16("secureserver.net"),
-  base::ASCIIToUTF16("m2newmedia.com"),
-  base::ASCIIToUTF16("directrev.com"),
-  base::ASCIIToUTF16("buzzfeed.com"),
-  base::ASCIIToUTF16("mozilla.org"),
-  base::ASCIIToUTF16("wikimedia.org"),
-  base::ASCIIToUTF16("fiverr.com"),
-  base::ASCIIToUTF16("google.com.pk"),
-  base::ASCIIToUTF16("ameblo.jp"),
-  base::ASCIIToUTF16("booking.com"),
-  base::ASCIIToUTF16("google.nl"),
-  base::ASCIIToUTF16("livejournal.com"),
-  base::ASCIIToUTF16("deviantart.com"),
-  base::ASCIIToUTF16("yelp.com"),
-  base::ASCIIToUTF16("sogou.com"),
-  base::ASCIIToUTF16("google.com.tw"),
-  base::ASCIIToUTF16("flipkart.com"),
-  base::ASCIIToUTF16("wikia.com"),
-  base::ASCIIToUTF16("hootsuite.com"),
-  base::ASCIIToUTF16("blogfa.com"),
-  base::ASCIIToUTF16("developunit.info"),
-  base::ASCIIToUTF16("etsy.com"),
-  base::ASCIIToUTF16("outbrain.com"),
-  base::ASCIIToUTF16("wikihow.com"),
-  base::ASCIIToUTF16("avg.com"),
-  base::ASCIIToUTF16("google.co.th"),
-  base::ASCIIToUTF16("clkmon.com"),
-  base::ASCIIToUTF16("google.co.za"),
-  base::ASCIIToUTF16("stumbleupon.com"),
-  base::ASCIIToUTF16("soundcloud.com"),
-  base::ASCIIToUTF16("livedoor.com"),
-  base::ASCIIToUTF16("4shared.com"),
-  base::ASCIIToUTF16("w3schools.com"),
-  base::ASCIIToUTF16("badoo.com"),
-  base::ASCIIToUTF16("sourceforge.net"),
-  base::ASCIIToUTF16("files.wordpress.com"),
-  base::ASCIIToUTF16("archive.org"),
-  base::ASCIIToUTF16("mediafire.com"),
-  base::ASCIIToUTF16("google.co.ve"),
-  base::ASCIIToUTF16("theguardian.com"),
-  base::ASCIIToUTF16("liveinternet.ru"),
-  base::ASCIIToUTF16("bankofamerica.com"),
-  base::ASCIIToUTF16("addthis.com"),
-  base::ASCIIToUTF16("aweber.com"),
-  base::ASCIIToUTF16("forbes.com"),
-  base::ASCIIToUTF16("foxnews.com"),
-  base::ASCIIToUTF16("ask.fm"),
-  base::ASCIIToUTF16("answers.com"),
-  base::ASCIIToUTF16("indeed.com"),
-  base::ASCIIToUTF16("chase.com"),
-  base::ASCIIToUTF16("bet365.com"),
-  base::ASCIIToUTF16("salesforce.com"),
-  base::ASCIIToUTF16("gameforge.com"),
-  base::ASCIIToUTF16("china.com.cn"),
-  base::ASCIIToUTF16("hostgator.com"),
-  base::ASCIIToUTF16("naver.com"),
-  base::ASCIIToUTF16("espncricinfo.com"),
-  base::ASCIIToUTF16("skype.com"),
-  base::ASCIIToUTF16("google.gr"),
-  base::ASCIIToUTF16("github.com"),
-  base::ASCIIToUTF16("softonic.com"),
-  base::ASCIIToUTF16("statcounter.com"),
-  base::ASCIIToUTF16("google.com.co"),
-  base::ASCIIToUTF16("google.co.id"),
-  base::ASCIIToUTF16("reference.com"),
-  base::ASCIIToUTF16("onet.pl"),
-  base::ASCIIToUTF16("spiegel.de"),
-  base::ASCIIToUTF16("nicovideo.jp"),
-  base::ASCIIToUTF16("shutterstock.com"),
-  base::ASCIIToUTF16("google.be"),
-  base::ASCIIToUTF16("allegro.pl"),
-  base::ASCIIToUTF16("walmart.com"),
-  base::ASCIIToUTF16("google.com.ua"),
-  base::ASCIIToUTF16("google.com.vn"),
-  base::ASCIIToUTF16("google.com.ng"),
-  base::ASCIIToUTF16("mailchimp.com"),
-  base::ASCIIToUTF16("stackexchange.com"),
-  base::ASCIIToUTF16("sharelive.net"),
-  base::ASCIIToUTF16("so.com"),
-  base::ASCIIToUTF16("gamer.com.tw"),
-  base::ASCIIToUTF16("tripadvisor.com"),
-  base::ASCIIToUTF16("zillow.com"),
-  base::ASCIIToUTF16("wsj.com"),
-  base::ASCIIToUTF16("wix.com"),
-  base::ASCIIToUTF16("popads.net"),
-  base::ASCIIToUTF16("loading-delivery1.com"),
-  base::ASCIIToUTF16("google.ro"),
-  base::ASCIIToUTF16("wellsfargo.com"),
-  base::ASCIIToUTF16("wordreference.com"),
-  base::ASCIIToUTF16("goo.ne.jp"),
-  base::ASCIIToUTF16("bild.de"),
-  base::ASCIIToUTF16("photobucket.com"),
-  base::ASCIIToUTF16("pandora.com"),
-  base::ASCIIToUTF16("google.se"),
-  base::ASCIIToUTF16("bleacherreport.com"),
-  base::ASCIIToUTF16("pcpop.com"),
-  base::ASCIIToUTF16("media.tumblr.com"),
-  base::ASCIIToUTF16("naver.jp"),
-  base::ASCIIToUTF16("warriorforum.com"),
-  base::ASCIIToUTF16("babylon.com"),
-  base::ASCIIToUTF16("zedo.com"),
-  base::ASCIIToUTF16("weebly.com"),
-  base::ASCIIToUTF16("google.dz"),
-  base::ASCIIToUTF16("taringa.net"),
-  base::ASCIIToUTF16("blogspot.com.es"),
-  base::ASCIIToUTF16("google.at"),
-  base::ASCIIToUTF16("rutracker.org"),
-  base::ASCIIToUTF16("php.net"),
-  base::ASCIIToUTF16("google.com.ph"),
-  base::ASCIIToUTF16("ups.com"),
-  base::ASCIIToUTF16("39.net"),
-  base::ASCIIToUTF16("leboncoin.fr"),
-  base::ASCIIToUTF16("mashable.com"),
-  base::ASCIIToUTF16("businessinsider.com"),
-  base::ASCIIToUTF16("goodreads.com"),
-  base::ASCIIToUTF16("quikr.com"),
-  base::ASCIIToUTF16("usatoday.com"),
-  base::ASCIIToUTF16("dmm.co.jp"),
-  base::ASCIIToUTF16("ucoz.ru"),
-  base::ASCIIToUTF16("gmx.net"),
-  base::ASCIIToUTF16("rambler.ru"),
-  base::ASCIIToUTF16("rediff.com"),
-  base::ASCIIToUTF16("domaintools.com"),
-  base::ASCIIToUTF16("telegraph.co.uk"),
-  base::ASCIIToUTF16("google.com.pe"),
-  base::ASCIIToUTF16("comcast.net"),
-  base::ASCIIToUTF16("intuit.com"),
-  base::ASCIIToUTF16("kaskus.co.id"),
-  base::ASCIIToUTF16("tianya.cn"),
-  base::ASCIIToUTF16("avito.ru"),
-  base::ASCIIToUTF16("ettoday.net"),
-  base::ASCIIToUTF16("thefreedictionary.com"),
-  base::ASCIIToUTF16("wp.pl"),
-  base::ASCIIToUTF16("ikea.com"),
-  base::ASCIIToUTF16("google.ch"),
-  base::ASCIIToUTF16("amazon.fr"),
-  base::ASCIIToUTF16("lpcloudsvr302.com"),
-  base::ASCIIToUTF16("goal.com"),
-  base::ASCIIToUTF16("hurriyet.com.tr"),
-  base::ASCIIToUTF16("uploaded.net"),
-  base::ASCIIToUTF16("ndtv.com"),
-  base::ASCIIToUTF16("baomihua.com"),
-  base::ASCIIToUTF16("usps.com"),
-  base::ASCIIToUTF16("xcar.com.cn"),
-  base::ASCIIToUTF16("coccoc.com"),
-  base::ASCIIToUTF16("moz.com"),
-  base::ASCIIToUTF16("google.cl"),
-  base::ASCIIToUTF16("google.pt"),
-  base::ASCIIToUTF16("iqiyi.com"),
-  base::ASCIIToUTF16("pchome.net"),
-  base::ASCIIToUTF16("codecanyon.net"),
-  base::ASCIIToUTF16("adrotator.se"),
-  base::ASCIIToUTF16("goodgamestudios.com"),
-  base::ASCIIToUTF16("twitch.tv"),
-  base::ASCIIToUTF16("google.com.bd"),
-  base::ASCIIToUTF16("ci123.com"),
-  base::ASCIIToUTF16("google.com.sg"),
-  base::ASCIIToUTF16("huanqiu.com"),
-  base::ASCIIToUTF16("fedex.com"),
-  base::ASCIIToUTF16("nbcnews.com"),
-  base::ASCIIToUTF16("web.de"),
-  base::ASCIIToUTF16("onclickads.net"),
-  base::ASCIIToUTF16("it168.com"),
-  base::ASCIIToUTF16("bitly.com"),
-  base::ASCIIToUTF16("google.ae"),
-  base::ASCIIToUTF16("washingtonpost.com"),
-  base::ASCIIToUTF16("ehow.com"),
-  base::ASCIIToUTF16("milliyet.com.tr"),
-  base::ASCIIToUTF16("google.co.kr"),
-  base::ASCIIToUTF16("suning.com"),
-  base::ASCIIToUTF16("enet.com.cn"),
-  base::ASCIIToUTF16("9gag.com"),
-  base::ASCIIToUTF16("delta-search.com"),
-  base::ASCIIToUTF16("hp.com"),
-  base::ASCIIToUTF16("disqus.com"),
-  base::ASCIIToUTF16("samsung.com"),
-  base::ASCIIToUTF16("sochi2014.com"),
-  base::ASCIIToUTF16("bitauto.com"),
-  base::ASCIIToUTF16("xuite.net"),
-  base::ASCIIToUTF16("daum.net"),
-  base::ASCIIToUTF16("meetup.com"),
-  base::ASCIIToUTF16("varzesh3.com"),
-  base::ASCIIToUTF16("olx.in"),
-  base::ASCIIToUTF16("myntra.com"),
-  base::ASCIIToUTF16("snapdeal.com"),
-  base::ASCIIToUTF16("scribd.com"),
-  base::ASCIIToUTF16("extratorrent.cc"),
-  base::ASCIIToUTF16("infusionsoft.com"),
-  base::ASCIIToUTF16("4dsply.com"),
-  base::ASCIIToUTF16("mercadolivre.com.br"),
-  base::ASCIIToUTF16("tmz.com"),
-  base::ASCIIToUTF16("orange.fr"),
-  base::ASCIIToUTF16("google.cz"),
-  base::ASCIIToUTF16("reuters.com"),
-  base::ASCIIToUTF16("constantcontact.com"),
-  base::ASCIIToUTF16("chinaz.com"),
-  base::ASCIIToUTF16("nih.gov"),
-  base::ASCIIToUTF16("eazel.com"),
-  base::ASCIIToUTF16("accuweather.com"),
-  base::ASCIIToUTF16("java.com"),
-  base::ASCIIToUTF16("hulu.com"),
-  base::ASCIIToUTF16("bloomberg.com"),
-  base::ASCIIToUTF16("free.fr"),
-  base::ASCIIToUTF16("xywy.com"),
-  base::ASCIIToUTF16("detik.com"),
-  base::ASCIIToUTF16("libero.it"),
-  base::ASCIIToUTF16("speedtest.net"),
-  base::ASCIIToUTF16("mobile01.com"),
-  base::ASCIIToUTF16("clickbank.com"),
-  base::ASCIIToUTF16("microsoftonline.com"),
-  base::ASCIIToUTF16("yandex.com"),
-  base::ASCIIToUTF16("yandex.ua"),
-  base::ASCIIToUTF16("gsmarena.com"),
-  base::ASCIIToUTF16("bluehost.com"),
-  base::ASCIIToUTF16("bbc.com"),
-  base::ASCIIToUTF16("time.com"),
-  base::ASCIIToUTF16("webmd.com"),
-  base::ASCIIToUTF16("marca.com"),
-  base::ASCIIToUTF16("hudong.com"),
-  base::ASCIIToUTF16("kooora.com"),
-  base::ASCIIToUTF16("histats.com"),
-  base::ASCIIToUTF16("caijing.com.cn"),
-  base::ASCIIToUTF16("xing.com"),
-  base::ASCIIToUTF16("americanexpress.com"),
-  base::ASCIIToUTF16("kwejk.pl"),
-  base::ASCIIToUTF16("ad6media.fr"),
-  base::ASCIIToUTF16("cj.com"),
-  base::ASCIIToUTF16("in.com"),
-  base::ASCIIToUTF16("bestbuy.com"),
-  base::ASCIIToUTF16("zippyshare.com"),
-  base::ASCIIToUTF16("mywebsearch.com"),
-  base::ASCIIToUTF16("google.co.hu"),
-  base::ASCIIToUTF16("nba.com"),
-  base::ASCIIToUTF16("adnxs.com"),
-  base::ASCIIToUTF16("elpais.com"),
-  base::ASCIIToUTF16("amazon.cn"),
-  base::ASCIIToUTF16("intoday.in"),
-  base::ASCIIToUTF16("tinyurl.com"),
-  base::ASCIIToUTF16("google.no"),
-  base::ASCIIToUTF16("ign.com"),
-  base::ASCIIToUTF16("cloudfront.net"),
-  base::ASCIIToUTF16("hdfcbank.com"),
-  base::ASCIIToUTF16("ebay.in"),
-  base::ASCIIToUTF16("snapdo.com"),
-  base::ASCIIToUTF16("lenta.ru"),
-  base::ASCIIToUTF16("techcrunch.com"),
-  base::ASCIIToUTF16("google.ie"),
-  base::ASCIIToUTF16("getresponse.com"),
-  base::ASCIIToUTF16("force.com"),
-  base::ASCIIToUTF16("irs.gov"),
-  base::ASCIIToUTF16("tagged.com"),
-  base::ASCIIToUTF16("zendesk.com"),
-  base::ASCIIToUTF16("pof.com"),
-  base::ASCIIToUTF16("rt.com"),
-  base::ASCIIToUTF16("cnzz.com"),
-  base::ASCIIToUTF16("repubblica.it"),
-  base::ASCIIToUTF16("google.az"),
-  base::ASCIIToUTF16("douban.com"),
-  base::ASCIIToUTF16("plugrush.com"),
-  base::ASCIIToUTF16("groupon.com"),
-  base::ASCIIToUTF16("siteadvisor.com"),
-  base::ASCIIToUTF16("google.cn"),
-  base::ASCIIToUTF16("seznam.cz"),
-  base::ASCIIToUTF16("ero-advertising.com"),
-  base::ASCIIToUTF16("kakaku.com"),
-  base::ASCIIToUTF16("w3.org"),
-  base::ASCIIToUTF16("elmundo.es"),
-  base::ASCIIToUTF16("xe.com"),
-  base::ASCIIToUTF16("feedly.com"),
-  base::ASCIIToUTF16("list-manage.com"),
-  base::ASCIIToUTF16("t-online.de"),
-  base::ASCIIToUTF16("dell.com"),
-  base::ASCIIToUTF16("nydailynews.com"),
-  base::ASCIIToUTF16("amazon.in"),
-  base::ASCIIToUTF16("cntv.cn"),
-  base::ASCIIToUTF16("ameba.jp"),
-  base::ASCIIToUTF16("jrj.com.cn"),
-  base::ASCIIToUTF16("surveymonkey.com"),
-  base::ASCIIToUTF16("target.com"),
-  base::ASCIIToUTF16("yaolan.com"),
-  base::ASCIIToUTF16("ebay.com.au"),
-  base::ASCIIToUTF16("odesk.com"),
-  base::ASCIIToUTF16("uimserv.net"),
-  base::ASCIIToUTF16("okcupid.com"),
-  base::ASCIIToUTF16("ce.cn"),
-  base::ASCIIToUTF16("rbc.ru"),
-  base::ASCIIToUTF16("doorblog.jp"),
-  base::ASCIIToUTF16("joomla.org"),
-  base::ASCIIToUTF16("doubleclick.com"),
-  base::ASCIIToUTF16("upworthy.com"),
-  base::ASCIIToUTF16("habrahabr.ru"),
-  base::ASCIIToUTF16("zimbio.com"),
-  base::ASCIIToUTF16("life.com.tw"),
-  base::ASCIIToUTF16("naukri.com"),
-  base::ASCIIToUTF16("istockphoto.com"),
-  base::ASCIIToUTF16("aili.com"),
-  base::ASCIIToUTF16("zing.vn"),
-  base::ASCIIToUTF16("ebay.it"),
-  base::ASCIIToUTF16("jimdo.com"),
-  base::ASCIIToUTF16("fbcdn.net"),
-  base::ASCIIToUTF16("blogspot.de"),
-  base::ASCIIToUTF16("google.co.il"),
-  base::ASCIIToUTF16("mama.cn"),
-  base::ASCIIToUTF16("google.dk"),
-  base::ASCIIToUTF16("blackhatworld.com"),
-  base::ASCIIToUTF16("webmoney.ru"),
-  base::ASCIIToUTF16("lenovo.com"),
-  base::ASCIIToUTF16("flipora.com"),
-  base::ASCIIToUTF16("freelancer.com"),
-  base::ASCIIToUTF16("latimes.com"),
-  base::ASCIIToUTF16("gazeta.pl"),
-  base::ASCIIToUTF16("justdial.com"),
-  base::ASCIIToUTF16("eyny.com"),
-  base::ASCIIToUTF16("match.com"),
-  base::ASCIIToUTF16("pcbaby.com.cn"),
-  base::ASCIIToUTF16("retailmenot.com"),
-  base::ASCIIToUTF16("4399.com"),
-  base::ASCIIToUTF16("drudgereport.com"),
-  base::ASCIIToUTF16("quora.com"),
-  base::ASCIIToUTF16("abcnews.go.com"),
-  base::ASCIIToUTF16("informer.com"),
-  base::ASCIIToUTF16("att.com"),
-  base::ASCIIToUTF16("mysearchdial.com"),
-  base::ASCIIToUTF16("sahibinden.com"),
-  base::ASCIIToUTF16("google.fi"),
-  base::ASCIIToUTF16("capitalone.com"),
-  base::ASCIIToUTF16("elance.com"),
-  base::ASCIIToUTF16("icicibank.com"),
-  base::ASCIIToUTF16("ck101.com"),
-  base::ASCIIToUTF16("teensdigest.com"),
-  base::ASCIIToUTF16("goo.gl"),
-  base::ASCIIToUTF16("probux.com"),
-  base::ASCIIToUTF16("issuu.com"),
-  base::ASCIIToUTF16("ig.com.br"),
-  base::ASCIIToUTF16("twoo.com"),
-  base::ASCIIToUTF16("qtrax.com"),
-  base::ASCIIToUTF16("pch.com"),
-  base::ASCIIToUTF16("blogspot.ru"),
-  base::ASCIIToUTF16("lifehacker.com"),
-  base::ASCIIToUTF16("subscene.com"),
-  base::ASCIIToUTF16("jabong.com"),
-  base::ASCIIToUTF16("blogspot.it"),
-  base::ASCIIToUTF16("jd.com"),
-  base::ASCIIToUTF16("hypergames.net"),
-  base::ASCIIToUTF16("xda-developers.com"),
-  base::ASCIIToUTF16("livescore.com"),
-  base::ASCIIToUTF16("empowernetwork.com"),
-  base::ASCIIToUTF16("iminent.com"),
-  base::ASCIIToUTF16("xgo.com.cn"),
-  base::ASCIIToUTF16("irctc.co.in"),
-  base::ASCIIToUTF16("sberbank.ru"),
-  base::ASCIIToUTF16("foxsports.com"),
-  base::ASCIIToUTF16("kinopoisk.ru"),
-  base::ASCIIToUTF16("exoclick.com"),
-  base::ASCIIToUTF16("rednet.cn"),
-  base::ASCIIToUTF16("pcgames.com.cn"),
-  base::ASCIIToUTF16("ning.com"),
-  base::ASCIIToUTF16("lady8844.com"),
-  base::ASCIIToUTF16("wideinfo.org"),
-  base::ASCIIToUTF16("webcrawler.com"),
-  base::ASCIIToUTF16("yesky.com"),
-  base::ASCIIToUTF16("trulia.com"),
-  base::ASCIIToUTF16("zeobit.com"),
-  base::ASCIIToUTF16("searchfun.in"),
-  base::ASCIIToUTF16("babytree.com"),
-  base::ASCIIToUTF16("youm7.com"),
-  base::ASCIIToUTF16("123rf.com"),
-  base::ASCIIToUTF16("commentcamarche.net"),
-  base::ASCIIToUTF16("brave.com")
-};
+#include "base/stl_util.h"
+#include "components/omnibox/browser/fixed_substring_index.h"
+
+namespace {
+
+// Defines kTopSitesChars, kTopSitesOffsets and kTopSitesSuffixes, generated
+// from topsites_provider_data.txt.
+#include "components/omnibox/browser/topsites_provider_data-inc.cc"
+
+constexpr FixedSubstringIndex kTopSitesIndex(kTopSitesChars,
+                                             kTopSitesOffsets,
+                                             base::size(kTopSitesOffsets) - 1,
+                                             kTopSitesSuffixes,
+                                             base::size(kTopSitesSuffixes));
+
+}  // namespace
+
+// static
+const FixedSubstringIndex& TopSitesProvider::GetTopSitesIndex() {
+  return kTopSitesIndex;
+}
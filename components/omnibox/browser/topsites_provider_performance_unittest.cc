@@ -0,0 +1,93 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "components/omnibox/browser/topsites_provider.h"
+
+#include <stddef.h>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "base/strings/string16.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/timer/elapsed_timer.h"
+#include "components/omnibox/browser/fixed_substring_index.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace {
+
+// What a user could type, one keystroke at a time.
+const char* const kInputs[] = {"google.com", "wikipedia", "brave.com",
+                               "amazon.co.jp", "zzz", "o"};
+
+constexpr size_t kMaxMatches = 3;
+
+#if defined(NDEBUG)
+constexpr size_t kIterations = 10000;
+#else
+constexpr size_t kIterations = 100;
+#endif
+
+std::vector<std::string> AllPrefixes(const std::vector<std::string>& inputs) {
+  std::vector<std::string> prefixes;
+  for (const std::string& input : inputs) {
+    for (size_t length = 1; length <= input.size(); ++length)
+      prefixes.push_back(input.substr(0, length));
+  }
+  return prefixes;
+}
+
+}  // namespace
+
+// Compares looking up every keystroke of a few inputs in the generated index
+// with scanning the list as TopSitesProvider used to.
+TEST(TopSitesProviderPerfTest, FindStringsContaining) {
+  const FixedSubstringIndex& index = TopSitesProvider::GetTopSitesIndex();
+  const std::vector<std::string> prefixes =
+      AllPrefixes(std::vector<std::string>(std::begin(kInputs),
+                                           std::end(kInputs)));
+
+  // The list as it used to be kept.
+  std::vector<base::string16> top_sites;
+  for (size_t i = 0; i < index.string_count(); ++i)
+    top_sites.push_back(base::ASCIIToUTF16(index.GetString(i)));
+  std::vector<base::string16> prefixes16;
+  for (const std::string& prefix : prefixes)
+    prefixes16.push_back(base::ASCIIToUTF16(prefix));
+
+  size_t linear_matches = 0;
+  base::ElapsedTimer linear_timer;
+  for (size_t i = 0; i < kIterations; ++i) {
+    for (const base::string16& prefix : prefixes16) {
+      size_t matches = 0;
+      for (auto site = top_sites.begin();
+           site != top_sites.end() && matches < kMaxMatches; ++site) {
+        if (site->find(prefix) != base::string16::npos)
+          ++matches;
+      }
+      linear_matches += matches;
+    }
+  }
+  const base::TimeDelta linear_time = linear_timer.Elapsed();
+
+  size_t index_matches = 0;
+  base::ElapsedTimer index_timer;
+  for (size_t i = 0; i < kIterations; ++i) {
+    for (const std::string& prefix : prefixes)
+      index_matches += index.FindStringsContaining(prefix, kMaxMatches).size();
+  }
+  const base::TimeDelta index_time = index_timer.Elapsed();
+
+  EXPECT_EQ(linear_matches, index_matches);
+
+  const double lookups = static_cast<double>(kIterations * prefixes.size());
+  perf_test::PrintResult("TopSitesProvider", "", "linear_scan",
+                         linear_time.InMicrosecondsF() / lookups,
+                         "us/lookup", true);
+  perf_test::PrintResult("TopSitesProvider", "", "substring_index",
+                         index_time.InMicrosecondsF() / lookups,
+                         "us/lookup", true);
+}
@@ -0,0 +1,381 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/omnibox/browser/url_index_flat_data.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/logging.h"
+
+namespace {
+
+constexpr uint32_t kFlatDataMagic = 0x46505148;  // "HQPF"
+constexpr uint32_t kFlatDataVersion = 1;
+
+// Returns the bit representing |c| in a word's char signature.
+uint64_t CharSignatureBit(base::char16 c) {
+  return uint64_t{1} << (c % 64);
+}
+
+// Rounds |size| up to the section alignment.
+size_t AlignedSize(size_t size) {
+  return (size + 7) & ~size_t{7};
+}
+
+void AppendPadding(std::string* out) {
+  out->resize(AlignedSize(out->size()), '\0');
+}
+
+template <typename T>
+void AppendArray(const std::vector<T>& values, std::string* out) {
+  out->append(reinterpret_cast<const char*>(values.data()),
+              values.size() * sizeof(T));
+  AppendPadding(out);
+}
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// Decodes a delta + varint encoded list of ascending values from |bytes|,
+// calling |callback| for each. Stops quietly at the end of |bytes| if the
+// last varint is truncated.
+template <typename Callback>
+void DecodeDeltaList(base::span<const uint8_t> bytes, Callback callback) {
+  uint64_t previous = 0;
+  size_t pos = 0;
+  while (pos < bytes.size()) {
+    uint64_t delta = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+      if (pos == bytes.size() || shift > 63)
+        return;
+      byte = bytes[pos++];
+      delta |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    previous += delta;
+    callback(previous);
+  }
+}
+
+// Checks that |offsets| (of |count| + 1 entries) is non-decreasing, starts at
+// zero and ends at |length|.
+bool OffsetsAreValid(const uint32_t* offsets, size_t count, size_t length) {
+  if (offsets[0] != 0 || offsets[count] != length)
+    return false;
+  for (size_t i = 0; i < count; ++i) {
+    if (offsets[i] > offsets[i + 1])
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+// static
+std::string URLIndexFlatData::Build(
+    uint64_t token,
+    const String16Vector& word_list,
+    const CharWordIDMap& char_word_map,
+    const WordIDHistoryMap& word_id_history_map) {
+  const size_t word_count = word_list.size();
+
+  std::vector<uint64_t> char_signatures(word_count, 0);
+  std::vector<uint32_t> word_offsets;
+  word_offsets.reserve(word_count + 1);
+  std::vector<base::char16> word_chars;
+  for (size_t word_id = 0; word_id < word_count; ++word_id) {
+    const base::string16& word = word_list[word_id];
+    word_offsets.push_back(word_chars.size());
+    word_chars.insert(word_chars.end(), word.begin(), word.end());
+    for (base::char16 c : word)
+      char_signatures[word_id] |= CharSignatureBit(c);
+  }
+  word_offsets.push_back(word_chars.size());
+
+  std::vector<uint32_t> sorted_word_ids(word_count);
+  for (size_t i = 0; i < word_count; ++i)
+    sorted_word_ids[i] = i;
+  std::sort(sorted_word_ids.begin(), sorted_word_ids.end(),
+            [&word_list](uint32_t a, uint32_t b) {
+              return word_list[a] < word_list[b];
+            });
+
+  std::vector<uint32_t> posting_offsets;
+  posting_offsets.reserve(word_count + 1);
+  std::string postings;
+  for (size_t word_id = 0; word_id < word_count; ++word_id) {
+    posting_offsets.push_back(postings.size());
+    auto iter = word_id_history_map.find(word_id);
+    if (iter == word_id_history_map.end())
+      continue;
+    uint64_t previous = 0;
+    for (HistoryID history_id : iter->second) {
+      AppendVarint(static_cast<uint64_t>(history_id) - previous, &postings);
+      previous = static_cast<uint64_t>(history_id);
+    }
+  }
+  posting_offsets.push_back(postings.size());
+
+  std::vector<base::char16> chars;
+  std::vector<uint32_t> char_offsets;
+  std::string char_postings;
+  for (const auto& entry : char_word_map) {
+    if (entry.second.empty())
+      continue;
+    chars.push_back(entry.first);
+    char_offsets.push_back(char_postings.size());
+    uint64_t previous = 0;
+    for (WordID word_id : entry.second) {
+      AppendVarint(word_id - previous, &char_postings);
+      previous = word_id;
+    }
+  }
+  char_offsets.push_back(char_postings.size());
+
+  Header header = {};
+  header.magic = kFlatDataMagic;
+  header.version = kFlatDataVersion;
+  header.token = token;
+  header.word_count = word_count;
+  header.char_count = chars.size();
+  header.word_chars_length = word_chars.size();
+  header.postings_length = postings.size();
+  header.char_postings_length = char_postings.size();
+
+  std::string out(reinterpret_cast<const char*>(&header), sizeof(header));
+  AppendPadding(&out);
+  AppendArray(char_signatures, &out);
+  AppendArray(word_offsets, &out);
+  AppendArray(word_chars, &out);
+  AppendArray(sorted_word_ids, &out);
+  AppendArray(posting_offsets, &out);
+  out.append(postings);
+  AppendPadding(&out);
+  AppendArray(chars, &out);
+  AppendArray(char_offsets, &out);
+  out.append(char_postings);
+  AppendPadding(&out);
+  return out;
+}
+
+// static
+scoped_refptr<URLIndexFlatData> URLIndexFlatData::CreateFromFile(
+    const base::FilePath& path) {
+  scoped_refptr<URLIndexFlatData> flat_data(new URLIndexFlatData);
+  if (!flat_data->mapped_file_.Initialize(path))
+    return nullptr;
+  flat_data->data_ = flat_data->mapped_file_.data();
+  flat_data->length_ = flat_data->mapped_file_.length();
+  if (!flat_data->Init())
+    return nullptr;
+  return flat_data;
+}
+
+// static
+scoped_refptr<URLIndexFlatData> URLIndexFlatData::CreateFromString(
+    std::string data) {
+  scoped_refptr<URLIndexFlatData> flat_data(new URLIndexFlatData);
+  flat_data->buffer_ = std::move(data);
+  flat_data->data_ =
+      reinterpret_cast<const uint8_t*>(flat_data->buffer_.data());
+  flat_data->length_ = flat_data->buffer_.size();
+  if (!flat_data->Init())
+    return nullptr;
+  return flat_data;
+}
+
+base::StringPiece URLIndexFlatData::bytes() const {
+  return base::StringPiece(reinterpret_cast<const char*>(data_), length_);
+}
+
+base::StringPiece16 URLIndexFlatData::GetWord(WordID word_id) const {
+  if (word_id >= word_count())
+    return base::StringPiece16();
+  const uint32_t begin = word_offsets_[word_id];
+  return base::StringPiece16(word_chars_ + begin,
+                             word_offsets_[word_id + 1] - begin);
+}
+
+void URLIndexFlatData::AppendHistoryIDsForWord(
+    WordID word_id,
+    HistoryIDVector* history_ids) const {
+  if (word_id >= word_count())
+    return;
+  DecodeDeltaList(PostingList(posting_offsets_, postings_, word_id),
+                  [history_ids](uint64_t value) {
+                    history_ids->push_back(static_cast<HistoryID>(value));
+                  });
+}
+
+WordIDSet URLIndexFlatData::WordIDSetForTermChars(
+    const Char16Set& term_chars) const {
+  if (term_chars.empty())
+    return WordIDSet();
+
+  // Find the character with the shortest encoded list; its words are a
+  // superset of the result.
+  int rarest_char_index = -1;
+  size_t rarest_length = 0;
+  uint64_t signature = 0;
+  for (base::char16 c : term_chars) {
+    int char_index = FindChar(c);
+    // A character was not found so there are no matching results: bail.
+    if (char_index < 0)
+      return WordIDSet();
+    size_t length = char_offsets_[char_index + 1] - char_offsets_[char_index];
+    if (rarest_char_index < 0 || length < rarest_length) {
+      rarest_char_index = char_index;
+      rarest_length = length;
+    }
+    signature |= CharSignatureBit(c);
+  }
+
+  std::vector<WordID> word_ids;
+  DecodeDeltaList(
+      PostingList(char_offsets_, char_postings_, rarest_char_index),
+      [&](uint64_t value) {
+        if (value >= word_count() ||
+            (char_signatures_[value] & signature) != signature) {
+          return;
+        }
+        // Signature bits are shared by characters 64 code points apart, so
+        // confirm the remaining characters when there is more than one.
+        if (term_chars.size() > 1) {
+          base::StringPiece16 word = GetWord(value);
+          for (base::char16 c : term_chars) {
+            if (word.find(c) == base::StringPiece16::npos)
+              return;
+          }
+        }
+        word_ids.push_back(value);
+      });
+  return WordIDSet(std::move(word_ids), base::KEEP_FIRST_OF_DUPES);
+}
+
+void URLIndexFlatData::Materialize(
+    String16Vector* word_list,
+    WordMap* word_map,
+    CharWordIDMap* char_word_map,
+    WordIDHistoryMap* word_id_history_map,
+    HistoryIDWordMap* history_id_word_map) const {
+  const size_t words = word_count();
+  word_list->clear();
+  word_list->reserve(words);
+  for (WordID word_id = 0; word_id < words; ++word_id)
+    word_list->push_back(GetWord(word_id).as_string());
+
+  // |sorted_word_ids_| lets the word map be built with end() hints, i.e. in
+  // linear rather than n log n time.
+  word_map->clear();
+  for (size_t i = 0; i < words; ++i) {
+    WordID word_id = sorted_word_ids_[i];
+    if (word_id >= words || (*word_list)[word_id].empty())
+      continue;
+    word_map->emplace_hint(word_map->end(), (*word_list)[word_id], word_id);
+  }
+
+  char_word_map->clear();
+  for (size_t i = 0; i < char_count(); ++i) {
+    std::vector<WordID> word_ids;
+    DecodeDeltaList(PostingList(char_offsets_, char_postings_, i),
+                    [&word_ids](uint64_t value) { word_ids.push_back(value); });
+    char_word_map->emplace_hint(
+        char_word_map->end(), chars_[i],
+        WordIDSet(std::move(word_ids), base::KEEP_FIRST_OF_DUPES));
+  }
+
+  word_id_history_map->clear();
+  history_id_word_map->clear();
+  for (WordID word_id = 0; word_id < words; ++word_id) {
+    HistoryIDVector history_ids;
+    AppendHistoryIDsForWord(word_id, &history_ids);
+    if (history_ids.empty())
+      continue;
+    for (HistoryID history_id : history_ids)
+      (*history_id_word_map)[history_id].insert(word_id);
+    word_id_history_map->emplace_hint(
+        word_id_history_map->end(), word_id,
+        HistoryIDSet(std::move(history_ids), base::KEEP_FIRST_OF_DUPES));
+  }
+}
+
+URLIndexFlatData::URLIndexFlatData() = default;
+
+URLIndexFlatData::~URLIndexFlatData() = default;
+
+bool URLIndexFlatData::Init() {
+  if (!data_ || length_ < AlignedSize(sizeof(Header)))
+    return false;
+  const Header* h = header();
+  if (h->magic != kFlatDataMagic || h->version != kFlatDataVersion)
+    return false;
+
+  // Compute the section table in 64-bit arithmetic so that hostile counts
+  // cannot overflow it, then require it to describe exactly |length_| bytes.
+  const uint64_t words = h->word_count;
+  const uint64_t chars = h->char_count;
+  uint64_t offset = AlignedSize(sizeof(Header));
+  auto take = [&offset](uint64_t size) {
+    uint64_t section = offset;
+    offset += (size + 7) & ~uint64_t{7};
+    return section;
+  };
+  const uint64_t char_signatures = take(words * sizeof(uint64_t));
+  const uint64_t word_offsets = take((words + 1) * sizeof(uint32_t));
+  const uint64_t word_chars =
+      take(uint64_t{h->word_chars_length} * sizeof(base::char16));
+  const uint64_t sorted_word_ids = take(words * sizeof(uint32_t));
+  const uint64_t posting_offsets = take((words + 1) * sizeof(uint32_t));
+  const uint64_t postings = take(h->postings_length);
+  const uint64_t char_table = take(chars * sizeof(base::char16));
+  const uint64_t char_offsets = take((chars + 1) * sizeof(uint32_t));
+  const uint64_t char_postings = take(h->char_postings_length);
+  if (offset != length_)
+    return false;
+
+  char_signatures_ =
+      reinterpret_cast<const uint64_t*>(data_ + char_signatures);
+  word_offsets_ = reinterpret_cast<const uint32_t*>(data_ + word_offsets);
+  word_chars_ = reinterpret_cast<const base::char16*>(data_ + word_chars);
+  sorted_word_ids_ =
+      reinterpret_cast<const uint32_t*>(data_ + sorted_word_ids);
+  posting_offsets_ =
+      reinterpret_cast<const uint32_t*>(data_ + posting_offsets);
+  postings_ = data_ + postings;
+  chars_ = reinterpret_cast<const base::char16*>(data_ + char_table);
+  char_offsets_ = reinterpret_cast<const uint32_t*>(data_ + char_offsets);
+  char_postings_ = data_ + char_postings;
+
+  // The offset tables are the only thing needed to keep every later read in
+  // bounds. Checking them touches a small fraction of the file.
+  return OffsetsAreValid(word_offsets_, words, h->word_chars_length) &&
+         OffsetsAreValid(posting_offsets_, words, h->postings_length) &&
+         OffsetsAreValid(char_offsets_, chars, h->char_postings_length);
+}
+
+base::span<const uint8_t> URLIndexFlatData::PostingList(
+    const uint32_t* offsets,
+    const uint8_t* postings,
+    size_t index) const {
+  return base::make_span(postings + offsets[index],
+                         offsets[index + 1] - offsets[index]);
+}
+
+int URLIndexFlatData::FindChar(base::char16 c) const {
+  const base::char16* end = chars_ + char_count();
+  const base::char16* pos = std::lower_bound(chars_, end, c);
+  if (pos == end || *pos != c)
+    return -1;
+  return pos - chars_;
+}
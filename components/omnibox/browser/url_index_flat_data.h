@@ -0,0 +1,150 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef COMPONENTS_OMNIBOX_BROWSER_URL_INDEX_FLAT_DATA_H_
+#define COMPONENTS_OMNIBOX_BROWSER_URL_INDEX_FLAT_DATA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/containers/span.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_piece.h"
+#include "components/omnibox/browser/in_memory_url_index_types.h"
+
+namespace base {
+class FilePath;
+}
+
+// A read-only, position-independent encoding of the word portion of
+// URLIndexPrivateData: the word list, the char-to-word map and the
+// word-to-history map. It is written next to the protobuf cache and is
+// memory-mapped on restore, so that HistoryItemsForTerms() can run directly
+// against it instead of first parsing hundreds of thousands of map entries.
+//
+// All sections are 8-byte aligned and stored in host byte order:
+//   Header
+//   uint64_t char_signatures[word_count]     Bit (c % 64) set for each char.
+//   uint32_t word_offsets[word_count + 1]    Offsets into |word_chars|.
+//   char16   word_chars[]                    Words, in WordID order.
+//   uint32_t sorted_word_ids[word_count]     WordIDs sorted by word.
+//   uint32_t posting_offsets[word_count + 1] Offsets into |postings|.
+//   uint8_t  postings[]                      Delta + varint HistoryIDs.
+//   char16   chars[char_count]               Sorted distinct characters.
+//   uint32_t char_offsets[char_count + 1]    Offsets into |char_postings|.
+//   uint8_t  char_postings[]                 Delta + varint WordIDs.
+//
+// Unused word slots (see URLIndexPrivateData::available_words_) are kept as
+// empty words so that WordIDs are stable across a save and restore.
+//
+// Decoding never reads outside of the mapped region, but a corrupt file may
+// produce bogus IDs. Callers must treat HistoryIDs coming out of this class
+// as untrusted and look them up before use, as ShouldFilter() already does.
+class URLIndexFlatData : public base::RefCountedThreadSafe<URLIndexFlatData> {
+ public:
+  // Encodes the given maps into the flat format. |token| is stored in the
+  // header and lets the owner of the companion protobuf cache verify that the
+  // two files were written together.
+  static std::string Build(uint64_t token,
+                           const String16Vector& word_list,
+                           const CharWordIDMap& char_word_map,
+                           const WordIDHistoryMap& word_id_history_map);
+
+  // Maps the file at |path|. Returns null if the file is missing or its
+  // header and section table are not consistent with its size.
+  static scoped_refptr<URLIndexFlatData> CreateFromFile(
+      const base::FilePath& path);
+
+  // Same as CreateFromFile() but takes ownership of an in-memory buffer.
+  static scoped_refptr<URLIndexFlatData> CreateFromString(std::string data);
+
+  uint64_t token() const { return header()->token; }
+  size_t word_count() const { return header()->word_count; }
+  size_t char_count() const { return header()->char_count; }
+
+  // The raw encoded bytes, suitable for writing back to disk.
+  base::StringPiece bytes() const;
+
+  // Returns the word for |word_id|, or an empty piece for an unused slot or an
+  // out-of-range ID.
+  base::StringPiece16 GetWord(WordID word_id) const;
+
+  // Appends the HistoryIDs of the items containing |word_id| to
+  // |history_ids|, in ascending order.
+  void AppendHistoryIDsForWord(WordID word_id,
+                               HistoryIDVector* history_ids) const;
+
+  // Equivalent to URLIndexPrivateData::WordIDSetForTermChars(): returns the
+  // words which contain every character in |term_chars|. Rather than
+  // intersecting one set per character, this decodes only the rarest
+  // character's list and filters it using the per-word char signatures.
+  WordIDSet WordIDSetForTermChars(const Char16Set& term_chars) const;
+
+  // Decodes the whole index back into its map form. Used when the index is
+  // about to be modified.
+  void Materialize(String16Vector* word_list,
+                   WordMap* word_map,
+                   CharWordIDMap* char_word_map,
+                   WordIDHistoryMap* word_id_history_map,
+                   HistoryIDWordMap* history_id_word_map) const;
+
+ private:
+  friend class base::RefCountedThreadSafe<URLIndexFlatData>;
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t token;
+    uint32_t word_count;
+    uint32_t char_count;
+    uint32_t word_chars_length;
+    uint32_t postings_length;
+    uint32_t char_postings_length;
+    uint32_t padding;
+  };
+
+  URLIndexFlatData();
+  ~URLIndexFlatData();
+
+  // Points the section pointers into |data_| and validates the layout.
+  bool Init();
+
+  const Header* header() const {
+    return reinterpret_cast<const Header*>(data_);
+  }
+
+  // Returns the bytes of the |index|th list in a varint section.
+  base::span<const uint8_t> PostingList(const uint32_t* offsets,
+                                        const uint8_t* postings,
+                                        size_t index) const;
+
+  // Returns the index of |c| in |chars_|, or -1.
+  int FindChar(base::char16 c) const;
+
+  // Exactly one of these owns the bytes pointed to by |data_|.
+  base::MemoryMappedFile mapped_file_;
+  std::string buffer_;
+
+  const uint8_t* data_ = nullptr;
+  size_t length_ = 0;
+
+  const uint64_t* char_signatures_ = nullptr;
+  const uint32_t* word_offsets_ = nullptr;
+  const base::char16* word_chars_ = nullptr;
+  const uint32_t* sorted_word_ids_ = nullptr;
+  const uint32_t* posting_offsets_ = nullptr;
+  const uint8_t* postings_ = nullptr;
+  const base::char16* chars_ = nullptr;
+  const uint32_t* char_offsets_ = nullptr;
+  const uint8_t* char_postings_ = nullptr;
+
+  DISALLOW_COPY_AND_ASSIGN(URLIndexFlatData);
+};
+
+#endif  // COMPONENTS_OMNIBOX_BROWSER_URL_INDEX_FLAT_DATA_H_
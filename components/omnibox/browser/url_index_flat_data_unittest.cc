@@ -0,0 +1,176 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/omnibox/browser/url_index_flat_data.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::ASCIIToUTF16;
+
+namespace {
+
+constexpr uint64_t kToken = 0x1234567890abcdef;
+
+class URLIndexFlatDataTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    // Slot 2 is unused, as if its word had been removed from the index.
+    AddWord(ASCIIToUTF16("google"), {1, 5, 300});
+    AddWord(ASCIIToUTF16("mail"), {5});
+    word_list_.push_back(base::string16());
+    AddWord(ASCIIToUTF16("gmail"), {5, 1000000000000});
+    AddWord(ASCIIToUTF16("a"), {7});
+  }
+
+  void AddWord(const base::string16& word,
+               const std::vector<HistoryID>& history_ids) {
+    WordID word_id = word_list_.size();
+    word_list_.push_back(word);
+    word_map_[word] = word_id;
+    for (base::char16 c : Char16SetFromString16(word))
+      char_word_map_[c].insert(word_id);
+    for (HistoryID history_id : history_ids) {
+      word_id_history_map_[word_id].insert(history_id);
+      history_id_word_map_[history_id].insert(word_id);
+    }
+  }
+
+  scoped_refptr<URLIndexFlatData> Build() {
+    return URLIndexFlatData::CreateFromString(URLIndexFlatData::Build(
+        kToken, word_list_, char_word_map_, word_id_history_map_));
+  }
+
+  String16Vector word_list_;
+  WordMap word_map_;
+  CharWordIDMap char_word_map_;
+  WordIDHistoryMap word_id_history_map_;
+  HistoryIDWordMap history_id_word_map_;
+};
+
+}  // namespace
+
+TEST_F(URLIndexFlatDataTest, Lookups) {
+  scoped_refptr<URLIndexFlatData> flat_data = Build();
+  ASSERT_TRUE(flat_data);
+  EXPECT_EQ(kToken, flat_data->token());
+  EXPECT_EQ(5u, flat_data->word_count());
+  EXPECT_EQ(char_word_map_.size(), flat_data->char_count());
+
+  EXPECT_EQ(ASCIIToUTF16("google"), flat_data->GetWord(0));
+  EXPECT_TRUE(flat_data->GetWord(2).empty());
+  EXPECT_EQ(ASCIIToUTF16("gmail"), flat_data->GetWord(3));
+  EXPECT_TRUE(flat_data->GetWord(5).empty());
+
+  HistoryIDVector history_ids;
+  flat_data->AppendHistoryIDsForWord(0, &history_ids);
+  flat_data->AppendHistoryIDsForWord(2, &history_ids);
+  flat_data->AppendHistoryIDsForWord(3, &history_ids);
+  EXPECT_EQ((HistoryIDVector{1, 5, 300, 5, 1000000000000}), history_ids);
+}
+
+TEST_F(URLIndexFlatDataTest, WordIDSetForTermChars) {
+  scoped_refptr<URLIndexFlatData> flat_data = Build();
+  ASSERT_TRUE(flat_data);
+
+  EXPECT_EQ((WordIDSet{1, 3, 4}),
+            flat_data->WordIDSetForTermChars(Char16Set{'a'}));
+  EXPECT_EQ((WordIDSet{0, 3}),
+            flat_data->WordIDSetForTermChars(Char16Set{'g', 'l'}));
+  EXPECT_EQ((WordIDSet{3}),
+            flat_data->WordIDSetForTermChars(Char16Set{'g', 'a', 'm'}));
+  EXPECT_TRUE(flat_data->WordIDSetForTermChars(Char16Set{'g', 'z'}).empty());
+}
+
+TEST_F(URLIndexFlatDataTest, WordIDSetForTermCharsSignatureCollision) {
+  // U+00A1 shares its signature bit with 'a', so "mail" and "gmail" pass the
+  // signature check for it and must be rejected by looking at the words.
+  const base::char16 kCollidesWithA = 'a' + 64;
+  AddWord(base::string16(1, kCollidesWithA) + ASCIIToUTF16("b"), {8});
+  AddWord(base::string16(1, kCollidesWithA) + ASCIIToUTF16("c"), {9});
+  scoped_refptr<URLIndexFlatData> flat_data = Build();
+  ASSERT_TRUE(flat_data);
+
+  EXPECT_TRUE(
+      flat_data->WordIDSetForTermChars(Char16Set{'m', kCollidesWithA})
+          .empty());
+  EXPECT_EQ((WordIDSet{5}),
+            flat_data->WordIDSetForTermChars(Char16Set{'b', kCollidesWithA}));
+}
+
+TEST_F(URLIndexFlatDataTest, Materialize) {
+  scoped_refptr<URLIndexFlatData> flat_data = Build();
+  ASSERT_TRUE(flat_data);
+
+  String16Vector word_list;
+  WordMap word_map;
+  CharWordIDMap char_word_map;
+  WordIDHistoryMap word_id_history_map;
+  HistoryIDWordMap history_id_word_map;
+  flat_data->Materialize(&word_list, &word_map, &char_word_map,
+                         &word_id_history_map, &history_id_word_map);
+  EXPECT_EQ(word_list_, word_list);
+  EXPECT_EQ(word_map_, word_map);
+  EXPECT_EQ(char_word_map_, char_word_map);
+  EXPECT_EQ(word_id_history_map_, word_id_history_map);
+  EXPECT_EQ(history_id_word_map_, history_id_word_map);
+}
+
+TEST_F(URLIndexFlatDataTest, FileRoundTrip) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.GetPath().AppendASCII("words");
+  std::string data = URLIndexFlatData::Build(kToken, word_list_,
+                                             char_word_map_,
+                                             word_id_history_map_);
+  ASSERT_EQ(static_cast<int>(data.size()),
+            base::WriteFile(path, data.data(), data.size()));
+
+  scoped_refptr<URLIndexFlatData> flat_data =
+      URLIndexFlatData::CreateFromFile(path);
+  ASSERT_TRUE(flat_data);
+  EXPECT_EQ(data, flat_data->bytes());
+  EXPECT_EQ(ASCIIToUTF16("mail"), flat_data->GetWord(1));
+
+  EXPECT_FALSE(URLIndexFlatData::CreateFromFile(
+      temp_dir.GetPath().AppendASCII("missing")));
+}
+
+TEST_F(URLIndexFlatDataTest, RejectsCorruptData) {
+  std::string data = URLIndexFlatData::Build(kToken, word_list_,
+                                             char_word_map_,
+                                             word_id_history_map_);
+  EXPECT_FALSE(URLIndexFlatData::CreateFromString(std::string()));
+  EXPECT_FALSE(URLIndexFlatData::CreateFromString(data.substr(0, 16)));
+  EXPECT_FALSE(
+      URLIndexFlatData::CreateFromString(data.substr(0, data.size() - 8)));
+
+  std::string bad_magic = data;
+  bad_magic[0] ^= 0xff;
+  EXPECT_FALSE(URLIndexFlatData::CreateFromString(bad_magic));
+
+  // Corrupt the first word offset, which must be zero.
+  std::string bad_offsets = data;
+  const size_t kWordOffsetsStart = 40 + 5 * sizeof(uint64_t);
+  bad_offsets[kWordOffsetsStart] = 3;
+  EXPECT_FALSE(URLIndexFlatData::CreateFromString(bad_offsets));
+}
+
+TEST_F(URLIndexFlatDataTest, Empty) {
+  scoped_refptr<URLIndexFlatData> flat_data =
+      URLIndexFlatData::CreateFromString(URLIndexFlatData::Build(
+          kToken, String16Vector(), CharWordIDMap(), WordIDHistoryMap()));
+  ASSERT_TRUE(flat_data);
+  EXPECT_EQ(0u, flat_data->word_count());
+  EXPECT_TRUE(flat_data->WordIDSetForTermChars(Char16Set{'a'}).empty());
+}
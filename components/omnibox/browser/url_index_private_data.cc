@@ -7,19 +7,24 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <numeric>
+#include <queue>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "base/containers/stack.h"
 #include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
 #include "base/i18n/break_iterator.h"
 #include "base/i18n/case_conversion.h"
 #include "base/macros.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/rand_util.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
@@ -172,8 +177,9 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
   ScoredHistoryMatches scored_items;
   // Invalidate the term cache and return if we have indexed no words (probably
   // because we've not been initialized yet).
-  if (word_list_.empty()) {
+  if (WordListSize() == 0) {
     search_term_cache_.clear();
+    previous_candidates_.clear();
     return scored_items;
   }
   // Reset used_ flags for search_term_cache_. We use a basic mark-and-sweep
@@ -181,6 +187,9 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
   ResetSearchTermCache();
 
   bool history_ids_were_trimmed = false;
+  // The untrimmed candidates for each list of words searched for below, kept
+  // so that the next call can narrow them down if the user keeps typing.
+  SearchCandidatesList candidates;
   // A set containing the list of words extracted from each search string,
   // used to prevent running duplicate searches.
   std::set<String16Vector> search_string_words;
@@ -211,13 +220,17 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
       continue;
     search_string_words.insert(lower_words);
 
-    HistoryIDVector history_ids = HistoryIDsFromWords(lower_words);
+    HistoryIDVector history_ids;
+    if (!HistoryIDsFromPreviousCandidates(lower_words, &history_ids))
+      history_ids = HistoryIDsFromWords(lower_words);
+    candidates.emplace_back(lower_words, history_ids);
     history_ids_were_trimmed |= TrimHistoryIdsPool(&history_ids);
 
     HistoryIdsToScoredMatches(std::move(history_ids), lower_raw_string,
-                              template_url_service, bookmark_model,
-                              &scored_items);
+                              max_matches, template_url_service,
+                              bookmark_model, &scored_items);
   }
+  previous_candidates_ = std::move(candidates);
   // Select and sort only the top |max_matches| results.
   if (scored_items.size() > max_matches) {
     std::partial_sort(scored_items.begin(), scored_items.begin() + max_matches,
@@ -254,6 +267,7 @@ bool URLIndexPrivateData::UpdateURL(
   // indexed and it qualifies then it gets indexed. If it is already
   // indexed and still qualifies then it gets updated, otherwise it
   // is deleted from the index.
+  MaterializeFlatData();
   bool row_was_updated = false;
   history::URLID row_id = row.id();
   auto row_pos = history_info_map_.find(row_id);
@@ -301,8 +315,10 @@ bool URLIndexPrivateData::UpdateURL(
     RemoveRowFromIndex(row);
     row_was_updated = true;
   }
-  if (row_was_updated)
+  if (row_was_updated) {
     search_term_cache_.clear();  // This invalidates the cache.
+    previous_candidates_.clear();
+  }
   return row_was_updated;
 }
 
@@ -358,8 +374,10 @@ bool URLIndexPrivateData::DeleteURL(const GURL& url) {
                           HistoryInfoMapItemHasURL(url));
   if (pos == history_info_map_.end())
     return false;
+  MaterializeFlatData();
   RemoveRowFromIndex(pos->second.url_row);
   search_term_cache_.clear();  // This invalidates the cache.
+  previous_candidates_.clear();
   return true;
 }
 
@@ -390,18 +408,38 @@ scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::RestoreFromFile(
     return restored_data;
   }
 
+  // The word index lives in its own file which is mapped rather than read.
+  // It must be the one written together with this cache file.
+  if (index_cache.has_flat_data_token()) {
+    restored_data->flat_data_ =
+        URLIndexFlatData::CreateFromFile(FlatDataFilePath(file_path));
+    if (!restored_data->flat_data_ ||
+        restored_data->flat_data_->token() != index_cache.flat_data_token()) {
+      LOG(WARNING) << "Missing or mismatched URLIndexPrivateData word index "
+                   << "for " << file_path.value();
+      return nullptr;
+    }
+  }
+
   if (!restored_data->RestorePrivateData(index_cache))
     return nullptr;
 
   UMA_HISTOGRAM_TIMES("History.InMemoryURLIndexRestoreCacheTime",
                       base::TimeTicks::Now() - beginning_time);
   UMA_HISTOGRAM_COUNTS_1M("History.InMemoryURLHistoryItems",
-                          restored_data->history_id_word_map_.size());
+                          restored_data->history_info_map_.size());
   UMA_HISTOGRAM_COUNTS_1M("History.InMemoryURLCacheSize", data.size());
-  UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLWords",
-                             restored_data->word_map_.size());
-  UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLChars",
-                             restored_data->char_word_map_.size());
+  if (restored_data->flat_data_) {
+    UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLWords",
+                               restored_data->flat_data_->word_count());
+    UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLChars",
+                               restored_data->flat_data_->char_count());
+  } else {
+    UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLWords",
+                               restored_data->word_map_.size());
+    UMA_HISTOGRAM_COUNTS_10000("History.InMemoryURLChars",
+                               restored_data->char_word_map_.size());
+  }
   if (restored_data->Empty())
     return nullptr;  // 'No data' is the same as a failed reload.
   return restored_data;
@@ -460,6 +498,20 @@ bool URLIndexPrivateData::WritePrivateDataToCacheFileTask(
   return private_data->SaveToFile(file_path);
 }
 
+// static
+bool URLIndexPrivateData::DeleteCacheFiles(const base::FilePath& file_path) {
+  // Delete both even if the first fails; the word index contains words from
+  // URLs and titles which may have just been removed from history.
+  bool deleted = base::DeleteFile(file_path, false);
+  return base::DeleteFile(FlatDataFilePath(file_path), false) && deleted;
+}
+
+// static
+base::FilePath URLIndexPrivateData::FlatDataFilePath(
+    const base::FilePath& file_path) {
+  return file_path.AddExtension(FILE_PATH_LITERAL("words"));
+}
+
 scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::Duplicate() const {
   scoped_refptr<URLIndexPrivateData> data_copy = new URLIndexPrivateData;
   data_copy->last_time_rebuilt_from_history_ = last_time_rebuilt_from_history_;
@@ -471,9 +523,11 @@ scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::Duplicate() const {
   data_copy->history_id_word_map_ = history_id_word_map_;
   data_copy->history_info_map_ = history_info_map_;
   data_copy->word_starts_map_ = word_starts_map_;
+  data_copy->flat_data_ = flat_data_;
   return data_copy;
   // Not copied:
   //    search_term_cache_
+  //    previous_candidates_
 }
 
 bool URLIndexPrivateData::Empty() const {
@@ -490,12 +544,15 @@ void URLIndexPrivateData::Clear() {
   history_id_word_map_.clear();
   history_info_map_.clear();
   word_starts_map_.clear();
+  flat_data_ = nullptr;
+  previous_candidates_.clear();
 }
 
 size_t URLIndexPrivateData::EstimateMemoryUsage() const {
   size_t res = 0;
 
   res += base::trace_event::EstimateMemoryUsage(search_term_cache_);
+  res += base::trace_event::EstimateMemoryUsage(previous_candidates_);
   res += base::trace_event::EstimateMemoryUsage(word_list_);
   res += base::trace_event::EstimateMemoryUsage(available_words_);
   res += base::trace_event::EstimateMemoryUsage(word_map_);
@@ -504,6 +561,8 @@ size_t URLIndexPrivateData::EstimateMemoryUsage() const {
   res += base::trace_event::EstimateMemoryUsage(history_id_word_map_);
   res += base::trace_event::EstimateMemoryUsage(history_info_map_);
   res += base::trace_event::EstimateMemoryUsage(word_starts_map_);
+  // |flat_data_| is a file-backed mapping which the OS can page out at will,
+  // so it is not counted here.
 
   return res;
 }
@@ -542,6 +601,54 @@ HistoryIDVector URLIndexPrivateData::HistoryIDsFromWords(
   return history_ids;
 }
 
+bool URLIndexPrivateData::HistoryIDsFromPreviousCandidates(
+    const String16Vector& lower_words,
+    HistoryIDVector* history_ids) {
+  // Find the longest previous list of words that |lower_words| extends. Each
+  // word matches a superset of the items its extensions match, so the items
+  // matching |lower_words| are exactly the previous candidates which also
+  // match the words that changed or were added.
+  const SearchCandidates* best_candidates = nullptr;
+  size_t best_length = 0;
+  for (const SearchCandidates& candidates : previous_candidates_) {
+    const String16Vector& previous_words = candidates.first;
+    if (previous_words.size() > lower_words.size())
+      continue;
+    size_t length = 0;
+    bool extends = true;
+    for (size_t i = 0; extends && i < previous_words.size(); ++i) {
+      extends = base::StartsWith(lower_words[i], previous_words[i],
+                                 base::CompareCase::SENSITIVE);
+      length += previous_words[i].length();
+    }
+    if (extends && (!best_candidates || length > best_length)) {
+      best_candidates = &candidates;
+      best_length = length;
+    }
+  }
+  if (!best_candidates)
+    return false;
+
+  SCOPED_UMA_HISTOGRAM_TIMER("Omnibox.HistoryQuickHistoryIDSetFromWords");
+  const String16Vector& previous_words = best_candidates->first;
+  *history_ids = best_candidates->second;
+  for (size_t i = 0; i < lower_words.size(); ++i) {
+    if (i < previous_words.size() && lower_words[i] == previous_words[i]) {
+      // Keep the term's cache entry alive, as HistoryIDsForTerm() would have.
+      auto cache_iter = search_term_cache_.find(lower_words[i]);
+      if (cache_iter != search_term_cache_.end())
+        cache_iter->second.used_ = true;
+      continue;
+    }
+    if (history_ids->empty())
+      break;
+    HistoryIDSet term_history_set = HistoryIDsForTerm(lower_words[i]);
+    // set-intersection
+    base::EraseIf(*history_ids, base::IsNotIn<HistoryIDSet>(term_history_set));
+  }
+  return true;
+}
+
 bool URLIndexPrivateData::TrimHistoryIdsPool(
     HistoryIDVector* history_ids) const {
   constexpr size_t kItemsToScoreLimit = 500;
@@ -635,7 +742,7 @@ HistoryIDSet URLIndexPrivateData::HistoryIDsForTerm(
     // We must filter the word list because the resulting word set surely
     // contains words which do not have the search term as a proper subset.
     base::EraseIf(word_id_set, [this, &term](WordID word_id) {
-      return word_list_[word_id].find(term) == base::string16::npos;
+      return WordForID(word_id).find(term) == base::StringPiece16::npos;
     });
   } else {
     word_id_set = WordIDSetForTermChars(Char16SetFromString16(term));
@@ -647,6 +754,10 @@ HistoryIDSet URLIndexPrivateData::HistoryIDsForTerm(
   // construct a flat_set than to insert elements one by one.
   HistoryIDVector buffer;
   for (WordID word_id : word_id_set) {
+    if (flat_data_) {
+      flat_data_->AppendHistoryIDsForWord(word_id, &buffer);
+      continue;
+    }
     auto word_iter = word_id_history_map_.find(word_id);
     if (word_iter != word_id_history_map_.end()) {
       HistoryIDSet& word_history_id_set(word_iter->second);
@@ -667,6 +778,9 @@ HistoryIDSet URLIndexPrivateData::HistoryIDsForTerm(
 
 WordIDSet URLIndexPrivateData::WordIDSetForTermChars(
     const Char16Set& term_chars) {
+  if (flat_data_)
+    return flat_data_->WordIDSetForTermChars(term_chars);
+
   // TODO(dyaroshev): write a generic algorithm(crbug.com/696167).
 
   WordIDSet word_id_set;
@@ -695,6 +809,7 @@ WordIDSet URLIndexPrivateData::WordIDSetForTermChars(
 void URLIndexPrivateData::HistoryIdsToScoredMatches(
     HistoryIDVector history_ids,
     const base::string16& lower_raw_string,
+    size_t max_matches,
     const TemplateURLService* template_url_service,
     bookmarks::BookmarkModel* bookmark_model,
     ScoredHistoryMatches* scored_items) const {
@@ -730,11 +845,48 @@ void URLIndexPrivateData::HistoryIdsToScoredMatches(
     return ShouldFilter(history_id, template_url_service);
   });
 
-  // Score the matches.
+  // Score the matches, the most promising ones first. Once |max_matches|
+  // matches score higher than what the remaining candidates could possibly
+  // reach, the remaining candidates cannot make it into the results and are
+  // skipped without being matched against the terms.
   const size_t num_matches = history_ids.size();
   const base::Time now = base::Time::Now();
 
+  std::vector<std::pair<int, HistoryID>> bounded_ids;
+  bounded_ids.reserve(num_matches);
   for (HistoryID history_id : history_ids) {
+    auto hist_pos = history_info_map_.find(history_id);
+    bounded_ids.emplace_back(
+        ScoredHistoryMatch::GetRawScoreUpperBound(hist_pos->second.visits,
+                                                  num_matches, now),
+        history_id);
+  }
+  std::stable_sort(bounded_ids.begin(), bounded_ids.end(),
+                   [](const std::pair<int, HistoryID>& a,
+                      const std::pair<int, HistoryID>& b) {
+                     return a.first > b.first;
+                   });
+
+  // The best |max_matches| scores so far, including those of |scored_items|
+  // from previous search strings, with the lowest on top.
+  std::priority_queue<int, std::vector<int>, std::greater<int>> top_scores;
+  auto add_top_score = [&top_scores, max_matches](int score) {
+    if (top_scores.size() < max_matches) {
+      top_scores.push(score);
+    } else if (!top_scores.empty() && score > top_scores.top()) {
+      top_scores.pop();
+      top_scores.push(score);
+    }
+  };
+  for (const ScoredHistoryMatch& scored_item : *scored_items)
+    add_top_score(scored_item.raw_score);
+
+  for (const auto& bounded_id : bounded_ids) {
+    if (!top_scores.empty() && top_scores.size() >= max_matches &&
+        bounded_id.first < top_scores.top()) {
+      break;
+    }
+    const HistoryID history_id = bounded_id.second;
     auto hist_pos = history_info_map_.find(history_id);
     const history::URLRow& hist_item = hist_pos->second.url_row;
     auto starts_pos = word_starts_map_.find(history_id);
@@ -746,8 +898,10 @@ void URLIndexPrivateData::HistoryIdsToScoredMatches(
         num_matches, now);
     // Filter new matches that ended up scoring 0. (These are usually matches
     // which didn't match the user's raw terms.)
-    if (new_scored_match.raw_score > 0)
+    if (new_scored_match.raw_score > 0) {
+      add_top_score(new_scored_match.raw_score);
       scored_items->push_back(std::move(new_scored_match));
+    }
   }
 }
 
@@ -846,6 +1000,7 @@ void URLIndexPrivateData::AddRowWordsToIndex(const history::URLRow& row,
     AddWordToIndex(word, history_id);
 
   search_term_cache_.clear();  // Invalidate the term cache.
+  previous_candidates_.clear();
 }
 
 void URLIndexPrivateData::AddWordToIndex(const base::string16& term,
@@ -926,10 +1081,60 @@ void URLIndexPrivateData::ResetSearchTermCache() {
     item.second.used_ = false;
 }
 
+size_t URLIndexPrivateData::WordListSize() const {
+  return flat_data_ ? flat_data_->word_count() : word_list_.size();
+}
+
+base::StringPiece16 URLIndexPrivateData::WordForID(WordID word_id) const {
+  if (flat_data_)
+    return flat_data_->GetWord(word_id);
+  return word_list_[word_id];
+}
+
+void URLIndexPrivateData::MaterializeFlatData() {
+  if (!flat_data_)
+    return;
+  SCOPED_UMA_HISTOGRAM_TIMER("History.InMemoryURLIndexMaterializeTime");
+  flat_data_->Materialize(&word_list_, &word_map_, &char_word_map_,
+                          &word_id_history_map_, &history_id_word_map_);
+  flat_data_ = nullptr;
+  // Cached word IDs are still valid, as Materialize() preserves them, but the
+  // cache is cheap to rebuild and the index is about to change anyway.
+  search_term_cache_.clear();
+}
+
+bool URLIndexPrivateData::SaveFlatDataToFile(const base::FilePath& file_path,
+                                             uint64_t* token) const {
+  if (flat_data_) {
+    // The index has not changed since it was restored. If the file on disk is
+    // still the one it was mapped from there is nothing to write, which also
+    // avoids replacing a file that is mapped.
+    *token = flat_data_->token();
+    scoped_refptr<URLIndexFlatData> on_disk =
+        URLIndexFlatData::CreateFromFile(file_path);
+    if (on_disk && on_disk->token() == *token)
+      return true;
+    return base::ImportantFileWriter::WriteFileAtomically(
+        file_path, flat_data_->bytes());
+  }
+  *token = base::RandUint64();
+  return base::ImportantFileWriter::WriteFileAtomically(
+      file_path, URLIndexFlatData::Build(*token, word_list_, char_word_map_,
+                                         word_id_history_map_));
+}
+
 bool URLIndexPrivateData::SaveToFile(const base::FilePath& file_path) {
   base::TimeTicks beginning_time = base::TimeTicks::Now();
   InMemoryURLIndexCacheItem index_cache;
   SavePrivateData(&index_cache);
+  if (saved_cache_version_ >= kFlatDataCacheFileVersion) {
+    uint64_t token = 0;
+    if (!SaveFlatDataToFile(FlatDataFilePath(file_path), &token)) {
+      LOG(WARNING) << "Failed to write the InMemoryURLIndex word index.";
+      return false;
+    }
+    index_cache.set_flat_data_token(token);
+  }
   std::string data;
   if (!index_cache.SerializeToString(&data)) {
     LOG(WARNING) << "Failed to serialize the InMemoryURLIndex cache.";
@@ -955,10 +1160,15 @@ void URLIndexPrivateData::SavePrivateData(
   // history_item_count_ is no longer used but rather than change the protobuf
   // definition use a placeholder. This will go away with the switch to SQLite.
   cache->set_history_item_count(0);
-  SaveWordList(cache);
-  SaveWordMap(cache);
-  SaveCharWordMap(cache);
-  SaveWordIDHistoryMap(cache);
+  // Newer versions keep the word index in a separate URLIndexFlatData file;
+  // see SaveFlatDataToFile().
+  if (saved_cache_version_ < kFlatDataCacheFileVersion) {
+    DCHECK(!flat_data_);
+    SaveWordList(cache);
+    SaveWordMap(cache);
+    SaveCharWordMap(cache);
+    SaveWordIDHistoryMap(cache);
+  }
   SaveHistoryInfoMap(cache);
   SaveWordStartsMap(cache);
 }
@@ -1091,9 +1301,14 @@ bool URLIndexPrivateData::RestorePrivateData(
     }
     restored_cache_version_ = cache.version();
   }
-  return RestoreWordList(cache) && RestoreWordMap(cache) &&
-      RestoreCharWordMap(cache) && RestoreWordIDHistoryMap(cache) &&
-      RestoreHistoryInfoMap(cache) && RestoreWordStartsMap(cache);
+  // When the word index was mapped by RestoreFromFile() there is nothing to
+  // decode for it here.
+  if (!flat_data_ &&
+      !(RestoreWordList(cache) && RestoreWordMap(cache) &&
+        RestoreCharWordMap(cache) && RestoreWordIDHistoryMap(cache))) {
+    return false;
+  }
+  return RestoreHistoryInfoMap(cache) && RestoreWordStartsMap(cache);
 }
 
 bool URLIndexPrivateData::RestoreWordList(
@@ -6,6 +6,7 @@
 #define COMPONENTS_OMNIBOX_BROWSER_URL_INDEX_PRIVATE_DATA_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <map>
 #include <set>
@@ -19,6 +20,7 @@
 #include "components/omnibox/browser/in_memory_url_index_cache.pb.h"
 #include "components/omnibox/browser/in_memory_url_index_types.h"
 #include "components/omnibox/browser/scored_history_match.h"
+#include "components/omnibox/browser/url_index_flat_data.h"
 
 class HistoryQuickProviderTest;
 class TemplateURLService;
@@ -37,7 +39,11 @@ class InMemoryURLIndex;
 }
 
 // Current version of the cache file.
-static const int kCurrentCacheFileVersion = 5;
+static const int kCurrentCacheFileVersion = 6;
+
+// The first version of the cache file which keeps the word index in a
+// URLIndexFlatData file next to it rather than in the protobuf.
+static const int kFlatDataCacheFileVersion = 6;
 
 // A structure private to InMemoryURLIndex describing its internal data and
 // providing for restoring, rebuilding and updating that internal data. As
@@ -132,6 +138,14 @@ class URLIndexPrivateData
       scoped_refptr<URLIndexPrivateData> private_data,
       const base::FilePath& file_path);
 
+  // Deletes the cache file at |file_path| along with its flat word index.
+  // Returns true if both are gone.
+  static bool DeleteCacheFiles(const base::FilePath& file_path);
+
+  // Returns the path of the flat word index belonging to the cache file at
+  // |file_path|.
+  static base::FilePath FlatDataFilePath(const base::FilePath& file_path);
+
   // Creates a copy of ourself.
   scoped_refptr<URLIndexPrivateData> Duplicate() const;
 
@@ -153,10 +167,12 @@ class URLIndexPrivateData
   friend class ::HistoryQuickProviderTest;
   friend class InMemoryURLIndexTest;
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, CacheSaveRestore);
+  FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, CacheRestoreFlatDataQueries);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, CalculateWordStartsOffsets);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest,
                            CalculateWordStartsOffsetsUnderscore);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, HugeResultSet);
+  FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, PreviousCandidatesReuse);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, ReadVisitsFromHistory);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, RebuildFromHistoryIfCacheOld);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, Scoring);
@@ -202,6 +218,11 @@ class URLIndexPrivateData
   };
   typedef std::map<base::string16, SearchTermCacheItem> SearchTermCacheMap;
 
+  // The words extracted from one search string, along with the untrimmed
+  // candidates that HistoryIDsFromWords() found for them.
+  typedef std::pair<String16Vector, HistoryIDVector> SearchCandidates;
+  typedef std::vector<SearchCandidates> SearchCandidatesList;
+
   // A helper predicate class used to filter excess history items when the
   // candidate results set is too large.
   class HistoryItemFactorGreater {
@@ -221,6 +242,15 @@ class URLIndexPrivateData
   // in |unsorted_words|.
   HistoryIDVector HistoryIDsFromWords(const String16Vector& unsorted_words);
 
+  // When |lower_words| extends the words of one of the previous search
+  // strings, i.e. it has at least as many words and each previous word is a
+  // prefix of the word in the same position, fills in |history_ids| by
+  // narrowing down that search's candidates with the new or changed words and
+  // returns true. The result is the same as that of HistoryIDsFromWords().
+  // Returns false if there is no such previous search.
+  bool HistoryIDsFromPreviousCandidates(const String16Vector& lower_words,
+                                        HistoryIDVector* history_ids);
+
   // Trims the candidate pool in advance of doing proper substring searching, to
   // cap the cost of such searching. Discards the least-relevant items (based on
   // visit stats), which are least likely to score highly in the end.  To
@@ -237,9 +267,11 @@ class URLIndexPrivateData
   WordIDSet WordIDSetForTermChars(const Char16Set& term_chars);
 
   // Helper function for HistoryItemsForTerms().  Fills in |scored_items| from
-  // the matches listed in |history_ids|.
+  // the matches listed in |history_ids|. Matches which cannot rank among the
+  // best |max_matches| of |scored_items| may be left out.
   void HistoryIdsToScoredMatches(HistoryIDVector history_ids,
                                  const base::string16& lower_raw_string,
+                                 size_t max_matches,
                                  const TemplateURLService* template_url_service,
                                  bookmarks::BookmarkModel* bookmark_model,
                                  ScoredHistoryMatches* scored_items) const;
@@ -286,6 +318,22 @@ class URLIndexPrivateData
   // Clears |used_| for each item in the search term cache.
   void ResetSearchTermCache();
 
+  // Returns the number of slots in the word list, whether the index is held
+  // in |flat_data_| or in the maps.
+  size_t WordListSize() const;
+
+  // Returns the word for |word_id| from |flat_data_| or |word_list_|.
+  base::StringPiece16 WordForID(WordID word_id) const;
+
+  // If the word index is still held in |flat_data_|, decodes it into the
+  // word maps and releases it. Must be called before the index is modified.
+  void MaterializeFlatData();
+
+  // Writes the word index to |file_path| as a URLIndexFlatData and sets
+  // |token| to the value identifying it. Called by SaveToFile.
+  bool SaveFlatDataToFile(const base::FilePath& file_path,
+                          uint64_t* token) const;
+
   // Caches the index private data and writes the cache file to the profile
   // directory.  Called by WritePrivateDataToCacheFileTask.
   bool SaveToFile(const base::FilePath& file_path);
@@ -335,6 +383,11 @@ class URLIndexPrivateData
   // Cache of search terms.
   SearchTermCacheMap search_term_cache_;
 
+  // The candidates found by the most recent HistoryItemsForTerms() call, one
+  // entry per distinct list of search words. Like |search_term_cache_| this is
+  // invalidated whenever the index changes.
+  SearchCandidatesList previous_candidates_;
+
   // Start of data members that are cached -------------------------------------
 
   // The version of the cache file most recently used to restore this instance
@@ -385,6 +438,14 @@ class URLIndexPrivateData
   // item's URL and page title.
   WordStartsMap word_starts_map_;
 
+  // When restored from a version 6 or later cache file, the word index
+  // (|word_list_|, |word_map_|, |char_word_map_|, |word_id_history_map_| and
+  // |history_id_word_map_|) is not decoded but queried in place from this
+  // memory-mapped file. The maps are left empty until the first modification
+  // of the index, at which point MaterializeFlatData() fills them in and this
+  // is reset. It is immutable, so it is shared by Duplicate() copies.
+  scoped_refptr<URLIndexFlatData> flat_data_;
+
   // End of data members that are cached ---------------------------------------
 
   // For unit testing only. Specifies the version of the cache file to be saved.
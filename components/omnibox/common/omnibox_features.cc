@@ -287,6 +287,12 @@ const base::Feature kOmniboxDisableInstantExtendedLimit{
 const base::Feature kOmniboxSearchEngineLogo{"OmniboxSearchEngineLogo",
                                              base::FEATURE_DISABLED_BY_DEFAULT};
 
+// Lets AutocompleteController run the matching of the providers that support
+// it on a ThreadPool sequence instead of the UI thread. See
+// AutocompleteProvider::GetBackgroundMatcher().
+const base::Feature kOmniboxParallelProviders{
+    "OmniboxParallelProviders", base::FEATURE_DISABLED_BY_DEFAULT};
+
 // Feature to configure on-focus suggestions provided by ZeroSuggestProvider.
 // This feature's main job is to contain some field trial parameters such as:
 //  - "ZeroSuggestVariant" configures the per-page-classification mode of
@@ -9,7 +9,9 @@
 
 #include "base/base64.h"
 #include "base/bind.h"
+#include "base/files/file.h"
 #include "base/files/file_util.h"
+#include "base/macros.h"
 #include "base/metrics/histogram_functions.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/stl_util.h"
@@ -20,6 +22,7 @@
 #include "components/safe_browsing/proto/webui.pb.h"
 #include "crypto/secure_hash.h"
 #include "crypto/sha2.h"
+#include "third_party/protobuf/src/google/protobuf/io/zero_copy_stream_impl_lite.h"
 
 using base::TimeTicks;
 
@@ -53,6 +56,23 @@ const uint32_t kFileVersion = 9;
 // The maximum store file size, as of today, is about 6MB.
 constexpr size_t kMaxStoreSizeBytes = 50 * 1000 * 1000;
 
+// A HashPrefixDirectory uses at most the first two bytes of the prefixes, and
+// aims for about 16 prefixes per bucket, so that its offsets take at most an
+// eighth of the memory of 4-byte prefixes.
+constexpr int kMaxDirectoryBits = 16;
+constexpr size_t kTargetDirectoryBucketSize = 16;
+
+// Returns the value of the leading |bits| bits of |prefix|.
+uint32_t GetDirectoryBucket(base::StringPiece prefix, int bits) {
+  uint32_t leading_bytes = 0;
+  for (size_t i = 0; i < 2; ++i) {
+    leading_bytes <<= 8;
+    if (i < prefix.size())
+      leading_bytes |= static_cast<uint8_t>(prefix[i]);
+  }
+  return leading_bytes >> (kMaxDirectoryBits - bits);
+}
+
 void RecordEnumWithAndWithoutSuffix(const std::string& metric,
                                     int32_t value,
                                     int32_t maximum,
@@ -127,6 +147,51 @@ void RecordStoreWriteResult(StoreWriteResult result) {
                             STORE_WRITE_RESULT_MAX);
 }
 
+// Reads a store file through the fixed-size buffer of a
+// CopyingInputStreamAdaptor, so that parsing it doesn't need a copy of its
+// whole contents.
+class StoreFileInputStream : public google::protobuf::io::CopyingInputStream {
+ public:
+  explicit StoreFileInputStream(base::File* file) : file_(file) {}
+
+  // google::protobuf::io::CopyingInputStream:
+  int Read(void* buffer, int size) override {
+    return file_->ReadAtCurrentPosNoBestEffort(static_cast<char*>(buffer),
+                                               size);
+  }
+
+ private:
+  base::File* const file_;
+
+  DISALLOW_COPY_AND_ASSIGN(StoreFileInputStream);
+};
+
+// Writes a store file through the fixed-size buffer of a
+// CopyingOutputStreamAdaptor, so that it is never serialized in memory.
+class StoreFileOutputStream
+    : public google::protobuf::io::CopyingOutputStream {
+ public:
+  explicit StoreFileOutputStream(base::File* file) : file_(file) {}
+
+  // google::protobuf::io::CopyingOutputStream:
+  bool Write(const void* buffer, int size) override {
+    if (file_->WriteAtCurrentPos(static_cast<const char*>(buffer), size) !=
+        size) {
+      return false;
+    }
+    bytes_written_ += size;
+    return true;
+  }
+
+  int64_t bytes_written() const { return bytes_written_; }
+
+ private:
+  base::File* const file_;
+  int64_t bytes_written_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(StoreFileOutputStream);
+};
+
 // Returns the name of the temporary file used to buffer data for
 // |filename|.
 const base::FilePath TemporaryFileForFilename(const base::FilePath& filename) {
@@ -139,6 +204,12 @@ using ::google::protobuf::RepeatedField;
 using ::google::protobuf::RepeatedPtrField;
 using ::google::protobuf::int32;
 
+HashPrefixDirectory::HashPrefixDirectory() = default;
+HashPrefixDirectory::HashPrefixDirectory(HashPrefixDirectory&&) = default;
+HashPrefixDirectory& HashPrefixDirectory::operator=(HashPrefixDirectory&&) =
+    default;
+HashPrefixDirectory::~HashPrefixDirectory() = default;
+
 std::ostream& operator<<(std::ostream& os, const V4Store& store) {
   os << store.DebugString();
   return os;
@@ -198,6 +269,7 @@ void V4Store::Destroy(std::unique_ptr<V4Store> v4_store) {
 void V4Store::Reset() {
   expected_checksum_.clear();
   hash_prefix_map_.clear();
+  hash_prefix_directories_.clear();
   state_ = "";
 }
 
@@ -237,11 +309,6 @@ ApplyUpdateResult V4Store::ProcessFullUpdate(
     bool delay_checksum_check) {
   DCHECK(response->has_response_type());
   DCHECK_EQ(ListUpdateResponse::FULL_UPDATE, response->response_type());
-  // TODO(vakh): For a full update, we don't need to process the update in
-  // lexographical order to store it, but we do need to do that for calculating
-  // checksum. It might save some CPU cycles to store the full update as-is and
-  // walk the list of hash prefixes in lexographical order only for checksum
-  // calculation.
   return ProcessUpdate(metric, HashPrefixMap(), response, delay_checksum_check);
 }
 
@@ -281,7 +348,7 @@ ApplyUpdateResult V4Store::ProcessUpdate(
 
   HashPrefixMap hash_prefix_map;
   ApplyUpdateResult apply_update_result = UpdateHashPrefixMapFromAdditions(
-      metric, response->additions(), &hash_prefix_map);
+      metric, response->mutable_additions(), &hash_prefix_map);
   if (apply_update_result != APPLY_UPDATE_SUCCESS) {
     return apply_update_result;
   }
@@ -296,19 +363,21 @@ ApplyUpdateResult V4Store::ProcessUpdate(
     DCHECK(!raw_removals);
     // We delay the checksum check at startup to be able to load the DB
     // quickly. In this case, the |hash_prefix_map_old| should be empty, so just
-    // copy over the |hash_prefix_map|.
-    hash_prefix_map_ = hash_prefix_map;
+    // take the |hash_prefix_map|.
+    hash_prefix_map_ = std::move(hash_prefix_map);
 
     // Calculate the checksum asynchronously later and if it doesn't match,
     // reset the store.
     expected_checksum_ = expected_checksum;
   } else {
-    apply_update_result = MergeUpdate(hash_prefix_map_old, hash_prefix_map,
-                                      raw_removals, expected_checksum);
-    if (apply_update_result != APPLY_UPDATE_SUCCESS) {
-      return apply_update_result;
-    }
+    apply_update_result =
+        MergeUpdate(hash_prefix_map_old, std::move(hash_prefix_map),
+                    raw_removals, expected_checksum);
   }
+  // Even a failed merge has changed |hash_prefix_map_|.
+  BuildHashPrefixDirectories();
+  if (apply_update_result != APPLY_UPDATE_SUCCESS)
+    return apply_update_result;
 
   state_ = response->new_client_state();
   return APPLY_UPDATE_SUCCESS;
@@ -362,18 +431,21 @@ void V4Store::ApplyUpdate(
 
 ApplyUpdateResult V4Store::UpdateHashPrefixMapFromAdditions(
     const std::string& metric,
-    const RepeatedPtrField<ThreatEntrySet>& additions,
+    RepeatedPtrField<ThreatEntrySet>* additions,
     HashPrefixMap* additions_map) {
-  for (const auto& addition : additions) {
+  for (auto& addition : *additions) {
     ApplyUpdateResult apply_update_result = APPLY_UPDATE_SUCCESS;
     const CompressionType compression_type = addition.compression_type();
     if (compression_type == RAW) {
       DCHECK(addition.has_raw_hashes());
       DCHECK(addition.raw_hashes().has_raw_hashes());
 
-      apply_update_result =
-          AddUnlumpedHashes(addition.raw_hashes().prefix_size(),
-                            addition.raw_hashes().raw_hashes(), additions_map);
+      // The additions are not needed once in |additions_map|, so take them
+      // rather than copy them.
+      apply_update_result = AddUnlumpedHashes(
+          addition.raw_hashes().prefix_size(),
+          std::move(*addition.mutable_raw_hashes()->mutable_raw_hashes()),
+          additions_map);
     } else if (compression_type == RICE) {
       DCHECK(addition.has_rice_hashes());
 
@@ -419,11 +491,35 @@ ApplyUpdateResult V4Store::AddUnlumpedHashes(PrefixSize prefix_size,
                            additions_map);
 }
 
+// static
+ApplyUpdateResult V4Store::AddUnlumpedHashes(PrefixSize prefix_size,
+                                             std::string&& raw_hashes,
+                                             HashPrefixMap* additions_map) {
+  ApplyUpdateResult result =
+      ValidateUnlumpedHashes(prefix_size, raw_hashes.size());
+  if (result == APPLY_UPDATE_SUCCESS)
+    (*additions_map)[prefix_size] = std::move(raw_hashes);
+  return result;
+}
+
 // static
 ApplyUpdateResult V4Store::AddUnlumpedHashes(PrefixSize prefix_size,
                                              const char* raw_hashes_begin,
                                              const size_t raw_hashes_length,
                                              HashPrefixMap* additions_map) {
+  ApplyUpdateResult result =
+      ValidateUnlumpedHashes(prefix_size, raw_hashes_length);
+  if (result == APPLY_UPDATE_SUCCESS) {
+    (*additions_map)[prefix_size] =
+        std::string(raw_hashes_begin, raw_hashes_begin + raw_hashes_length);
+  }
+  return result;
+}
+
+// static
+ApplyUpdateResult V4Store::ValidateUnlumpedHashes(
+    PrefixSize prefix_size,
+    const size_t raw_hashes_length) {
   if (prefix_size < kMinHashPrefixLength) {
     NOTREACHED();
     return PREFIX_SIZE_TOO_SMALL_FAILURE;
@@ -435,10 +531,6 @@ ApplyUpdateResult V4Store::AddUnlumpedHashes(PrefixSize prefix_size,
   if (raw_hashes_length % prefix_size != 0) {
     return ADDITIONS_SIZE_UNEXPECTED_FAILURE;
   }
-
-  // TODO(vakh): Figure out a way to avoid the following copy operation.
-  (*additions_map)[prefix_size] =
-      std::string(raw_hashes_begin, raw_hashes_begin + raw_hashes_length);
   return APPLY_UPDATE_SUCCESS;
 }
 
@@ -493,7 +585,7 @@ void V4Store::ReserveSpaceInPrefixMap(const HashPrefixMap& other_prefixes_map,
 }
 
 ApplyUpdateResult V4Store::MergeUpdate(const HashPrefixMap& old_prefixes_map,
-                                       const HashPrefixMap& additions_map,
+                                       HashPrefixMap additions_map,
                                        const RepeatedField<int32>* raw_removals,
                                        const std::string& expected_checksum) {
   DCHECK(task_runner_->RunsTasksInCurrentSequence());
@@ -505,6 +597,28 @@ ApplyUpdateResult V4Store::MergeUpdate(const HashPrefixMap& old_prefixes_map,
     return CHECKSUM_MISMATCH_FAILURE;
   }
 
+  std::unique_ptr<crypto::SecureHash> checksum_ctx(
+      crypto::SecureHash::Create(crypto::SecureHash::SHA256));
+
+  if (old_prefixes_map.empty() && (!raw_removals || raw_removals->empty())) {
+    // There is nothing to merge the additions with, so they are the new lists
+    // as they are. Only walk them in lexographically sorted order to calculate
+    // the checksum, rather than building a merged copy.
+    if (calculate_checksum) {
+      IteratorMap iterator_map;
+      HashPrefix next_smallest_prefix;
+      InitializeIteratorMap(additions_map, &iterator_map);
+      while (GetNextSmallestUnmergedPrefix(additions_map, iterator_map,
+                                           &next_smallest_prefix)) {
+        const PrefixSize prefix_size = next_smallest_prefix.size();
+        checksum_ctx->Update(next_smallest_prefix.data(), prefix_size);
+        iterator_map[prefix_size] += prefix_size;
+      }
+    }
+    hash_prefix_map_ = std::move(additions_map);
+    return CheckMergedChecksum(checksum_ctx.get(), expected_checksum);
+  }
+
   hash_prefix_map_.clear();
   ReserveSpaceInPrefixMap(old_prefixes_map, &hash_prefix_map_);
   ReserveSpaceInPrefixMap(additions_map, &hash_prefix_map_);
@@ -526,9 +640,6 @@ ApplyUpdateResult V4Store::MergeUpdate(const HashPrefixMap& old_prefixes_map,
   // At least one of the maps still has elements that need to be merged into the
   // new store.
 
-  std::unique_ptr<crypto::SecureHash> checksum_ctx(
-      crypto::SecureHash::Create(crypto::SecureHash::SHA256));
-
   // Keep track of the number of elements picked from the old map. This is used
   // to determine which elements to drop based on the raw_removals. Note that
   // picked is not the same as merged. A picked element isn't merged if its
@@ -605,22 +716,29 @@ ApplyUpdateResult V4Store::MergeUpdate(const HashPrefixMap& old_prefixes_map,
     return REMOVALS_INDEX_TOO_LARGE_FAILURE;
   }
 
-  if (calculate_checksum) {
-    char checksum[crypto::kSHA256Length];
-    checksum_ctx->Finish(checksum, sizeof(checksum));
-    for (size_t i = 0; i < crypto::kSHA256Length; i++) {
-      if (checksum[i] != expected_checksum[i]) {
+  return CheckMergedChecksum(checksum_ctx.get(), expected_checksum);
+}
+
+ApplyUpdateResult V4Store::CheckMergedChecksum(
+    crypto::SecureHash* checksum_ctx,
+    const std::string& expected_checksum) const {
+  if (expected_checksum.empty())
+    return APPLY_UPDATE_SUCCESS;
+
+  char checksum[crypto::kSHA256Length];
+  checksum_ctx->Finish(checksum, sizeof(checksum));
+  for (size_t i = 0; i < crypto::kSHA256Length; i++) {
+    if (checksum[i] != expected_checksum[i]) {
 #if DCHECK_IS_ON()
-        std::string checksum_b64, expected_checksum_b64;
-        base::Base64Encode(base::StringPiece(checksum, base::size(checksum)),
-                           &checksum_b64);
-        base::Base64Encode(expected_checksum, &expected_checksum_b64);
-        DVLOG(1) << "Failure: Checksum mismatch: calculated: " << checksum_b64
-                 << "; expected: " << expected_checksum_b64
-                 << "; store: " << *this;
+      std::string checksum_b64, expected_checksum_b64;
+      base::Base64Encode(base::StringPiece(checksum, base::size(checksum)),
+                         &checksum_b64);
+      base::Base64Encode(expected_checksum, &expected_checksum_b64);
+      DVLOG(1) << "Failure: Checksum mismatch: calculated: " << checksum_b64
+               << "; expected: " << expected_checksum_b64
+               << "; store: " << *this;
 #endif
-        return CHECKSUM_MISMATCH_FAILURE;
-      }
+      return CHECKSUM_MISMATCH_FAILURE;
     }
   }
 
@@ -633,22 +751,29 @@ StoreReadResult V4Store::ReadFromDisk() {
   V4StoreFileFormat file_format;
   int64_t file_size;
   {
-    // A temporary scope to make sure that |contents| get destroyed as soon as
-    // we are doing using it.
-    std::string contents;
-    if (!base::ReadFileToStringWithMaxSize(store_path_, &contents,
-                                           kMaxStoreSizeBytes)) {
+    // A temporary scope to make sure that |file| is closed as soon as we are
+    // done reading it. The file is parsed as it is read, rather than read into
+    // memory first, so that it is never held twice.
+    base::File file(store_path_, base::File::FLAG_OPEN | base::File::FLAG_READ);
+    if (!file.IsValid()) {
       return FILE_UNREADABLE_FAILURE;
     }
 
-    if (contents.empty()) {
+    file_size = file.GetLength();
+    if (file_size < 0 ||
+        static_cast<uint64_t>(file_size) > kMaxStoreSizeBytes) {
+      return FILE_UNREADABLE_FAILURE;
+    }
+
+    if (file_size == 0) {
       return FILE_EMPTY_FAILURE;
     }
 
-    if (!file_format.ParseFromString(contents)) {
+    StoreFileInputStream input_stream(&file);
+    google::protobuf::io::CopyingInputStreamAdaptor input(&input_stream);
+    if (!file_format.ParseFromZeroCopyStream(&input)) {
       return PROTO_PARSING_FAILURE;
     }
-    file_size = static_cast<int64_t>(contents.size());
   }
 
   if (file_format.magic_number() != kFileMagic) {
@@ -671,6 +796,7 @@ StoreReadResult V4Store::ReadFromDisk() {
   last_apply_update_result_ = apply_update_result;
   if (apply_update_result != APPLY_UPDATE_SUCCESS) {
     hash_prefix_map_.clear();
+    hash_prefix_directories_.clear();
     return HASH_PREFIX_MAP_GENERATION_FAILURE;
   }
 
@@ -686,14 +812,16 @@ StoreWriteResult V4Store::WriteToDisk(const Checksum& checksum) {
   *(lur->mutable_checksum()) = checksum;
   lur->set_new_client_state(state_);
   lur->set_response_type(ListUpdateResponse::FULL_UPDATE);
-  for (const auto& entry : hash_prefix_map_) {
+  for (auto& entry : hash_prefix_map_) {
     ThreatEntrySet* additions = lur->add_additions();
     // TODO(vakh): Write RICE encoded hash prefixes on disk. Not doing so
     // currently since it takes a long time to decode them on startup, which
     // blocks resource load. See: http://crbug.com/654819
     additions->set_compression_type(RAW);
     additions->mutable_raw_hashes()->set_prefix_size(entry.first);
-    additions->mutable_raw_hashes()->set_raw_hashes(entry.second);
+    // Lend the hash prefixes to the proto rather than copy them. They are
+    // given back once the file is written.
+    additions->mutable_raw_hashes()->mutable_raw_hashes()->swap(entry.second);
   }
 
   // Attempt writing to a temporary file first and at the end, swap the files.
@@ -701,12 +829,27 @@ StoreWriteResult V4Store::WriteToDisk(const Checksum& checksum) {
 
   file_format.set_magic_number(kFileMagic);
   file_format.set_version_number(kFileVersion);
-  std::string file_format_string;
-  file_format.SerializeToString(&file_format_string);
-  size_t written = base::WriteFile(new_filename, file_format_string.data(),
-                                   file_format_string.size());
+  const int64_t expected_size =
+      static_cast<int64_t>(file_format.ByteSizeLong());
+  int64_t written = 0;
+  {
+    // Close |file| before moving it.
+    base::File file(new_filename,
+                    base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+    if (file.IsValid()) {
+      StoreFileOutputStream output_stream(&file);
+      google::protobuf::io::CopyingOutputStreamAdaptor output(&output_stream);
+      if (file_format.SerializeToZeroCopyStream(&output) && output.Flush())
+        written = output_stream.bytes_written();
+    }
+  }
+
+  for (auto& additions : *lur->mutable_additions()) {
+    hash_prefix_map_[additions.raw_hashes().prefix_size()].swap(
+        *additions.mutable_raw_hashes()->mutable_raw_hashes());
+  }
 
-  if (file_format_string.size() != written) {
+  if (expected_size != written) {
     base::DeleteFile(new_filename, /*recursive=*/false);
     return UNEXPECTED_BYTES_WRITTEN_FAILURE;
   }
@@ -717,7 +860,7 @@ StoreWriteResult V4Store::WriteToDisk(const Checksum& checksum) {
   }
 
   // Update |file_size_| now because we wrote the file correctly.
-  file_size_ = static_cast<int64_t>(written);
+  file_size_ = written;
 
   return WRITE_SUCCESS;
 }
@@ -732,10 +875,25 @@ HashPrefix V4Store::GetMatchingHashPrefix(base::StringPiece full_hash) {
   // It does not guarantee which one of those will be returned.
   DCHECK(full_hash.size() == 32u || full_hash.size() == 21u);
   checks_attempted_++;
+  DCHECK_EQ(hash_prefix_map_.size(), hash_prefix_directories_.size());
   for (const auto& pair : hash_prefix_map_) {
     const PrefixSize& prefix_size = pair.first;
     base::StringPiece hash_prefix = full_hash.substr(0, prefix_size);
-    if (HashPrefixMatches(hash_prefix, pair.second, prefix_size))
+    // The directories are rebuilt whenever |hash_prefix_map_| changes. Should
+    // one be missing or out of date anyway, the whole list is searched.
+    auto directory = hash_prefix_directories_.find(prefix_size);
+    const bool has_directory =
+        directory != hash_prefix_directories_.end() &&
+        directory->second.offsets.back() == pair.second.size() / prefix_size;
+    DCHECK(has_directory);
+    bool matches;
+    if (has_directory) {
+      matches = HashPrefixMatches(hash_prefix, pair.second, prefix_size,
+                                  directory->second);
+    } else {
+      matches = HashPrefixMatches(hash_prefix, pair.second, prefix_size);
+    }
+    if (matches)
       return hash_prefix.as_string();
   }
   return HashPrefix();
@@ -749,6 +907,50 @@ bool V4Store::HashPrefixMatches(base::StringPiece prefix,
       PrefixIterator(prefixes, prefixes.size() / size, size), prefix);
 }
 
+bool V4Store::HashPrefixMatches(base::StringPiece prefix,
+                                const HashPrefixes& prefixes,
+                                const PrefixSize& size,
+                                const HashPrefixDirectory& directory) {
+  const uint32_t bucket = GetDirectoryBucket(prefix, directory.bits);
+  return std::binary_search(
+      PrefixIterator(prefixes, directory.offsets[bucket], size),
+      PrefixIterator(prefixes, directory.offsets[bucket + 1], size), prefix);
+}
+
+// static
+HashPrefixDirectory V4Store::BuildHashPrefixDirectory(
+    const HashPrefixes& prefixes,
+    const PrefixSize& size) {
+  const size_t count = prefixes.size() / size;
+  HashPrefixDirectory directory;
+  while (directory.bits < kMaxDirectoryBits &&
+         (count >> directory.bits) > kTargetDirectoryBucketSize) {
+    ++directory.bits;
+  }
+
+  // Count the prefixes in each bucket, then turn the counts into offsets. The
+  // prefixes are sorted, so the buckets are in order.
+  directory.offsets.assign((size_t{1} << directory.bits) + 1, 0);
+  base::StringPiece prefixes_piece(prefixes);
+  for (size_t i = 0; i < count; ++i) {
+    ++directory.offsets[GetDirectoryBucket(
+                            prefixes_piece.substr(i * size, size),
+                            directory.bits) +
+                        1];
+  }
+  for (size_t i = 1; i < directory.offsets.size(); ++i)
+    directory.offsets[i] += directory.offsets[i - 1];
+  return directory;
+}
+
+void V4Store::BuildHashPrefixDirectories() {
+  hash_prefix_directories_.clear();
+  for (const auto& entry : hash_prefix_map_) {
+    hash_prefix_directories_[entry.first] =
+        BuildHashPrefixDirectory(entry.second, entry.first);
+  }
+}
+
 bool V4Store::VerifyChecksum() {
   DCHECK(task_runner_->RunsTasksInCurrentSequence());
 
@@ -7,9 +7,12 @@
 #ifndef COMPONENTS_SAFE_BROWSING_DB_V4_STORE_H_
 #define COMPONENTS_SAFE_BROWSING_DB_V4_STORE_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
@@ -18,6 +21,10 @@
 #include "components/safe_browsing/db/v4_protocol_manager_util.h"
 #include "components/safe_browsing/proto/webui.pb.h"
 
+namespace crypto {
+class SecureHash;
+}
+
 namespace safe_browsing {
 
 class V4Store;
@@ -39,6 +46,26 @@ using HashPrefixMap = std::unordered_map<PrefixSize, HashPrefixes>;
 using IteratorMap =
     std::unordered_map<PrefixSize, HashPrefixes::const_iterator>;
 
+// Splits a list of sorted hash prefixes into buckets by their leading |bits|
+// bits: the prefixes whose leading bits have the value b are those at indices
+// [offsets[b], offsets[b + 1]). Hash prefixes are uniformly distributed, so a
+// lookup only has to binary search a few prefixes, which usually share a cache
+// line, rather than the whole list.
+struct HashPrefixDirectory {
+  HashPrefixDirectory();
+  HashPrefixDirectory(HashPrefixDirectory&&);
+  HashPrefixDirectory& operator=(HashPrefixDirectory&&);
+  ~HashPrefixDirectory();
+
+  int bits = 0;
+  // Has 2^bits + 1 entries. The last one is the number of prefixes.
+  std::vector<uint32_t> offsets;
+};
+
+// Stores the directory of the hash prefixes of each size in a HashPrefixMap.
+using HashPrefixDirectoryMap =
+    std::unordered_map<PrefixSize, HashPrefixDirectory>;
+
 // Enumerate different failure events while parsing the file read from disk for
 // histogramming purposes.  DO NOT CHANGE THE ORDERING OF THESE VALUES.
 enum StoreReadResult {
@@ -224,8 +251,18 @@ class V4Store {
       const std::string& base_metric);
 
  protected:
+  // Rebuilds |hash_prefix_directories_| from |hash_prefix_map_|. Must be
+  // called whenever |hash_prefix_map_| changes.
+  void BuildHashPrefixDirectories();
+
   HashPrefixMap hash_prefix_map_;
 
+  // Speeds up the lookups in |hash_prefix_map_|. Not persisted, since building
+  // it is a single pass over the prefixes. Lookups always go through it, so it
+  // must be rebuilt, or cleared along with the map, whenever
+  // |hash_prefix_map_| changes.
+  HashPrefixDirectoryMap hash_prefix_directories_;
+
  private:
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest, TestReadFromEmptyFile);
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest, TestReadFromAbsentFile);
@@ -273,6 +310,7 @@ class V4Store {
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest,
                            TestHashPrefixExistsAtTheBeginningOfEven);
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest, TestHashPrefixExistsAtTheEndOfEven);
+  FRIEND_TEST_ALL_PREFIXES(V4StoreTest, TestHashPrefixDirectoryLookups);
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest,
                            TestHashPrefixDoesNotExistInConcatenatedList);
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest, TestFullHashExistsInMapWithSingleSize);
@@ -290,10 +328,12 @@ class V4Store {
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest, TestAdditionsWithRiceEncodingSucceeds);
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest, TestRemovalsWithRiceEncodingSucceeds);
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest, TestMergeUpdatesFailsChecksum);
+  FRIEND_TEST_ALL_PREFIXES(V4StoreTest, TestMergeUpdatesWithoutOldPrefixes);
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest, TestChecksumErrorOnStartup);
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest, WriteToDiskFails);
   FRIEND_TEST_ALL_PREFIXES(V4StoreTest, FullUpdateFailsChecksumSynchronously);
   FRIEND_TEST_ALL_PREFIXES(V4StorePerftest, StressTest);
+  FRIEND_TEST_ALL_PREFIXES(V4StorePerftest, DirectoryVsBinarySearch);
 
   friend class V4StoreTest;
   friend class V4StoreFuzzer;
@@ -313,6 +353,18 @@ class V4Store {
                                              const std::string& raw_hashes,
                                              HashPrefixMap* additions_map);
 
+  // An overloaded version of AddUnlumpedHashes that takes |raw_hashes| rather
+  // than copying them.
+  static ApplyUpdateResult AddUnlumpedHashes(PrefixSize prefix_size,
+                                             std::string&& raw_hashes,
+                                             HashPrefixMap* additions_map);
+
+  // Returns whether |raw_hashes_length| bytes of hash prefixes of size
+  // |prefix_size| can be added by AddUnlumpedHashes, and why not otherwise.
+  static ApplyUpdateResult ValidateUnlumpedHashes(
+      PrefixSize prefix_size,
+      const size_t raw_hashes_length);
+
   // Get the next unmerged hash prefix in dictionary order from
   // |hash_prefix_map|. |iterator_map| is used to determine which hash prefixes
   // have been merged already. Returns true if there are any unmerged hash
@@ -328,6 +380,18 @@ class V4Store {
                                 const HashPrefixes& prefixes,
                                 const PrefixSize& size);
 
+  // Same as above, but only searches the bucket of |directory| that |prefix|
+  // falls in. |directory| must have been built for |prefixes|.
+  static bool HashPrefixMatches(base::StringPiece prefix,
+                                const HashPrefixes& prefixes,
+                                const PrefixSize& size,
+                                const HashPrefixDirectory& directory);
+
+  // Returns the directory of |prefixes| of PrefixSize |size|.
+  static HashPrefixDirectory BuildHashPrefixDirectory(
+      const HashPrefixes& prefixes,
+      const PrefixSize& size);
+
   // For each key in |hash_prefix_map|, sets the iterator at that key
   // |iterator_map| to hash_prefix_map[key].begin().
   static void InitializeIteratorMap(const HashPrefixMap& hash_prefix_map,
@@ -350,14 +414,23 @@ class V4Store {
   // The indices in the |raw_removals| list, which may be NULL, are not merged.
   // The SHA256 checksum of the final list of hash prefixes, in
   // lexicographically sorted order, must match |expected_checksum| (if it's not
-  // empty).
+  // empty). When there is nothing to merge |additions_map| with, as for a
+  // FULL_UPDATE, it becomes the prefix map of the store without being copied,
+  // and is only walked in sorted order to calculate the checksum.
   ApplyUpdateResult MergeUpdate(
       const HashPrefixMap& old_hash_prefix_map,
-      const HashPrefixMap& additions_map,
+      HashPrefixMap additions_map,
       const ::google::protobuf::RepeatedField<::google::protobuf::int32>*
           raw_removals,
       const std::string& expected_checksum);
 
+  // Returns CHECKSUM_MISMATCH_FAILURE if |expected_checksum| is not empty and
+  // doesn't match the checksum of the prefixes given to |checksum_ctx|, which
+  // it finishes.
+  ApplyUpdateResult CheckMergedChecksum(
+      crypto::SecureHash* checksum_ctx,
+      const std::string& expected_checksum) const;
+
   // Processes the FULL_UPDATE |response| from the server, and writes the
   // merged V4Store to disk. If processing the |response| succeeds, it returns
   // APPLY_UPDATE_SUCCESS. The UMA metrics for all interesting sub-operations
@@ -405,15 +478,17 @@ class V4Store {
   StoreReadResult ReadFromDisk();
 
   // Updates the |additions_map| with the additions received in the partial
-  // update from the server. The UMA metrics for all interesting sub-operations
-  // use the prefix |metric|.
+  // update from the server. The raw hash prefixes are moved out of |additions|
+  // rather than copied. The UMA metrics for all interesting sub-operations use
+  // the prefix |metric|.
   ApplyUpdateResult UpdateHashPrefixMapFromAdditions(
       const std::string& metric,
-      const ::google::protobuf::RepeatedPtrField<ThreatEntrySet>& additions,
+      ::google::protobuf::RepeatedPtrField<ThreatEntrySet>* additions,
       HashPrefixMap* additions_map);
 
-  // Writes the hash_prefix_map_ to disk as a V4StoreFileFormat proto.
-  // |checksum| is used to set the |checksum| field in the final proto.
+  // Writes the hash_prefix_map_ to disk as a V4StoreFileFormat proto, streamed
+  // to the file rather than serialized in memory first. |checksum| is used to
+  // set the |checksum| field in the final proto.
   StoreWriteResult WriteToDisk(const Checksum& checksum);
 
   // Records the status of the update being applied to the database.
@@ -66,4 +66,60 @@ TEST_F(V4StorePerftest, StressTest) {
   EXPECT_EQ(kNumPrefixes, matches);
 }
 
+// Compares looking prefixes up through the store's HashPrefixDirectory with
+// binary searching the whole list, for prefixes that are in the list and, as
+// most lookups are, prefixes that aren't.
+TEST_F(V4StorePerftest, DirectoryVsBinarySearch) {
+#if defined(NDEBUG)
+  const size_t kNumPrefixes = 2000000;
+#else
+  const size_t kNumPrefixes = 20000;
+#endif
+
+  std::vector<std::string> prefixes;
+  std::vector<std::string> lookups;
+  for (size_t i = 0; i < 2 * kNumPrefixes; i++) {
+    std::string prefix = crypto::SHA256HashString(base::StringPrintf("%zu", i))
+                             .substr(0, kMinHashPrefixLength);
+    if (i < kNumPrefixes)
+      prefixes.push_back(prefix);
+    lookups.push_back(std::move(prefix));
+  }
+
+  auto store = std::make_unique<TestV4Store>(
+      base::MakeRefCounted<base::TestSimpleTaskRunner>(), base::FilePath());
+  base::ElapsedTimer build_timer;
+  store->SetPrefixes(std::move(prefixes), kMinHashPrefixLength);
+  perf_test::PrintResult("SetPrefixes", "", "",
+                         build_timer.Elapsed().InMillisecondsF(), "ms", true);
+
+  const HashPrefixes& hash_prefixes =
+      store->hash_prefix_map_[kMinHashPrefixLength];
+  const HashPrefixDirectory& directory =
+      store->hash_prefix_directories_[kMinHashPrefixLength];
+
+  size_t binary_search_matches = 0;
+  base::ElapsedTimer binary_search_timer;
+  for (const std::string& prefix : lookups) {
+    binary_search_matches += V4Store::HashPrefixMatches(prefix, hash_prefixes,
+                                                        kMinHashPrefixLength);
+  }
+  perf_test::PrintResult("HashPrefixMatches", "", "binary_search",
+                         binary_search_timer.Elapsed().InMillisecondsF(), "ms",
+                         true);
+
+  size_t directory_matches = 0;
+  base::ElapsedTimer directory_timer;
+  for (const std::string& prefix : lookups) {
+    directory_matches += V4Store::HashPrefixMatches(
+        prefix, hash_prefixes, kMinHashPrefixLength, directory);
+  }
+  perf_test::PrintResult("HashPrefixMatches", "", "directory",
+                         directory_timer.Elapsed().InMillisecondsF(), "ms",
+                         true);
+
+  EXPECT_LE(kNumPrefixes, directory_matches);
+  EXPECT_EQ(binary_search_matches, directory_matches);
+}
+
 }  // namespace safe_browsing
@@ -4,11 +4,17 @@
 
 #include "components/safe_browsing/db/v4_store.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "base/base64.h"
 #include "base/bind.h"
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/run_loop.h"
+#include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/test/test_simple_task_runner.h"
 #include "base/time/time.h"
 #include "components/safe_browsing/db/v4_store.pb.h"
@@ -626,10 +632,45 @@ TEST_F(V4StoreTest, TestHashPrefixDoesNotExistInConcatenatedList) {
   EXPECT_FALSE(V4Store::HashPrefixMatches(hash_prefix, hash_prefixes, 5));
 }
 
+TEST_F(V4StoreTest, TestHashPrefixDirectoryLookups) {
+  // Enough prefixes for the directory to have a few hundred buckets, some of
+  // them empty.
+  std::vector<std::string> prefixes;
+  for (size_t i = 0; i < 5000; i++)
+    prefixes.push_back(crypto::SHA256HashString(base::NumberToString(i))
+                           .substr(0, 4));
+  // Prefixes at the edges of the first and last buckets.
+  prefixes.push_back(std::string(4, '\0'));
+  prefixes.push_back(std::string(4, '\xff'));
+  std::sort(prefixes.begin(), prefixes.end());
+  prefixes.erase(std::unique(prefixes.begin(), prefixes.end()),
+                 prefixes.end());
+  const HashPrefixes hash_prefixes = base::StrCat(prefixes);
+
+  const HashPrefixDirectory directory =
+      V4Store::BuildHashPrefixDirectory(hash_prefixes, 4);
+  EXPECT_GT(directory.bits, 0);
+  ASSERT_EQ((1u << directory.bits) + 1, directory.offsets.size());
+  EXPECT_EQ(0u, directory.offsets.front());
+  EXPECT_EQ(prefixes.size(), directory.offsets.back());
+
+  for (const std::string& prefix : prefixes) {
+    EXPECT_TRUE(
+        V4Store::HashPrefixMatches(prefix, hash_prefixes, 4, directory));
+  }
+  for (size_t i = 5000; i < 10000; i++) {
+    const std::string prefix =
+        crypto::SHA256HashString(base::NumberToString(i)).substr(0, 4);
+    EXPECT_EQ(V4Store::HashPrefixMatches(prefix, hash_prefixes, 4),
+              V4Store::HashPrefixMatches(prefix, hash_prefixes, 4, directory));
+  }
+}
+
 TEST_F(V4StoreTest, TestFullHashExistsInMapWithSingleSize) {
   V4Store store(task_runner_, store_path_);
   store.hash_prefix_map_[32] =
       "0111222233334444555566667777888811112222333344445555666677778888";
+  store.BuildHashPrefixDirectories();
   FullHash full_hash = "11112222333344445555666677778888";
   EXPECT_EQ("11112222333344445555666677778888",
             store.GetMatchingHashPrefix(full_hash));
@@ -639,6 +680,7 @@ TEST_F(V4StoreTest, TestFullHashExistsInMapWithDifferentSizes) {
   V4Store store(task_runner_, store_path_);
   store.hash_prefix_map_[4] = "22223333aaaa";
   store.hash_prefix_map_[32] = "11112222333344445555666677778888";
+  store.BuildHashPrefixDirectories();
   FullHash full_hash = "11112222333344445555666677778888";
   EXPECT_EQ("11112222333344445555666677778888",
             store.GetMatchingHashPrefix(full_hash));
@@ -647,6 +689,7 @@ TEST_F(V4StoreTest, TestFullHashExistsInMapWithDifferentSizes) {
 TEST_F(V4StoreTest, TestHashPrefixExistsInMapWithSingleSize) {
   V4Store store(task_runner_, store_path_);
   store.hash_prefix_map_[4] = "22223333aaaa";
+  store.BuildHashPrefixDirectories();
   FullHash full_hash = "22222222222222222222222222222222";
   EXPECT_EQ("2222", store.GetMatchingHashPrefix(full_hash));
 }
@@ -655,6 +698,7 @@ TEST_F(V4StoreTest, TestHashPrefixExistsInMapWithDifferentSizes) {
   V4Store store(task_runner_, store_path_);
   store.hash_prefix_map_[4] = "22223333aaaa";
   store.hash_prefix_map_[5] = "11111hhhhh";
+  store.BuildHashPrefixDirectories();
   FullHash full_hash = "22222222222222222222222222222222";
   EXPECT_EQ("2222", store.GetMatchingHashPrefix(full_hash));
 }
@@ -663,6 +707,7 @@ TEST_F(V4StoreTest, TestHashPrefixDoesNotExistInMapWithDifferentSizes) {
   V4Store store(task_runner_, store_path_);
   store.hash_prefix_map_[4] = "3333aaaa";
   store.hash_prefix_map_[5] = "11111hhhhh";
+  store.BuildHashPrefixDirectories();
   FullHash full_hash = "22222222222222222222222222222222";
   EXPECT_TRUE(store.GetMatchingHashPrefix(full_hash).empty());
 }
@@ -671,6 +716,7 @@ TEST_F(V4StoreTest, GetMatchingHashPrefixSize32Or21) {
   HashPrefix prefix = "0123";
   V4Store store(task_runner_, store_path_);
   store.hash_prefix_map_[4] = prefix;
+  store.BuildHashPrefixDirectories();
 
   FullHash full_hash_21 = "0123456789ABCDEF01234";
   EXPECT_EQ(prefix, store.GetMatchingHashPrefix(full_hash_21));
@@ -693,7 +739,7 @@ TEST_F(V4StoreTest, TestAdditionsWithRiceEncodingFailsWithInvalidInput) {
   HashPrefixMap additions_map;
   EXPECT_EQ(RICE_DECODING_FAILURE,
             V4Store(task_runner_, store_path_)
-                .UpdateHashPrefixMapFromAdditions("V4Metric", additions,
+                .UpdateHashPrefixMapFromAdditions("V4Metric", &additions,
                                                   &additions_map));
 }
 #endif
@@ -715,7 +761,7 @@ TEST_F(V4StoreTest, TestAdditionsWithRiceEncodingSucceeds) {
   HashPrefixMap additions_map;
   EXPECT_EQ(APPLY_UPDATE_SUCCESS,
             V4Store(task_runner_, store_path_)
-                .UpdateHashPrefixMapFromAdditions("V4Metric", additions,
+                .UpdateHashPrefixMapFromAdditions("V4Metric", &additions,
                                                   &additions_map));
   EXPECT_EQ(1u, additions_map.size());
   EXPECT_EQ(std::string("\x5\0\0\0\fL\x93\xADV\x7F\xF6o\xCEo1\x81", 16),
@@ -792,6 +838,29 @@ TEST_F(V4StoreTest, TestMergeUpdatesFailsChecksum) {
                 .MergeUpdate(prefix_map_old, HashPrefixMap(), nullptr, "aawc"));
 }
 
+TEST_F(V4StoreTest, TestMergeUpdatesWithoutOldPrefixes) {
+  HashPrefixMap prefix_map_additions;
+  EXPECT_EQ(APPLY_UPDATE_SUCCESS,
+            V4Store::AddUnlumpedHashes(4, "----1111bbbb",
+                                       &prefix_map_additions));
+  EXPECT_EQ(APPLY_UPDATE_SUCCESS,
+            V4Store::AddUnlumpedHashes(5, "22222bcdef", &prefix_map_additions));
+  // The checksum is over the prefixes of both sizes, in sorted order.
+  const std::string expected_checksum =
+      crypto::SHA256HashString("----1111" "22222" "bbbb" "bcdef");
+
+  V4Store store(task_runner_, store_path_);
+  EXPECT_EQ(APPLY_UPDATE_SUCCESS,
+            store.MergeUpdate(HashPrefixMap(), prefix_map_additions, nullptr,
+                              expected_checksum));
+  EXPECT_EQ(prefix_map_additions, store.hash_prefix_map_);
+
+  EXPECT_EQ(CHECKSUM_MISMATCH_FAILURE,
+            V4Store(task_runner_, store_path_)
+                .MergeUpdate(HashPrefixMap(), prefix_map_additions, nullptr,
+                             std::string(crypto::kSHA256Length, 0)));
+}
+
 TEST_F(V4StoreTest, TestChecksumErrorOnStartup) {
   // First the case of checksum not matching after reading from disk.
   ListUpdateResponse list_update_response;
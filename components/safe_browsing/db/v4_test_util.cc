@@ -53,6 +53,7 @@ void TestV4Store::MarkPrefixAsBad(HashPrefix prefix) {
   auto& vec = mock_prefixes_[prefix.size()];
   vec.insert(std::upper_bound(vec.begin(), vec.end(), prefix), prefix);
   hash_prefix_map_[prefix.size()] = base::StrCat(vec);
+  BuildHashPrefixDirectories();
 }
 
 void TestV4Store::SetPrefixes(std::vector<HashPrefix> prefixes,
@@ -60,6 +61,7 @@ void TestV4Store::SetPrefixes(std::vector<HashPrefix> prefixes,
   std::sort(prefixes.begin(), prefixes.end());
   mock_prefixes_[size] = prefixes;
   hash_prefix_map_[size] = base::StrCat(prefixes);
+  BuildHashPrefixDirectories();
 }
 
 TestV4Database::TestV4Database(
@@ -45,6 +45,9 @@ void PostOrRunInternalGetCommandsCallback(
 
 }  // namespace
 
+const base::Feature kCompactSessionFile{"CompactSessionFile",
+                                        base::FEATURE_DISABLED_BY_DEFAULT};
+
 // Delay between when a command is received, and when we save it to the
 // backend.
 static const int kSaveDelayMS = 2500;
@@ -148,6 +151,13 @@ void BaseSessionService::Save() {
   }
 }
 
+void BaseSessionService::SetCommandCompactor(
+    const CompactCommandsCallback& compactor) {
+  RunTaskOnBackendThread(
+      FROM_HERE,
+      base::BindOnce(&SessionBackend::SetCompactor, backend_, compactor));
+}
+
 base::CancelableTaskTracker::TaskId
 BaseSessionService::ScheduleGetLastSessionCommands(
     const GetCommandsCallback& callback,
@@ -6,8 +6,10 @@
 #define COMPONENTS_SESSIONS_CORE_BASE_SESSION_SERVICE_H_
 
 #include <memory>
+#include <vector>
 
 #include "base/callback.h"
+#include "base/feature_list.h"
 #include "base/files/file_path.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -24,6 +26,10 @@ class BaseSessionServiceDelegate;
 class SessionCommand;
 class SessionBackend;
 
+// Compacts the session file in the background instead of periodically
+// rewriting it from the open windows.
+SESSIONS_EXPORT extern const base::Feature kCompactSessionFile;
+
 // BaseSessionService is the super class of both tab restore service and
 // session service. It contains commonality needed by both, in particular
 // it manages a set of SessionCommands that are periodically sent to a
@@ -40,6 +46,12 @@ class SESSIONS_EXPORT BaseSessionService {
   typedef base::Callback<void(std::vector<std::unique_ptr<SessionCommand>>)>
       GetCommandsCallback;
 
+  // Returns commands restoring the same state as the given ones, ideally
+  // fewer. Run on the backend sequence.
+  typedef base::RepeatingCallback<std::vector<std::unique_ptr<SessionCommand>>(
+      std::vector<std::unique_ptr<SessionCommand>>)>
+      CompactCommandsCallback;
+
   // Creates a new BaseSessionService. After creation you need to invoke
   // Init. |delegate| will remain owned by the creator and it is guaranteed
   // that its lifetime surpasses this class.
@@ -96,6 +108,10 @@ class SESSIONS_EXPORT BaseSessionService {
   // Passes all pending commands to the backend for saving.
   void Save();
 
+  // Has the backend compact the current session file with |compactor| from
+  // now on. See SessionBackend::SetCompactor().
+  void SetCommandCompactor(const CompactCommandsCallback& compactor);
+
   // Uses the backend to load the last session commands from disc. |callback|
   // gets called once the data has arrived.
   base::CancelableTaskTracker::TaskId ScheduleGetLastSessionCommands(
@@ -5,12 +5,16 @@
 #include "components/sessions/core/session_backend.h"
 
 #include <stdint.h>
+#include <algorithm>
 #include <limits>
+#include <string>
 #include <utility>
 
 #include "base/files/file.h"
+#include "base/feature_list.h"
 #include "base/files/file_util.h"
 #include "base/macros.h"
+#include "base/metrics/crc32.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/threading/thread_restrictions.h"
 #include "build/build_config.h"
@@ -19,8 +23,12 @@ using base::TimeTicks;
 
 namespace sessions {
 
-// File version number.
-static const int32_t kFileCurrentVersion = 1;
+// File version number. Commands in files of version 2 and later are followed
+// by a checksum. Version 2 files are only written when kCompactSessionFile is
+// enabled, as builds before it can't read them.
+static const int32_t kFileVersionWithoutChecksums = 1;
+static const int32_t kFileVersionWithChecksums = 2;
+static const int32_t kFileCurrentVersion = kFileVersionWithChecksums;
 
 // The signature at the beginning of the file = SSNS (Sessions).
 static const int32_t kFileSignature = 0x53534E53;
@@ -38,7 +46,8 @@ struct FileHeader {
 
 // SessionFileReader is responsible for reading the set of SessionCommands that
 // describe a Session back from a file. SessionFileRead does minimal error
-// checking on the file (pretty much only that the header is valid).
+// checking on the file (pretty much only that the header is valid, and that
+// commands match their checksum).
 
 class SessionFileReader {
  public:
@@ -47,12 +56,24 @@ class SessionFileReader {
 
   explicit SessionFileReader(const base::FilePath& path)
       : errored_(false),
+        has_checksums_(false),
         buffer_(SessionBackend::kFileReadBufferSize, 0),
         buffer_position_(0),
         available_count_(0) {
-    file_.reset(new base::File(
+    owned_file_.reset(new base::File(
         path, base::File::FLAG_OPEN | base::File::FLAG_READ));
+    file_ = owned_file_.get();
   }
+
+  // Reads |file| from its beginning. |file| must be open for reading and
+  // outlive the reader.
+  explicit SessionFileReader(base::File* file)
+      : errored_(false),
+        has_checksums_(false),
+        buffer_(SessionBackend::kFileReadBufferSize, 0),
+        file_(file),
+        buffer_position_(0),
+        available_count_(0) {}
   // Reads the contents of the file specified in the constructor, returning
   // true on success, and filling up |commands| with commands.
   bool Read(std::vector<std::unique_ptr<sessions::SessionCommand>>* commands);
@@ -73,11 +94,15 @@ class SessionFileReader {
   // Whether an error condition has been detected (
   bool errored_;
 
+  // Whether each command is followed by its checksum.
+  bool has_checksums_;
+
   // As we read from the file, data goes here.
   std::string buffer_;
 
-  // The file.
-  std::unique_ptr<base::File> file_;
+  // The file, and the file opened by the reader, if it opened one.
+  std::unique_ptr<base::File> owned_file_;
+  base::File* file_;
 
   // Position in buffer_ of the data.
   size_t buffer_position_;
@@ -90,15 +115,16 @@ class SessionFileReader {
 
 bool SessionFileReader::Read(
     std::vector<std::unique_ptr<sessions::SessionCommand>>* commands) {
-  if (!file_->IsValid())
+  if (!file_->IsValid() || file_->Seek(base::File::FROM_BEGIN, 0) != 0)
     return false;
   FileHeader header;
   int read_count;
   read_count = file_->ReadAtCurrentPos(reinterpret_cast<char*>(&header),
                                        sizeof(header));
   if (read_count != sizeof(header) || header.signature != kFileSignature ||
-      header.version != kFileCurrentVersion)
+      header.version < 1 || header.version > kFileCurrentVersion)
     return false;
+  has_checksums_ = header.version >= kFileVersionWithChecksums;
 
   std::vector<std::unique_ptr<sessions::SessionCommand>> read_commands;
   for (std::unique_ptr<sessions::SessionCommand> command = ReadCommand();
@@ -133,16 +159,31 @@ std::unique_ptr<sessions::SessionCommand> SessionFileReader::ReadCommand() {
     return nullptr;
   }
 
-  // Make sure buffer has the complete contents of the command.
-  if (command_size > available_count_) {
-    if (command_size > buffer_.size())
-      buffer_.resize((command_size / 1024 + 1) * 1024, 0);
-    if (!FillBuffer() || command_size > available_count_) {
+  // Make sure buffer has the complete contents of the command, and its
+  // checksum.
+  const size_t record_size =
+      command_size + (has_checksums_ ? sizeof(uint32_t) : 0);
+  if (record_size > available_count_) {
+    if (record_size > buffer_.size())
+      buffer_.resize((record_size / 1024 + 1) * 1024, 0);
+    if (!FillBuffer() || record_size > available_count_) {
       // Again, assume the file was ok, and just the last chunk was lost.
       VLOG(1) << "SessionFileReader::ReadCommand, last chunk lost";
       return nullptr;
     }
   }
+  if (has_checksums_) {
+    uint32_t checksum;
+    memcpy(&checksum, &(buffer_[buffer_position_ + command_size]),
+           sizeof(checksum));
+    if (checksum !=
+        base::Crc32(0, &(buffer_[buffer_position_]), command_size)) {
+      // Nothing after a damaged command can be trusted, not even the sizes,
+      // so keep the commands read so far and stop as if the file ended here.
+      VLOG(1) << "SessionFileReader::ReadCommand, checksum mismatch";
+      return nullptr;
+    }
+  }
   const id_type command_id = buffer_[buffer_position_];
   // NOTE: command_size includes the size of the id, which is not part of
   // the contents of the SessionCommand.
@@ -154,8 +195,8 @@ std::unique_ptr<sessions::SessionCommand> SessionFileReader::ReadCommand() {
            &(buffer_[buffer_position_ + sizeof(id_type)]),
            command_size - sizeof(id_type));
   }
-  buffer_position_ += command_size;
-  available_count_ -= command_size;
+  buffer_position_ += record_size;
+  available_count_ -= record_size;
   return command;
 }
 
@@ -194,13 +235,19 @@ static const char* kLastSessionFileName = "Last Session";
 // static
 const int SessionBackend::kFileReadBufferSize = 1024;
 
+// static
+const int64_t SessionBackend::kMinBytesBeforeCompaction = 64 * 1024;
+
 SessionBackend::SessionBackend(sessions::BaseSessionService::SessionType type,
                                const base::FilePath& path_to_dir)
     : type_(type),
       path_to_dir_(path_to_dir),
       last_session_valid_(false),
       inited_(false),
-      empty_file_(true) {
+      empty_file_(true),
+      write_checksums_(base::FeatureList::IsEnabled(kCompactSessionFile)),
+      compacted_bytes_(0),
+      bytes_since_compaction_(0) {
   // NOTE: this is invoked on the main thread, don't do file access here.
 }
 
@@ -227,11 +274,24 @@ void SessionBackend::AppendCommands(
     ResetFile();
   }
   // Need to check current_session_file_ again, ResetFile may fail.
+  int64_t bytes_written = 0;
   if (current_session_file_.get() && current_session_file_->IsValid() &&
-      !AppendCommandsToFile(current_session_file_.get(), commands)) {
+      !AppendCommandsToFile(current_session_file_.get(), commands,
+                            &bytes_written)) {
     current_session_file_.reset(nullptr);
   }
   empty_file_ = false;
+
+  // A reset rewrites the whole session, which is as compact as it gets.
+  if (reset_first)
+    compacted_bytes_ += bytes_written;
+  else
+    bytes_since_compaction_ += bytes_written;
+  if (compactor_ &&
+      bytes_since_compaction_ >=
+          std::max(kMinBytesBeforeCompaction, compacted_bytes_)) {
+    CompactCurrentFile();
+  }
 }
 
 void SessionBackend::ReadLastSessionCommands(
@@ -284,35 +344,82 @@ bool SessionBackend::ReadCurrentSessionCommandsImpl(
   return file_reader.Read(commands);
 }
 
+void SessionBackend::SetCompactor(
+    const sessions::BaseSessionService::CompactCommandsCallback& compactor) {
+  compactor_ = compactor;
+}
+
+bool SessionBackend::CompactCurrentFile() {
+  Init();
+  if (!compactor_ || !current_session_file_ ||
+      !current_session_file_->IsValid()) {
+    return false;
+  }
+
+  // Whatever happens, the file is not compacted again before it grows as much
+  // again, so that a file that can't be compacted isn't read on every append.
+  compacted_bytes_ += bytes_since_compaction_;
+  bytes_since_compaction_ = 0;
+
+  // The file is read and rewritten through the open handle. As in
+  // ResetFile(), it is not closed, so that scanners can't lock it out from
+  // under us. If reading fails, the file is left as it was.
+  std::vector<std::unique_ptr<sessions::SessionCommand>> commands;
+  if (!SessionFileReader(current_session_file_.get()).Read(&commands)) {
+    current_session_file_->Seek(base::File::FROM_END, 0);
+    return false;
+  }
+  commands = compactor_.Run(std::move(commands));
+
+  const int header_size = static_cast<int>(sizeof(FileHeader));
+  int64_t bytes_written = 0;
+  if (current_session_file_->Seek(base::File::FROM_BEGIN, header_size) !=
+          header_size ||
+      !AppendCommandsToFile(current_session_file_.get(), commands,
+                            &bytes_written) ||
+      !current_session_file_->SetLength(header_size + bytes_written)) {
+    // The file may be partially rewritten. As when appending fails, it is
+    // recreated by the next append.
+    current_session_file_.reset(nullptr);
+    return false;
+  }
+  compacted_bytes_ = bytes_written;
+  return true;
+}
+
 bool SessionBackend::AppendCommandsToFile(
     base::File* file,
-    const std::vector<std::unique_ptr<sessions::SessionCommand>>& commands) {
+    const std::vector<std::unique_ptr<sessions::SessionCommand>>& commands,
+    int64_t* bytes_written) {
+  // Write all the commands at once, each followed by the checksum of its id
+  // and contents if the file has checksums.
+  std::string data;
   for (auto i = commands.begin(); i != commands.end(); ++i) {
-    int wrote;
     const size_type content_size = static_cast<size_type>((*i)->size());
     const size_type total_size =  content_size + sizeof(id_type);
-    wrote = file->WriteAtCurrentPos(reinterpret_cast<const char*>(&total_size),
-                                    sizeof(total_size));
-    if (wrote != sizeof(total_size)) {
-      NOTREACHED() << "error writing";
-      return false;
-    }
+    data.append(reinterpret_cast<const char*>(&total_size),
+                sizeof(total_size));
+    const size_t command_start = data.size();
     id_type command_id = (*i)->id();
-    wrote = file->WriteAtCurrentPos(reinterpret_cast<char*>(&command_id),
-                                    sizeof(command_id));
-    if (wrote != sizeof(command_id)) {
+    data.append(reinterpret_cast<const char*>(&command_id),
+                sizeof(command_id));
+    if (content_size > 0)
+      data.append((*i)->contents(), content_size);
+    if (write_checksums_) {
+      const uint32_t checksum =
+          base::Crc32(0, data.data() + command_start, total_size);
+      data.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    }
+  }
+  if (!data.empty()) {
+    int wrote = file->WriteAtCurrentPos(data.data(),
+                                        static_cast<int>(data.size()));
+    if (wrote != static_cast<int>(data.size())) {
       NOTREACHED() << "error writing";
       return false;
     }
-    if (content_size > 0) {
-      wrote = file->WriteAtCurrentPos(reinterpret_cast<char*>((*i)->contents()),
-                                      content_size);
-      if (wrote != content_size) {
-        NOTREACHED() << "error writing";
-        return false;
-      }
-    }
   }
+  *bytes_written += static_cast<int64_t>(data.size());
 #if defined(OS_CHROMEOS)
   file->Flush();
 #endif
@@ -344,19 +451,22 @@ void SessionBackend::ResetFile() {
   if (!current_session_file_)
     current_session_file_.reset(OpenAndWriteHeader(GetCurrentSessionPath()));
   empty_file_ = true;
+  compacted_bytes_ = 0;
+  bytes_since_compaction_ = 0;
 }
 
 base::File* SessionBackend::OpenAndWriteHeader(const base::FilePath& path) {
   DCHECK(!path.empty());
   std::unique_ptr<base::File> file(new base::File(
-      path, base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE |
-                base::File::FLAG_EXCLUSIVE_WRITE |
+      path, base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_READ |
+                base::File::FLAG_WRITE | base::File::FLAG_EXCLUSIVE_WRITE |
                 base::File::FLAG_EXCLUSIVE_READ));
   if (!file->IsValid())
     return nullptr;
   FileHeader header;
   header.signature = kFileSignature;
-  header.version = kFileCurrentVersion;
+  header.version = write_checksums_ ? kFileVersionWithChecksums
+                                    : kFileVersionWithoutChecksums;
   int wrote = file->WriteAtCurrentPos(reinterpret_cast<char*>(&header),
                                       sizeof(header));
   if (wrote != sizeof(header))
@@ -6,6 +6,7 @@
 #define COMPONENTS_SESSIONS_CORE_SESSION_BACKEND_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <memory>
 #include <vector>
@@ -34,7 +35,13 @@ namespace sessions {
 // Each file contains an arbitrary set of commands supplied from
 // BaseSessionService. A command consists of a unique id and a stream of bytes.
 // SessionBackend does not use the id in anyway, that is used by
-// BaseSessionService.
+// BaseSessionService. When kCompactSessionFile is enabled, each command is
+// followed by a checksum, and reading a file stops at the first command that
+// doesn't match its checksum. Files with and without checksums are both read.
+//
+// The current file is append only. If a compactor is set, the current file is
+// periodically rewritten to the compacted commands, on the backend sequence,
+// once the commands appended since it was last compacted outgrow it.
 class SESSIONS_EXPORT SessionBackend
     : public base::RefCountedThreadSafe<SessionBackend> {
  public:
@@ -45,6 +52,11 @@ class SESSIONS_EXPORT SessionBackend
   // for testing.
   static const int kFileReadBufferSize;
 
+  // Number of bytes that must be appended to the current file before it is
+  // compacted, however small the compacted file is. This is exposed for
+  // testing.
+  static const int64_t kMinBytesBeforeCompaction;
+
   // Creates a SessionBackend. This method is invoked on the MAIN thread,
   // and does no IO. The real work is done from Init, which is invoked on
   // the file thread.
@@ -95,6 +107,20 @@ class SESSIONS_EXPORT SessionBackend
   bool ReadCurrentSessionCommandsImpl(
       std::vector<std::unique_ptr<sessions::SessionCommand>>* commands);
 
+  // Sets the callback the current file is compacted with. The current file is
+  // compacted whenever the bytes appended since the last compaction (or reset)
+  // reach the size the file had then, so that, however long the session,
+  // the bytes written stay proportional to the bytes appended.
+  void SetCompactor(
+      const sessions::BaseSessionService::CompactCommandsCallback& compactor);
+
+  // Rewrites the current file with its commands run through the compactor,
+  // through the open file, as a reset rewrites it. Returns false if there is
+  // no compactor or the file couldn't be compacted. If the file couldn't be
+  // read it is left as it was; if it couldn't be rewritten it is recreated by
+  // the next AppendCommands(), as when appending fails.
+  bool CompactCurrentFile();
+
  private:
   friend class base::RefCountedThreadSafe<SessionBackend>;
 
@@ -109,13 +135,16 @@ class SESSIONS_EXPORT SessionBackend
   void ResetFile();
 
   // Opens the current file and writes the header. On success a handle to
-  // the file is returned.
+  // the file is returned. The file is also open for reading, so that it can
+  // be compacted without being closed.
   base::File* OpenAndWriteHeader(const base::FilePath& path);
 
-  // Appends the specified commands to the specified file.
+  // Appends the specified commands to the specified file, adding the number
+  // of bytes written to |bytes_written|.
   bool AppendCommandsToFile(
       base::File* file,
-      const std::vector<std::unique_ptr<sessions::SessionCommand>>& commands);
+      const std::vector<std::unique_ptr<sessions::SessionCommand>>& commands,
+      int64_t* bytes_written);
 
   const sessions::BaseSessionService::SessionType type_;
 
@@ -141,6 +170,17 @@ class SESSIONS_EXPORT SessionBackend
   // If true, the file is empty (no commands have been added to it).
   bool empty_file_;
 
+  // Whether commands are written with checksums, in a file of the version
+  // that has them. Older builds can't read such files.
+  const bool write_checksums_;
+
+  sessions::BaseSessionService::CompactCommandsCallback compactor_;
+
+  // Bytes of commands in the current file as of the last compaction or reset,
+  // and bytes appended since.
+  int64_t compacted_bytes_;
+  int64_t bytes_since_compaction_;
+
   DISALLOW_COPY_AND_ASSIGN(SessionBackend);
 };
 
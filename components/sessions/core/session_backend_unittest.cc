@@ -5,12 +5,18 @@
 #include "components/sessions/core/session_backend.h"
 
 #include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
 #include <utility>
 
+#include "base/bind.h"
+#include "base/files/file.h"
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/stl_util.h"
 #include "base/strings/string_util.h"
+#include "base/test/scoped_feature_list.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace sessions {
@@ -34,6 +40,21 @@ std::unique_ptr<sessions::SessionCommand> CreateCommandFromData(
   return command;
 }
 
+// Keeps the last command with each id.
+SessionCommands KeepLastCommandWithEachId(int* call_count,
+                                          SessionCommands commands) {
+  ++*call_count;
+  std::map<sessions::SessionCommand::id_type, size_t> last_commands;
+  for (size_t i = 0; i < commands.size(); ++i)
+    last_commands[commands[i]->id()] = i;
+  SessionCommands compacted;
+  for (size_t i = 0; i < commands.size(); ++i) {
+    if (last_commands[commands[i]->id()] == i)
+      compacted.push_back(std::move(commands[i]));
+  }
+  return compacted;
+}
+
 }  // namespace
 
 class SessionBackendTest : public testing::Test {
@@ -52,6 +73,17 @@ class SessionBackendTest : public testing::Test {
         memcmp(command->contents(), data.data.c_str(), command->size()) == 0);
   }
 
+  void AssertCommandsEqualData(const std::vector<TestData>& data,
+                               const SessionCommands& commands) {
+    ASSERT_EQ(data.size(), commands.size());
+    for (size_t i = 0; i < data.size(); ++i)
+      AssertCommandEqualsData(data[i], commands[i].get());
+  }
+
+  base::FilePath GetCurrentSessionPath() {
+    return path_.AppendASCII("Current Session");
+  }
+
   // Path used in testing.
   base::FilePath path_;
   base::ScopedTempDir temp_dir_;
@@ -210,4 +242,143 @@ TEST_F(SessionBackendTest, Truncate) {
   commands.clear();
 }
 
+// A damaged command, and everything after it, is dropped.
+TEST_F(SessionBackendTest, ChecksumMismatch) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(kCompactSessionFile);
+  struct TestData data[] = {
+    { 1,  "a" },
+    { 2,  "bc" },
+    { 3,  "def" },
+  };
+  scoped_refptr<SessionBackend> backend(
+      new SessionBackend(sessions::BaseSessionService::SESSION_RESTORE, path_));
+  SessionCommands commands;
+  for (const TestData& command_data : data)
+    commands.push_back(CreateCommandFromData(command_data));
+  backend->AppendCommands(std::move(commands), false);
+  backend = nullptr;
+
+  // Change a byte of the second command's contents. The file starts with an
+  // eight byte header, and the first command takes two bytes of size, one of
+  // id, one of contents and four of checksum.
+  {
+    base::File file(GetCurrentSessionPath(),
+                    base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+    ASSERT_TRUE(file.IsValid());
+    ASSERT_EQ(1, file.Write(8 + 8 + 3, "x", 1));
+  }
+
+  backend = new SessionBackend(sessions::BaseSessionService::SESSION_RESTORE,
+                               path_);
+  ASSERT_TRUE(backend->ReadLastSessionCommandsImpl(&commands));
+  AssertCommandsEqualData({data[0]}, commands);
+}
+
+// Without kCompactSessionFile, files are written in the format older builds
+// read, without checksums.
+TEST_F(SessionBackendTest, WriteFileWithoutChecksums) {
+  scoped_refptr<SessionBackend> backend(
+      new SessionBackend(sessions::BaseSessionService::SESSION_RESTORE, path_));
+  SessionCommands commands;
+  commands.push_back(CreateCommandFromData({7, "ab"}));
+  backend->AppendCommands(std::move(commands), false);
+  backend = nullptr;
+
+  std::string file_data;
+  ASSERT_TRUE(base::ReadFileToString(GetCurrentSessionPath(), &file_data));
+  std::string expected_data;
+  const int32_t header[] = {0x53534E53, 1};
+  expected_data.append(reinterpret_cast<const char*>(header), sizeof(header));
+  const sessions::SessionCommand::size_type size = 3;
+  expected_data.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  expected_data.append("\x07" "ab", size);
+  EXPECT_EQ(expected_data, file_data);
+}
+
+// Files written before commands had checksums can still be read.
+TEST_F(SessionBackendTest, ReadFileWithoutChecksums) {
+  std::string file_data;
+  const int32_t header[] = {0x53534E53, 1};
+  file_data.append(reinterpret_cast<const char*>(header), sizeof(header));
+  const sessions::SessionCommand::size_type size = 3;
+  file_data.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  file_data.append("\x07" "ab", size);
+  ASSERT_EQ(static_cast<int>(file_data.size()),
+            base::WriteFile(GetCurrentSessionPath(), file_data.data(),
+                            static_cast<int>(file_data.size())));
+
+  scoped_refptr<SessionBackend> backend(
+      new SessionBackend(sessions::BaseSessionService::SESSION_RESTORE, path_));
+  SessionCommands commands;
+  ASSERT_TRUE(backend->ReadLastSessionCommandsImpl(&commands));
+  AssertCommandsEqualData({{7, "ab"}}, commands);
+}
+
+TEST_F(SessionBackendTest, CompactCurrentFile) {
+  scoped_refptr<SessionBackend> backend(
+      new SessionBackend(sessions::BaseSessionService::SESSION_RESTORE, path_));
+  SessionCommands commands;
+  commands.push_back(CreateCommandFromData({1, "a"}));
+  backend->AppendCommands(std::move(commands), false);
+  // Nothing to compact with yet.
+  EXPECT_FALSE(backend->CompactCurrentFile());
+
+  int call_count = 0;
+  backend->SetCompactor(
+      base::BindRepeating(&KeepLastCommandWithEachId, &call_count));
+  commands.push_back(CreateCommandFromData({2, "b"}));
+  commands.push_back(CreateCommandFromData({1, "c"}));
+  backend->AppendCommands(std::move(commands), false);
+  // Too little was appended for the file to be compacted.
+  EXPECT_EQ(0, call_count);
+
+  EXPECT_TRUE(backend->CompactCurrentFile());
+  EXPECT_EQ(1, call_count);
+
+  // Commands are appended to the compacted file.
+  commands.push_back(CreateCommandFromData({3, "d"}));
+  backend->AppendCommands(std::move(commands), false);
+  backend = nullptr;
+  backend = new SessionBackend(sessions::BaseSessionService::SESSION_RESTORE,
+                               path_);
+  ASSERT_TRUE(backend->ReadLastSessionCommandsImpl(&commands));
+  AssertCommandsEqualData({{2, "b"}, {1, "c"}, {3, "d"}}, commands);
+}
+
+// The current file is compacted as it grows, keeping it from growing much
+// beyond its compacted size.
+TEST_F(SessionBackendTest, CompactAsFileGrows) {
+  scoped_refptr<SessionBackend> backend(
+      new SessionBackend(sessions::BaseSessionService::SESSION_RESTORE, path_));
+  int call_count = 0;
+  backend->SetCompactor(
+      base::BindRepeating(&KeepLastCommandWithEachId, &call_count));
+
+  const std::string contents(1000, 'a');
+  const int64_t command_count =
+      4 * SessionBackend::kMinBytesBeforeCompaction / contents.size();
+  for (int64_t i = 0; i < command_count; ++i) {
+    SessionCommands commands;
+    commands.push_back(CreateCommandFromData(
+        {static_cast<sessions::SessionCommand::id_type>(i % 3), contents}));
+    backend->AppendCommands(std::move(commands), false);
+
+    int64_t file_size = 0;
+    ASSERT_TRUE(base::GetFileSize(GetCurrentSessionPath(), &file_size));
+    EXPECT_LE(file_size, SessionBackend::kMinBytesBeforeCompaction +
+                             static_cast<int64_t>(4 * contents.size()));
+  }
+  EXPECT_LE(3, call_count);
+
+  backend = nullptr;
+  backend = new SessionBackend(sessions::BaseSessionService::SESSION_RESTORE,
+                               path_);
+  SessionCommands commands;
+  ASSERT_TRUE(backend->ReadLastSessionCommandsImpl(&commands));
+  ASSERT_EQ(3U, commands.size());
+  for (const auto& command : commands)
+    EXPECT_EQ(contents.size(), command->size());
+}
+
 }  // namespace sessions
@@ -7,10 +7,14 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <map>
+#include <set>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "base/containers/flat_set.h"
+#include "base/macros.h"
 #include "base/memory/ptr_util.h"
 #include "base/pickle.h"
 #include "base/token.h"
@@ -751,6 +755,317 @@ bool CreateTabsAndWindows(
   return true;
 }
 
+// Finds the commands of a session file that CreateTabsAndWindows() would
+// read to no effect on the restored session, for CompactSessionCommands().
+class SessionCommandCompactor {
+ public:
+  explicit SessionCommandCompactor(
+      const std::vector<std::unique_ptr<SessionCommand>>& commands)
+      : commands_(commands), live_(commands.size(), true) {}
+
+  // Returns whether each command is still needed.
+  std::vector<bool> FindLiveCommands() {
+    // CreateTabsAndWindows() stops at the first command it fails to read, so
+    // nothing after it is compacted.
+    for (size_t i = 0; i < commands_.size(); ++i) {
+      if (!ReadCommand(i))
+        break;
+    }
+
+    // The tabs of a closed window aren't closed one by one, but are dropped on
+    // restore along with the window, which never reopens.
+    for (const auto& tab_window : tab_windows_) {
+      if (closed_windows_.count(tab_window.second))
+        DropCommands(tab_commands_[tab_window.first]);
+    }
+    return live_;
+  }
+
+ private:
+  // Identifies what a command sets: the command id, the tab or window id,
+  // and for navigations, the navigation index and the number of times the
+  // tab's navigations were pruned before, as pruning moves them.
+  using FieldKey =
+      std::tuple<SessionCommand::id_type, SessionID::id_type, int, int>;
+
+  // Returns false if CreateTabsAndWindows() would stop at command |i|.
+  bool ReadCommand(size_t i) {
+    const SessionCommand::id_type kCommandSetWindowBounds2 = 10;
+    const SessionCommand& command = *commands_[i];
+    switch (command.id()) {
+      case kCommandSetTabWindow: {
+        SessionID::id_type payload[2];
+        if (!command.GetPayload(payload, sizeof(payload)))
+          return false;
+        tab_windows_[payload[1]] = payload[0];
+        SetTabField(i, payload[1]);
+        return true;
+      }
+
+      case kCommandSetWindowBounds2: {
+        WindowBoundsPayload2 payload;
+        if (!command.GetPayload(&payload, sizeof(payload)))
+          return false;
+        // Both versions of the command set the same fields.
+        SetWindowField(i, payload.window_id, kCommandSetWindowBounds3);
+        return true;
+      }
+
+      case kCommandSetWindowBounds3: {
+        WindowBoundsPayload3 payload;
+        if (!command.GetPayload(&payload, sizeof(payload)))
+          return false;
+        SetWindowField(i, payload.window_id);
+        return true;
+      }
+
+      case kCommandSetTabIndexInWindow:
+      case kCommandSetSelectedNavigationIndex: {
+        IDAndIndexPayload payload;
+        if (!command.GetPayload(&payload, sizeof(payload)))
+          return false;
+        SetTabField(i, payload.id);
+        return true;
+      }
+
+      case kCommandSetSelectedTabInIndex:
+      case kCommandSetWindowType: {
+        IDAndIndexPayload payload;
+        if (!command.GetPayload(&payload, sizeof(payload)))
+          return false;
+        SetWindowField(i, payload.id);
+        return true;
+      }
+
+      case kCommandTabClosed:
+      case kCommandWindowClosed: {
+        ClosedPayload payload;
+        if (!command.GetPayload(&payload, sizeof(payload)))
+          return false;
+        // Once everything done to a tab or window is dropped, so can its
+        // closing be.
+        live_[i] = false;
+        if (command.id() == kCommandTabClosed) {
+          DropCommands(tab_commands_[payload.id]);
+          tab_commands_.erase(payload.id);
+          tab_windows_.erase(payload.id);
+          prune_counts_.erase(payload.id);
+        } else {
+          DropCommands(window_commands_[payload.id]);
+          window_commands_.erase(payload.id);
+          closed_windows_.insert(payload.id);
+        }
+        return true;
+      }
+
+      case kCommandTabNavigationPathPrunedFromBack: {
+        TabNavigationPathPrunedFromBackPayload payload;
+        if (!command.GetPayload(&payload, sizeof(payload)))
+          return false;
+        PruneTab(i, payload.id);
+        return true;
+      }
+
+      case kCommandTabNavigationPathPrunedFromFront: {
+        TabNavigationPathPrunedFromFrontPayload payload;
+        if (!command.GetPayload(&payload, sizeof(payload)) ||
+            payload.index <= 0) {
+          return false;
+        }
+        PruneTab(i, payload.id);
+        return true;
+      }
+
+      case kCommandTabNavigationPathPruned: {
+        TabNavigationPathPrunedPayload payload;
+        if (!command.GetPayload(&payload, sizeof(payload)) ||
+            payload.index < 0 || payload.count <= 0) {
+          return false;
+        }
+        PruneTab(i, payload.id);
+        return true;
+      }
+
+      case kCommandUpdateTabNavigation: {
+        sessions::SerializedNavigationEntry navigation;
+        SessionID tab_id = SessionID::InvalidValue();
+        if (!RestoreUpdateTabNavigationCommand(command, &navigation, &tab_id))
+          return false;
+        SetTabField(i, tab_id.id(), navigation.index(),
+                    prune_counts_[tab_id.id()]);
+        return true;
+      }
+
+      case kCommandSetTabGroup: {
+        TabGroupPayload payload;
+        if (!command.GetPayload(&payload, sizeof(payload)))
+          return false;
+        SetTabField(i, payload.tab_id);
+        return true;
+      }
+
+      case kCommandSetTabGroupMetadata: {
+        std::unique_ptr<base::Pickle> pickle = command.PayloadAsPickle();
+        base::PickleIterator iter(*pickle);
+        base::Optional<base::Token> group_id = ReadTokenFromPickle(&iter);
+        base::string16 title;
+        uint32_t color;
+        if (!group_id.has_value() || !iter.ReadString16(&title) ||
+            !iter.ReadUInt32(&color)) {
+          return false;
+        }
+        auto result = group_metadata_.emplace(group_id.value(), i);
+        if (!result.second) {
+          live_[result.first->second] = false;
+          result.first->second = i;
+        }
+        return true;
+      }
+
+      case kCommandSetPinnedState: {
+        PinnedStatePayload payload;
+        if (!command.GetPayload(&payload, sizeof(payload)))
+          return false;
+        SetTabField(i, payload.tab_id);
+        return true;
+      }
+
+      case kCommandSetWindowAppName: {
+        SessionID window_id = SessionID::InvalidValue();
+        std::string app_name;
+        if (!RestoreSetWindowAppNameCommand(command, &window_id, &app_name))
+          return false;
+        SetWindowField(i, window_id.id());
+        return true;
+      }
+
+      case kCommandSetExtensionAppID: {
+        SessionID tab_id = SessionID::InvalidValue();
+        std::string extension_app_id;
+        if (!RestoreSetTabExtensionAppIDCommand(command, &tab_id,
+                                                &extension_app_id)) {
+          return false;
+        }
+        SetTabField(i, tab_id.id());
+        return true;
+      }
+
+      case kCommandSetTabUserAgentOverride: {
+        SessionID tab_id = SessionID::InvalidValue();
+        std::string user_agent_override;
+        if (!RestoreSetTabUserAgentOverrideCommand(command, &tab_id,
+                                                   &user_agent_override)) {
+          return false;
+        }
+        SetTabField(i, tab_id.id());
+        return true;
+      }
+
+      case kCommandSessionStorageAssociated: {
+        std::unique_ptr<base::Pickle> pickle = command.PayloadAsPickle();
+        base::PickleIterator iter(*pickle);
+        SessionID::id_type tab_id;
+        std::string session_storage_persistent_id;
+        if (!iter.ReadInt(&tab_id) ||
+            !iter.ReadString(&session_storage_persistent_id)) {
+          return false;
+        }
+        SetTabField(i, tab_id);
+        return true;
+      }
+
+      case kCommandSetActiveWindow: {
+        ActiveWindowPayload payload;
+        if (!command.GetPayload(&payload, sizeof(payload)))
+          return false;
+        SetField(i, FieldKey(command.id(), 0, 0, 0));
+        return true;
+      }
+
+      case kCommandLastActiveTime: {
+        LastActiveTimePayload payload;
+        if (!command.GetPayload(&payload, sizeof(payload)))
+          return false;
+        SetTabField(i, payload.tab_id);
+        return true;
+      }
+
+      case kCommandSetWindowWorkspace2: {
+        std::unique_ptr<base::Pickle> pickle = command.PayloadAsPickle();
+        base::PickleIterator iter(*pickle);
+        SessionID::id_type window_id;
+        std::string workspace;
+        if (!iter.ReadInt(&window_id) || !iter.ReadString(&workspace))
+          return false;
+        SetWindowField(i, window_id);
+        return true;
+      }
+
+      default:
+        return false;
+    }
+  }
+
+  // Records that command |i| sets the field identified by |key|, which makes
+  // the last command that set it unneeded.
+  void SetField(size_t i, const FieldKey& key) {
+    auto result = last_setters_.emplace(key, i);
+    if (!result.second) {
+      live_[result.first->second] = false;
+      result.first->second = i;
+    }
+  }
+
+  void SetTabField(size_t i,
+                   SessionID::id_type tab_id,
+                   int navigation_index = 0,
+                   int prune_count = 0) {
+    tab_commands_[tab_id].push_back(i);
+    SetField(i, FieldKey(commands_[i]->id(), tab_id, navigation_index,
+                         prune_count));
+  }
+
+  void SetWindowField(size_t i, SessionID::id_type window_id) {
+    SetWindowField(i, window_id, commands_[i]->id());
+  }
+
+  void SetWindowField(size_t i,
+                      SessionID::id_type window_id,
+                      SessionCommand::id_type field) {
+    window_commands_[window_id].push_back(i);
+    // A command for a closed window recreates it.
+    closed_windows_.erase(window_id);
+    SetField(i, FieldKey(field, window_id, 0, 0));
+  }
+
+  void PruneTab(size_t i, SessionID::id_type tab_id) {
+    tab_commands_[tab_id].push_back(i);
+    ++prune_counts_[tab_id];
+  }
+
+  void DropCommands(const std::vector<size_t>& commands) {
+    for (size_t i : commands)
+      live_[i] = false;
+  }
+
+  const std::vector<std::unique_ptr<SessionCommand>>& commands_;
+  std::vector<bool> live_;
+
+  // The last command to set each field.
+  std::map<FieldKey, size_t> last_setters_;
+  std::map<base::Token, size_t> group_metadata_;
+
+  // The commands for each open tab and window.
+  std::map<SessionID::id_type, std::vector<size_t>> tab_commands_;
+  std::map<SessionID::id_type, std::vector<size_t>> window_commands_;
+
+  std::map<SessionID::id_type, int> prune_counts_;
+  std::map<SessionID::id_type, SessionID::id_type> tab_windows_;
+  std::set<SessionID::id_type> closed_windows_;
+
+  DISALLOW_COPY_AND_ASSIGN(SessionCommandCompactor);
+};
+
 template <typename Payload>
 std::unique_ptr<SessionCommand> CreateSessionCommandForPayload(
     SessionCommand::id_type id,
@@ -1034,4 +1349,16 @@ void RestoreSessionFromCommands(
   DCHECK_EQ(0u, windows.size());
 }
 
+std::vector<std::unique_ptr<SessionCommand>> CompactSessionCommands(
+    std::vector<std::unique_ptr<SessionCommand>> commands) {
+  const std::vector<bool> live =
+      SessionCommandCompactor(commands).FindLiveCommands();
+  std::vector<std::unique_ptr<SessionCommand>> compacted;
+  for (size_t i = 0; i < commands.size(); ++i) {
+    if (live[i])
+      compacted.push_back(std::move(commands[i]));
+  }
+  return compacted;
+}
+
 }  // namespace sessions
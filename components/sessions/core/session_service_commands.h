@@ -8,6 +8,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/callback.h"
 #include "base/memory/weak_ptr.h"
@@ -107,6 +108,14 @@ SESSIONS_EXPORT void RestoreSessionFromCommands(
     std::vector<std::unique_ptr<SessionWindow>>* valid_windows,
     SessionID* active_window_id);
 
+// Returns |commands| without those that make no difference to the session
+// RestoreSessionFromCommands() restores: the ones setting what a later command
+// sets again, and the ones for tabs and windows that were closed. Used to
+// compact the session file in the background, see
+// BaseSessionService::SetCommandCompactor().
+SESSIONS_EXPORT std::vector<std::unique_ptr<SessionCommand>>
+CompactSessionCommands(std::vector<std::unique_ptr<SessionCommand>> commands);
+
 }  // namespace sessions
 
 #endif  // COMPONENTS_SESSIONS_CORE_SESSION_SERVICE_COMMANDS_H_
@@ -157,10 +157,14 @@ void StartInstallOnBlockingTaskRunner(
     std::unique_ptr<Unzipper> unzipper_,
     scoped_refptr<Patcher> patcher_,
     crx_file::VerifierFormat crx_format,
+    base::Optional<crx_file::VerifierResult> crx_verifier_result,
+    const std::string& crx_public_key,
     InstallOnBlockingTaskRunnerCompleteCallback callback) {
   auto unpacker = base::MakeRefCounted<ComponentUnpacker>(
       pk_hash, crx_path, installer, std::move(unzipper_), std::move(patcher_),
       crx_format);
+  if (crx_verifier_result)
+    unpacker->set_verifier_result(*crx_verifier_result, crx_public_key);
 
   unpacker->Unpack(base::BindOnce(&UnpackCompleteOnBlockingTaskRunner,
                                   main_task_runner, crx_path, fingerprint,
@@ -631,6 +635,9 @@ void Component::StateDownloadingDiff::DoHandle() {
   crx_downloader_->set_progress_callback(
       base::Bind(&Component::StateDownloadingDiff::DownloadProgress,
                  base::Unretained(this), id));
+  crx_downloader_->set_crx_verification(
+      component.crx_component()->pk_hash,
+      component.crx_component()->crx_format_requirement);
   crx_downloader_->StartDownload(
       component.crx_diffurls_, component.hashdiff_sha256_,
       base::BindOnce(&Component::StateDownloadingDiff::DownloadComplete,
@@ -669,6 +676,8 @@ void Component::StateDownloadingDiff::DownloadComplete(
   }
 
   component.crx_path_ = download_result.response;
+  component.crx_verifier_result_ = download_result.crx_verifier_result;
+  component.crx_public_key_ = download_result.public_key;
 
   TransitionState(std::make_unique<StateUpdatingDiff>(&component));
 }
@@ -696,6 +705,9 @@ void Component::StateDownloading::DoHandle() {
   crx_downloader_->set_progress_callback(
       base::Bind(&Component::StateDownloading::DownloadProgress,
                  base::Unretained(this), id));
+  crx_downloader_->set_crx_verification(
+      component.crx_component()->pk_hash,
+      component.crx_component()->crx_format_requirement);
   crx_downloader_->StartDownload(
       component.crx_urls_, component.hash_sha256_,
       base::BindOnce(&Component::StateDownloading::DownloadComplete,
@@ -735,6 +747,8 @@ void Component::StateDownloading::DownloadComplete(
   }
 
   component.crx_path_ = download_result.response;
+  component.crx_verifier_result_ = download_result.crx_verifier_result;
+  component.crx_public_key_ = download_result.public_key;
 
   TransitionState(std::make_unique<StateUpdating>(&component));
 }
@@ -767,6 +781,7 @@ void Component::StateUpdatingDiff::DoHandle() {
               update_context.config->GetUnzipperFactory()->Create(),
               update_context.config->GetPatcherFactory()->Create(),
               component.crx_component()->crx_format_requirement,
+              component.crx_verifier_result_, component.crx_public_key_,
               base::BindOnce(&Component::StateUpdatingDiff::InstallComplete,
                              base::Unretained(this))));
 }
@@ -828,6 +843,7 @@ void Component::StateUpdating::DoHandle() {
                      update_context.config->GetUnzipperFactory()->Create(),
                      update_context.config->GetPatcherFactory()->Create(),
                      component.crx_component()->crx_format_requirement,
+                     component.crx_verifier_result_, component.crx_public_key_,
                      base::BindOnce(&Component::StateUpdating::InstallComplete,
                                     base::Unretained(this))));
 }
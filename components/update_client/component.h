@@ -424,6 +424,11 @@ class Component {
 
   base::FilePath crx_path_;
 
+  // The result of verifying |crx_path_| while it was downloaded, if it was,
+  // and the public key the CRX is signed with.
+  base::Optional<crx_file::VerifierResult> crx_verifier_result_;
+  std::string crx_public_key_;
+
   // The error information for full and differential updates.
   // The |error_category| contains a hint about which module in the component
   // updater generated the error. The |error_code| constains the error and
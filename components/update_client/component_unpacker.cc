@@ -55,6 +55,13 @@ void ComponentUnpacker::Unpack(Callback callback) {
     EndUnpacking();
 }
 
+void ComponentUnpacker::set_verifier_result(
+    crx_file::VerifierResult verifier_result,
+    const std::string& public_key) {
+  verifier_result_ = verifier_result;
+  public_key_ = public_key;
+}
+
 bool ComponentUnpacker::Verify() {
   VLOG(1) << "Verifying component: " << path_.value();
   if (pk_hash_.empty() || path_.empty()) {
@@ -63,8 +70,10 @@ bool ComponentUnpacker::Verify() {
   }
   const std::vector<std::vector<uint8_t>> required_keys = {pk_hash_};
   const crx_file::VerifierResult result =
-      crx_file::Verify(path_, crx_format_, required_keys,
-                       std::vector<uint8_t>(), &public_key_, nullptr);
+      verifier_result_
+          ? *verifier_result_
+          : crx_file::Verify(path_, crx_format_, required_keys,
+                             std::vector<uint8_t>(), &public_key_, nullptr);
   if (result != crx_file::VerifierResult::OK_FULL &&
       result != crx_file::VerifierResult::OK_DELTA) {
     error_ = UnpackerError::kInvalidFile;
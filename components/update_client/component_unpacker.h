@@ -15,10 +15,12 @@
 #include "base/files/file_path.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/optional.h"
 #include "components/update_client/update_client_errors.h"
 
 namespace crx_file {
 enum class VerifierFormat;
+enum class VerifierResult;
 }
 
 namespace update_client {
@@ -98,6 +100,12 @@ class ComponentUnpacker : public base::RefCountedThreadSafe<ComponentUnpacker> {
   // Calls |callback| with the result.
   void Unpack(Callback callback);
 
+  // Uses |verifier_result|, the result of verifying the CRX while it was
+  // downloaded, and the |public_key| found then, instead of reading the CRX
+  // to verify it. Must be called before Unpack().
+  void set_verifier_result(crx_file::VerifierResult verifier_result,
+                           const std::string& public_key);
+
  private:
   friend class base::RefCountedThreadSafe<ComponentUnpacker>;
 
@@ -139,6 +147,7 @@ class ComponentUnpacker : public base::RefCountedThreadSafe<ComponentUnpacker> {
   UnpackerError error_;
   int extended_error_;
   std::string public_key_;
+  base::Optional<crx_file::VerifierResult> verifier_result_;
 
   DISALLOW_COPY_AND_ASSIGN(ComponentUnpacker);
 };
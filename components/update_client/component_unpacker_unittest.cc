@@ -169,4 +169,27 @@ TEST_F(ComponentUnpackerTest, UnpackFileHashMismatch) {
   EXPECT_TRUE(result_.unpack_path.empty());
 }
 
+// Tests that the result of verifying the CRX while it was downloaded is used
+// instead of verifying the file.
+TEST_F(ComponentUnpackerTest, UnpackWithVerifierResult) {
+  scoped_refptr<ComponentUnpacker> component_unpacker =
+      base::MakeRefCounted<ComponentUnpacker>(
+          std::vector<uint8_t>(std::begin(jebg_hash), std::end(jebg_hash)),
+          test_file("jebgalgnebhfojomionfpkfelancnnkf.crx"), nullptr, nullptr,
+          nullptr, crx_file::VerifierFormat::CRX3);
+  component_unpacker->set_verifier_result(
+      crx_file::VerifierResult::ERROR_SIGNATURE_VERIFICATION_FAILED,
+      std::string());
+  component_unpacker->Unpack(base::BindOnce(
+      &ComponentUnpackerTest::UnpackComplete, base::Unretained(this)));
+  RunThreads();
+
+  EXPECT_EQ(UnpackerError::kInvalidFile, result_.error);
+  EXPECT_EQ(static_cast<int>(
+                crx_file::VerifierResult::ERROR_SIGNATURE_VERIFICATION_FAILED),
+            result_.extended_error);
+
+  EXPECT_TRUE(result_.unpack_path.empty());
+}
+
 }  // namespace update_client
@@ -56,6 +56,11 @@ class Configurator : public base::RefCountedThreadSafe<Configurator> {
   // components.
   virtual int UpdateDelay() const = 0;
 
+  // The number of components of one update which may download at the same
+  // time. Above 1, the next components download while the current one is
+  // unpacked and installed; components are still installed one at a time.
+  virtual int MaxConcurrentDownloads() const = 0;
+
   // The URLs for the update checks. The URLs are tried in order, the first one
   // that succeeds wins.
   virtual std::vector<GURL> UpdateUrl() const = 0;
@@ -7,6 +7,7 @@
 #include <utility>
 
 #include "base/bind.h"
+#include "base/containers/span.h"
 #include "base/files/file_util.h"
 #include "base/location.h"
 #include "base/logging.h"
@@ -25,6 +26,51 @@
 
 namespace update_client {
 
+// Hashes the chunks of a response and, if requested, verifies them as a CRX.
+// Used on one sequence only.
+class CrxDownloader::ResponseVerifier {
+ public:
+  ResponseVerifier(const std::vector<uint8_t>& pk_hash,
+                   base::Optional<crx_file::VerifierFormat> crx_format)
+      : pk_hash_(pk_hash), crx_format_(crx_format) {}
+
+  int64_t size() const { return hasher_.size(); }
+
+  void Update(int64_t offset, const std::string& data) {
+    // The CRX is verified from the first byte of the response, and only as
+    // long as no chunk is missed. Missing a chunk fails the hash check, in
+    // which case the verdict is not used.
+    if (crx_format_ && offset == 0) {
+      crx_verifier_ = std::make_unique<crx_file::StreamingVerifier>(
+          *crx_format_, std::vector<std::vector<uint8_t>>{pk_hash_},
+          std::vector<uint8_t>());
+    }
+    if (crx_verifier_ && offset == hasher_.size())
+      crx_verifier_->Update(base::as_bytes(base::make_span(data)));
+    hasher_.Update(offset, data);
+  }
+
+  // Returns true if the hash of the response matches |expected_hash|, in
+  // which case the result of the CRX verification, if any, is set in |result|.
+  bool Verify(const std::string& expected_hash, Result* result) {
+    if (!hasher_.Verify(expected_hash))
+      return false;
+    if (crx_verifier_) {
+      result->crx_verifier_result =
+          crx_verifier_->Finish(&result->public_key, nullptr);
+    }
+    return true;
+  }
+
+ private:
+  const std::vector<uint8_t> pk_hash_;
+  const base::Optional<crx_file::VerifierFormat> crx_format_;
+  StreamHasher256 hasher_;
+  std::unique_ptr<crx_file::StreamingVerifier> crx_verifier_;
+
+  DISALLOW_COPY_AND_ASSIGN(ResponseVerifier);
+};
+
 CrxDownloader::DownloadMetrics::DownloadMetrics()
     : downloader(kNone),
       error(0),
@@ -53,7 +99,10 @@ std::unique_ptr<CrxDownloader> CrxDownloader::Create(
 
 CrxDownloader::CrxDownloader(std::unique_ptr<CrxDownloader> successor)
     : main_task_runner_(base::ThreadTaskRunnerHandle::Get()),
-      successor_(std::move(successor)) {}
+      successor_(std::move(successor)),
+      hash_task_runner_(base::CreateSequencedTaskRunner(kTaskTraits)),
+      response_verifier_(nullptr,
+                         base::OnTaskRunnerDeleter(hash_task_runner_)) {}
 
 CrxDownloader::~CrxDownloader() {}
 
@@ -62,6 +111,15 @@ void CrxDownloader::set_progress_callback(
   progress_callback_ = progress_callback;
 }
 
+void CrxDownloader::set_crx_verification(
+    const std::vector<uint8_t>& pk_hash,
+    crx_file::VerifierFormat crx_format) {
+  pk_hash_ = pk_hash;
+  crx_format_ = crx_format;
+  if (successor_)
+    successor_->set_crx_verification(pk_hash, crx_format);
+}
+
 GURL CrxDownloader::url() const {
   return current_url_ != urls_.end() ? *current_url_ : GURL();
 }
@@ -119,16 +177,23 @@ void CrxDownloader::OnDownloadComplete(
     const DownloadMetrics& download_metrics) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
-  if (!result.error)
-    base::PostTask(
-        FROM_HERE, kTaskTraits,
-        base::BindOnce(&CrxDownloader::VerifyResponse, base::Unretained(this),
-                       is_handled, result, download_metrics));
-  else
+  if (!result.error) {
+    // When the download has been hashed as it was received, it is verified on
+    // the same sequence, after the last chunk is hashed.
+    ResponseVerifier* response_verifier = response_verifier_.get();
+    auto verify_response = base::BindOnce(
+        &CrxDownloader::VerifyResponse, base::Unretained(this),
+        response_verifier, is_handled, result, download_metrics);
+    if (response_verifier)
+      hash_task_runner_->PostTask(FROM_HERE, std::move(verify_response));
+    else
+      base::PostTask(FROM_HERE, kTaskTraits, std::move(verify_response));
+  } else {
     main_task_runner()->PostTask(
         FROM_HERE, base::BindOnce(&CrxDownloader::HandleDownloadError,
                                   base::Unretained(this), is_handled, result,
                                   download_metrics));
+  }
 }
 
 void CrxDownloader::OnDownloadProgress() {
@@ -140,16 +205,37 @@ void CrxDownloader::OnDownloadProgress() {
   progress_callback_.Run();
 }
 
+void CrxDownloader::OnResponseData(int64_t offset, const std::string& data) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  if (!response_verifier_)
+    response_verifier_.reset(new ResponseVerifier(pk_hash_, crx_format_));
+
+  hash_task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&ResponseVerifier::Update,
+                                base::Unretained(response_verifier_.get()),
+                                offset, data));
+}
+
 // The function mutates the values of the parameters |result| and
 // |download_metrics|.
-void CrxDownloader::VerifyResponse(bool is_handled,
+void CrxDownloader::VerifyResponse(ResponseVerifier* response_verifier,
+                                   bool is_handled,
                                    Result result,
                                    DownloadMetrics download_metrics) {
   DCHECK_EQ(0, result.error);
   DCHECK_EQ(0, download_metrics.error);
   DCHECK(is_handled);
 
-  if (VerifyFileHash256(result.response, expected_hash_)) {
+  // The file is read only if the verifier did not see all of it.
+  int64_t file_size = -1;
+  const bool is_verified =
+      response_verifier &&
+              base::GetFileSize(result.response, &file_size) &&
+              file_size == response_verifier->size()
+          ? response_verifier->Verify(expected_hash_, &result)
+          : VerifyFileHash256(result.response, expected_hash_);
+  if (is_verified) {
     download_metrics_.push_back(download_metrics);
     main_task_runner()->PostTask(
         FROM_HERE, base::BindOnce(std::move(download_callback_), result));
@@ -192,6 +278,9 @@ void CrxDownloader::HandleDownloadError(
     ++current_url_;
   }
 
+  // The chunks of the failed response are not verified again.
+  response_verifier_.reset();
+
   // Try downloading from another url from the list.
   if (current_url_ != urls_.end()) {
     DoStartDownload(*current_url_);
@@ -15,8 +15,11 @@
 #include "base/files/file_path.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/optional.h"
+#include "base/sequenced_task_runner.h"
 #include "base/single_thread_task_runner.h"
 #include "base/threading/thread_checker.h"
+#include "components/crx_file/crx_verifier.h"
 #include "url/gurl.h"
 
 namespace update_client {
@@ -59,6 +62,12 @@ class CrxDownloader {
 
     // Path of the downloaded file if the download was successful.
     base::FilePath response;
+
+    // The result of verifying the CRX as it was downloaded, and the public key
+    // it was signed with. Only set when the verification was requested and
+    // the whole response was received in chunks.
+    base::Optional<crx_file::VerifierResult> crx_verifier_result;
+    std::string public_key;
   };
 
   // The callback fires only once, regardless of how many urls are tried, and
@@ -89,6 +98,11 @@ class CrxDownloader {
 
   void set_progress_callback(const ProgressCallback& progress_callback);
 
+  // Verifies the downloaded CRX as it is received, with the checks the
+  // ComponentUnpacker makes, so that the CRX is not read again to verify it.
+  void set_crx_verification(const std::vector<uint8_t>& pk_hash,
+                            crx_file::VerifierFormat crx_format);
+
   // Starts the download. One instance of the class handles one download only.
   // One instance of CrxDownloader can only be started once, otherwise the
   // behavior is undefined. The callback gets invoked if the download can't
@@ -121,6 +135,14 @@ class CrxDownloader {
   // Calls the callback when progress is made.
   void OnDownloadProgress();
 
+  // Hashes |data|, the chunk of the current response at |offset|, so that the
+  // response is not read again to verify it once the download completes. The
+  // chunk is also verified as part of a CRX if set_crx_verification() was
+  // called.
+  // Derived classes which receive the response in chunks call this with every
+  // chunk, in order, starting over from offset 0 for each request.
+  void OnResponseData(int64_t offset, const std::string& data);
+
   // Returns the url which is currently being downloaded from.
   GURL url() const;
 
@@ -129,9 +151,13 @@ class CrxDownloader {
   }
 
  private:
+  class ResponseVerifier;
+
   virtual void DoStartDownload(const GURL& url) = 0;
 
-  void VerifyResponse(bool is_handled,
+  // Uses |response_verifier| to verify the response if it is not null.
+  void VerifyResponse(ResponseVerifier* response_verifier,
+                      bool is_handled,
                       Result result,
                       DownloadMetrics download_metrics);
 
@@ -148,6 +174,11 @@ class CrxDownloader {
 
   // The SHA256 hash of the download payload in hexadecimal format.
   std::string expected_hash_;
+
+  // Set when the CRX is verified as it is downloaded.
+  std::vector<uint8_t> pk_hash_;
+  base::Optional<crx_file::VerifierFormat> crx_format_;
+
   std::unique_ptr<CrxDownloader> successor_;
   DownloadCallback download_callback_;
   ProgressCallback progress_callback_;
@@ -156,6 +187,12 @@ class CrxDownloader {
 
   std::vector<DownloadMetrics> download_metrics_;
 
+  // Hashes and verifies the download as it is received. The verifier is
+  // deleted on this sequence, after the tasks using it.
+  scoped_refptr<base::SequencedTaskRunner> hash_task_runner_;
+  std::unique_ptr<ResponseVerifier, base::OnTaskRunnerDeleter>
+      response_verifier_;
+
   DISALLOW_COPY_AND_ASSIGN(CrxDownloader);
 };
 
@@ -4,8 +4,10 @@
 
 #include "components/update_client/crx_downloader.h"
 
+#include <iterator>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/files/file_path.h"
@@ -17,7 +19,9 @@
 #include "base/test/task_environment.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "build/build_config.h"
+#include "components/crx_file/crx_verifier.h"
 #include "components/update_client/net/network_chromium.h"
+#include "components/update_client/test_configurator.h"
 #include "components/update_client/update_client_errors.h"
 #include "components/update_client/utils.h"
 #include "net/base/net_errors.h"
@@ -271,6 +275,32 @@ TEST_F(CrxDownloaderTest, OneUrlBadHash) {
   EXPECT_LE(1, num_progress_calls_);
 }
 
+// Tests that the CRX is verified as it is downloaded, when requested.
+TEST_F(CrxDownloaderTest, OneUrlVerifiesCrx) {
+  const GURL expected_crx_url =
+      GURL("http://localhost/download/jebgalgnebhfojomionfpkfelancnnkf.crx");
+
+  const base::FilePath test_file(MakeTestFilePath(kTestFileName));
+  AddResponse(expected_crx_url, test_file, net::OK);
+
+  crx_downloader_->set_crx_verification(
+      std::vector<uint8_t>(std::begin(jebg_hash), std::end(jebg_hash)),
+      crx_file::VerifierFormat::CRX3);
+  crx_downloader_->StartDownloadFromUrl(
+      expected_crx_url, std::string(hash_jebg), std::move(callback_));
+  RunThreads();
+
+  EXPECT_EQ(1, num_download_complete_calls_);
+  EXPECT_EQ(0, download_complete_result_.error);
+  ASSERT_TRUE(download_complete_result_.crx_verifier_result);
+  EXPECT_EQ(crx_file::VerifierResult::OK_FULL,
+            *download_complete_result_.crx_verifier_result);
+  EXPECT_EQ(jebg_public_key, download_complete_result_.public_key);
+
+  EXPECT_TRUE(
+      DeleteFileAndEmptyParentDirectory(download_complete_result_.response));
+}
+
 // Tests that specifying two urls has no side effects. Expect a successful
 // download, and only one download request be made.
 TEST_F(CrxDownloaderTest, TwoUrls) {
@@ -7,14 +7,24 @@
 #include <utility>
 
 #include "base/bind.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/memory/weak_ptr.h"
 #include "base/numerics/safe_conversions.h"
+#include "base/sequenced_task_runner.h"
+#include "base/strings/string_piece.h"
+#include "base/task/post_task.h"
+#include "base/task_runner_util.h"
 #include "components/update_client/net/network_chromium.h"
+#include "components/update_client/task_traits.h"
 #include "net/base/load_flags.h"
+#include "net/base/net_errors.h"
 #include "net/http/http_response_headers.h"
 #include "net/traffic_annotation/network_traffic_annotation.h"
 #include "services/network/public/cpp/resource_response.h"
 #include "services/network/public/cpp/shared_url_loader_factory.h"
 #include "services/network/public/cpp/simple_url_loader.h"
+#include "services/network/public/cpp/simple_url_loader_stream_consumer.h"
 #include "url/gurl.h"
 
 namespace {
@@ -86,10 +96,115 @@ int64_t GetInt64Header(const network::SimpleURLLoader* simple_url_loader,
   return response_info->headers->GetInt64HeaderValue(header_name);
 }
 
+// Creates |file|, or empties it if it exists.
+void CreateDownloadFile(const base::FilePath& file_path, base::File* file) {
+  *file = base::File(file_path,
+                     base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+}
+
+bool WriteDownloadFile(base::File* file, const std::string& data) {
+  return file->IsValid() &&
+         file->WriteAtCurrentPos(data.data(), data.size()) ==
+             static_cast<int>(data.size());
+}
+
+bool CloseDownloadFile(base::File* file) {
+  const bool is_valid = file->IsValid();
+  file->Close();
+  return is_valid;
+}
+
 }  // namespace
 
 namespace update_client {
 
+// Saves the response body of a download to a file, and passes each chunk of
+// the body to a callback before writing it. The file is written on a blocking
+// sequence, and the next chunk is only read once the previous one is written.
+class NetworkFetcherImpl::FileStreamWriter
+    : public network::SimpleURLLoaderStreamConsumer {
+ public:
+  // Called with whether the whole body was received and saved, and with the
+  // number of bytes received.
+  using CompleteCallback =
+      base::OnceCallback<void(bool success, int64_t content_size)>;
+
+  FileStreamWriter(const base::FilePath& file_path,
+                   DownloadDataCallback download_data_callback,
+                   CompleteCallback complete_callback)
+      : file_path_(file_path),
+        download_data_callback_(std::move(download_data_callback)),
+        complete_callback_(std::move(complete_callback)),
+        file_task_runner_(base::CreateSequencedTaskRunner(kTaskTraits)),
+        file_(new base::File, base::OnTaskRunnerDeleter(file_task_runner_)) {
+    file_task_runner_->PostTask(FROM_HERE,
+                                base::BindOnce(&CreateDownloadFile, file_path_,
+                                               file_.get()));
+  }
+
+  ~FileStreamWriter() override = default;
+
+  // network::SimpleURLLoaderStreamConsumer overrides.
+  void OnDataReceived(base::StringPiece string_piece,
+                      base::OnceClosure resume) override {
+    std::string data = string_piece.as_string();
+    download_data_callback_.Run(content_size_, data);
+    content_size_ += data.size();
+    base::PostTaskAndReplyWithResult(
+        file_task_runner_.get(), FROM_HERE,
+        base::BindOnce(&WriteDownloadFile, file_.get(), std::move(data)),
+        base::BindOnce(&FileStreamWriter::OnWritten,
+                       weak_factory_.GetWeakPtr(), std::move(resume)));
+  }
+
+  void OnComplete(bool success) override {
+    base::PostTaskAndReplyWithResult(
+        file_task_runner_.get(), FROM_HERE,
+        base::BindOnce(&CloseDownloadFile, file_.get()),
+        base::BindOnce(&FileStreamWriter::OnClosed,
+                       weak_factory_.GetWeakPtr(), success));
+  }
+
+  void OnRetry(base::OnceClosure start_retry) override {
+    // The retried response is received again from its first byte.
+    content_size_ = 0;
+    has_write_error_ = false;
+    file_task_runner_->PostTaskAndReply(
+        FROM_HERE,
+        base::BindOnce(&CreateDownloadFile, file_path_, file_.get()),
+        base::BindOnce(&FileStreamWriter::RunClosure,
+                       weak_factory_.GetWeakPtr(), std::move(start_retry)));
+  }
+
+ private:
+  void OnWritten(base::OnceClosure resume, bool is_written) {
+    has_write_error_ |= !is_written;
+    std::move(resume).Run();
+  }
+
+  void OnClosed(bool success, bool is_file_valid) {
+    std::move(complete_callback_)
+        .Run(success && is_file_valid && !has_write_error_, content_size_);
+  }
+
+  void RunClosure(base::OnceClosure closure) { std::move(closure).Run(); }
+
+  const base::FilePath file_path_;
+  DownloadDataCallback download_data_callback_;
+  CompleteCallback complete_callback_;
+
+  // The file is only used and deleted on this sequence.
+  scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
+  std::unique_ptr<base::File, base::OnTaskRunnerDeleter> file_;
+
+  int64_t content_size_ = 0;
+  bool has_write_error_ = false;
+
+  base::WeakPtrFactory<FileStreamWriter> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(FileStreamWriter);
+};
+
 NetworkFetcherImpl::NetworkFetcherImpl(
     scoped_refptr<network::SharedURLLoaderFactory> shared_url_network_factory)
     : shared_url_network_factory_(shared_url_network_factory) {}
@@ -162,6 +277,32 @@ void NetworkFetcherImpl::DownloadToFile(
   simple_url_loader_->SetOnDownloadProgressCallback(base::BindRepeating(
       &NetworkFetcherImpl::OnProgressCallback, base::Unretained(this),
       std::move(progress_callback)));
+
+  // The body is streamed when its chunks are needed, so that they are not
+  // read back from the file.
+  if (download_data_callback_) {
+    file_stream_writer_ = std::make_unique<FileStreamWriter>(
+        file_path, download_data_callback_,
+        base::BindOnce(
+            [](const network::SimpleURLLoader* simple_url_loader,
+               DownloadToFileCompleteCallback
+                   download_to_file_complete_callback,
+               const base::FilePath& file_path, bool success,
+               int64_t content_size) {
+              int net_error = simple_url_loader->NetError();
+              if (!success && net_error == net::OK)
+                net_error = net::ERR_FAILED;
+              std::move(download_to_file_complete_callback)
+                  .Run(success ? file_path : base::FilePath(), net_error,
+                       content_size);
+            },
+            simple_url_loader_.get(),
+            std::move(download_to_file_complete_callback), file_path));
+    simple_url_loader_->DownloadAsStream(shared_url_network_factory_.get(),
+                                         file_stream_writer_.get());
+    return;
+  }
+
   simple_url_loader_->DownloadToFile(
       shared_url_network_factory_.get(),
       base::BindOnce(
@@ -177,6 +318,11 @@ void NetworkFetcherImpl::DownloadToFile(
       file_path);
 }
 
+void NetworkFetcherImpl::SetDownloadDataCallback(
+    DownloadDataCallback download_data_callback) {
+  download_data_callback_ = std::move(download_data_callback);
+}
+
 void NetworkFetcherImpl::OnResponseStartedCallback(
     ResponseStartedCallback response_started_callback,
     const GURL& final_url,
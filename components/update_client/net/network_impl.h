@@ -42,8 +42,12 @@ class NetworkFetcherImpl : public NetworkFetcher {
                       ProgressCallback progress_callback,
                       DownloadToFileCompleteCallback
                           download_to_file_complete_callback) override;
+  void SetDownloadDataCallback(
+      DownloadDataCallback download_data_callback) override;
 
  private:
+  class FileStreamWriter;
+
   void OnResponseStartedCallback(
       ResponseStartedCallback response_started_callback,
       const GURL& final_url,
@@ -57,6 +61,10 @@ class NetworkFetcherImpl : public NetworkFetcher {
   scoped_refptr<network::SharedURLLoaderFactory> shared_url_network_factory_;
   std::unique_ptr<network::SimpleURLLoader> simple_url_loader_;
 
+  // Used by DownloadToFile() when |download_data_callback_| is set.
+  DownloadDataCallback download_data_callback_;
+  std::unique_ptr<FileStreamWriter> file_stream_writer_;
+
   DISALLOW_COPY_AND_ASSIGN(NetworkFetcherImpl);
 };
 
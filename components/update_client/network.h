@@ -10,7 +10,7 @@
 #include <memory>
 #include <string>
 
-#include "base/callback_forward.h"
+#include "base/callback.h"
 #include "base/containers/flat_map.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -35,6 +35,8 @@ class NetworkFetcher {
   using ResponseStartedCallback = base::OnceCallback<
       void(const GURL& final_url, int response_code, int64_t content_length)>;
   using ProgressCallback = base::RepeatingCallback<void(int64_t current)>;
+  using DownloadDataCallback =
+      base::RepeatingCallback<void(int64_t offset, const std::string& data)>;
 
   // The ETag header carries the ECSDA signature of the POST response, if
   // signing has been used.
@@ -64,6 +66,13 @@ class NetworkFetcher {
       ProgressCallback progress_callback,
       DownloadToFileCompleteCallback download_to_file_complete_callback) = 0;
 
+  // Sets a callback that DownloadToFile() runs with each chunk of the response
+  // body, before the chunk is written, along with its offset in the body. The
+  // offset goes back to 0 when the request is retried. Fetchers which do not
+  // see the body as it is received ignore the callback.
+  virtual void SetDownloadDataCallback(
+      DownloadDataCallback download_data_callback) {}
+
  protected:
   NetworkFetcher() = default;
 
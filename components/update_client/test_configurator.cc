@@ -40,6 +40,7 @@ TestConfigurator::TestConfigurator()
       ondemand_time_(0),
       enabled_cup_signing_(false),
       enabled_component_updates_(true),
+      max_concurrent_downloads_(1),
       unzip_factory_(base::MakeRefCounted<update_client::UnzipChromiumFactory>(
           base::BindRepeating(&unzip::LaunchInProcessUnzipper))),
       patch_factory_(base::MakeRefCounted<update_client::PatchChromiumFactory>(
@@ -70,6 +71,10 @@ int TestConfigurator::UpdateDelay() const {
   return 1;
 }
 
+int TestConfigurator::MaxConcurrentDownloads() const {
+  return max_concurrent_downloads_;
+}
+
 std::vector<GURL> TestConfigurator::UpdateUrl() const {
   if (!update_check_url_.is_empty())
     return std::vector<GURL>(1, update_check_url_);
@@ -185,6 +190,10 @@ void TestConfigurator::SetAppGuid(const std::string& app_guid) {
   app_guid_ = app_guid;
 }
 
+void TestConfigurator::SetMaxConcurrentDownloads(int max_concurrent_downloads) {
+  max_concurrent_downloads_ = max_concurrent_downloads;
+}
+
 PrefService* TestConfigurator::GetPrefService() const {
   return nullptr;
 }
@@ -76,6 +76,7 @@ class TestConfigurator : public Configurator {
   int NextCheckDelay() const override;
   int OnDemandDelay() const override;
   int UpdateDelay() const override;
+  int MaxConcurrentDownloads() const override;
   std::vector<GURL> UpdateUrl() const override;
   std::vector<GURL> PingUrl() const override;
   std::string GetProdId() const override;
@@ -111,6 +112,7 @@ class TestConfigurator : public Configurator {
   void SetUpdateCheckUrl(const GURL& url);
   void SetPingUrl(const GURL& url);
   void SetAppGuid(const std::string& app_guid);
+  void SetMaxConcurrentDownloads(int max_concurrent_downloads);
   network::TestURLLoaderFactory* test_url_loader_factory() {
     return &test_url_loader_factory_;
   }
@@ -130,6 +132,7 @@ class TestConfigurator : public Configurator {
   GURL update_check_url_;
   GURL ping_url_;
   std::string app_guid_;
+  int max_concurrent_downloads_;
 
   scoped_refptr<update_client::UnzipChromiumFactory> unzip_factory_;
   scoped_refptr<update_client::PatchChromiumFactory> patch_factory_;
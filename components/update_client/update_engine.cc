@@ -28,6 +28,21 @@
 
 namespace update_client {
 
+namespace {
+
+bool IsDownloadState(ComponentState state) {
+  return state == ComponentState::kDownloadingDiff ||
+         state == ComponentState::kDownloading;
+}
+
+// Running an action is local work too, so it shares the install stage.
+bool IsInstallState(ComponentState state) {
+  return state == ComponentState::kUpdatingDiff ||
+         state == ComponentState::kUpdating || state == ComponentState::kRun;
+}
+
+}  // namespace
+
 UpdateContext::UpdateContext(
     scoped_refptr<Configurator> config,
     bool is_foreground,
@@ -299,17 +314,15 @@ void UpdateEngine::HandleComponent(
   DCHECK(thread_checker_.CalledOnValidThread());
   DCHECK(update_context);
 
+  if (config_->MaxConcurrentDownloads() > 1) {
+    HandleComponentsPipelined(update_context);
+    return;
+  }
+
   auto& queue = update_context->component_queue;
 
   if (queue.empty()) {
-    const Error error = update_context->update_check_error
-                            ? Error::UPDATE_CHECK_ERROR
-                            : Error::NONE;
-
-    base::ThreadTaskRunnerHandle::Get()->PostTask(
-        FROM_HERE,
-        base::BindOnce(&UpdateEngine::UpdateComplete, base::Unretained(this),
-                       update_context, error));
+    PostUpdateComplete(update_context);
     return;
   }
 
@@ -365,6 +378,130 @@ void UpdateEngine::HandleComponentComplete(
                                 base::Unretained(this), update_context));
 }
 
+void UpdateEngine::HandleComponentsPipelined(
+    scoped_refptr<UpdateContext> update_context) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  DCHECK(update_context);
+
+  auto& queue = update_context->component_queue;
+  auto& pipeline = update_context->pipeline;
+  while (!queue.empty()) {
+    pipeline.push_back(queue.front());
+    queue.pop();
+  }
+
+  if (pipeline.empty()) {
+    PostUpdateComplete(update_context);
+    return;
+  }
+
+  auto& busy_components = update_context->busy_components;
+  const size_t max_downloads = config_->MaxConcurrentDownloads();
+  size_t num_downloads = 0;
+  bool is_installing = false;
+  for (const auto& id : busy_components) {
+    const ComponentState state = update_context->components.at(id)->state();
+    if (IsDownloadState(state))
+      ++num_downloads;
+    else if (IsInstallState(state))
+      is_installing = true;
+  }
+
+  for (const auto& id : pipeline) {
+    if (base::Contains(busy_components, id))
+      continue;
+
+    DCHECK_EQ(1u, update_context->components.count(id));
+    const auto& component = update_context->components.at(id);
+    DCHECK(component);
+
+    const ComponentState state = component->state();
+    if (IsDownloadState(state)) {
+      if (num_downloads >= max_downloads)
+        continue;
+      ++num_downloads;
+    } else if (IsInstallState(state)) {
+      if (is_installing)
+        continue;
+      const base::TimeTicks now = base::TimeTicks::Now();
+      if (now < update_context->next_install_time) {
+        if (!update_context->is_install_delayed) {
+          update_context->is_install_delayed = true;
+          base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+              FROM_HERE,
+              base::BindOnce(&UpdateEngine::EndInstallDelay,
+                             base::Unretained(this), update_context),
+              update_context->next_install_time - now);
+          notify_observers_callback_.Run(
+              UpdateClient::Observer::Events::COMPONENT_WAIT, id);
+        }
+        continue;
+      }
+      is_installing = true;
+    }
+
+    busy_components.insert(id);
+    component->Handle(
+        base::BindOnce(&UpdateEngine::HandlePipelinedComponentComplete,
+                       base::Unretained(this), update_context, id));
+  }
+}
+
+void UpdateEngine::HandlePipelinedComponentComplete(
+    scoped_refptr<UpdateContext> update_context,
+    const std::string& id) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  DCHECK(update_context);
+
+  const auto num_erased = update_context->busy_components.erase(id);
+  DCHECK_EQ(1u, num_erased);
+
+  DCHECK_EQ(1u, update_context->components.count(id));
+  const auto& component = update_context->components.at(id);
+  DCHECK(component);
+
+  if (component->IsHandled()) {
+    update_context->next_install_time =
+        std::max(update_context->next_install_time,
+                 base::TimeTicks::Now() + component->GetUpdateDuration());
+
+    if (!component->events().empty()) {
+      ping_manager_->SendPing(*component,
+                              base::BindOnce([](int, const std::string&) {}));
+    }
+
+    base::Erase(update_context->pipeline, id);
+  }
+
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(&UpdateEngine::HandleComponentsPipelined,
+                                base::Unretained(this), update_context));
+}
+
+void UpdateEngine::EndInstallDelay(
+    scoped_refptr<UpdateContext> update_context) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  DCHECK(update_context);
+
+  update_context->is_install_delayed = false;
+  HandleComponentsPipelined(update_context);
+}
+
+void UpdateEngine::PostUpdateComplete(
+    scoped_refptr<UpdateContext> update_context) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  DCHECK(update_context);
+
+  const Error error = update_context->update_check_error
+                          ? Error::UPDATE_CHECK_ERROR
+                          : Error::NONE;
+
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE,
+      base::BindOnce(&UpdateEngine::UpdateComplete, base::Unretained(this),
+                     update_context, error));
+}
+
 void UpdateEngine::UpdateComplete(scoped_refptr<UpdateContext> update_context,
                                   Error error) {
   DCHECK(thread_checker_.CalledOnValidThread());
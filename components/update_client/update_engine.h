@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "base/callback.h"
+#include "base/containers/flat_set.h"
 #include "base/containers/queue.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -36,7 +37,9 @@ struct UpdateContext;
 
 // Handles updates for a group of components. Updates for different groups
 // are run concurrently but within the same group of components, updates are
-// applied one at a time.
+// applied one at a time. When the configurator allows more than one download
+// at a time, the downloads of a group are pipelined: up to that many
+// components download while the component before them is installed.
 class UpdateEngine : public base::RefCounted<UpdateEngine> {
  public:
   using Callback = base::OnceCallback<void(Error error)>;
@@ -92,6 +95,18 @@ class UpdateEngine : public base::RefCounted<UpdateEngine> {
   void HandleComponent(scoped_refptr<UpdateContext> update_context);
   void HandleComponentComplete(scoped_refptr<UpdateContext> update_context);
 
+  // Moves every component of |update_context| which is not being handled on
+  // to its next state, as long as there is room in the download or install
+  // stage this state belongs to.
+  void HandleComponentsPipelined(scoped_refptr<UpdateContext> update_context);
+  void HandlePipelinedComponentComplete(
+      scoped_refptr<UpdateContext> update_context,
+      const std::string& id);
+  void EndInstallDelay(scoped_refptr<UpdateContext> update_context);
+
+  // Completes the update once all components have been handled.
+  void PostUpdateComplete(scoped_refptr<UpdateContext> update_context);
+
   // Returns true if the update engine rejects this update call because it
   // occurs too soon.
   bool IsThrottled(bool is_foreground) const;
@@ -184,6 +199,17 @@ struct UpdateContext : public base::RefCounted<UpdateContext> {
   // is handling the next component in the queue.
   base::TimeDelta next_update_delay;
 
+  // Used instead of |component_queue| when the downloads are pipelined.
+  // Contains the ids of the components not handled yet, in queue order, and
+  // the ids of those waiting for a call to |Component::Handle| to complete.
+  std::vector<std::string> pipeline;
+  base::flat_set<std::string> busy_components;
+
+  // Takes the place of |next_update_delay| when the downloads are pipelined.
+  // Only installs wait for this time; downloads go ahead.
+  base::TimeTicks next_install_time;
+  bool is_install_delayed = false;
+
   // The unique session id of this context. The session id is serialized in
   // every protocol request. It is also used as a key in various data stuctures
   // to uniquely identify an update context.
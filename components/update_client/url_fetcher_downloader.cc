@@ -77,6 +77,8 @@ void UrlFetcherDownloader::StartURLFetch(const GURL& url) {
 
   const auto file_path = download_dir_.AppendASCII(url.ExtractFileName());
   network_fetcher_ = network_fetcher_factory_->Create();
+  network_fetcher_->SetDownloadDataCallback(base::BindRepeating(
+      &UrlFetcherDownloader::OnResponseData, base::Unretained(this)));
   network_fetcher_->DownloadToFile(
       url, file_path,
       base::BindOnce(&UrlFetcherDownloader::OnResponseStarted,
@@ -83,6 +83,44 @@ bool VerifyFileHash256(const base::FilePath& filepath,
   return memcmp(actual_hash, &expected_hash[0], sizeof(actual_hash)) == 0;
 }
 
+StreamHasher256::StreamHasher256()
+    : hash_(crypto::SecureHash::Create(crypto::SecureHash::SHA256)) {}
+
+StreamHasher256::~StreamHasher256() = default;
+
+void StreamHasher256::Update(int64_t offset, const std::string& data) {
+  // A retried response starts over from its first byte.
+  if (offset == 0) {
+    hash_ = crypto::SecureHash::Create(crypto::SecureHash::SHA256);
+    size_ = 0;
+    has_error_ = false;
+  }
+  if (has_error_)
+    return;
+  if (offset != size_) {
+    has_error_ = true;
+    return;
+  }
+  hash_->Update(data.data(), data.size());
+  size_ += data.size();
+}
+
+bool StreamHasher256::Verify(const std::string& expected_hash_str) {
+  std::vector<uint8_t> expected_hash;
+  if (has_error_ ||
+      !base::HexStringToBytes(expected_hash_str, &expected_hash) ||
+      expected_hash.size() != crypto::kSHA256Length) {
+    return false;
+  }
+
+  uint8_t actual_hash[crypto::kSHA256Length] = {0};
+  hash_->Finish(actual_hash, sizeof(actual_hash));
+  // The hash is finished, so it cannot be updated or verified again.
+  has_error_ = true;
+
+  return memcmp(actual_hash, &expected_hash[0], sizeof(actual_hash)) == 0;
+}
+
 bool IsValidBrand(const std::string& brand) {
   const size_t kMaxBrandSize = 4;
   if (!brand.empty() && brand.size() != kMaxBrandSize)
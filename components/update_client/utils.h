@@ -5,12 +5,15 @@
 #ifndef COMPONENTS_UPDATE_CLIENT_UTILS_H_
 #define COMPONENTS_UPDATE_CLIENT_UTILS_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/callback_forward.h"
+#include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "components/update_client/update_client.h"
 
@@ -21,6 +24,10 @@ class DictionaryValue;
 class FilePath;
 }
 
+namespace crypto {
+class SecureHash;
+}
+
 namespace update_client {
 
 class Component;
@@ -54,6 +61,36 @@ std::string GetCrxIdFromPublicKeyHash(const std::vector<uint8_t>& pk_hash);
 bool VerifyFileHash256(const base::FilePath& filepath,
                        const std::string& expected_hash);
 
+// Computes the SHA-256 hash of a download from the chunks of its response
+// body, as they are received, so that the complete download is never read
+// again to verify it. Use it on one sequence only.
+class StreamHasher256 {
+ public:
+  StreamHasher256();
+  ~StreamHasher256();
+
+  // The number of bytes hashed so far.
+  int64_t size() const { return size_; }
+
+  // Hashes |data|, the bytes of the response at |offset|. An |offset| of 0
+  // starts the hash over, as the whole response is received again when the
+  // request is retried. Any other |offset| must follow the bytes hashed so far.
+  void Update(int64_t offset, const std::string& data);
+
+  // Returns true if the hash of the bytes received matches |expected_hash|.
+  // Can only be called once.
+  bool Verify(const std::string& expected_hash);
+
+ private:
+  std::unique_ptr<crypto::SecureHash> hash_;
+  int64_t size_ = 0;
+
+  // True if some bytes were missed, in which case it never verifies.
+  bool has_error_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamHasher256);
+};
+
 // Returns true if the |brand| parameter matches ^[a-zA-Z]{4}?$ .
 bool IsValidBrand(const std::string& brand);
 
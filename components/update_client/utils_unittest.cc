@@ -7,6 +7,7 @@
 #include <iterator>
 
 #include "base/files/file_path.h"
+#include "base/files/file_util.h"
 #include "base/path_service.h"
 #include "components/update_client/updater_state.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -47,6 +48,45 @@ TEST(UpdateClientUtils, VerifyFileHash256) {
           "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa")));
 }
 
+// Tests hashing a download in chunks, as it is received.
+TEST(UpdateClientUtils, StreamHasher256) {
+  const char kHash[] =
+      "7ab32f071cd9b5ef8e0d7913be161f532d98b3e9fa284a7cd8059c3409ce0498";
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(
+      MakeTestFilePath("jebgalgnebhfojomionfpkfelancnnkf.crx"), &contents));
+  const size_t split = contents.size() / 3;
+
+  StreamHasher256 hasher;
+  hasher.Update(0, contents.substr(0, split));
+  hasher.Update(split, contents.substr(split, split));
+  hasher.Update(2 * split, std::string());
+  hasher.Update(2 * split, contents.substr(2 * split));
+  EXPECT_EQ(static_cast<int64_t>(contents.size()), hasher.size());
+  EXPECT_TRUE(hasher.Verify(kHash));
+
+  // A retry sends the response again from its first byte.
+  StreamHasher256 retried_hasher;
+  retried_hasher.Update(0, contents.substr(0, split));
+  retried_hasher.Update(0, contents.substr(0, split));
+  retried_hasher.Update(split, contents.substr(split));
+  EXPECT_TRUE(retried_hasher.Verify(kHash));
+
+  StreamHasher256 truncated_hasher;
+  truncated_hasher.Update(0, contents.substr(0, split));
+  EXPECT_FALSE(truncated_hasher.Verify(kHash));
+
+  // A missed chunk fails the verification even if the rest is received.
+  StreamHasher256 gap_hasher;
+  gap_hasher.Update(0, contents.substr(0, split));
+  gap_hasher.Update(2 * split, contents.substr(2 * split));
+  EXPECT_FALSE(gap_hasher.Verify(kHash));
+
+  StreamHasher256 bad_hash_hasher;
+  bad_hash_hasher.Update(0, contents);
+  EXPECT_FALSE(bad_hash_hasher.Verify("abcd"));
+}
+
 // Tests that the brand matches ^[a-zA-Z]{4}?$
 TEST(UpdateClientUtils, IsValidBrand) {
   // The valid brand code must be empty or exactly 4 chars long.
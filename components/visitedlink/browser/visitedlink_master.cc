@@ -21,6 +21,7 @@
 #include "base/stl_util.h"
 #include "base/strings/string_util.h"
 #include "base/threading/thread_restrictions.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "build/build_config.h"
 #include "components/visitedlink/browser/visitedlink_delegate.h"
 #include "components/visitedlink/browser/visitedlink_event_listener.h"
@@ -45,7 +46,9 @@ const int32_t VisitedLinkMaster::kFileHeaderLengthOffset = 8;
 const int32_t VisitedLinkMaster::kFileHeaderUsedOffset = 12;
 const int32_t VisitedLinkMaster::kFileHeaderSaltOffset = 16;
 
-const int32_t VisitedLinkMaster::kFileCurrentVersion = 3;
+// Version 4 lists the fingerprints of the table instead of storing the table.
+const int32_t VisitedLinkMaster::kFileCurrentVersion = 4;
+const int32_t VisitedLinkMaster::kFileFullTableVersion = 3;
 
 // the signature at the beginning of the URL table = "VLnk" (visited links)
 const int32_t VisitedLinkMaster::kFileSignature = 0x6b6e4c56;
@@ -56,10 +59,21 @@ const size_t VisitedLinkMaster::kFileHeaderSize =
 // table in NewTableSizeForCount (prime number).
 const unsigned VisitedLinkMaster::kDefaultTableSize = 16381;
 
-const size_t VisitedLinkMaster::kBigDeleteThreshold = 64;
+const int32_t VisitedLinkMaster::kTableMigrationSliceSize = 65536;
 
 namespace {
 
+// Load limits for good performance/space. We are pretty conservative about
+// keeping the table not very full. This is because we use linear probing
+// which increases the likelihood of clumps of entries which will reduce
+// performance.
+const float kMaxTableLoad = 0.5f;  // Grow when we're > this full.
+const float kMinTableLoad = 0.2f;  // Shrink when we're < this full.
+
+// While the table grows incrementally the current table keeps filling up.
+// Past this load, the rest of the migration happens at once.
+const float kMaxMigratingTableLoad = 0.7f;
+
 // Fills the given salt structure with some quasi-random values
 // It is not necessary to generate a cryptographically strong random string,
 // only that it be reasonably different for different users.
@@ -129,13 +143,16 @@ struct VisitedLinkMaster::LoadFromFileResult
                      base::MappedReadOnlyRegion hash_table_memory,
                      int32_t num_entries,
                      int32_t used_count,
-                     uint8_t salt[LINK_SALT_LENGTH]);
+                     uint8_t salt[LINK_SALT_LENGTH],
+                     bool needs_rewrite);
 
   base::ScopedFILE file;
   base::MappedReadOnlyRegion hash_table_memory;
   int32_t num_entries;
   int32_t used_count;
   uint8_t salt[LINK_SALT_LENGTH];
+  // Set when the file uses an older format.
+  bool needs_rewrite;
 
  private:
   friend class base::RefCountedThreadSafe<LoadFromFileResult>;
@@ -149,17 +166,31 @@ VisitedLinkMaster::LoadFromFileResult::LoadFromFileResult(
     base::MappedReadOnlyRegion hash_table_memory,
     int32_t num_entries,
     int32_t used_count,
-    uint8_t salt[LINK_SALT_LENGTH])
+    uint8_t salt[LINK_SALT_LENGTH],
+    bool needs_rewrite)
     : file(std::move(file)),
       hash_table_memory(std::move(hash_table_memory)),
       num_entries(num_entries),
-      used_count(used_count) {
+      used_count(used_count),
+      needs_rewrite(needs_rewrite) {
   memcpy(this->salt, salt, LINK_SALT_LENGTH);
 }
 
 VisitedLinkMaster::LoadFromFileResult::~LoadFromFileResult() {
 }
 
+// TableMigration -------------------------------------------------------------
+
+struct VisitedLinkMaster::TableMigration {
+  base::MappedReadOnlyRegion memory;
+  Fingerprint* hash_table = nullptr;
+  int32_t table_length = 0;
+  int32_t used_items = 0;
+
+  // The entries of the current table before this one have been copied.
+  int32_t next_entry = 0;
+};
+
 // TableBuilder ---------------------------------------------------------------
 
 // How rebuilding from history works
@@ -170,10 +201,10 @@ VisitedLinkMaster::LoadFromFileResult::~LoadFromFileResult() {
 // will be called on the history thread by the history system for every URL
 // in the database.
 //
-// The builder will store the fingerprints for those URLs, and then marshalls
-// back to the main thread where the VisitedLinkMaster will be notified. The
-// master then replaces its table with a new table containing the computed
-// fingerprints.
+// The builder will store the fingerprints for those URLs and, once the history
+// system is done, put them in a new table on the history thread. It then
+// marshalls back to the main thread where the VisitedLinkMaster will be
+// notified. The master then replaces its table with the new table.
 //
 // The builder must remain active while the history system is using it.
 // Sometimes, the master will be deleted before the rebuild is complete, in
@@ -213,6 +244,11 @@ class VisitedLinkMaster::TableBuilder
   // Stores the fingerprints we computed on the background thread.
   VisitedLinkCommon::Fingerprints fingerprints_;
 
+  // The table made of |fingerprints_| on the background thread.
+  base::MappedReadOnlyRegion table_memory_;
+  int32_t table_length_ = 0;
+  int32_t used_count_ = 0;
+
   DISALLOW_COPY_AND_ASSIGN(TableBuilder);
 };
 
@@ -330,7 +366,13 @@ VisitedLinkMaster::Hash VisitedLinkMaster::TryToAddURL(const GURL& url) {
   if (used_items_ / 8 > table_length_ / 10)
     return null_hash_;  // Table is more than 80% full.
 
-  return AddFingerprint(fingerprint, true);
+  Hash index = AddFingerprint(fingerprint, true);
+  if (index != null_hash_ && table_migration_ &&
+      AddFingerprintToTable(fingerprint, table_migration_->hash_table,
+                            table_migration_->table_length)) {
+    table_migration_->used_items++;
+  }
+  return index;
 }
 
 void VisitedLinkMaster::PostIOTask(const base::Location& from_here,
@@ -342,16 +384,20 @@ void VisitedLinkMaster::PostIOTask(const base::Location& from_here,
 void VisitedLinkMaster::AddURL(const GURL& url) {
   Hash index = TryToAddURL(url);
   if (!table_builder_ && !table_is_loading_from_file_ && index != null_hash_) {
-    // Not rebuilding, so we want to keep the file on disk up to date.
+    // Not rebuilding, so we want to keep the file on disk up to date. The
+    // fingerprint goes first so that the count never covers a missing one.
     if (persist_to_disk_) {
+      WriteFingerprintToFile(used_items_ - 1, hash_table_[index]);
       WriteUsedItemCountToFile();
-      WriteHashRangeToFile(index, index);
     }
-    ResizeTableIfNecessary();
+    if (!GrowTableIncrementallyIfNecessary())
+      ResizeTableIfNecessary();
   }
 }
 
 void VisitedLinkMaster::AddURLs(const std::vector<GURL>& urls) {
+  // The file is rewritten anyway, so the table may as well be resized at once.
+  FinishTableMigration();
   for (const GURL& url : urls) {
     Hash index = TryToAddURL(url);
     if (!table_builder_ && !table_is_loading_from_file_ && index != null_hash_)
@@ -372,6 +418,9 @@ void VisitedLinkMaster::DeleteAllURLs() {
   deleted_since_load_.clear();
   table_is_loading_from_file_ = false;
 
+  // The table being grown into is as stale.
+  CancelTableMigration();
+
   // Clear the hash table.
   used_items_ = 0;
   memset(hash_table_, 0, this->table_length_ * sizeof(Fingerprint));
@@ -392,6 +441,9 @@ void VisitedLinkMaster::DeleteURLs(URLIterator* urls) {
   if (!urls->HasNextURL())
     return;
 
+  // Deleting moves fingerprints around, which a migration can't follow.
+  FinishTableMigration();
+
   listener_->Reset(false);
 
   if (table_builder_.get() || table_is_loading_from_file_) {
@@ -472,20 +524,41 @@ VisitedLinkMaster::Hash VisitedLinkMaster::AddFingerprint(
   }
 }
 
+// static
+bool VisitedLinkMaster::AddFingerprintToTable(Fingerprint fingerprint,
+                                              Fingerprint* hash_table,
+                                              int32_t table_length) {
+  Hash first_hash = HashFingerprint(fingerprint, table_length);
+  Hash cur_hash = first_hash;
+  while (true) {
+    if (hash_table[cur_hash] == fingerprint)
+      return false;  // Already there.
+
+    if (!hash_table[cur_hash]) {
+      hash_table[cur_hash] = fingerprint;
+      return true;
+    }
+
+    cur_hash = cur_hash >= table_length - 1 ? 0 : cur_hash + 1;
+    if (cur_hash == first_hash)
+      return false;  // The table is full.
+  }
+}
+
 void VisitedLinkMaster::DeleteFingerprintsFromCurrentTable(
     const std::set<Fingerprint>& fingerprints) {
-  bool bulk_write = (fingerprints.size() > kBigDeleteThreshold);
-
-  // Delete the URLs from the table.
+  // Delete the URLs from the table. The file lists the fingerprints rather
+  // than storing the table, so it is rewritten once at the end.
+  bool deleted = false;
   for (auto i = fingerprints.begin(); i != fingerprints.end(); ++i)
-    DeleteFingerprint(*i, !bulk_write);
+    deleted |= DeleteFingerprint(*i, false);
 
   // These deleted fingerprints may make us shrink the table.
   if (ResizeTableIfNecessary())
     return;  // The resize function wrote the new table to disk for us.
 
   // Nobody wrote this out for us, write the full file to disk.
-  if (bulk_write && persist_to_disk_)
+  if (deleted && persist_to_disk_)
     WriteFullTable();
 }
 
@@ -498,10 +571,7 @@ bool VisitedLinkMaster::DeleteFingerprint(Fingerprint fingerprint,
   if (!IsVisited(fingerprint))
     return false;  // Not in the database to delete.
 
-  // First update the header used count.
   used_items_--;
-  if (update_file && persist_to_disk_)
-    WriteUsedItemCountToFile();
 
   Hash deleted_hash = HashFingerprint(fingerprint);
 
@@ -543,9 +613,9 @@ bool VisitedLinkMaster::DeleteFingerprint(Fingerprint fingerprint,
       AddFingerprint(shuffled_fingerprints[i], false);
   }
 
-  // Write the affected range to disk [deleted_hash, end_range].
+  // The fingerprint may be anywhere in the file, rewrite all of it.
   if (update_file && persist_to_disk_)
-    WriteHashRangeToFile(deleted_hash, end_range);
+    WriteFullTable();
 
   return true;
 }
@@ -581,11 +651,21 @@ void VisitedLinkMaster::WriteFullTable() {
   WriteToFile(file_, 0, header, sizeof(header));
   WriteToFile(file_, sizeof(header), salt_, LINK_SALT_LENGTH);
 
-  // Write the hash data.
-  WriteToFile(file_, kFileHeaderSize,
-              hash_table_, table_length_ * sizeof(Fingerprint));
+  // Write the fingerprints, leaving out the empty entries of the table.
+  std::vector<Fingerprint> fingerprints;
+  fingerprints.reserve(used_items_);
+  for (int32_t i = 0; i < table_length_; i++) {
+    if (hash_table_[i])
+      fingerprints.push_back(hash_table_[i]);
+  }
+  DCHECK_EQ(used_items_, static_cast<int32_t>(fingerprints.size()));
+  if (!fingerprints.empty()) {
+    WriteToFile(file_, kFileHeaderSize, fingerprints.data(),
+                fingerprints.size() * sizeof(Fingerprint));
+  }
 
-  // The hash table may have shrunk, so make sure this is the end.
+  // There may be fewer fingerprints than before, so make sure this is the
+  // end.
   PostIOTask(FROM_HERE, base::Bind(&AsyncTruncate, file_));
 }
 
@@ -631,25 +711,55 @@ bool VisitedLinkMaster::LoadApartFromFile(
   if (!file_closer.get())
     return false;
 
-  int32_t num_entries, used_count;
+  int32_t version, num_entries, used_count;
   uint8_t salt[LINK_SALT_LENGTH];
-  if (!ReadFileHeader(file_closer.get(), &num_entries, &used_count, salt))
+  if (!ReadFileHeader(file_closer.get(), &version, &num_entries, &used_count,
+                      salt)) {
     return false;  // Header isn't valid.
+  }
 
-  // Allocate and read the table.
   base::MappedReadOnlyRegion hash_table_memory;
-  if (!CreateApartURLTable(num_entries, salt, &hash_table_memory))
+  if (version == kFileFullTableVersion) {
+    // The file stores the table itself, read it as is.
+    if (!CreateApartURLTable(num_entries, salt, &hash_table_memory))
+      return false;
+
+    if (!ReadFromFile(file_closer.get(), kFileHeaderSize,
+                      GetHashTableFromMapping(hash_table_memory.mapping),
+                      num_entries * sizeof(Fingerprint))) {
+      return false;
+    }
+
+    *load_from_file_result = new LoadFromFileResult(
+        std::move(file_closer), std::move(hash_table_memory), num_entries,
+        used_count, salt, true);
+    return true;
+  }
+
+  // Read the fingerprints and add them to a table that fits them.
+  std::vector<Fingerprint> fingerprints(used_count);
+  if (used_count &&
+      !ReadFromFile(file_closer.get(), kFileHeaderSize, fingerprints.data(),
+                    used_count * sizeof(Fingerprint))) {
     return false;
+  }
 
-  if (!ReadFromFile(file_closer.get(), kFileHeaderSize,
-                    GetHashTableFromMapping(hash_table_memory.mapping),
-                    num_entries * sizeof(Fingerprint))) {
+  num_entries = NewTableSizeForCount(used_count);
+  if (!CreateApartURLTable(num_entries, salt, &hash_table_memory))
     return false;
+
+  Fingerprint* hash_table = GetHashTableFromMapping(hash_table_memory.mapping);
+  for (Fingerprint fingerprint : fingerprints) {
+    // An empty or repeated fingerprint means the file is corrupt.
+    if (!fingerprint ||
+        !AddFingerprintToTable(fingerprint, hash_table, num_entries)) {
+      return false;
+    }
   }
 
   *load_from_file_result = new LoadFromFileResult(
       std::move(file_closer), std::move(hash_table_memory), num_entries,
-      used_count, salt);
+      used_count, salt, false);
   return true;
 }
 
@@ -689,6 +799,10 @@ void VisitedLinkMaster::OnTableLoadComplete(
 
   DCHECK(load_from_file_result);
 
+  // Nothing can have been added through a migration while loading, but the
+  // table is about to be replaced in any case.
+  CancelTableMigration();
+
   // Delete the previous table.
   DCHECK(mapped_table_memory_.region.IsValid());
   mapped_table_memory_ = base::MappedReadOnlyRegion();
@@ -715,6 +829,7 @@ void VisitedLinkMaster::OnTableLoadComplete(
   // Send an update notification to all child processes.
   listener_->NewTable(&mapped_table_memory_.region);
 
+  const bool needs_rewrite = load_from_file_result->needs_rewrite;
   if (!added_since_load_.empty() || !deleted_since_load_.empty()) {
     // Resize the table if the table doesn't have enough capacity.
     int new_used_items =
@@ -741,6 +856,9 @@ void VisitedLinkMaster::OnTableLoadComplete(
 
     if (persist_to_disk_)
       WriteFullTable();
+  } else if (needs_rewrite) {
+    // Convert the file to the current format.
+    WriteFullTable();
   }
 
   // All tabs which was loaded when table was being loaded drop their cached
@@ -766,6 +884,7 @@ bool VisitedLinkMaster::InitFromScratch(bool suppress_rebuild) {
 
 // static
 bool VisitedLinkMaster::ReadFileHeader(FILE* file,
+                                       int32_t* version,
                                        int32_t* num_entries,
                                        int32_t* used_count,
                                        uint8_t salt[LINK_SALT_LENGTH]) {
@@ -777,7 +896,7 @@ bool VisitedLinkMaster::ReadFileHeader(FILE* file,
     return false;
   size_t file_size = ftell(file);
 
-  if (file_size <= kFileHeaderSize)
+  if (file_size < kFileHeaderSize)
     return false;
 
   uint8_t header[kFileHeaderSize];
@@ -790,24 +909,29 @@ bool VisitedLinkMaster::ReadFileHeader(FILE* file,
   if (signature != kFileSignature)
     return false;
 
-  // Verify the version is up to date. As with other read errors, a version
+  // Verify the version is known. As with other read errors, a version
   // mistmatch will trigger a rebuild of the database from history, which will
   // have the effect of migrating the database.
-  int32_t version;
-  memcpy(&version, &header[kFileHeaderVersionOffset], sizeof(version));
-  if (version != kFileCurrentVersion)
+  memcpy(version, &header[kFileHeaderVersionOffset], sizeof(*version));
+  if (*version != kFileCurrentVersion && *version != kFileFullTableVersion)
     return false;  // Bad version.
 
-  // Read the table size and make sure it matches the file size.
+  // Read the table size and the used item count.
   memcpy(num_entries, &header[kFileHeaderLengthOffset], sizeof(*num_entries));
-  if (*num_entries * sizeof(Fingerprint) + kFileHeaderSize != file_size)
-    return false;  // Bad size.
-
-  // Read the used item count.
   memcpy(used_count, &header[kFileHeaderUsedOffset], sizeof(*used_count));
-  if (*used_count > *num_entries)
+  if (*num_entries <= 0 || *used_count < 0 || *used_count > *num_entries)
     return false;  // Bad used item count;
 
+  // Make sure the sizes match the file size. The current format has one
+  // fingerprint per used item. Anything past them is left over from a write
+  // that didn't finish, and is dropped when the file is next rewritten.
+  if (*version == kFileFullTableVersion) {
+    if (*num_entries * sizeof(Fingerprint) + kFileHeaderSize != file_size)
+      return false;  // Bad size.
+  } else if (*used_count * sizeof(Fingerprint) + kFileHeaderSize > file_size) {
+    return false;  // Bad size.
+  }
+
   // Read the salt.
   memcpy(salt, &header[kFileHeaderSaltOffset], LINK_SALT_LENGTH);
 
@@ -902,23 +1026,16 @@ void VisitedLinkMaster::FreeURLTable() {
 bool VisitedLinkMaster::ResizeTableIfNecessary() {
   DCHECK(table_length_ > 0) << "Must have a table";
 
-  // Load limits for good performance/space. We are pretty conservative about
-  // keeping the table not very full. This is because we use linear probing
-  // which increases the likelihood of clumps of entries which will reduce
-  // performance.
-  const float max_table_load = 0.5f;  // Grow when we're > this full.
-  const float min_table_load = 0.2f;  // Shrink when we're < this full.
-
   float load = ComputeTableLoad();
-  if (load < max_table_load &&
+  if (load < kMaxTableLoad &&
       (table_length_ <= static_cast<float>(kDefaultTableSize) ||
-       load > min_table_load))
+       load > kMinTableLoad))
     return false;
 
   // Table needs to grow or shrink.
   int new_size = NewTableSizeForCount(used_items_);
   DCHECK(new_size > used_items_);
-  DCHECK(load <= min_table_load || new_size > table_length_);
+  DCHECK(load <= kMinTableLoad || new_size > table_length_);
   ResizeTable(new_size);
   return true;
 }
@@ -926,6 +1043,7 @@ bool VisitedLinkMaster::ResizeTableIfNecessary() {
 void VisitedLinkMaster::ResizeTable(int32_t new_size) {
   DCHECK(mapped_table_memory_.region.IsValid() &&
          mapped_table_memory_.mapping.IsValid());
+  DCHECK(!table_migration_);
   shared_memory_serial_++;
 
 #ifndef NDEBUG
@@ -971,7 +1089,8 @@ uint32_t VisitedLinkMaster::DefaultTableSize() const {
   return kDefaultTableSize;
 }
 
-uint32_t VisitedLinkMaster::NewTableSizeForCount(int32_t item_count) const {
+// static
+uint32_t VisitedLinkMaster::NewTableSizeForCount(int32_t item_count) {
   // These table sizes are selected to be the maximum prime number less than
   // a "convenient" multiple of 1K.
   static const int table_sizes[] = {
@@ -1003,6 +1122,109 @@ uint32_t VisitedLinkMaster::NewTableSizeForCount(int32_t item_count) const {
   return item_count * 2 - 1;
 }
 
+bool VisitedLinkMaster::GrowTableIncrementallyIfNecessary() {
+  if (table_migration_) {
+    // Additions are outpacing the migration, finish it before the current
+    // table gets too full.
+    if (ComputeTableLoad() > kMaxMigratingTableLoad)
+      FinishTableMigration();
+    return true;
+  }
+
+  if (ComputeTableLoad() < kMaxTableLoad)
+    return false;
+
+  StartTableMigration(NewTableSizeForCount(used_items_));
+  return true;
+}
+
+void VisitedLinkMaster::StartTableMigration(int32_t new_size) {
+  DCHECK(!table_migration_);
+  DCHECK_GT(new_size, used_items_);
+
+  auto migration = std::make_unique<TableMigration>();
+  if (!CreateApartURLTable(new_size, salt_, &migration->memory))
+    return;
+  migration->hash_table = GetHashTableFromMapping(migration->memory.mapping);
+  migration->table_length = new_size;
+  table_migration_ = std::move(migration);
+
+  // Tables smaller than a slice are migrated right away, like before.
+  MigrateTableSlice();
+}
+
+void VisitedLinkMaster::MigrateTableSlice() {
+  if (!table_migration_)
+    return;  // Finished or canceled in the meantime.
+
+  MigrateTableEntries(
+      std::min(table_length_,
+               table_migration_->next_entry + TableMigrationSliceSize()));
+  if (table_migration_->next_entry == table_length_) {
+    CompleteTableMigration();
+    return;
+  }
+
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(&VisitedLinkMaster::MigrateTableSlice,
+                                weak_ptr_factory_.GetWeakPtr()));
+}
+
+void VisitedLinkMaster::MigrateTableEntries(int32_t end) {
+  DCHECK(table_migration_);
+  for (int32_t i = table_migration_->next_entry; i < end; i++) {
+    // The entries added since the migration started are there already.
+    if (hash_table_[i] &&
+        AddFingerprintToTable(hash_table_[i], table_migration_->hash_table,
+                              table_migration_->table_length)) {
+      table_migration_->used_items++;
+    }
+  }
+  table_migration_->next_entry = std::max(table_migration_->next_entry, end);
+}
+
+void VisitedLinkMaster::FinishTableMigration() {
+  if (!table_migration_)
+    return;
+
+  MigrateTableEntries(table_length_);
+  CompleteTableMigration();
+}
+
+void VisitedLinkMaster::CancelTableMigration() {
+  table_migration_.reset();
+}
+
+void VisitedLinkMaster::CompleteTableMigration() {
+  DCHECK(table_migration_);
+  DCHECK_EQ(used_items_, table_migration_->used_items);
+  shared_memory_serial_++;
+
+  mapped_table_memory_ = std::move(table_migration_->memory);
+  hash_table_ = table_migration_->hash_table;
+  table_length_ = table_migration_->table_length;
+  table_migration_.reset();
+
+#ifndef NDEBUG
+  DebugValidate();
+#endif
+
+  // Send an update notification to all child processes so they read the new
+  // table.
+  listener_->NewTable(&mapped_table_memory_.region);
+
+  // The file lists the same fingerprints as before.
+  if (persist_to_disk_)
+    WriteTableLengthToFile();
+}
+
+int32_t VisitedLinkMaster::TableMigrationSliceSize() const {
+  if (table_migration_slice_size_override_)
+    return table_migration_slice_size_override_;
+
+  return kTableMigrationSliceSize;
+}
+
 // See the TableBuilder definition in the header file for how this works.
 bool VisitedLinkMaster::RebuildTableFromDelegate() {
   DCHECK(!table_builder_);
@@ -1016,39 +1238,47 @@ bool VisitedLinkMaster::RebuildTableFromDelegate() {
 // See the TableBuilder declaration above for how this works.
 void VisitedLinkMaster::OnTableRebuildComplete(
     bool success,
-    const std::vector<Fingerprint>& fingerprints) {
+    base::MappedReadOnlyRegion table_memory,
+    int32_t table_length,
+    int32_t used_count) {
   if (success) {
-    // Replace the old table with a new blank one.
+    // Replace the old table with the rebuilt one.
+    CancelTableMigration();
     shared_memory_serial_++;
+    mapped_table_memory_ = std::move(table_memory);
+    hash_table_ = GetHashTableFromMapping(mapped_table_memory_.mapping);
+    table_length_ = table_length;
+    used_items_ = used_count;
 
-    int new_table_size = NewTableSizeForCount(
-        static_cast<int>(fingerprints.size() + added_since_rebuild_.size()));
-    if (BeginReplaceURLTable(new_table_size)) {
-      // Add the stored fingerprints to the hash table.
-      for (const auto& fingerprint : fingerprints)
-        AddFingerprint(fingerprint, false);
-
-      // Also add anything that was added while we were asynchronously
-      // generating the new table.
-      for (const auto& fingerprint : added_since_rebuild_)
-        AddFingerprint(fingerprint, false);
-      added_since_rebuild_.clear();
-
-      // Now handle deletions. Do not shrink the table now, we'll shrink it when
-      // adding or deleting an url the next time.
-      for (const auto& fingerprint : deleted_since_rebuild_)
-        DeleteFingerprint(fingerprint, false);
-      deleted_since_rebuild_.clear();
-
-      // Send an update notification to all child processes.
-      listener_->NewTable(&mapped_table_memory_.region);
-      // All tabs which was loaded when table was being rebuilt
-      // invalidate their links again.
-      listener_->Reset(false);
-
-      if (persist_to_disk_)
-        WriteFullTable();
-    }
+    // Make room for anything that was added while we were asynchronously
+    // generating the new table.
+    int new_used_items =
+        used_items_ + static_cast<int>(added_since_rebuild_.size());
+    if (new_used_items > table_length_ * kMaxTableLoad)
+      ResizeTable(NewTableSizeForCount(new_used_items));
+
+    for (const auto& fingerprint : added_since_rebuild_)
+      AddFingerprint(fingerprint, false);
+    added_since_rebuild_.clear();
+
+    // Now handle deletions. Do not shrink the table now, we'll shrink it when
+    // adding or deleting an url the next time.
+    for (const auto& fingerprint : deleted_since_rebuild_)
+      DeleteFingerprint(fingerprint, false);
+    deleted_since_rebuild_.clear();
+
+#ifndef NDEBUG
+    DebugValidate();
+#endif
+
+    // Send an update notification to all child processes.
+    listener_->NewTable(&mapped_table_memory_.region);
+    // All tabs which was loaded when table was being rebuilt
+    // invalidate their links again.
+    listener_->Reset(false);
+
+    if (persist_to_disk_)
+      WriteFullTable();
   }
   table_builder_ = nullptr;  // Will release our reference to the builder.
 
@@ -1077,26 +1307,21 @@ void VisitedLinkMaster::WriteUsedItemCountToFile() {
   WriteToFile(file_, kFileHeaderUsedOffset, &used_items_, sizeof(used_items_));
 }
 
-void VisitedLinkMaster::WriteHashRangeToFile(Hash first_hash, Hash last_hash) {
+void VisitedLinkMaster::WriteTableLengthToFile() {
   DCHECK(persist_to_disk_);
+  if (!file_)
+    return;  // See comment on the file_ variable for why this might happen.
+  WriteToFile(file_, kFileHeaderLengthOffset, &table_length_,
+              sizeof(table_length_));
+}
 
+void VisitedLinkMaster::WriteFingerprintToFile(int32_t index,
+                                               Fingerprint fingerprint) {
+  DCHECK(persist_to_disk_);
   if (!file_)
     return;  // See comment on the file_ variable for why this might happen.
-  if (last_hash < first_hash) {
-    // Handle wraparound at 0. This first write is first_hash->EOF
-    WriteToFile(file_, first_hash * sizeof(Fingerprint) + kFileHeaderSize,
-                &hash_table_[first_hash],
-                (table_length_ - first_hash + 1) * sizeof(Fingerprint));
-
-    // Now do 0->last_lash.
-    WriteToFile(file_, kFileHeaderSize, hash_table_,
-                (last_hash + 1) * sizeof(Fingerprint));
-  } else {
-    // Normal case, just write the range.
-    WriteToFile(file_, first_hash * sizeof(Fingerprint) + kFileHeaderSize,
-                &hash_table_[first_hash],
-                (last_hash - first_hash + 1) * sizeof(Fingerprint));
-  }
+  WriteToFile(file_, kFileHeaderSize + index * sizeof(Fingerprint),
+              &fingerprint, sizeof(fingerprint));
 }
 
 // static
@@ -1138,6 +1363,22 @@ void VisitedLinkMaster::TableBuilder::OnComplete(bool success) {
   success_ = success;
   DLOG_IF(WARNING, !success) << "Unable to rebuild visited links";
 
+  // Build the new table here rather than on the main thread, it takes a while
+  // for a long history.
+  if (success_) {
+    table_length_ =
+        NewTableSizeForCount(static_cast<int32_t>(fingerprints_.size()));
+    success_ = CreateApartURLTable(table_length_, salt_, &table_memory_);
+  }
+  if (success_) {
+    Fingerprint* hash_table = GetHashTableFromMapping(table_memory_.mapping);
+    for (Fingerprint fingerprint : fingerprints_) {
+      if (AddFingerprintToTable(fingerprint, hash_table, table_length_))
+        used_count_++;
+    }
+  }
+  fingerprints_.clear();
+
   // Marshal to the main thread to notify the VisitedLinkMaster that the
   // rebuild is complete.
   base::PostTask(FROM_HERE, {BrowserThread::UI},
@@ -1145,8 +1386,10 @@ void VisitedLinkMaster::TableBuilder::OnComplete(bool success) {
 }
 
 void VisitedLinkMaster::TableBuilder::OnCompleteMainThread() {
-  if (master_)
-    master_->OnTableRebuildComplete(success_, fingerprints_);
+  if (master_) {
+    master_->OnTableRebuildComplete(success_, std::move(table_memory_),
+                                    table_length_, used_count_);
+  }
 }
 
 // static
@@ -168,12 +168,22 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   void RewriteFile() {
     WriteFullTable();
   }
+
+  // Sets how many entries of the current table are copied at a time when the
+  // table grows incrementally, see StartTableMigration().
+  void set_table_migration_slice_size(int32_t slice_size) {
+    table_migration_slice_size_override_ = slice_size;
+  }
 #endif
 
  private:
   FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, Delete);
   FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, BigDelete);
   FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, BigImport);
+  FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, CompactFile);
+  FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, FinishTableMigrationWhenTooFull);
+  FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, IncrementalResizing);
+  FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, LoadFullTableFile);
 
   // Keeps the result of loading the table from the database file to the UI
   // thread.
@@ -186,6 +196,9 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // Object to rebuild the table on the history thread (see the .cc file).
   class TableBuilder;
 
+  // The new table while the table grows incrementally (see the .cc file).
+  struct TableMigration;
+
   // Byte offsets of values in the header.
   static const int32_t kFileHeaderSignatureOffset;
   static const int32_t kFileHeaderVersionOffset;
@@ -199,16 +212,18 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // version of the file format this module currently uses
   static const int32_t kFileCurrentVersion;
 
+  // Version of the file format that stored the whole hash table, empty
+  // entries included. Such files are still loaded, then rewritten.
+  static const int32_t kFileFullTableVersion;
+
   // Bytes in the file header, including the salt.
   static const size_t kFileHeaderSize;
 
   // When creating a fresh new table, we use this many entries.
   static const unsigned kDefaultTableSize;
 
-  // When the user is deleting a boatload of URLs, we don't really want to do
-  // individual writes for each of them. When the count exceeds this threshold,
-  // we will write the whole table to disk at once instead of individual items.
-  static const size_t kBigDeleteThreshold;
+  // How many entries of the current table a growing table copies at a time.
+  static const int32_t kTableMigrationSliceSize;
 
   // If a rebuild is in progress, we save the URL in the temporary list.
   // Otherwise, we add this to the table. Returns the index of the
@@ -237,7 +252,8 @@ class VisitedLinkMaster : public VisitedLinkCommon {
 
   // Load the table from the database file. Returns true on success.
   // Fills parameter |load_from_file_result| on success. It is called from
-  // the background thread.
+  // the background thread. The file lists the fingerprints of the table, so
+  // the table is built by adding them to a table of suitable size.
   static bool LoadApartFromFile(
       const base::FilePath& filename,
       scoped_refptr<LoadFromFileResult>* load_from_file_result);
@@ -252,10 +268,12 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // file pointer is at the beginning of the file and that it is the first
   // asynchronous I/O operation on the background thread.
   //
-  // Returns true on success and places the size of the table in num_entries
-  // and the number of nonzero fingerprints in used_count. This will fail if
-  // the version of the file is not the current version of the database.
+  // Returns true on success and places the version of the file in version,
+  // the size of the table in num_entries and the number of nonzero
+  // fingerprints in used_count. This will fail if the version of the file is
+  // neither the current version of the database nor kFileFullTableVersion.
   static bool ReadFileHeader(FILE* hfile,
+                             int32_t* version,
                              int32_t* num_entries,
                              int32_t* used_count,
                              uint8_t salt[LINK_SALT_LENGTH]);
@@ -271,10 +289,13 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // disk (this is a common operation).
   void WriteUsedItemCountToFile();
 
-  // Helper function to schedule an asynchronous write of the given range of
-  // hash functions to disk. The range is inclusive on both ends. The range can
-  // wrap around at 0 and this function will handle it.
-  void WriteHashRangeToFile(Hash first_hash, Hash last_hash);
+  // Helper function to schedule an asynchronous write of the table size to
+  // disk. It is informational only, the table is sized again on load.
+  void WriteTableLengthToFile();
+
+  // Helper function to schedule an asynchronous write of |fingerprint| as the
+  // |index|th fingerprint of the file.
+  void WriteFingerprintToFile(int32_t index, Fingerprint fingerprint);
 
   // Synchronous read from the file. Assumes that it is the first asynchronous
   // I/O operation in the background thread. Returns true if the entire buffer
@@ -293,6 +314,13 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // duplicate and this item was skippped.
   Hash AddFingerprint(Fingerprint fingerprint, bool send_notifications);
 
+  // Adds |fingerprint| to the |table_length| entries of |hash_table|, probing
+  // like AddFingerprint(). Returns false if it was already there or if the
+  // table is full.
+  static bool AddFingerprintToTable(Fingerprint fingerprint,
+                                    Fingerprint* hash_table,
+                                    int32_t table_length);
+
   // Deletes all fingerprints from the given vector from the current hash table
   // and syncs it to disk if there are changes. This does not update the
   // deleted_since_rebuild_ list, the caller must update this itself if there
@@ -301,8 +329,8 @@ class VisitedLinkMaster : public VisitedLinkCommon {
       const std::set<Fingerprint>& fingerprints);
 
   // Removes the indicated fingerprint from the table. If the update_file flag
-  // is set, the changes will also be written to disk. Returns true if the
-  // fingerprint was deleted, false if it was not in the table to delete.
+  // is set, the file will be rewritten. Returns true if the fingerprint was
+  // deleted, false if it was not in the table to delete.
   bool DeleteFingerprint(Fingerprint fingerprint, bool update_file);
 
   // Creates a new empty table, call if InitFromFile() fails. Normally, when
@@ -350,7 +378,46 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   uint32_t DefaultTableSize() const;
 
   // Returns the desired table size for |item_count| URLs.
-  uint32_t NewTableSizeForCount(int32_t item_count) const;
+  static uint32_t NewTableSizeForCount(int32_t item_count);
+
+  // Growing the table incrementally
+  // -------------------------------
+  // Growing a big table means adding each of its fingerprints to a new one.
+  // Rather than doing all of it at once, StartTableMigration() makes the new
+  // table and posted tasks copy the current table to it a slice at a time.
+  // Meanwhile the current table keeps serving lookups and the listener, and
+  // additions go to both tables. The listener gets the new table once it is
+  // complete.
+
+  // Starts growing the table if it is too full. Returns true if it did or if
+  // the table is already growing, in which case the migration may have to be
+  // finished right away if additions are outpacing it.
+  bool GrowTableIncrementallyIfNecessary();
+
+  // Makes an empty table of |new_size| entries and starts migrating to it.
+  void StartTableMigration(int32_t new_size);
+
+  // Copies the next slice of the current table to the new one, and switches
+  // to the new table after the last slice.
+  void MigrateTableSlice();
+
+  // Copies the entries of the current table before |end| to the new one.
+  void MigrateTableEntries(int32_t end);
+
+  // Copies the rest of the current table and switches to the new one. Does
+  // nothing if the table isn't growing. Called before the operations that
+  // need a single table, such as deletions.
+  void FinishTableMigration();
+
+  // Drops the new table, for when the current one is about to be replaced.
+  void CancelTableMigration();
+
+  // Makes the new table current and notifies the listener.
+  void CompleteTableMigration();
+
+  // Returns how many entries a slice of the table migration copies. It can be
+  // overridden in unit tests.
+  int32_t TableMigrationSliceSize() const;
 
   // Computes the table load as fraction. For example, if 1/4 of the entries are
   // full, this value will be 0.25
@@ -369,10 +436,12 @@ class VisitedLinkMaster : public VisitedLinkCommon {
 
   // Callback that the table rebuilder uses when the rebuild is complete.
   // |success| is true if the fingerprint generation succeeded, in which case
-  // |fingerprints| will contain the computed fingerprints. On failure, there
-  // will be no fingerprints.
+  // |table_memory| holds a table of |table_length| entries with the
+  // |used_count| computed fingerprints. On failure, there will be no table.
   void OnTableRebuildComplete(bool success,
-                              const std::vector<Fingerprint>& fingerprints);
+                              base::MappedReadOnlyRegion table_memory,
+                              int32_t table_length,
+                              int32_t used_count);
 
   // Increases or decreases the given hash value by one, wrapping around as
   // necessary. Used for probing.
@@ -416,6 +485,9 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // history query is running. We must only delete it when the query is done.
   scoped_refptr<TableBuilder> table_builder_;
 
+  // While the table grows incrementally, the table it grows into.
+  std::unique_ptr<TableMigration> table_migration_;
+
   // Indicates URLs added and deleted since we started rebuilding the table.
   std::set<Fingerprint> added_since_rebuild_;
   std::set<Fingerprint> deleted_since_rebuild_;
@@ -467,6 +539,9 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // When nonzero, overrides the table size for new databases for testing
   int32_t table_size_override_ = 0;
 
+  // When nonzero, overrides kTableMigrationSliceSize for testing
+  int32_t table_migration_slice_size_override_ = 0;
+
   // When set, indicates the task that should be run after the next rebuild from
   // history is complete.
   base::Closure rebuild_complete_task_;
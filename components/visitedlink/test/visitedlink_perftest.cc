@@ -60,6 +60,7 @@ void TimeLogger::Done() {
 // how we generate URLs, note that the two strings should be the same length
 const int add_count = 10000;
 const int load_test_add_count = 250000;
+const int million_test_add_count = 1000000;
 const char added_prefix[] = "http://www.google.com/stuff/something/foo?session=85025602345625&id=1345142319023&seq=";
 const char unadded_prefix[] = "http://www.google.org/stuff/something/foo?session=39586739476365&id=2347624314402&seq=";
 
@@ -139,6 +140,66 @@ TEST_F(VisitedLink, TestAddAndQuery) {
   CheckVisited(master, unadded_prefix, 0, add_count);
 }
 
+// Tests adding a million links one at a time, then looking them up. The table
+// grows several times along the way, a slice at a time in between additions,
+// so the slowest single addition tells how long the UI thread can be blocked.
+TEST_F(VisitedLink, TestMillionLinks) {
+  VisitedLinkMaster master(new DummyVisitedLinkEventListener(), nullptr, true,
+                           true, db_path_, 0);
+  ASSERT_TRUE(master.Init());
+  content::RunAllTasksUntilIdle();
+
+  TimeDelta slowest_add;
+  {
+    TimeLogger add_timer("Visited_link_add_1M");
+    for (int i = 0; i < million_test_add_count; i++) {
+      GURL url = TestURL(added_prefix, i);
+      base::ElapsedTimer timer;
+      master.AddURL(url);
+      slowest_add = std::max(slowest_add, timer.Elapsed());
+
+      // Let the pending tasks run, as they would in between events.
+      if (i % 1000 == 999)
+        content::RunAllTasksUntilIdle();
+    }
+  }
+  perf_test::PrintResult("Visited_link_slowest_add_1M", std::string(),
+                         std::string(), slowest_add.InMillisecondsF(), "ms",
+                         true);
+  ASSERT_EQ(million_test_add_count, master.GetUsedCount());
+
+  {
+    TimeLogger lookup_timer("Visited_link_lookup_visited_1M");
+    CheckVisited(master, added_prefix, 0, million_test_add_count);
+  }
+  {
+    TimeLogger lookup_timer("Visited_link_lookup_unvisited_1M");
+    CheckVisited(master, unadded_prefix, 0, million_test_add_count);
+  }
+}
+
+// Tests importing a million links in batches, which resizes the table at once
+// whenever it gets too full.
+TEST_F(VisitedLink, TestMillionLinksImport) {
+  VisitedLinkMaster master(new DummyVisitedLinkEventListener(), nullptr, true,
+                           true, db_path_, 0);
+  ASSERT_TRUE(master.Init());
+  content::RunAllTasksUntilIdle();
+
+  const int batch_size = 10000;
+  TimeLogger import_timer("Visited_link_import_1M");
+  for (int begin = 0; begin < million_test_add_count; begin += batch_size) {
+    std::vector<GURL> urls;
+    urls.reserve(batch_size);
+    for (int i = begin; i < begin + batch_size; i++)
+      urls.push_back(TestURL(added_prefix, i));
+    master.AddURLs(urls);
+  }
+  content::RunAllTasksUntilIdle();
+  import_timer.Done();
+  ASSERT_EQ(million_test_add_count, master.GetUsedCount());
+}
+
 // Tests how long it takes to write and read a large database to and from disk.
 // Flaky, see crbug.com/822308.
 TEST_F(VisitedLink, DISABLED_TestLoad) {
@@ -157,9 +218,6 @@ TEST_F(VisitedLink, DISABLED_TestLoad) {
     ASSERT_TRUE(success);
 
     // add a bunch of stuff
-    // TODO(maruel): This is very inefficient because the file gets rewritten
-    // many time and this is the actual bottleneck of this test. The file should
-    // only get written that the end of the FillTable call, not 4169(!) times.
     FillTable(master, added_prefix, 0, load_test_add_count);
 
     // time writing the file out out
@@ -301,8 +301,8 @@ TEST_F(VisitedLinkTest, Delete) {
         "Hash table has values in it.";
 }
 
-// When we delete more than kBigDeleteThreshold we trigger different behavior
-// where the entire file is rewritten.
+// Deleting many URLs at once rewrites the file once, after all of them are
+// gone from the table.
 TEST_F(VisitedLinkTest, BigDelete) {
   ASSERT_TRUE(InitVisited(16381, true, true));
 
@@ -312,7 +312,7 @@ TEST_F(VisitedLinkTest, BigDelete) {
     master_->AddURL(TestURL(i));
 
   // Add more URLs than necessary to trigger this case.
-  const int kTestDeleteCount = VisitedLinkMaster::kBigDeleteThreshold + 2;
+  const int kTestDeleteCount = 66;
   URLs urls_to_delete;
   for (int32_t i = g_test_count; i < g_test_count + kTestDeleteCount; i++) {
     GURL url(TestURL(i));
@@ -415,6 +415,143 @@ TEST_F(VisitedLinkTest, Resizing) {
   Reload();
 }
 
+// Tests that a table too big to be copied at once grows a slice at a time, and
+// that slaves keep finding the links while it does.
+TEST_F(VisitedLinkTest, IncrementalResizing) {
+  const int32_t initial_size = 17;
+  ASSERT_TRUE(InitVisited(initial_size, true, true));
+  master_->set_table_migration_slice_size(4);
+
+  VisitedLinkSlave slave;
+  slave.UpdateVisitedLinks(master_->mapped_table_memory().region.Duplicate());
+  g_slaves.push_back(&slave);
+
+  // Filling half of the table starts growing it.
+  int added = 0;
+  while (!master_->table_migration_) {
+    master_->AddURL(TestURL(added++));
+    ASSERT_LT(added, initial_size);
+  }
+  EXPECT_EQ(initial_size, master_->table_length_);
+
+  // Links added meanwhile go to both tables.
+  master_->AddURL(TestURL(added++));
+  master_->AddURL(TestURL(added++));
+  ASSERT_TRUE(master_->table_migration_);
+  EXPECT_EQ(added, master_->GetUsedCount());
+  for (int i = 0; i < added; i++) {
+    EXPECT_TRUE(master_->IsVisited(TestURL(i)));
+    EXPECT_TRUE(slave.IsVisited(TestURL(i)));
+  }
+
+  // The remaining slices run as tasks, after which the slave gets the new
+  // table.
+  content::RunAllTasksUntilIdle();
+  EXPECT_FALSE(master_->table_migration_);
+  EXPECT_EQ(static_cast<int32_t>(VisitedLinkMaster::kDefaultTableSize),
+            master_->table_length_);
+  EXPECT_EQ(added, master_->GetUsedCount());
+  master_->DebugValidate();
+
+  int32_t child_table_size;
+  VisitedLinkCommon::Fingerprint* child_table;
+  slave.GetUsageStatistics(&child_table_size, &child_table);
+  EXPECT_EQ(master_->table_length_, child_table_size);
+  for (int i = 0; i < added; i++)
+    EXPECT_TRUE(slave.IsVisited(TestURL(i)));
+
+  g_slaves.clear();
+
+  for (int i = added; i < g_test_count; i++)
+    master_->AddURL(TestURL(i));
+  Reload();
+}
+
+// Tests that the table stops growing incrementally when links are added
+// faster than it grows.
+TEST_F(VisitedLinkTest, FinishTableMigrationWhenTooFull) {
+  const int32_t initial_size = 17;
+  ASSERT_TRUE(InitVisited(initial_size, true, true));
+  master_->set_table_migration_slice_size(1);
+
+  int added = 0;
+  while (!master_->table_migration_)
+    master_->AddURL(TestURL(added++));
+
+  // Without running the migration tasks, the migration finishes once the
+  // current table is 70% full.
+  while (master_->table_migration_) {
+    master_->AddURL(TestURL(added++));
+    ASSERT_LE(added, 12);
+  }
+  EXPECT_EQ(12, added);
+  EXPECT_EQ(static_cast<int32_t>(VisitedLinkMaster::kDefaultTableSize),
+            master_->table_length_);
+  EXPECT_EQ(added, master_->GetUsedCount());
+  master_->DebugValidate();
+  for (int i = 0; i < added; i++)
+    EXPECT_TRUE(master_->IsVisited(TestURL(i)));
+}
+
+// Tests that the file lists the fingerprints only, also after deletions.
+TEST_F(VisitedLinkTest, CompactFile) {
+  ASSERT_TRUE(InitVisited(0, true, true));
+
+  URLs urls_to_delete;
+  for (int i = 0; i < 10; i++) {
+    urls_to_delete.push_back(TestURL(g_test_count + i));
+    master_->AddURL(urls_to_delete.back());
+  }
+  TestURLIterator iterator(urls_to_delete);
+  master_->DeleteURLs(&iterator);
+
+  for (int i = 0; i < g_test_count; i++)
+    master_->AddURL(TestURL(i));
+  ClearDB();
+
+  int64_t file_size;
+  ASSERT_TRUE(base::GetFileSize(visited_file_, &file_size));
+  EXPECT_EQ(static_cast<int64_t>(VisitedLinkMaster::kFileHeaderSize +
+                                 g_test_count *
+                                     sizeof(VisitedLinkCommon::Fingerprint)),
+            file_size);
+
+  Reload();
+}
+
+// Tests that a file storing the whole table, as older versions wrote, is
+// loaded and then rewritten in the current format.
+TEST_F(VisitedLinkTest, LoadFullTableFile) {
+  ASSERT_TRUE(InitVisited(0, true, true));
+  for (int i = 0; i < g_test_count; i++)
+    master_->AddURL(TestURL(i));
+
+  const int32_t header[] = {VisitedLinkMaster::kFileSignature,
+                            VisitedLinkMaster::kFileFullTableVersion,
+                            master_->table_length_, master_->used_items_};
+  std::string contents(reinterpret_cast<const char*>(header), sizeof(header));
+  contents.append(reinterpret_cast<const char*>(master_->salt_),
+                  LINK_SALT_LENGTH);
+  contents.append(reinterpret_cast<const char*>(master_->hash_table_),
+                  master_->table_length_ *
+                      sizeof(VisitedLinkCommon::Fingerprint));
+  ClearDB();
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(visited_file_, contents.data(), contents.size()));
+
+  Reload();
+  ClearDB();
+
+  int64_t file_size;
+  ASSERT_TRUE(base::GetFileSize(visited_file_, &file_size));
+  EXPECT_EQ(static_cast<int64_t>(VisitedLinkMaster::kFileHeaderSize +
+                                 g_test_count *
+                                     sizeof(VisitedLinkCommon::Fingerprint)),
+            file_size);
+
+  Reload();
+}
+
 // Tests that if the database doesn't exist, it will be rebuilt from history.
 TEST_F(VisitedLinkTest, Rebuild) {
   // Add half of our URLs to history. This needs to be done before we
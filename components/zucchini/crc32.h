@@ -12,6 +12,11 @@ namespace zucchini {
 // Calculates CRC-32 of the given range [|first|, |last|).
 uint32_t CalculateCrc32(const uint8_t* first, const uint8_t* last);
 
+// Extends |crc|, the CRC-32 of some data, to the CRC-32 of that data followed
+// by the range [|first|, |last|). Starting from a |crc| of 0 gives the same
+// result as CalculateCrc32().
+uint32_t ExtendCrc32(uint32_t crc, const uint8_t* first, const uint8_t* last);
+
 }  // namespace zucchini
 
 #endif  // COMPONENTS_ZUCCHINI_CRC32_H_
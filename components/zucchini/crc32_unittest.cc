@@ -44,4 +44,23 @@ TEST(Crc32Test, All) {
   EXPECT_DCHECK_DEATH(CalculateCrc32(std::begin(bytes) + 1, std::begin(bytes)));
 }
 
+TEST(Crc32Test, Extend) {
+  // Extending by nothing changes nothing.
+  EXPECT_EQ(0x00000000U, ExtendCrc32(0, std::begin(bytes), std::begin(bytes)));
+  EXPECT_EQ(0xCFB5FFE9U,
+            ExtendCrc32(0xCFB5FFE9U, std::end(bytes), std::end(bytes)));
+
+  // Extending from 0 is the same as calculating.
+  EXPECT_EQ(0xA86FD7D6U, ExtendCrc32(0, std::begin(bytes), std::end(bytes)));
+
+  // Any split of the region gives the CRC-32 of the whole region.
+  for (const uint8_t* split = std::begin(bytes); split != std::end(bytes);
+       ++split) {
+    uint32_t crc = CalculateCrc32(std::begin(bytes), split);
+    EXPECT_EQ(0xA86FD7D6U, ExtendCrc32(crc, split, std::end(bytes)));
+  }
+
+  EXPECT_DCHECK_DEATH(ExtendCrc32(0, std::begin(bytes) + 1, std::begin(bytes)));
+}
+
 }  // namespace zucchini
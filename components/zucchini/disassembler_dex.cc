@@ -8,6 +8,7 @@
 #include <stdlib.h>
 
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cmath>
 #include <iterator>
@@ -243,19 +244,19 @@ class InstructionParser {
 
   // Returns pointer to DEX Instruction data for |opcode|, or null if |opcode|
   // is unknown. An internal initialize-on-first-use table is used for fast
-  // lookup.
+  // lookup. Its initialization is thread-safe, as elements may be generated on
+  // several threads.
   const dex::Instruction* FindDalvikInstruction(uint8_t opcode) {
-    static bool is_init = false;
-    static const dex::Instruction* instruction_table[256];
-    if (!is_init) {
-      is_init = true;
-      std::fill(std::begin(instruction_table), std::end(instruction_table),
-                nullptr);
+    using InstructionTable = std::array<const dex::Instruction*, 256>;
+    static const InstructionTable instruction_table = [] {
+      InstructionTable table;
+      table.fill(nullptr);
       for (const dex::Instruction& instr : dex::kByteCode) {
-        std::fill(instruction_table + instr.opcode,
-                  instruction_table + instr.opcode + instr.variant, &instr);
+        std::fill(table.begin() + instr.opcode,
+                  table.begin() + instr.opcode + instr.variant, &instr);
       }
-    }
+      return table;
+    }();
     return instruction_table[opcode];
   }
 
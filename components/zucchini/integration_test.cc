@@ -12,6 +12,7 @@
 #include "base/files/memory_mapped_file.h"
 #include "base/optional.h"
 #include "base/path_service.h"
+#include "base/test/bind_test_util.h"
 #include "components/zucchini/buffer_view.h"
 #include "components/zucchini/patch_reader.h"
 #include "components/zucchini/patch_writer.h"
@@ -79,6 +80,47 @@ void TestGenApply(const std::string& old_filename,
   // Note that |new_region| and |patched_new_buffer| are the same size.
   EXPECT_TRUE(std::equal(new_region.begin(), new_region.end(),
                          patched_new_buffer.begin()));
+
+  // Apply the patch again, streaming the result, which should be released in
+  // order and in full.
+  std::vector<uint8_t> streamed_new_buffer(new_region.size());
+  MutableBufferView streamed_new(streamed_new_buffer.data(),
+                                 streamed_new_buffer.size());
+  size_t released_size = 0;
+  ASSERT_EQ(status::kStatusSuccess,
+            ApplyBufferStreaming(
+                old_region, *patch_reader, streamed_new,
+                base::BindLambdaForTesting([&](MutableBufferView region) {
+                  EXPECT_EQ(streamed_new.begin() + released_size,
+                            region.begin());
+                  released_size += region.size();
+                })));
+  EXPECT_EQ(streamed_new.size(), released_size);
+  EXPECT_EQ(patched_new_buffer, streamed_new_buffer);
+}
+
+// Checks that generating the patch on several threads doesn't change it.
+void TestGenParallel(const std::string& old_filename,
+                     const std::string& new_filename) {
+  base::MemoryMappedFile old_file;
+  ASSERT_TRUE(old_file.Initialize(MakeTestPath(old_filename)));
+  base::MemoryMappedFile new_file;
+  ASSERT_TRUE(new_file.Initialize(MakeTestPath(new_filename)));
+  ConstBufferView old_region(old_file.data(), old_file.length());
+  ConstBufferView new_region(new_file.data(), new_file.length());
+
+  std::vector<std::vector<uint8_t>> patches;
+  for (size_t num_threads : {size_t{1}, size_t{4}}) {
+    EnsemblePatchWriter patch_writer(old_region, new_region);
+    ASSERT_EQ(status::kStatusSuccess,
+              GenerateBufferParallel(old_region, new_region, "", num_threads,
+                                     &patch_writer));
+    std::vector<uint8_t> patch_buffer(patch_writer.SerializedSize());
+    ASSERT_TRUE(
+        patch_writer.SerializeInto({patch_buffer.data(), patch_buffer.size()}));
+    patches.push_back(std::move(patch_buffer));
+  }
+  EXPECT_EQ(patches[0], patches[1]);
 }
 
 TEST(EndToEndTest, GenApplyRaw) {
@@ -100,4 +142,9 @@ TEST(EndToEndTest, GenApplyCross) {
   TestGenApply("setup1.exe", "chrome64_1.exe", false);
 }
 
+TEST(EndToEndTest, GenParallel) {
+  TestGenParallel("setup1.exe", "setup2.exe");
+  TestGenParallel("chrome64_1.exe", "chrome64_2.exe");
+}
+
 }  // namespace zucchini
@@ -8,8 +8,15 @@
 
 #include "base/files/file_util.h"
 #include "base/logging.h"
+#include "base/process/process_metrics.h"
 #include "build/build_config.h"
 
+#if defined(OS_WIN)
+#include <windows.h>
+#elif defined(OS_POSIX)
+#include <sys/mman.h>
+#endif
+
 namespace zucchini {
 
 MappedFileReader::MappedFileReader(base::File file) {
@@ -67,4 +74,27 @@ bool MappedFileWriter::Keep() {
   return true;
 }
 
+void MappedFileWriter::Release(MutableBufferView region) {
+  DCHECK(region.begin() >= data() && region.end() <= data() + length());
+  // Only whole pages can be dropped. The mapping starts on a page boundary.
+  const size_t page_size = base::GetPageSize();
+  const size_t begin = region.begin() - data();
+  const size_t first_page = (begin + page_size - 1) / page_size * page_size;
+  const size_t end_page = (begin + region.size()) / page_size * page_size;
+  if (end_page <= first_page)
+    return;
+  uint8_t* const pages = data() + first_page;
+  const size_t pages_size = end_page - first_page;
+#if defined(OS_WIN)
+  ::FlushViewOfFile(pages, pages_size);
+  // Unlocking pages that aren't locked removes them from the working set.
+  ::VirtualUnlock(pages, pages_size);
+#elif defined(OS_POSIX)
+  // Changes to a shared mapping are kept in the file, so dropping the pages
+  // doesn't lose them.
+  ::msync(pages, pages_size, MS_ASYNC);
+  ::madvise(pages, pages_size, MADV_DONTNEED);
+#endif
+}
+
 }  // namespace zucchini
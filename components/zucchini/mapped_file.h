@@ -62,6 +62,12 @@ class MappedFileWriter {
   // iff the operation succeeds.
   bool Keep();
 
+  // Writes |region|, which must lie within region(), back to the file and drops
+  // the pages it spans in full from memory. The data is kept, and is read back
+  // from the file if |region| is accessed again. This is only a hint: the pages
+  // may stay resident.
+  void Release(MutableBufferView region);
+
  private:
   enum OnCloseDeleteBehavior {
     kKeep,
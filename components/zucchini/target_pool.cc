@@ -14,6 +14,21 @@
 
 namespace zucchini {
 
+namespace {
+
+// Size below which targets read one by one aren't deduped before the end.
+constexpr size_t kMinDedupSize = 1 << 16;
+
+// Returns the size of |targets| at which to next dedupe targets that are read
+// one by one. Deduping whenever the targets double keeps the working set within
+// about twice the distinct targets, rather than letting it grow with the number
+// of references, which is often many times more.
+size_t NextDedupSize(const std::vector<offset_t>& targets) {
+  return std::max(targets.size() * 2, kMinDedupSize);
+}
+
+}  // namespace
+
 TargetPool::TargetPool() = default;
 
 TargetPool::TargetPool(std::vector<offset_t>&& targets) {
@@ -53,9 +68,14 @@ void TargetPool::InsertTargets(const std::vector<Reference>& references) {
 }
 
 void TargetPool::InsertTargets(ReferenceReader&& references) {
+  size_t dedup_size = NextDedupSize(targets_);
   for (auto ref = references.GetNext(); ref.has_value();
        ref = references.GetNext()) {
     targets_.push_back(ref->target);
+    if (targets_.size() >= dedup_size) {
+      SortAndUniquify(&targets_);
+      dedup_size = NextDedupSize(targets_);
+    }
   }
   SortAndUniquify(&targets_);
 }
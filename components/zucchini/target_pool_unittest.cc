@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "components/zucchini/image_utils.h"
+#include "components/zucchini/test_reference_reader.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace zucchini {
@@ -36,6 +37,23 @@ TEST(TargetPoolTest, InsertTargetsFromReferences) {
   EXPECT_EQ(OffsetVector({0, 1}), test_insert({{0, 0}, {10, 0}, {20, 1}}));
 }
 
+TEST(TargetPoolTest, InsertTargetsFromReferenceReader) {
+  // Enough references to be deduped while they're read, each target many times
+  // over.
+  constexpr offset_t kNumTargets = 1000;
+  std::vector<Reference> references;
+  for (offset_t i = 0; i < 200000; ++i)
+    references.push_back({i, (i * 7919) % kNumTargets});
+
+  TargetPool target_pool;
+  target_pool.InsertTargets(std::vector<offset_t>({kNumTargets, 5}));
+  target_pool.InsertTargets(TestReferenceReader(references));
+  OffsetVector expected;
+  for (offset_t i = 0; i <= kNumTargets; ++i)
+    expected.push_back(i);
+  EXPECT_EQ(expected, target_pool.targets());
+}
+
 TEST(TargetPoolTest, KeyOffset) {
   auto test_key_offset = [](const std::string& nearest_offsets_key,
                             OffsetVector&& targets) {
@@ -5,8 +5,11 @@
 #ifndef COMPONENTS_ZUCCHINI_ZUCCHINI_H_
 #define COMPONENTS_ZUCCHINI_ZUCCHINI_H_
 
+#include <stddef.h>
+
 #include <string>
 
+#include "base/callback.h"
 #include "components/zucchini/buffer_view.h"
 #include "components/zucchini/patch_reader.h"
 #include "components/zucchini/patch_writer.h"
@@ -55,6 +58,16 @@ status::Code GenerateBufferImposed(ConstBufferView old_image,
                                    std::string imposed_matches,
                                    EnsemblePatchWriter* patch_writer);
 
+// Same as GenerateBufferImposed(), but generates the patch elements of matched
+// executables on up to |num_threads| threads, as well as the raw patch elements
+// of the data between them. The patch is identical to the one generated on a
+// single thread, but the suffix arrays of several elements are held at once.
+status::Code GenerateBufferParallel(ConstBufferView old_image,
+                                    ConstBufferView new_image,
+                                    std::string imposed_matches,
+                                    size_t num_threads,
+                                    EnsemblePatchWriter* patch_writer);
+
 // Generates raw patch from |old_image| to |new_image|, and writes it to
 // |patch_writer|.
 status::Code GenerateBufferRaw(ConstBufferView old_image,
@@ -67,6 +80,17 @@ status::Code ApplyBuffer(ConstBufferView old_image,
                          const EnsemblePatchReader& patch_reader,
                          MutableBufferView new_image);
 
+// Same as ApplyBuffer(), but for |new_image| backed by a file: as each element
+// of |new_image| is completed, folds it into the checksum of |new_image| and
+// passes it to |release_region|, which can write it out and drop it from
+// memory, as it isn't read again. This keeps at most one element of
+// |new_image| in use at a time.
+status::Code ApplyBufferStreaming(
+    ConstBufferView old_image,
+    const EnsemblePatchReader& patch_reader,
+    MutableBufferView new_image,
+    const base::RepeatingCallback<void(MutableBufferView)>& release_region);
+
 }  // namespace zucchini
 
 #endif  // COMPONENTS_ZUCCHINI_ZUCCHINI_H_
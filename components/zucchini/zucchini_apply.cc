@@ -11,6 +11,7 @@
 
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
+#include "components/zucchini/crc32.h"
 #include "components/zucchini/disassembler.h"
 #include "components/zucchini/element_detection.h"
 #include "components/zucchini/equivalence_map.h"
@@ -214,4 +215,38 @@ status::Code ApplyBuffer(ConstBufferView old_image,
   return status::kStatusSuccess;
 }
 
+status::Code ApplyBufferStreaming(
+    ConstBufferView old_image,
+    const EnsemblePatchReader& patch_reader,
+    MutableBufferView new_image,
+    const base::RepeatingCallback<void(MutableBufferView)>& release_region) {
+  if (!patch_reader.CheckOldFile(old_image)) {
+    LOG(ERROR) << "Invalid old_image.";
+    return status::kStatusInvalidOldImage;
+  }
+  if (new_image.size() != patch_reader.header().new_size) {
+    LOG(ERROR) << "Invalid new_image.";
+    return status::kStatusInvalidNewImage;
+  }
+
+  // EnsemblePatchReader ensures that elements cover the new image back to back,
+  // so the checksum can be extended by each element in turn.
+  uint32_t new_crc = 0;
+  for (const auto& element_patch : patch_reader.elements()) {
+    ElementMatch match = element_patch.element_match();
+    MutableBufferView new_element = new_image[match.new_element.region()];
+    if (!ApplyElement(match.exe_type(), old_image[match.old_element.region()],
+                      element_patch, new_element))
+      return status::kStatusFatal;
+    new_crc = ExtendCrc32(new_crc, new_element.begin(), new_element.end());
+    release_region.Run(new_element);
+  }
+
+  if (new_crc != patch_reader.header().new_crc) {
+    LOG(ERROR) << "Invalid new_image.";
+    return status::kStatusInvalidNewImage;
+  }
+  return status::kStatusSuccess;
+}
+
 }  // namespace zucchini
@@ -17,6 +17,7 @@
 #include "base/files/memory_mapped_file.h"
 #include "base/logging.h"
 #include "base/macros.h"
+#include "base/strings/string_number_conversions.h"
 #include "components/zucchini/buffer_view.h"
 #include "components/zucchini/crc32.h"
 #include "components/zucchini/io_utils.h"
@@ -33,23 +34,36 @@ constexpr char kSwitchDump[] = "dump";
 constexpr char kSwitchImpose[] = "impose";
 constexpr char kSwitchKeep[] = "keep";
 constexpr char kSwitchRaw[] = "raw";
+constexpr char kSwitchStream[] = "stream";
+constexpr char kSwitchThreads[] = "threads";
 
 }  // namespace
 
 zucchini::status::Code MainGen(MainParams params) {
   CHECK_EQ(3U, params.file_paths.size());
+  size_t num_threads = 1;
+  if (params.command_line.HasSwitch(kSwitchThreads) &&
+      (!base::StringToSizeT(
+           params.command_line.GetSwitchValueASCII(kSwitchThreads),
+           &num_threads) ||
+       num_threads == 0)) {
+    params.err << "-" << kSwitchThreads << " must be a positive number."
+               << std::endl;
+    return zucchini::status::kStatusInvalidParam;
+  }
   return zucchini::Generate(
       params.file_paths[0], params.file_paths[1], params.file_paths[2],
       params.command_line.HasSwitch(kSwitchKeep),
       params.command_line.HasSwitch(kSwitchRaw),
-      params.command_line.GetSwitchValueASCII(kSwitchImpose));
+      params.command_line.GetSwitchValueASCII(kSwitchImpose), num_threads);
 }
 
 zucchini::status::Code MainApply(MainParams params) {
   CHECK_EQ(3U, params.file_paths.size());
   return zucchini::Apply(params.file_paths[0], params.file_paths[1],
                          params.file_paths[2],
-                         params.command_line.HasSwitch(kSwitchKeep));
+                         params.command_line.HasSwitch(kSwitchKeep),
+                         params.command_line.HasSwitch(kSwitchStream));
 }
 
 zucchini::status::Code MainRead(MainParams params) {
@@ -13,8 +13,13 @@
 #include <string>
 #include <utility>
 
+#include "base/bind.h"
+#include "base/callback.h"
 #include "base/logging.h"
+#include "base/macros.h"
 #include "base/numerics/safe_conversions.h"
+#include "base/threading/simple_thread.h"
+#include "base/timer/elapsed_timer.h"
 #include "components/zucchini/disassembler.h"
 #include "components/zucchini/element_detection.h"
 #include "components/zucchini/encoded_view.h"
@@ -36,6 +41,48 @@ namespace {
 constexpr double kMinEquivalenceSimilarity = 12.0;
 constexpr double kMinLabelAffinity = 64.0;
 
+// Runs a task on a thread of a base::DelegateSimpleThreadPool.
+class TaskDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit TaskDelegate(base::OnceClosure task) : task_(std::move(task)) {}
+  ~TaskDelegate() override = default;
+
+  // base::DelegateSimpleThread::Delegate:
+  void Run() override { std::move(task_).Run(); }
+
+ private:
+  base::OnceClosure task_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskDelegate);
+};
+
+// Runs |tasks| on up to |num_threads| threads, starting them in order, and
+// returns once all are done. With a single thread, runs them in order on the
+// current thread.
+void RunTasks(std::vector<base::OnceClosure> tasks, size_t num_threads) {
+  num_threads = std::min(num_threads, tasks.size());
+  if (num_threads <= 1) {
+    for (base::OnceClosure& task : tasks)
+      std::move(task).Run();
+    return;
+  }
+
+  std::vector<std::unique_ptr<TaskDelegate>> delegates;
+  base::DelegateSimpleThreadPool pool("zucchini_gen",
+                                      base::checked_cast<int>(num_threads));
+  for (base::OnceClosure& task : tasks) {
+    delegates.push_back(std::make_unique<TaskDelegate>(std::move(task)));
+    pool.AddWork(delegates.back().get());
+  }
+  pool.Start();
+  pool.JoinAll();
+}
+
+void LogElapsedTime(const char* name, const base::ElapsedTimer& timer) {
+  LOG(INFO) << "Zucchini." << name << " " << timer.Elapsed().InSecondsF()
+            << " s";
+}
+
 }  // namespace
 
 std::vector<offset_t> FindExtraTargets(const TargetPool& projected_old_targets,
@@ -323,11 +370,14 @@ bool GenerateExecutableElement(ExecutableType exe_type,
 status::Code GenerateBufferCommon(ConstBufferView old_image,
                                   ConstBufferView new_image,
                                   std::unique_ptr<EnsembleMatcher> matcher,
+                                  size_t num_threads,
                                   EnsemblePatchWriter* patch_writer) {
+  base::ElapsedTimer match_timer;
   if (!matcher->RunMatch(old_image, new_image)) {
     LOG(INFO) << "RunMatch() failed, generating raw patch.";
     return GenerateBufferRaw(old_image, new_image, patch_writer);
   }
+  LogElapsedTime("MatchTime", match_timer);
 
   const std::vector<ElementMatch>& matches = matcher->matches();
   LOG(INFO) << "Matching: Found " << matches.size()
@@ -352,65 +402,129 @@ status::Code GenerateBufferCommon(ConstBufferView old_image,
   std::vector<BufferRegion> covered_new_regions;
   size_t covered_new_bytes = 0;
 
-  // Process elements first, since non-fatal failures may turn some into gaps.
-  for (const ElementMatch& match : matches) {
-    BufferRegion new_region = match.new_element.region();
-    LOG(INFO) << "--- Match [" << new_region.lo() << "," << new_region.hi()
-              << ")";
+  // "Gaps" share a common suffix array |old_sa_raw|. On a single thread, its
+  // lifetime is kept separated from elements' suffix arrays to reduce peak
+  // memory. With more threads, if there are gaps between the elements it is
+  // built alongside them.
+  std::vector<offset_t> old_sa_raw;
+  auto make_old_sa_raw = [](ConstBufferView old_image,
+                            std::vector<offset_t>* old_sa_raw) {
+    ImageIndex old_image_index(old_image);
+    EncodedView old_view_raw(old_image_index);
+    *old_sa_raw = MakeSuffixArray<InducedSuffixSort>(old_view_raw, size_t(256));
+  };
+  size_t matched_new_bytes = 0;
+  for (const ElementMatch& match : matches)
+    matched_new_bytes += match.new_element.size;
+  const bool make_old_sa_raw_with_elements =
+      num_threads > 1 && matched_new_bytes < new_image.size();
 
+  // Process elements first, since non-fatal failures may turn some into gaps.
+  // Each element is written to its own PatchElementWriter, so that elements
+  // can be generated in any order, and on any thread. With more threads, the
+  // largest are started first so that threads finish at about the same time.
+  base::ElapsedTimer elements_timer;
+  std::vector<PatchElementWriter> element_writers(matches.begin(),
+                                                  matches.end());
+  std::unique_ptr<bool[]> element_generated(new bool[num_elements]());
+  std::vector<size_t> element_order(num_elements);
+  for (size_t i = 0; i < num_elements; ++i)
+    element_order[i] = i;
+  if (num_threads > 1) {
+    std::stable_sort(element_order.begin(), element_order.end(),
+                     [&matches](size_t a, size_t b) {
+                       return matches[a].new_element.size >
+                              matches[b].new_element.size;
+                     });
+  }
+  std::vector<base::OnceClosure> element_tasks;
+  if (make_old_sa_raw_with_elements) {
+    element_tasks.push_back(
+        base::BindOnce(make_old_sa_raw, old_image, &old_sa_raw));
+  }
+  for (size_t i : element_order) {
+    element_tasks.push_back(base::BindOnce(
+        [](const ElementMatch* match, ConstBufferView old_image,
+           ConstBufferView new_image, PatchElementWriter* patch_element,
+           bool* generated) {
+          BufferRegion new_region = match->new_element.region();
+          LOG(INFO) << "--- Match [" << new_region.lo() << ","
+                    << new_region.hi() << ")";
+          *generated = GenerateExecutableElement(
+              match->exe_type(), old_image[match->old_element.region()],
+              new_image[new_region], patch_element);
+        },
+        &matches[i], old_image, new_image, &element_writers[i],
+        &element_generated[i]));
+  }
+  RunTasks(std::move(element_tasks), num_threads);
+  LogElapsedTime("ElementsTime", elements_timer);
+
+  for (size_t i = 0; i < num_elements; ++i) {
+    BufferRegion new_region = matches[i].new_element.region();
+    if (!element_generated[i]) {
+      LOG(INFO) << "Match [" << new_region.lo() << "," << new_region.hi()
+                << "): Fall back to raw patching.";
+      continue;
+    }
     auto it_and_success = patch_element_map.emplace(
-        base::checked_cast<offset_t>(new_region.lo()), match);
+        base::checked_cast<offset_t>(new_region.lo()),
+        std::move(element_writers[i]));
     DCHECK(it_and_success.second);
-    PatchElementWriter& patch_element = it_and_success.first->second;
-
-    ConstBufferView old_sub_image = old_image[match.old_element.region()];
-    ConstBufferView new_sub_image = new_image[new_region];
-    if (GenerateExecutableElement(match.exe_type(), old_sub_image,
-                                  new_sub_image, &patch_element)) {
-      covered_new_regions.push_back(new_region);
-      covered_new_bytes += new_region.size;
-    } else {
-      LOG(INFO) << "Fall back to raw patching.";
-      patch_element_map.erase(it_and_success.first);
-    }
+    covered_new_regions.push_back(new_region);
+    covered_new_bytes += new_region.size;
   }
+  element_writers.clear();
 
   if (covered_new_bytes < new_image.size()) {
-    // Process all "gaps", which are patched against the entire "old" image. To
-    // compute equivalence maps, "gaps" share a common suffix array
-    // |old_sa_raw|, whose lifetime is kept separated from elements' suffix
-    // arrays to reduce peak memory.
+    // Process all "gaps", which are patched against the entire "old" image, and
+    // are independent of one another.
+    base::ElapsedTimer gaps_timer;
+    if (!make_old_sa_raw_with_elements)
+      make_old_sa_raw(old_image, &old_sa_raw);
     Element entire_old_element(old_image.local_region(), kExeTypeNoOp);
-    ImageIndex old_image_index(old_image);
-    EncodedView old_view_raw(old_image_index);
-    std::vector<offset_t> old_sa_raw =
-        MakeSuffixArray<InducedSuffixSort>(old_view_raw, size_t(256));
 
     offset_t gap_lo = 0;
     // Add sentinel that points to end of "new" file, to simplify gap iteration.
     covered_new_regions.emplace_back(BufferRegion{new_image.size(), 0});
 
+    std::vector<BufferRegion> gap_regions;
+    std::vector<PatchElementWriter*> gap_writers;
     for (const BufferRegion& covered : covered_new_regions) {
       offset_t gap_hi = base::checked_cast<offset_t>(covered.lo());
       DCHECK_GE(gap_hi, gap_lo);
       offset_t gap_size = gap_hi - gap_lo;
       if (gap_size > 0) {
-        LOG(INFO) << "--- Gap   [" << gap_lo << "," << gap_hi << ")";
-
         ElementMatch gap_match{{entire_old_element, kExeTypeNoOp},
                                {{gap_lo, gap_size}, kExeTypeNoOp}};
         auto it_and_success = patch_element_map.emplace(gap_lo, gap_match);
         DCHECK(it_and_success.second);
-        PatchElementWriter& patch_element = it_and_success.first->second;
-
-        ConstBufferView new_sub_image = new_image[{gap_lo, gap_size}];
-        if (!GenerateRawElement(old_sa_raw, old_image, new_sub_image,
-                                &patch_element)) {
-          return status::kStatusFatal;
-        }
+        gap_regions.push_back({gap_lo, gap_size});
+        gap_writers.push_back(&it_and_success.first->second);
       }
       gap_lo = base::checked_cast<offset_t>(covered.hi());
     }
+
+    std::unique_ptr<bool[]> gap_generated(new bool[gap_regions.size()]());
+    std::vector<base::OnceClosure> gap_tasks;
+    for (size_t i = 0; i < gap_regions.size(); ++i) {
+      gap_tasks.push_back(base::BindOnce(
+          [](const std::vector<offset_t>* old_sa_raw, ConstBufferView old_image,
+             ConstBufferView new_image, BufferRegion gap,
+             PatchElementWriter* patch_element, bool* generated) {
+            LOG(INFO) << "--- Gap   [" << gap.lo() << "," << gap.hi() << ")";
+            *generated = GenerateRawElement(*old_sa_raw, old_image,
+                                            new_image[gap], patch_element);
+          },
+          &old_sa_raw, old_image, new_image, gap_regions[i], gap_writers[i],
+          &gap_generated[i]));
+    }
+    RunTasks(std::move(gap_tasks), num_threads);
+    LogElapsedTime("GapsTime", gaps_timer);
+    for (size_t i = 0; i < gap_regions.size(); ++i) {
+      if (!gap_generated[i])
+        return status::kStatusFatal;
+    }
   }
 
   // Write all PatchElementWriter sorted by "new" offset.
@@ -427,19 +541,31 @@ status::Code GenerateBuffer(ConstBufferView old_image,
                             EnsemblePatchWriter* patch_writer) {
   return GenerateBufferCommon(
       old_image, new_image, std::make_unique<HeuristicEnsembleMatcher>(nullptr),
-      patch_writer);
+      /*num_threads=*/1, patch_writer);
 }
 
 status::Code GenerateBufferImposed(ConstBufferView old_image,
                                    ConstBufferView new_image,
                                    std::string imposed_matches,
                                    EnsemblePatchWriter* patch_writer) {
-  if (imposed_matches.empty())
-    return GenerateBuffer(old_image, new_image, patch_writer);
+  return GenerateBufferParallel(old_image, new_image,
+                                std::move(imposed_matches),
+                                /*num_threads=*/1, patch_writer);
+}
 
-  return GenerateBufferCommon(
-      old_image, new_image,
-      std::make_unique<ImposedEnsembleMatcher>(imposed_matches), patch_writer);
+status::Code GenerateBufferParallel(ConstBufferView old_image,
+                                    ConstBufferView new_image,
+                                    std::string imposed_matches,
+                                    size_t num_threads,
+                                    EnsemblePatchWriter* patch_writer) {
+  DCHECK_GE(num_threads, 1U);
+  std::unique_ptr<EnsembleMatcher> matcher;
+  if (imposed_matches.empty())
+    matcher = std::make_unique<HeuristicEnsembleMatcher>(nullptr);
+  else
+    matcher = std::make_unique<ImposedEnsembleMatcher>(imposed_matches);
+  return GenerateBufferCommon(old_image, new_image, std::move(matcher),
+                              num_threads, patch_writer);
 }
 
 status::Code GenerateBufferRaw(ConstBufferView old_image,
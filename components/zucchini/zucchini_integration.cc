@@ -6,6 +6,7 @@
 
 #include <utility>
 
+#include "base/bind.h"
 #include "base/logging.h"
 #include "components/zucchini/buffer_view.h"
 #include "components/zucchini/mapped_file.h"
@@ -45,7 +46,8 @@ status::Code GenerateCommon(base::File old_file,
                             const FileNames& names,
                             bool force_keep,
                             bool is_raw,
-                            std::string imposed_matches) {
+                            std::string imposed_matches,
+                            size_t num_threads) {
   MappedFileReader mapped_old(std::move(old_file));
   if (mapped_old.HasError()) {
     LOG(ERROR) << "Error with file " << names.old_name.value() << ": "
@@ -66,8 +68,9 @@ status::Code GenerateCommon(base::File old_file,
     result = GenerateBufferRaw(mapped_old.region(), mapped_new.region(),
                                &patch_writer);
   } else {
-    result = GenerateBufferImposed(mapped_old.region(), mapped_new.region(),
-                                   std::move(imposed_matches), &patch_writer);
+    result = GenerateBufferParallel(mapped_old.region(), mapped_new.region(),
+                                    std::move(imposed_matches), num_threads,
+                                    &patch_writer);
   }
   if (result != status::kStatusSuccess) {
     LOG(ERROR) << "Fatal error encountered when generating patch.";
@@ -99,7 +102,8 @@ status::Code ApplyCommon(base::File old_file,
                          base::File patch_file,
                          base::File new_file,
                          const FileNames& names,
-                         bool force_keep) {
+                         bool force_keep,
+                         bool streaming) {
   MappedFileReader mapped_patch(std::move(patch_file));
   if (mapped_patch.HasError()) {
     LOG(ERROR) << "Error with file " << names.patch_name.value() << ": "
@@ -134,7 +138,13 @@ status::Code ApplyCommon(base::File old_file,
     mapped_new.Keep();
 
   status::Code result =
-      ApplyBuffer(mapped_old.region(), *patch_reader, mapped_new.region());
+      streaming
+          ? ApplyBufferStreaming(
+                mapped_old.region(), *patch_reader, mapped_new.region(),
+                base::BindRepeating(&MappedFileWriter::Release,
+                                    base::Unretained(&mapped_new)))
+          : ApplyBuffer(mapped_old.region(), *patch_reader,
+                        mapped_new.region());
   if (result != status::kStatusSuccess) {
     LOG(ERROR) << "Fatal error encountered while applying patch.";
     return result;
@@ -153,11 +163,12 @@ status::Code Generate(base::File old_file,
                       base::File patch_file,
                       bool force_keep,
                       bool is_raw,
-                      std::string imposed_matches) {
+                      std::string imposed_matches,
+                      size_t num_threads) {
   const FileNames file_names;
   return GenerateCommon(std::move(old_file), std::move(new_file),
                         std::move(patch_file), file_names, force_keep, is_raw,
-                        std::move(imposed_matches));
+                        std::move(imposed_matches), num_threads);
 }
 
 status::Code Generate(const base::FilePath& old_path,
@@ -165,7 +176,8 @@ status::Code Generate(const base::FilePath& old_path,
                       const base::FilePath& patch_path,
                       bool force_keep,
                       bool is_raw,
-                      std::string imposed_matches) {
+                      std::string imposed_matches,
+                      size_t num_threads) {
   using base::File;
   File old_file(old_path, File::FLAG_OPEN | File::FLAG_READ);
   File new_file(new_path, File::FLAG_OPEN | File::FLAG_READ);
@@ -175,22 +187,24 @@ status::Code Generate(const base::FilePath& old_path,
   const FileNames file_names(old_path, new_path, patch_path);
   return GenerateCommon(std::move(old_file), std::move(new_file),
                         std::move(patch_file), file_names, force_keep, is_raw,
-                        std::move(imposed_matches));
+                        std::move(imposed_matches), num_threads);
 }
 
 status::Code Apply(base::File old_file,
                    base::File patch_file,
                    base::File new_file,
-                   bool force_keep) {
+                   bool force_keep,
+                   bool streaming) {
   const FileNames file_names;
   return ApplyCommon(std::move(old_file), std::move(patch_file),
-                     std::move(new_file), file_names, force_keep);
+                     std::move(new_file), file_names, force_keep, streaming);
 }
 
 status::Code Apply(const base::FilePath& old_path,
                    const base::FilePath& patch_path,
                    const base::FilePath& new_path,
-                   bool force_keep) {
+                   bool force_keep,
+                   bool streaming) {
   using base::File;
   File old_file(old_path, File::FLAG_OPEN | File::FLAG_READ);
   File patch_file(patch_path, File::FLAG_OPEN | File::FLAG_READ);
@@ -199,7 +213,7 @@ status::Code Apply(const base::FilePath& old_path,
                               File::FLAG_CAN_DELETE_ON_CLOSE);
   const FileNames file_names(old_path, new_path, patch_path);
   return ApplyCommon(std::move(old_file), std::move(patch_file),
-                     std::move(new_file), file_names, force_keep);
+                     std::move(new_file), file_names, force_keep, streaming);
 }
 
 }  // namespace zucchini
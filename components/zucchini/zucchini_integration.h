@@ -5,6 +5,8 @@
 #ifndef COMPONENTS_ZUCCHINI_ZUCCHINI_INTEGRATION_H_
 #define COMPONENTS_ZUCCHINI_ZUCCHINI_INTEGRATION_H_
 
+#include <stddef.h>
+
 #include <string>
 
 #include "base/files/file.h"
@@ -28,12 +30,15 @@ namespace zucchini {
 //   "#+#=#+#,#+#=#+#,..."  (e.g., "1+2=3+4", "1+2=3+4,5+6=7+8"),
 // where "#+#=#+#" encodes a match as 4 unsigned integers:
 //   [offset in "old", size in "old", offset in "new", size in "new"].
+// Patch elements are generated on up to |num_threads| threads, which doesn't
+// change the patch.
 status::Code Generate(base::File old_file,
                       base::File new_file,
                       base::File patch_file,
                       bool force_keep = false,
                       bool is_raw = false,
-                      std::string imposed_matches = "");
+                      std::string imposed_matches = "",
+                      size_t num_threads = 1);
 
 // Alternative Generate() interface that takes base::FilePath as arguments.
 // Performs proper cleanup in Windows and UNIX if failure occurs.
@@ -42,7 +47,8 @@ status::Code Generate(const base::FilePath& old_path,
                       const base::FilePath& patch_path,
                       bool force_keep = false,
                       bool is_raw = false,
-                      std::string imposed_matches = "");
+                      std::string imposed_matches = "",
+                      size_t num_threads = 1);
 
 // Applies the patch in |patch_file| to |old_file|, and writes the result to
 // |new_file|. Since this uses memory mapped files, crashes are expected in case
@@ -50,18 +56,22 @@ status::Code Generate(const base::FilePath& old_path,
 // kStatusSuccess or if |force_keep == true|, and is deleted otherwise. For UNIX
 // systems the caller needs to do cleanup since it has ownership of the
 // base::File params, and Zucchini has no knowledge of which base::FilePath to
-// delete.
+// delete. If |streaming| is true, each element of |new_file| is written back
+// and dropped from memory once complete, to bound memory use on low-memory
+// devices.
 status::Code Apply(base::File old_file,
                    base::File patch_file,
                    base::File new_file,
-                   bool force_keep = false);
+                   bool force_keep = false,
+                   bool streaming = false);
 
 // Alternative Apply() interface that takes base::FilePath as arguments.
 // Performs proper cleanup in Windows and UNIX if failure occurs.
 status::Code Apply(const base::FilePath& old_path,
                    const base::FilePath& patch_path,
                    const base::FilePath& new_path,
-                   bool force_keep = false);
+                   bool force_keep = false,
+                   bool streaming = false);
 
 }  // namespace zucchini
 
@@ -0,0 +1,40 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/cache_storage/cache_storage_cache.h"
+
+#include "content/browser/cache_storage/cache_storage.pb.h"
+
+namespace content {
+
+CacheStorageCache::CacheStorageCache() = default;
+CacheStorageCache::~CacheStorageCache() = default;
+
+void CacheStorageCache::DidPutEntry(const std::string& key,
+                                    const proto::CacheMetadata& metadata) {
+  match_index_.Put(key, metadata);
+}
+
+void CacheStorageCache::DidDeleteEntry(const std::string& key) {
+  match_index_.Delete(key);
+}
+
+void CacheStorageCache::DidLoadMatchIndex() {
+  match_index_loaded_ = true;
+}
+
+void CacheStorageCache::ResetMatchIndex() {
+  match_index_.Clear();
+  match_index_loaded_ = false;
+}
+
+base::Optional<std::vector<std::string>> CacheStorageCache::MatchIndexedKeys(
+    const blink::mojom::FetchAPIRequest* request,
+    const blink::mojom::CacheQueryOptions* options) const {
+  if (!match_index_loaded_)
+    return base::nullopt;
+  return match_index_.Match(request, options);
+}
+
+}  // namespace content
@@ -12,13 +12,20 @@
 #include <vector>
 
 #include "base/callback.h"
+#include "base/macros.h"
+#include "base/optional.h"
 #include "content/browser/cache_storage/cache_storage_cache_handle.h"
+#include "content/browser/cache_storage/cache_storage_cache_match_index.h"
 #include "content/common/content_export.h"
 #include "third_party/blink/public/mojom/cache_storage/cache_storage.mojom.h"
 #include "url/origin.h"
 
 namespace content {
 
+namespace proto {
+class CacheMetadata;
+}  // namespace proto
+
 // Represents a ServiceWorker Cache as seen in:
 //
 //  https://w3c.github.io/ServiceWorker/#cache-interface
@@ -28,6 +35,11 @@ namespace content {
 // to for client code hold a |CacheStorageCacheHandle| to the cache for the
 // duration of any operations. Otherwise it is possible the operation may
 // get cancelled in some circumstances.
+//
+// Implementations that keep their entries in a disk_cache also keep a
+// CacheStorageCacheMatchIndex of them. They report their writes and deletes
+// with DidPutEntry() and DidDeleteEntry(), and find the entries that Match,
+// MatchAll and Keys open with MatchIndexedKeys().
 class CONTENT_EXPORT CacheStorageCache {
  public:
   using CacheEntry = std::pair<blink::mojom::FetchAPIRequestPtr,
@@ -149,7 +161,38 @@ class CONTENT_EXPORT CacheStorageCache {
   virtual InitState GetInitState() const = 0;
 
  protected:
-  virtual ~CacheStorageCache() = default;
+  CacheStorageCache();
+  virtual ~CacheStorageCache();
+
+  // Records the entry just written under |key| with |metadata|.
+  void DidPutEntry(const std::string& key,
+                   const proto::CacheMetadata& metadata);
+
+  // Records that the entry under |key| was doomed.
+  void DidDeleteEntry(const std::string& key);
+
+  // Marks the index as holding every entry of the cache. Called once the
+  // implementation has restored it with match_index()->Parse(), or has put
+  // every entry in it while opening its backend.
+  void DidLoadMatchIndex();
+
+  // Forgets the indexed entries, as when the backend is lost or recreated.
+  void ResetMatchIndex();
+
+  // Returns the keys of the entries matching |request| with |options|, oldest
+  // first, without opening any entry. Returns null while the index isn't
+  // loaded, in which case the implementation scans its entries.
+  base::Optional<std::vector<std::string>> MatchIndexedKeys(
+      const blink::mojom::FetchAPIRequest* request,
+      const blink::mojom::CacheQueryOptions* options) const;
+
+  CacheStorageCacheMatchIndex* match_index() { return &match_index_; }
+
+ private:
+  CacheStorageCacheMatchIndex match_index_;
+  bool match_index_loaded_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(CacheStorageCache);
 };
 
 }  // namespace content
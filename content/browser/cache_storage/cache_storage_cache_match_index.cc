@@ -0,0 +1,224 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/cache_storage/cache_storage_cache_match_index.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "base/logging.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "content/browser/cache_storage/cache_storage.pb.h"
+#include "url/gurl.h"
+
+namespace content {
+
+namespace {
+
+std::string GetUrlWithoutQuery(const GURL& url) {
+  GURL::Replacements replacements;
+  replacements.ClearQuery();
+  replacements.ClearRef();
+  return url.ReplaceComponents(replacements).spec();
+}
+
+bool VaryMatches(const CacheStorageCacheMatchIndex::Entry& entry,
+                 const blink::mojom::FetchAPIRequest& request) {
+  if (entry.vary_all)
+    return false;
+  for (const auto& vary_header : entry.vary_headers) {
+    auto request_iter = request.headers.find(vary_header.first);
+    // If the header exists in one but not the other, no match.
+    if ((request_iter == request.headers.end()) != !vary_header.second)
+      return false;
+    // If the header exists in one, it exists in both. Verify that the values
+    // are equal.
+    if (request_iter != request.headers.end() &&
+        request_iter->second != *vary_header.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+CacheStorageCacheMatchIndex::Entry::Entry() = default;
+CacheStorageCacheMatchIndex::Entry::Entry(const Entry& other) = default;
+CacheStorageCacheMatchIndex::Entry::~Entry() = default;
+
+CacheStorageCacheMatchIndex::CacheStorageCacheMatchIndex() = default;
+CacheStorageCacheMatchIndex::~CacheStorageCacheMatchIndex() = default;
+
+void CacheStorageCacheMatchIndex::Put(const std::string& key,
+                                      const proto::CacheMetadata& metadata) {
+  Entry entry;
+  entry.key = key;
+  entry.entry_time = metadata.entry_time();
+  entry.response_time = metadata.response().response_time();
+
+  const std::string* vary = nullptr;
+  for (const auto& header : metadata.response().headers()) {
+    if (base::EqualsCaseInsensitiveASCII(header.name(), "vary")) {
+      vary = &header.value();
+      break;
+    }
+  }
+  if (vary) {
+    for (const std::string& name :
+         base::SplitString(*vary, ",", base::TRIM_WHITESPACE,
+                           base::SPLIT_WANT_NONEMPTY)) {
+      if (name == "*") {
+        entry.vary_all = true;
+        continue;
+      }
+      base::Optional<std::string> value;
+      for (const auto& header : metadata.request().headers()) {
+        if (base::EqualsCaseInsensitiveASCII(header.name(), name)) {
+          value = header.value();
+          break;
+        }
+      }
+      entry.vary_headers.emplace_back(base::ToLowerASCII(name),
+                                      std::move(value));
+    }
+  }
+
+  Delete(key);
+  AddEntry(std::move(entry));
+}
+
+bool CacheStorageCacheMatchIndex::Delete(const std::string& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end())
+    return false;
+  auto keys_it =
+      keys_by_url_without_query_.find(GetUrlWithoutQuery(GURL(key)));
+  DCHECK(keys_it != keys_by_url_without_query_.end());
+  keys_it->second.erase(key);
+  if (keys_it->second.empty())
+    keys_by_url_without_query_.erase(keys_it);
+  entries_.erase(it);
+  return true;
+}
+
+void CacheStorageCacheMatchIndex::Clear() {
+  entries_.clear();
+  keys_by_url_without_query_.clear();
+}
+
+std::vector<std::string> CacheStorageCacheMatchIndex::Match(
+    const blink::mojom::FetchAPIRequest* request,
+    const blink::mojom::CacheQueryOptions* options) const {
+  const bool ignore_method = options && options->ignore_method;
+  const bool ignore_search = options && options->ignore_search;
+  const bool ignore_vary = options && options->ignore_vary;
+
+  if (request && !ignore_method && !request->method.empty() &&
+      request->method != "GET") {
+    return {};
+  }
+
+  std::vector<const Entry*> matches;
+  auto add_if_matches = [&](const Entry& entry) {
+    if (request && !ignore_vary && !VaryMatches(entry, *request))
+      return;
+    matches.push_back(&entry);
+  };
+
+  if (!request) {
+    for (const auto& entry : entries_)
+      add_if_matches(entry.second);
+  } else if (ignore_search) {
+    auto keys_it =
+        keys_by_url_without_query_.find(GetUrlWithoutQuery(request->url));
+    if (keys_it != keys_by_url_without_query_.end()) {
+      for (const std::string& key : keys_it->second)
+        add_if_matches(entries_.find(key)->second);
+    }
+  } else {
+    auto it = entries_.find(request->url.spec());
+    if (it != entries_.end())
+      add_if_matches(it->second);
+  }
+
+  std::sort(matches.begin(), matches.end(),
+            [](const Entry* a, const Entry* b) {
+              return std::tie(a->entry_time, a->key) <
+                     std::tie(b->entry_time, b->key);
+            });
+  std::vector<std::string> keys;
+  keys.reserve(matches.size());
+  for (const Entry* entry : matches)
+    keys.push_back(entry->key);
+  return keys;
+}
+
+const CacheStorageCacheMatchIndex::Entry* CacheStorageCacheMatchIndex::GetEntry(
+    const std::string& key) const {
+  auto it = entries_.find(key);
+  if (it == entries_.end())
+    return nullptr;
+  return &it->second;
+}
+
+std::string CacheStorageCacheMatchIndex::Serialize() const {
+  proto::CacheMatchIndex index;
+  for (const auto& it : entries_) {
+    const Entry& entry = it.second;
+    proto::CacheMatchIndex::Entry* index_entry = index.add_entry();
+    index_entry->set_key(entry.key);
+    index_entry->set_entry_time(entry.entry_time);
+    index_entry->set_response_time(entry.response_time);
+    index_entry->set_vary_all(entry.vary_all);
+    for (const auto& vary_header : entry.vary_headers) {
+      proto::CacheMatchIndex::VaryHeader* index_header =
+          index_entry->add_vary_header();
+      index_header->set_name(vary_header.first);
+      if (vary_header.second)
+        index_header->set_value(*vary_header.second);
+    }
+  }
+  std::string serialized;
+  index.SerializeToString(&serialized);
+  return serialized;
+}
+
+bool CacheStorageCacheMatchIndex::Parse(const std::string& serialized) {
+  Clear();
+  proto::CacheMatchIndex index;
+  if (!index.ParseFromString(serialized))
+    return false;
+  for (const proto::CacheMatchIndex::Entry& index_entry : index.entry()) {
+    if (!GURL(index_entry.key()).is_valid() ||
+        entries_.count(index_entry.key())) {
+      Clear();
+      return false;
+    }
+    Entry entry;
+    entry.key = index_entry.key();
+    entry.entry_time = index_entry.entry_time();
+    entry.response_time = index_entry.response_time();
+    entry.vary_all = index_entry.vary_all();
+    for (const auto& index_header : index_entry.vary_header()) {
+      base::Optional<std::string> value;
+      if (index_header.has_value())
+        value = index_header.value();
+      entry.vary_headers.emplace_back(index_header.name(), std::move(value));
+    }
+    AddEntry(std::move(entry));
+  }
+  return true;
+}
+
+void CacheStorageCacheMatchIndex::AddEntry(Entry entry) {
+  DCHECK(!entries_.count(entry.key));
+  keys_by_url_without_query_[GetUrlWithoutQuery(GURL(entry.key))].insert(
+      entry.key);
+  std::string key = entry.key;
+  entries_.emplace(std::move(key), std::move(entry));
+}
+
+}  // namespace content
@@ -0,0 +1,106 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_BROWSER_CACHE_STORAGE_CACHE_STORAGE_CACHE_MATCH_INDEX_H_
+#define CONTENT_BROWSER_CACHE_STORAGE_CACHE_STORAGE_CACHE_MATCH_INDEX_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/optional.h"
+#include "content/common/content_export.h"
+#include "third_party/blink/public/mojom/cache_storage/cache_storage.mojom.h"
+
+namespace content {
+
+namespace proto {
+class CacheMetadata;
+}  // namespace proto
+
+// CacheStorageCacheMatchIndex keeps, for each entry of a cache, what Match,
+// MatchAll and Keys need to tell whether the entry matches a request: its key,
+// the request headers named by the Vary header of its response, and a little
+// response metadata. The cache can then open just the matching entries instead
+// of opening every candidate and parsing its CacheMetadata.
+//
+// The index is updated on put and delete. It can be written out with
+// Serialize() and read back with Parse(), so that it need not be rebuilt from
+// the entries on every start. This class is not thread safe, and is owned by
+// the cache.
+class CONTENT_EXPORT CacheStorageCacheMatchIndex {
+ public:
+  struct CONTENT_EXPORT Entry {
+    Entry();
+    Entry(const Entry& other);
+    ~Entry();
+
+    // The disk_cache key of the entry, which is the request URL.
+    std::string key;
+
+    // When the entry was put. Matches are ordered by it.
+    int64_t entry_time = 0;
+
+    // The response time, which WriteSideData() checks.
+    int64_t response_time = 0;
+
+    // True if the response varies on "*", so that the entry only matches when
+    // Vary is ignored.
+    bool vary_all = false;
+
+    // The lower-cased names in the Vary header of the response, with the
+    // value of that header in the cached request, or none if it had none.
+    std::vector<std::pair<std::string, base::Optional<std::string>>>
+        vary_headers;
+  };
+
+  CacheStorageCacheMatchIndex();
+  ~CacheStorageCacheMatchIndex();
+
+  // Adds the entry put under |key|, replacing any entry with the same key.
+  void Put(const std::string& key, const proto::CacheMetadata& metadata);
+
+  // Returns false if there was no entry under |key|.
+  bool Delete(const std::string& key);
+
+  void Clear();
+
+  // Returns the keys of the entries that match |request| with |options|,
+  // oldest first. A null |request| matches every entry, and a null |options|
+  // is the default options.
+  std::vector<std::string> Match(
+      const blink::mojom::FetchAPIRequest* request,
+      const blink::mojom::CacheQueryOptions* options) const;
+
+  // Returns nullptr if there is no entry under |key|.
+  const Entry* GetEntry(const std::string& key) const;
+
+  size_t num_entries() const { return entries_.size(); }
+
+  std::string Serialize() const;
+
+  // Replaces the entries with those of |serialized|. Returns false, leaving
+  // the index empty, if |serialized| can't be parsed.
+  bool Parse(const std::string& serialized);
+
+ private:
+  void AddEntry(Entry entry);
+
+  std::map<std::string, Entry> entries_;
+
+  // The keys of the entries by their URL without query and fragment, for
+  // matching with ignoreSearch.
+  std::map<std::string, std::set<std::string>> keys_by_url_without_query_;
+
+  DISALLOW_COPY_AND_ASSIGN(CacheStorageCacheMatchIndex);
+};
+
+}  // namespace content
+
+#endif  // CONTENT_BROWSER_CACHE_STORAGE_CACHE_STORAGE_CACHE_MATCH_INDEX_H_
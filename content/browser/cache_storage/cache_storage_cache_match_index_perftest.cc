@@ -0,0 +1,150 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares finding the entries of a large cache that match a request with
+// ignoreSearch by parsing the CacheMetadata of every entry, as the cache does
+// after opening each of them, with looking them up in the match index. The
+// entry opens themselves are left out, so this understates the difference.
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "content/browser/cache_storage/cache_storage.pb.h"
+#include "content/browser/cache_storage/cache_storage_cache_match_index.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+#include "url/gurl.h"
+
+namespace content {
+namespace {
+
+constexpr int kEntryCount = 5000;
+constexpr int kUrlCount = 500;
+constexpr int kQueryCount = 200;
+
+std::string EntryKey(int entry) {
+  return base::StringPrintf("https://example.com/asset%d.js?v=%d",
+                            entry % kUrlCount, entry / kUrlCount);
+}
+
+std::string Language(int entry) {
+  return entry % 2 ? "en" : "fr";
+}
+
+proto::CacheMetadata CreateMetadata(int entry) {
+  proto::CacheMetadata metadata;
+  metadata.set_entry_time(entry);
+  proto::CacheRequest* request = metadata.mutable_request();
+  request->set_method("GET");
+  proto::CacheHeaderMap* request_header = request->add_headers();
+  request_header->set_name("Accept-Language");
+  request_header->set_value(Language(entry));
+  proto::CacheResponse* response = metadata.mutable_response();
+  response->set_status_code(200);
+  response->set_status_text("OK");
+  response->set_response_type(proto::CacheResponse::BASIC_TYPE);
+  response->set_response_time(entry);
+  response->add_url_list(EntryKey(entry));
+  const char* const kResponseHeaders[][2] = {
+      {"Content-Type", "application/javascript"},
+      {"Cache-Control", "public, max-age=31536000"},
+      {"Vary", "Accept-Language"},
+      {"ETag", "\"0123456789abcdef\""}};
+  for (const auto& header : kResponseHeaders) {
+    proto::CacheHeaderMap* response_header = response->add_headers();
+    response_header->set_name(header[0]);
+    response_header->set_value(header[1]);
+  }
+  return metadata;
+}
+
+std::string GetUrlWithoutQuery(const GURL& url) {
+  GURL::Replacements replacements;
+  replacements.ClearQuery();
+  replacements.ClearRef();
+  return url.ReplaceComponents(replacements).spec();
+}
+
+class CacheStorageCacheMatchIndexPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (int entry = 0; entry < kEntryCount; ++entry) {
+      proto::CacheMetadata metadata = CreateMetadata(entry);
+      std::string serialized;
+      ASSERT_TRUE(metadata.SerializeToString(&serialized));
+      entries_.emplace_back(EntryKey(entry), std::move(serialized));
+      index_.Put(EntryKey(entry), metadata);
+    }
+  }
+
+  blink::mojom::FetchAPIRequestPtr CreateRequest(int query) {
+    auto request = blink::mojom::FetchAPIRequest::New();
+    request->url = GURL(base::StringPrintf("https://example.com/asset%d.js",
+                                           query * 7 % kUrlCount));
+    request->method = "GET";
+    request->headers.emplace("Accept-Language", Language(query));
+    return request;
+  }
+
+  // Parses the metadata of every entry and checks its URL and Vary header.
+  size_t MatchByParsingEntries(const blink::mojom::FetchAPIRequest& request) {
+    const std::string url = GetUrlWithoutQuery(request.url);
+    const std::string& language = request.headers.at("Accept-Language");
+    size_t matches = 0;
+    for (const auto& entry : entries_) {
+      proto::CacheMetadata metadata;
+      EXPECT_TRUE(metadata.ParseFromString(entry.second));
+      if (GetUrlWithoutQuery(GURL(entry.first)) != url)
+        continue;
+      for (const auto& header : metadata.request().headers()) {
+        if (base::EqualsCaseInsensitiveASCII(header.name(),
+                                             "Accept-Language") &&
+            header.value() == language) {
+          ++matches;
+        }
+      }
+    }
+    return matches;
+  }
+
+  std::vector<std::pair<std::string, std::string>> entries_;
+  CacheStorageCacheMatchIndex index_;
+};
+
+TEST_F(CacheStorageCacheMatchIndexPerfTest, IgnoreSearch) {
+  auto options = blink::mojom::CacheQueryOptions::New();
+  options->ignore_search = true;
+
+  size_t parsed_matches = 0;
+  base::ElapsedTimer parse_timer;
+  for (int query = 0; query < kQueryCount; ++query)
+    parsed_matches += MatchByParsingEntries(*CreateRequest(query));
+  const base::TimeDelta parse_time = parse_timer.Elapsed();
+
+  size_t index_matches = 0;
+  base::ElapsedTimer index_timer;
+  for (int query = 0; query < kQueryCount; ++query)
+    index_matches +=
+        index_.Match(CreateRequest(query).get(), options.get()).size();
+  const base::TimeDelta index_time = index_timer.Elapsed();
+
+  EXPECT_GT(index_matches, 0u);
+  EXPECT_EQ(parsed_matches, index_matches);
+  perf_test::PrintResult("CacheStorageCacheMatchIndex", "",
+                         "parse_entries_match",
+                         parse_time.InMicrosecondsF() / kQueryCount,
+                         "us/query", true);
+  perf_test::PrintResult("CacheStorageCacheMatchIndex", "", "index_match",
+                         index_time.InMicrosecondsF() / kQueryCount,
+                         "us/query", true);
+}
+
+}  // namespace
+}  // namespace content
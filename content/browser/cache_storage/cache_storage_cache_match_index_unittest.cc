@@ -0,0 +1,281 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/cache_storage/cache_storage_cache_match_index.h"
+
+#include <string>
+#include <vector>
+
+#include "content/browser/cache_storage/cache_storage.pb.h"
+#include "content/browser/cache_storage/cache_storage_cache.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace content {
+
+namespace {
+
+proto::CacheMetadata CreateMetadata(
+    int64_t entry_time,
+    const std::vector<std::pair<std::string, std::string>>& request_headers,
+    const std::string& vary) {
+  proto::CacheMetadata metadata;
+  metadata.set_entry_time(entry_time);
+  metadata.mutable_request()->set_method("GET");
+  for (const auto& header : request_headers) {
+    proto::CacheHeaderMap* header_map =
+        metadata.mutable_request()->add_headers();
+    header_map->set_name(header.first);
+    header_map->set_value(header.second);
+  }
+  proto::CacheResponse* response = metadata.mutable_response();
+  response->set_status_code(200);
+  response->set_status_text("OK");
+  response->set_response_type(proto::CacheResponse::DEFAULT_TYPE);
+  response->set_response_time(entry_time * 10);
+  if (!vary.empty()) {
+    proto::CacheHeaderMap* header_map = response->add_headers();
+    header_map->set_name("Vary");
+    header_map->set_value(vary);
+  }
+  return metadata;
+}
+
+blink::mojom::FetchAPIRequestPtr CreateRequest(
+    const std::string& url,
+    const std::vector<std::pair<std::string, std::string>>& headers = {}) {
+  auto request = blink::mojom::FetchAPIRequest::New();
+  request->url = GURL(url);
+  request->method = "GET";
+  for (const auto& header : headers)
+    request->headers.emplace(header.first, header.second);
+  return request;
+}
+
+// A cache that only exposes the match index hooks of CacheStorageCache.
+class IndexedCache : public CacheStorageCache {
+ public:
+  IndexedCache() = default;
+  ~IndexedCache() override = default;
+
+  using CacheStorageCache::DidDeleteEntry;
+  using CacheStorageCache::DidLoadMatchIndex;
+  using CacheStorageCache::DidPutEntry;
+  using CacheStorageCache::MatchIndexedKeys;
+  using CacheStorageCache::ResetMatchIndex;
+
+  CacheStorageCacheHandle CreateHandle() override {
+    return CacheStorageCacheHandle();
+  }
+  void AddHandleRef() override {}
+  void DropHandleRef() override {}
+  bool IsUnreferenced() const override { return true; }
+  void Match(blink::mojom::FetchAPIRequestPtr request,
+             blink::mojom::CacheQueryOptionsPtr match_options,
+             int64_t trace_id,
+             ResponseCallback callback) override {}
+  void MatchAll(blink::mojom::FetchAPIRequestPtr request,
+                blink::mojom::CacheQueryOptionsPtr match_options,
+                int64_t trace_id,
+                ResponsesCallback callback) override {}
+  void WriteSideData(ErrorCallback callback,
+                     const GURL& url,
+                     base::Time expected_response_time,
+                     int64_t trace_id,
+                     scoped_refptr<net::IOBuffer> buffer,
+                     int buf_len) override {}
+  void BatchOperation(std::vector<blink::mojom::BatchOperationPtr> operations,
+                      int64_t trace_id,
+                      VerboseErrorCallback callback,
+                      BadMessageCallback bad_message_callback) override {}
+  void Keys(blink::mojom::FetchAPIRequestPtr request,
+            blink::mojom::CacheQueryOptionsPtr options,
+            int64_t trace_id,
+            RequestsCallback callback) override {}
+  void Put(blink::mojom::FetchAPIRequestPtr request,
+           blink::mojom::FetchAPIResponsePtr response,
+           int64_t trace_id,
+           ErrorCallback callback) override {}
+  void GetAllMatchedEntries(blink::mojom::FetchAPIRequestPtr request,
+                            blink::mojom::CacheQueryOptionsPtr match_options,
+                            int64_t trace_id,
+                            CacheEntriesCallback callback) override {}
+  InitState GetInitState() const override { return InitState::Initialized; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(IndexedCache);
+};
+
+}  // namespace
+
+class CacheStorageCacheMatchIndexTest : public testing::Test {
+ protected:
+  std::vector<std::string> Match(
+      const std::string& url,
+      const std::vector<std::pair<std::string, std::string>>& headers = {},
+      blink::mojom::CacheQueryOptionsPtr options = nullptr) {
+    return index_.Match(CreateRequest(url, headers).get(), options.get());
+  }
+
+  CacheStorageCacheMatchIndex index_;
+};
+
+TEST_F(CacheStorageCacheMatchIndexTest, PutAndDelete) {
+  index_.Put("https://example.com/a", CreateMetadata(1, {}, ""));
+  index_.Put("https://example.com/b", CreateMetadata(2, {}, ""));
+  EXPECT_EQ(2u, index_.num_entries());
+  EXPECT_THAT(Match("https://example.com/a"),
+              ElementsAre("https://example.com/a"));
+  EXPECT_THAT(Match("https://example.com/c"), IsEmpty());
+
+  const CacheStorageCacheMatchIndex::Entry* entry =
+      index_.GetEntry("https://example.com/b");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(2, entry->entry_time);
+  EXPECT_EQ(20, entry->response_time);
+
+  EXPECT_TRUE(index_.Delete("https://example.com/a"));
+  EXPECT_FALSE(index_.Delete("https://example.com/a"));
+  EXPECT_THAT(Match("https://example.com/a"), IsEmpty());
+  EXPECT_EQ(1u, index_.num_entries());
+}
+
+TEST_F(CacheStorageCacheMatchIndexTest, PutReplaces) {
+  index_.Put("https://example.com/a", CreateMetadata(1, {}, ""));
+  index_.Put("https://example.com/a", CreateMetadata(5, {}, ""));
+  EXPECT_EQ(1u, index_.num_entries());
+  EXPECT_EQ(5, index_.GetEntry("https://example.com/a")->entry_time);
+}
+
+TEST_F(CacheStorageCacheMatchIndexTest, IgnoreSearch) {
+  index_.Put("https://example.com/a?q=2", CreateMetadata(2, {}, ""));
+  index_.Put("https://example.com/a?q=1", CreateMetadata(1, {}, ""));
+  index_.Put("https://example.com/a", CreateMetadata(3, {}, ""));
+  index_.Put("https://example.com/b?q=1", CreateMetadata(4, {}, ""));
+
+  EXPECT_THAT(Match("https://example.com/a?q=3"), IsEmpty());
+
+  auto options = blink::mojom::CacheQueryOptions::New();
+  options->ignore_search = true;
+  EXPECT_THAT(Match("https://example.com/a?q=3", {}, options.Clone()),
+              ElementsAre("https://example.com/a?q=1",
+                          "https://example.com/a?q=2",
+                          "https://example.com/a"));
+
+  index_.Delete("https://example.com/a?q=1");
+  EXPECT_THAT(Match("https://example.com/a", {}, std::move(options)),
+              ElementsAre("https://example.com/a?q=2",
+                          "https://example.com/a"));
+}
+
+TEST_F(CacheStorageCacheMatchIndexTest, Vary) {
+  index_.Put("https://example.com/a",
+             CreateMetadata(1, {{"Accept", "text/html"}}, "accept, x-absent"));
+
+  EXPECT_THAT(Match("https://example.com/a", {{"accept", "text/html"}}),
+              ElementsAre("https://example.com/a"));
+  EXPECT_THAT(Match("https://example.com/a", {{"accept", "image/png"}}),
+              IsEmpty());
+  EXPECT_THAT(Match("https://example.com/a"), IsEmpty());
+  EXPECT_THAT(Match("https://example.com/a",
+                    {{"accept", "text/html"}, {"x-absent", "1"}}),
+              IsEmpty());
+
+  auto options = blink::mojom::CacheQueryOptions::New();
+  options->ignore_vary = true;
+  EXPECT_THAT(Match("https://example.com/a", {}, std::move(options)),
+              ElementsAre("https://example.com/a"));
+}
+
+TEST_F(CacheStorageCacheMatchIndexTest, VaryStar) {
+  index_.Put("https://example.com/a", CreateMetadata(1, {}, "*"));
+  EXPECT_THAT(Match("https://example.com/a"), IsEmpty());
+
+  auto options = blink::mojom::CacheQueryOptions::New();
+  options->ignore_vary = true;
+  EXPECT_THAT(Match("https://example.com/a", {}, std::move(options)),
+              ElementsAre("https://example.com/a"));
+}
+
+TEST_F(CacheStorageCacheMatchIndexTest, Method) {
+  index_.Put("https://example.com/a", CreateMetadata(1, {}, ""));
+  blink::mojom::FetchAPIRequestPtr request =
+      CreateRequest("https://example.com/a");
+  request->method = "POST";
+  EXPECT_THAT(index_.Match(request.get(), nullptr), IsEmpty());
+
+  auto options = blink::mojom::CacheQueryOptions::New();
+  options->ignore_method = true;
+  EXPECT_THAT(index_.Match(request.get(), options.get()),
+              ElementsAre("https://example.com/a"));
+}
+
+TEST_F(CacheStorageCacheMatchIndexTest, NullRequestMatchesAll) {
+  index_.Put("https://example.com/b", CreateMetadata(2, {}, "*"));
+  index_.Put("https://example.com/a", CreateMetadata(1, {}, ""));
+  EXPECT_THAT(index_.Match(nullptr, nullptr),
+              ElementsAre("https://example.com/a", "https://example.com/b"));
+}
+
+TEST_F(CacheStorageCacheMatchIndexTest, SerializeAndParse) {
+  index_.Put("https://example.com/a?q=1",
+             CreateMetadata(1, {{"Accept", "text/html"}}, "Accept, X-Absent"));
+  index_.Put("https://example.com/b", CreateMetadata(2, {}, "*"));
+
+  CacheStorageCacheMatchIndex parsed;
+  ASSERT_TRUE(parsed.Parse(index_.Serialize()));
+  EXPECT_EQ(2u, parsed.num_entries());
+  const CacheStorageCacheMatchIndex::Entry* entry =
+      parsed.GetEntry("https://example.com/a?q=1");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(1, entry->entry_time);
+  EXPECT_EQ(10, entry->response_time);
+  EXPECT_FALSE(entry->vary_all);
+  ASSERT_EQ(2u, entry->vary_headers.size());
+  EXPECT_EQ("accept", entry->vary_headers[0].first);
+  ASSERT_TRUE(entry->vary_headers[0].second);
+  EXPECT_EQ("text/html", *entry->vary_headers[0].second);
+  EXPECT_EQ("x-absent", entry->vary_headers[1].first);
+  EXPECT_FALSE(entry->vary_headers[1].second);
+  EXPECT_TRUE(parsed.GetEntry("https://example.com/b")->vary_all);
+
+  auto options = blink::mojom::CacheQueryOptions::New();
+  options->ignore_search = true;
+  EXPECT_THAT(parsed.Match(CreateRequest("https://example.com/a",
+                                         {{"accept", "text/html"}})
+                               .get(),
+                           options.get()),
+              ElementsAre("https://example.com/a?q=1"));
+
+  EXPECT_FALSE(parsed.Parse("not a proto"));
+  EXPECT_EQ(0u, parsed.num_entries());
+}
+
+// The cache scans its entries until its index is loaded, and then keeps the
+// index up to date with its puts and deletes.
+TEST(CacheStorageCacheMatchIndexHooksTest, MatchIndexedKeys) {
+  IndexedCache cache;
+  auto request = CreateRequest("https://example.com/a");
+  cache.DidPutEntry("https://example.com/a", CreateMetadata(1, {}, ""));
+  EXPECT_FALSE(cache.MatchIndexedKeys(request.get(), nullptr));
+
+  cache.DidLoadMatchIndex();
+  base::Optional<std::vector<std::string>> keys =
+      cache.MatchIndexedKeys(request.get(), nullptr);
+  ASSERT_TRUE(keys);
+  EXPECT_THAT(*keys, ElementsAre("https://example.com/a"));
+
+  cache.DidDeleteEntry("https://example.com/a");
+  keys = cache.MatchIndexedKeys(request.get(), nullptr);
+  ASSERT_TRUE(keys);
+  EXPECT_THAT(*keys, IsEmpty());
+
+  cache.ResetMatchIndex();
+  EXPECT_FALSE(cache.MatchIndexedKeys(nullptr, nullptr));
+}
+
+}  // namespace content
@@ -16,6 +16,7 @@
 #include "content/browser/indexed_db/indexed_db_callback_helpers.h"
 #include "content/browser/indexed_db/indexed_db_connection.h"
 #include "content/browser/indexed_db/indexed_db_context_impl.h"
+#include "content/browser/indexed_db/indexed_db_database.h"
 #include "content/browser/indexed_db/indexed_db_dispatcher_host.h"
 #include "content/browser/indexed_db/indexed_db_factory_impl.h"
 #include "content/browser/indexed_db/indexed_db_transaction.h"
@@ -222,12 +223,18 @@ void DatabaseImpl::Get(int64_t transaction_id,
                                     blink::mojom::IDBDatabaseGetResultPtr>(
           std::move(callback), transaction->AsWeakPtr());
 
-  transaction->ScheduleTask(BindWeakOperation(
+  IndexedDBTransaction::Operation operation = BindWeakOperation(
       &IndexedDBDatabase::GetOperation, connection_->database()->AsWeakPtr(),
       dispatcher_host_->AsWeakPtr(), object_store_id, index_id,
       std::make_unique<IndexedDBKeyRange>(key_range),
       key_only ? indexed_db::CURSOR_KEY_ONLY : indexed_db::CURSOR_KEY_AND_VALUE,
-      std::move(aborting_callback)));
+      std::move(aborting_callback));
+  if (IndexedDBDatabase::ReadsRecordInParallel(transaction, index_id,
+                                               key_range)) {
+    transaction->ScheduleOverlappingReadTask(std::move(operation));
+  } else {
+    transaction->ScheduleTask(std::move(operation));
+  }
 }
 
 void DatabaseImpl::GetAll(int64_t transaction_id,
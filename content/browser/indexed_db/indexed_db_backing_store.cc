@@ -512,6 +512,65 @@ bool IndexCursorOptions(
   return true;
 }
 
+// Fills |record| from the |data| stored for an object store record.
+Status DecodeRecordData(const std::string& data, IndexedDBValue* record) {
+  if (data.empty()) {
+    INTERNAL_READ_ERROR_UNTESTED(GET_RECORD);
+    return Status::NotFound("Record contained no data");
+  }
+
+  int64_t version;
+  StringPiece slice(data);
+  if (!DecodeVarInt(&slice, &version)) {
+    INTERNAL_READ_ERROR_UNTESTED(GET_RECORD);
+    return InternalInconsistencyStatus();
+  }
+
+  record->bits = slice.as_string();
+  return Status::OK();
+}
+
+// What GetRecordInParallel() read on the thread pool.
+struct SnapshotRead {
+  Status status;
+  bool found = false;
+  std::string data;
+};
+
+SnapshotRead ReadFromSnapshot(scoped_refptr<LevelDBSharedSnapshot> snapshot,
+                              const std::string& leveldb_key) {
+  IDB_TRACE("IndexedDBBackingStore::ReadFromSnapshot");
+  SnapshotRead read;
+  read.status = snapshot->Get(leveldb_key, &read.data, &read.found);
+  return read;
+}
+
+void DidReadFromSnapshot(
+    base::WeakPtr<IndexedDBBackingStore::Transaction> transaction,
+    int64_t database_id,
+    const std::string& leveldb_key,
+    IndexedDBBackingStore::GetRecordCallback callback,
+    SnapshotRead read) {
+  // The transaction finished while the read ran, so nobody waits for it.
+  if (!transaction || !transaction->transaction())
+    return;
+
+  IndexedDBValue record;
+  if (!read.status.ok()) {
+    INTERNAL_READ_ERROR(GET_RECORD);
+    std::move(callback).Run(read.status, std::move(record));
+    return;
+  }
+  if (!read.found) {
+    std::move(callback).Run(read.status, std::move(record));
+    return;
+  }
+  Status s = DecodeRecordData(read.data, &record);
+  if (s.ok())
+    s = transaction->GetBlobInfoForRecord(database_id, leveldb_key, &record);
+  std::move(callback).Run(s, std::move(record));
+}
+
 }  // namespace
 
 IndexedDBBackingStore::IndexedDBBackingStore(
@@ -1004,20 +1063,41 @@ Status IndexedDBBackingStore::GetRecord(
   }
   if (!found)
     return s;
-  if (data.empty()) {
-    INTERNAL_READ_ERROR_UNTESTED(GET_RECORD);
-    return Status::NotFound("Record contained no data");
-  }
+  s = DecodeRecordData(data, record);
+  if (!s.ok())
+    return s;
+  return transaction->GetBlobInfoForRecord(database_id, leveldb_key, record);
+}
 
-  int64_t version;
-  StringPiece slice(data);
-  if (!DecodeVarInt(&slice, &version)) {
-    INTERNAL_READ_ERROR_UNTESTED(GET_RECORD);
-    return InternalInconsistencyStatus();
+void IndexedDBBackingStore::GetRecordInParallel(
+    IndexedDBBackingStore::Transaction* transaction,
+    int64_t database_id,
+    int64_t object_store_id,
+    const IndexedDBKey& key,
+    GetRecordCallback callback) {
+  DCHECK(task_runner_->RunsTasksInCurrentSequence());
+#if DCHECK_IS_ON()
+  DCHECK(initialized_);
+#endif
+
+  IDB_TRACE("IndexedDBBackingStore::GetRecordInParallel");
+  if (!KeyPrefix::ValidIds(database_id, object_store_id)) {
+    task_runner_->PostTask(
+        FROM_HERE, base::BindOnce(std::move(callback), InvalidDBKeyStatus(),
+                                  IndexedDBValue()));
+    return;
   }
 
-  record->bits = slice.as_string();
-  return transaction->GetBlobInfoForRecord(database_id, leveldb_key, record);
+  std::string leveldb_key =
+      ObjectStoreDataKey::Encode(database_id, object_store_id, key);
+  base::PostTaskAndReplyWithResult(
+      FROM_HERE,
+      {base::ThreadPool(), base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+       base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+      base::BindOnce(&ReadFromSnapshot, transaction->GetReadSnapshot(),
+                     leveldb_key),
+      base::BindOnce(&DidReadFromSnapshot, transaction->AsWeakPtr(),
+                     database_id, leveldb_key, std::move(callback)));
 }
 
 int64_t IndexedDBBackingStore::GetInMemoryBlobSize() const {
@@ -1809,6 +1889,16 @@ void IndexedDBBackingStore::DidCommitTransaction() {
   }
 }
 
+scoped_refptr<LevelDBSharedSnapshot>
+IndexedDBBackingStore::Transaction::GetReadSnapshot() {
+  DCHECK(transaction_);
+  if (!read_snapshot_) {
+    read_snapshot_ =
+        base::MakeRefCounted<LevelDBSharedSnapshot>(backing_store_->db_.get());
+  }
+  return read_snapshot_;
+}
+
 Status IndexedDBBackingStore::Transaction::GetBlobInfoForRecord(
     int64_t database_id,
     const std::string& object_store_data_key,
@@ -3177,6 +3267,7 @@ leveldb::Status IndexedDBBackingStore::Transaction::WriteNewBlobs(
 void IndexedDBBackingStore::Transaction::Reset() {
   backing_store_ = nullptr;
   transaction_ = nullptr;
+  read_snapshot_ = nullptr;
 }
 
 leveldb::Status IndexedDBBackingStore::Transaction::Rollback() {
@@ -53,6 +53,7 @@ class FileWriterDelegate;
 namespace content {
 class IndexedDBFactory;
 struct IndexedDBValue;
+class LevelDBSharedSnapshot;
 class TransactionalLevelDBDatabase;
 class TransactionalLevelDBIterator;
 class TransactionalLevelDBTransaction;
@@ -113,6 +114,9 @@ class CONTENT_EXPORT IndexedDBBackingStore {
   using BlobWriteCallback = base::OnceCallback<leveldb::Status(
       IndexedDBBackingStore::BlobWriteResult)>;
 
+  using GetRecordCallback =
+      base::OnceCallback<void(leveldb::Status, IndexedDBValue)>;
+
   class BlobChangeRecord {
    public:
     BlobChangeRecord(const std::string& key, int64_t object_store_id);
@@ -182,6 +186,14 @@ class CONTENT_EXPORT IndexedDBBackingStore {
         const std::string& object_store_data_key,
         IndexedDBValue* value);
 
+    // Returns a snapshot of the database, which reads on other sequences can
+    // share. It is taken on the first call, and kept until Reset().
+    scoped_refptr<LevelDBSharedSnapshot> GetReadSnapshot();
+
+    base::WeakPtr<Transaction> AsWeakPtr() {
+      return ptr_factory_.GetWeakPtr();
+    }
+
     // This holds a BlobEntryKey and the encoded IndexedDBBlobInfo vector stored
     // under that key.
     typedef std::vector<std::pair<BlobEntryKey, std::string> >
@@ -279,6 +291,7 @@ class CONTENT_EXPORT IndexedDBBackingStore {
     IndexedDBBackingStore* backing_store_;
     indexed_db::LevelDBFactory* const leveldb_factory_;
     scoped_refptr<TransactionalLevelDBTransaction> transaction_;
+    scoped_refptr<LevelDBSharedSnapshot> read_snapshot_;
     std::map<std::string, std::unique_ptr<BlobChangeRecord>> blob_change_map_;
     std::map<std::string, std::unique_ptr<BlobChangeRecord>>
         incognito_blob_map_;
@@ -449,6 +462,17 @@ class CONTENT_EXPORT IndexedDBBackingStore {
       int64_t object_store_id,
       const blink::IndexedDBKey& key,
       IndexedDBValue* record) WARN_UNUSED_RESULT;
+  // Like GetRecord(), but reads the record from |transaction|'s snapshot on
+  // the thread pool, so that reads don't wait for each other or for this
+  // sequence. Only for readonly transactions, whose scope can't be written
+  // while they run. |callback| is run on this sequence, unless |transaction|
+  // is reset or destroyed first.
+  virtual void GetRecordInParallel(
+      IndexedDBBackingStore::Transaction* transaction,
+      int64_t database_id,
+      int64_t object_store_id,
+      const blink::IndexedDBKey& key,
+      GetRecordCallback callback);
   virtual leveldb::Status PutRecord(
       IndexedDBBackingStore::Transaction* transaction,
       int64_t database_id,
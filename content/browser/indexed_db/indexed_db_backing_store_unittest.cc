@@ -508,6 +508,73 @@ TEST_F(IndexedDBBackingStoreTest, PutGetConsistency) {
   CycleIDBTaskRunner();
 }
 
+TEST_F(IndexedDBBackingStoreTest, GetRecordInParallel) {
+  base::RunLoop loop;
+  std::unique_ptr<IndexedDBBackingStore::Transaction> read_transaction;
+  IndexedDBValue key1_value;
+  IndexedDBValue key2_value("not read", std::vector<IndexedDBBlobInfo>());
+
+  // Commits |value| at |key| in a readwrite transaction.
+  auto put_record = [this](const IndexedDBKey& key, IndexedDBValue value) {
+    IndexedDBBackingStore::Transaction transaction(backing_store(),
+                                                   /*relaxed_durability=*/true);
+    transaction.Begin(CreateDummyLock());
+    IndexedDBBackingStore::RecordIdentifier record;
+    EXPECT_TRUE(
+        backing_store()->PutRecord(&transaction, 1, 1, key, &value, &record)
+            .ok());
+    TestCallback callback_creator;
+    EXPECT_TRUE(
+        transaction.CommitPhaseOne(callback_creator.CreateCallback()).ok());
+    EXPECT_TRUE(transaction.CommitPhaseTwo().ok());
+  };
+
+  idb_context_->TaskRunner()->PostTask(
+      FROM_HERE, base::BindLambdaForTesting([&]() {
+        put_record(key1_, value1_);
+
+        read_transaction = std::make_unique<IndexedDBBackingStore::Transaction>(
+            backing_store(), /*relaxed_durability=*/true);
+        read_transaction->Begin(CreateDummyLock());
+        base::RepeatingClosure read_done = base::BarrierClosure(
+            2, base::BindLambdaForTesting([&]() {
+              TestCallback callback_creator;
+              leveldb::Status s = read_transaction->CommitPhaseOne(
+                  callback_creator.CreateCallback());
+              EXPECT_TRUE(s.ok());
+              EXPECT_TRUE(read_transaction->CommitPhaseTwo().ok());
+              read_transaction.reset();
+              loop.Quit();
+            }));
+        backing_store()->GetRecordInParallel(
+            read_transaction.get(), 1, 1, key2_,
+            base::BindLambdaForTesting(
+                [&](leveldb::Status s, IndexedDBValue value) {
+                  EXPECT_TRUE(s.ok());
+                  key2_value = value;
+                  read_done.Run();
+                }));
+
+        // The reads see the database as of the first one, not this later
+        // write.
+        put_record(key1_, value2_);
+        backing_store()->GetRecordInParallel(
+            read_transaction.get(), 1, 1, key1_,
+            base::BindLambdaForTesting(
+                [&](leveldb::Status s, IndexedDBValue value) {
+                  EXPECT_TRUE(s.ok());
+                  key1_value = value;
+                  read_done.Run();
+                }));
+      }));
+  loop.Run();
+
+  EXPECT_TRUE(key2_value.empty());
+  EXPECT_EQ(value1_.bits, key1_value.bits);
+
+  CycleIDBTaskRunner();
+}
+
 TEST_F(IndexedDBBackingStoreTestWithBlobs, PutGetConsistencyWithBlobs) {
   std::unique_ptr<IndexedDBBackingStore::Transaction> transaction1;
   TestCallback callback_creator1;
@@ -5,12 +5,15 @@
 #include "content/browser/indexed_db/indexed_db_cursor.h"
 
 #include <stddef.h>
+#include <algorithm>
 #include <utility>
 #include <vector>
 
 #include "base/bind.h"
+#include "base/feature_list.h"
 #include "base/logging.h"
 #include "base/task/post_task.h"
+#include "base/timer/elapsed_timer.h"
 #include "content/browser/indexed_db/indexed_db_callback_helpers.h"
 #include "content/browser/indexed_db/indexed_db_callbacks.h"
 #include "content/browser/indexed_db/indexed_db_context_impl.h"
@@ -20,12 +23,28 @@
 #include "content/browser/indexed_db/indexed_db_value.h"
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
+#include "content/public/common/content_features.h"
 #include "third_party/blink/public/platform/modules/indexeddb/web_idb_database_exception.h"
 
 using blink::IndexedDBKey;
 
 namespace content {
 namespace {
+
+// TODO(cmumford): Use IPC::Channel::kMaximumMessageSize
+constexpr size_t kMaxPrefetchSizeEstimate = 10 * 1024 * 1024;
+
+// With kIndexedDBAdaptivePrefetch, a prefetch batch aims at this many bytes,
+// so that medium-sized values are not all copied into one huge message, and
+// at this much read time, so that a slow cursor neither keeps the renderer
+// waiting for its first records nor holds up the other transactions.
+constexpr size_t kAdaptivePrefetchSizeEstimate = 2 * 1024 * 1024;
+constexpr base::TimeDelta kAdaptivePrefetchTime =
+    base::TimeDelta::FromMilliseconds(16);
+
+// Weight of the latest batch in the prefetch averages.
+constexpr double kPrefetchAverageWeight = 0.5;
+
 // This should never be script visible: the cursor should either be closed when
 // it hits the end of the range (and script throws an error before the call
 // could be made), if the transaction has finished (ditto), or if there's an
@@ -272,14 +291,18 @@ leveldb::Status IndexedDBCursor::CursorPrefetchIterationOperation(
   if (!dispatcher_host)
     return s;
 
+  const bool adaptive =
+      base::FeatureList::IsEnabled(features::kIndexedDBAdaptivePrefetch);
+  if (adaptive)
+    number_to_fetch = GetPrefetchCount(number_to_fetch);
+
   std::vector<IndexedDBKey> found_keys;
   std::vector<IndexedDBKey> found_primary_keys;
   std::vector<IndexedDBValue> found_values;
 
   saved_cursor_.reset();
-  // TODO(cmumford): Use IPC::Channel::kMaximumMessageSize
-  const size_t max_size_estimate = 10 * 1024 * 1024;
   size_t size_estimate = 0;
+  base::ElapsedTimer timer;
 
   // TODO(cmumford): Handle this error (crbug.com/363397). Although this will
   //                 properly fail, caller will not know why, and any corruption
@@ -315,20 +338,19 @@ leveldb::Status IndexedDBCursor::CursorPrefetchIterationOperation(
       case indexed_db::CURSOR_KEY_ONLY:
         found_values.push_back(IndexedDBValue());
         break;
-      case indexed_db::CURSOR_KEY_AND_VALUE: {
-        IndexedDBValue value;
-        value.swap(*cursor_->value());
-        size_estimate += value.SizeEstimate();
-        found_values.push_back(value);
+      case indexed_db::CURSOR_KEY_AND_VALUE:
+        // Take the value from the cursor rather than copying it.
+        found_values.emplace_back();
+        found_values.back().swap(*cursor_->value());
+        size_estimate += found_values.back().SizeEstimate();
         break;
-      }
       default:
         NOTREACHED();
     }
     size_estimate += cursor_->key().size_estimate();
     size_estimate += cursor_->primary_key().size_estimate();
 
-    if (size_estimate > max_size_estimate)
+    if (IsPrefetchBatchFull(size_estimate, timer.Elapsed(), adaptive))
       break;
   }
 
@@ -339,6 +361,7 @@ leveldb::Status IndexedDBCursor::CursorPrefetchIterationOperation(
 
   DCHECK_EQ(found_keys.size(), found_primary_keys.size());
   DCHECK_EQ(found_keys.size(), found_values.size());
+  RecordPrefetch(found_keys.size(), size_estimate, timer.Elapsed());
 
   std::vector<blink::mojom::IDBValuePtr> mojo_values;
   mojo_values.reserve(found_values.size());
@@ -366,6 +389,44 @@ leveldb::Status IndexedDBCursor::CursorPrefetchIterationOperation(
   return s;
 }
 
+int IndexedDBCursor::GetPrefetchCount(int number_to_fetch) const {
+  int64_t count = number_to_fetch;
+  if (prefetch_record_size_ > 0) {
+    count = std::min(count, static_cast<int64_t>(kAdaptivePrefetchSizeEstimate /
+                                                 prefetch_record_size_));
+  }
+  if (!prefetch_record_time_.is_zero())
+    count = std::min(count, kAdaptivePrefetchTime / prefetch_record_time_);
+  return static_cast<int>(std::max<int64_t>(count, 1));
+}
+
+// static
+bool IndexedDBCursor::IsPrefetchBatchFull(size_t size_estimate,
+                                          base::TimeDelta time,
+                                          bool adaptive) {
+  if (size_estimate > kMaxPrefetchSizeEstimate)
+    return true;
+  return adaptive && (size_estimate > kAdaptivePrefetchSizeEstimate ||
+                      time > kAdaptivePrefetchTime);
+}
+
+void IndexedDBCursor::RecordPrefetch(size_t count,
+                                     size_t size_estimate,
+                                     base::TimeDelta time) {
+  DCHECK_GT(count, 0u);
+  const double record_size = static_cast<double>(size_estimate) / count;
+  const base::TimeDelta record_time = time / static_cast<int64_t>(count);
+  if (prefetch_record_size_ == 0) {
+    prefetch_record_size_ = record_size;
+    prefetch_record_time_ = record_time;
+    return;
+  }
+  prefetch_record_size_ +=
+      kPrefetchAverageWeight * (record_size - prefetch_record_size_);
+  prefetch_record_time_ +=
+      kPrefetchAverageWeight * (record_time - prefetch_record_time_);
+}
+
 leveldb::Status IndexedDBCursor::PrefetchReset(int used_prefetches,
                                                int /* unused_prefetches */) {
   IDB_TRACE("IndexedDBCursor::PrefetchReset");
@@ -5,6 +5,7 @@
 #ifndef CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_CURSOR_H_
 #define CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_CURSOR_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <memory>
@@ -13,6 +14,7 @@
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "content/browser/indexed_db/indexed_db_backing_store.h"
 #include "content/browser/indexed_db/indexed_db_database.h"
 #include "content/browser/indexed_db/indexed_db_transaction.h"
@@ -75,6 +77,19 @@ class CONTENT_EXPORT IndexedDBCursor {
       IndexedDBTransaction* transaction);
 
  private:
+  friend class IndexedDBCursorTest;
+
+  // Returns how many of the |number_to_fetch| records the renderer asked for
+  // to prefetch, going by the records prefetched before.
+  int GetPrefetchCount(int number_to_fetch) const;
+  // Whether a prefetch batch of |size_estimate| bytes, read in |time|, must
+  // end before reaching the count it asked for.
+  static bool IsPrefetchBatchFull(size_t size_estimate,
+                                  base::TimeDelta time,
+                                  bool adaptive);
+  // Folds a prefetched batch into the averages GetPrefetchCount() uses.
+  void RecordPrefetch(size_t count, size_t size_estimate, base::TimeDelta time);
+
   blink::mojom::IDBTaskType task_type_;
   indexed_db::CursorType cursor_type_;
 
@@ -90,6 +105,10 @@ class CONTENT_EXPORT IndexedDBCursor {
 
   bool closed_;
 
+  // Running averages of the size and read time of the prefetched records.
+  double prefetch_record_size_ = 0;
+  base::TimeDelta prefetch_record_time_;
+
   base::WeakPtrFactory<IndexedDBCursor> ptr_factory_{this};
 
   DISALLOW_COPY_AND_ASSIGN(IndexedDBCursor);
@@ -0,0 +1,107 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/indexed_db/indexed_db_cursor.h"
+
+#include <stddef.h>
+
+#include <memory>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+namespace {
+constexpr size_t kAdaptiveSize = 2 * 1024 * 1024;
+constexpr size_t kMaxSize = 10 * 1024 * 1024;
+constexpr base::TimeDelta kAdaptiveTime = base::TimeDelta::FromMilliseconds(16);
+}  // namespace
+
+class IndexedDBCursorTest : public testing::Test {
+ public:
+  IndexedDBCursorTest()
+      : cursor_(nullptr,
+                indexed_db::CURSOR_KEY_AND_VALUE,
+                blink::mojom::IDBTaskType::Normal,
+                nullptr) {}
+
+ protected:
+  int GetPrefetchCount(int number_to_fetch) const {
+    return cursor_.GetPrefetchCount(number_to_fetch);
+  }
+  void RecordPrefetch(size_t count,
+                      size_t size_estimate,
+                      base::TimeDelta time) {
+    cursor_.RecordPrefetch(count, size_estimate, time);
+  }
+  static bool IsPrefetchBatchFull(size_t size_estimate,
+                                  base::TimeDelta time,
+                                  bool adaptive) {
+    return IndexedDBCursor::IsPrefetchBatchFull(size_estimate, time, adaptive);
+  }
+
+ private:
+  IndexedDBCursor cursor_;
+
+  DISALLOW_COPY_AND_ASSIGN(IndexedDBCursorTest);
+};
+
+TEST_F(IndexedDBCursorTest, PrefetchCountWithoutHistory) {
+  EXPECT_EQ(100, GetPrefetchCount(100));
+  EXPECT_EQ(1, GetPrefetchCount(1));
+}
+
+TEST_F(IndexedDBCursorTest, PrefetchCountCappedBySize) {
+  // 10 KB records, read instantly.
+  RecordPrefetch(100, 100 * 10240, base::TimeDelta());
+  EXPECT_EQ(static_cast<int>(kAdaptiveSize / 10240), GetPrefetchCount(1000));
+  EXPECT_EQ(100, GetPrefetchCount(100));
+}
+
+TEST_F(IndexedDBCursorTest, PrefetchCountCappedByTime) {
+  // Tiny records, read in 200 microseconds each.
+  RecordPrefetch(10, 10, base::TimeDelta::FromMilliseconds(2));
+  EXPECT_EQ(kAdaptiveTime / base::TimeDelta::FromMicroseconds(200),
+            GetPrefetchCount(1000));
+  EXPECT_EQ(20, GetPrefetchCount(20));
+}
+
+TEST_F(IndexedDBCursorTest, PrefetchCountIsAtLeastOne) {
+  // A single record is over both limits.
+  RecordPrefetch(1, 2 * kAdaptiveSize, 2 * kAdaptiveTime);
+  EXPECT_EQ(1, GetPrefetchCount(100));
+}
+
+TEST_F(IndexedDBCursorTest, PrefetchAveragesBatches) {
+  RecordPrefetch(1, 1000, base::TimeDelta::FromMilliseconds(1));
+  // The latest batch weighs half.
+  RecordPrefetch(2, 6000, base::TimeDelta::FromMilliseconds(6));
+  // Records now average 2000 bytes and 2 ms.
+  EXPECT_EQ(8, GetPrefetchCount(1000));
+
+  // Lots of fast records bring the time down, and the size takes over.
+  for (int i = 0; i < 20; ++i)
+    RecordPrefetch(100, 100 * 2000, base::TimeDelta());
+  EXPECT_EQ(static_cast<int>(kAdaptiveSize / 2000), GetPrefetchCount(100000));
+}
+
+TEST_F(IndexedDBCursorTest, PrefetchBatchFull) {
+  // Without adaptive prefetch, only the message size limit ends a batch.
+  EXPECT_FALSE(IsPrefetchBatchFull(kAdaptiveSize + 1, 2 * kAdaptiveTime,
+                                   /*adaptive=*/false));
+  EXPECT_TRUE(
+      IsPrefetchBatchFull(kMaxSize + 1, base::TimeDelta(), /*adaptive=*/false));
+
+  EXPECT_FALSE(IsPrefetchBatchFull(kAdaptiveSize, kAdaptiveTime,
+                                   /*adaptive=*/true));
+  EXPECT_TRUE(IsPrefetchBatchFull(kAdaptiveSize + 1, base::TimeDelta(),
+                                  /*adaptive=*/true));
+  EXPECT_TRUE(IsPrefetchBatchFull(
+      1, kAdaptiveTime + base::TimeDelta::FromMicroseconds(1),
+      /*adaptive=*/true));
+}
+
+}  // namespace content
@@ -12,6 +12,7 @@
 
 #include "base/auto_reset.h"
 #include "base/bind.h"
+#include "base/feature_list.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/scoped_refptr.h"
@@ -46,6 +47,7 @@
 #include "content/browser/indexed_db/scopes/scope_lock.h"
 #include "content/browser/indexed_db/scopes/scopes_lock_manager.h"
 #include "content/browser/indexed_db/transaction_impl.h"
+#include "content/public/common/content_features.h"
 #include "content/public/common/content_switches.h"
 #include "ipc/ipc_channel.h"
 #include "storage/browser/blob/blob_data_handle.h"
@@ -768,6 +770,18 @@ void IndexedDBDatabase::RenameIndexAbortOperation(int64_t object_store_id,
   object_store.indexes[index_id].name = std::move(old_name);
 }
 
+// static
+bool IndexedDBDatabase::ReadsRecordInParallel(
+    const IndexedDBTransaction* transaction,
+    int64_t index_id,
+    const IndexedDBKeyRange& key_range) {
+  return transaction->mode() == blink::mojom::IDBTransactionMode::ReadOnly &&
+         index_id == IndexedDBIndexMetadata::kInvalidId &&
+         key_range.IsOnlyKey() &&
+         base::FeatureList::IsEnabled(
+             features::kIndexedDBParallelReadOnlyReads);
+}
+
 Status IndexedDBDatabase::GetOperation(
     base::WeakPtr<IndexedDBDispatcherHost> dispatcher_host,
     int64_t object_store_id,
@@ -796,6 +810,25 @@ Status IndexedDBDatabase::GetOperation(
   const IndexedDBKey* key;
 
   Status s = Status::OK();
+
+  // Readonly transactions read records from a snapshot on the thread pool,
+  // so that they don't wait for this sequence. Up to
+  // IndexedDBTransaction::kMaxOverlappingReads reads of a transaction are in
+  // flight at once. Their results, and the later requests of the
+  // transaction, wait for the reads started before them, to keep their order.
+  // SendGetResultOperation() reports a missing |dispatcher_host| in order too.
+  if (ReadsRecordInParallel(transaction, index_id, *key_range)) {
+    const int64_t event_id = transaction->AddOrderedPreemptiveEvent();
+    backing_store_->GetRecordInParallel(
+        transaction->BackingStoreTransaction(), id(), object_store_id,
+        key_range->lower(),
+        base::BindOnce(&IndexedDBDatabase::DidGetRecordInParallel,
+                       AsWeakPtr(), transaction->AsWeakPtr(), event_id,
+                       std::move(dispatcher_host), object_store_id,
+                       key_range->lower(), cursor_type, std::move(callback)));
+    return s;
+  }
+
   if (!dispatcher_host) {
     IndexedDBDatabaseError error =
         CreateError(blink::kWebIDBDatabaseExceptionUnknownError,
@@ -854,58 +887,12 @@ Status IndexedDBDatabase::GetOperation(
 
   if (index_id == IndexedDBIndexMetadata::kInvalidId) {
     // Object Store Retrieval Operation
-    IndexedDBReturnValue value;
+    IndexedDBValue value;
     s = backing_store_->GetRecord(transaction->BackingStoreTransaction(), id(),
                                   object_store_id, *key, &value);
-    if (!s.ok()) {
-      IndexedDBDatabaseError error =
-          CreateError(blink::kWebIDBDatabaseExceptionUnknownError,
-                      "Unknown error", transaction);
-      std::move(callback).Run(
-          blink::mojom::IDBDatabaseGetResult::NewErrorResult(
-              blink::mojom::IDBError::New(error.code(), error.message())));
-      return s;
-    }
-
-    if (value.empty()) {
-      std::move(callback).Run(
-          blink::mojom::IDBDatabaseGetResult::NewEmpty(true));
-      return s;
-    }
-
-    if (cursor_type == indexed_db::CURSOR_KEY_ONLY) {
-      std::move(callback).Run(
-          blink::mojom::IDBDatabaseGetResult::NewKey(std::move(*key)));
-      return s;
-    }
-
-    if (object_store_metadata.auto_increment &&
-        !object_store_metadata.key_path.IsNull()) {
-      value.primary_key = *key;
-      value.key_path = object_store_metadata.key_path;
-    }
-
-    blink::mojom::IDBReturnValuePtr mojo_value =
-        IndexedDBReturnValue::ConvertReturnValue(&value);
-
-    std::vector<IndexedDBCallbacks::IndexedDBValueBlob> value_blob;
-    IndexedDBCallbacks::IndexedDBValueBlob::GetIndexedDBValueBlobs(
-        &value_blob, value.blob_info, &mojo_value->value->blob_or_file_info);
-
-    if (!IndexedDBCallbacks::CreateAllBlobs(
-            dispatcher_host->blob_storage_context(), std::move(value_blob))) {
-      IndexedDBDatabaseError error =
-          CreateError(blink::kWebIDBDatabaseExceptionUnknownError,
-                      "Unknown error", transaction);
-      std::move(callback).Run(
-          blink::mojom::IDBDatabaseGetResult::NewErrorResult(
-              blink::mojom::IDBError::New(error.code(), error.message())));
-      return s;
-    }
-
-    std::move(callback).Run(
-        blink::mojom::IDBDatabaseGetResult::NewValue(std::move(mojo_value)));
-    return s;
+    return SendGetResultOperation(std::move(dispatcher_host), object_store_id,
+                                  *key, cursor_type, std::move(callback), s,
+                                  std::move(value), transaction);
   }
 
   // From here we are dealing only with indexes.
@@ -978,6 +965,102 @@ Status IndexedDBDatabase::GetOperation(
   return s;
 }
 
+Status IndexedDBDatabase::SendGetResultOperation(
+    base::WeakPtr<IndexedDBDispatcherHost> dispatcher_host,
+    int64_t object_store_id,
+    const IndexedDBKey& key,
+    indexed_db::CursorType cursor_type,
+    blink::mojom::IDBDatabase::GetCallback callback,
+    Status read_status,
+    IndexedDBValue record,
+    IndexedDBTransaction* transaction) {
+  IDB_TRACE1("IndexedDBDatabase::SendGetResultOperation", "txn.id",
+             transaction->id());
+
+  if (!read_status.ok()) {
+    IndexedDBDatabaseError error =
+        CreateError(blink::kWebIDBDatabaseExceptionUnknownError,
+                    "Unknown error", transaction);
+    std::move(callback).Run(blink::mojom::IDBDatabaseGetResult::NewErrorResult(
+        blink::mojom::IDBError::New(error.code(), error.message())));
+    return read_status;
+  }
+
+  if (record.empty()) {
+    std::move(callback).Run(blink::mojom::IDBDatabaseGetResult::NewEmpty(true));
+    return read_status;
+  }
+
+  if (cursor_type == indexed_db::CURSOR_KEY_ONLY) {
+    std::move(callback).Run(blink::mojom::IDBDatabaseGetResult::NewKey(key));
+    return read_status;
+  }
+
+  if (!dispatcher_host ||
+      !IsObjectStoreIdAndMaybeIndexIdInMetadata(
+          object_store_id, IndexedDBIndexMetadata::kInvalidId)) {
+    IndexedDBDatabaseError error =
+        CreateError(blink::kWebIDBDatabaseExceptionUnknownError,
+                    "Unknown error", transaction);
+    std::move(callback).Run(blink::mojom::IDBDatabaseGetResult::NewErrorResult(
+        blink::mojom::IDBError::New(error.code(), error.message())));
+    return read_status;
+  }
+
+  IndexedDBReturnValue value;
+  value.swap(record);
+  const IndexedDBObjectStoreMetadata& object_store_metadata =
+      metadata_.object_stores[object_store_id];
+  if (object_store_metadata.auto_increment &&
+      !object_store_metadata.key_path.IsNull()) {
+    value.primary_key = key;
+    value.key_path = object_store_metadata.key_path;
+  }
+
+  blink::mojom::IDBReturnValuePtr mojo_value =
+      IndexedDBReturnValue::ConvertReturnValue(&value);
+
+  std::vector<IndexedDBCallbacks::IndexedDBValueBlob> value_blob;
+  IndexedDBCallbacks::IndexedDBValueBlob::GetIndexedDBValueBlobs(
+      &value_blob, value.blob_info, &mojo_value->value->blob_or_file_info);
+
+  if (!IndexedDBCallbacks::CreateAllBlobs(
+          dispatcher_host->blob_storage_context(), std::move(value_blob))) {
+    IndexedDBDatabaseError error =
+        CreateError(blink::kWebIDBDatabaseExceptionUnknownError,
+                    "Unknown error", transaction);
+    std::move(callback).Run(blink::mojom::IDBDatabaseGetResult::NewErrorResult(
+        blink::mojom::IDBError::New(error.code(), error.message())));
+    return read_status;
+  }
+
+  std::move(callback).Run(
+      blink::mojom::IDBDatabaseGetResult::NewValue(std::move(mojo_value)));
+  return read_status;
+}
+
+void IndexedDBDatabase::DidGetRecordInParallel(
+    base::WeakPtr<IndexedDBTransaction> transaction,
+    int64_t event_id,
+    base::WeakPtr<IndexedDBDispatcherHost> dispatcher_host,
+    int64_t object_store_id,
+    const IndexedDBKey& key,
+    indexed_db::CursorType cursor_type,
+    blink::mojom::IDBDatabase::GetCallback callback,
+    Status read_status,
+    IndexedDBValue record) {
+  // An aborted transaction drops its pending events, and its callbacks report
+  // the abort.
+  if (!transaction || transaction->state() == IndexedDBTransaction::FINISHED)
+    return;
+  transaction->DidCompleteOrderedPreemptiveEvent(
+      event_id,
+      BindWeakOperation(&IndexedDBDatabase::SendGetResultOperation,
+                        AsWeakPtr(), std::move(dispatcher_host),
+                        object_store_id, key, cursor_type, std::move(callback),
+                        read_status, std::move(record)));
+}
+
 static_assert(sizeof(size_t) >= sizeof(int32_t),
               "Size of size_t is less than size of int32");
 static_assert(blink::mojom::kIDBMaxMessageOverhead <= INT32_MAX,
@@ -211,6 +211,13 @@ class CONTENT_EXPORT IndexedDBDatabase {
                                  int64_t index_id,
                                  base::string16 old_name);
 
+  // Whether GetOperation() reads the record of a Get request from a snapshot
+  // on the thread pool. Such requests are scheduled with
+  // IndexedDBTransaction::ScheduleOverlappingReadTask().
+  static bool ReadsRecordInParallel(const IndexedDBTransaction* transaction,
+                                    int64_t index_id,
+                                    const blink::IndexedDBKeyRange& key_range);
+
   leveldb::Status GetOperation(
       base::WeakPtr<IndexedDBDispatcherHost> dispatcher_host,
       int64_t object_store_id,
@@ -220,6 +227,19 @@ class CONTENT_EXPORT IndexedDBDatabase {
       blink::mojom::IDBDatabase::GetCallback callback,
       IndexedDBTransaction* transaction);
 
+  // Sends the result of a Get request on an object store, once the record at
+  // |key| was read. GetOperation() runs it directly, or schedules it when the
+  // record was read on the thread pool.
+  leveldb::Status SendGetResultOperation(
+      base::WeakPtr<IndexedDBDispatcherHost> dispatcher_host,
+      int64_t object_store_id,
+      const blink::IndexedDBKey& key,
+      indexed_db::CursorType cursor_type,
+      blink::mojom::IDBDatabase::GetCallback callback,
+      leveldb::Status read_status,
+      IndexedDBValue record,
+      IndexedDBTransaction* transaction);
+
   leveldb::Status GetAllOperation(
       base::WeakPtr<IndexedDBDispatcherHost> dispatcher_host,
       int64_t object_store_id,
@@ -376,6 +396,19 @@ class CONTENT_EXPORT IndexedDBDatabase {
 
   bool CanBeDestroyed();
 
+  // Called with a record that GetOperation() read on the thread pool for
+  // |transaction|, as its ordered event |event_id|.
+  void DidGetRecordInParallel(
+      base::WeakPtr<IndexedDBTransaction> transaction,
+      int64_t event_id,
+      base::WeakPtr<IndexedDBDispatcherHost> dispatcher_host,
+      int64_t object_store_id,
+      const blink::IndexedDBKey& key,
+      indexed_db::CursorType cursor_type,
+      blink::mojom::IDBDatabase::GetCallback callback,
+      leveldb::Status read_status,
+      IndexedDBValue record);
+
   // Safe because the IndexedDBBackingStore is owned by the same object which
   // owns us, the IndexedDBPerOriginFactory.
   IndexedDBBackingStore* backing_store_;
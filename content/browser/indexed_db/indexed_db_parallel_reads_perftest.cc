@@ -0,0 +1,290 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the Get requests of readonly transactions reading their records on
+// the backing store's sequence (IndexedDBBackingStore::GetRecord()) with
+// reading them from a snapshot on the thread pool (GetRecordInParallel()),
+// while a readwrite transaction commits on the sequence. On the sequence, each
+// request is one task. On the thread pool, a transaction keeps up to
+// IndexedDBTransaction::kMaxOverlappingReads requests in flight, as
+// GetOperation() does.
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "base/barrier_closure.h"
+#include "base/bind.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/test/bind_test_util.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "base/time/default_clock.h"
+#include "base/timer/elapsed_timer.h"
+#include "content/browser/indexed_db/indexed_db_backing_store.h"
+#include "content/browser/indexed_db/indexed_db_context_impl.h"
+#include "content/browser/indexed_db/indexed_db_factory_impl.h"
+#include "content/browser/indexed_db/indexed_db_leveldb_coding.h"
+#include "content/browser/indexed_db/indexed_db_origin_state.h"
+#include "content/browser/indexed_db/indexed_db_origin_state_handle.h"
+#include "content/browser/indexed_db/indexed_db_transaction.h"
+#include "content/browser/indexed_db/indexed_db_value.h"
+#include "content/browser/indexed_db/leveldb/transactional_leveldb_database.h"
+#include "content/browser/indexed_db/scopes/disjoint_range_lock_manager.h"
+#include "content/public/test/browser_task_environment.h"
+#include "storage/browser/test/mock_quota_manager_proxy.h"
+#include "storage/browser/test/mock_special_storage_policy.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+#include "third_party/blink/public/common/indexeddb/indexeddb_key.h"
+#include "url/gurl.h"
+#include "url/origin.h"
+
+using blink::IndexedDBKey;
+
+namespace content {
+namespace {
+
+constexpr int64_t kDatabaseId = 1;
+// Object store 1 is written, and the others are read.
+constexpr int64_t kWrittenObjectStoreId = 1;
+constexpr int64_t kObjectStoreCount = 4;
+constexpr int kRecordsPerObjectStore = 5000;
+constexpr int kRounds = 20;
+constexpr int kWritesPerRound = 200;
+constexpr int kReadsPerTransaction = 500;
+constexpr size_t kValueSize = 1024;
+
+IndexedDBKey RecordKey(int record) {
+  return IndexedDBKey(record, blink::mojom::IDBKeyType::Number);
+}
+
+IndexedDBBackingStore::BlobWriteCallback CreateBlobWriteCallback() {
+  return base::BindOnce([](IndexedDBBackingStore::BlobWriteResult result) {
+    EXPECT_NE(IndexedDBBackingStore::BlobWriteResult::kFailure, result);
+    return leveldb::Status::OK();
+  });
+}
+
+// A readonly transaction and the requests it has left.
+struct ReadTransaction {
+  std::unique_ptr<IndexedDBBackingStore::Transaction> transaction;
+  int64_t object_store_id = 0;
+  int round = 0;
+  int next_read = 0;
+  int reads_in_flight = 0;
+  base::OnceClosure done;
+};
+
+class IndexedDBParallelReadsPerfTest : public testing::Test {
+ public:
+  IndexedDBParallelReadsPerfTest()
+      : special_storage_policy_(
+            base::MakeRefCounted<MockSpecialStoragePolicy>()),
+        quota_manager_proxy_(
+            base::MakeRefCounted<MockQuotaManagerProxy>(nullptr, nullptr)) {}
+
+  void SetUp() override {
+    special_storage_policy_->SetAllUnlimited(true);
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    idb_context_ = base::MakeRefCounted<IndexedDBContextImpl>(
+        temp_dir_.GetPath(), special_storage_policy_, quota_manager_proxy_,
+        base::DefaultClock::GetInstance(),
+        base::SequencedTaskRunnerHandle::Get());
+
+    leveldb::Status s;
+    std::tie(origin_state_handle_, s, std::ignore, std::ignore, std::ignore) =
+        idb_context_->GetIDBFactory()->GetOrOpenOriginFactory(
+            origin_, idb_context_->data_path(), /*create_if_missing=*/true);
+    ASSERT_TRUE(origin_state_handle_.IsHeld());
+    backing_store_ = origin_state_handle_.origin_state()->backing_store();
+    lock_manager_ = origin_state_handle_.origin_state()->lock_manager();
+
+    for (int64_t store = 1; store <= kObjectStoreCount; ++store) {
+      IndexedDBBackingStore::Transaction transaction(
+          backing_store_, /*relaxed_durability=*/true);
+      transaction.Begin(AcquireLock(
+          store, ScopesLockManager::LockType::kExclusive));
+      for (int record = 0; record < kRecordsPerObjectStore; ++record)
+        PutRecord(&transaction, store, record, 'v');
+      Commit(&transaction);
+    }
+  }
+
+  void TearDown() override {
+    backing_store_ = nullptr;
+    lock_manager_ = nullptr;
+    origin_state_handle_.Release();
+    quota_manager_proxy_->SimulateQuotaManagerDestroyed();
+
+    IndexedDBOriginState* origin_state =
+        idb_context_->GetIDBFactory()->GetOriginFactory(origin_);
+    if (origin_state) {
+      base::RunLoop loop;
+      origin_state->backing_store()->db()->leveldb_state()->RequestDestruction(
+          loop.QuitClosure(), base::SequencedTaskRunnerHandle::Get());
+      idb_context_->ForceClose(
+          origin_, IndexedDBContextImpl::FORCE_CLOSE_DELETE_ORIGIN);
+      loop.Run();
+    }
+    idb_context_.reset();
+    base::RunLoop().RunUntilIdle();
+  }
+
+ protected:
+  std::vector<ScopeLock> AcquireLock(int64_t object_store_id,
+                                     ScopesLockManager::LockType type) {
+    base::RunLoop loop;
+    ScopesLocksHolder locks_receiver;
+    EXPECT_TRUE(lock_manager_->AcquireLocks(
+        {{kObjectStoreRangeLockLevel,
+          GetObjectStoreLockRange(kDatabaseId, object_store_id), type}},
+        locks_receiver.AsWeakPtr(),
+        base::BindLambdaForTesting([&loop]() { loop.Quit(); })));
+    loop.Run();
+    return std::move(locks_receiver.locks);
+  }
+
+  void PutRecord(IndexedDBBackingStore::Transaction* transaction,
+                 int64_t object_store_id,
+                 int record,
+                 char fill) {
+    IndexedDBValue value(std::string(kValueSize, fill),
+                         std::vector<IndexedDBBlobInfo>());
+    IndexedDBBackingStore::RecordIdentifier record_identifier;
+    ASSERT_TRUE(backing_store_
+                    ->PutRecord(transaction, kDatabaseId, object_store_id,
+                                RecordKey(record), &value, &record_identifier)
+                    .ok());
+  }
+
+  static void Commit(IndexedDBBackingStore::Transaction* transaction) {
+    ASSERT_TRUE(transaction->CommitPhaseOne(CreateBlobWriteCallback()).ok());
+    ASSERT_TRUE(transaction->CommitPhaseTwo().ok());
+  }
+
+  // Commits a readwrite transaction that overwrites records of the written
+  // object store.
+  void RunWriteTransaction(int round) {
+    IndexedDBBackingStore::Transaction transaction(backing_store_,
+                                                   /*relaxed_durability=*/true);
+    transaction.Begin(AcquireLock(kWrittenObjectStoreId,
+                                  ScopesLockManager::LockType::kExclusive));
+    for (int i = 0; i < kWritesPerRound; ++i) {
+      PutRecord(&transaction, kWrittenObjectStoreId,
+                (round * kWritesPerRound + i) % kRecordsPerObjectStore,
+                'a' + round % 26);
+    }
+    Commit(&transaction);
+  }
+
+  // Sends the next requests of |read|, or commits it once all of them are
+  // done.
+  void ReadNextRecords(ReadTransaction* read) {
+    if (read->next_read == kReadsPerTransaction) {
+      if (read->reads_in_flight == 0) {
+        Commit(read->transaction.get());
+        std::move(read->done).Run();
+      }
+      return;
+    }
+
+    const int max_reads_in_flight =
+        parallel_reads_
+            ? static_cast<int>(IndexedDBTransaction::kMaxOverlappingReads)
+            : 1;
+    while (read->next_read < kReadsPerTransaction &&
+           read->reads_in_flight < max_reads_in_flight) {
+      ++read->reads_in_flight;
+      const IndexedDBKey key =
+          RecordKey((read->round * 7919 + read->next_read * 104729) %
+                    kRecordsPerObjectStore);
+      ++read->next_read;
+
+      if (parallel_reads_) {
+        backing_store_->GetRecordInParallel(
+            read->transaction.get(), kDatabaseId, read->object_store_id, key,
+            base::BindOnce(&IndexedDBParallelReadsPerfTest::DidReadRecord,
+                           base::Unretained(this), read));
+        continue;
+      }
+      base::SequencedTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE,
+          base::BindOnce(
+              [](IndexedDBParallelReadsPerfTest* test, ReadTransaction* read,
+                 IndexedDBKey key) {
+                IndexedDBValue value;
+                leveldb::Status s = test->backing_store_->GetRecord(
+                    read->transaction.get(), kDatabaseId,
+                    read->object_store_id, key, &value);
+                test->DidReadRecord(read, s, std::move(value));
+              },
+              base::Unretained(this), read, key));
+    }
+  }
+
+  void DidReadRecord(ReadTransaction* read,
+                     leveldb::Status s,
+                     IndexedDBValue value) {
+    EXPECT_TRUE(s.ok());
+    EXPECT_FALSE(value.empty());
+    --read->reads_in_flight;
+    ReadNextRecords(read);
+  }
+
+  // Runs |kRounds| rounds of one readwrite transaction and one readonly
+  // transaction per other object store, and returns how long they took.
+  base::TimeDelta RunWorkload(bool parallel_reads) {
+    parallel_reads_ = parallel_reads;
+    base::ElapsedTimer timer;
+    for (int round = 0; round < kRounds; ++round) {
+      base::RunLoop reads_loop;
+      base::RepeatingClosure read_done =
+          base::BarrierClosure(kObjectStoreCount - 1, reads_loop.QuitClosure());
+      std::vector<std::unique_ptr<ReadTransaction>> reads;
+      for (int64_t store = 1; store <= kObjectStoreCount; ++store) {
+        if (store == kWrittenObjectStoreId)
+          continue;
+        auto read = std::make_unique<ReadTransaction>();
+        read->transaction = std::make_unique<IndexedDBBackingStore::Transaction>(
+            backing_store_, /*relaxed_durability=*/true);
+        read->transaction->Begin(
+            AcquireLock(store, ScopesLockManager::LockType::kShared));
+        read->object_store_id = store;
+        read->round = round;
+        read->done = read_done;
+        reads.push_back(std::move(read));
+        ReadNextRecords(reads.back().get());
+      }
+      RunWriteTransaction(round);
+      reads_loop.Run();
+    }
+    return timer.Elapsed();
+  }
+
+  BrowserTaskEnvironment task_environment_;
+  base::ScopedTempDir temp_dir_;
+  scoped_refptr<MockSpecialStoragePolicy> special_storage_policy_;
+  scoped_refptr<MockQuotaManagerProxy> quota_manager_proxy_;
+  scoped_refptr<IndexedDBContextImpl> idb_context_;
+  const url::Origin origin_ = url::Origin::Create(GURL("http://localhost:81"));
+  IndexedDBOriginStateHandle origin_state_handle_;
+  IndexedDBBackingStore* backing_store_ = nullptr;
+  DisjointRangeLockManager* lock_manager_ = nullptr;
+  bool parallel_reads_ = false;
+};
+
+TEST_F(IndexedDBParallelReadsPerfTest, MixedReadWrite) {
+  const base::TimeDelta serial = RunWorkload(/*parallel_reads=*/false);
+  const base::TimeDelta parallel = RunWorkload(/*parallel_reads=*/true);
+  perf_test::PrintResult("IndexedDBParallelReads", "", "serial_reads",
+                         serial.InMillisecondsF(), "ms", true);
+  perf_test::PrintResult("IndexedDBParallelReads", "", "parallel_reads",
+                         parallel.InMillisecondsF(), "ms", true);
+}
+
+}  // namespace
+}  // namespace content
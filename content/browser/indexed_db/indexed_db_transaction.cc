@@ -65,6 +65,9 @@ UmaIDBException ExceptionCodeToUmaEnum(uint16_t code) {
 
 }  // namespace
 
+// static
+constexpr size_t IndexedDBTransaction::kMaxOverlappingReads;
+
 IndexedDBTransaction::TaskQueue::TaskQueue() = default;
 IndexedDBTransaction::TaskQueue::~TaskQueue() = default;
 
@@ -75,7 +78,7 @@ void IndexedDBTransaction::TaskQueue::clear() {
 
 IndexedDBTransaction::Operation IndexedDBTransaction::TaskQueue::pop() {
   DCHECK(!queue_.empty());
-  Operation task = std::move(queue_.front());
+  Operation task = std::move(queue_.front().first);
   queue_.pop();
   return task;
 }
@@ -155,6 +158,42 @@ void IndexedDBTransaction::ScheduleTask(blink::mojom::IDBTaskType type,
     run_tasks_callback_.Run();
 }
 
+void IndexedDBTransaction::ScheduleOverlappingReadTask(Operation task) {
+  if (state_ == FINISHED)
+    return;
+
+  timeout_timer_.Stop();
+  used_ = true;
+  task_queue_.push(std::move(task), /*overlaps_reads=*/true);
+  ++diagnostics_.tasks_scheduled;
+  if (state() == STARTED)
+    run_tasks_callback_.Run();
+}
+
+int64_t IndexedDBTransaction::AddOrderedPreemptiveEvent() {
+  AddPreemptiveEvent();
+  ordered_event_tasks_.emplace_back();
+  return first_ordered_event_id_ + ordered_event_tasks_.size() - 1;
+}
+
+void IndexedDBTransaction::DidCompleteOrderedPreemptiveEvent(int64_t event_id,
+                                                             Operation task) {
+  if (state_ == FINISHED)
+    return;
+  DCHECK_GE(event_id, first_ordered_event_id_);
+  const size_t index = event_id - first_ordered_event_id_;
+  DCHECK_LT(index, ordered_event_tasks_.size());
+  DCHECK(!ordered_event_tasks_[index]);
+  ordered_event_tasks_[index] = std::move(task);
+  while (!ordered_event_tasks_.empty() && ordered_event_tasks_.front()) {
+    Operation ready = std::move(ordered_event_tasks_.front());
+    ordered_event_tasks_.pop_front();
+    ++first_ordered_event_id_;
+    DidCompletePreemptiveEvent();
+    ScheduleTask(blink::mojom::IDBTaskType::Preemptive, std::move(ready));
+  }
+}
+
 void IndexedDBTransaction::ScheduleAbortTask(AbortOperation abort_task) {
   DCHECK_NE(FINISHED, state_);
   DCHECK(used_);
@@ -187,6 +226,8 @@ leveldb::Status IndexedDBTransaction::Abort(
 
   preemptive_task_queue_.clear();
   pending_preemptive_events_ = 0;
+  first_ordered_event_id_ += ordered_event_tasks_.size();
+  ordered_event_tasks_.clear();
 
   // Backing store resources (held via cursors) must be released
   // before script callbacks are fired, as the script callbacks may
@@ -234,6 +275,21 @@ bool IndexedDBTransaction::HasPendingTasks() const {
   return pending_preemptive_events_ || !IsTaskQueueEmpty();
 }
 
+bool IndexedDBTransaction::ShouldRunPreemptiveQueue() const {
+  if (!preemptive_task_queue_.empty())
+    return true;
+  if (pending_preemptive_events_ == 0)
+    return false;
+  // While only overlapping reads are in flight, the next task may start
+  // another one.
+  const bool only_reads_in_flight =
+      static_cast<size_t>(pending_preemptive_events_) ==
+      ordered_event_tasks_.size();
+  return !only_reads_in_flight ||
+         ordered_event_tasks_.size() >= kMaxOverlappingReads ||
+         task_queue_.empty() || !task_queue_.front_overlaps_reads();
+}
+
 void IndexedDBTransaction::RegisterOpenCursor(IndexedDBCursor* cursor) {
   open_cursors_.insert(cursor);
 }
@@ -460,8 +516,7 @@ IndexedDBTransaction::RunTasks() {
     backing_store_transaction_begun_ = true;
   }
 
-  bool run_preemptive_queue =
-      !preemptive_task_queue_.empty() || pending_preemptive_events_ != 0;
+  bool run_preemptive_queue = ShouldRunPreemptiveQueue();
   TaskQueue* task_queue =
       run_preemptive_queue ? &preemptive_task_queue_ : &task_queue_;
   while (!task_queue->empty() && state_ != FINISHED) {
@@ -480,8 +535,7 @@ IndexedDBTransaction::RunTasks() {
       };
     }
 
-    run_preemptive_queue =
-        !preemptive_task_queue_.empty() || pending_preemptive_events_ != 0;
+    run_preemptive_queue = ShouldRunPreemptiveQueue();
     // Event itself may change which queue should be processed next.
     task_queue = run_preemptive_queue ? &preemptive_task_queue_ : &task_queue_;
   }
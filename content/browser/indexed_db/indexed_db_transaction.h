@@ -11,8 +11,10 @@
 #include <memory>
 #include <set>
 #include <tuple>
+#include <utility>
 
 #include "base/callback.h"
+#include "base/containers/circular_deque.h"
 #include "base/containers/queue.h"
 #include "base/containers/stack.h"
 #include "base/gtest_prod_util.h"
@@ -41,6 +43,7 @@ class IndexedDBTransactionTest;
 FORWARD_DECLARE_TEST(IndexedDBTransactionTestMode, AbortPreemptive);
 FORWARD_DECLARE_TEST(IndexedDBTransactionTestMode, AbortTasks);
 FORWARD_DECLARE_TEST(IndexedDBTransactionTest, NoTimeoutReadOnly);
+FORWARD_DECLARE_TEST(IndexedDBTransactionTest, OverlappingReads);
 FORWARD_DECLARE_TEST(IndexedDBTransactionTest, SchedulePreemptiveTask);
 FORWARD_DECLARE_TEST(IndexedDBTransactionTestMode, ScheduleNormalTask);
 FORWARD_DECLARE_TEST(IndexedDBTransactionTestMode, TaskFails);
@@ -54,6 +57,10 @@ class CONTENT_EXPORT IndexedDBTransaction {
   using Operation = base::OnceCallback<leveldb::Status(IndexedDBTransaction*)>;
   using AbortOperation = base::OnceClosure;
 
+  // How many reads started by tasks scheduled with
+  // ScheduleOverlappingReadTask() can be in flight at once.
+  static constexpr size_t kMaxOverlappingReads = 16;
+
   enum State {
     CREATED,     // Created, but not yet started by coordinator.
     STARTED,     // Started by the coordinator.
@@ -83,6 +90,10 @@ class CONTENT_EXPORT IndexedDBTransaction {
     ScheduleTask(blink::mojom::IDBTaskType::Normal, std::move(task));
   }
   void ScheduleTask(blink::mojom::IDBTaskType, Operation task);
+  // Like ScheduleTask(), for a task that only starts a read with
+  // AddOrderedPreemptiveEvent(). Unlike other tasks, it doesn't wait for the
+  // reads started before it, up to kMaxOverlappingReads in flight.
+  void ScheduleOverlappingReadTask(Operation task);
   void ScheduleAbortTask(AbortOperation abort_task);
   void RegisterOpenCursor(IndexedDBCursor* cursor);
   void UnregisterOpenCursor(IndexedDBCursor* cursor);
@@ -91,6 +102,13 @@ class CONTENT_EXPORT IndexedDBTransaction {
     pending_preemptive_events_--;
     DCHECK_GE(pending_preemptive_events_, 0);
   }
+  // Like AddPreemptiveEvent(), for a read that completes with
+  // DidCompleteOrderedPreemptiveEvent(). Returns the id of the event.
+  int64_t AddOrderedPreemptiveEvent();
+  // Completes the ordered event |event_id|. |task| is scheduled as a
+  // preemptive task once the ordered events added before it have completed,
+  // so that the results of overlapping reads are sent in request order.
+  void DidCompleteOrderedPreemptiveEvent(int64_t event_id, Operation task);
 
   void AddPendingObserver(int32_t observer_id,
                           const IndexedDBObserver::Options& options);
@@ -176,6 +194,9 @@ class CONTENT_EXPORT IndexedDBTransaction {
   FRIEND_TEST_ALL_PREFIXES(
       indexed_db_transaction_unittest::IndexedDBTransactionTest,
       NoTimeoutReadOnly);
+  FRIEND_TEST_ALL_PREFIXES(
+      indexed_db_transaction_unittest::IndexedDBTransactionTest,
+      OverlappingReads);
   FRIEND_TEST_ALL_PREFIXES(
       indexed_db_transaction_unittest::IndexedDBTransactionTest,
       SchedulePreemptiveTask);
@@ -201,6 +222,8 @@ class CONTENT_EXPORT IndexedDBTransaction {
 
   bool IsTaskQueueEmpty() const;
   bool HasPendingTasks() const;
+  // Whether RunTasks() should only run preemptive tasks for now.
+  bool ShouldRunPreemptiveQueue() const;
 
   leveldb::Status BlobWriteComplete(
       IndexedDBBackingStore::BlobWriteResult result);
@@ -241,12 +264,17 @@ class CONTENT_EXPORT IndexedDBTransaction {
     TaskQueue();
     ~TaskQueue();
     bool empty() const { return queue_.empty(); }
-    void push(Operation task) { queue_.push(std::move(task)); }
+    void push(Operation task) { push(std::move(task), false); }
+    void push(Operation task, bool overlaps_reads) {
+      queue_.emplace(std::move(task), overlaps_reads);
+    }
+    // Whether the next task was scheduled by ScheduleOverlappingReadTask().
+    bool front_overlaps_reads() const { return queue_.front().second; }
     Operation pop();
     void clear();
 
    private:
-    base::queue<Operation> queue_;
+    base::queue<std::pair<Operation, bool>> queue_;
 
     DISALLOW_COPY_AND_ASSIGN(TaskQueue);
   };
@@ -274,6 +302,11 @@ class CONTENT_EXPORT IndexedDBTransaction {
   bool backing_store_transaction_begun_ = false;
 
   int pending_preemptive_events_ = 0;
+  // The tasks of the ordered events not yet scheduled, in the order of the
+  // events. A task is null until its event completes.
+  base::circular_deque<Operation> ordered_event_tasks_;
+  // The id of the event of |ordered_event_tasks_.front()|.
+  int64_t first_ordered_event_id_ = 0;
   bool processing_event_queue_ = false;
   bool aborted_ = false;
 
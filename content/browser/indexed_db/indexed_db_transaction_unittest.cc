@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 #include <memory>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/debug/stack_trace.h"
@@ -388,6 +389,76 @@ TEST_F(IndexedDBTransactionTest, SchedulePreemptiveTask) {
   EXPECT_TRUE(error_called_);
 }
 
+TEST_F(IndexedDBTransactionTest, OverlappingReads) {
+  const int64_t id = 0;
+  const std::set<int64_t> scope;
+  const leveldb::Status commit_success = leveldb::Status::OK();
+  std::unique_ptr<IndexedDBConnection> connection = CreateConnection();
+  IndexedDBTransaction* transaction = connection->CreateTransaction(
+      id, scope, blink::mojom::IDBTransactionMode::ReadOnly,
+      new IndexedDBFakeBackingStore::FakeTransaction(commit_success));
+  db_->RegisterAndScheduleTransaction(transaction);
+
+  // Each read only starts an ordered event, as GetOperation() does.
+  const size_t read_count = IndexedDBTransaction::kMaxOverlappingReads + 1;
+  std::vector<int64_t> event_ids;
+  for (size_t i = 0; i < read_count; ++i) {
+    transaction->ScheduleOverlappingReadTask(base::BindLambdaForTesting(
+        [&event_ids](IndexedDBTransaction* transaction) {
+          event_ids.push_back(transaction->AddOrderedPreemptiveEvent());
+          return leveldb::Status::OK();
+        }));
+  }
+  bool normal_task_run = false;
+  transaction->ScheduleTask(base::BindLambdaForTesting(
+      [&normal_task_run](IndexedDBTransaction* transaction) {
+        normal_task_run = true;
+        return leveldb::Status::OK();
+      }));
+
+  // The reads don't wait for each other, up to the limit.
+  RunPostedTasks();
+  ASSERT_EQ(IndexedDBTransaction::kMaxOverlappingReads, event_ids.size());
+  EXPECT_FALSE(normal_task_run);
+
+  std::vector<int64_t> results;
+  auto complete = [&](size_t read) {
+    transaction->DidCompleteOrderedPreemptiveEvent(
+        event_ids[read],
+        base::BindLambdaForTesting(
+            [&results, read](IndexedDBTransaction* transaction) {
+              results.push_back(read);
+              return leveldb::Status::OK();
+            }));
+  };
+
+  // A result waits for the results of the reads started before it.
+  complete(1);
+  RunPostedTasks();
+  EXPECT_TRUE(results.empty());
+  complete(0);
+  RunPostedTasks();
+  EXPECT_EQ(std::vector<int64_t>({0, 1}), results);
+
+  // The last read starts once there is room, but the normal task still waits.
+  ASSERT_EQ(read_count, event_ids.size());
+  EXPECT_FALSE(normal_task_run);
+  for (size_t read = read_count - 1; read >= 2; --read)
+    complete(read);
+  RunPostedTasks();
+  ASSERT_EQ(read_count, results.size());
+  for (size_t read = 0; read < read_count; ++read)
+    EXPECT_EQ(static_cast<int64_t>(read), results[read]);
+  EXPECT_TRUE(normal_task_run);
+  EXPECT_FALSE(transaction->HasPendingTasks());
+
+  // Clean up to avoid leaks.
+  transaction->Abort(IndexedDBDatabaseError(
+      IndexedDBDatabaseError(blink::kWebIDBDatabaseExceptionAbortError,
+                             "Transaction aborted by user.")));
+  EXPECT_EQ(IndexedDBTransaction::FINISHED, transaction->state());
+}
+
 TEST_P(IndexedDBTransactionTestMode, AbortTasks) {
   const int64_t id = 0;
   const std::set<int64_t> scope;
@@ -73,6 +73,35 @@ LevelDBSnapshot::~LevelDBSnapshot() {
   db_->ReleaseSnapshot(snapshot_);
 }
 
+LevelDBSharedSnapshot::LevelDBSharedSnapshot(TransactionalLevelDBDatabase* db)
+    : level_db_state_(db->leveldb_state()),
+      read_options_([db]() {
+        leveldb::ReadOptions read_options = db->DefaultReadOptions();
+        read_options.snapshot = db->db()->GetSnapshot();
+        return read_options;
+      }()) {}
+
+LevelDBSharedSnapshot::~LevelDBSharedSnapshot() {
+  level_db_state_->db()->ReleaseSnapshot(read_options_.snapshot);
+}
+
+leveldb::Status LevelDBSharedSnapshot::Get(const StringPiece& key,
+                                           std::string* value,
+                                           bool* found) const {
+  *found = false;
+  const leveldb::Status s = level_db_state_->db()->Get(
+      read_options_, leveldb_env::MakeSlice(key), value);
+  if (s.ok()) {
+    *found = true;
+    return s;
+  }
+  if (s.IsNotFound())
+    return leveldb::Status::OK();
+  indexed_db::ReportLevelDBError("WebCore.IndexedDB.LevelDBReadErrors", s);
+  LOG(ERROR) << "LevelDB get failed: " << s.ToString();
+  return s;
+}
+
 // static
 constexpr const size_t
     TransactionalLevelDBDatabase::kDefaultMaxOpenIteratorsPerDatabase;
@@ -13,6 +13,7 @@
 #include "base/files/file_path.h"
 #include "base/gtest_prod_util.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequenced_task_runner.h"
 #include "base/strings/string_piece.h"
@@ -57,6 +58,31 @@ class CONTENT_EXPORT LevelDBSnapshot {
   DISALLOW_COPY_AND_ASSIGN(LevelDBSnapshot);
 };
 
+// Like LevelDBSnapshot, but can be shared with other sequences, which may read
+// from it concurrently. It keeps the leveldb database alive until it is
+// released.
+class CONTENT_EXPORT LevelDBSharedSnapshot
+    : public base::RefCountedThreadSafe<LevelDBSharedSnapshot> {
+ public:
+  explicit LevelDBSharedSnapshot(TransactionalLevelDBDatabase* db);
+
+  // Reads |key| as of when this snapshot was taken. Can be called on any
+  // sequence.
+  leveldb::Status Get(const base::StringPiece& key,
+                      std::string* value,
+                      bool* found) const;
+
+ private:
+  friend class base::RefCountedThreadSafe<LevelDBSharedSnapshot>;
+
+  ~LevelDBSharedSnapshot();
+
+  const scoped_refptr<LevelDBState> level_db_state_;
+  const leveldb::ReadOptions read_options_;
+
+  DISALLOW_COPY_AND_ASSIGN(LevelDBSharedSnapshot);
+};
+
 class CONTENT_EXPORT TransactionalLevelDBDatabase
     : public base::trace_event::MemoryDumpProvider {
  public:
@@ -205,6 +205,17 @@ const base::Feature kHistoryPreventSandboxedNavigation{
 const base::Feature kIdleDetection{"IdleDetection",
                                    base::FEATURE_ENABLED_BY_DEFAULT};
 
+// Sizes IndexedDB cursor prefetch batches by the size and read time of the
+// records prefetched before.
+const base::Feature kIndexedDBAdaptivePrefetch{
+    "IndexedDBAdaptivePrefetch", base::FEATURE_ENABLED_BY_DEFAULT};
+
+// Enables reading the records of readonly IndexedDB transactions from a
+// LevelDB snapshot on the thread pool, instead of on the backing store's
+// sequence. Several Get requests of a transaction are read at once.
+const base::Feature kIndexedDBParallelReadOnlyReads{
+    "IndexedDBParallelReadOnlyReads", base::FEATURE_ENABLED_BY_DEFAULT};
+
 // This flag is used to set field parameters to choose predictor we use when
 // kResamplingInputEvents is disabled. It's used for gatherig accuracy metrics
 // on finch and also for choosing predictor type for predictedEvents API without
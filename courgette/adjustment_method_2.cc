@@ -13,6 +13,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/format_macros.h"
@@ -167,7 +168,7 @@ class ShinglePattern;
 class LabelInfo {
  public:
   // Just a no-argument constructor and copy constructor.  Actual LabelInfo
-  // objects are allocated in std::pair structs in a std::map.
+  // objects are allocated in bulk in a std::vector by LabelInfoMaker.
   LabelInfo()
       : label_(nullptr),
         is_model_(false),
@@ -197,9 +198,6 @@ class LabelInfo {
   AssignmentCandidates* candidates_;
 
   void operator=(const LabelInfo*);  // Disallow assignment only.
-  // Public compiler generated copy constructor is needed to constuct
-  // std::pair<Label*, LabelInfo> so that fresh LabelInfos can be allocated
-  // inside a std::map.
 };
 
 typedef std::vector<LabelInfo*> Trace;
@@ -214,21 +212,46 @@ std::string ToString(const LabelInfo* info) {
   return s;
 }
 
+// Marks a label that has no LabelInfo yet.
+constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
 // LabelInfoMaker maps labels to their surrogate LabelInfo objects.
+//
+// The LabelInfos live in a single vector, allocated once all the labels are
+// known, instead of one heap node per label. They are handed out in order of
+// first reference, so their addresses follow the same order as they would with
+// one allocation per label. Nothing in the adjustment depends on that order.
 class LabelInfoMaker {
  public:
   LabelInfoMaker() : debug_label_index_gen_(0) {}
 
+  // Allocates a LabelInfo for each distinct label in |labels|, which must hold
+  // every label later passed to MakeLabelInfo().
+  void Init(std::vector<Label*> labels) {
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+    labels.shrink_to_fit();
+    labels_ = std::move(labels);
+    slots_.assign(labels_.size(), kNoSlot);
+    label_infos_ = std::vector<LabelInfo>(labels_.size());
+    next_slot_ = 0;
+  }
+
   LabelInfo* MakeLabelInfo(Label* label, bool is_model, uint32_t position) {
-    LabelInfo& slot = label_infos_[label];
-    if (slot.label_ == nullptr) {
-      slot.label_ = label;
-      slot.is_model_ = is_model;
-      slot.debug_index_ = ++debug_label_index_gen_;
+    auto it = std::lower_bound(labels_.begin(), labels_.end(), label);
+    CHECK(it != labels_.end() && *it == label);
+    uint32_t& slot = slots_[it - labels_.begin()];
+    if (slot == kNoSlot)
+      slot = next_slot_++;
+    LabelInfo& info = label_infos_[slot];
+    if (info.label_ == nullptr) {
+      info.label_ = label;
+      info.is_model_ = is_model;
+      info.debug_index_ = ++debug_label_index_gen_;
     }
-    slot.positions_.push_back(position);
-    ++slot.refs_;
-    return &slot;
+    info.positions_.push_back(position);
+    ++info.refs_;
+    return &info;
   }
 
   void ResetDebugLabel() { debug_label_index_gen_ = 0; }
@@ -236,9 +259,14 @@ class LabelInfoMaker {
  private:
   int debug_label_index_gen_;
 
-  // Note LabelInfo is allocated 'flat' inside map::value_type, so the LabelInfo
-  // lifetimes are managed by the map.
-  std::map<Label*, LabelInfo> label_infos_;
+  // The distinct labels, sorted by address, and the position in
+  // |label_infos_| of the LabelInfo of each.
+  std::vector<Label*> labels_;
+  std::vector<uint32_t> slots_;
+  uint32_t next_slot_ = 0;
+
+  // Never resized after Init(), so pointers to the LabelInfos stay valid.
+  std::vector<LabelInfo> label_infos_;
 
   DISALLOW_COPY_AND_ASSIGN(LabelInfoMaker);
 };
@@ -1239,6 +1267,7 @@ class Adjuster : public AdjustmentMethod {
 
   bool Finish() {
     prog_->UnassignIndexes();
+    InitLabelInfos();
     Trace abs32_trace_;
     Trace rel32_trace_;
     CollectTraces(model_, &abs32_trace_, &rel32_trace_, true);
@@ -1252,6 +1281,17 @@ class Adjuster : public AdjustmentMethod {
   }
 
  private:
+  void InitLabelInfos() {
+    std::vector<Label*> labels;
+    for (const AssemblyProgram* program : {model_, prog_}) {
+      const std::vector<Label*>& abs32 = program->abs32_label_annotations();
+      const std::vector<Label*>& rel32 = program->rel32_label_annotations();
+      labels.insert(labels.end(), abs32.begin(), abs32.end());
+      labels.insert(labels.end(), rel32.begin(), rel32.end());
+    }
+    label_info_maker_.Init(std::move(labels));
+  }
+
   void CollectTraces(const AssemblyProgram* program, Trace* abs32, Trace* rel32,
                      bool is_model) {
     label_info_maker_.ResetDebugLabel();
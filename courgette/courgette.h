@@ -98,6 +98,16 @@ Status ApplyEnsemblePatch(const base::FilePath::CharType* old_file_name,
 Status GenerateEnsemblePatch(SourceStream* old, SourceStream* target,
                              SinkStream* patch);
 
+// Same as GenerateEnsemblePatch(), but transforms up to |num_threads| pairs of
+// matched elements at once. A transform only starts if the estimated memory of
+// the transforms running stays within |memory_budget| bytes, or if it would
+// run alone. The patch is the same as the one generated on a single thread.
+Status GenerateEnsemblePatchParallel(SourceStream* old,
+                                     SourceStream* target,
+                                     SinkStream* patch,
+                                     size_t num_threads,
+                                     size_t memory_budget);
+
 // Serializes |encoded| into the stream set.
 // Returns C_OK if succeeded, otherwise returns an error status.
 Status WriteEncodedProgram(EncodedProgram* encoded, SinkStreamSet* sink);
@@ -7,6 +7,7 @@
 #include <stdint.h>
 
 #include <initializer_list>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -19,8 +20,10 @@
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "build/build_config.h"
 #include "courgette/assembly_program.h"
 #include "courgette/courgette.h"
 #include "courgette/courgette_flow.h"
@@ -29,11 +32,19 @@
 #include "courgette/streams.h"
 #include "courgette/third_party/bsdiff/bsdiff.h"
 
+#if defined(OS_WIN)
+#include <windows.h>  // This include must come first.
+
+#include <psapi.h>
+#endif
+
 namespace {
 
 using courgette::CourgetteFlow;
 
-const char kUsageGen[] = "-gen <old_in> <new_in> <patch_out>";
+const char kUsageGen[] =
+    "-gen <old_in> <new_in> <patch_out> [-threads=<count>]"
+    " [-memory-budget=<MiB>]";
 const char kUsageApply[] = "-apply <old_in> <patch_in> <new_out>";
 const char kUsageGenbsdiff[] = "-genbsdiff <old_in> <new_in> <patch_out>";
 const char kUsageApplybsdiff[] = "-applybsdiff <old_in> <patch_in> <new_out>";
@@ -280,9 +291,36 @@ void Assemble(const base::FilePath& input_file,
   WriteSinkToFile(&sink, output_file);
 }
 
+// Returns the peak resident memory of the process so far, or 0 if unknown.
+size_t GetPeakResidentMemory() {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  std::string status;
+  if (!base::ReadFileToString(base::FilePath("/proc/self/status"), &status))
+    return 0;
+  for (base::StringPiece line : base::SplitStringPiece(
+           status, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    // The line is of the form "VmHWM: <val> kB".
+    std::vector<base::StringPiece> tokens = base::SplitStringPiece(
+        line, " ", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    size_t peak_kib = 0;
+    if (tokens.size() >= 2 && tokens[0] == "VmHWM:" &&
+        base::StringToSizeT(tokens[1], &peak_kib)) {
+      return peak_kib * 1024;
+    }
+  }
+#elif defined(OS_WIN)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (::GetProcessMemoryInfo(::GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return pmc.PeakWorkingSetSize;
+#endif
+  return 0;
+}
+
 void GenerateEnsemblePatch(const base::FilePath& old_file,
                            const base::FilePath& new_file,
-                           const base::FilePath& patch_file) {
+                           const base::FilePath& patch_file,
+                           size_t num_threads,
+                           size_t memory_budget) {
   BufferedFileReader old_buffer(old_file, "'old' input");
   BufferedFileReader new_buffer(new_file, "'new' input");
 
@@ -292,13 +330,16 @@ void GenerateEnsemblePatch(const base::FilePath& old_file,
   new_stream.Init(new_buffer.data(), new_buffer.length());
 
   courgette::SinkStream patch_stream;
-  courgette::Status status =
-      courgette::GenerateEnsemblePatch(&old_stream, &new_stream, &patch_stream);
+  courgette::Status status = courgette::GenerateEnsemblePatchParallel(
+      &old_stream, &new_stream, &patch_stream, num_threads, memory_budget);
 
   if (status != courgette::C_OK)
     Problem("-gen failed.");
 
   WriteSinkToFile(&patch_stream, patch_file);
+
+  LOG(INFO) << "Courgette.PeakResidentMemory "
+            << GetPeakResidentMemory() / 1024 << " KiB";
 }
 
 void ApplyEnsemblePatch(const base::FilePath& old_file,
@@ -440,6 +481,23 @@ int main(int argc, const char* argv[]) {
     if (!base::StringToInt(repeat_switch, &repeat_count))
       repeat_count = 1;
 
+  // '-threads=N' and '-memory-budget=MiB' let '-gen' transform several
+  // elements at once.
+  size_t num_threads = 1;
+  std::string threads_switch = command_line.GetSwitchValueASCII("threads");
+  if (!threads_switch.empty() &&
+      (!base::StringToSizeT(threads_switch, &num_threads) || num_threads == 0))
+    UsageProblem(kUsageGen);
+  size_t memory_budget = std::numeric_limits<size_t>::max();
+  std::string budget_switch = command_line.GetSwitchValueASCII("memory-budget");
+  if (!budget_switch.empty()) {
+    size_t memory_budget_mib = 0;
+    if (!base::StringToSizeT(budget_switch, &memory_budget_mib) ||
+        memory_budget_mib > memory_budget / (1024 * 1024))
+      UsageProblem(kUsageGen);
+    memory_budget = memory_budget_mib * 1024 * 1024;
+  }
+
   if (cmd_sup + cmd_dis + cmd_asm + cmd_disadj + cmd_make_patch +
           cmd_apply_patch + cmd_make_bsdiff_patch + cmd_apply_bsdiff_patch +
           cmd_spread_1_adjusted + cmd_spread_1_unadjusted !=
@@ -470,7 +528,8 @@ int main(int argc, const char* argv[]) {
     } else if (cmd_make_patch) {
       if (values.size() != 3)
         UsageProblem(kUsageGen);
-      GenerateEnsemblePatch(values[0], values[1], values[2]);
+      GenerateEnsemblePatch(values[0], values[1], values[2], num_threads,
+                            memory_budget);
     } else if (cmd_apply_patch) {
       if (values.size() != 3)
         UsageProblem(kUsageApply);
@@ -240,6 +240,9 @@ class TransformationPatchGenerator {
   virtual Status Reform(SourceStreamSet* transformed_element,
                         SinkStream* reformed_element);
 
+  Element* old_element() const { return old_element_; }
+  Element* new_element() const { return new_element_; }
+
  protected:
   Element* old_element_;
   Element* new_element_;
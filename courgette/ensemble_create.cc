@@ -16,10 +16,15 @@
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
 #include "base/logging.h"
+#include "base/macros.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/simple_thread.h"
 #include "base/time/time.h"
 
 #include "courgette/crc.h"
@@ -238,11 +243,168 @@ void FreeGenerators(std::vector<TransformationPatchGenerator*>* generators) {
   generators->clear();
 }
 
+namespace {
+
+// A rough estimate of the memory taken by the Transform() step of a generator,
+// per byte of its old and new elements: both are disassembled into Labels,
+// AssemblyPrograms and EncodedPrograms, of which a few are held at once.
+constexpr size_t kTransformMemoryPerByte = 10;
+
+size_t EstimateTransformMemory(TransformationPatchGenerator* generator) {
+  return (generator->old_element()->region().length() +
+          generator->new_element()->region().length()) *
+         kTransformMemoryPerByte;
+}
+
+// Runs the Transform() step of several generators on the threads that call
+// Run(). A transform only starts if the estimated memory of the transforms
+// running stays within the memory budget, or if none is running.
+class TransformRunner : public base::DelegateSimpleThread::Delegate {
+ public:
+  TransformRunner(const std::vector<TransformationPatchGenerator*>& generators,
+                  size_t memory_budget)
+      : generators_(generators),
+        memory_budget_(memory_budget),
+        parameters_(generators.size()),
+        predicted_(generators.size()),
+        corrected_(generators.size()),
+        statuses_(generators.size(), C_OK),
+        fits_(&lock_) {
+    for (size_t i = 0; i < generators.size(); ++i) {
+      order_.push_back(i);
+      estimates_.push_back(EstimateTransformMemory(generators[i]));
+    }
+    // Start with the largest transforms, so that small ones fill in the gaps
+    // left in the budget, and the last transform to finish is a small one.
+    std::stable_sort(order_.begin(), order_.end(), [this](size_t a, size_t b) {
+      return estimates_[a] > estimates_[b];
+    });
+  }
+  ~TransformRunner() override = default;
+
+  SourceStreamSet* parameters(size_t index) { return &parameters_[index]; }
+  SinkStreamSet* predicted(size_t index) { return &predicted_[index]; }
+  SinkStreamSet* corrected(size_t index) { return &corrected_[index]; }
+  Status status(size_t index) const { return statuses_[index]; }
+  size_t peak_estimate() const { return peak_estimate_; }
+
+  // base::DelegateSimpleThread::Delegate:
+  void Run() override {
+    for (;;) {
+      size_t index;
+      {
+        base::AutoLock auto_lock(lock_);
+        while (next_ < order_.size() && running_ > 0 &&
+               !FitsInBudget(estimates_[order_[next_]])) {
+          fits_.Wait();
+        }
+        if (next_ == order_.size())
+          return;
+        index = order_[next_++];
+        ++running_;
+        running_estimate_ += estimates_[index];
+        peak_estimate_ = std::max(peak_estimate_, running_estimate_);
+      }
+
+      statuses_[index] = generators_[index]->Transform(
+          &parameters_[index], &predicted_[index], &corrected_[index]);
+
+      base::AutoLock auto_lock(lock_);
+      --running_;
+      running_estimate_ -= estimates_[index];
+      fits_.Broadcast();
+    }
+  }
+
+ private:
+  bool FitsInBudget(size_t estimate) const {
+    return running_estimate_ <= memory_budget_ &&
+           estimate <= memory_budget_ - running_estimate_;
+  }
+
+  const std::vector<TransformationPatchGenerator*>& generators_;
+  const size_t memory_budget_;
+
+  // Inputs, outputs and estimated memory of each transform, by index in
+  // |generators_|. Each is only touched by the thread running its transform.
+  std::vector<SourceStreamSet> parameters_;
+  std::vector<SinkStreamSet> predicted_;
+  std::vector<SinkStreamSet> corrected_;
+  std::vector<Status> statuses_;
+  std::vector<size_t> estimates_;
+
+  // The order in which to start the transforms.
+  std::vector<size_t> order_;
+
+  base::Lock lock_;
+  // Signaled whenever a transform finishes.
+  base::ConditionVariable fits_;
+  size_t next_ = 0;  // Index in |order_| of the next transform to start.
+  size_t running_ = 0;
+  size_t running_estimate_ = 0;
+  size_t peak_estimate_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(TransformRunner);
+};
+
+// Transforms the elements of |generators| with their parameters from
+// |corrected_parameters_source_set| on up to |num_threads| threads, and writes
+// the results to |predicted_transformed_elements| and
+// |corrected_transformed_elements| in the order of |generators|, the same as
+// transforming them one by one.
+Status TransformInParallel(
+    const std::vector<TransformationPatchGenerator*>& generators,
+    SourceStreamSet* corrected_parameters_source_set,
+    SinkStreamSet* predicted_transformed_elements,
+    SinkStreamSet* corrected_transformed_elements,
+    size_t num_threads,
+    size_t memory_budget) {
+  base::Time start_time = base::Time::Now();
+  TransformRunner runner(generators, memory_budget);
+  for (size_t i = 0; i < generators.size(); ++i) {
+    if (!corrected_parameters_source_set->ReadSet(runner.parameters(i)))
+      return C_STREAM_ERROR;
+  }
+
+  num_threads = std::min(num_threads, generators.size());
+  base::DelegateSimpleThreadPool pool("courgette_transform",
+                                      static_cast<int>(num_threads));
+  pool.Start();
+  pool.AddWork(&runner, static_cast<int>(num_threads));
+  pool.JoinAll();
+
+  for (size_t i = 0; i < generators.size(); ++i) {
+    if (runner.status(i) != C_OK)
+      return runner.status(i);
+    if (!runner.parameters(i)->Empty())
+      return C_STREAM_NOT_CONSUMED;
+    if (!predicted_transformed_elements->WriteSet(runner.predicted(i)))
+      return C_STREAM_ERROR;
+    if (!corrected_transformed_elements->WriteSet(runner.corrected(i)))
+      return C_STREAM_ERROR;
+  }
+
+  VLOG(1) << "done transforms on " << num_threads << " threads, peak estimated "
+          << "memory " << runner.peak_estimate() / (1024 * 1024) << " MiB, in "
+          << (base::Time::Now() - start_time).InSecondsF() << "s";
+  return C_OK;
+}
+
+}  // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Status GenerateEnsemblePatch(SourceStream* base,
                              SourceStream* update,
                              SinkStream* final_patch) {
+  return GenerateEnsemblePatchParallel(base, update, final_patch, 1, 0);
+}
+
+Status GenerateEnsemblePatchParallel(SourceStream* base,
+                                     SourceStream* update,
+                                     SinkStream* final_patch,
+                                     size_t num_threads,
+                                     size_t memory_budget) {
   VLOG(1) << "start GenerateEnsemblePatch";
   base::Time start_time = base::Time::Now();
 
@@ -335,26 +497,35 @@ Status GenerateEnsemblePatch(SourceStream* base,
   SinkStreamSet predicted_transformed_elements;
   SinkStreamSet corrected_transformed_elements;
 
-  for (size_t i = 0;  i < number_of_transformations;  ++i) {
-    SourceStreamSet single_parameters;
-    if (!corrected_parameters_source_set.ReadSet(&single_parameters))
-      return C_STREAM_ERROR;
-    SinkStreamSet single_predicted_transformed_element;
-    SinkStreamSet single_corrected_transformed_element;
-    Status status = generators[i]->Transform(
-        &single_parameters,
-        &single_predicted_transformed_element,
-        &single_corrected_transformed_element);
+  if (num_threads > 1 && number_of_transformations > 1) {
+    Status status = TransformInParallel(
+        generators, &corrected_parameters_source_set,
+        &predicted_transformed_elements, &corrected_transformed_elements,
+        num_threads, memory_budget);
     if (status != C_OK)
       return status;
-    if (!single_parameters.Empty())
-      return C_STREAM_NOT_CONSUMED;
-    if (!predicted_transformed_elements.WriteSet(
-            &single_predicted_transformed_element))
-      return C_STREAM_ERROR;
-    if (!corrected_transformed_elements.WriteSet(
-            &single_corrected_transformed_element))
-      return C_STREAM_ERROR;
+  } else {
+    for (size_t i = 0;  i < number_of_transformations;  ++i) {
+      SourceStreamSet single_parameters;
+      if (!corrected_parameters_source_set.ReadSet(&single_parameters))
+        return C_STREAM_ERROR;
+      SinkStreamSet single_predicted_transformed_element;
+      SinkStreamSet single_corrected_transformed_element;
+      Status status = generators[i]->Transform(
+          &single_parameters,
+          &single_predicted_transformed_element,
+          &single_corrected_transformed_element);
+      if (status != C_OK)
+        return status;
+      if (!single_parameters.Empty())
+        return C_STREAM_NOT_CONSUMED;
+      if (!predicted_transformed_elements.WriteSet(
+              &single_predicted_transformed_element))
+        return C_STREAM_ERROR;
+      if (!corrected_transformed_elements.WriteSet(
+              &single_corrected_transformed_element))
+        return C_STREAM_ERROR;
+    }
   }
 
   if (!corrected_parameters_source_set.Empty())
@@ -2,6 +2,10 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stddef.h>
+
+#include <limits>
+
 #include "courgette/base_test_unittest.h"
 #include "courgette/courgette.h"
 #include "courgette/streams.h"
@@ -55,6 +59,20 @@ void EnsembleTest::TestEnsemble(const std::string& src_bytes,
   EXPECT_FALSE(memcmp(target.Buffer(),
                       patch_result.Buffer(),
                       target.OriginalLength()));
+
+  // Transforming the elements on several threads makes the same patch, whether
+  // the memory budget lets them all run at once or only one at a time.
+  for (size_t memory_budget : {std::numeric_limits<size_t>::max(), size_t{0}}) {
+    source.Init(src_bytes);
+    target.Init(tgt_bytes);
+    courgette::SinkStream parallel_patch_sink;
+    status = courgette::GenerateEnsemblePatchParallel(
+        &source, &target, &parallel_patch_sink, 4, memory_budget);
+    EXPECT_EQ(courgette::C_OK, status);
+    ASSERT_EQ(patch_sink.Length(), parallel_patch_sink.Length());
+    EXPECT_FALSE(memcmp(patch_sink.Buffer(), parallel_patch_sink.Buffer(),
+                        patch_sink.Length()));
+  }
 }
 
 void EnsembleTest::Elf32Ensemble() const {
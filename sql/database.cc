@@ -9,6 +9,9 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/format_macros.h"
@@ -26,13 +29,16 @@
 #include "base/strings/utf_string_conversions.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/scoped_blocking_call.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "base/trace_event/memory_dump_manager.h"
 #include "build/build_config.h"
 #include "sql/database_memory_dump_provider.h"
 #include "sql/initialization.h"
 #include "sql/meta_table.h"
+#include "sql/page_cache_budget.h"
 #include "sql/sql_features.h"
 #include "sql/statement.h"
+#include "sql/statement_profiler.h"
 #include "sql/vfs_wrapper.h"
 #include "third_party/sqlite/sqlite3.h"
 
@@ -144,6 +150,21 @@ int GetSqlite3FileAndSize(sqlite3* db,
   return (*file)->pMethods->xFileSize(*file, db_size);
 }
 
+// How much to memory-map for a database of |db_size| bytes, whose contents
+// were found readable. It leaves room for the file to grow by half, and by at
+// least 8MB, until the next time it is opened, but no more than |max_size|.
+// Mapping less than everything saves address space, which is scarce in 32-bit
+// processes running many databases.
+size_t GetMmapSizeForFileSize(sqlite3_int64 db_size, size_t max_size) {
+  const sqlite3_int64 kMinHeadroom = 8 * 1024 * 1024;
+  const sqlite3_int64 kGranularity = 1024 * 1024;
+  sqlite3_int64 size = db_size + std::max(db_size / 2, kMinHeadroom);
+  size = (size + kGranularity - 1) / kGranularity * kGranularity;
+  return size < static_cast<sqlite3_int64>(max_size)
+             ? static_cast<size_t>(size)
+             : max_size;
+}
+
 std::string AsUTF8ForSQL(const base::FilePath& path) {
 #if defined(OS_WIN)
   return base::UTF16ToUTF8(path.value());
@@ -311,6 +332,14 @@ void Database::CloseInternal(bool forced) {
     base::Optional<base::ScopedBlockingCall> scoped_blocking_call;
     InitScopedBlockingCall(&scoped_blocking_call);
 
+    // Give this database's share of the page cache budget back.
+    if (page_cache_budget_id_ != PageCacheBudget::kInvalidClientId) {
+      PageCacheBudget::GetInstance()->Unregister(page_cache_budget_id_);
+      page_cache_budget_id_ = PageCacheBudget::kInvalidClientId;
+      steps_since_budget_report_ = 0;
+      budget_cache_pages_ = 0;
+    }
+
     // Reseting acquires a lock to ensure no dump is happening on the database
     // at the same time. Unregister takes ownership of provider and it is safe
     // since the db is reset. memory_dump_provider_ could be null if db_ was
@@ -635,10 +664,21 @@ size_t Database::GetAppropriateMmapSize() {
   base::Optional<base::ScopedBlockingCall> scoped_blocking_call;
   InitScopedBlockingCall(&scoped_blocking_call);
 
-  // How much to map if no errors are found.  50MB encompasses the 99th
+  // The most to map if no errors are found.  50MB encompasses the 99th
   // percentile of Chrome databases in the wild, so this should be good.
   const size_t kMmapEverything = 256 * 1024 * 1024;
 
+  // With kSqlMmapFileSize, the file is mapped with some room to grow, rather
+  // than |kMmapEverything| for every database.
+  sqlite3_file* file = nullptr;
+  sqlite3_int64 db_size = 0;
+  const bool has_size =
+      GetSqlite3FileAndSize(db_, &file, &db_size) == SQLITE_OK;
+  const size_t mmap_everything =
+      has_size && base::FeatureList::IsEnabled(features::kSqlMmapFileSize)
+          ? GetMmapSizeForFileSize(db_size, kMmapEverything)
+          : kMmapEverything;
+
   // Progress information is tracked in the [meta] table for databases which use
   // sql::MetaTable, otherwise it is tracked in a special view.
   // TODO(shess): Move all cases to the view implementation.
@@ -653,7 +693,7 @@ size_t Database::GetAppropriateMmapSize() {
     // sql::MetaTable::Init() will preload kMmapSuccess.
     if (!MetaTable::DoesTableExist(this)) {
       RecordOneEvent(EVENT_MMAP_META_MISSING);
-      return kMmapEverything;
+      return mmap_everything;
     }
 
     if (!MetaTable::GetMmapStatus(this, &mmap_ofs)) {
@@ -679,9 +719,7 @@ size_t Database::GetAppropriateMmapSize() {
     // Read more of the database looking for errors.  The VFS interface is used
     // to assure that the reads are valid for SQLite.  |g_reads_allowed| is used
     // to limit checking to 20MB per run of Chromium.
-    sqlite3_file* file = nullptr;
-    sqlite3_int64 db_size = 0;
-    if (SQLITE_OK != GetSqlite3FileAndSize(db_, &file, &db_size)) {
+    if (!has_size) {
       RecordOneEvent(EVENT_MMAP_VFS_FAILURE);
       return 0;
     }
@@ -751,7 +789,7 @@ size_t Database::GetAppropriateMmapSize() {
   if (mmap_ofs == MetaTable::kMmapFailure)
     return 0;
   if (mmap_ofs == MetaTable::kMmapSuccess)
-    return kMmapEverything;
+    return mmap_everything;
   return mmap_ofs;
 }
 
@@ -759,6 +797,8 @@ void Database::TrimMemory() {
   if (!db_)
     return;
 
+  if (page_cache_budget_id_ != PageCacheBudget::kInvalidClientId)
+    UpdatePageCacheBudget();
   sqlite3_db_release_memory(db_);
 
   // It is tempting to use sqlite3_release_memory() here as well. However, the
@@ -770,6 +810,37 @@ void Database::TrimMemory() {
   // pool.
 }
 
+constexpr int64_t Database::kStepsPerBudgetReport;
+
+void Database::UpdatePageCacheBudget() {
+  DCHECK_NE(PageCacheBudget::kInvalidClientId, page_cache_budget_id_);
+  const int64_t steps = steps_since_budget_report_;
+  steps_since_budget_report_ = 0;
+  ApplyPageCacheBudget(
+      PageCacheBudget::GetInstance()->ReportSteps(page_cache_budget_id_, steps),
+      /*force=*/false);
+}
+
+void Database::ApplyPageCacheBudget(int cache_pages, bool force) {
+  // Shares move a little with every report. Only follow moves of more than an
+  // eighth, so that the cache isn't resized all the time.
+  if (!force && cache_pages <= budget_cache_pages_ + budget_cache_pages_ / 8 &&
+      cache_pages >= budget_cache_pages_ - budget_cache_pages_ / 8) {
+    return;
+  }
+  budget_cache_pages_ = cache_pages;
+  const std::string cache_size_sql =
+      base::StringPrintf("PRAGMA cache_size=%d", cache_pages);
+  ignore_result(Execute(cache_size_sql.c_str()));
+}
+
+void Database::OnPageCacheBudgetChanged(PageCacheBudget::ClientId id,
+                                        int cache_pages) {
+  if (!db_ || id != page_cache_budget_id_)
+    return;
+  ApplyPageCacheBudget(cache_pages, /*force=*/false);
+}
+
 // Create an in-memory database with the existing database's page
 // size, then backup that database over the existing database.
 bool Database::Raze() {
@@ -1097,7 +1168,9 @@ int Database::ExecuteAndReturnErrorCode(const char* sql) {
     if (!sqlite_statement)
       continue;
 
-    while ((rc = sqlite3_step(sqlite_statement)) == SQLITE_ROW) {
+    OnStatementStep();
+    while ((rc = ProfiledStep(sqlite_statement, statement_profiler_.get())) ==
+           SQLITE_ROW) {
       // TODO(shess): Audit to see if this can become a DCHECK.  I think PRAGMA
       // is the only legitimate case for this. Previously recorded histograms
       // show significant use of this code path.
@@ -1353,6 +1426,9 @@ bool Database::OpenInternal(const std::string& file_name,
 
   EnsureSqliteInitialized();
 
+  if (base::FeatureList::IsEnabled(features::kSqlStatementProfiling))
+    EnableStatementProfiling();
+
   // Setup the stats histograms immediately rather than allocating lazily.
   // Databases which won't exercise all of these probably shouldn't exist.
   if (!histogram_tag_.empty()) {
@@ -1467,6 +1543,22 @@ bool Database::OpenInternal(const std::string& file_name,
     const std::string cache_size_sql =
         base::StringPrintf("PRAGMA cache_size=%d", cache_size_);
     ignore_result(ExecuteWithTimeout(cache_size_sql.c_str(), kBusyTimeout));
+  } else if (!in_memory_ &&
+             base::FeatureList::IsEnabled(features::kSqlPageCacheBudget)) {
+    // The page size of an existing database may differ from |page_size_|.
+    Statement page_size(GetUniqueStatement("PRAGMA page_size"));
+    if (page_size.Step() && page_size.ColumnInt(0) > 0) {
+      PageCacheBudget* budget = PageCacheBudget::GetInstance();
+      page_cache_budget_id_ = budget->Register(
+          page_size.ColumnInt(0),
+          base::SequencedTaskRunnerHandle::IsSet()
+              ? base::SequencedTaskRunnerHandle::Get()
+              : nullptr,
+          base::BindRepeating(&Database::OnPageCacheBudgetChanged,
+                              weak_factory_.GetWeakPtr()));
+      ApplyPageCacheBudget(budget->GetCachePages(page_cache_budget_id_),
+                           /*force=*/true);
+    }
   }
 
   static_assert(SQLITE_SECURE_DELETE == 1,
@@ -1509,8 +1601,8 @@ bool Database::OpenInternal(const std::string& file_name,
   }
 
   DCHECK(!memory_dump_provider_);
-  memory_dump_provider_.reset(
-      new DatabaseMemoryDumpProvider(db_, histogram_tag_));
+  memory_dump_provider_.reset(new DatabaseMemoryDumpProvider(
+      db_, histogram_tag_, statement_profiler_.get()));
   base::trace_event::MemoryDumpManager::GetInstance()->RegisterDumpProvider(
       memory_dump_provider_.get(), "sql::Database", nullptr);
 
@@ -1675,6 +1767,21 @@ bool Database::IntegrityCheckHelper(const char* pragma_sql,
   return ret;
 }
 
+void Database::EnableStatementProfiling() {
+  if (statement_profiler_)
+    return;
+  statement_profiler_ = std::make_unique<StatementProfiler>();
+  if (memory_dump_provider_)
+    memory_dump_provider_->SetStatementProfiler(statement_profiler_.get());
+}
+
+std::map<std::string, StatementProfiler::Stats>
+Database::GetStatementStatsForTesting() const {
+  if (!statement_profiler_)
+    return std::map<std::string, StatementProfiler::Stats>();
+  return statement_profiler_->GetStats();
+}
+
 bool Database::ReportMemoryUsage(base::trace_event::ProcessMemoryDump* pmd,
                                  const std::string& dump_name) {
   return memory_dump_provider_ &&
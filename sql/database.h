@@ -7,6 +7,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -20,11 +21,14 @@
 #include "base/gtest_prod_util.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "base/optional.h"
 #include "base/sequence_checker.h"
 #include "base/threading/scoped_blocking_call.h"
 #include "sql/internal_api_token.h"
+#include "sql/page_cache_budget.h"
 #include "sql/statement_id.h"
+#include "sql/statement_profiler.h"
 
 struct sqlite3;
 struct sqlite3_stmt;
@@ -82,6 +86,9 @@ class COMPONENT_EXPORT(SQL) Database {
   // Sets the number of pages that will be cached in memory by sqlite. The
   // total cache size in bytes will be page_size * cache_size. This must be
   // called before Open() to have an effect.
+  //
+  // Databases that don't set a cache size share sql::PageCacheBudget, which
+  // sizes their caches by how busy they are.
   void set_cache_size(int cache_size) {
     DCHECK_GE(cache_size, 0);
 
@@ -199,6 +206,20 @@ class COMPONENT_EXPORT(SQL) Database {
   bool ReportMemoryUsage(base::trace_event::ProcessMemoryDump* pmd,
                          const std::string& dump_name);
 
+  // Starts recording, for each statement, the steps, rows, time spent and page
+  // cache hits and misses. The stats are added to detailed memory dumps. This
+  // can be called at any time, and is done by Open() when the
+  // SqlStatementProfiling feature is enabled. Steps are also traced under the
+  // "disabled-by-default-sql" category, whether profiling is on or not.
+  void EnableStatementProfiling();
+  bool statement_profiling_enabled() const {
+    return static_cast<bool>(statement_profiler_);
+  }
+
+  // Returns the stats recorded since profiling was enabled, by statement.
+  std::map<std::string, StatementProfiler::Stats> GetStatementStatsForTesting()
+      const;
+
   // Initialization ------------------------------------------------------------
 
   // Initializes the SQL database for the given file, returning true if the
@@ -239,6 +260,7 @@ class COMPONENT_EXPORT(SQL) Database {
   void Preload();
 
   // Release all non-essential memory associated with this database connection.
+  // This also applies the current page cache budget.
   void TrimMemory();
 
   // Raze the database to the ground.  This approximates creating a
@@ -503,7 +525,9 @@ class COMPONENT_EXPORT(SQL) Database {
   FRIEND_TEST_ALL_PREFIXES(SQLDatabaseTest, GetAppropriateMmapSize);
   FRIEND_TEST_ALL_PREFIXES(SQLDatabaseTest, GetAppropriateMmapSizeAltStatus);
   FRIEND_TEST_ALL_PREFIXES(SQLDatabaseTest, OnMemoryDump);
+  FRIEND_TEST_ALL_PREFIXES(SQLDatabaseTest, PageCacheBudget);
   FRIEND_TEST_ALL_PREFIXES(SQLDatabaseTest, RegisterIntentToUpload);
+  FRIEND_TEST_ALL_PREFIXES(SQLDatabaseTest, StatementProfiling);
   FRIEND_TEST_ALL_PREFIXES(SQLiteFeaturesTest, WALNoClose);
 
   // Internal initialize function used by both Init and InitInMemory. The file
@@ -681,6 +705,23 @@ class COMPONENT_EXPORT(SQL) Database {
   bool GetMmapAltStatus(int64_t* status);
   bool SetMmapAltStatus(int64_t status);
 
+  // Called before each step of a statement. Every |kStepsPerBudgetReport|
+  // steps, reports them to the page cache budget and applies the new share.
+  void OnStatementStep() {
+    if (page_cache_budget_id_ != PageCacheBudget::kInvalidClientId &&
+        ++steps_since_budget_report_ >= kStepsPerBudgetReport) {
+      UpdatePageCacheBudget();
+    }
+  }
+  static constexpr int64_t kStepsPerBudgetReport = 256;
+  void UpdatePageCacheBudget();
+  // Sets the cache size to the page cache budget's share, unless it is close
+  // to the current size and |force| is false.
+  void ApplyPageCacheBudget(int cache_pages, bool force);
+  // Applies a share pushed by the budget, if |id| is still this database's
+  // registration.
+  void OnPageCacheBudgetChanged(PageCacheBudget::ClientId id, int cache_pages);
+
   // The actual sqlite database. Will be null before Init has been called or if
   // Init resulted in an error.
   sqlite3* db_;
@@ -746,6 +787,20 @@ class COMPONENT_EXPORT(SQL) Database {
   // Stores the dump provider object when db is open.
   std::unique_ptr<DatabaseMemoryDumpProvider> memory_dump_provider_;
 
+  // Registration with PageCacheBudget, while the database is open and doesn't
+  // have a |cache_size_|.
+  PageCacheBudget::ClientId page_cache_budget_id_ =
+      PageCacheBudget::kInvalidClientId;
+  int64_t steps_since_budget_report_ = 0;
+  // The cache size last set from the budget.
+  int budget_cache_pages_ = 0;
+
+  // Set by EnableStatementProfiling(). Outlives |memory_dump_provider_|'s use
+  // of it, as CloseInternal() resets the provider.
+  std::unique_ptr<StatementProfiler> statement_profiler_;
+
+  base::WeakPtrFactory<Database> weak_factory_{this};
+
   DISALLOW_COPY_AND_ASSIGN(Database);
 };
 
@@ -8,19 +8,31 @@
 
 #include "base/strings/stringprintf.h"
 #include "base/trace_event/process_memory_dump.h"
+#include "sql/statement_profiler.h"
 #include "third_party/sqlite/sqlite3.h"
 
 namespace sql {
 
-DatabaseMemoryDumpProvider::DatabaseMemoryDumpProvider(sqlite3* db,
-                                                       const std::string& name)
-    : db_(db), connection_name_(name) {}
+DatabaseMemoryDumpProvider::DatabaseMemoryDumpProvider(
+    sqlite3* db,
+    const std::string& name,
+    StatementProfiler* statement_profiler)
+    : db_(db),
+      statement_profiler_(statement_profiler),
+      connection_name_(name) {}
 
 DatabaseMemoryDumpProvider::~DatabaseMemoryDumpProvider() = default;
 
 void DatabaseMemoryDumpProvider::ResetDatabase() {
   base::AutoLock lock(lock_);
   db_ = nullptr;
+  statement_profiler_ = nullptr;
+}
+
+void DatabaseMemoryDumpProvider::SetStatementProfiler(
+    StatementProfiler* statement_profiler) {
+  base::AutoLock lock(lock_);
+  statement_profiler_ = statement_profiler;
 }
 
 bool DatabaseMemoryDumpProvider::OnMemoryDump(
@@ -50,6 +62,10 @@ bool DatabaseMemoryDumpProvider::OnMemoryDump(
   dump->AddScalar("statement_size",
                   base::trace_event::MemoryAllocatorDump::kUnitsBytes,
                   statement_size);
+
+  base::AutoLock lock(lock_);
+  if (statement_profiler_)
+    statement_profiler_->DumpStats(FormatDumpName(), pmd);
   return true;
 }
 
@@ -21,14 +21,23 @@ class ProcessMemoryDump;
 
 namespace sql {
 
+class StatementProfiler;
+
 class DatabaseMemoryDumpProvider
     : public base::trace_event::MemoryDumpProvider {
  public:
-  DatabaseMemoryDumpProvider(sqlite3* db, const std::string& name);
+  // |statement_profiler| may be null. It must stay alive until
+  // ResetDatabase() is called.
+  DatabaseMemoryDumpProvider(sqlite3* db,
+                             const std::string& name,
+                             StatementProfiler* statement_profiler);
   ~DatabaseMemoryDumpProvider() override;
 
   void ResetDatabase();
 
+  // Adds the stats of |statement_profiler| to detailed dumps from now on.
+  void SetStatementProfiler(StatementProfiler* statement_profiler);
+
   // base::trace_event::MemoryDumpProvider implementation.
   bool OnMemoryDump(
       const base::trace_event::MemoryDumpArgs& args,
@@ -45,6 +54,7 @@ class DatabaseMemoryDumpProvider
   std::string FormatDumpName() const;
 
   sqlite3* db_;  // not owned.
+  StatementProfiler* statement_profiler_;  // not owned.
   base::Lock lock_;
   std::string connection_name_;
 
@@ -5,6 +5,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <map>
+#include <string>
+
 #include "base/bind.h"
 #include "base/files/file_util.h"
 #include "base/files/scoped_file.h"
@@ -15,12 +18,16 @@
 #include "base/test/gtest_util.h"
 #include "base/test/metrics/histogram_tester.h"
 #include "base/test/scoped_feature_list.h"
+#include "base/test/task_environment.h"
 #include "base/trace_event/process_memory_dump.h"
 #include "build/build_config.h"
 #include "sql/database.h"
 #include "sql/database_memory_dump_provider.h"
 #include "sql/meta_table.h"
+#include "sql/page_cache_budget.h"
+#include "sql/sql_features.h"
 #include "sql/statement.h"
+#include "sql/statement_profiler.h"
 #include "sql/test/database_test_peer.h"
 #include "sql/test/error_callback_support.h"
 #include "sql/test/scoped_error_expecter.h"
@@ -1046,6 +1053,121 @@ TEST_F(SQLDatabaseTest, OnMemoryDump) {
   EXPECT_GE(pmd.allocator_dumps().size(), 1u);
 }
 
+TEST_F(SQLDatabaseTest, PageCacheBudget) {
+  // The database opened by the fixture predates the feature.
+  EXPECT_EQ(PageCacheBudget::kInvalidClientId, db().page_cache_budget_id_);
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(features::kSqlPageCacheBudget);
+  db().Close();
+  ASSERT_TRUE(db().Open(db_path()));
+
+  PageCacheBudget* budget = PageCacheBudget::GetInstance();
+  const size_t client_count = budget->client_count();
+
+  // The reopened database has its share of the budget.
+  ASSERT_NE(PageCacheBudget::kInvalidClientId, db().page_cache_budget_id_);
+  EXPECT_GT(db().budget_cache_pages_, 0);
+  EXPECT_EQ(base::NumberToString(db().budget_cache_pages_),
+            ExecuteWithResult(&db(), "PRAGMA cache_size"));
+
+  db().Close();
+  EXPECT_EQ(PageCacheBudget::kInvalidClientId, db().page_cache_budget_id_);
+  EXPECT_EQ(client_count - 1, budget->client_count());
+
+  // Databases with their own cache size don't take part.
+  db().set_cache_size(64);
+  ASSERT_TRUE(db().Open(db_path()));
+  EXPECT_EQ(PageCacheBudget::kInvalidClientId, db().page_cache_budget_id_);
+  EXPECT_EQ("64", ExecuteWithResult(&db(), "PRAGMA cache_size"));
+  EXPECT_EQ(client_count - 1, budget->client_count());
+}
+
+TEST_F(SQLDatabaseTest, PageCacheBudgetMemoryPressure) {
+  base::test::TaskEnvironment task_environment;
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(features::kSqlPageCacheBudget);
+  db().Close();
+  ASSERT_TRUE(db().Open(db_path()));
+  ASSERT_NE(PageCacheBudget::kInvalidClientId, db().page_cache_budget_id_);
+  const int cache_pages = db().budget_cache_pages_;
+
+  // The shrunk share is applied without the database being stepped.
+  PageCacheBudget::GetInstance()->OnMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  task_environment.RunUntilIdle();
+  EXPECT_LT(db().budget_cache_pages_, cache_pages);
+  EXPECT_EQ(base::NumberToString(db().budget_cache_pages_),
+            ExecuteWithResult(&db(), "PRAGMA cache_size"));
+
+  // A share pushed after the database is closed is dropped.
+  db().Close();
+  PageCacheBudget::GetInstance()->OnMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  task_environment.RunUntilIdle();
+  EXPECT_EQ(0, db().budget_cache_pages_);
+}
+
+TEST_F(SQLDatabaseTest, StatementProfiling) {
+  static const char kInsertSql[] = "INSERT INTO foo (a, b) VALUES (1, 2)";
+  static const char kSelectSql[] = "SELECT a FROM foo";
+
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a, b)"));
+  EXPECT_FALSE(db().statement_profiling_enabled());
+  EXPECT_TRUE(db().GetStatementStatsForTesting().empty());
+
+  db().EnableStatementProfiling();
+  EXPECT_TRUE(db().statement_profiling_enabled());
+  ASSERT_TRUE(db().Execute(kInsertSql));
+  ASSERT_TRUE(db().Execute(kInsertSql));
+  for (int i = 0; i < 2; ++i) {
+    Statement s(db().GetCachedStatement(SQL_FROM_HERE, kSelectSql));
+    while (s.Step()) {
+    }
+  }
+
+  std::map<std::string, StatementProfiler::Stats> stats =
+      db().GetStatementStatsForTesting();
+  ASSERT_EQ(2u, stats.size());
+  const StatementProfiler::Stats& insert = stats[kInsertSql];
+  EXPECT_EQ(2, insert.step_count);
+  EXPECT_EQ(0, insert.row_count);
+  // Two rows then the end of the results, twice.
+  const StatementProfiler::Stats& select = stats[kSelectSql];
+  EXPECT_EQ(6, select.step_count);
+  EXPECT_EQ(4, select.row_count);
+  EXPECT_GE(select.total_time, select.max_time);
+  EXPECT_GT(select.cache_hits + select.cache_misses, 0);
+
+  // Detailed memory dumps have a dump per statement.
+  base::trace_event::MemoryDumpArgs args = {
+      base::trace_event::MemoryDumpLevelOfDetail::DETAILED};
+  base::trace_event::ProcessMemoryDump pmd(args);
+  ASSERT_TRUE(db().memory_dump_provider_->OnMemoryDump(args, &pmd));
+  size_t statement_dumps = 0;
+  for (const auto& dump : pmd.allocator_dumps()) {
+    if (dump.first.find("/statements/") != std::string::npos)
+      ++statement_dumps;
+  }
+  EXPECT_EQ(2u, statement_dumps);
+}
+
+TEST_F(SQLDatabaseTest, StatementProfilingIsBounded) {
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a)"));
+  db().EnableStatementProfiling();
+  const size_t kStatementCount = StatementProfiler::kMaxStatements + 10;
+  for (size_t i = 0; i < kStatementCount; ++i) {
+    const std::string sql =
+        "INSERT INTO foo (a) VALUES (" + base::NumberToString(i) + ")";
+    ASSERT_TRUE(db().Execute(sql.c_str()));
+  }
+
+  // The statements past the limit are counted together.
+  std::map<std::string, StatementProfiler::Stats> stats =
+      db().GetStatementStatsForTesting();
+  EXPECT_EQ(StatementProfiler::kMaxStatements + 1, stats.size());
+  EXPECT_EQ(10, stats[std::string()].step_count);
+}
+
 // Test that the functions to collect diagnostic data run to completion, without
 // worrying too much about what they generate (since that will change).
 TEST_F(SQLDatabaseTest, CollectDiagnosticInfo) {
@@ -1184,6 +1306,22 @@ TEST_F(SQLDatabaseTest, GetAppropriateMmapSize) {
   ASSERT_EQ(MetaTable::kMmapSuccess, mmap_status);
 }
 
+TEST_F(SQLDatabaseTest, GetAppropriateMmapSizeFileSize) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(features::kSqlMmapFileSize);
+
+  // Small databases are mapped with room to grow, but not as much as large
+  // ones.
+  const size_t kMmapAlot = 4 * 1024 * 1024;
+  const size_t kMmapEverything = 256 * 1024 * 1024;
+  ASSERT_GT(db().GetAppropriateMmapSize(), kMmapAlot);
+  ASSERT_LT(db().GetAppropriateMmapSize(), kMmapEverything);
+
+  MetaTable().Init(&db(), 1, 1);
+  ASSERT_GT(db().GetAppropriateMmapSize(), kMmapAlot);
+  ASSERT_LT(db().GetAppropriateMmapSize(), kMmapEverything);
+}
+
 TEST_F(SQLDatabaseTest, GetAppropriateMmapSizeAltStatus) {
   const size_t kMmapAlot = 25 * 1024 * 1024;
 
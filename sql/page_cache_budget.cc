@@ -0,0 +1,174 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sql/page_cache_budget.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/no_destructor.h"
+#include "base/time/default_tick_clock.h"
+
+namespace sql {
+
+constexpr PageCacheBudget::ClientId PageCacheBudget::kInvalidClientId;
+constexpr size_t PageCacheBudget::kDefaultBudgetBytes;
+constexpr size_t PageCacheBudget::kMinCacheBytes;
+constexpr base::TimeDelta PageCacheBudget::kDecayInterval;
+constexpr base::TimeDelta PageCacheBudget::kPressureDuration;
+
+// static
+PageCacheBudget* PageCacheBudget::GetInstance() {
+  static base::NoDestructor<PageCacheBudget> instance(kDefaultBudgetBytes);
+  return instance.get();
+}
+
+PageCacheBudget::PageCacheBudget(size_t budget_bytes,
+                                 const base::TickClock* clock)
+    : budget_bytes_(budget_bytes),
+      clock_(clock ? clock : base::DefaultTickClock::GetInstance()) {}
+
+PageCacheBudget::~PageCacheBudget() = default;
+
+PageCacheBudget::ClientId PageCacheBudget::Register(
+    int page_size,
+    scoped_refptr<base::SequencedTaskRunner> task_runner,
+    ShareCallback on_share_changed) {
+  DCHECK_GT(page_size, 0);
+  base::AutoLock lock(lock_);
+  UpdateLocked(clock_->NowTicks());
+  const ClientId id = next_id_++;
+  Client& client = clients_[id];
+  client.page_size = page_size;
+  if (task_runner && on_share_changed) {
+    client.task_runner = std::move(task_runner);
+    client.on_share_changed = std::move(on_share_changed);
+  }
+  RedistributeLocked();
+  return id;
+}
+
+void PageCacheBudget::Unregister(ClientId id) {
+  base::AutoLock lock(lock_);
+  const size_t erased = clients_.erase(id);
+  DCHECK_EQ(1u, erased);
+  RedistributeLocked();
+}
+
+int PageCacheBudget::ReportSteps(ClientId id, int64_t steps) {
+  base::AutoLock lock(lock_);
+  auto client = clients_.find(id);
+  DCHECK(client != clients_.end());
+  if (client == clients_.end())
+    return 0;
+  UpdateLocked(clock_->NowTicks());
+  client->second.score += steps;
+  RedistributeLocked();
+  return client->second.cache_pages;
+}
+
+int PageCacheBudget::GetCachePages(ClientId id) {
+  base::AutoLock lock(lock_);
+  auto client = clients_.find(id);
+  DCHECK(client != clients_.end());
+  if (client == clients_.end())
+    return 0;
+  UpdateLocked(clock_->NowTicks());
+  RedistributeLocked();
+  return client->second.cache_pages;
+}
+
+void PageCacheBudget::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  if (level == base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE)
+    return;
+  base::AutoLock lock(lock_);
+  UpdateLocked(clock_->NowTicks());
+  pressure_level_ = level;
+  last_pressure_time_ = clock_->NowTicks();
+  RedistributeLocked();
+
+  // Idle databases would otherwise keep their old share until their next
+  // report, which may never come.
+  for (const auto& client : clients_) {
+    if (!client.second.task_runner)
+      continue;
+    client.second.task_runner->PostTask(
+        FROM_HERE, base::BindOnce(client.second.on_share_changed, client.first,
+                                  client.second.cache_pages));
+  }
+}
+
+size_t PageCacheBudget::GetEffectiveBudgetBytes() {
+  base::AutoLock lock(lock_);
+  UpdateLocked(clock_->NowTicks());
+  return GetEffectiveBudgetBytesLocked();
+}
+
+size_t PageCacheBudget::client_count() {
+  base::AutoLock lock(lock_);
+  return clients_.size();
+}
+
+void PageCacheBudget::UpdateLocked(base::TimeTicks now) {
+  lock_.AssertAcquired();
+  if (last_decay_time_.is_null())
+    last_decay_time_ = now;
+  const int64_t halvings = (now - last_decay_time_) / kDecayInterval;
+  if (halvings > 0) {
+    const double factor = std::pow(0.5, std::min<int64_t>(halvings, 64));
+    for (auto& client : clients_)
+      client.second.score *= factor;
+    last_decay_time_ += kDecayInterval * halvings;
+  }
+
+  if (pressure_level_ !=
+          base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE &&
+      now - last_pressure_time_ >= kPressureDuration) {
+    pressure_level_ = base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+  }
+}
+
+size_t PageCacheBudget::GetEffectiveBudgetBytesLocked() const {
+  switch (pressure_level_) {
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE:
+      return budget_bytes_;
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE:
+      return budget_bytes_ / 2;
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL:
+      return budget_bytes_ / 4;
+  }
+  NOTREACHED();
+  return budget_bytes_;
+}
+
+void PageCacheBudget::RedistributeLocked() {
+  lock_.AssertAcquired();
+  if (clients_.empty())
+    return;
+
+  // Every client gets |kMinCacheBytes|, even if that overruns the budget, and
+  // the rest goes by score.
+  const size_t budget = GetEffectiveBudgetBytesLocked();
+  const size_t reserved = kMinCacheBytes * clients_.size();
+  const size_t shared = budget > reserved ? budget - reserved : 0;
+  double total_score = 0;
+  for (const auto& client : clients_)
+    total_score += client.second.score;
+
+  for (auto& client : clients_) {
+    const double share = total_score > 0
+                             ? client.second.score / total_score
+                             : 1.0 / clients_.size();
+    const size_t bytes = kMinCacheBytes + static_cast<size_t>(shared * share);
+    client.second.cache_pages = std::max(
+        1, static_cast<int>(bytes / client.second.page_size));
+  }
+}
+
+}  // namespace sql
@@ -0,0 +1,130 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef SQL_PAGE_CACHE_BUDGET_H_
+#define SQL_PAGE_CACHE_BUDGET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+
+#include "base/callback.h"
+#include "base/component_export.h"
+#include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/sequenced_task_runner.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+namespace base {
+class TickClock;
+}  // namespace base
+
+namespace sql {
+
+// Splits a process-wide page cache budget between the open sql::Database
+// instances, instead of each of them caching up to SQLite's default 2 MB.
+// Each database gets a small share, and the rest of the budget goes to the
+// databases by how often they were stepped lately. Memory pressure shrinks the
+// budget for a while, and the shrunk shares are pushed to the databases right
+// away.
+//
+// Databases report their steps and read their share on their own sequences,
+// so this class is thread-safe.
+class COMPONENT_EXPORT(SQL) PageCacheBudget {
+ public:
+  using ClientId = int;
+
+  // Runs with a client's id and its new number of cache pages.
+  using ShareCallback = base::RepeatingCallback<void(ClientId, int)>;
+
+  // Never returned by Register().
+  static constexpr ClientId kInvalidClientId = 0;
+
+  // The budget used by GetInstance().
+  static constexpr size_t kDefaultBudgetBytes = 16 * 1024 * 1024;
+
+  // Every database gets at least this much, even when idle.
+  static constexpr size_t kMinCacheBytes = 256 * 1024;
+
+  // Steps are weighed less the longer ago they were reported. Their weight
+  // halves every |kDecayInterval|.
+  static constexpr base::TimeDelta kDecayInterval =
+      base::TimeDelta::FromSeconds(30);
+
+  // How long memory pressure shrinks the budget after its last notification.
+  static constexpr base::TimeDelta kPressureDuration =
+      base::TimeDelta::FromMinutes(1);
+
+  static PageCacheBudget* GetInstance();
+
+  // |clock| is for tests, and defaults to the real clock.
+  explicit PageCacheBudget(size_t budget_bytes,
+                           const base::TickClock* clock = nullptr);
+  ~PageCacheBudget();
+
+  // Adds a database whose pages are |page_size| bytes. When memory pressure
+  // changes the budget, |on_share_changed| is posted to |task_runner| with the
+  // new share. A client without a |task_runner| only gets its new share when
+  // it reports steps or asks for it.
+  ClientId Register(int page_size,
+                    scoped_refptr<base::SequencedTaskRunner> task_runner,
+                    ShareCallback on_share_changed);
+  void Unregister(ClientId id);
+
+  // Records |steps| statement steps of |id|, and returns how many pages |id|
+  // may cache now.
+  int ReportSteps(ClientId id, int64_t steps);
+
+  // Returns how many pages |id| may cache.
+  int GetCachePages(ClientId id);
+
+  // Halves the budget on moderate pressure, and quarters it on critical
+  // pressure, for |kPressureDuration|, and pushes the new shares to the
+  // clients.
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
+  // The budget in bytes, and how much of it is given out now, which is less
+  // than the budget under memory pressure.
+  size_t budget_bytes() const { return budget_bytes_; }
+  size_t GetEffectiveBudgetBytes();
+
+  size_t client_count();
+
+ private:
+  struct Client {
+    int page_size = 0;
+    // Decayed count of the steps reported.
+    double score = 0;
+    int cache_pages = 0;
+    scoped_refptr<base::SequencedTaskRunner> task_runner;
+    ShareCallback on_share_changed;
+  };
+
+  // Applies the decay and the end of memory pressure that are due.
+  void UpdateLocked(base::TimeTicks now);
+  size_t GetEffectiveBudgetBytesLocked() const;
+  // Recomputes the share of every client.
+  void RedistributeLocked();
+
+  const size_t budget_bytes_;
+  const base::TickClock* const clock_;
+
+  base::Lock lock_;
+  std::map<ClientId, Client> clients_;
+  ClientId next_id_ = kInvalidClientId + 1;
+  base::TimeTicks last_decay_time_;
+  base::MemoryPressureListener::MemoryPressureLevel pressure_level_ =
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+  base::TimeTicks last_pressure_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(PageCacheBudget);
+};
+
+}  // namespace sql
+
+#endif  // SQL_PAGE_CACHE_BUDGET_H_
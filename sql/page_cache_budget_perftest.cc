@@ -0,0 +1,196 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/timer/elapsed_timer.h"
+#include "sql/database.h"
+#include "sql/sql_features.h"
+#include "sql/statement.h"
+#include "sql/transaction.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace sql {
+namespace {
+
+constexpr int kUrlCount = 40000;
+constexpr int kVisitsPerUrl = 4;
+constexpr int kCookieCount = 3000;
+constexpr int kQueryCount = 50000;
+
+// Returns the same numbers on every run.
+class Random {
+ public:
+  int Next(int range) {
+    seed_ = seed_ * 1103515245 + 12345;
+    return static_cast<int>((seed_ >> 16) % range);
+  }
+
+ private:
+  uint32_t seed_ = 1;
+};
+
+// A History-like database: urls with an index on their spec, and visits with
+// an index on their url.
+void CreateHistory(Database* db) {
+  ASSERT_TRUE(db->Execute(
+      "CREATE TABLE urls (id INTEGER PRIMARY KEY, url LONGVARCHAR, "
+      "title LONGVARCHAR, visit_count INTEGER, last_visit_time INTEGER)"));
+  ASSERT_TRUE(db->Execute("CREATE INDEX urls_url_index ON urls (url)"));
+  ASSERT_TRUE(db->Execute(
+      "CREATE TABLE visits (id INTEGER PRIMARY KEY, url INTEGER, "
+      "visit_time INTEGER, transition INTEGER)"));
+  ASSERT_TRUE(db->Execute("CREATE INDEX visits_url_index ON visits (url)"));
+
+  Transaction transaction(db);
+  ASSERT_TRUE(transaction.Begin());
+  Statement insert_url(db->GetUniqueStatement(
+      "INSERT INTO urls (id, url, title, visit_count, last_visit_time) "
+      "VALUES (?, ?, ?, ?, ?)"));
+  Statement insert_visit(db->GetUniqueStatement(
+      "INSERT INTO visits (url, visit_time, transition) VALUES (?, ?, ?)"));
+  for (int i = 1; i <= kUrlCount; ++i) {
+    insert_url.BindInt(0, i);
+    insert_url.BindString(
+        1, base::StringPrintf("https://www.example%d.com/path/%d", i % 500, i));
+    insert_url.BindString(2, base::StringPrintf("Page title number %d", i));
+    insert_url.BindInt(3, kVisitsPerUrl);
+    insert_url.BindInt64(4, i);
+    ASSERT_TRUE(insert_url.Run());
+    insert_url.Reset(true);
+    for (int j = 0; j < kVisitsPerUrl; ++j) {
+      insert_visit.BindInt(0, i);
+      insert_visit.BindInt64(1, i * kVisitsPerUrl + j);
+      insert_visit.BindInt(2, j);
+      ASSERT_TRUE(insert_visit.Run());
+      insert_visit.Reset(true);
+    }
+  }
+  ASSERT_TRUE(transaction.Commit());
+}
+
+// A Cookies-like database: cookies looked up by host.
+void CreateCookies(Database* db) {
+  ASSERT_TRUE(db->Execute(
+      "CREATE TABLE cookies (creation_utc INTEGER PRIMARY KEY, "
+      "host_key TEXT, name TEXT, value TEXT, path TEXT)"));
+  ASSERT_TRUE(db->Execute("CREATE INDEX cookies_host ON cookies (host_key)"));
+
+  Transaction transaction(db);
+  ASSERT_TRUE(transaction.Begin());
+  Statement insert(db->GetUniqueStatement(
+      "INSERT INTO cookies (creation_utc, host_key, name, value, path) "
+      "VALUES (?, ?, ?, ?, '/')"));
+  for (int i = 0; i < kCookieCount; ++i) {
+    insert.BindInt(0, i);
+    insert.BindString(1, base::StringPrintf(".example%d.com", i % 700));
+    insert.BindString(2, base::StringPrintf("name%d", i));
+    insert.BindString(3, std::string(64, 'v'));
+    ASSERT_TRUE(insert.Run());
+    insert.Reset(true);
+  }
+  ASSERT_TRUE(transaction.Commit());
+}
+
+// Returns how many bytes |db| may cache. A negative cache_size is in KiB.
+int64_t GetCacheLimitBytes(Database* db) {
+  Statement cache_size(db->GetUniqueStatement("PRAGMA cache_size"));
+  EXPECT_TRUE(cache_size.Step());
+  const int64_t pages = cache_size.ColumnInt64(0);
+  if (pages < 0)
+    return -pages * 1024;
+  Statement page_size(db->GetUniqueStatement("PRAGMA page_size"));
+  EXPECT_TRUE(page_size.Step());
+  return pages * page_size.ColumnInt64(0);
+}
+
+class PageCacheBudgetPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    Database history;
+    ASSERT_TRUE(history.Open(HistoryPath()));
+    CreateHistory(&history);
+    Database cookies;
+    ASSERT_TRUE(cookies.Open(CookiesPath()));
+    CreateCookies(&cookies);
+  }
+
+  base::FilePath HistoryPath() const {
+    return temp_dir_.GetPath().AppendASCII("History");
+  }
+  base::FilePath CookiesPath() const {
+    return temp_dir_.GetPath().AppendASCII("Cookies");
+  }
+
+  // Runs History queries with a Cookies lookup every tenth query, as browsing
+  // does, and reports the time per query and the memory cached.
+  void RunWorkload(const std::string& trace) {
+    Database history;
+    ASSERT_TRUE(history.Open(HistoryPath()));
+    Database cookies;
+    ASSERT_TRUE(cookies.Open(CookiesPath()));
+
+    Random random;
+    int64_t rows = 0;
+    base::ElapsedTimer timer;
+    for (int i = 0; i < kQueryCount; ++i) {
+      if (i % 10 == 0) {
+        Statement s(cookies.GetCachedStatement(
+            SQL_FROM_HERE, "SELECT name, value FROM cookies WHERE host_key=?"));
+        s.BindString(0, base::StringPrintf(".example%d.com", random.Next(700)));
+        while (s.Step())
+          ++rows;
+        continue;
+      }
+      // Recent URLs are visited more, like in real history.
+      const int url_id =
+          kUrlCount - random.Next(random.Next(kUrlCount - 1) + 1);
+      Statement s(history.GetCachedStatement(
+          SQL_FROM_HERE,
+          "SELECT urls.url, urls.title, visits.visit_time FROM urls "
+          "JOIN visits ON visits.url = urls.id WHERE urls.id=?"));
+      s.BindInt(0, url_id);
+      while (s.Step())
+        ++rows;
+    }
+    const base::TimeDelta time = timer.Elapsed();
+    EXPECT_GT(rows, 0);
+
+    perf_test::PrintResult("PageCacheBudget", "", trace + "_query",
+                           time.InMicrosecondsF() / kQueryCount, "us/query",
+                           true);
+    perf_test::PrintResult(
+        "PageCacheBudget", "", trace + "_cache_limit",
+        static_cast<size_t>(GetCacheLimitBytes(&history) +
+                            GetCacheLimitBytes(&cookies)),
+        "bytes", true);
+  }
+
+  base::ScopedTempDir temp_dir_;
+};
+
+TEST_F(PageCacheBudgetPerfTest, HistoryAndCookies) {
+  {
+    base::test::ScopedFeatureList feature_list;
+    feature_list.InitAndDisableFeature(features::kSqlPageCacheBudget);
+    RunWorkload("per_database_cache");
+  }
+  {
+    base::test::ScopedFeatureList feature_list;
+    feature_list.InitAndEnableFeature(features::kSqlPageCacheBudget);
+    RunWorkload("shared_budget");
+  }
+}
+
+}  // namespace
+}  // namespace sql
@@ -0,0 +1,159 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sql/page_cache_budget.h"
+
+#include <map>
+
+#include "base/bind.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/test/task_environment.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace sql {
+namespace {
+
+constexpr size_t kBudget = 4 * 1024 * 1024;
+constexpr int kPageSize = 4096;
+
+class PageCacheBudgetTest : public testing::Test {
+ protected:
+  PageCacheBudgetTest() : budget_(kBudget, &clock_) {
+    clock_.Advance(base::TimeDelta::FromSeconds(1));
+  }
+
+  PageCacheBudget::ClientId Register(int page_size) {
+    return budget_.Register(page_size, nullptr,
+                            PageCacheBudget::ShareCallback());
+  }
+
+  // Returns the bytes given out to |ids|.
+  size_t GetTotalBytes(std::initializer_list<PageCacheBudget::ClientId> ids) {
+    size_t bytes = 0;
+    for (PageCacheBudget::ClientId id : ids)
+      bytes += budget_.GetCachePages(id) * kPageSize;
+    return bytes;
+  }
+
+  base::SimpleTestTickClock clock_;
+  PageCacheBudget budget_;
+};
+
+TEST_F(PageCacheBudgetTest, IdleClientsShareEqually) {
+  PageCacheBudget::ClientId a = Register(kPageSize);
+  EXPECT_EQ(static_cast<int>(kBudget / kPageSize), budget_.GetCachePages(a));
+
+  PageCacheBudget::ClientId b = Register(kPageSize);
+  EXPECT_NE(a, b);
+  EXPECT_EQ(budget_.GetCachePages(a), budget_.GetCachePages(b));
+  EXPECT_EQ(kBudget, GetTotalBytes({a, b}));
+  EXPECT_EQ(2u, budget_.client_count());
+
+  budget_.Unregister(b);
+  EXPECT_EQ(static_cast<int>(kBudget / kPageSize), budget_.GetCachePages(a));
+  EXPECT_EQ(1u, budget_.client_count());
+}
+
+TEST_F(PageCacheBudgetTest, BusyClientsGetMore) {
+  PageCacheBudget::ClientId busy = Register(kPageSize);
+  PageCacheBudget::ClientId idle = Register(kPageSize);
+  PageCacheBudget::ClientId other = Register(2 * kPageSize);
+
+  budget_.ReportSteps(busy, 3000);
+  budget_.ReportSteps(other, 1000);
+
+  // The idle client keeps the minimum, and the rest is split 3 to 1.
+  EXPECT_EQ(static_cast<int>(PageCacheBudget::kMinCacheBytes / kPageSize),
+            budget_.GetCachePages(idle));
+  const size_t shared = kBudget - 3 * PageCacheBudget::kMinCacheBytes;
+  EXPECT_EQ(
+      static_cast<int>((PageCacheBudget::kMinCacheBytes + shared * 3 / 4) /
+                       kPageSize),
+      budget_.GetCachePages(busy));
+  EXPECT_EQ(
+      static_cast<int>((PageCacheBudget::kMinCacheBytes + shared / 4) /
+                       (2 * kPageSize)),
+      budget_.GetCachePages(other));
+}
+
+TEST_F(PageCacheBudgetTest, OldStepsDecay) {
+  PageCacheBudget::ClientId a = Register(kPageSize);
+  PageCacheBudget::ClientId b = Register(kPageSize);
+
+  budget_.ReportSteps(a, 1000);
+  const int a_busy_pages = budget_.GetCachePages(a);
+  EXPECT_GT(a_busy_pages, budget_.GetCachePages(b));
+
+  // After a few decays, a few recent steps of |b| outweigh the old ones of
+  // |a|.
+  clock_.Advance(PageCacheBudget::kDecayInterval * 5);
+  budget_.ReportSteps(b, 100);
+  EXPECT_GT(budget_.GetCachePages(b), budget_.GetCachePages(a));
+  EXPECT_LT(budget_.GetCachePages(a), a_busy_pages);
+}
+
+TEST_F(PageCacheBudgetTest, MemoryPressureShrinksTheBudget) {
+  PageCacheBudget::ClientId a = Register(kPageSize);
+  PageCacheBudget::ClientId b = Register(kPageSize);
+
+  budget_.OnMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  EXPECT_EQ(kBudget / 2, budget_.GetEffectiveBudgetBytes());
+  EXPECT_EQ(kBudget / 2, GetTotalBytes({a, b}));
+
+  budget_.OnMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  EXPECT_EQ(kBudget / 4, budget_.GetEffectiveBudgetBytes());
+  EXPECT_EQ(kBudget / 4, GetTotalBytes({a, b}));
+
+  // The budget comes back once the pressure is gone for a while.
+  clock_.Advance(PageCacheBudget::kPressureDuration);
+  EXPECT_EQ(kBudget, budget_.GetEffectiveBudgetBytes());
+  EXPECT_EQ(kBudget, GetTotalBytes({a, b}));
+}
+
+TEST_F(PageCacheBudgetTest, MemoryPressurePushesShares) {
+  base::test::TaskEnvironment task_environment;
+  std::map<PageCacheBudget::ClientId, int> pushed;
+  PageCacheBudget::ShareCallback on_share_changed = base::BindRepeating(
+      [](std::map<PageCacheBudget::ClientId, int>* pushed,
+         PageCacheBudget::ClientId id, int cache_pages) {
+        (*pushed)[id] = cache_pages;
+      },
+      &pushed);
+  PageCacheBudget::ClientId a = budget_.Register(
+      kPageSize, base::SequencedTaskRunnerHandle::Get(), on_share_changed);
+  PageCacheBudget::ClientId b = budget_.Register(
+      kPageSize, base::SequencedTaskRunnerHandle::Get(), on_share_changed);
+  PageCacheBudget::ClientId silent = Register(kPageSize);
+  task_environment.RunUntilIdle();
+  EXPECT_TRUE(pushed.empty());
+
+  // The shares are posted to the clients' sequences.
+  budget_.OnMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  EXPECT_TRUE(pushed.empty());
+  task_environment.RunUntilIdle();
+  ASSERT_EQ(2u, pushed.size());
+  EXPECT_EQ(budget_.GetCachePages(a), pushed[a]);
+  EXPECT_EQ(budget_.GetCachePages(b), pushed[b]);
+  EXPECT_EQ(0u, pushed.count(silent));
+}
+
+TEST_F(PageCacheBudgetTest, MinimumOverrunsTheBudget) {
+  PageCacheBudget small_budget(PageCacheBudget::kMinCacheBytes, &clock_);
+  PageCacheBudget::ClientId a = small_budget.Register(
+      kPageSize, nullptr, PageCacheBudget::ShareCallback());
+  PageCacheBudget::ClientId b = small_budget.Register(
+      kPageSize, nullptr, PageCacheBudget::ShareCallback());
+  small_budget.ReportSteps(a, 1000);
+  EXPECT_EQ(static_cast<int>(PageCacheBudget::kMinCacheBytes / kPageSize),
+            small_budget.GetCachePages(a));
+  EXPECT_EQ(static_cast<int>(PageCacheBudget::kMinCacheBytes / kPageSize),
+            small_budget.GetCachePages(b));
+}
+
+}  // namespace
+}  // namespace sql
@@ -20,6 +20,17 @@ namespace features {
 const base::Feature kSqlSkipPreload{"SqlSkipPreload",
                                     base::FEATURE_DISABLED_BY_DEFAULT};
 
+// Disabled until the memory it saves and its effect on query times are
+// measured.
+const base::Feature kSqlPageCacheBudget{"SqlPageCacheBudget",
+                                        base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::Feature kSqlMmapFileSize{"SqlMmapFileSize",
+                                     base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::Feature kSqlStatementProfiling{"SqlStatementProfiling",
+                                           base::FEATURE_DISABLED_BY_DEFAULT};
+
 }  // namespace features
 
 }  // namespace sql
@@ -14,6 +14,17 @@ namespace features {
 
 COMPONENT_EXPORT(SQL) extern const base::Feature kSqlSkipPreload;
 
+// Splits a process-wide page cache budget between the databases that don't
+// set their own cache size. See sql::PageCacheBudget.
+COMPONENT_EXPORT(SQL) extern const base::Feature kSqlPageCacheBudget;
+
+// Memory-maps the database file with some room to grow, instead of up to
+// 256MB for every database.
+COMPONENT_EXPORT(SQL) extern const base::Feature kSqlMmapFileSize;
+
+// Enables sql::Database::EnableStatementProfiling() for every database.
+COMPONENT_EXPORT(SQL) extern const base::Feature kSqlStatementProfiling;
+
 }  // namespace features
 
 }  // namespace sql
@@ -4,8 +4,11 @@
 
 #include "sql/sql_memory_dump_provider.h"
 
+#include "base/bind.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "base/trace_event/memory_dump_manager.h"
 #include "base/trace_event/process_memory_dump.h"
+#include "sql/page_cache_budget.h"
 #include "third_party/sqlite/sqlite3.h"
 
 namespace sql {
@@ -17,7 +20,13 @@ SqlMemoryDumpProvider* SqlMemoryDumpProvider::GetInstance() {
       base::LeakySingletonTraits<SqlMemoryDumpProvider>>::get();
 }
 
-SqlMemoryDumpProvider::SqlMemoryDumpProvider() = default;
+SqlMemoryDumpProvider::SqlMemoryDumpProvider() {
+  if (base::SequencedTaskRunnerHandle::IsSet()) {
+    memory_pressure_listener_ = std::make_unique<base::MemoryPressureListener>(
+        base::BindRepeating(&PageCacheBudget::OnMemoryPressure,
+                            base::Unretained(PageCacheBudget::GetInstance())));
+  }
+}
 
 SqlMemoryDumpProvider::~SqlMemoryDumpProvider() = default;
 
@@ -50,6 +59,14 @@ bool SqlMemoryDumpProvider::OnMemoryDump(
                     malloc_count);
   }
 
+  PageCacheBudget* budget = PageCacheBudget::GetInstance();
+  dump->AddScalar("page_cache_budget",
+                  base::trace_event::MemoryAllocatorDump::kUnitsBytes,
+                  budget->GetEffectiveBudgetBytes());
+  dump->AddScalar("page_cache_budget_clients",
+                  base::trace_event::MemoryAllocatorDump::kUnitsObjects,
+                  budget->client_count());
+
   const char* system_allocator_name =
       base::trace_event::MemoryDumpManager::GetInstance()
           ->system_allocator_pool_name();
@@ -5,8 +5,11 @@
 #ifndef SQL_SQL_MEMORY_DUMP_PROVIDER_H
 #define SQL_SQL_MEMORY_DUMP_PROVIDER_H
 
+#include <memory>
+
 #include "base/component_export.h"
 #include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/memory/singleton.h"
 #include "base/trace_event/memory_dump_provider.h"
 
@@ -29,6 +32,10 @@ class COMPONENT_EXPORT(SQL) SqlMemoryDumpProvider
   SqlMemoryDumpProvider();
   ~SqlMemoryDumpProvider() override;
 
+  // Shrinks the sql::PageCacheBudget under memory pressure. Only listens when
+  // created on a sequence, as it is in the browser process.
+  std::unique_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+
   DISALLOW_COPY_AND_ASSIGN(SqlMemoryDumpProvider);
 };
 
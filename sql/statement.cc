@@ -11,6 +11,7 @@
 #include "base/numerics/safe_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "sql/statement_profiler.h"
 #include "third_party/sqlite/sqlite3.h"
 
 namespace sql {
@@ -61,7 +62,12 @@ int Statement::StepInternal() {
   ref_->InitScopedBlockingCall(&scoped_blocking_call);
 
   stepped_ = true;
-  int ret = sqlite3_step(ref_->stmt());
+  Database* database = ref_->database();
+  if (database)
+    database->OnStatementStep();
+  StatementProfiler* profiler =
+      database ? database->statement_profiler_.get() : nullptr;
+  int ret = ProfiledStep(ref_->stmt(), profiler);
   return CheckError(ret);
 }
 
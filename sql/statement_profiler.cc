@@ -0,0 +1,125 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sql/statement_profiler.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/hash/hash.h"
+#include "base/logging.h"
+#include "base/strings/stringprintf.h"
+#include "base/trace_event/memory_allocator_dump.h"
+#include "base/trace_event/process_memory_dump.h"
+#include "base/trace_event/trace_event.h"
+#include "third_party/sqlite/sqlite3.h"
+
+namespace sql {
+
+namespace {
+
+int GetCacheStatus(sqlite3* db, int op) {
+  int current = 0;
+  int highwater = 0;
+  int status = sqlite3_db_status(db, op, &current, &highwater,
+                                 0 /* resetFlag */);
+  DCHECK_EQ(SQLITE_OK, status);
+  return current;
+}
+
+uint32_t GetStatementHash(const char* sql) {
+  if (!sql)
+    sql = "";
+  return base::PersistentHash(sql, strlen(sql));
+}
+
+}  // namespace
+
+StatementProfiler::StatementProfiler() = default;
+
+StatementProfiler::~StatementProfiler() = default;
+
+void StatementProfiler::RecordStep(const char* sql,
+                                   base::TimeDelta time,
+                                   bool returned_row,
+                                   int cache_hits,
+                                   int cache_misses) {
+  base::AutoLock lock(lock_);
+  auto it = stats_.find(sql);
+  if (it == stats_.end()) {
+    it = stats_
+             .emplace(stats_.size() < kMaxStatements ? sql : std::string(),
+                      Stats())
+             .first;
+  }
+  Stats& stats = it->second;
+  ++stats.step_count;
+  if (returned_row)
+    ++stats.row_count;
+  stats.total_time += time;
+  stats.max_time = std::max(stats.max_time, time);
+  stats.cache_hits += cache_hits;
+  stats.cache_misses += cache_misses;
+}
+
+std::map<std::string, StatementProfiler::Stats> StatementProfiler::GetStats()
+    const {
+  base::AutoLock lock(lock_);
+  return stats_;
+}
+
+void StatementProfiler::Reset() {
+  base::AutoLock lock(lock_);
+  stats_.clear();
+}
+
+void StatementProfiler::DumpStats(
+    const std::string& parent_dump_name,
+    base::trace_event::ProcessMemoryDump* pmd) const {
+  using base::trace_event::MemoryAllocatorDump;
+  base::AutoLock lock(lock_);
+  for (const auto& statement : stats_) {
+    const Stats& stats = statement.second;
+    MemoryAllocatorDump* dump = pmd->CreateAllocatorDump(base::StringPrintf(
+        "%s/statements/0x%08X", parent_dump_name.c_str(),
+        GetStatementHash(statement.first.c_str())));
+    dump->AddScalar("step_count", MemoryAllocatorDump::kUnitsObjects,
+                    stats.step_count);
+    dump->AddScalar("row_count", MemoryAllocatorDump::kUnitsObjects,
+                    stats.row_count);
+    dump->AddScalar("total_time_us", MemoryAllocatorDump::kUnitsObjects,
+                    stats.total_time.InMicroseconds());
+    dump->AddScalar("max_time_us", MemoryAllocatorDump::kUnitsObjects,
+                    stats.max_time.InMicroseconds());
+    dump->AddScalar("cache_hits", MemoryAllocatorDump::kUnitsObjects,
+                    stats.cache_hits);
+    dump->AddScalar("cache_misses", MemoryAllocatorDump::kUnitsObjects,
+                    stats.cache_misses);
+  }
+}
+
+int ProfiledStep(sqlite3_stmt* stmt, StatementProfiler* profiler) {
+  // The statement text may hold user data, so only its hash is traced.
+  TRACE_EVENT1(TRACE_DISABLED_BY_DEFAULT("sql"), "sql::Step", "statement_hash",
+               GetStatementHash(sqlite3_sql(stmt)));
+  if (!profiler)
+    return sqlite3_step(stmt);
+
+  sqlite3* db = sqlite3_db_handle(stmt);
+  const int cache_hits = GetCacheStatus(db, SQLITE_DBSTATUS_CACHE_HIT);
+  const int cache_misses = GetCacheStatus(db, SQLITE_DBSTATUS_CACHE_MISS);
+  const base::TimeTicks start = base::TimeTicks::Now();
+  const int rc = sqlite3_step(stmt);
+  const base::TimeDelta time = base::TimeTicks::Now() - start;
+
+  const char* sql = sqlite3_sql(stmt);
+  profiler->RecordStep(
+      sql ? sql : "", time, rc == SQLITE_ROW,
+      GetCacheStatus(db, SQLITE_DBSTATUS_CACHE_HIT) - cache_hits,
+      GetCacheStatus(db, SQLITE_DBSTATUS_CACHE_MISS) - cache_misses);
+  return rc;
+}
+
+}  // namespace sql
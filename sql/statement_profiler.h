@@ -0,0 +1,91 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef SQL_STATEMENT_PROFILER_H_
+#define SQL_STATEMENT_PROFILER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include "base/component_export.h"
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+struct sqlite3_stmt;
+
+namespace base {
+namespace trace_event {
+class ProcessMemoryDump;
+}  // namespace trace_event
+}  // namespace base
+
+namespace sql {
+
+// Collects how often and how long the statements of a sql::Database run, by
+// statement text. Steps are recorded on the database's sequence, and read
+// from any thread, notably by memory dumps.
+//
+// Only the first kMaxStatements distinct statements get stats of their own,
+// so that statements built with literal values can't grow the stats without
+// bound. The steps of later statements are counted together, under an empty
+// statement text.
+class COMPONENT_EXPORT(SQL) StatementProfiler {
+ public:
+  static constexpr size_t kMaxStatements = 256;
+
+  struct Stats {
+    // Calls to sqlite3_step(), and how many of them returned a row.
+    int64_t step_count = 0;
+    int64_t row_count = 0;
+
+    // Time spent in sqlite3_step(), in all and in the slowest call.
+    base::TimeDelta total_time;
+    base::TimeDelta max_time;
+
+    // Page cache lookups done by the steps, as SQLITE_DBSTATUS_CACHE_HIT and
+    // SQLITE_DBSTATUS_CACHE_MISS count them.
+    int64_t cache_hits = 0;
+    int64_t cache_misses = 0;
+  };
+
+  StatementProfiler();
+  ~StatementProfiler();
+
+  // Records a step of the statement |sql|.
+  void RecordStep(const char* sql,
+                  base::TimeDelta time,
+                  bool returned_row,
+                  int cache_hits,
+                  int cache_misses);
+
+  // Returns the stats of the statements stepped since the last Reset().
+  std::map<std::string, Stats> GetStats() const;
+
+  void Reset();
+
+  // Adds a dump per statement under |parent_dump_name|. The dumps are named
+  // by a hash of the statement, so that they carry no user data.
+  void DumpStats(const std::string& parent_dump_name,
+                 base::trace_event::ProcessMemoryDump* pmd) const;
+
+ private:
+  mutable base::Lock lock_;
+  std::map<std::string, Stats> stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(StatementProfiler);
+};
+
+// Steps |stmt| like sqlite3_step(). The step is recorded into |profiler| when
+// it is not null, and traced when the "disabled-by-default-sql" category is
+// enabled. Traces carry the same hash of the statement as memory dumps.
+COMPONENT_EXPORT(SQL)
+int ProfiledStep(sqlite3_stmt* stmt, StatementProfiler* profiler);
+
+}  // namespace sql
+
+#endif  // SQL_STATEMENT_PROFILER_H_